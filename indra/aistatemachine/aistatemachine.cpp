@@ -34,6 +34,7 @@
 #include "linden_common.h"
 #include "aistatemachine.h"
 #include "aicondition.h"
+#include "llfasttimertrace.h"
 #include "lltimer.h"
 
 //==================================================================
@@ -325,7 +326,7 @@ void print_statemachine_diagnostics(U64 total_clocks, AIStateMachine::StateTimer
 #endif
 
 // MAIN-THREAD
-void AIEngine::mainloop(void)
+bool AIEngine::mainloop(void)
 {
   queued_type::iterator queued_element, end;
   {
@@ -345,6 +346,7 @@ void AIEngine::mainloop(void)
 	if (!state_machine.sleep(get_clock_count()))
 	{
 		AIStateMachine::StateTimerRoot timer(state_machine.getName());
+		LLFastTimerTrace::Scope trace(LLFastTimer::sTraceEnabled ? state_machine.getTraceName() : NULL);
 		state_machine.multiplex(AIStateMachine::normal_run);
 		time_data = timer.GetTimerData();
 	}
@@ -379,9 +381,10 @@ void AIEngine::mainloop(void)
 #endif
 	  Dout(dc::statemachine, "Sorting " << engine_state_w->list.size() << " state machines.");
 	  engine_state_w->list.sort(QueueElementComp());
-	  break;
+	  return true;
 	}
   }
+  return false;
 }
 
 void AIEngine::flush(void)
@@ -403,8 +406,9 @@ U64 AIEngine::sMaxCount;
 void AIEngine::setMaxCount(F32 StateMachineMaxTime)
 {
   llassert(AIThreadID::in_main_thread());
-  Dout(dc::statemachine, "(Re)calculating AIStateMachine::sMaxCount");
-  sMaxCount = calc_clock_frequency() * StateMachineMaxTime / 1000;
+  // Called every frame by the frame budget.
+  static F64 const clock_frequency = calc_clock_frequency();
+  sMaxCount = clock_frequency * StateMachineMaxTime / 1000;
 }
 
 #ifdef CWDEBUG
@@ -1363,6 +1367,16 @@ char const* AIStateMachine::state_str(base_state_type state)
   return "UNKNOWN BASE STATE";
 }
 
+char const* AIStateMachine::getTraceName(void)
+{
+  // Interning takes a lock, so do it once per state machine rather than once per run.
+  if (!mTraceName)
+  {
+	mTraceName = LLFastTimerTrace::intern(getName());
+  }
+  return mTraceName;
+}
+
 AIEngine gMainThreadEngine("gMainThreadEngine");
 AIEngine gStateMachineThreadEngine("gStateMachineThreadEngine");
 
@@ -1386,7 +1400,10 @@ void AIEngine::threadloop(void)
   do
   {
 	AIStateMachine& state_machine(queued_element->statemachine());
-	state_machine.multiplex(AIStateMachine::normal_run);
+	{
+	  LLFastTimerTrace::Scope trace(LLFastTimer::sTraceEnabled ? state_machine.getTraceName() : NULL);
+	  state_machine.multiplex(AIStateMachine::normal_run);
+	}
 	bool active = state_machine.active(this);		// This locks mState shortly, so it must be called before locking mEngineState because add() locks mEngineState while holding mState.
 	engine_state_type_wat engine_state_w(mEngineState);
 	if (!active)
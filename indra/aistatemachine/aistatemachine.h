@@ -86,7 +86,8 @@ class AIEngine
 
 	void add(AIStateMachine* state_machine);
 
-	void mainloop(void);
+	// Returns true when it ran out of time before every state machine had run.
+	bool mainloop(void);
 	void threadloop(void);
 	void wake_up(void);
 	void flush(void);
@@ -336,6 +337,7 @@ public:
 #endif
   private:
 	U64 mRuntime;								// Total time spent running in the main thread (in clocks).
+	char const* mTraceName;						// getName(), interned for LLFastTimerTrace on first use.
 
   public:
 	AIStateMachine(CWD_ONLY(bool debug)) : mCallback(NULL), mDefaultEngine(NULL), mYieldEngine(NULL),
@@ -346,7 +348,7 @@ public:
 #ifdef CWDEBUG
 		mSMDebug(debug),
 #endif
-		mRuntime(0)
+		mRuntime(0), mTraceName(NULL)
 	{ }
 
   protected:
@@ -437,6 +439,8 @@ public:
 
 	// For diagnostics. Every derived class must override this.
 	virtual const char* getName() const = 0;
+	// getName(), as a string that stays valid until exit. Only call from multiplex context.
+	char const* getTraceName(void);
 
   protected:
 	virtual void initialize_impl(void) = 0;
@@ -146,6 +146,7 @@
 
 #include "llfasttimer.h"
 
+#include "llfasttimertrace.h"
 #include "llmemory.h"
 #include "llprocessor.h"
 #include "llsingleton.h"
@@ -191,6 +192,7 @@ const int LLFastTimer::NamedTimer::HISTORY_NUM = 300;
 std::vector<LLFastTimer::FrameState>* LLFastTimer::sTimerInfos = NULL;
 U64				LLFastTimer::sTimerCycles = 0;
 U32				LLFastTimer::sTimerCalls = 0;
+LLAtomicU32		LLFastTimer::sTraceEnabled(0);
 
 
 // FIXME: move these declarations to the relevant modules
@@ -944,6 +946,15 @@ LLFastTimer::LLFastTimer(LLFastTimer::FrameState* state)
 	mLastTimerData = LLFastTimer::sCurTimerData;
 }
 
+//static
+void LLFastTimer::recordTraceEvent(const NamedTimer* timer, U32 start_time)
+{
+	U64 end_time = getCPUClockCount64();
+	// The 32 bit clock is the 64 bit one without its low byte.
+	U64 start = end_time - ((U64)((U32)(end_time >> 8) - start_time) << 8);
+	LLFastTimerTrace::record(timer->getName().c_str(), start, end_time);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Important note: These implementations must be FAST!
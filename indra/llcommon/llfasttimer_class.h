@@ -27,6 +27,8 @@
 #ifndef LL_FASTTIMER_CLASS_H
 #define LL_FASTTIMER_CLASS_H
 
+#include "aithreadid.h"
+#include "llatomic.h"
 #include "llinstancetracker.h"
 
 #define FAST_TIMER_ON 1
@@ -159,29 +161,33 @@ public:
 		U64 timer_start = getCPUClockCount64();
 #endif
 #if FAST_TIMER_ON
-		LLFastTimer::FrameState* frame_state = mFrameState;
 		mStartTime = getCPUClockCount32();
-
-		frame_state->mActiveCount++;
-		frame_state->mCalls++;
-		// keep current parent as long as it is active when we are
-		frame_state->mMoveUpTree |= (frame_state->mParent->mActiveCount == 0);
-
-		LLFastTimer::CurTimerData* cur_timer_data = &LLFastTimer::sCurTimerData;
-		mLastTimerData = *cur_timer_data;
-		cur_timer_data->mCurTimer = this;
-		cur_timer_data->mNamedTimer = &timer.mTimer;
-		cur_timer_data->mFrameState = frame_state;
-		cur_timer_data->mChildTime = 0;
+		if (LL_UNLIKELY(!inMainThread()))
+		{
+			// The frame statistics are the main thread's; other threads only show up in traces.
+			mFrameState = NULL;
+			mLastTimerData.mNamedTimer = &timer.mTimer;
+		}
+		else
+		{
+			LLFastTimer::FrameState* frame_state = mFrameState;
+
+			frame_state->mActiveCount++;
+			frame_state->mCalls++;
+			// keep current parent as long as it is active when we are
+			frame_state->mMoveUpTree |= (frame_state->mParent->mActiveCount == 0);
+
+			LLFastTimer::CurTimerData* cur_timer_data = &LLFastTimer::sCurTimerData;
+			mLastTimerData = *cur_timer_data;
+			cur_timer_data->mCurTimer = this;
+			cur_timer_data->mNamedTimer = &timer.mTimer;
+			cur_timer_data->mFrameState = frame_state;
+			cur_timer_data->mChildTime = 0;
+		}
 #endif
 #if TIME_FAST_TIMERS
 		U64 timer_end = getCPUClockCount64();
 		sTimerCycles += timer_end - timer_start;
-#endif
-#if DEBUG_FAST_TIMER_THREADS
-#if !LL_RELEASE
-		assert_main_thread();
-#endif
 #endif
 	}
 
@@ -192,19 +198,40 @@ public:
 #endif
 #if FAST_TIMER_ON
 		LLFastTimer::FrameState* frame_state = mFrameState;
-		U32 total_time = getCPUClockCount32() - mStartTime;
+		if (LL_UNLIKELY(!frame_state))
+		{
+			if (sTraceEnabled)
+			{
+				recordTraceEvent(mLastTimerData.mNamedTimer, mStartTime);
+			}
+		}
+		else
+		{
+			U32 total_time = getCPUClockCount32() - mStartTime;
 
-		frame_state->mSelfTimeCounter += total_time - LLFastTimer::sCurTimerData.mChildTime;
-		frame_state->mActiveCount--;
+			frame_state->mSelfTimeCounter += total_time - LLFastTimer::sCurTimerData.mChildTime;
+			frame_state->mActiveCount--;
 
-		// store last caller to bootstrap tree creation
-		// do this in the destructor in case of recursion to get topmost caller
-		frame_state->mLastCaller = mLastTimerData.mNamedTimer;
+			// store last caller to bootstrap tree creation
+			// do this in the destructor in case of recursion to get topmost caller
+			frame_state->mLastCaller = mLastTimerData.mNamedTimer;
 
-		// we are only tracking self time, so subtract our total time delta from parents
-		mLastTimerData.mChildTime += total_time;
+			// we are only tracking self time, so subtract our total time delta from parents
+			mLastTimerData.mChildTime += total_time;
 
-		LLFastTimer::sCurTimerData = mLastTimerData;
+			LLFastTimer::sCurTimerData = mLastTimerData;
+
+#if DEBUG_FAST_TIMER_THREADS
+#if !LL_RELEASE
+			// A timer that was opened for the frame statistics must close there too.
+			assert_main_thread();
+#endif
+#endif
+			if (LL_UNLIKELY(sTraceEnabled))
+			{
+				recordTraceEvent(frame_state->mTimer, mStartTime);
+			}
+		}
 #endif
 #if TIME_FAST_TIMERS
 		U64 timer_end = getCPUClockCount64();
@@ -223,6 +250,7 @@ public:
 	static bool 			sResetHistory;
 	static U64				sTimerCycles;
 	static U32				sTimerCalls;
+	static LLAtomicU32		sTraceEnabled;	// See LLFastTimerTrace
 
 	typedef std::vector<FrameState> info_list_t;
 	static info_list_t& getFrameStateList();
@@ -259,8 +287,12 @@ public:
 	static std::string sClockType;
 
 private:
+	friend class LLFastTimerTrace;
+
 	static U32 getCPUClockCount32();
 	static U64 getCPUClockCount64();
+	static bool inMainThread() { return AIThreadID::in_main_thread_inline(); }
+	static void recordTraceEvent(const NamedTimer* timer, U32 start_time);
 
 	static S32				sCurFrameIndex;
 	static S32				sLastFrameIndex;
@@ -0,0 +1,311 @@
+/**
+ * @file llfasttimertrace.cpp
+ * @brief Per-thread timelines of LLFastTimer scopes, exported as trace-event JSON.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llfasttimertrace.h"
+
+#include <ostream>
+#include <set>
+#include <vector>
+
+#include "llatomic.h"
+#include "llfile.h"
+#include "llformat.h"
+#include "llthread.h"
+
+namespace
+{
+
+// Events kept per thread; a power of two. An event takes 24 bytes.
+const U32 EVENTS_PER_THREAD = 1 << 15;
+
+struct Event
+{
+	const char* mName;
+	U64 mStart;
+	U64 mEnd;
+};
+
+struct ThreadBuffer
+{
+	ThreadBuffer(const std::string& name, U32 id)
+	:	mName(name),
+		mID(id),
+		mEvents(EVENTS_PER_THREAD),
+		mWritten(0),
+		mWriting(0),
+		mReading(0),
+		mExited(0)
+	{
+	}
+
+	// Owning thread only.
+	void push(const char* name, U64 start, U64 end)
+	{
+		// mWriting and mReading keep push() and copy() apart: each side
+		// announces itself before it checks the other, so at most one of
+		// them touches mEvents. Events that arrive during a copy are dropped.
+		mWriting = 1;
+		if (LL_LIKELY(!mReading))
+		{
+			U32 written = mWritten;
+			Event& event = mEvents[written & (EVENTS_PER_THREAD - 1)];
+			event.mName = name;
+			event.mStart = start;
+			event.mEnd = end;
+			mWritten = written + 1;
+		}
+		mWriting = 0;
+	}
+
+	// Any thread, with sMutex locked. Returns the number of events pushed so far.
+	U32 copy(std::vector<Event>& events)
+	{
+		mReading = 1;
+		while (mWriting)
+		{
+			LLThread::yield();
+		}
+		const U32 written = mWritten;
+		const U32 count = llmin(written, EVENTS_PER_THREAD);
+		events.resize(count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			events[i] = mEvents[(written - count + i) & (EVENTS_PER_THREAD - 1)];
+		}
+		mReading = 0;
+		return written;
+	}
+
+	std::string mName;
+	U32 mID;
+	std::vector<Event> mEvents;
+	LLAtomicU32 mWritten;		// Events pushed since the thread registered.
+	LLAtomicU32 mWriting;		// Set while push() runs.
+	LLAtomicU32 mReading;		// Set while copy() runs.
+	LLAtomicU32 mExited;		// Set when the thread is gone; its buffer only holds history.
+};
+
+// Owned by the thread's LLThreadLocalData, so that we learn when the thread ends.
+class ThreadHandle : public LLThreadLocalDataMember
+{
+public:
+	ThreadHandle(ThreadBuffer* buffer) : mBuffer(buffer) { }
+	/*virtual*/ ~ThreadHandle();
+
+	ThreadBuffer* mBuffer;
+};
+
+LLMutex* sMutex = NULL;						// Protects sBuffers, sNextThreadID and sNames.
+std::vector<ThreadBuffer*> sBuffers;
+U32 sNextThreadID = 1;
+std::set<std::string> sNames;				// See LLFastTimerTrace::intern().
+U64 sCaptureStart = 0;
+U64 sCaptureEnd = 0;
+
+#ifdef ll_thread_local
+static ll_thread_local ThreadBuffer* sThreadBuffer = NULL;
+#endif
+
+ThreadHandle::~ThreadHandle()
+{
+	mBuffer->mExited = 1;
+#ifdef ll_thread_local
+	sThreadBuffer = NULL;
+#endif
+}
+
+ThreadBuffer* get_thread_buffer()
+{
+#ifdef ll_thread_local
+	if (LL_LIKELY(sThreadBuffer))
+	{
+		return sThreadBuffer;
+	}
+#endif
+	LLThreadLocalData& tldata = LLThreadLocalData::tldata();
+	if (!tldata.mTraceBuffer)
+	{
+		LLMutexLock lock(sMutex);
+		ThreadBuffer* buffer = new ThreadBuffer(tldata.mName, sNextThreadID++);
+		sBuffers.push_back(buffer);
+		tldata.mTraceBuffer = new ThreadHandle(buffer);
+	}
+	ThreadBuffer* buffer = static_cast<ThreadHandle*>(tldata.mTraceBuffer)->mBuffer;
+#ifdef ll_thread_local
+	sThreadBuffer = buffer;
+#endif
+	return buffer;
+}
+
+std::string json_escape(const char* str)
+{
+	std::string escaped;
+	for (; *str; ++str)
+	{
+		const char c = *str;
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else if ((U8)c < 0x20)
+		{
+			escaped += llformat("\\u%04x", (U32)c);
+		}
+		else
+		{
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+} // namespace
+
+//static
+void LLFastTimerTrace::start()
+{
+	llassert(AIThreadID::in_main_thread());
+	if (!sMutex)
+	{
+		sMutex = new LLMutex;
+	}
+	{
+		// Threads that ended before this capture have nothing to add to it.
+		LLMutexLock lock(sMutex);
+		for (std::vector<ThreadBuffer*>::iterator it = sBuffers.begin(); it != sBuffers.end();)
+		{
+			if ((*it)->mExited)
+			{
+				delete *it;
+				it = sBuffers.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+	sCaptureStart = now();
+	sCaptureEnd = 0;
+	LLFastTimer::sTraceEnabled = 1;
+	LL_INFOS() << "Fast timer trace started" << LL_ENDL;
+}
+
+//static
+void LLFastTimerTrace::stop()
+{
+	llassert(AIThreadID::in_main_thread());
+	if (LLFastTimer::sTraceEnabled)
+	{
+		LLFastTimer::sTraceEnabled = 0;
+		sCaptureEnd = now();
+		LL_INFOS() << "Fast timer trace stopped" << LL_ENDL;
+	}
+}
+
+//static
+void LLFastTimerTrace::record(const char* name, U64 start, U64 end)
+{
+	get_thread_buffer()->push(name, start, end);
+}
+
+//static
+const char* LLFastTimerTrace::intern(const char* name)
+{
+	llassert(sMutex);
+	LLMutexLock lock(sMutex);
+	return sNames.insert(name).first->c_str();
+}
+
+//static
+void LLFastTimerTrace::write(std::ostream& os)
+{
+	os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	if (!sMutex)
+	{
+		os << "]}\n";
+		return;
+	}
+
+	// countsPerSecond() is for the 32 bit clock, which drops the low byte.
+	const F64 us_per_count = 1000000.0 / (F64)(LLFastTimer::countsPerSecond() << 8);
+	const U64 capture_end = sCaptureEnd ? sCaptureEnd : now();
+	const char* separator = "\n";
+	std::vector<Event> events;
+
+	LLMutexLock lock(sMutex);
+	for (std::vector<ThreadBuffer*>::const_iterator it = sBuffers.begin(); it != sBuffers.end(); ++it)
+	{
+		ThreadBuffer& buffer = **it;
+
+		// Scopes that were still open at stop() may be pushing now.
+		const U32 written = buffer.copy(events);
+		const U32 count = (U32)events.size();
+
+		if (written > EVENTS_PER_THREAD && count && events[0].mStart > sCaptureStart)
+		{
+			LL_WARNS() << "Thread \"" << buffer.mName << "\" recorded more than " << EVENTS_PER_THREAD
+					   << " events; the start of the capture is missing from its timeline" << LL_ENDL;
+		}
+
+		os << separator << llformat("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+									buffer.mID, json_escape(buffer.mName.c_str()).c_str());
+		separator = ",\n";
+
+		for (U32 i = 0; i < count; ++i)
+		{
+			const Event& event = events[i];
+			if (event.mEnd < sCaptureStart || event.mStart > capture_end)
+			{
+				continue;
+			}
+			// Scopes that were already open when the capture started begin with it.
+			const U64 start = llmax(event.mStart, sCaptureStart);
+			os << separator << llformat("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+										json_escape(event.mName).c_str(), buffer.mID,
+										(F64)(start - sCaptureStart) * us_per_count,
+										(F64)(event.mEnd - start) * us_per_count);
+		}
+	}
+	os << "\n]}\n";
+}
+
+//static
+bool LLFastTimerTrace::write(const std::string& filename)
+{
+	llofstream file(filename.c_str());
+	if (!file.is_open())
+	{
+		LL_WARNS() << "Could not open " << filename << " to write the fast timer trace" << LL_ENDL;
+		return false;
+	}
+	write(file);
+	LL_INFOS() << "Wrote fast timer trace to " << filename << LL_ENDL;
+	return true;
+}
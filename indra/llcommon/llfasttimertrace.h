@@ -0,0 +1,94 @@
+/**
+ * @file llfasttimertrace.h
+ * @brief Per-thread timelines of LLFastTimer scopes, exported as trace-event JSON.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFASTTIMERTRACE_H
+#define LL_LLFASTTIMERTRACE_H
+
+#include <iosfwd>
+
+#include "llfasttimer.h"
+
+/**
+ * @class LLFastTimerTrace
+ * @brief Records when every LLFastTimer scope ran, on every thread.
+ *
+ * While a capture runs, each thread that closes a scope appends it to a
+ * ring buffer of its own. Only the owning thread writes to a buffer, so
+ * recording takes no locks; a thread only takes a mutex the first time
+ * it records, to register its buffer. Each buffer keeps the newest
+ * events, so a long capture loses its beginning rather than its end.
+ * write() never copies a buffer while its thread is pushing to it.
+ *
+ * write() produces the Chrome trace-event format, which chrome://tracing
+ * and the Perfetto UI load, with one timeline per thread.
+ */
+class LL_COMMON_API LLFastTimerTrace
+{
+public:
+	// Main thread. Starting a capture forgets the previous one.
+	static void start();
+	static void stop();
+	static bool isRunning() { return LLFastTimer::sTraceEnabled; }
+
+	// Writes the last capture. Call after stop().
+	static void write(std::ostream& os);
+	static bool write(const std::string& filename);
+
+	// Any thread. start and end are LLFastTimer clock counts (see now()),
+	// name must stay valid until exit; see intern().
+	static void record(const char* name, U64 start, U64 end);
+	// A copy of name that stays valid until exit, for names that don't.
+	// Takes a mutex: intern a name once, not for every scope.
+	static const char* intern(const char* name);
+	static U64 now() { return LLFastTimer::getCPUClockCount64(); }
+
+	// Records its lifetime as a scope with a name that is only known at run
+	// time, like a state machine's. name must stay valid until exit; see
+	// intern(). Does nothing when no capture runs.
+	class Scope
+	{
+	public:
+		Scope(const char* name)
+		:	mName(LLFastTimer::sTraceEnabled ? name : NULL),
+			mStart(mName ? now() : 0)
+		{
+		}
+
+		~Scope()
+		{
+			if (mName)
+			{
+				record(mName, mStart, now());
+			}
+		}
+
+	private:
+		const char* mName;
+		U64 mStart;
+	};
+};
+
+#endif // LL_LLFASTTIMERTRACE_H
@@ -34,14 +34,19 @@
 #if defined(LL_WINDOWS)
 //# include <windows.h>
 # include <psapi.h>
+# include <intrin.h>
 #elif defined(LL_DARWIN)
 # include <sys/types.h>
+# include <sys/mman.h>
 # include <mach/task.h>
 # include <mach/mach_init.h>
 #elif LL_LINUX || LL_SOLARIS
 # include <unistd.h>
+# include <sys/mman.h>
 #endif
 
+#include <algorithm>
+
 #include "llmemory.h"
 
 #include "llsys.h"
@@ -553,785 +558,369 @@ const char* LLMemTracker::getNextLine()
 
 //--------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------
-//minimum slot size and minimal slot size interval
-const U32 ATOMIC_MEM_SLOT = 16 ; //bytes
-
-//minimum block sizes (page size) for small allocation, medium allocation, large allocation 
-const U32 MIN_BLOCK_SIZES[LLPrivateMemoryPool::SUPER_ALLOCATION] = {2 << 10, 4 << 10, 16 << 10} ; //
-
-//maximum block sizes for small allocation, medium allocation, large allocation 
-const U32 MAX_BLOCK_SIZES[LLPrivateMemoryPool::SUPER_ALLOCATION] = {64 << 10, 1 << 20, 4 << 20} ;
-
-//minimum slot sizes for small allocation, medium allocation, large allocation 
-const U32 MIN_SLOT_SIZES[LLPrivateMemoryPool::SUPER_ALLOCATION]  = {ATOMIC_MEM_SLOT, 2 << 10, 512 << 10};
+//objects of up to 256 bytes come in steps of 16 bytes, larger ones in four steps per power of two.
+const U32 SMALL_CLASS_STEP = 16 ;
+const U32 NUM_SMALL_CLASSES = 16 ;
 
-//maximum slot sizes for small allocation, medium allocation, large allocation 
-const U32 MAX_SLOT_SIZES[LLPrivateMemoryPool::SUPER_ALLOCATION]  = {(2 << 10) - ATOMIC_MEM_SLOT, (512 - 2) << 10, 4 << 20};
+//free objects a thread may keep per size class: up to MAGAZINE_BYTES worth, at least one.
+const U32 MAX_MAGAZINE_SIZE = 64 ;
+const U32 MAGAZINE_BYTES = 128 << 10 ;
 
-//size of a block with multiple slots can not exceed CUT_OFF_SIZE
-const U32 CUT_OFF_SIZE = (64 << 10) ; //64 KB
+//volatile pools keep one empty span per size class for reuse, if it is no larger than this.
+const U32 MAX_SPARE_SPAN_SIZE = 256 << 10 ;
 
-//max number of slots in a block
-const U32 MAX_NUM_SLOTS_IN_A_BLOCK = llmin(MIN_BLOCK_SIZES[0] / ATOMIC_MEM_SLOT, ATOMIC_MEM_SLOT * 8) ;
+//a size class that is not one: spans holding a single allocation larger than MAX_CLASS_SIZE.
+const S32 LARGE_CLASS = LLPrivateMemoryPool::NUM_SIZE_CLASSES ;
 
-//-------------------------------------------------------------
-//align val to be integer times of ATOMIC_MEM_SLOT
-U32 align(U32 val)
-{
-	U32 aligned = (val / ATOMIC_MEM_SLOT) * ATOMIC_MEM_SLOT ;
-	if(aligned < val)
-	{
-		aligned += ATOMIC_MEM_SLOT ;
-	}
-
-	return aligned ;
-}
-
-//-------------------------------------------------------------
-//class LLPrivateMemoryPool::LLMemoryBlock
-//-------------------------------------------------------------
-//
-//each memory block could fit for two page sizes: 0.75 * mSlotSize, which starts from the beginning of the memory chunk and grow towards the end of the
-//the block; another is mSlotSize, which starts from the end of the block and grows towards the beginning of the block.
-//
-LLPrivateMemoryPool::LLMemoryBlock::LLMemoryBlock()
+static inline U32 highest_bit(U32 val)
 {
-	//empty
-}
-		
-LLPrivateMemoryPool::LLMemoryBlock::~LLMemoryBlock() 
-{
-	//empty
+#if LL_WINDOWS
+	unsigned long index ;
+	_BitScanReverse(&index, val) ;
+	return index ;
+#else
+	return 31 - __builtin_clz(val) ;
+#endif
 }
 
-//create and initialize a memory block
-void LLPrivateMemoryPool::LLMemoryBlock::init(char* buffer, U32 buffer_size, U32 slot_size)
+static inline U32 get_class_size(S32 class_index)
 {
-	mBuffer = buffer ;
-	mBufferSize = buffer_size ;
-	mSlotSize = slot_size ;
-	mTotalSlots = buffer_size / mSlotSize ;	
-	
-	llassert_always(buffer_size / mSlotSize <= MAX_NUM_SLOTS_IN_A_BLOCK) ; //max number is 128
-	
-	mAllocatedSlots = 0 ;
-	mDummySize = 0 ;
-
-	//init the bit map.
-	//mark free bits	
-	if(mTotalSlots > 32) //reserve extra space from mBuffer to store bitmap if needed.
-	{
-		mDummySize = ATOMIC_MEM_SLOT ;		
-		mTotalSlots -= (mDummySize + mSlotSize - 1) / mSlotSize ;
-		mUsageBits = 0 ;
-
-		S32 usage_bit_len = (mTotalSlots + 31) / 32 ;
-		
-		for(S32 i = 0 ; i < usage_bit_len - 1 ; i++)
-		{
-			*((U32*)mBuffer + i) = 0 ;
-		}
-		for(S32 i = usage_bit_len - 1 ; i < (S32)(mDummySize / sizeof(U32)) ; i++)
-		{
-			*((U32*)mBuffer + i) = 0xffffffff ;
-		}
-
-		if(mTotalSlots & 31)
-		{
-			*((U32*)mBuffer + usage_bit_len - 2) = (0xffffffff << (mTotalSlots & 31)) ;
-		}		
-	}	
-	else//no extra bitmap space reserved
+	if(class_index < (S32)NUM_SMALL_CLASSES)
 	{
-		mUsageBits = 0 ;
-		if(mTotalSlots & 31)
-		{
-			mUsageBits = (0xffffffff << (mTotalSlots & 31)) ;
-		}
+		return (class_index + 1) * SMALL_CLASS_STEP ;
 	}
-
-	mSelf = this ;
-	mNext = NULL ;
-	mPrev = NULL ;
-
-	llassert_always(mTotalSlots > 0) ;
+	U32 step = class_index - NUM_SMALL_CLASSES ;
+	U32 level = 8 + (step >> 2) ;
+	return (1 << level) + (((step & 3) + 1) << (level - 2)) ;
 }
 
-//mark this block to be free with the memory [mBuffer, mBuffer + mBufferSize).
-void LLPrivateMemoryPool::LLMemoryBlock::setBuffer(char* buffer, U32 buffer_size)
+//spans hold at least eight objects (four of the classes above 64 KB) and are whole pages.
+static inline U32 get_span_size(U32 object_size)
 {
-	mBuffer = buffer ;
-	mBufferSize = buffer_size ;
-	mSelf = NULL ;
-	mTotalSlots = 0 ; //set the block is free.
+	U32 objects = object_size > (64 << 10) ? 4 : 8 ;
+	U32 size = llmax((U32)LLPrivateMemoryPool::PAGE_SIZE, object_size * objects) ;
+	return (size + LLPrivateMemoryPool::PAGE_SIZE - 1) & ~(LLPrivateMemoryPool::PAGE_SIZE - 1) ;
 }
 
-//reserve a slot
-char* LLPrivateMemoryPool::LLMemoryBlock::allocate() 
+static inline U32 get_magazine_size(S32 class_index)
 {
-	llassert_always(mAllocatedSlots < mTotalSlots) ;
-	
-	//find a free slot
-	U32* bits = NULL ;
-	U32  k = 0 ;
-	if(mUsageBits != 0xffffffff)
-	{
-		bits = &mUsageBits ;
-	}
-	else if(mDummySize > 0)//go to extra space
-	{		
-		for(S32 i = 0 ; i < (S32)(mDummySize / sizeof(U32)); i++)
-		{
-			if(*((U32*)mBuffer + i) != 0xffffffff)
-			{
-				bits = (U32*)mBuffer + i ;
-				k = i + 1 ;
-				break ;
-			}
-		}
-	}	
-	S32 idx = 0 ;
-	U32 tmp = *bits ;
-	for(; tmp & 1 ; tmp >>= 1, idx++) ;
-
-	//set the slot reserved
-	if(!idx)
-	{
-		*bits |= 1 ;
-	}
-	else
-	{
-		*bits |= (1 << idx) ;
-	}
-
-	mAllocatedSlots++ ;
-	
-	return mBuffer + mDummySize + (k * 32 + idx) * mSlotSize ;
+	return llclamp(MAGAZINE_BYTES / get_class_size(class_index), 1U, MAX_MAGAZINE_SIZE) ;
 }
 
-//free a slot
-void  LLPrivateMemoryPool::LLMemoryBlock::freeMem(void* addr) 
+//-------------------------------------------------------------
+//spans are taken from, and given back to, the OS directly.
+//-------------------------------------------------------------
+static char* os_allocate(U32 size)
 {
-	//bit index
-	U32 idx = (static_cast<U32>((char*)addr - mBuffer) - mDummySize) / mSlotSize ;
-
-	U32* bits = &mUsageBits ;
-	if(idx >= 32)
-	{
-		bits = (U32*)mBuffer + (idx - 32) / 32 ;
-	}
-
-	//reset the bit
-	if(idx & 31)
+#if LL_WINDOWS
+	//VirtualAlloc() already hands out memory at a 64 KB granularity.
+	return (char*)VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE) ;
+#else
+	//reserve an extra page and trim the ends, so that the span starts at a page boundary.
+	const size_t page_size = LLPrivateMemoryPool::PAGE_SIZE ;
+	size_t reserved = size + page_size ;
+	char* p = (char*)mmap(NULL, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0) ;
+	if(p == (char*)MAP_FAILED)
 	{
-		*bits &= ~(1 << (idx & 31)) ;
+		return NULL ;
 	}
-	else
+	size_t head = (page_size - ((uintptr_t)p & (page_size - 1))) & (page_size - 1) ;
+	if(head)
 	{
-		*bits &= ~1 ;
+		munmap(p, head) ;
 	}
-
-	mAllocatedSlots-- ;
-}
-
-//for debug use: reset the entire bitmap.
-void  LLPrivateMemoryPool::LLMemoryBlock::resetBitMap()
-{
-	for(S32 i = 0 ; i < (S32)(mDummySize / sizeof(U32)) ; i++)
+	size_t tail = reserved - head - size ;
+	if(tail)
 	{
-		*((U32*)mBuffer + i) = 0 ;
+		munmap(p + head + size, tail) ;
 	}
-	mUsageBits = 0 ;
-}
-//-------------------------------------------------------------------
-//class LLMemoryChunk
-//--------------------------------------------------------------------
-LLPrivateMemoryPool::LLMemoryChunk::LLMemoryChunk()
-{
-	//empty
+	return p + head ;
+#endif
 }
 
-LLPrivateMemoryPool::LLMemoryChunk::~LLMemoryChunk()
+static void os_free(char* p, U32 size)
 {
-	//empty
+#if LL_WINDOWS
+	VirtualFree(p, 0, MEM_RELEASE) ;
+#else
+	munmap(p, size) ;
+#endif
 }
 
-//create and init a memory chunk
-void LLPrivateMemoryPool::LLMemoryChunk::init(char* buffer, U32 buffer_size, U32 min_slot_size, U32 max_slot_size, U32 min_block_size, U32 max_block_size) 
+//-------------------------------------------------------------
+//struct LLPrivateMemoryPool::Span
+//-------------------------------------------------------------
+struct LLPrivateMemoryPool::Span
 {
-	mBuffer = buffer ;
-	mBufferSize = buffer_size ;
-	mAlloatedSize = 0 ;
-
-	mMetaBuffer = mBuffer + sizeof(LLMemoryChunk) ;
+	LLPrivateMemoryPool* mPool ;
+	char* mBuffer ;
+	U32   mSize ;        //a multiple of PAGE_SIZE
+	S32   mClass ;       //size class, or LARGE_CLASS
+	U32   mObjectSize ;
+	U32   mTotal ;       //number of objects that fit
+	U32   mUsed ;        //number of objects taken
+	char* mFreeList ;    //returned objects, linked through their first word
+	char* mUnused ;      //objects from here to the end of the span were never handed out
+	Span* mPrev ;
+	Span* mNext ;
 
-	mMinBlockSize = min_block_size; //page size
-	mMinSlotSize = min_slot_size;
-	mMaxSlotSize = max_slot_size ;
-	mBlockLevels = mMaxSlotSize / mMinSlotSize ;
-	mPartitionLevels = max_block_size / mMinBlockSize + 1 ;
-
-	S32 max_num_blocks = (buffer_size - sizeof(LLMemoryChunk) - mBlockLevels * sizeof(LLMemoryBlock*) - mPartitionLevels * sizeof(LLMemoryBlock*)) / 
-		                 (mMinBlockSize + sizeof(LLMemoryBlock)) ;
-	//meta data space
-	mBlocks = (LLMemoryBlock*)mMetaBuffer ; //space reserved for all memory blocks.
-	mAvailBlockList = (LLMemoryBlock**)((char*)mBlocks + sizeof(LLMemoryBlock) * max_num_blocks) ; 
-	mFreeSpaceList = (LLMemoryBlock**)((char*)mAvailBlockList + sizeof(LLMemoryBlock*) * mBlockLevels) ; 
-	
-	//data buffer, which can be used for allocation
-	mDataBuffer = (char*)mFreeSpaceList + sizeof(LLMemoryBlock*) * mPartitionLevels ;
-	
-	//alignmnet
-	mDataBuffer = mBuffer + align(mDataBuffer - mBuffer) ;
-	
-	//init
-	for(U32 i = 0 ; i < mBlockLevels; i++)
-	{
-		mAvailBlockList[i] = NULL ;
-	}
-	for(U32 i = 0 ; i < mPartitionLevels ; i++)
+	void reset()
 	{
-		mFreeSpaceList[i] = NULL ;
+		mUsed = 0 ;
+		mFreeList = NULL ;
+		mUnused = mBuffer ;
 	}
+};
 
-	//assign the entire chunk to the first block
-	mBlocks[0].mPrev = NULL ;
-	mBlocks[0].mNext = NULL ;
-	mBlocks[0].setBuffer(mDataBuffer, buffer_size - (mDataBuffer - mBuffer)) ;
-	addToFreeSpace(&mBlocks[0]) ;
-
-	mNext = NULL ;
-	mPrev = NULL ;
-}
-
-//static 
-U32 LLPrivateMemoryPool::LLMemoryChunk::getMaxOverhead(U32 data_buffer_size, U32 min_slot_size, 
-													   U32 max_slot_size, U32 min_block_size, U32 max_block_size)
+static void link_span(LLPrivateMemoryPool::Span*& head, LLPrivateMemoryPool::Span* span)
 {
-	//for large allocations, reserve some extra memory for meta data to avoid wasting much 
-	if(data_buffer_size / min_slot_size < 64) //large allocations
+	span->mPrev = NULL ;
+	span->mNext = head ;
+	if(head)
 	{
-		U32 overhead = sizeof(LLMemoryChunk) + (data_buffer_size / min_block_size) * sizeof(LLMemoryBlock) +
-			sizeof(LLMemoryBlock*) * (max_slot_size / min_slot_size) + sizeof(LLMemoryBlock*) * (max_block_size / min_block_size + 1) ;
-
-		//round to integer times of min_block_size
-		overhead = ((overhead + min_block_size - 1) / min_block_size) * min_block_size ;
-		return overhead ;
-	}
-	else
-	{
-		return 0 ; //do not reserve extra overhead if for small allocations
+		head->mPrev = span ;
 	}
+	head = span ;
 }
 
-char* LLPrivateMemoryPool::LLMemoryChunk::allocate(U32 size)
+static void unlink_span(LLPrivateMemoryPool::Span*& head, LLPrivateMemoryPool::Span* span)
 {
-	if(mMinSlotSize > size)
+	if(span->mPrev)
 	{
-		size = mMinSlotSize ;
+		span->mPrev->mNext = span->mNext ;
 	}
-	if(mAlloatedSize + size  > mBufferSize - (mDataBuffer - mBuffer))
-	{
-		return NULL ; //no enough space in this chunk.
-	}
-
-	char* p = NULL ;
-	U32 blk_idx = getBlockLevel(size);
-
-	LLMemoryBlock* blk = NULL ;
-
-	//check if there is free block available
-	if(mAvailBlockList[blk_idx])
-	{
-		blk = mAvailBlockList[blk_idx] ;
-		p = blk->allocate() ;
-		
-		if(blk->isFull())
-		{
-			popAvailBlockList(blk_idx) ;
-		}
-	}
-
-	//ask for a new block
-	if(!p)
+	else
 	{
-		blk = addBlock(blk_idx) ;
-		if(blk)
-		{
-			p = blk->allocate() ;
-
-			if(blk->isFull())
-			{
-				popAvailBlockList(blk_idx) ;
-			}
-		}
+		head = span->mNext ;
 	}
-
-	//ask for space from larger blocks
-	if(!p)
+	if(span->mNext)
 	{
-		for(S32 i = blk_idx + 1 ; i < mBlockLevels; i++)
-		{
-			if(mAvailBlockList[i])
-			{
-				blk = mAvailBlockList[i] ;
-				p = blk->allocate() ;
-
-				if(blk->isFull())
-				{
-					popAvailBlockList(i) ;
-				}
-				break ;
-			}
-		}
+		span->mNext->mPrev = span->mPrev ;
 	}
-
-	if(p && blk)
-	{		
-		mAlloatedSize += blk->getSlotSize() ;
-	}
-	return p ;
+	span->mPrev = span->mNext = NULL ;
 }
 
-void LLPrivateMemoryPool::LLMemoryChunk::freeMem(void* addr)
-{	
-	U32 blk_idx = getPageIndex((char*)addr);
-	LLMemoryBlock* blk = (LLMemoryBlock*)(mMetaBuffer + blk_idx * sizeof(LLMemoryBlock)) ;
-	blk = blk->mSelf ;
+//-------------------------------------------------------------
+//page map: finds the span of any address without taking a lock.
+//the top level has an entry for every 2^16 pages, the leaves are created on demand.
+//-------------------------------------------------------------
+const U32 PAGE_MAP_BITS = 16 ;
+const uintptr_t PAGE_MAP_SIZE = 1 << PAGE_MAP_BITS ;
+static LLPrivateMemoryPool::Span** sPageMap[PAGE_MAP_SIZE] ;
 
-	bool was_full = blk->isFull() ;
-	blk->freeMem(addr) ;
-	mAlloatedSize -= blk->getSlotSize() ;
+//guards sPoolRegistry and the creation of page map leaves.
+static LLMutex* sPoolRegistryMutexp = NULL ;
+static std::vector<LLPrivateMemoryPool*> sPoolRegistry ;
+static U32 sNextPoolId = 1 ;
 
-	if(blk->empty())
+static inline LLPrivateMemoryPool::Span* find_span(const void* addr)
+{
+	uintptr_t page = (uintptr_t)addr >> LLPrivateMemoryPool::PAGE_SHIFT ;
+	uintptr_t top = page >> PAGE_MAP_BITS ;
+	if(top >= PAGE_MAP_SIZE)
 	{
-		removeBlock(blk) ;
+		return NULL ;
 	}
-	else if(was_full)
-	{
-		addToAvailBlockList(blk) ;
-	}	
-}
-
-bool LLPrivateMemoryPool::LLMemoryChunk::empty()
-{
-	return !mAlloatedSize ;
-}
-
-bool LLPrivateMemoryPool::LLMemoryChunk::containsAddress(const char* addr) const
-{
-	return (size_t)mBuffer <= (size_t)addr && (size_t)mBuffer + mBufferSize > (size_t)addr ;
+	LLPrivateMemoryPool::Span** leaf = sPageMap[top] ;
+	return leaf ? leaf[page & (PAGE_MAP_SIZE - 1)] : NULL ;
 }
 
-//debug use
-void LLPrivateMemoryPool::LLMemoryChunk::dump()
+//point all pages of span at value.
+static void map_span(LLPrivateMemoryPool::Span* span, LLPrivateMemoryPool::Span* value)
 {
-#if 0
-	//sanity check
-	//for(S32 i = 0 ; i < mBlockLevels ; i++)
-	//{
-	//	LLMemoryBlock* blk = mAvailBlockList[i] ;
-	//	while(blk)
-	//	{
-	//		blk_list.push_back(blk) ;
-	//		blk = blk->mNext ;
-	//	}
-	//}
-	for(S32 i = 0 ; i < mPartitionLevels ; i++)
-	{
-		LLMemoryBlock* blk = mFreeSpaceList[i] ;
-		while(blk)
-		{
-			blk_list.push_back(blk) ;
-			blk = blk->mNext ;
-		}
-	}
-
-	std::sort(blk_list.begin(), blk_list.end(), LLMemoryBlock::CompareAddress());
-
-	U32 total_size = blk_list[0]->getBufferSize() ;
-	for(U32 i = 1 ; i < blk_list.size(); i++)
-	{
-		total_size += blk_list[i]->getBufferSize() ;
-		if((U32)blk_list[i]->getBuffer() < (U32)blk_list[i-1]->getBuffer() + blk_list[i-1]->getBufferSize())
-		{
-			LL_ERRS() << "buffer corrupted." << LL_ENDL ;
-		}
-	}
-
-	llassert_always(total_size + mMinBlockSize >= mBufferSize - ((U32)mDataBuffer - (U32)mBuffer)) ;
-
-	U32 blk_num = (mBufferSize - (mDataBuffer - mBuffer)) / mMinBlockSize ;
-	for(U32 i = 0 ; i < blk_num ; )
+	uintptr_t first = (uintptr_t)span->mBuffer >> LLPrivateMemoryPool::PAGE_SHIFT ;
+	uintptr_t last = first + (span->mSize >> LLPrivateMemoryPool::PAGE_SHIFT) ;
+	for(uintptr_t page = first ; page < last ; page++)
 	{
-		LLMemoryBlock* blk = &mBlocks[i] ;
-		if(blk->mSelf)
+		uintptr_t top = page >> PAGE_MAP_BITS ;
+		llassert_always(top < PAGE_MAP_SIZE) ;
+		if(!sPageMap[top])
 		{
-			U32 end = blk->getBufferSize() / mMinBlockSize ;
-			for(U32 j = 0 ; j < end ; j++)
+			sPoolRegistryMutexp->lock() ;
+			if(!sPageMap[top])
 			{
-				llassert_always(blk->mSelf == blk || !blk->mSelf) ;
+				LLPrivateMemoryPool::Span** leaf = new LLPrivateMemoryPool::Span*[PAGE_MAP_SIZE] ;
+				memset(leaf, 0, PAGE_MAP_SIZE * sizeof(LLPrivateMemoryPool::Span*)) ;
+				sPageMap[top] = leaf ;
 			}
-			i += end ;
-		}
-		else
-		{
-			LL_ERRS() << "gap happens" << LL_ENDL ;
+			sPoolRegistryMutexp->unlock() ;
 		}
+		sPageMap[top][page & (PAGE_MAP_SIZE - 1)] = value ;
 	}
-#endif
-#if 0
-	LL_INFOS() << "---------------------------" << LL_ENDL ;
-	LL_INFOS() << "Chunk buffer: " << (U32)getBuffer() << " size: " << getBufferSize() << LL_ENDL ;
+}
 
-	LL_INFOS() << "available blocks ... " << LL_ENDL ;
-	for(S32 i = 0 ; i < mBlockLevels ; i++)
+//-------------------------------------------------------------
+//class LLPrivateMemoryPool::ThreadCache
+//-------------------------------------------------------------
+//per thread magazines of free objects, one per pool type and size class.
+//owned by LLThreadLocalData, which deletes it when the thread exits.
+class LLPrivateMemoryPool::ThreadCache : public LLThreadLocalDataMember
+{
+public:
+	struct Magazine
 	{
-		LLMemoryBlock* blk = mAvailBlockList[i] ;
-		while(blk)
-		{
-			LL_INFOS() << "blk buffer " << (U32)blk->getBuffer() << " size: " << blk->getBufferSize() << LL_ENDL ;
-			blk = blk->mNext ;
-		}
-	}
+		LLPrivateMemoryPool* mPool ;
+		U32   mPoolId ;
+		U32   mCount ;
+		char* mObjects[MAX_MAGAZINE_SIZE] ;
+	};
 
-	LL_INFOS() << "free blocks ... " << LL_ENDL ;
-	for(S32 i = 0 ; i < mPartitionLevels ; i++)
+	ThreadCache()
 	{
-		LLMemoryBlock* blk = mFreeSpaceList[i] ;
-		while(blk)
+		for(S32 i = 0 ; i < MAX_TYPES ; i++)
 		{
-			LL_INFOS() << "blk buffer " << (U32)blk->getBuffer() << " size: " << blk->getBufferSize() << LL_ENDL ;
-			blk = blk->mNext ;
+			mMagazines[i] = NULL ;
 		}
 	}
-#endif
-}
 
-//compute the size for a block, the size is round to integer times of mMinBlockSize.
-U32 LLPrivateMemoryPool::LLMemoryChunk::calcBlockSize(U32 slot_size)
-{
-	//
-	//Note: we try to make a block to have 32 slots if the size is not over 32 pages
-	//32 is the number of bits of an integer in a 32-bit system
-	//
+	/*virtual*/ ~ThreadCache() ;
 
-	U32 block_size;
-	U32 cut_off_size = llmin(CUT_OFF_SIZE, (U32)(mMinBlockSize << 5)) ;
+	static ThreadCache& get() ;
 
-	if((slot_size << 5) <= mMinBlockSize)//for small allocations, return one page 
+	Magazine& getMagazine(LLPrivateMemoryPool* pool, S32 class_index)
 	{
-		block_size = mMinBlockSize ;
-	}
-	else if(slot_size >= cut_off_size)//for large allocations, return one-slot block
-	{
-		block_size = (slot_size / mMinBlockSize) * mMinBlockSize ;
-		if(block_size < slot_size)
-		{
-			block_size += mMinBlockSize ;
-		}
-	}
-	else //medium allocations
-	{
-		if((slot_size << 5) >= cut_off_size)
+		Magazine*& magazines = mMagazines[pool->mType] ;
+		if(!magazines)
 		{
-			block_size = cut_off_size ;
+			magazines = new Magazine[NUM_SIZE_CLASSES] ;
+			memset(magazines, 0, NUM_SIZE_CLASSES * sizeof(Magazine)) ;
 		}
-		else
+		Magazine& magazine = magazines[class_index] ;
+		if(magazine.mPool != pool || magazine.mPoolId != pool->mPoolId)
 		{
-			block_size = ((slot_size << 5) / mMinBlockSize) * mMinBlockSize ;
+			flush(magazine, class_index) ;
+			magazine.mPool = pool ;
+			magazine.mPoolId = pool->mPoolId ;
 		}
+		return magazine ;
 	}
 
-	llassert_always(block_size >= slot_size) ;
+private:
+	static void flush(Magazine& magazine, S32 class_index) ;
 
-	return block_size ;
-}
+	Magazine* mMagazines[MAX_TYPES] ;
+};
 
-//create a new block in the chunk
-LLPrivateMemoryPool::LLMemoryBlock* LLPrivateMemoryPool::LLMemoryChunk::addBlock(U32 blk_idx)
-{	
-	U32 slot_size = mMinSlotSize * (blk_idx + 1) ;
-	U32 preferred_block_size = calcBlockSize(slot_size) ;	
-	U16 idx = getPageLevel(preferred_block_size); 
-	LLMemoryBlock* blk = NULL ;
-	
-	if(mFreeSpaceList[idx])//if there is free slot for blk_idx
-	{
-		blk = createNewBlock(mFreeSpaceList[idx], preferred_block_size, slot_size, blk_idx) ;
-	}
-	else if(mFreeSpaceList[mPartitionLevels - 1]) //search free pool
-	{		
-		blk = createNewBlock(mFreeSpaceList[mPartitionLevels - 1], preferred_block_size, slot_size, blk_idx) ;
-	}
-	else //search for other non-preferred but enough space slot.
-	{
-		S32 min_idx = 0 ;
-		if(slot_size > mMinBlockSize)
-		{
-			min_idx = getPageLevel(slot_size) ;
-		}
-		for(S32 i = (S32)idx - 1 ; i >= min_idx ; i--) //search the small slots first
-		{
-			if(mFreeSpaceList[i])
-			{
-				U32 new_preferred_block_size = mFreeSpaceList[i]->getBufferSize();
-				new_preferred_block_size = (new_preferred_block_size / mMinBlockSize) * mMinBlockSize ; //round to integer times of mMinBlockSize.
-
-				//create a NEW BLOCK THERE.
-				if(new_preferred_block_size >= slot_size) //at least there is space for one slot.
-				{
-					
-					blk = createNewBlock(mFreeSpaceList[i], new_preferred_block_size, slot_size, blk_idx) ;
-				}
-				break ;
-			} 
-		}
+#ifdef ll_thread_local
+static ll_thread_local LLPrivateMemoryPool::ThreadCache* sThreadCache = NULL ;
+#endif
 
-		if(!blk)
+LLPrivateMemoryPool::ThreadCache::~ThreadCache()
+{
+	for(S32 i = 0 ; i < MAX_TYPES ; i++)
+	{
+		if(mMagazines[i])
 		{
-			for(U16 i = idx + 1 ; i < mPartitionLevels - 1; i++) //search the large slots 
+			for(S32 j = 0 ; j < NUM_SIZE_CLASSES ; j++)
 			{
-				if(mFreeSpaceList[i])
-				{
-					//create a NEW BLOCK THERE.
-					blk = createNewBlock(mFreeSpaceList[i], preferred_block_size, slot_size, blk_idx) ;
-					break ;
-				} 
+				flush(mMagazines[i][j], j) ;
 			}
+			delete[] mMagazines[i] ;
 		}
 	}
-
-	return blk ;
+#ifdef ll_thread_local
+	sThreadCache = NULL ;
+#endif
 }
 
-//create a new block at the designed location
-LLPrivateMemoryPool::LLMemoryBlock* LLPrivateMemoryPool::LLMemoryChunk::createNewBlock(LLMemoryBlock* blk, U32 buffer_size, U32 slot_size, U32 blk_idx)
+//static
+LLPrivateMemoryPool::ThreadCache& LLPrivateMemoryPool::ThreadCache::get()
 {
-	//unlink from the free space
-	removeFromFreeSpace(blk) ;
-
-	//check the rest space
-	U32 new_free_blk_size = blk->getBufferSize() - buffer_size ;	
-	if(new_free_blk_size < mMinBlockSize) //can not partition the memory into size smaller than mMinBlockSize
-	{
-		new_free_blk_size = 0 ; //discard the last small extra space.
-	}			
-
-	//add the rest space back to the free list
-	if(new_free_blk_size > 0) //blk still has free space
+#ifdef ll_thread_local
+	if(LL_LIKELY(sThreadCache))
 	{
-		LLMemoryBlock* next_blk = blk + (buffer_size / mMinBlockSize) ;
-		next_blk->mPrev = NULL ;
-		next_blk->mNext = NULL ;
-		next_blk->setBuffer(blk->getBuffer() + buffer_size, new_free_blk_size) ;
-		addToFreeSpace(next_blk) ;
+		return *sThreadCache ;
 	}
-
-	blk->init(blk->getBuffer(), buffer_size, slot_size) ;
-	//insert to the available block list...
-	mAvailBlockList[blk_idx] = blk ;
-
-	//mark the address map: all blocks covered by this block space pointing back to this block.
-	U32 end = (buffer_size / mMinBlockSize) ;
-	for(U32 i = 1 ; i < end ; i++)
+#endif
+	LLThreadLocalData& tldata = LLThreadLocalData::tldata() ;
+	if(!tldata.mPrivatePoolCache)
 	{
-		(blk + i)->mSelf = blk ;
+		tldata.mPrivatePoolCache = new ThreadCache ;
 	}
-
-	return blk ;
+	ThreadCache* cache = static_cast<ThreadCache*>(tldata.mPrivatePoolCache) ;
+#ifdef ll_thread_local
+	sThreadCache = cache ;
+#endif
+	return *cache ;
 }
 
-//delete a block, release the block to the free pool.
-void LLPrivateMemoryPool::LLMemoryChunk::removeBlock(LLMemoryBlock* blk)
+//return the objects of a magazine to their pool, unless that pool was destroyed meanwhile.
+//static
+void LLPrivateMemoryPool::ThreadCache::flush(Magazine& magazine, S32 class_index)
 {
-	//remove from the available block list
-	if(blk->mPrev)
-	{
-		blk->mPrev->mNext = blk->mNext ;
-	}
-	if(blk->mNext)
+	if(!magazine.mCount)
 	{
-		blk->mNext->mPrev = blk->mPrev ;
-	}
-	U32 blk_idx = getBlockLevel(blk->getSlotSize());
-	if(mAvailBlockList[blk_idx] == blk)
-	{
-		mAvailBlockList[blk_idx] = blk->mNext ;
+		return ;
 	}
 
-	blk->mNext = NULL ;
-	blk->mPrev = NULL ;
-	
-	//mark it free
-	blk->setBuffer(blk->getBuffer(), blk->getBufferSize()) ;
-
-#if 1
-	//merge blk with neighbors if possible
-	if(blk->getBuffer() > mDataBuffer) //has the left neighbor
-	{
-		if((blk - 1)->mSelf->isFree())
-		{
-			LLMemoryBlock* left_blk = (blk - 1)->mSelf ;
-			removeFromFreeSpace((blk - 1)->mSelf);
-			left_blk->setBuffer(left_blk->getBuffer(), left_blk->getBufferSize() + blk->getBufferSize()) ;
-			blk = left_blk ;
-		}
-	}
-	if(blk->getBuffer() + blk->getBufferSize() <= mBuffer + mBufferSize - mMinBlockSize) //has the right neighbor
+	sPoolRegistryMutexp->lock() ;
+	if(std::find(sPoolRegistry.begin(), sPoolRegistry.end(), magazine.mPool) != sPoolRegistry.end() &&
+	   magazine.mPool->mPoolId == magazine.mPoolId)
 	{
-		U32 d = blk->getBufferSize() / mMinBlockSize ;
-		if((blk + d)->isFree())
-		{
-			LLMemoryBlock* right_blk = blk + d ;
-			removeFromFreeSpace(blk + d) ;
-			blk->setBuffer(blk->getBuffer(), blk->getBufferSize() + right_blk->getBufferSize()) ;
-		}
+		magazine.mPool->release(class_index, magazine.mObjects, magazine.mCount) ;
 	}
-#endif
-	
-	addToFreeSpace(blk) ;
+	sPoolRegistryMutexp->unlock() ;
 
-	return ;
+	magazine.mCount = 0 ;
 }
 
-//the top block in the list is full, pop it out of the list
-void LLPrivateMemoryPool::LLMemoryChunk::popAvailBlockList(U32 blk_idx) 
-{
-	if(mAvailBlockList[blk_idx])
-	{
-		LLMemoryBlock* next = mAvailBlockList[blk_idx]->mNext ;
-		if(next)
-		{
-			next->mPrev = NULL ;
-		}
-		mAvailBlockList[blk_idx]->mPrev = NULL ;
-		mAvailBlockList[blk_idx]->mNext = NULL ;
-		mAvailBlockList[blk_idx] = next ;
-	}
-}
-
-//add the block back to the free pool
-void LLPrivateMemoryPool::LLMemoryChunk::addToFreeSpace(LLMemoryBlock* blk) 
+//-------------------------------------------------------------------
+//class LLPrivateMemoryPool
+//--------------------------------------------------------------------
+F32 LLPrivateMemoryPool::Stats::getFragmentation() const
 {
-	llassert_always(!blk->mPrev) ;
-	llassert_always(!blk->mNext) ;
-
-	U16 free_idx = blk->getBufferSize() / mMinBlockSize - 1;
-
-	(blk + free_idx)->mSelf = blk ; //mark the end pointing back to the head.
-	free_idx = llmin(free_idx, (U16)(mPartitionLevels - 1)) ;
-
-	blk->mNext = mFreeSpaceList[free_idx] ;
-	if(mFreeSpaceList[free_idx])
+	if(!mReservedSize || mAllocatedSize >= mReservedSize)
 	{
-		mFreeSpaceList[free_idx]->mPrev = blk ;
+		return 0.f ;
 	}
-	mFreeSpaceList[free_idx] = blk ;
-	blk->mPrev = NULL ;
-	blk->mSelf = blk ;
-	
-	return ;
+	return 1.f - (F32)mAllocatedSize / (F32)mReservedSize ;
 }
 
-//remove the space from the free pool
-void LLPrivateMemoryPool::LLMemoryChunk::removeFromFreeSpace(LLMemoryBlock* blk) 
+LLPrivateMemoryPool::LLPrivateMemoryPool(S32 type, U32 max_pool_size) :
+	mMaxPoolSize(max_pool_size),
+	mReservedPoolSize(0),
+	mAllocatedSize(0),
+	mLargeSpans(NULL),
+	mLargeCount(0),
+	mLargeSize(0),
+	mType(type)
 {
-	U16 free_idx = blk->getBufferSize() / mMinBlockSize - 1;
-	free_idx = llmin(free_idx, (U16)(mPartitionLevels - 1)) ;
-
-	if(mFreeSpaceList[free_idx] == blk)
-	{
-		mFreeSpaceList[free_idx] = blk->mNext ;
-	}
-	if(blk->mPrev)
-	{
-		blk->mPrev->mNext = blk->mNext ;
-	}
-	if(blk->mNext)
+	bool threaded = type == STATIC_THREADED || type == VOLATILE_THREADED ;
+	for(S32 i = 0 ; i <= NUM_SIZE_CLASSES ; i++)
 	{
-		blk->mNext->mPrev = blk->mPrev ;
+		mMutexp[i] = threaded ? new LLMutex() : NULL ;
 	}
-	blk->mNext = NULL ;
-	blk->mPrev = NULL ;
-	blk->mSelf = NULL ;
-
-	return ;
-}
-
-void LLPrivateMemoryPool::LLMemoryChunk::addToAvailBlockList(LLMemoryBlock* blk) 
-{
-	llassert_always(!blk->mPrev) ;
-	llassert_always(!blk->mNext) ;
 
-	U32 blk_idx = getBlockLevel(blk->getSlotSize());
+	memset(mClasses, 0, sizeof(mClasses)) ;
 
-	blk->mNext = mAvailBlockList[blk_idx] ;
-	if(blk->mNext)
+	if(!sPoolRegistryMutexp)
 	{
-		blk->mNext->mPrev = blk ;
+		sPoolRegistryMutexp = new LLMutex() ;
 	}
-	blk->mPrev = NULL ;
-	mAvailBlockList[blk_idx] = blk ;
-
-	return ;
+	sPoolRegistryMutexp->lock() ;
+	mPoolId = sNextPoolId++ ;
+	sPoolRegistry.push_back(this) ;
+	sPoolRegistryMutexp->unlock() ;
 }
 
-U32 LLPrivateMemoryPool::LLMemoryChunk::getPageIndex(char const* addr)
-{
-	return static_cast<U32>(addr - mDataBuffer) / mMinBlockSize ;
-}
-
-//for mAvailBlockList
-U32 LLPrivateMemoryPool::LLMemoryChunk::getBlockLevel(U32 size)
-{
-	llassert(size >= mMinSlotSize && size <= mMaxSlotSize) ;
-
-	//start from 0
-	return (size + mMinSlotSize - 1) / mMinSlotSize - 1 ;
-}
-
-//for mFreeSpaceList
-U16 LLPrivateMemoryPool::LLMemoryChunk::getPageLevel(U32 size)
+LLPrivateMemoryPool::~LLPrivateMemoryPool()
 {
-	//start from 0
-	U16 level = size / mMinBlockSize - 1 ;
-	if(level >= mPartitionLevels)
+	destroyPool();
+	for(S32 i = 0 ; i <= NUM_SIZE_CLASSES ; i++)
 	{
-		level = mPartitionLevels - 1 ;
+		delete mMutexp[i] ;
 	}
-	return level ;
 }
 
-//-------------------------------------------------------------------
-//class LLPrivateMemoryPool
-//--------------------------------------------------------------------
-const U32 CHUNK_SIZE = 4 << 20 ; //4 MB
-const U32 LARGE_CHUNK_SIZE = 4 * CHUNK_SIZE ; //16 MB
-LLPrivateMemoryPool::LLPrivateMemoryPool(S32 type, U32 max_pool_size) :
-	mMutexp(NULL),	
-	mReservedPoolSize(0),
-	mHashFactor(1),
-	mType(type),
-	mMaxPoolSize(max_pool_size)
+//static
+S32 LLPrivateMemoryPool::getSizeClass(U32 size)
 {
-	if(type == STATIC_THREADED || type == VOLATILE_THREADED)
+	if(size <= NUM_SMALL_CLASSES * SMALL_CLASS_STEP)
 	{
-		mMutexp = new LLMutex() ;
+		return (size - 1) / SMALL_CLASS_STEP ;
 	}
-
-	for(S32 i = 0 ; i < SUPER_ALLOCATION ; i++)
-	{
-		mChunkList[i] = NULL ;
-	}	
-	
-	mNumOfChunks = 0 ;
-}
-
-LLPrivateMemoryPool::~LLPrivateMemoryPool()
-{
-	destroyPool();
-	delete mMutexp ;
+	U32 level = highest_bit(size - 1) ;
+	return NUM_SMALL_CLASSES + ((level - 8) << 2) + (((size - 1) >> (level - 2)) & 3) ;
 }
 
 char* LLPrivateMemoryPool::allocate(U32 size)
@@ -1341,70 +930,24 @@ char* LLPrivateMemoryPool::allocate(U32 size)
 		return NULL ;
 	}
 
-	//if the asked size larger than MAX_BLOCK_SIZE, fetch from heap directly, the pool does not manage it
-	if(size >= CHUNK_SIZE)
-	{
-		return (char*)ll_aligned_malloc_16(size) ;
-	}
-
-	char* p = NULL ;
-
-	//find the appropriate chunk
-	S32 chunk_idx = getChunkIndex(size) ;
-	
-	lock() ;
-
-	LLMemoryChunk* chunk = mChunkList[chunk_idx];
-	while(chunk)
+	if(size > MAX_CLASS_SIZE)
 	{
-		if((p = chunk->allocate(size)))
-		{
-			break ;
-		}
-		chunk = chunk->mNext ;
-	}
-	
-	//fetch new memory chunk
-	if(!p)
-	{
-		if(mReservedPoolSize + CHUNK_SIZE > mMaxPoolSize)
-		{
-			chunk = mChunkList[chunk_idx];
-			while(chunk)
-			{
-				if((p = chunk->allocate(size)))
-				{
-					break ;
-				}
-				chunk = chunk->mNext ;
-			}
-		}
-		else
-		{
-			chunk = addChunk(chunk_idx) ;
-			if(chunk)
-			{
-				p = chunk->allocate(size) ;
-			}
-		}
+		return allocateLarge(size) ;
 	}
 
-	unlock() ;
-
-	if(!p) //to get memory from the private pool failed, try the heap directly
+	S32 class_index = getSizeClass(size) ;
+	ThreadCache::Magazine& magazine = ThreadCache::get().getMagazine(this, class_index) ;
+	if(!magazine.mCount)
 	{
-		static bool to_log = true ;
-		
-		if(to_log)
+		magazine.mCount = refill(class_index, magazine.mObjects, llmax(get_magazine_size(class_index) / 2, 1U)) ;
+		if(!magazine.mCount)
 		{
-			LL_WARNS() << "The memory pool overflows, now using heap directly!" << LL_ENDL ;
-			to_log = false ;
+			return allocateFromHeap(size) ;
 		}
-
-		return (char*)ll_aligned_malloc_16(size) ;
 	}
 
-	return p ;
+	mAllocatedSize += get_class_size(class_index) ;
+	return magazine.mObjects[--magazine.mCount] ;
 }
 
 void LLPrivateMemoryPool::freeMem(void* addr)
@@ -1414,399 +957,307 @@ void LLPrivateMemoryPool::freeMem(void* addr)
 		return ;
 	}
 	
-	lock() ;
-	
-	LLMemoryChunk* chunk = findChunk((char*)addr) ;
-	
-	if(!chunk)
+	Span* span = find_span(addr) ;
+	if(!span)
 	{
 		ll_aligned_free_16(addr) ; //release from heap
+		return ;
 	}
-	else
+	if(span->mPool != this)
 	{
-		chunk->freeMem(addr) ;
-
-		if(chunk->empty())
-		{
-			removeChunk(chunk) ;
-		}
+		span->mPool->freeMem(addr) ;
+		return ;
 	}
-	
-	unlock() ;
-}
-
-void LLPrivateMemoryPool::dump()
-{
-}
-
-U32 LLPrivateMemoryPool::getTotalAllocatedSize()
-{
-	U32 total_allocated = 0 ;
-
-	LLMemoryChunk* chunk ;
-	for(S32 i = 0 ; i < SUPER_ALLOCATION ; i++)
+	if(span->mClass == LARGE_CLASS)
 	{
-		chunk = mChunkList[i];
-		while(chunk)
-		{
-			total_allocated += chunk->getAllocatedSize() ;
-			chunk = chunk->mNext ;
-		}
+		freeLarge(span) ;
+		return ;
 	}
 
-	return total_allocated ;
-}
-
-void LLPrivateMemoryPool::lock()
-{
-	if(mMutexp)
+	S32 class_index = span->mClass ;
+	ThreadCache::Magazine& magazine = ThreadCache::get().getMagazine(this, class_index) ;
+	U32 capacity = get_magazine_size(class_index) ;
+	if(magazine.mCount >= capacity)
 	{
-		mMutexp->lock() ;
+		//hand the oldest half back to the spans
+		U32 count = llmax(capacity / 2, 1U) ;
+		release(class_index, magazine.mObjects, count) ;
+		magazine.mCount -= count ;
+		memmove(magazine.mObjects, magazine.mObjects + count, magazine.mCount * sizeof(char*)) ;
 	}
+	magazine.mObjects[magazine.mCount++] = (char*)addr ;
+	mAllocatedSize -= span->mObjectSize ;
 }
 
-void LLPrivateMemoryPool::unlock()
+char* LLPrivateMemoryPool::allocateFromHeap(U32 size)
 {
-	if(mMutexp)
+	static bool to_log = true ;
+	if(to_log)
 	{
-		mMutexp->unlock() ;
+		LL_WARNS() << "The memory pool overflows, now using heap directly!" << LL_ENDL ;
+		to_log = false ;
 	}
-}
-
-S32  LLPrivateMemoryPool::getChunkIndex(U32 size) 
-{
-	S32 i ;
-	for(i = 0 ; size > MAX_SLOT_SIZES[i]; i++);
-	
-	llassert_always(i < SUPER_ALLOCATION);
 
-	return i ;
+	return (char*)ll_aligned_malloc_16(size) ;
 }
 
-//destroy the entire pool
-void  LLPrivateMemoryPool::destroyPool()
+//take up to count objects of a size class from the spans, adding spans as needed.
+U32 LLPrivateMemoryPool::refill(S32 class_index, char** objects, U32 count)
 {
-	lock() ;
-
-	if(mNumOfChunks > 0)
-	{
-		LL_WARNS() << "There is some memory not freed when destroy the memory pool!" << LL_ENDL ;
-	}
+	U32 object_size = get_class_size(class_index) ;
+	SizeClass& size_class = mClasses[class_index] ;
+	U32 taken = 0 ;
 
-	mNumOfChunks = 0 ;
-	mChunkHashList.clear() ;
-	mHashFactor = 1 ;
-	for(S32 i = 0 ; i < SUPER_ALLOCATION ; i++)
+	lock(class_index) ;
+	while(taken < count)
 	{
-		mChunkList[i] = NULL ;
-	}
-
-	unlock() ;
-}
-
-bool LLPrivateMemoryPool::checkSize(U32 asked_size)
-{
-	if(mReservedPoolSize + asked_size > mMaxPoolSize)
-	{
-		LL_INFOS() << "Max pool size: " << mMaxPoolSize << LL_ENDL ;
-		LL_INFOS() << "Total reserved size: " << mReservedPoolSize + asked_size << LL_ENDL ;
-		LL_INFOS() << "Total_allocated Size: " << getTotalAllocatedSize() << LL_ENDL ;
+		Span* span = size_class.mPartial ;
+		if(!span)
+		{
+			span = size_class.mSpare ;
+			size_class.mSpare = NULL ;
+			if(!span)
+			{
+				span = addSpan(class_index, object_size, get_span_size(object_size)) ;
+				if(!span)
+				{
+					break ;
+				}
+				size_class.mSpanCount++ ;
+			}
+			link_span(size_class.mPartial, span) ;
+		}
 
-		//LL_ERRS() << "The pool is overflowing..." << LL_ENDL ;
+		while(taken < count && span->mUsed < span->mTotal)
+		{
+			char* p = span->mFreeList ;
+			if(p)
+			{
+				span->mFreeList = *(char**)p ;
+			}
+			else
+			{
+				p = span->mUnused ;
+				span->mUnused += object_size ;
+			}
+			span->mUsed++ ;
+			objects[taken++] = p ;
+		}
 
-		return false ;
+		if(span->mUsed == span->mTotal)
+		{
+			unlink_span(size_class.mPartial, span) ;
+			link_span(size_class.mFull, span) ;
+		}
 	}
+	size_class.mObjectsOut += taken ;
+	unlock(class_index) ;
 
-	return true ;
+	return taken ;
 }
 
-LLPrivateMemoryPool::LLMemoryChunk* LLPrivateMemoryPool::addChunk(S32 chunk_index)
+//give objects back to their spans; spans that become empty are returned to the OS.
+void LLPrivateMemoryPool::release(S32 class_index, char** objects, U32 count)
 {
-	U32 preferred_size ;
-	U32 overhead ;
-	if(chunk_index < LARGE_ALLOCATION)
-	{
-		preferred_size = CHUNK_SIZE ; //4MB
-		overhead = LLMemoryChunk::getMaxOverhead(preferred_size, MIN_SLOT_SIZES[chunk_index],
-			MAX_SLOT_SIZES[chunk_index], MIN_BLOCK_SIZES[chunk_index], MAX_BLOCK_SIZES[chunk_index]) ;
-	}
-	else
-	{
-		preferred_size = LARGE_CHUNK_SIZE ; //16MB
-		overhead = LLMemoryChunk::getMaxOverhead(preferred_size, MIN_SLOT_SIZES[chunk_index], 
-			MAX_SLOT_SIZES[chunk_index], MIN_BLOCK_SIZES[chunk_index], MAX_BLOCK_SIZES[chunk_index]) ;
-	}
+	SizeClass& size_class = mClasses[class_index] ;
+	bool keep_spare = mType == VOLATILE || mType == VOLATILE_THREADED ;
 
-	if(!checkSize(preferred_size + overhead))
+	lock(class_index) ;
+	for(U32 i = 0 ; i < count ; i++)
 	{
-		return NULL ;
-	}
-
-	mReservedPoolSize += preferred_size + overhead ;
+		char* p = objects[i] ;
+		Span* span = find_span(p) ;
+		llassert_always(span && span->mPool == this && span->mClass == class_index) ;
 
-	char* buffer = (char*)ll_aligned_malloc_16(preferred_size + overhead) ;
-	if(!buffer)
-	{
-		return NULL ;
-	}
-	
-	LLMemoryChunk* chunk = new (buffer) LLMemoryChunk() ;
-	chunk->init(buffer, preferred_size + overhead, MIN_SLOT_SIZES[chunk_index],
-		MAX_SLOT_SIZES[chunk_index], MIN_BLOCK_SIZES[chunk_index], MAX_BLOCK_SIZES[chunk_index]) ;
-
-	//add to the tail of the linked list
-	{
-		if(!mChunkList[chunk_index])
+		if(span->mUsed == span->mTotal)
 		{
-			mChunkList[chunk_index] = chunk ;
+			unlink_span(size_class.mFull, span) ;
+			link_span(size_class.mPartial, span) ;
 		}
-		else
+		*(char**)p = span->mFreeList ;
+		span->mFreeList = p ;
+
+		if(!--span->mUsed)
 		{
-			LLMemoryChunk* cur = mChunkList[chunk_index] ;
-			while(cur->mNext)
+			unlink_span(size_class.mPartial, span) ;
+			if(keep_spare && !size_class.mSpare && span->mSize <= MAX_SPARE_SPAN_SIZE)
+			{
+				//volatile pools come back for more soon, keep one span around.
+				span->reset() ;
+				size_class.mSpare = span ;
+			}
+			else
 			{
-				cur = cur->mNext ;
+				removeSpan(span) ;
+				size_class.mSpanCount-- ;
 			}
-			cur->mNext = chunk ;
-			chunk->mPrev = cur ;
 		}
 	}
+	size_class.mObjectsOut -= count ;
+	unlock(class_index) ;
+}
 
-	//insert into the hash table
-	addToHashTable(chunk) ;
-	
-	mNumOfChunks++;
-
-	return chunk ;
+bool LLPrivateMemoryPool::checkSize(U32 asked_size)
+{
+	return mReservedPoolSize + asked_size <= mMaxPoolSize ;
 }
 
-void LLPrivateMemoryPool::removeChunk(LLMemoryChunk* chunk) 
+LLPrivateMemoryPool::Span* LLPrivateMemoryPool::addSpan(S32 class_index, U32 object_size, U32 span_size)
 {
-	if(!chunk)
+	if(!checkSize(span_size))
 	{
-		return ;
+		return NULL ;
 	}
 
-	//remove from the linked list
-	for(S32 i = 0 ; i < SUPER_ALLOCATION ; i++)
+	char* buffer = os_allocate(span_size) ;
+	if(!buffer)
 	{
-		if(mChunkList[i] == chunk)
-		{
-			mChunkList[i] = chunk->mNext ;
-		}
+		return NULL ;
 	}
 
-	if(chunk->mPrev)
-	{
-		chunk->mPrev->mNext = chunk->mNext ;
-	}
-	if(chunk->mNext)
-	{
-		chunk->mNext->mPrev = chunk->mPrev ;
-	}
+	Span* span = new Span ;
+	span->mPool = this ;
+	span->mBuffer = buffer ;
+	span->mSize = span_size ;
+	span->mClass = class_index ;
+	span->mObjectSize = object_size ;
+	span->mTotal = span_size / object_size ;
+	span->mPrev = span->mNext = NULL ;
+	span->reset() ;
 
-	//remove from the hash table
-	removeFromHashTable(chunk) ;
-	
-	mNumOfChunks--;
-	mReservedPoolSize -= chunk->getBufferSize() ;
-	
-	//release memory
-	ll_aligned_free_16(chunk->getBuffer()) ;
-}
+	map_span(span, span) ;
+	mReservedPoolSize += span_size ;
 
-U16 LLPrivateMemoryPool::findHashKey(const char* addr)
-{
-	return (((size_t)addr) / CHUNK_SIZE) % mHashFactor ;
+	return span ;
 }
 
-LLPrivateMemoryPool::LLMemoryChunk* LLPrivateMemoryPool::findChunk(const char* addr)
+void LLPrivateMemoryPool::removeSpan(Span* span)
 {
-	U16 key = findHashKey(addr) ;	
-	if(mChunkHashList.size() <= key)
-	{
-		return NULL ;
-	}
-
-	return mChunkHashList[key].findChunk(addr) ;	
+	map_span(span, NULL) ;
+	mReservedPoolSize -= span->mSize ;
+	os_free(span->mBuffer, span->mSize) ;
+	delete span ;
 }
 
-void LLPrivateMemoryPool::addToHashTable(LLMemoryChunk* chunk) 
+char* LLPrivateMemoryPool::allocateLarge(U32 size)
 {
-	static const U16 HASH_FACTORS[] = {41, 83, 193, 317, 419, 523, 719, 997, 1523, 0xFFFF}; 
-	
-	U16 i ;
-	if(mChunkHashList.empty())
-	{
-		mHashFactor = HASH_FACTORS[0] ;
-		rehash() ;		
-	}
-
-	U16 start_key = findHashKey(chunk->getBuffer()) ;
-	U16 end_key = findHashKey(chunk->getBuffer() + chunk->getBufferSize() - 1) ;
-	bool need_rehash = false ;
-	
-	if(mChunkHashList[start_key].hasElement(chunk))
-	{
-		return; //already inserted.
-	}
-	need_rehash = mChunkHashList[start_key].add(chunk) ;
-	
-	if(start_key == end_key && !need_rehash)
+	U32 span_size = (size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1) ;
+	Span* span = addSpan(LARGE_CLASS, span_size, span_size) ;
+	if(!span)
 	{
-		return ; //done
+		return allocateFromHeap(size) ;
 	}
+	span->mUsed = 1 ;
 
-	if(!need_rehash)
-	{
-		need_rehash = mChunkHashList[end_key].add(chunk) ;
-	}
+	lock(LARGE_CLASS) ;
+	link_span(mLargeSpans, span) ;
+	mLargeCount++ ;
+	mLargeSize += span_size ;
+	unlock(LARGE_CLASS) ;
 
-	if(!need_rehash)
-	{
-		if(end_key < start_key)
-		{
-			need_rehash = fillHashTable(start_key + 1, mHashFactor, chunk) ;
-			if(!need_rehash)
-			{
-				need_rehash = fillHashTable(0, end_key, chunk) ;
-			}
-		}
-		else
-		{
-			need_rehash = fillHashTable(start_key + 1, end_key, chunk) ;
-		}
-	}
-	
-	if(need_rehash)
-	{
-		i = 0 ;
-		while(HASH_FACTORS[i] <= mHashFactor) i++;
-
-		mHashFactor = HASH_FACTORS[i] ;
-		llassert_always(mHashFactor != 0xFFFF) ;//stop point to prevent endlessly recursive calls
-
-		rehash() ;
-	}
+	mAllocatedSize += span_size ;
+	return span->mBuffer ;
 }
 
-void LLPrivateMemoryPool::removeFromHashTable(LLMemoryChunk* chunk) 
+void LLPrivateMemoryPool::freeLarge(Span* span)
 {
-	U16 start_key = findHashKey(chunk->getBuffer()) ;
-	U16 end_key = findHashKey(chunk->getBuffer() + chunk->getBufferSize() - 1) ;
-	
-	mChunkHashList[start_key].remove(chunk) ;
-	if(start_key == end_key)
-	{
-		return ; //done
-	}
+	lock(LARGE_CLASS) ;
+	unlink_span(mLargeSpans, span) ;
+	mLargeCount-- ;
+	mLargeSize -= span->mSize ;
+	unlock(LARGE_CLASS) ;
 
-	mChunkHashList[end_key].remove(chunk) ;
-	
-	if(end_key < start_key)
-	{
-		for(U16 i = start_key + 1 ; i < mHashFactor; i++)
-		{
-			mChunkHashList[i].remove(chunk) ;
-		}
-		for(U16 i = 0 ; i < end_key; i++)
-		{
-			mChunkHashList[i].remove(chunk) ;
-		}
-	}
-	else
-	{
-		for(U16 i = start_key + 1 ; i < end_key; i++)
-		{
-			mChunkHashList[i].remove(chunk) ;
-		}
-	}
+	mAllocatedSize -= span->mSize ;
+	removeSpan(span) ;
 }
 
-void LLPrivateMemoryPool::rehash()
+void LLPrivateMemoryPool::dump()
 {
-	LL_INFOS() << "new hash factor: " << mHashFactor << LL_ENDL ;
-
-	mChunkHashList.clear() ;
-	mChunkHashList.resize(mHashFactor) ;
-
-	LLMemoryChunk* chunk ;
-	for(U16 i = 0 ; i < SUPER_ALLOCATION ; i++)
-	{
-		chunk = mChunkList[i] ; 
-		while(chunk)
-		{
-			addToHashTable(chunk) ;
-			chunk = chunk->mNext ;
-		}
-	}
 }
 
-bool LLPrivateMemoryPool::fillHashTable(U16 start, U16 end, LLMemoryChunk* chunk)
+void LLPrivateMemoryPool::getStats(Stats& stats)
 {
-	for(U16 i = start; i < end; i++)
+	U32 taken = 0 ;
+	stats.mSpanCount = 0 ;
+	for(S32 i = 0 ; i < NUM_SIZE_CLASSES ; i++)
 	{
-		if(mChunkHashList[i].add(chunk))
-		{			
-			return true ;
-		}		
+		lock(i) ;
+		stats.mSpanCount += mClasses[i].mSpanCount ;
+		taken += mClasses[i].mObjectsOut * get_class_size(i) ;
+		unlock(i) ;
 	}
 
-	return false ;
+	lock(LARGE_CLASS) ;
+	stats.mSpanCount += mLargeCount ;
+	stats.mLargeCount = mLargeCount ;
+	taken += mLargeSize ;
+	unlock(LARGE_CLASS) ;
+
+	stats.mReservedSize = mReservedPoolSize ;
+	stats.mAllocatedSize = mAllocatedSize ;
+	stats.mCachedSize = taken > stats.mAllocatedSize ? taken - stats.mAllocatedSize : 0 ;
 }
 
-//--------------------------------------------------------------------
-// class LLChunkHashElement
-//--------------------------------------------------------------------
-LLPrivateMemoryPool::LLMemoryChunk* LLPrivateMemoryPool::LLChunkHashElement::findChunk(const char* addr)
+void LLPrivateMemoryPool::lock(S32 class_index)
 {
-	if(mFirst && mFirst->containsAddress(addr))
-	{
-		return mFirst ;
-	}
-	else if(mSecond && mSecond->containsAddress(addr))
+	if(mMutexp[class_index])
 	{
-		return mSecond ;
+		mMutexp[class_index]->lock() ;
 	}
-
-	return NULL ;
 }
 
-//return false if successfully inserted to the hash slot.
-bool LLPrivateMemoryPool::LLChunkHashElement::add(LLPrivateMemoryPool::LLMemoryChunk* chunk)
+void LLPrivateMemoryPool::unlock(S32 class_index)
 {
-	llassert_always(!hasElement(chunk)) ;
-
-	if(!mFirst)
-	{
-		mFirst = chunk ;
-	}
-	else if(!mSecond)
+	if(mMutexp[class_index])
 	{
-		mSecond = chunk ;
-	}
-	else
-	{
-		return true ; //failed
+		mMutexp[class_index]->unlock() ;
 	}
+}
 
-	return false ;
+//static
+LLPrivateMemoryPool* LLPrivateMemoryPool::findOwner(const void* addr)
+{
+	Span* span = find_span(addr) ;
+	return span ? span->mPool : NULL ;
 }
 
-void LLPrivateMemoryPool::LLChunkHashElement::remove(LLPrivateMemoryPool::LLMemoryChunk* chunk)
+//destroy the entire pool
+void  LLPrivateMemoryPool::destroyPool()
 {
-	if(mFirst == chunk)
+	//stop thread caches from handing objects back to this pool.
+	sPoolRegistryMutexp->lock() ;
+	sPoolRegistry.erase(std::find(sPoolRegistry.begin(), sPoolRegistry.end(), this)) ;
+	sPoolRegistryMutexp->unlock() ;
+
+	if(mAllocatedSize)
 	{
-		mFirst = NULL ;
+		LL_WARNS() << "There is some memory not freed when destroy the memory pool!" << LL_ENDL ;
 	}
-	else if(mSecond ==chunk)
+
+	for(S32 i = 0 ; i < NUM_SIZE_CLASSES ; i++)
 	{
-		mSecond = NULL ;
+		SizeClass& size_class = mClasses[i] ;
+		Span* lists[] = { size_class.mPartial, size_class.mFull, size_class.mSpare } ;
+		for(U32 j = 0 ; j < LL_ARRAY_SIZE(lists) ; j++)
+		{
+			while(lists[j])
+			{
+				Span* span = lists[j] ;
+				lists[j] = span->mNext ;
+				removeSpan(span) ;
+			}
+		}
+		memset(&size_class, 0, sizeof(SizeClass)) ;
 	}
-	else
+
+	while(mLargeSpans)
 	{
-		LL_ERRS() << "This slot does not contain this chunk!" << LL_ENDL ;
+		Span* span = mLargeSpans ;
+		mLargeSpans = span->mNext ;
+		removeSpan(span) ;
 	}
+	mLargeCount = 0 ;
+	mLargeSize = 0 ;
 }
 
 //--------------------------------------------------------------------
@@ -1940,10 +1391,12 @@ void LLPrivateMemoryPoolManager::updateStatistics()
 
 	for(U32 i = 0; i < mPoolList.size(); i++)
 	{
+		mPoolStats[i] = LLPrivateMemoryPool::Stats() ;
 		if(mPoolList[i])
 		{
-			mTotalReservedSize += mPoolList[i]->getTotalReservedSize() ;
-			mTotalAllocatedSize += mPoolList[i]->getTotalAllocatedSize() ;
+			mPoolList[i]->getStats(mPoolStats[i]) ;
+			mTotalReservedSize += mPoolStats[i].mReservedSize ;
+			mTotalAllocatedSize += mPoolStats[i].mAllocatedSize ;
 		}
 	}
 }
@@ -2011,34 +1464,24 @@ void  LLPrivateMemoryPoolManager::freeMem(LLPrivateMemoryPool* poolp, void* addr
 		if(!sPrivatePoolEnabled)
 		{
 			ll_aligned_free_16(addr) ; //private pool is disabled.
+			return ;
 		}
-		else if(!sInstance) //the private memory manager is destroyed, try the dangling list
+
+		//the owner already let go of its pool, or the memory came from the heap.
+		poolp = LLPrivateMemoryPool::findOwner(addr) ;
+		if(!poolp)
 		{
-			for(S32 i = 0 ; i < (S32)sDanglingPoolList.size(); i++)
-			{
-				if(sDanglingPoolList[i]->findChunk((char*)addr))
-				{
-					sDanglingPoolList[i]->freeMem(addr) ;
-					if(sDanglingPoolList[i]->isEmpty())
-					{
-						delete sDanglingPoolList[i] ;
-						
-						if(i < (S32)sDanglingPoolList.size() - 1)
-						{
-							sDanglingPoolList[i] = sDanglingPoolList[sDanglingPoolList.size() - 1] ;
-						}
-						sDanglingPoolList.pop_back() ;
-					}
-
-					addr = NULL ;
-					break ;
-				}
-			}		
-			llassert_always(!addr) ; //addr should be release before hitting here!
+			ll_aligned_free_16(addr) ;
+			return ;
 		}
-		else
+		poolp->freeMem(addr) ;
+
+		std::vector<LLPrivateMemoryPool*>::iterator iter = std::find(sDanglingPoolList.begin(), sDanglingPoolList.end(), poolp) ;
+		if(iter != sDanglingPoolList.end() && poolp->isEmpty())
 		{
-			LL_ERRS() << "private pool is used before initialized.!" << LL_ENDL ;
+			delete poolp ;
+			*iter = sDanglingPoolList.back() ;
+			sDanglingPoolList.pop_back() ;
 		}
 	}	
 }
@@ -34,6 +34,8 @@
 #include <stdint.h>		// uintptr_t
 #endif
 
+#include "llatomic.h"
+
 class LLMutex ;
 
 #if LL_WINDOWS && LL_DEBUG
@@ -365,122 +367,69 @@ private:
 //class LLPrivateMemoryPool defines a private memory pool for an application to use, so the application does not
 //need to access the heap directly fro each memory allocation. Throught this, the allocation speed is faster, 
 //and reduces virtaul address space gragmentation problem.
-//Note: this class is thread-safe by passing true to the constructor function. However, you do not need to do this unless
-//you are sure the memory allocation and de-allocation will happen in different threads. To make the pool thread safe
-//increases allocation and deallocation cost.
+//
+//Requests are rounded up to one of NUM_SIZE_CLASSES size classes. Each size class carves objects out of spans,
+//runs of 64 KB pages taken from the OS, and every thread keeps a small magazine of free objects per size class,
+//so that most allocations and frees touch neither a lock nor another thread's data. Spans that become empty
+//are returned to the OS. Allocations larger than MAX_CLASS_SIZE get a span of their own.
+//Note: the *_THREADED pool types only add a lock around the exchange of objects between the magazines and the
+//spans; you still do not need them unless memory is allocated and freed in different threads.
 //
 class LL_COMMON_API LLPrivateMemoryPool
 {
 	friend class LLPrivateMemoryPoolManager ;
 
 public:
-	class LL_COMMON_API LLMemoryBlock //each block is devided into slots uniformly
+	enum
 	{
-	public: 
-		LLMemoryBlock() ;
-		~LLMemoryBlock() ;
-
-		void init(char* buffer, U32 buffer_size, U32 slot_size) ;
-		void setBuffer(char* buffer, U32 buffer_size) ;
-
-		char* allocate() ;
-		void  freeMem(void* addr) ;
-
-		bool empty() {return !mAllocatedSlots;}
-		bool isFull() {return mAllocatedSlots == mTotalSlots;}
-		bool isFree() {return !mTotalSlots;}
-
-		U32  getSlotSize()const {return mSlotSize;}
-		U32  getTotalSlots()const {return mTotalSlots;}
-		U32  getBufferSize()const {return mBufferSize;}
-		char* getBuffer() const {return mBuffer;}
-
-		//debug use
-		void resetBitMap() ;
-	private:
-		char* mBuffer;
-		U32   mSlotSize ; //when the block is not initialized, it is the buffer size.
-		U32   mBufferSize ;
-		U32   mUsageBits ;
-		U8    mTotalSlots ;
-		U8    mAllocatedSlots ;
-		U8    mDummySize ; //size of extra bytes reserved for mUsageBits.
-
-	public:
-		LLMemoryBlock* mPrev ;
-		LLMemoryBlock* mNext ;
-		LLMemoryBlock* mSelf ;
-
-		struct CompareAddress
-		{
-			bool operator()(const LLMemoryBlock* const& lhs, const LLMemoryBlock* const& rhs)
-			{
-				return (size_t)lhs->getBuffer() < (size_t)rhs->getBuffer();
-			}
-		};
-	};
+		STATIC = 0 ,       //static pool(each alllocation stays for a long time) without threading support
+		VOLATILE,          //Volatile pool(each allocation stays for a very short time) without threading support
+		STATIC_THREADED,   //static pool with threading support
+		VOLATILE_THREADED, //volatile pool with threading support
+		MAX_TYPES
+	}; //pool types
 
-	class LL_COMMON_API LLMemoryChunk //is divided into memory blocks.
+	enum
 	{
-	public:
-		LLMemoryChunk() ;
-		~LLMemoryChunk() ;
+		PAGE_SHIFT = 16,
+		PAGE_SIZE = 1 << PAGE_SHIFT,   //64 KB, spans are made of whole pages
+		NUM_SIZE_CLASSES = 64,         //16 bytes to 1 MB
+		MAX_CLASS_SIZE = 1 << 20
+	};
 
-		void init(char* buffer, U32 buffer_size, U32 min_slot_size, U32 max_slot_size, U32 min_block_size, U32 max_block_size) ;
-		void setBuffer(char* buffer, U32 buffer_size) ;
+	//memory usage of a pool, see getStats()
+	struct Stats
+	{
+		Stats() : mReservedSize(0), mAllocatedSize(0), mCachedSize(0), mSpanCount(0), mLargeCount(0) {}
 
-		bool empty() ;
-		
-		char* allocate(U32 size) ;
-		void  freeMem(void* addr) ;
+		//the fraction of the reserved memory that is not in use by the application.
+		F32 getFragmentation() const ;
 
-		char* getBuffer() const {return mBuffer;}
-		U32 getBufferSize() const {return mBufferSize;}
-		U32 getAllocatedSize() const {return mAlloatedSize;}
+		U32 mReservedSize ;  //taken from the OS
+		U32 mAllocatedSize ; //handed out to the application, rounded up to the size classes
+		U32 mCachedSize ;    //free objects held in thread magazines
+		U32 mSpanCount ;
+		U32 mLargeCount ;    //allocations larger than MAX_CLASS_SIZE
+	};
 
-		bool containsAddress(const char* addr) const;
+	void  getStats(Stats& stats) ;
+	S32   getType() const {return mType; }
 
-		static U32 getMaxOverhead(U32 data_buffer_size, U32 min_slot_size, 
-													   U32 max_slot_size, U32 min_block_size, U32 max_block_size) ;
-	
-		void dump() ;
-
-	private:
-		U32 getPageIndex(char const* addr) ;
-		U32 getBlockLevel(U32 size) ;
-		U16 getPageLevel(U32 size) ;
-		LLMemoryBlock* addBlock(U32 blk_idx) ;
-		void popAvailBlockList(U32 blk_idx) ;
-		void addToFreeSpace(LLMemoryBlock* blk) ;
-		void removeFromFreeSpace(LLMemoryBlock* blk) ;
-		void removeBlock(LLMemoryBlock* blk) ;
-		void addToAvailBlockList(LLMemoryBlock* blk) ;
-		U32  calcBlockSize(U32 slot_size);
-		LLMemoryBlock* createNewBlock(LLMemoryBlock* blk, U32 buffer_size, U32 slot_size, U32 blk_idx) ;
-
-	private:
-		LLMemoryBlock** mAvailBlockList ;//256 by mMinSlotSize
-		LLMemoryBlock** mFreeSpaceList;
-		LLMemoryBlock*  mBlocks ; //index of blocks by address.
-		
-		char* mBuffer ;
-		U32   mBufferSize ;
-		char* mDataBuffer ;
-		char* mMetaBuffer ;
-		U32   mMinBlockSize ;
-		U32   mMinSlotSize ;
-		U32   mMaxSlotSize ;
-		U32   mAlloatedSize ;
-		U16   mBlockLevels;
-		U16   mPartitionLevels;
-
-	public:
-		//form a linked list
-		LLMemoryChunk* mNext ;
-		LLMemoryChunk* mPrev ;
-	} ;
+	//implementation details, see llmemory.cpp
+	struct Span ;
+	class ThreadCache ;
 
 private:
+
+	struct SizeClass
+	{
+		Span* mPartial ;     //spans with free objects
+		Span* mFull ;
+		Span* mSpare ;       //one empty span kept by volatile pools
+		U32   mSpanCount ;
+		U32   mObjectsOut ;  //objects taken from the spans, including those in magazines
+	};
+
 	LLPrivateMemoryPool(S32 type, U32 max_pool_size) ;
 	~LLPrivateMemoryPool() ;
 
@@ -488,74 +437,40 @@ private:
 	void  freeMem(void* addr) ;
 	
 	void  dump() ;
-	U32   getTotalAllocatedSize() ;
+	U32   getTotalAllocatedSize() {return mAllocatedSize;}
 	U32   getTotalReservedSize() {return mReservedPoolSize;}
-	S32   getType() const {return mType; }
-	bool  isEmpty() const {return !mNumOfChunks; }
+	bool  isEmpty() const {return !mAllocatedSize; }
 
 private:
-	void lock() ;
-	void unlock() ;	
-	S32 getChunkIndex(U32 size) ;
-	LLMemoryChunk*  addChunk(S32 chunk_index) ;
+	void lock(S32 class_index) ;
+	void unlock(S32 class_index) ;	
+	U32  refill(S32 class_index, char** objects, U32 count) ;
+	void release(S32 class_index, char** objects, U32 count) ;
 	bool checkSize(U32 asked_size) ;
-	void removeChunk(LLMemoryChunk* chunk) ;
-	U16  findHashKey(const char* addr);
-	void addToHashTable(LLMemoryChunk* chunk) ;
-	void removeFromHashTable(LLMemoryChunk* chunk) ;
-	void rehash() ;
-	bool fillHashTable(U16 start, U16 end, LLMemoryChunk* chunk) ;
-	LLMemoryChunk* findChunk(const char* addr) ;
+	Span* addSpan(S32 class_index, U32 object_size, U32 span_size) ;
+	void removeSpan(Span* span) ;
+	char* allocateLarge(U32 size) ;
+	void  freeLarge(Span* span) ;
+	char* allocateFromHeap(U32 size) ;
 
 	void destroyPool() ;
 
-public:
-	enum
-	{
-		SMALL_ALLOCATION = 0, //from 8 bytes to 2KB(exclusive), page size 2KB, max chunk size is 4MB.
-		MEDIUM_ALLOCATION,    //from 2KB to 512KB(exclusive), page size 32KB, max chunk size 4MB
-		LARGE_ALLOCATION,     //from 512KB to 4MB(inclusive), page size 64KB, max chunk size 16MB
-		SUPER_ALLOCATION      //allocation larger than 4MB.
-	};
-
-	enum
-	{
-		STATIC = 0 ,       //static pool(each alllocation stays for a long time) without threading support
-		VOLATILE,          //Volatile pool(each allocation stays for a very short time) without threading support
-		STATIC_THREADED,   //static pool with threading support
-		VOLATILE_THREADED, //volatile pool with threading support
-		MAX_TYPES
-	}; //pool types
+	static S32 getSizeClass(U32 size) ;
+	static LLPrivateMemoryPool* findOwner(const void* addr) ;
 
 private:
-	LLMutex* mMutexp ;
+	LLMutex* mMutexp[NUM_SIZE_CLASSES + 1] ; //one per size class plus one for large allocations, threaded pools only
 	U32  mMaxPoolSize;
-	U32  mReservedPoolSize ;	
+	LLAtomicU32 mReservedPoolSize ;
+	LLAtomicU32 mAllocatedSize ;
 
-	LLMemoryChunk* mChunkList[SUPER_ALLOCATION] ; //all memory chunks reserved by this pool, sorted by address	
-	U16 mNumOfChunks ;
-	U16 mHashFactor ;
+	SizeClass mClasses[NUM_SIZE_CLASSES] ;
+	Span* mLargeSpans ;
+	U32   mLargeCount ;
+	U32   mLargeSize ;
 
 	S32 mType ;
-
-	class LLChunkHashElement
-	{
-	public:
-		LLChunkHashElement() {mFirst = NULL ; mSecond = NULL ;}
-
-		bool add(LLMemoryChunk* chunk) ;
-		void remove(LLMemoryChunk* chunk) ;
-		LLMemoryChunk* findChunk(const char* addr) ;
-
-		bool empty() {return !mFirst && !mSecond; }
-		bool full()  {return mFirst && mSecond; }
-		bool hasElement(LLMemoryChunk* chunk) {return mFirst == chunk || mSecond == chunk;}
-
-	private:
-		LLMemoryChunk* mFirst ;
-		LLMemoryChunk* mSecond ;
-	};
-	std::vector<LLChunkHashElement> mChunkHashList ;
+	U32 mPoolId ; //unique for the lifetime of the process, lets thread caches detect pools that are gone
 };
 
 class LL_COMMON_API LLPrivateMemoryPoolManager
@@ -568,6 +483,7 @@ public:
 	static LLPrivateMemoryPoolManager* getInstance() ;
 	static void initClass(BOOL enabled, U32 pool_size) ;
 	static void destroyClass() ;
+	static BOOL isEnabled() {return sPrivatePoolEnabled;}
 
 	LLPrivateMemoryPool* newPool(S32 type) ;
 	void deletePool(LLPrivateMemoryPool* pool) ;
@@ -585,6 +501,7 @@ public:
 
 	U32 mTotalReservedSize ;
 	U32 mTotalAllocatedSize ;
+	LLPrivateMemoryPool::Stats mPoolStats[LLPrivateMemoryPool::MAX_TYPES] ; //empty for pools that do not exist
 
 public:
 #if __DEBUG_PRIVATE_MEM__
@@ -26,6 +26,7 @@
 #include "linden_common.h"
 #include "llqueuedthread.h"
 
+#include "llfasttimer.h"
 #include "llstl.h"
 #include "lltimer.h"	// ms_sleep()
 
@@ -406,6 +407,8 @@ bool LLQueuedThread::check()
 //============================================================================
 // Runs on its OWN thread
 
+static LLFastTimer::DeclareTimer FTM_PROCESS_QUEUED_REQUEST("Queued Thread Request");
+
 S32 LLQueuedThread::processNextRequest()
 {
 	QueuedRequest *req;
@@ -481,6 +484,7 @@ S32 LLQueuedThread::processNextRequest()
 	if (req)
 	{
 		// process request
+		LLFastTimer t(FTM_PROCESS_QUEUED_REQUEST);
 		bool complete = req->processRequest();
 
 		if (complete)
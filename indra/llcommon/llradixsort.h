@@ -0,0 +1,120 @@
+/**
+ * @file llradixsort.h
+ * @brief Stable radix sort on 64 bit keys.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLRADIXSORT_H
+#define LL_LLRADIXSORT_H
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// One element to sort: its key and whatever the key stands for.
+template <class T>
+struct LLRadixSortEntry
+{
+	U64 mKey;
+	T mValue;
+};
+
+// Maps a float to an unsigned integer that sorts the same way, so that it
+// can be packed into a sort key.
+inline U32 ll_float_sort_key(F32 value)
+{
+	U32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+}
+
+/**
+ * @brief Sorts entries by ascending key; entries with equal keys keep their order.
+ *
+ * Least significant byte first, one pass over the entries per byte. Bytes
+ * that are the same in every key are skipped, so keys that only use a few
+ * of their bits only cost a few passes. scratch must hold count entries.
+ */
+template <class T>
+void ll_radix_sort(LLRadixSortEntry<T>* entries, LLRadixSortEntry<T>* scratch, U32 count)
+{
+	if (count < 2)
+	{
+		return;
+	}
+
+	// Count all eight digits in one read of the keys.
+	U32 histogram[8][256];
+	memset(histogram, 0, sizeof(histogram));
+	for (U32 i = 0; i < count; ++i)
+	{
+		U64 key = entries[i].mKey;
+		for (U32 digit = 0; digit < 8; ++digit)
+		{
+			++histogram[digit][(key >> (digit * 8)) & 0xFF];
+		}
+	}
+
+	LLRadixSortEntry<T>* src = entries;
+	LLRadixSortEntry<T>* dst = scratch;
+	for (U32 digit = 0; digit < 8; ++digit)
+	{
+		const U32 shift = digit * 8;
+		U32* offsets = histogram[digit];
+		if (offsets[(src[0].mKey >> shift) & 0xFF] == count)
+		{ //every key has this digit
+			continue;
+		}
+
+		U32 sum = 0;
+		for (U32 b = 0; b < 256; ++b)
+		{
+			U32 bucket = offsets[b];
+			offsets[b] = sum;
+			sum += bucket;
+		}
+
+		for (U32 i = 0; i < count; ++i)
+		{
+			dst[offsets[(src[i].mKey >> shift) & 0xFF]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+
+	if (src != entries)
+	{
+		std::copy(src, src + count, entries);
+	}
+}
+
+template <class T>
+void ll_radix_sort(std::vector<LLRadixSortEntry<T> >& entries, std::vector<LLRadixSortEntry<T> >& scratch)
+{
+	if (!entries.empty())
+	{
+		scratch.resize(entries.size());
+		ll_radix_sort(&entries[0], &scratch[0], (U32)entries.size());
+	}
+}
+
+#endif // LL_LLRADIXSORT_H
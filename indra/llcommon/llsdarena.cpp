@@ -0,0 +1,707 @@
+/**
+ * @file llsdarena.cpp
+ * @brief Arena allocated, read-only LLSD representation for parsed payloads.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llsdarena.h"
+
+#include <algorithm>
+
+// Maps of at most this many entries are searched linearly by interned
+// key pointer, larger ones are binary searched.
+static const U32 LINEAR_MAP_SEARCH_MAX = 8;
+
+// Initial number of slots in the key intern table.
+static const size_t MIN_KEY_TABLE_SIZE = 64;
+
+namespace
+{
+	struct MapEntryLess
+	{
+		bool operator()(const LLSDArenaValue::MapEntry& lhs, const LLSDArenaValue::MapEntry& rhs) const
+		{
+			return strcmp(lhs.first, rhs.first) < 0;
+		}
+	};
+}
+
+/**
+ * LLSDArenaValue
+ */
+
+// static
+const LLSDArenaValue& LLSDArenaValue::undefined()
+{
+	static const LLSDArenaValue sUndefined;
+	return sUndefined;
+}
+
+LLSD::Boolean LLSDArenaValue::asBoolean() const
+{
+	switch (mType)
+	{
+		case LLSD::TypeBoolean:	return mData.mBoolean;
+		case LLSD::TypeInteger:	return mData.mInteger != 0;
+		case LLSD::TypeReal:	return mData.mReal != 0.0;
+		case LLSD::TypeUndefined:	return false;
+		default:				return toLLSD().asBoolean();
+	}
+}
+
+LLSD::Integer LLSDArenaValue::asInteger() const
+{
+	switch (mType)
+	{
+		case LLSD::TypeInteger:	return mData.mInteger;
+		case LLSD::TypeBoolean:	return mData.mBoolean ? 1 : 0;
+		case LLSD::TypeUndefined:	return 0;
+		default:				return toLLSD().asInteger();
+	}
+}
+
+LLSD::Real LLSDArenaValue::asReal() const
+{
+	switch (mType)
+	{
+		case LLSD::TypeReal:	return mData.mReal;
+		case LLSD::TypeInteger:	return (LLSD::Real)mData.mInteger;
+		case LLSD::TypeBoolean:	return mData.mBoolean ? 1.0 : 0.0;
+		case LLSD::TypeUndefined:	return 0.0;
+		default:				return toLLSD().asReal();
+	}
+}
+
+LLSD::String LLSDArenaValue::asString() const
+{
+	switch (mType)
+	{
+		case LLSD::TypeString:
+		case LLSD::TypeURI:
+			return LLSD::String(mData.mBuffer.mPtr, mData.mBuffer.mSize);
+		case LLSD::TypeUndefined:
+			return LLSD::String();
+		default:
+			return toLLSD().asString();
+	}
+}
+
+LLSD::UUID LLSDArenaValue::asUUID() const
+{
+	switch (mType)
+	{
+		case LLSD::TypeUUID:
+		{
+			LLUUID id;
+			memcpy(id.mData, mData.mUUID, UUID_BYTES);		/* Flawfinder: ignore */
+			return id;
+		}
+		case LLSD::TypeUndefined:
+			return LLUUID::null;
+		default:
+			return toLLSD().asUUID();
+	}
+}
+
+LLSD::Date LLSDArenaValue::asDate() const
+{
+	if (mType == LLSD::TypeDate)
+	{
+		return LLDate(mData.mReal);
+	}
+	return toLLSD().asDate();
+}
+
+LLSD::URI LLSDArenaValue::asURI() const
+{
+	if (mType == LLSD::TypeURI)
+	{
+		return LLURI(LLSD::String(mData.mBuffer.mPtr, mData.mBuffer.mSize));
+	}
+	return toLLSD().asURI();
+}
+
+LLSD::Binary LLSDArenaValue::asBinary() const
+{
+	if (mType == LLSD::TypeBinary)
+	{
+		const U8* begin = (const U8*)mData.mBuffer.mPtr;
+		return LLSD::Binary(begin, begin + mData.mBuffer.mSize);
+	}
+	return toLLSD().asBinary();
+}
+
+const char* LLSDArenaValue::data() const
+{
+	switch (mType)
+	{
+		case LLSD::TypeString:
+		case LLSD::TypeURI:
+		case LLSD::TypeBinary:
+			return mData.mBuffer.mPtr;
+		default:
+			return NULL;
+	}
+}
+
+S32 LLSDArenaValue::size() const
+{
+	switch (mType)
+	{
+		case LLSD::TypeMap:		return (S32)mData.mMap.mSize;
+		case LLSD::TypeArray:	return (S32)mData.mArray.mSize;
+		default:				return 0;
+	}
+}
+
+const LLSDArenaValue::MapEntry* LLSDArenaValue::find(const char* key, bool interned) const
+{
+	if (mType != LLSD::TypeMap || !key)
+	{
+		return NULL;
+	}
+	const MapEntry* begin = mData.mMap.mPtr;
+	const MapEntry* end = begin + mData.mMap.mSize;
+	if (mData.mMap.mSize <= LINEAR_MAP_SEARCH_MAX)
+	{
+		for (const MapEntry* entry = begin; entry != end; ++entry)
+		{
+			if (interned ? entry->first == key : strcmp(entry->first, key) == 0)
+			{
+				return entry;
+			}
+		}
+		return NULL;
+	}
+	MapEntry probe;
+	probe.first = key;
+	const MapEntry* found = std::lower_bound(begin, end, probe, MapEntryLess());
+	if (found != end && (found->first == key || strcmp(found->first, key) == 0))
+	{
+		return found;
+	}
+	return NULL;
+}
+
+bool LLSDArenaValue::has(const char* key) const
+{
+	return find(key, false) != NULL;
+}
+
+const LLSDArenaValue& LLSDArenaValue::get(const char* key) const
+{
+	const MapEntry* entry = find(key, false);
+	return entry ? entry->second : undefined();
+}
+
+const LLSDArenaValue& LLSDArenaValue::getInterned(const char* key) const
+{
+	const MapEntry* entry = find(key, true);
+	return entry ? entry->second : undefined();
+}
+
+const LLSDArenaValue& LLSDArenaValue::get(S32 index) const
+{
+	if (mType != LLSD::TypeArray || index < 0 || (U32)index >= mData.mArray.mSize)
+	{
+		return undefined();
+	}
+	return mData.mArray.mPtr[index];
+}
+
+LLSDArenaValue::map_const_iterator LLSDArenaValue::beginMap() const
+{
+	return mType == LLSD::TypeMap ? mData.mMap.mPtr : NULL;
+}
+
+LLSDArenaValue::map_const_iterator LLSDArenaValue::endMap() const
+{
+	return mType == LLSD::TypeMap ? mData.mMap.mPtr + mData.mMap.mSize : NULL;
+}
+
+LLSDArenaValue::array_const_iterator LLSDArenaValue::beginArray() const
+{
+	return mType == LLSD::TypeArray ? mData.mArray.mPtr : NULL;
+}
+
+LLSDArenaValue::array_const_iterator LLSDArenaValue::endArray() const
+{
+	return mType == LLSD::TypeArray ? mData.mArray.mPtr + mData.mArray.mSize : NULL;
+}
+
+LLSD LLSDArenaValue::toLLSD() const
+{
+	switch (mType)
+	{
+		case LLSD::TypeBoolean:	return LLSD(mData.mBoolean);
+		case LLSD::TypeInteger:	return LLSD(mData.mInteger);
+		case LLSD::TypeReal:	return LLSD(mData.mReal);
+		case LLSD::TypeString:	return LLSD(LLSD::String(mData.mBuffer.mPtr, mData.mBuffer.mSize));
+		case LLSD::TypeUUID:	return LLSD(asUUID());
+		case LLSD::TypeDate:	return LLSD(LLDate(mData.mReal));
+		case LLSD::TypeURI:		return LLSD(asURI());
+		case LLSD::TypeBinary:	return LLSD(asBinary());
+		case LLSD::TypeMap:
+		{
+			LLSD map = LLSD::emptyMap();
+			for (map_const_iterator it = beginMap(); it != endMap(); ++it)
+			{
+				map.insert(it->first, it->second.toLLSD());
+			}
+			return map;
+		}
+		case LLSD::TypeArray:
+		{
+			LLSD array = LLSD::emptyArray();
+			for (array_const_iterator it = beginArray(); it != endArray(); ++it)
+			{
+				array.append(it->toLLSD());
+			}
+			return array;
+		}
+		default:
+			return LLSD();
+	}
+}
+
+/**
+ * LLSDArena
+ */
+
+LLSDArena::LLSDArena(U32 block_size)
+	: mBlocks(NULL),
+	  mBlockSize(block_size),
+	  mBytesUsed(0),
+	  mBytesReserved(0),
+	  mRoot(NULL),
+	  mKeyCount(0)
+{
+}
+
+// virtual
+LLSDArena::~LLSDArena()
+{
+	while (mBlocks)
+	{
+		Block* next = mBlocks->mNext;
+		free(mBlocks);
+		mBlocks = next;
+	}
+}
+
+LLSDArena::Block* LLSDArena::newBlock(size_t min_size)
+{
+	size_t size = llmax(min_size, (size_t)mBlockSize);
+	Block* block = (Block*)malloc(sizeof(Block) + size);
+	if (!block)
+	{
+		LL_ERRS() << "Out of memory allocating LLSD arena block of " << size << " bytes" << LL_ENDL;
+	}
+	block->mSize = size;
+	block->mUsed = 0;
+	block->mNext = mBlocks;
+	mBlocks = block;
+	mBytesReserved += size;
+	return block;
+}
+
+void* LLSDArena::allocate(size_t size, size_t alignment)
+{
+	Block* block = mBlocks;
+	if (block)
+	{
+		size_t offset = (block->mUsed + alignment - 1) & ~(alignment - 1);
+		if (offset + size <= block->mSize)
+		{
+			block->mUsed = offset + size;
+			mBytesUsed += size;
+			return (char*)(block + 1) + offset;
+		}
+	}
+	// Oversized requests get a block of their own; the header keeps the
+	// payload aligned to at least sizeof(F64).
+	block = newBlock(size + alignment);
+	size_t offset = (alignment - ((size_t)(block + 1) & (alignment - 1))) & (alignment - 1);
+	block->mUsed = offset + size;
+	mBytesUsed += size;
+	return (char*)(block + 1) + offset;
+}
+
+const char* LLSDArena::copyString(const char* str, size_t len)
+{
+	char* copy = (char*)allocate(len + 1, 1);
+	if (len)
+	{
+		memcpy(copy, str, len);		/* Flawfinder: ignore */
+	}
+	copy[len] = '\0';
+	return copy;
+}
+
+// static
+U32 LLSDArena::hashKey(const char* key, size_t len)
+{
+	// FNV-1a
+	U32 hash = 2166136261U;
+	for (size_t i = 0; i < len; ++i)
+	{
+		hash ^= (U8)key[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+const char* LLSDArena::findKey(const char* key, size_t len) const
+{
+	if (mKeys.empty())
+	{
+		return NULL;
+	}
+	U32 hash = hashKey(key, len);
+	U32 mask = (U32)mKeys.size() - 1;
+	for (U32 slot = hash & mask;; slot = (slot + 1) & mask)
+	{
+		const Key& entry = mKeys[slot];
+		if (!entry.mStr)
+		{
+			return NULL;
+		}
+		if (entry.mHash == hash && entry.mLen == len && memcmp(entry.mStr, key, len) == 0)
+		{
+			return entry.mStr;
+		}
+	}
+}
+
+const char* LLSDArena::internKey(const char* key, size_t len)
+{
+	if ((mKeyCount + 1) * 2 > mKeys.size())
+	{
+		growKeyTable();
+	}
+	U32 hash = hashKey(key, len);
+	U32 mask = (U32)mKeys.size() - 1;
+	U32 slot = hash & mask;
+	for (;; slot = (slot + 1) & mask)
+	{
+		Key& entry = mKeys[slot];
+		if (!entry.mStr)
+		{
+			break;
+		}
+		if (entry.mHash == hash && entry.mLen == len && memcmp(entry.mStr, key, len) == 0)
+		{
+			return entry.mStr;
+		}
+	}
+	Key& entry = mKeys[slot];
+	entry.mStr = copyString(key, len);
+	entry.mLen = (U32)len;
+	entry.mHash = hash;
+	++mKeyCount;
+	return entry.mStr;
+}
+
+void LLSDArena::growKeyTable()
+{
+	std::vector<Key> old_keys;
+	old_keys.swap(mKeys);
+	Key empty = { NULL, 0, 0 };
+	mKeys.resize(llmax(old_keys.size() * 2, MIN_KEY_TABLE_SIZE), empty);
+	U32 mask = (U32)mKeys.size() - 1;
+	for (std::vector<Key>::const_iterator it = old_keys.begin(); it != old_keys.end(); ++it)
+	{
+		if (it->mStr)
+		{
+			U32 slot = it->mHash & mask;
+			while (mKeys[slot].mStr)
+			{
+				slot = (slot + 1) & mask;
+			}
+			mKeys[slot] = *it;
+		}
+	}
+}
+
+void LLSDArena::clear()
+{
+	// Keep the oldest block around, it is the one that was sized for
+	// typical use.
+	Block* keep = NULL;
+	while (mBlocks)
+	{
+		Block* next = mBlocks->mNext;
+		if (!next)
+		{
+			keep = mBlocks;
+			break;
+		}
+		free(mBlocks);
+		mBlocks = next;
+	}
+	mBlocks = keep;
+	mBytesReserved = 0;
+	if (keep)
+	{
+		keep->mUsed = 0;
+		mBytesReserved = keep->mSize;
+	}
+	mBytesUsed = 0;
+	mRoot = NULL;
+	mKeys.clear();
+	mKeyCount = 0;
+}
+
+/**
+ * LLSDArenaBuilder
+ */
+
+LLSDArenaBuilder::LLSDArenaBuilder(LLSDArena& arena, bool last_key_wins)
+	: mArena(arena),
+	  mLastKeyWins(last_key_wins),
+	  mPendingKey(NULL),
+	  mRootCount(0),
+	  mFailed(false)
+{
+}
+
+bool LLSDArenaBuilder::inMap() const
+{
+	return !mFrames.empty() && mFrames.back().mType == LLSD::TypeMap;
+}
+
+bool LLSDArenaBuilder::inArray() const
+{
+	return !mFrames.empty() && mFrames.back().mType == LLSD::TypeArray;
+}
+
+void LLSDArenaBuilder::push(const LLSDArenaValue& value)
+{
+	if (mFrames.empty())
+	{
+		++mRootCount;
+	}
+	else if (mFrames.back().mType == LLSD::TypeMap)
+	{
+		if (!mPendingKey)
+		{
+			mFailed = true;
+			return;
+		}
+	}
+	mValues.push_back(value);
+	mValueKeys.push_back(mPendingKey);
+	mPendingKey = NULL;
+}
+
+void LLSDArenaBuilder::key(const char* key, size_t len)
+{
+	if (!inMap())
+	{
+		mFailed = true;
+		return;
+	}
+	mPendingKey = mArena.internKey(key, len);
+}
+
+void LLSDArenaBuilder::beginContainer(LLSD::Type type)
+{
+	// The container itself is pushed as a placeholder so that the key it
+	// is stored under stays with it; endMap/endArray fill it in.
+	LLSDArenaValue placeholder;
+	placeholder.mType = type;
+	push(placeholder);
+	if (!mFailed)
+	{
+		Frame frame;
+		frame.mType = type;
+		frame.mStart = (U32)mValues.size();
+		mFrames.push_back(frame);
+	}
+}
+
+void LLSDArenaBuilder::beginMap()
+{
+	beginContainer(LLSD::TypeMap);
+}
+
+void LLSDArenaBuilder::beginArray()
+{
+	beginContainer(LLSD::TypeArray);
+}
+
+void LLSDArenaBuilder::endMap()
+{
+	if (!inMap())
+	{
+		mFailed = true;
+		return;
+	}
+	U32 start = mFrames.back().mStart;
+	mFrames.pop_back();
+	U32 count = (U32)mValues.size() - start;
+
+	LLSDArenaValue::MapEntry* entries = NULL;
+	if (count)
+	{
+		entries = (LLSDArenaValue::MapEntry*)mArena.allocate(count * sizeof(LLSDArenaValue::MapEntry));
+		for (U32 i = 0; i < count; ++i)
+		{
+			entries[i].first = mValueKeys[start + i];
+			entries[i].second = mValues[start + i];
+		}
+		std::stable_sort(entries, entries + count, MapEntryLess());
+		// Duplicate keys: the sort is stable, so the first or last entry of
+		// a run is the first or last value given. Interned keys compare
+		// equal by pointer.
+		U32 out = 0;
+		for (U32 i = 0; i < count; ++i)
+		{
+			if (!out || entries[out - 1].first != entries[i].first)
+			{
+				entries[out++] = entries[i];
+			}
+			else if (mLastKeyWins)
+			{
+				entries[out - 1] = entries[i];
+			}
+		}
+		count = out;
+	}
+	mValues.resize(start);
+	mValueKeys.resize(start);
+
+	LLSDArenaValue& map = mValues.back();
+	map.mData.mMap.mPtr = entries;
+	map.mData.mMap.mSize = count;
+}
+
+void LLSDArenaBuilder::endArray()
+{
+	if (!inArray())
+	{
+		mFailed = true;
+		return;
+	}
+	U32 start = mFrames.back().mStart;
+	mFrames.pop_back();
+	U32 count = (U32)mValues.size() - start;
+
+	LLSDArenaValue* elements = NULL;
+	if (count)
+	{
+		elements = (LLSDArenaValue*)mArena.allocate(count * sizeof(LLSDArenaValue));
+		std::copy(mValues.begin() + start, mValues.end(), elements);
+	}
+	mValues.resize(start);
+	mValueKeys.resize(start);
+
+	LLSDArenaValue& array = mValues.back();
+	array.mData.mArray.mPtr = elements;
+	array.mData.mArray.mSize = count;
+}
+
+void LLSDArenaBuilder::undefinedValue()
+{
+	push(LLSDArenaValue());
+}
+
+void LLSDArenaBuilder::booleanValue(LLSD::Boolean value)
+{
+	LLSDArenaValue node;
+	node.mType = LLSD::TypeBoolean;
+	node.mData.mBoolean = value;
+	push(node);
+}
+
+void LLSDArenaBuilder::integerValue(LLSD::Integer value)
+{
+	LLSDArenaValue node;
+	node.mType = LLSD::TypeInteger;
+	node.mData.mInteger = value;
+	push(node);
+}
+
+void LLSDArenaBuilder::realValue(LLSD::Real value)
+{
+	LLSDArenaValue node;
+	node.mType = LLSD::TypeReal;
+	node.mData.mReal = value;
+	push(node);
+}
+
+void LLSDArenaBuilder::uuidValue(const LLUUID& value)
+{
+	LLSDArenaValue node;
+	node.mType = LLSD::TypeUUID;
+	memcpy(node.mData.mUUID, value.mData, UUID_BYTES);		/* Flawfinder: ignore */
+	push(node);
+}
+
+void LLSDArenaBuilder::dateValue(const LLDate& value)
+{
+	LLSDArenaValue node;
+	node.mType = LLSD::TypeDate;
+	node.mData.mReal = value.secondsSinceEpoch();
+	push(node);
+}
+
+void LLSDArenaBuilder::bufferValue(LLSD::Type type, const char* value, size_t len)
+{
+	LLSDArenaValue node;
+	node.mType = type;
+	node.mData.mBuffer.mPtr = mArena.copyString(value, len);
+	node.mData.mBuffer.mSize = (U32)len;
+	push(node);
+}
+
+void LLSDArenaBuilder::stringValue(const char* value, size_t len)
+{
+	bufferValue(LLSD::TypeString, value, len);
+}
+
+void LLSDArenaBuilder::uriValue(const char* value, size_t len)
+{
+	bufferValue(LLSD::TypeURI, value, len);
+}
+
+void LLSDArenaBuilder::binaryValue(const U8* value, size_t len)
+{
+	bufferValue(LLSD::TypeBinary, (const char*)value, len);
+}
+
+bool LLSDArenaBuilder::finish()
+{
+	if (mFailed || !mFrames.empty() || mRootCount != 1 || mValues.size() != 1)
+	{
+		return false;
+	}
+	LLSDArenaValue* root = (LLSDArenaValue*)mArena.allocate(sizeof(LLSDArenaValue));
+	*root = mValues.back();
+	mValues.clear();
+	mValueKeys.clear();
+	mArena.setRoot(root);
+	return true;
+}
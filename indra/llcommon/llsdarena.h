@@ -0,0 +1,373 @@
+/**
+ * @file llsdarena.h
+ * @brief Arena allocated, read-only LLSD representation for parsed payloads.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSDARENA_H
+#define LL_LLSDARENA_H
+
+#include <string>
+#include <vector>
+
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "llsd.h"
+#include "llsdparsehandler.h"
+
+/**
+	LLSDArena and LLSDArenaValue provide a read-only, LLSD compatible view
+	of a parsed document in which every node, string and map key lives in
+	a single arena.
+
+	LLSD allocates a reference counted Impl per map entry, array element and
+	string. Large capability responses (inventory fetches, event poll
+	messages, mesh headers) create hundreds of thousands of them, and
+	tearing the tree down again walks every one. An arena document is built
+	in one pass by the parser, releases all of its memory by freeing a
+	handful of blocks, and interns map keys so that each distinct key is
+	stored once per document and can be matched by pointer.
+
+	Typical use:
+
+		LLPointer<LLSDArena> doc = new LLSDArena;
+		if (LLSDSerialize::fromBinary(*doc, istr, max_bytes) > 0)
+		{
+			const LLSDArenaValue& root = doc->root();
+			const LLSDArenaValue& folders = root["folders"];
+			for (S32 i = 0; i < folders.size(); ++i)
+			{
+				LLUUID id = folders[i]["folder_id"].asUUID();
+				...
+			}
+		}
+
+	Values are only valid for as long as the arena that owns them is
+	alive. Use toLLSD() to make a mutable, independent copy of a subtree.
+*/
+
+class LLSDArena;
+
+/**
+ * @class LLSDArenaValue
+ * @brief Immutable LLSD node stored in an LLSDArena.
+ *
+ * The accessors mirror those of LLSD. Conversions between types that
+ * are not stored natively fall back to LLSD's own conversion rules, so
+ * asString() of an integer gives the same result as it does for LLSD.
+ */
+class LL_COMMON_API LLSDArenaValue
+{
+public:
+	struct MapEntry;
+
+	typedef const MapEntry* map_const_iterator;
+	typedef const LLSDArenaValue* array_const_iterator;
+
+	LLSDArenaValue() : mType(LLSD::TypeUndefined) { mData.mBuffer.mPtr = NULL; mData.mBuffer.mSize = 0; }
+
+	LLSD::Type type() const				{ return (LLSD::Type)mType; }
+
+	bool isUndefined() const			{ return mType == LLSD::TypeUndefined; }
+	bool isDefined() const				{ return mType != LLSD::TypeUndefined; }
+	bool isMap() const					{ return mType == LLSD::TypeMap; }
+	bool isArray() const				{ return mType == LLSD::TypeArray; }
+	bool isBoolean() const				{ return mType == LLSD::TypeBoolean; }
+	bool isInteger() const				{ return mType == LLSD::TypeInteger; }
+	bool isReal() const					{ return mType == LLSD::TypeReal; }
+	bool isString() const				{ return mType == LLSD::TypeString; }
+	bool isUUID() const					{ return mType == LLSD::TypeUUID; }
+	bool isDate() const					{ return mType == LLSD::TypeDate; }
+	bool isURI() const					{ return mType == LLSD::TypeURI; }
+	bool isBinary() const				{ return mType == LLSD::TypeBinary; }
+
+	/** @name Scalar Accessors */
+	//@{
+	LLSD::Boolean	asBoolean() const;
+	LLSD::Integer	asInteger() const;
+	LLSD::Real		asReal() const;
+	LLSD::String	asString() const;
+	LLSD::UUID		asUUID() const;
+	LLSD::Date		asDate() const;
+	LLSD::URI		asURI() const;
+	LLSD::Binary	asBinary() const;
+
+	/**
+	 * @brief Raw access to string, URI and binary data without a copy.
+	 *
+	 * The data is NUL terminated for strings and URIs. Returns NULL for
+	 * any other type.
+	 */
+	const char* data() const;
+	//@}
+
+	/** @name Container Accessors */
+	//@{
+	S32 size() const;
+
+	bool has(const char* key) const;
+	bool has(const std::string& key) const		{ return has(key.c_str()); }
+
+	/**
+	 * @brief Look up a map entry.
+	 *
+	 * @return The value, or an undefined value if this is not a map or
+	 * the key is not present.
+	 */
+	const LLSDArenaValue& get(const char* key) const;
+	const LLSDArenaValue& get(const std::string& key) const		{ return get(key.c_str()); }
+	const LLSDArenaValue& operator[](const char* key) const		{ return get(key); }
+	const LLSDArenaValue& operator[](const std::string& key) const	{ return get(key.c_str()); }
+
+	/**
+	 * @brief Look up a map entry by a key obtained from LLSDArena::findKey.
+	 *
+	 * Small maps are then searched by pointer compare only; hoist the
+	 * findKey() out of loops over many similar maps.
+	 */
+	const LLSDArenaValue& getInterned(const char* interned_key) const;
+
+	/**
+	 * @brief Look up an array element.
+	 *
+	 * @return The value, or an undefined value if this is not an array or
+	 * the index is out of range.
+	 */
+	const LLSDArenaValue& get(S32 index) const;
+	const LLSDArenaValue& operator[](S32 index) const	{ return get(index); }
+
+	// Map entries are sorted by key, the same order in which LLSD iterates.
+	map_const_iterator beginMap() const;
+	map_const_iterator endMap() const;
+	array_const_iterator beginArray() const;
+	array_const_iterator endArray() const;
+	//@}
+
+	/**
+	 * @brief Make a deep, mutable copy of this value as regular LLSD.
+	 */
+	LLSD toLLSD() const;
+
+	static const LLSDArenaValue& undefined();
+
+private:
+	friend class LLSDArena;
+	friend class LLSDArenaBuilder;
+
+	const MapEntry* find(const char* key, bool interned) const;
+
+	U8 mType;
+	union
+	{
+		LLSD::Boolean mBoolean;
+		LLSD::Integer mInteger;
+		LLSD::Real mReal;				// Also used for dates.
+		U8 mUUID[UUID_BYTES];
+		struct
+		{
+			const char* mPtr;			// Strings, URIs and binary.
+			U32 mSize;
+		} mBuffer;
+		struct
+		{
+			const LLSDArenaValue* mPtr;
+			U32 mSize;
+		} mArray;
+		struct
+		{
+			const MapEntry* mPtr;
+			U32 mSize;
+		} mMap;
+	} mData;
+};
+
+struct LLSDArenaValue::MapEntry
+{
+	const char* first;					// Interned key, see LLSDArena::internKey.
+	LLSDArenaValue second;
+};
+
+/**
+ * @class LLSDArena
+ * @brief Owns the memory of one parsed LLSD document.
+ *
+ * Memory is handed out from a list of blocks and is only ever released
+ * as a whole, when the arena is destroyed or clear() is called.
+ */
+class LL_COMMON_API LLSDArena : public LLRefCount
+{
+protected:
+	virtual ~LLSDArena();
+
+public:
+	enum
+	{
+		DEFAULT_BLOCK_SIZE = 64 * 1024
+	};
+
+	LLSDArena(U32 block_size = DEFAULT_BLOCK_SIZE);
+
+	/**
+	 * @brief The document root; undefined until a parse succeeded.
+	 */
+	const LLSDArenaValue& root() const				{ return mRoot ? *mRoot : LLSDArenaValue::undefined(); }
+	void setRoot(const LLSDArenaValue* root)		{ mRoot = root; }
+
+	/**
+	 * @brief Get uninitialized memory that lives as long as the arena.
+	 */
+	void* allocate(size_t size, size_t alignment = sizeof(F64));
+
+	/**
+	 * @brief Copy a string into the arena, NUL terminating it.
+	 */
+	const char* copyString(const char* str, size_t len);
+
+	/**
+	 * @brief Return the unique arena copy of key.
+	 *
+	 * All map keys of a document are interned, so two keys are equal
+	 * if and only if their pointers are.
+	 */
+	const char* internKey(const char* key, size_t len);
+
+	/**
+	 * @brief Return the interned copy of key, or NULL if no map in this
+	 * arena uses it.
+	 */
+	const char* findKey(const char* key, size_t len) const;
+
+	/**
+	 * @brief Release all memory but the first block, making the arena
+	 * ready for reuse by another parse.
+	 */
+	void clear();
+
+	/** @name Statistics */
+	//@{
+	size_t bytesUsed() const						{ return mBytesUsed; }
+	size_t bytesReserved() const					{ return mBytesReserved; }
+	U32 keyCount() const							{ return mKeyCount; }
+	//@}
+
+private:
+	struct Block
+	{
+		Block* mNext;
+		size_t mSize;
+		size_t mUsed;
+	};
+
+	struct Key
+	{
+		const char* mStr;
+		U32 mLen;
+		U32 mHash;
+	};
+
+	Block* newBlock(size_t min_size);
+	void growKeyTable();
+	static U32 hashKey(const char* key, size_t len);
+
+private:
+	Block* mBlocks;					// Current block first.
+	U32 mBlockSize;
+	size_t mBytesUsed;
+	size_t mBytesReserved;
+	const LLSDArenaValue* mRoot;
+
+	std::vector<Key> mKeys;			// Open addressed, size is a power of two.
+	U32 mKeyCount;
+};
+
+/**
+ * @class LLSDArenaBuilder
+ * @brief Builds an LLSDArena document from a sequence of parse events.
+ *
+ * Children are collected on a scratch stack and are copied into the
+ * arena as a contiguous run when their container is closed, so every
+ * container occupies a single allocation.
+ */
+class LL_COMMON_API LLSDArenaBuilder : public LLSDParseHandler
+{
+public:
+	/**
+	 * @param last_key_wins A map key given twice keeps its last value,
+	 * as in the XML parser, rather than its first, as in the binary and
+	 * notation parsers.
+	 */
+	LLSDArenaBuilder(LLSDArena& arena, bool last_key_wins = false);
+
+	/*virtual*/ void beginMap();
+	/*virtual*/ void endMap();
+	/*virtual*/ void beginArray();
+	/*virtual*/ void endArray();
+
+	/*virtual*/ void key(const std::string& key)	{ this->key(key.data(), key.size()); }
+	void key(const char* key, size_t len);
+
+	/*virtual*/ void undefinedValue();
+	/*virtual*/ void booleanValue(LLSD::Boolean value);
+	/*virtual*/ void integerValue(LLSD::Integer value);
+	/*virtual*/ void realValue(LLSD::Real value);
+	/*virtual*/ void stringValue(const std::string& value)	{ stringValue(value.data(), value.size()); }
+	void stringValue(const char* value, size_t len);
+	/*virtual*/ void uuidValue(const LLUUID& value);
+	/*virtual*/ void dateValue(const LLDate& value);
+	/*virtual*/ void uriValue(const std::string& value)		{ uriValue(value.data(), value.size()); }
+	void uriValue(const char* value, size_t len);
+	/*virtual*/ void binaryValue(const U8* value, size_t len);
+
+	bool inMap() const;
+	bool inArray() const;
+
+	/**
+	 * @brief Make the completed value the root of the arena.
+	 *
+	 * @return Returns false if the events did not form exactly one
+	 * well nested value.
+	 */
+	bool finish();
+
+private:
+	struct Frame
+	{
+		U8 mType;
+		U32 mStart;
+	};
+
+	void push(const LLSDArenaValue& value);
+	void beginContainer(LLSD::Type type);
+	void bufferValue(LLSD::Type type, const char* value, size_t len);
+
+	LLSDArena& mArena;
+	bool mLastKeyWins;
+	std::vector<Frame> mFrames;
+	std::vector<LLSDArenaValue> mValues;
+	std::vector<const char*> mValueKeys;	// Parallel to mValues.
+	const char* mPendingKey;
+	U32 mRootCount;
+	bool mFailed;
+};
+
+#endif // LL_LLSDARENA_H
@@ -0,0 +1,363 @@
+/**
+ * @file llsdparsehandler.cpp
+ * @brief Event interface for streaming LLSD parsers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llsdparsehandler.h"
+
+/**
+ * LLSDParseHandler
+ */
+
+void LLSDParseHandler::value(const LLSD& value)
+{
+	switch (value.type())
+	{
+		case LLSD::TypeBoolean:	booleanValue(value.asBoolean()); break;
+		case LLSD::TypeInteger:	integerValue(value.asInteger()); break;
+		case LLSD::TypeReal:	realValue(value.asReal()); break;
+		case LLSD::TypeString:	stringValue(value.asString()); break;
+		case LLSD::TypeUUID:	uuidValue(value.asUUID()); break;
+		case LLSD::TypeDate:	dateValue(value.asDate()); break;
+		case LLSD::TypeURI:		uriValue(value.asString()); break;
+		case LLSD::TypeBinary:
+		{
+			const LLSD::Binary& binary = value.asBinary();
+			binaryValue(binary.empty() ? NULL : &binary[0], binary.size());
+			break;
+		}
+		case LLSD::TypeMap:
+			beginMap();
+			for (LLSD::map_const_iterator it = value.beginMap(); it != value.endMap(); ++it)
+			{
+				key(it->first);
+				this->value(it->second);
+			}
+			endMap();
+			break;
+		case LLSD::TypeArray:
+			beginArray();
+			for (LLSD::array_const_iterator it = value.beginArray(); it != value.endArray(); ++it)
+			{
+				this->value(*it);
+			}
+			endArray();
+			break;
+		default:
+			undefinedValue();
+			break;
+	}
+}
+
+/**
+ * LLSDTreeHandler
+ */
+
+LLSDTreeHandler::LLSDTreeHandler()
+	: mHaveRoot(false)
+{
+}
+
+void LLSDTreeHandler::reset()
+{
+	mResult.clear();
+	mStack.clear();
+	mKey.clear();
+	mHaveRoot = false;
+}
+
+LLSD& LLSDTreeHandler::newValue()
+{
+	if (mStack.empty())
+	{
+		mHaveRoot = true;
+		mResult.clear();
+		return mResult;
+	}
+	LLSD& container = *mStack.back();
+	if (container.isMap())
+	{
+		return container[mKey];
+	}
+	// Only the innermost container is appended to, so references to
+	// elements further up the stack stay valid.
+	container.append(LLSD());
+	return container[container.size() - 1];
+}
+
+void LLSDTreeHandler::beginMap()
+{
+	LLSD& map = newValue();
+	map = LLSD::emptyMap();
+	mStack.push_back(&map);
+}
+
+void LLSDTreeHandler::endMap()
+{
+	if (!mStack.empty())
+	{
+		mStack.pop_back();
+	}
+}
+
+void LLSDTreeHandler::beginArray()
+{
+	LLSD& array = newValue();
+	array = LLSD::emptyArray();
+	mStack.push_back(&array);
+}
+
+void LLSDTreeHandler::endArray()
+{
+	if (!mStack.empty())
+	{
+		mStack.pop_back();
+	}
+}
+
+void LLSDTreeHandler::key(const std::string& key)
+{
+	mKey = key;
+}
+
+void LLSDTreeHandler::undefinedValue()
+{
+	newValue().clear();
+}
+
+void LLSDTreeHandler::booleanValue(LLSD::Boolean value)
+{
+	newValue() = value;
+}
+
+void LLSDTreeHandler::integerValue(LLSD::Integer value)
+{
+	newValue() = value;
+}
+
+void LLSDTreeHandler::realValue(LLSD::Real value)
+{
+	newValue() = value;
+}
+
+void LLSDTreeHandler::stringValue(const std::string& value)
+{
+	newValue() = value;
+}
+
+void LLSDTreeHandler::uuidValue(const LLUUID& value)
+{
+	newValue() = value;
+}
+
+void LLSDTreeHandler::dateValue(const LLDate& value)
+{
+	newValue() = value;
+}
+
+void LLSDTreeHandler::uriValue(const std::string& value)
+{
+	newValue() = LLURI(value);
+}
+
+void LLSDTreeHandler::binaryValue(const U8* value, size_t len)
+{
+	newValue() = LLSD::Binary(value, value + len);
+}
+
+/**
+ * LLSDItemHandler
+ */
+
+LLSDItemHandler::LLSDItemHandler(const std::string& items_key, const callback_t& callback)
+	: mItemsKey(items_key),
+	  mCallback(callback),
+	  mDepth(0),
+	  mItemsDepth(0),
+	  mItemCount(0),
+	  mItemsKeyPending(false),
+	  mInItem(false)
+{
+}
+
+// Decide where the value that starts now belongs. Returns NULL for the
+// collection container itself, which is not recorded anywhere.
+LLSDParseHandler* LLSDItemHandler::beginValue(bool container)
+{
+	if (mInItem)
+	{
+		return &mItem;
+	}
+	if (mItemsDepth && mDepth == mItemsDepth)
+	{
+		mItem.reset();
+		mInItem = true;
+		return &mItem;
+	}
+	if (mItemsKeyPending)
+	{
+		mItemsKeyPending = false;
+		if (container)
+		{
+			mItemsDepth = mDepth + 1;
+			return NULL;
+		}
+		// Not a collection after all; keep it with the header.
+		mHeader.key(mItemsKey);
+	}
+	return &mHeader;
+}
+
+// Decide where the end of a container goes, before mDepth is decremented.
+LLSDParseHandler* LLSDItemHandler::endContainer()
+{
+	if (mItemsDepth && mDepth == mItemsDepth && !mInItem)
+	{
+		mItemsDepth = 0;
+		return NULL;
+	}
+	return mInItem ? &mItem : &mHeader;
+}
+
+// Called after every complete value or closed container.
+void LLSDItemHandler::endValue()
+{
+	if (mInItem && mDepth == mItemsDepth && mItem.complete())
+	{
+		mInItem = false;
+		++mItemCount;
+		if (mCallback)
+		{
+			mCallback(mItemKey, mItem.result());
+		}
+		mItem.reset();
+		mItemKey.clear();
+	}
+}
+
+void LLSDItemHandler::beginMap()
+{
+	LLSDParseHandler* target = beginValue(true);
+	if (target) target->beginMap();
+	++mDepth;
+}
+
+void LLSDItemHandler::endMap()
+{
+	LLSDParseHandler* target = endContainer();
+	if (target) target->endMap();
+	--mDepth;
+	endValue();
+}
+
+void LLSDItemHandler::beginArray()
+{
+	LLSDParseHandler* target = beginValue(true);
+	if (target) target->beginArray();
+	++mDepth;
+}
+
+void LLSDItemHandler::endArray()
+{
+	LLSDParseHandler* target = endContainer();
+	if (target) target->endArray();
+	--mDepth;
+	endValue();
+}
+
+void LLSDItemHandler::key(const std::string& key)
+{
+	if (mInItem)
+	{
+		mItem.key(key);
+	}
+	else if (mItemsDepth && mDepth == mItemsDepth)
+	{
+		mItemKey = key;
+	}
+	else if (mDepth == 1 && key == mItemsKey)
+	{
+		mItemsKeyPending = true;
+	}
+	else
+	{
+		mHeader.key(key);
+	}
+}
+
+void LLSDItemHandler::undefinedValue()
+{
+	beginValue(false)->undefinedValue();
+	endValue();
+}
+
+void LLSDItemHandler::booleanValue(LLSD::Boolean value)
+{
+	beginValue(false)->booleanValue(value);
+	endValue();
+}
+
+void LLSDItemHandler::integerValue(LLSD::Integer value)
+{
+	beginValue(false)->integerValue(value);
+	endValue();
+}
+
+void LLSDItemHandler::realValue(LLSD::Real value)
+{
+	beginValue(false)->realValue(value);
+	endValue();
+}
+
+void LLSDItemHandler::stringValue(const std::string& value)
+{
+	beginValue(false)->stringValue(value);
+	endValue();
+}
+
+void LLSDItemHandler::uuidValue(const LLUUID& value)
+{
+	beginValue(false)->uuidValue(value);
+	endValue();
+}
+
+void LLSDItemHandler::dateValue(const LLDate& value)
+{
+	beginValue(false)->dateValue(value);
+	endValue();
+}
+
+void LLSDItemHandler::uriValue(const std::string& value)
+{
+	beginValue(false)->uriValue(value);
+	endValue();
+}
+
+void LLSDItemHandler::binaryValue(const U8* value, size_t len)
+{
+	beginValue(false)->binaryValue(value, len);
+	endValue();
+}
@@ -0,0 +1,184 @@
+/**
+ * @file llsdparsehandler.h
+ * @brief Event interface for streaming LLSD parsers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSDPARSEHANDLER_H
+#define LL_LLSDPARSEHANDLER_H
+
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+
+#include "llsd.h"
+
+/**
+ * @class LLSDParseHandler
+ * @brief Receives the values of an LLSD document as they are parsed.
+ *
+ * All three parsers (XML, notation and binary) can push their input into
+ * a handler instead of building an LLSD tree; see LLSDParser::parse().
+ * A document is reported depth first: a container is announced by
+ * beginMap() or beginArray(), followed by its children and closed by the
+ * matching end call. Every child of a map is preceded by key().
+ *
+ * The default implementations ignore the event, so a consumer only has
+ * to override what it is interested in.
+ */
+class LL_COMMON_API LLSDParseHandler
+{
+public:
+	virtual ~LLSDParseHandler() { }
+
+	virtual void beginMap() { }
+	virtual void endMap() { }
+	virtual void beginArray() { }
+	virtual void endArray() { }
+
+	/**
+	 * @brief The key of the next value in the current map.
+	 */
+	virtual void key(const std::string& key) { }
+
+	virtual void undefinedValue() { }
+	virtual void booleanValue(LLSD::Boolean value) { }
+	virtual void integerValue(LLSD::Integer value) { }
+	virtual void realValue(LLSD::Real value) { }
+	virtual void stringValue(const std::string& value) { }
+	virtual void uuidValue(const LLUUID& value) { }
+	virtual void dateValue(const LLDate& value) { }
+	virtual void uriValue(const std::string& value) { }
+	virtual void binaryValue(const U8* value, size_t len) { }
+
+	/**
+	 * @brief Report a scalar that is already held in an LLSD.
+	 *
+	 * Maps and arrays are reported recursively.
+	 */
+	void value(const LLSD& value);
+};
+
+/**
+ * @class LLSDTreeHandler
+ * @brief Builds a regular LLSD tree from parse events.
+ */
+class LL_COMMON_API LLSDTreeHandler : public LLSDParseHandler
+{
+public:
+	LLSDTreeHandler();
+
+	/**
+	 * @brief Forget the previous result and start a new document.
+	 */
+	void reset();
+
+	const LLSD& result() const						{ return mResult; }
+
+	/**
+	 * @brief True once exactly one complete value was received.
+	 */
+	bool complete() const							{ return mHaveRoot && mStack.empty(); }
+
+	/*virtual*/ void beginMap();
+	/*virtual*/ void endMap();
+	/*virtual*/ void beginArray();
+	/*virtual*/ void endArray();
+	/*virtual*/ void key(const std::string& key);
+	/*virtual*/ void undefinedValue();
+	/*virtual*/ void booleanValue(LLSD::Boolean value);
+	/*virtual*/ void integerValue(LLSD::Integer value);
+	/*virtual*/ void realValue(LLSD::Real value);
+	/*virtual*/ void stringValue(const std::string& value);
+	/*virtual*/ void uuidValue(const LLUUID& value);
+	/*virtual*/ void dateValue(const LLDate& value);
+	/*virtual*/ void uriValue(const std::string& value);
+	/*virtual*/ void binaryValue(const U8* value, size_t len);
+
+private:
+	LLSD& newValue();
+
+	LLSD mResult;
+	std::vector<LLSD*> mStack;		// Open containers, innermost last.
+	std::string mKey;
+	bool mHaveRoot;
+};
+
+/**
+ * @class LLSDItemHandler
+ * @brief Hands out the entries of one large collection one at a time.
+ *
+ * Many capability replies are a map with a few small header fields and
+ * one big collection, like "members" in GroupMemberData or "folders" in
+ * FetchInventoryDescendents2. This handler materializes each entry of the
+ * collection stored under items_key in the top level map as its own
+ * LLSD, passes it to the callback and drops it again, so that memory use
+ * is bounded by the largest entry rather than by the whole reply. All
+ * other top level values are collected in header().
+ *
+ * The callback receives the map key of the entry, or an empty string if
+ * the collection is an array.
+ */
+class LL_COMMON_API LLSDItemHandler : public LLSDParseHandler
+{
+public:
+	typedef boost::function<void (const std::string& key, const LLSD& item)> callback_t;
+
+	LLSDItemHandler(const std::string& items_key, const callback_t& callback);
+
+	const LLSD& header() const						{ return mHeader.result(); }
+	S32 itemCount() const							{ return mItemCount; }
+
+	/*virtual*/ void beginMap();
+	/*virtual*/ void endMap();
+	/*virtual*/ void beginArray();
+	/*virtual*/ void endArray();
+	/*virtual*/ void key(const std::string& key);
+	/*virtual*/ void undefinedValue();
+	/*virtual*/ void booleanValue(LLSD::Boolean value);
+	/*virtual*/ void integerValue(LLSD::Integer value);
+	/*virtual*/ void realValue(LLSD::Real value);
+	/*virtual*/ void stringValue(const std::string& value);
+	/*virtual*/ void uuidValue(const LLUUID& value);
+	/*virtual*/ void dateValue(const LLDate& value);
+	/*virtual*/ void uriValue(const std::string& value);
+	/*virtual*/ void binaryValue(const U8* value, size_t len);
+
+private:
+	LLSDParseHandler* beginValue(bool container);
+	LLSDParseHandler* endContainer();
+	void endValue();
+
+	LLSDTreeHandler mHeader;
+	LLSDTreeHandler mItem;
+	std::string mItemsKey;
+	std::string mItemKey;
+	callback_t mCallback;
+	S32 mDepth;						// Number of open containers.
+	S32 mItemsDepth;				// Depth inside the collection, or 0.
+	S32 mItemCount;
+	bool mItemsKeyPending;			// Next top level value is the collection.
+	bool mInItem;
+};
+
+#endif // LL_LLSDPARSEHANDLER_H
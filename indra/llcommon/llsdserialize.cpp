@@ -28,6 +28,7 @@
 
 #include "linden_common.h"
 #include "llsdserialize.h"
+#include "llsdarena.h"
 #include "llpointer.h"
 #include "llstreamtools.h" // for fullread
 #include "llbase64.h"
@@ -334,6 +335,25 @@ S32 LLSDParser::parseLines(std::istream& istr, LLSD& data)
 	return doParse(istr, data);
 }
 
+S32 LLSDParser::parse(std::istream& istr, LLSDParseHandler& handler, S32 max_bytes)
+{
+	mCheckLimits = (LLSDSerialize::SIZE_UNLIMITED == max_bytes) ? false : true;
+	mMaxBytesLeft = max_bytes;
+	return doParseEvents(istr, handler);
+}
+
+S32 LLSDParser::parse(std::istream& istr, LLSDArena& arena, S32 max_bytes)
+{
+	arena.setRoot(NULL);
+	LLSDArenaBuilder builder(arena, keepsLastDuplicateKey());
+	S32 parse_count = parse(istr, builder, max_bytes);
+	if(parse_count > 0 && !builder.finish())
+	{
+		parse_count = PARSE_FAILURE;
+	}
+	return parse_count;
+}
+
 
 int LLSDParser::get(std::istream& istr) const
 {
@@ -758,6 +778,149 @@ S32 LLSDNotationParser::parseArray(std::istream& istr, LLSD& array) const
 	return parse_count;
 }
 
+// virtual
+S32 LLSDNotationParser::doParseEvents(std::istream& istr, LLSDParseHandler& handler) const
+{
+	char c;
+	c = istr.peek();
+	while(isspace(c))
+	{
+		// pop the whitespace.
+		c = get(istr);
+		c = istr.peek();
+	}
+	if(!istr.good())
+	{
+		return 0;
+	}
+	S32 parse_count = 1;
+	S32 child_count;
+	switch(c)
+	{
+	case '{':
+		child_count = parseMap(istr, handler);
+		break;
+
+	case '[':
+		child_count = parseArray(istr, handler);
+		break;
+
+	default:
+	{
+		// Scalars are small; decode them the usual way and pass them on.
+		LLSD data;
+		parse_count = doParse(istr, data);
+		if(parse_count > 0)
+		{
+			handler.value(data);
+		}
+		return parse_count;
+	}
+	}
+	if((child_count == PARSE_FAILURE) || istr.fail())
+	{
+		return PARSE_FAILURE;
+	}
+	return parse_count + child_count;
+}
+
+S32 LLSDNotationParser::parseMap(std::istream& istr, LLSDParseHandler& handler) const
+{
+	// map: { string:object, string:object }
+	S32 parse_count = 0;
+	char c = get(istr);
+	if(c != '{')
+	{
+		return PARSE_FAILURE;
+	}
+	handler.beginMap();
+	// eat commas, white
+	bool found_name = false;
+	std::string name;
+	c = get(istr);
+	while(c != '}' && istr.good())
+	{
+		if(!found_name)
+		{
+			if((c == '\"') || (c == '\'') || (c == 's'))
+			{
+				putback(istr, c);
+				found_name = true;
+				int count = deserialize_string(istr, name, mMaxBytesLeft);
+				if(PARSE_FAILURE == count) return PARSE_FAILURE;
+				account(count);
+			}
+			c = get(istr);
+		}
+		else
+		{
+			if(isspace(c) || (c == ':'))
+			{
+				c = get(istr);
+				continue;
+			}
+			putback(istr, c);
+			handler.key(name);
+			S32 count = doParseEvents(istr, handler);
+			if(count <= 0)
+			{
+				// There must be a value for every key.
+				return PARSE_FAILURE;
+			}
+			parse_count += count;
+			found_name = false;
+			c = get(istr);
+		}
+	}
+	if(c != '}')
+	{
+		return PARSE_FAILURE;
+	}
+	handler.endMap();
+	return parse_count;
+}
+
+S32 LLSDNotationParser::parseArray(std::istream& istr, LLSDParseHandler& handler) const
+{
+	// array: [ object, object, object ]
+	S32 parse_count = 0;
+	char c = get(istr);
+	if(c != '[')
+	{
+		return PARSE_FAILURE;
+	}
+	handler.beginArray();
+	// eat commas, white
+	c = get(istr);
+	while((c != ']') && istr.good())
+	{
+		if(isspace(c) || (c == ','))
+		{
+			c = get(istr);
+			continue;
+		}
+		putback(istr, c);
+		S32 count = doParseEvents(istr, handler);
+		if(PARSE_FAILURE == count)
+		{
+			return PARSE_FAILURE;
+		}
+		if(0 == count)
+		{
+			// parseArray() appends an undefined element in this case.
+			handler.undefinedValue();
+		}
+		parse_count += count;
+		c = get(istr);
+	}
+	if(c != ']')
+	{
+		return PARSE_FAILURE;
+	}
+	handler.endArray();
+	return parse_count;
+}
+
 bool LLSDNotationParser::parseString(std::istream& istr, LLSD& data) const
 {
 	std::string value;
@@ -1192,21 +1355,274 @@ S32 LLSDBinaryParser::parseArray(std::istream& istr, LLSD& array) const
 	return parse_count;
 }
 
+// virtual
+S32 LLSDBinaryParser::doParseEvents(std::istream& istr, LLSDParseHandler& handler) const
+{
+	std::string buffer;
+	return parseEventValue(istr, handler, buffer);
+}
+
+// Mirrors doParse() above, but reports every value to a handler
+// instead of creating an LLSD node for it.
+S32 LLSDBinaryParser::parseEventValue(
+	std::istream& istr,
+	LLSDParseHandler& handler,
+	std::string& buffer) const
+{
+	char c;
+	c = get(istr);
+	if(!istr.good())
+	{
+		return 0;
+	}
+	S32 parse_count = 1;
+	switch(c)
+	{
+	case '{':
+	{
+		U32 value_nbo = 0;
+		read(istr, (char*)&value_nbo, sizeof(U32));		 /*Flawfinder: ignore*/
+		S32 size = (S32)ntohl(value_nbo);
+		handler.beginMap();
+		S32 count = 0;
+		c = get(istr);
+		while(c != '}' && (count < size) && istr.good())
+		{
+			switch(c)
+			{
+			case 'k':
+				if(!parseString(istr, buffer))
+				{
+					return PARSE_FAILURE;
+				}
+				break;
+			case '\'':
+			case '"':
+			{
+				int cnt = deserialize_string_delim(istr, buffer, c);
+				if(PARSE_FAILURE == cnt) return PARSE_FAILURE;
+				account(cnt);
+				break;
+			}
+			default:
+				buffer.clear();
+				break;
+			}
+			handler.key(buffer);
+			S32 child_count = parseEventValue(istr, handler, buffer);
+			if(child_count <= 0)
+			{
+				// There must be a value for every key.
+				return PARSE_FAILURE;
+			}
+			parse_count += child_count;
+			++count;
+			c = get(istr);
+		}
+		if((c != '}') || (count < size))
+		{
+			return PARSE_FAILURE;
+		}
+		handler.endMap();
+		if(istr.fail())
+		{
+			LL_INFOS() << "STREAM FAILURE reading binary map." << LL_ENDL;
+			parse_count = PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case '[':
+	{
+		U32 value_nbo = 0;
+		read(istr, (char*)&value_nbo, sizeof(U32));		 /*Flawfinder: ignore*/
+		S32 size = (S32)ntohl(value_nbo);
+		handler.beginArray();
+		S32 count = 0;
+		c = istr.peek();
+		while((c != ']') && (count < size) && istr.good())
+		{
+			S32 child_count = parseEventValue(istr, handler, buffer);
+			if(PARSE_FAILURE == child_count)
+			{
+				return PARSE_FAILURE;
+			}
+			parse_count += child_count;
+			++count;
+			c = istr.peek();
+		}
+		c = get(istr);
+		if((c != ']') || (count < size))
+		{
+			return PARSE_FAILURE;
+		}
+		handler.endArray();
+		if(istr.fail())
+		{
+			LL_INFOS() << "STREAM FAILURE reading binary array." << LL_ENDL;
+			parse_count = PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case '!':
+		handler.undefinedValue();
+		break;
+
+	case '0':
+		handler.booleanValue(false);
+		break;
+
+	case '1':
+		handler.booleanValue(true);
+		break;
+
+	case 'i':
+	{
+		U32 value_nbo = 0;
+		read(istr, (char*)&value_nbo, sizeof(U32));	 /*Flawfinder: ignore*/
+		handler.integerValue((S32)ntohl(value_nbo));
+		if(istr.fail())
+		{
+			LL_INFOS() << "STREAM FAILURE reading binary integer." << LL_ENDL;
+		}
+		break;
+	}
+
+	case 'r':
+	{
+		F64 real_nbo = 0.0;
+		read(istr, (char*)&real_nbo, sizeof(F64));	 /*Flawfinder: ignore*/
+		handler.realValue(ll_ntohd(real_nbo));
+		if(istr.fail())
+		{
+			LL_INFOS() << "STREAM FAILURE reading binary real." << LL_ENDL;
+		}
+		break;
+	}
+
+	case 'u':
+	{
+		LLUUID id;
+		read(istr, (char*)(&id.mData), UUID_BYTES);	 /*Flawfinder: ignore*/
+		handler.uuidValue(id);
+		if(istr.fail())
+		{
+			LL_INFOS() << "STREAM FAILURE reading binary uuid." << LL_ENDL;
+		}
+		break;
+	}
+
+	case '\'':
+	case '"':
+	{
+		int cnt = deserialize_string_delim(istr, buffer, c);
+		if(PARSE_FAILURE == cnt)
+		{
+			parse_count = PARSE_FAILURE;
+		}
+		else
+		{
+			handler.stringValue(buffer);
+			account(cnt);
+		}
+		if(istr.fail())
+		{
+			LL_INFOS() << "STREAM FAILURE reading binary (notation-style) string."
+				<< LL_ENDL;
+			parse_count = PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case 's':
+	case 'l':
+	{
+		if(parseString(istr, buffer))
+		{
+			if(c == 's')
+			{
+				handler.stringValue(buffer);
+			}
+			else
+			{
+				handler.uriValue(buffer);
+			}
+		}
+		else
+		{
+			parse_count = PARSE_FAILURE;
+		}
+		if(istr.fail())
+		{
+			LL_INFOS() << "STREAM FAILURE reading binary string." << LL_ENDL;
+			parse_count = PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case 'd':
+	{
+		F64 real = 0.0;
+		read(istr, (char*)&real, sizeof(F64));	 /*Flawfinder: ignore*/
+		handler.dateValue(LLDate(real));
+		if(istr.fail())
+		{
+			LL_INFOS() << "STREAM FAILURE reading binary date." << LL_ENDL;
+			parse_count = PARSE_FAILURE;
+		}
+		break;
+	}
+
+	case 'b':
+	{
+		U32 size_nbo = 0;
+		read(istr, (char*)&size_nbo, sizeof(U32));	/*Flawfinder: ignore*/
+		S32 size = (S32)ntohl(size_nbo);
+		if(mCheckLimits && (size > mMaxBytesLeft))
+		{
+			parse_count = PARSE_FAILURE;
+		}
+		else
+		{
+			buffer.resize(llmax(size, 0));
+			if(size > 0)
+			{
+				account((int)fullread(istr, &buffer[0], size));
+			}
+			handler.binaryValue((const U8*)buffer.data(), buffer.size());
+		}
+		if(istr.fail())
+		{
+			LL_INFOS() << "STREAM FAILURE reading binary." << LL_ENDL;
+			parse_count = PARSE_FAILURE;
+		}
+		break;
+	}
+
+	default:
+		parse_count = PARSE_FAILURE;
+		LL_INFOS() << "Unrecognized character while parsing: int(" << (int)c
+			<< ")" << LL_ENDL;
+		break;
+	}
+	return parse_count;
+}
+
 bool LLSDBinaryParser::parseString(
 	std::istream& istr,
 	std::string& value) const
 {
-	// *FIX: This is memory inefficient.
 	U32 value_nbo = 0;
 	read(istr, (char*)&value_nbo, sizeof(U32));		 /*Flawfinder: ignore*/
 	S32 size = (S32)ntohl(value_nbo);
-	if(mCheckLimits && (size > mMaxBytesLeft)) return false;
-	std::vector<char> buf;
+	if(size < 0 || (mCheckLimits && (size > mMaxBytesLeft))) return false;
+	// Read straight into value; the arena parser reuses it as scratch
+	// space, so it must also be emptied for zero length strings.
+	value.resize(size);
 	if(size)
 	{
-		buf.resize(size);
-		account((int)fullread(istr, &buf[0], size));
-		value.assign(buf.begin(), buf.end());
+		account((int)fullread(istr, &value[0], size));
 	}
 	return true;
 }
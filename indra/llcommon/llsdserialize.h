@@ -34,6 +34,9 @@
 #include "llrefcount.h"
 #include "llsd.h"
 
+class LLSDArena;
+class LLSDParseHandler;
+
 /** 
  * @class LLSDParser
  * @brief Abstract base class for LLSD parsers.
@@ -85,6 +88,38 @@ public:
 	 */
 	S32 parseLines(std::istream& istr, LLSD& data);
 
+	/** 
+	 * @brief Parse a stream and report its values to a handler.
+	 *
+	 * Same semantics as parse() above, but no LLSD tree is built: every
+	 * value is passed to handler as soon as it is read, see
+	 * llsdparsehandler.h.
+	 * @param istr The input stream.
+	 * @param handler The handler that receives the parse events.
+	 * @param max_bytes The maximum number of bytes that will be in
+	 * the stream. Pass in LLSDSerialize::SIZE_UNLIMITED (-1) to set no
+	 * byte limit.
+	 * @return Returns the number of LLSD objects reported. Returns
+	 * PARSE_FAILURE (-1) on parse failure, in which case the handler may
+	 * have seen an incomplete document.
+	 */
+	S32 parse(std::istream& istr, LLSDParseHandler& handler, S32 max_bytes);
+
+	/** 
+	 * @brief Parse a stream into an arena backed, read-only document.
+	 *
+	 * Same semantics as parse() above, but the result is built directly
+	 * into arena and is available as arena.root(). See llsdarena.h.
+	 * @param istr The input stream.
+	 * @param arena[out] The arena that receives the document.
+	 * @param max_bytes The maximum number of bytes that will be in
+	 * the stream. Pass in LLSDSerialize::SIZE_UNLIMITED (-1) to set no
+	 * byte limit.
+	 * @return Returns the number of LLSD objects parsed into the
+	 * arena. Returns PARSE_FAILURE (-1) on parse failure.
+	 */
+	S32 parse(std::istream& istr, LLSDArena& arena, S32 max_bytes);
+
 	/** 
 	 * @brief Resets the parser so parse() or parseLines() can be called again for another <llsd> chunk.
 	 */
@@ -108,6 +143,23 @@ protected:
 	 */
 	virtual S32 doParse(std::istream& istr, LLSD& data) const = 0;
 
+	/** 
+	 * @brief Pure virtual base for parsing into a handler.
+	 *
+	 * @param istr The input stream.
+	 * @param handler The handler that receives the parsed values.
+	 * @return Returns the number of LLSD objects parsed. Returns
+	 * PARSE_FAILURE (-1) on parse failure.
+	 */
+	virtual S32 doParseEvents(std::istream& istr, LLSDParseHandler& handler) const = 0;
+
+	/** 
+	 * @brief Whether a repeated map key keeps its last value rather
+	 * than its first when parsing into LLSD, so that arena documents
+	 * keep the same one.
+	 */
+	virtual bool keepsLastDuplicateKey() const	{ return false; }
+
 	/** 
 	 * @brief Virtual default function for resetting the parser
 	 */
@@ -246,6 +298,14 @@ protected:
 	 */
 	virtual S32 doParse(std::istream& istr, LLSD& data) const;
 
+	/** 
+	 * @brief Parse the notation stream into a handler.
+	 *
+	 * Scalars are decoded by doParse() and passed on; maps and arrays
+	 * are never materialized.
+	 */
+	virtual S32 doParseEvents(std::istream& istr, LLSDParseHandler& handler) const;
+
 private:
 	/** 
 	 * @brief Parse a map from the istream
@@ -256,6 +316,15 @@ private:
 	 */
 	S32 parseMap(std::istream& istr, LLSD& map) const;
 
+	/** 
+	 * @brief Parse a map from the istream into a handler.
+	 *
+	 * @param istr The input stream.
+	 * @param handler The handler that receives the parsed values.
+	 * @return Returns The number of LLSD objects parsed.
+	 */
+	S32 parseMap(std::istream& istr, LLSDParseHandler& handler) const;
+
 	/** 
 	 * @brief Parse an array from the istream.
 	 *
@@ -265,6 +334,15 @@ private:
 	 */
 	S32 parseArray(std::istream& istr, LLSD& array) const;
 
+	/** 
+	 * @brief Parse an array from the istream into a handler.
+	 *
+	 * @param istr The input stream.
+	 * @param handler The handler that receives the parsed values.
+	 * @return Returns The number of LLSD objects parsed.
+	 */
+	S32 parseArray(std::istream& istr, LLSDParseHandler& handler) const;
+
 	/** 
 	 * @brief Parse a string from the istream and assign it to data.
 	 *
@@ -319,6 +397,16 @@ protected:
 	 */
 	virtual S32 doParse(std::istream& istr, LLSD& data) const;
 
+	/** 
+	 * @brief Parse the XML stream into a handler.
+	 */
+	virtual S32 doParseEvents(std::istream& istr, LLSDParseHandler& handler) const;
+
+	/** 
+	 * @brief Map elements are assigned, so the last value of a key wins.
+	 */
+	virtual bool keepsLastDuplicateKey() const	{ return true; }
+
 	/** 
 	 * @brief Virtual default function for resetting the parser
 	 */
@@ -367,7 +455,22 @@ protected:
 	 */
 	virtual S32 doParse(std::istream& istr, LLSD& data) const;
 
+	/** 
+	 * @brief Parse the binary stream into a handler.
+	 */
+	virtual S32 doParseEvents(std::istream& istr, LLSDParseHandler& handler) const;
+
 private:
+	/** 
+	 * @brief Parse one value, recursively, into a handler.
+	 *
+	 * @param istr The input stream.
+	 * @param handler The handler that receives the parsed values.
+	 * @param buffer Scratch space for strings, reused across values.
+	 * @return Returns The number of LLSD objects parsed.
+	 */
+	S32 parseEventValue(std::istream& istr, LLSDParseHandler& handler, std::string& buffer) const;
+
 	/** 
 	 * @brief Parse a map from the istream
 	 *
@@ -749,6 +852,11 @@ public:
 		LLPointer<LLSDNotationParser> p = new LLSDNotationParser;
 		return p->parse(str, sd, max_bytes);
 	}
+	static S32 fromNotation(LLSDParseHandler& handler, std::istream& str, S32 max_bytes)
+	{
+		LLPointer<LLSDNotationParser> p = new LLSDNotationParser;
+		return p->parse(str, handler, max_bytes);
+	}
 	static LLSD fromNotation(std::istream& str, S32 max_bytes)
 	{
 		LLPointer<LLSDNotationParser> p = new LLSDNotationParser;
@@ -791,6 +899,16 @@ public:
 		return fromXMLEmbedded(sd, str, emit_errors);
 //		return fromXMLDocument(sd, str, emit_errors);
 	}
+	static S32 fromXML(LLSDParseHandler& handler, std::istream& str, bool emit_errors=true)
+	{
+		LLPointer<LLSDXMLParser> p = new LLSDXMLParser(emit_errors);
+		return p->parse(str, handler, LLSDSerialize::SIZE_UNLIMITED);
+	}
+	static S32 fromXML(LLSDArena& arena, std::istream& str, bool emit_errors=true)
+	{
+		LLPointer<LLSDXMLParser> p = new LLSDXMLParser(emit_errors);
+		return p->parse(str, arena, LLSDSerialize::SIZE_UNLIMITED);
+	}
 
 	/*
 	 * Binary Methods
@@ -805,6 +923,16 @@ public:
 		LLPointer<LLSDBinaryParser> p = new LLSDBinaryParser;
 		return p->parse(str, sd, max_bytes);
 	}
+	static S32 fromBinary(LLSDParseHandler& handler, std::istream& str, S32 max_bytes)
+	{
+		LLPointer<LLSDBinaryParser> p = new LLSDBinaryParser;
+		return p->parse(str, handler, max_bytes);
+	}
+	static S32 fromBinary(LLSDArena& arena, std::istream& str, S32 max_bytes)
+	{
+		LLPointer<LLSDBinaryParser> p = new LLSDBinaryParser;
+		return p->parse(str, arena, max_bytes);
+	}
 	static LLSD fromBinary(std::istream& str, S32 max_bytes)
 	{
 		LLPointer<LLSDBinaryParser> p = new LLSDBinaryParser;
@@ -26,6 +26,7 @@
 
 #include "linden_common.h"
 #include "llsdserialize_xml.h"
+#include "llsdparsehandler.h"
 #include "llbase64.h"
 
 #include <iostream>
@@ -247,6 +248,9 @@ public:
 	S32 parse(std::istream& input, LLSD& data);
 	S32 parseLines(std::istream& input, LLSD& data);
 
+	// Report the document to a handler instead of building mResult.
+	S32 parse(std::istream& input, LLSDParseHandler& handler, bool lines);
+
 	void parsePart(const char *buf, int len);
 	
 	void reset();
@@ -264,6 +268,12 @@ private:
 		void* userData, const XML_Char* data, int length);
 
 	void startSkipping();
+
+	bool parseBuffered(std::istream& input);
+	bool parseByLines(std::istream& input);
+
+	bool startHandlerElement(int element);
+	void endHandlerElement(int element);
 	
 	enum Element {
 		ELEMENT_LLSD,
@@ -297,6 +307,10 @@ private:
 	
 	typedef std::deque<LLSD*> LLSDRefStack;
 	LLSDRefStack mStack;
+
+	LLSDParseHandler* mHandler;		// Non-NULL while parsing into a handler.
+	std::vector<bool> mHandlerStack;	// Open containers in handler mode, true for maps.
+	bool mInHandlerScalar;			// Inside a scalar element in handler mode.
 	
 	int mDepth;
 	bool mSkipping;
@@ -308,7 +322,7 @@ private:
 
 
 LLSDXMLParser::Impl::Impl(bool emit_errors)
-	: mEmitErrors(emit_errors)
+	: mEmitErrors(emit_errors), mHandler(NULL)
 {
 	mParser = XML_ParserCreate(NULL);
 	reset();
@@ -348,7 +362,7 @@ static unsigned get_till_eol(std::istream& input, char *buf, unsigned bufsize)
 	return count;
 }
 
-S32 LLSDXMLParser::Impl::parse(std::istream& input, LLSD& data)
+bool LLSDXMLParser::Impl::parseBuffered(std::istream& input)
 {
 	XML_Status status;
 	
@@ -397,22 +411,29 @@ S32 LLSDXMLParser::Impl::parse(std::istream& input, LLSD& data)
 		{
 			LL_INFOS() << "LLSDXMLParser::Impl::parse: XML_STATUS_ERROR parsing:" << (char*) buffer << LL_ENDL;
 		}
-		data = LLSD();
-		return LLSDParser::PARSE_FAILURE;
+		return false;
 	}
 
 	clear_eol(input);
+	return true;
+}
+
+S32 LLSDXMLParser::Impl::parse(std::istream& input, LLSD& data)
+{
+	if (!parseBuffered(input))
+	{
+		data = LLSD();
+		return LLSDParser::PARSE_FAILURE;
+	}
 	data = mResult;
 	return mParseCount;
 }
 
 
-S32 LLSDXMLParser::Impl::parseLines(std::istream& input, LLSD& data)
+bool LLSDXMLParser::Impl::parseByLines(std::istream& input)
 {
 	XML_Status status = XML_STATUS_OK;
 
-	data = LLSD();
-
 	static const int BUFFER_SIZE = 1024;
 
 	//static char last_buffer[ BUFFER_SIZE ];
@@ -478,14 +499,34 @@ S32 LLSDXMLParser::Impl::parseLines(std::istream& input, LLSD& data)
 		{
 			LL_INFOS() << "LLSDXMLParser::Impl::parseLines: XML_STATUS_ERROR" << LL_ENDL;
 		}
-		return LLSDParser::PARSE_FAILURE;
+		return false;
 	}
 
 	clear_eol(input);
+	return true;
+}
+
+S32 LLSDXMLParser::Impl::parseLines(std::istream& input, LLSD& data)
+{
+	data = LLSD();
+	if (!parseByLines(input))
+	{
+		return LLSDParser::PARSE_FAILURE;
+	}
 	data = mResult;
 	return mParseCount;
 }
 
+S32 LLSDXMLParser::Impl::parse(std::istream& input, LLSDParseHandler& handler, bool lines)
+{
+	mHandler = &handler;
+	mHandlerStack.clear();
+	mInHandlerScalar = false;
+	bool success = lines ? parseByLines(input) : parseBuffered(input);
+	mHandler = NULL;
+	return success ? mParseCount : LLSDParser::PARSE_FAILURE;
+}
+
 
 void LLSDXMLParser::Impl::reset()
 {
@@ -596,7 +637,8 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 			return;
 	
 		case ELEMENT_KEY:
-			if (mStack.empty()  ||  !(mStack.back()->isMap()))
+			if (mHandler ? (mInHandlerScalar || mHandlerStack.empty() || !mHandlerStack.back())
+						 : (mStack.empty()  ||  !(mStack.back()->isMap())))
 			{
 				return startSkipping();
 			}
@@ -616,6 +658,13 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
 	
 
 	if (!mInLLSDElement) { return startSkipping(); }
+
+	if (mHandler)
+	{
+		if (!startHandlerElement(element)) { return startSkipping(); }
+		++mParseCount;
+		return;
+	}
 	
 	if (mStack.empty())
 	{
@@ -700,6 +749,13 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 	
 	if (!mInLLSDElement) { return; }
 
+	if (mHandler)
+	{
+		endHandlerElement(element);
+		mCurrentContent.clear();
+		return;
+	}
+
 	LLSD& value = *mStack.back();
 	mStack.pop_back();
 	
@@ -792,6 +848,112 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 	mCurrentContent.clear();
 }
 
+bool LLSDXMLParser::Impl::startHandlerElement(int element)
+{
+	if (mInHandlerScalar)
+	{
+		// improperly nested value in a non-structure
+		return false;
+	}
+	if (!mHandlerStack.empty() && mHandlerStack.back())
+	{
+		if (mCurrentKey.empty()) { return false; }
+		mHandler->key(mCurrentKey);
+		mCurrentKey.clear();
+	}
+
+	switch (element)
+	{
+		case ELEMENT_MAP:
+			mHandler->beginMap();
+			mHandlerStack.push_back(true);
+			break;
+
+		case ELEMENT_ARRAY:
+			mHandler->beginArray();
+			mHandlerStack.push_back(false);
+			break;
+
+		default:
+			// all the other values will be reported in the end element handler
+			mInHandlerScalar = true;
+	}
+	return true;
+}
+
+// Same conversions as endElementHandler, but reported to mHandler.
+void LLSDXMLParser::Impl::endHandlerElement(int element)
+{
+	mInHandlerScalar = false;
+	switch (element)
+	{
+		case ELEMENT_MAP:
+			mHandlerStack.pop_back();
+			mHandler->endMap();
+			break;
+
+		case ELEMENT_ARRAY:
+			mHandlerStack.pop_back();
+			mHandler->endArray();
+			break;
+
+		case ELEMENT_BOOL:
+			mHandler->booleanValue(mCurrentContent == "true" || mCurrentContent == "1");
+			break;
+
+		case ELEMENT_INTEGER:
+			{
+				S32 i;
+				if ( sscanf(mCurrentContent.c_str(), "%d", &i ) == 1 )
+				{
+					mHandler->integerValue(i);
+				}
+				else
+				{
+					mHandler->integerValue(LLSD(mCurrentContent).asInteger());
+				}
+			}
+			break;
+
+		case ELEMENT_REAL:
+			mHandler->realValue(LLSD(mCurrentContent).asReal());
+			break;
+
+		case ELEMENT_STRING:
+			mHandler->stringValue(mCurrentContent);
+			break;
+
+		case ELEMENT_UUID:
+			mHandler->uuidValue(LLSD(mCurrentContent).asUUID());
+			break;
+
+		case ELEMENT_DATE:
+			mHandler->dateValue(LLSD(mCurrentContent).asDate());
+			break;
+
+		case ELEMENT_URI:
+			mHandler->uriValue(mCurrentContent);
+			break;
+
+		case ELEMENT_BINARY:
+		{
+			boost::regex r;
+			r.assign("\\s");
+			std::string stripped = boost::regex_replace(mCurrentContent, r, "");
+			size_t len = LLBase64::requiredDecryptionSpace(stripped);
+			std::vector<U8> data;
+			data.resize(len);
+			len = LLBase64::decode(stripped, len ? &data[0] : NULL, len);
+			mHandler->binaryValue(len ? &data[0] : NULL, len);
+			break;
+		}
+
+		default:
+			mHandler->undefinedValue();
+			break;
+	}
+}
+
 void LLSDXMLParser::Impl::characterDataHandler(const XML_Char* data, int length)
 {
 	#ifdef XML_PARSER_PERFORMANCE_TESTS
@@ -924,6 +1086,12 @@ S32 LLSDXMLParser::doParse(std::istream& input, LLSD& data) const
 	return impl.parse(input, data);
 }
 
+// virtual
+S32 LLSDXMLParser::doParseEvents(std::istream& input, LLSDParseHandler& handler) const
+{
+	return impl.parse(input, handler, mParseLines);
+}
+
 //	virtual 
 void LLSDXMLParser::doReset()
 {
@@ -0,0 +1,259 @@
+/**
+ * @file llsortedindex.cpp
+ * @brief Filtered, sorted view of the rows of a list model
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llsortedindex.h"
+
+#include <algorithm>
+
+struct LLSortedIndex::RowLess
+{
+	RowLess(const compare_t& compare) : mCompare(compare) {}
+
+	bool operator()(U32 lhs, U32 rhs) const
+	{
+		if (mCompare)
+		{
+			S32 order = mCompare(lhs, rhs);
+			if (order)
+			{
+				return order < 0;
+			}
+		}
+		return lhs < rhs;
+	}
+
+	const compare_t& mCompare;
+};
+
+namespace
+{
+
+struct IsFlagged
+{
+	IsFlagged(const std::vector<bool>& flags) : mFlags(flags) {}
+	bool operator()(U32 row) const { return mFlags[row]; }
+	const std::vector<bool>& mFlags;
+};
+
+// Drops the rows in [first, first + count) and renumbers the ones after them.
+void remove_range(std::vector<U32>& rows, U32 first, U32 count)
+{
+	const U32 end = first + count;
+	std::vector<U32>::iterator out = rows.begin();
+	for (std::vector<U32>::iterator it = rows.begin(); it != rows.end(); ++it)
+	{
+		const U32 row = *it;
+		if (row < first)
+		{
+			*out++ = row;
+		}
+		else if (row >= end)
+		{
+			*out++ = row - count;
+		}
+	}
+	rows.erase(out, rows.end());
+}
+
+void shift_from(std::vector<U32>& rows, U32 first, U32 count)
+{
+	for (std::vector<U32>::iterator it = rows.begin(); it != rows.end(); ++it)
+	{
+		if (*it >= first)
+		{
+			*it += count;
+		}
+	}
+}
+
+} // namespace
+
+LLSortedIndex::LLSortedIndex()
+:	mIndexOfRowValid(false),
+	mRowCount(0),
+	mNeedsRefilter(false),
+	mNeedsResort(false)
+{
+}
+
+void LLSortedIndex::setCompare(const compare_t& compare)
+{
+	mCompare = compare;
+	resort();
+}
+
+void LLSortedIndex::setFilter(const filter_t& filter)
+{
+	mFilter = filter;
+	refilter();
+}
+
+void LLSortedIndex::reset(U32 row_count)
+{
+	mRowCount = row_count;
+	mIndex.clear();
+	mIndexOfRowValid = false;
+	refilter();
+}
+
+void LLSortedIndex::insertRows(U32 first, U32 count)
+{
+	llassert(first <= mRowCount);
+	if (!count)
+	{
+		return;
+	}
+	shift_from(mIndex, first, count);
+	shift_from(mChanged, first, count);
+	mIsChanged.insert(mIsChanged.begin() + first, count, false);
+	mRowCount += count;
+	mIndexOfRowValid = false;
+	if (!mNeedsRefilter)
+	{
+		for (U32 row = first; row < first + count; ++row)
+		{
+			rowChanged(row);
+		}
+	}
+}
+
+void LLSortedIndex::removeRows(U32 first, U32 count)
+{
+	llassert(first + count <= mRowCount);
+	if (!count)
+	{
+		return;
+	}
+	// Taking rows out keeps the others in order.
+	remove_range(mIndex, first, count);
+	remove_range(mChanged, first, count);
+	mIsChanged.erase(mIsChanged.begin() + first, mIsChanged.begin() + first + count);
+	mRowCount -= count;
+	mIndexOfRowValid = false;
+}
+
+void LLSortedIndex::rowChanged(U32 row)
+{
+	llassert(row < mRowCount);
+	if (!mNeedsRefilter && !mIsChanged[row])
+	{
+		mIsChanged[row] = true;
+		mChanged.push_back(row);
+	}
+}
+
+void LLSortedIndex::resort()
+{
+	mNeedsResort = true;
+}
+
+void LLSortedIndex::refilter()
+{
+	// The rebuild places every row.
+	mChanged.clear();
+	mIsChanged.assign(mRowCount, false);
+	mNeedsRefilter = true;
+}
+
+bool LLSortedIndex::update()
+{
+	RowLess row_less(mCompare);
+
+	if (mNeedsRefilter)
+	{
+		mIndex.clear();
+		mIndex.reserve(mRowCount);
+		for (U32 row = 0; row < mRowCount; ++row)
+		{
+			if (!mFilter || mFilter(row))
+			{
+				mIndex.push_back(row);
+			}
+		}
+		if (mCompare)
+		{
+			std::sort(mIndex.begin(), mIndex.end(), row_less);
+		}
+		mNeedsRefilter = false;
+		mNeedsResort = false;
+		mIndexOfRowValid = false;
+		return true;
+	}
+
+	bool changed = false;
+	if (!mChanged.empty())
+	{
+		mIndex.erase(std::remove_if(mIndex.begin(), mIndex.end(), IsFlagged(mIsChanged)), mIndex.end());
+		const size_t sorted = mIndex.size();
+		for (std::vector<U32>::const_iterator it = mChanged.begin(); it != mChanged.end(); ++it)
+		{
+			mIsChanged[*it] = false;
+			if (!mFilter || mFilter(*it))
+			{
+				mIndex.push_back(*it);
+			}
+		}
+		mChanged.clear();
+		if (!mNeedsResort)
+		{
+			std::sort(mIndex.begin() + sorted, mIndex.end(), row_less);
+			std::inplace_merge(mIndex.begin(), mIndex.begin() + sorted, mIndex.end(), row_less);
+		}
+		changed = true;
+	}
+	if (mNeedsResort)
+	{
+		std::sort(mIndex.begin(), mIndex.end(), row_less);
+		mNeedsResort = false;
+		changed = true;
+	}
+	if (changed)
+	{
+		mIndexOfRowValid = false;
+	}
+	return changed;
+}
+
+S32 LLSortedIndex::getIndex(U32 row) const
+{
+	if (row >= mRowCount)
+	{
+		return -1;
+	}
+	if (!mIndexOfRowValid || mIndexOfRow.size() != mRowCount)
+	{
+		mIndexOfRow.assign(mRowCount, -1);
+		for (U32 i = 0; i < (U32)mIndex.size(); ++i)
+		{
+			mIndexOfRow[mIndex[i]] = (S32)i;
+		}
+		mIndexOfRowValid = true;
+	}
+	return mIndexOfRow[row];
+}
@@ -0,0 +1,99 @@
+/**
+ * @file llsortedindex.h
+ * @brief Filtered, sorted view of the rows of a list model
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLSORTEDINDEX_H
+#define LL_LLSORTEDINDEX_H
+
+#include <vector>
+#include <boost/function.hpp>
+
+//
+// The order in which a list shows the rows of a model, without copying the
+// rows. Rows are numbered 0 to getRowCount() - 1 in model order; the index
+// holds the numbers of the rows that pass the filter, sorted by the compare
+// function. Rows that compare equal keep model order, so the order does not
+// depend on the order of the updates.
+//
+// Changes are queued and applied by update(): the rows that changed are
+// taken out, sorted and merged back in, so that updating a few rows of a
+// long list does not sort it all again.
+//
+class LL_COMMON_API LLSortedIndex
+{
+public:
+	// Negative if lhs comes first, 0 if the rows are equal, like LLStringUtil::compareDict().
+	typedef boost::function<S32 (U32 lhs, U32 rhs)> compare_t;
+	// True to show the row.
+	typedef boost::function<bool (U32 row)> filter_t;
+
+	LLSortedIndex();
+
+	// No compare function keeps model order; no filter shows every row.
+	void setCompare(const compare_t& compare);
+	void setFilter(const filter_t& filter);
+
+	// The model changed completely and has row_count rows now. The index is
+	// empty until the next update().
+	void reset(U32 row_count);
+	// Rows were added before row first (or at the end), or removed starting at it.
+	// The rows after them are renumbered.
+	void insertRows(U32 first, U32 count);
+	void removeRows(U32 first, U32 count);
+	// The row's sort keys or filter result may have changed.
+	void rowChanged(U32 row);
+	// The compare function, or the filter, changed its mind about any row.
+	void resort();
+	void refilter();
+
+	// Applies the changes. Returns true if the rows shown or their order may have changed.
+	bool update();
+
+	// These describe the index as of the last update(), with the rows renumbered
+	// by any insertRows() or removeRows() since.
+	U32 size() const						{ return (U32)mIndex.size(); }
+	bool empty() const						{ return mIndex.empty(); }
+	U32 getRow(U32 index) const				{ return mIndex[index]; }
+	// Where the row is shown, or -1 if it is filtered out.
+	S32 getIndex(U32 row) const;
+	U32 getRowCount() const					{ return mRowCount; }
+
+private:
+	struct RowLess;
+
+	compare_t mCompare;
+	filter_t mFilter;
+	std::vector<U32> mIndex;
+	std::vector<U32> mChanged;				// Rows to take out and merge back in
+	std::vector<bool> mIsChanged;			// By row, so that mChanged has no duplicates
+	mutable std::vector<S32> mIndexOfRow;	// By row; built by getIndex() after an update
+	mutable bool mIndexOfRowValid;
+	U32 mRowCount;
+	bool mNeedsRefilter;
+	bool mNeedsResort;
+};
+
+#endif // LL_LLSORTEDINDEX_H
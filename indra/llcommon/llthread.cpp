@@ -297,13 +297,15 @@ void LLThread::wakeLocked()
 // The thread private handle to access the LLThreadLocalData instance.
 apr_threadkey_t* LLThreadLocalData::sThreadLocalDataKey;
 
-LLThreadLocalData::LLThreadLocalData(char const* name) : mCurlMultiHandle(NULL), mCurlErrorBuffer(NULL), mName(name)
+LLThreadLocalData::LLThreadLocalData(char const* name) : mCurlMultiHandle(NULL), mPrivatePoolCache(NULL), mTraceBuffer(NULL), mCurlErrorBuffer(NULL), mName(name)
 {
 }
 
 LLThreadLocalData::~LLThreadLocalData()
 {
   delete mCurlMultiHandle;
+  delete mPrivatePoolCache;
+  delete mTraceBuffer;
   delete [] mCurlErrorBuffer;
 }
 
@@ -66,6 +66,8 @@ public:
 	LLAPRRootPool mRootPool;
 	LLVolatileAPRPool mVolatileAPRPool;
 	LLThreadLocalDataMember* mCurlMultiHandle;	// Initialized by AICurlMultiHandle::getInstance
+	LLThreadLocalDataMember* mPrivatePoolCache;	// Initialized by LLPrivateMemoryPool::ThreadCache::get
+	LLThreadLocalDataMember* mTraceBuffer;		// Initialized by LLFastTimerTrace::record
 	char* mCurlErrorBuffer;						// NULL, or pointing to a buffer used by libcurl.
 	std::string mName;							// "main thread", or a copy of LLThread::mName.
 
@@ -0,0 +1,254 @@
+/**
+ * @file llthreadpool.cpp
+ * @brief A small set of worker threads for data parallel loops.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llthreadpool.h"
+
+#include <boost/thread/thread.hpp>
+
+#include "llformat.h"
+#include "llthread.h"
+
+// Upper limit on the number of threads, whatever the core count.
+static const S32 MAX_WORKERS = 16;
+
+// Chunks per participating thread, so that a thread that finishes early
+// can help with the rest.
+static const S32 CHUNKS_PER_THREAD = 4;
+
+namespace
+{
+
+struct Job
+{
+	const LLThreadPool::range_func_t* mFunc;
+	S32 mCount;
+	S32 mChunkSize;
+	S32 mChunks;
+	LLAtomicS32 mNextChunk;
+	LLAtomicS32 mChunksLeft;
+	LLAtomicS32 mUsers;				// Workers that still hold a pointer to this job.
+};
+
+class Worker;
+
+std::vector<Worker*> sWorkers;
+LLMutex* sJobMutex = NULL;				// Protects sJob.
+LLCondition* sDoneCondition = NULL;		// Signalled when the last chunk of a job finished.
+Job* sJob = NULL;
+LLAtomicU32 sGeneration(0);				// Incremented for every job handed out.
+
+void run_job(Job& job)
+{
+	S32 chunk;
+	while ((chunk = job.mNextChunk++) < job.mChunks)
+	{
+		S32 begin = chunk * job.mChunkSize;
+		S32 end = llmin(begin + job.mChunkSize, job.mCount);
+		(*job.mFunc)(begin, end);
+		if (!--job.mChunksLeft)
+		{
+			sDoneCondition->lock();
+			sDoneCondition->signal();
+			sDoneCondition->unlock();
+		}
+	}
+}
+
+class Worker : public LLThread
+{
+public:
+	Worker(S32 index)
+		: LLThread(llformat("ThreadPool %d", index)),
+		  mGeneration(sGeneration)
+	{
+	}
+
+protected:
+	/*virtual*/ bool runCondition()
+	{
+		return mGeneration != sGeneration;
+	}
+
+	/*virtual*/ void run()
+	{
+		while (true)
+		{
+			checkPause();
+			if (isQuitting())
+			{
+				break;
+			}
+
+			sJobMutex->lock();
+			mGeneration = sGeneration;
+			Job* job = sJob;
+			if (job)
+			{
+				job->mUsers++;
+			}
+			sJobMutex->unlock();
+
+			if (job)
+			{
+				run_job(*job);
+				--job->mUsers;
+			}
+		}
+	}
+
+private:
+	U32 mGeneration;				// Last job generation this worker looked at.
+};
+
+} // namespace
+
+//static
+void LLThreadPool::initClass(S32 workers)
+{
+	if (!sWorkers.empty())
+	{
+		return;
+	}
+	if (workers < 0)
+	{
+		workers = (S32)boost::thread::hardware_concurrency() - 1;
+	}
+	workers = llclamp(workers, 0, MAX_WORKERS);
+	if (!workers)
+	{
+		LL_INFOS() << "Thread pool disabled" << LL_ENDL;
+		return;
+	}
+
+	sJobMutex = new LLMutex;
+	sDoneCondition = new LLCondition;
+	for (S32 i = 0; i < workers; ++i)
+	{
+		Worker* worker = new Worker(i);
+		worker->start();
+		sWorkers.push_back(worker);
+	}
+	LL_INFOS() << "Thread pool started with " << workers << " worker threads" << LL_ENDL;
+}
+
+//static
+void LLThreadPool::cleanupClass()
+{
+	if (sWorkers.empty())
+	{
+		return;
+	}
+	// Make new loops run inline while the workers go away.
+	sJobMutex->lock();
+	std::vector<Worker*> workers;
+	workers.swap(sWorkers);
+	sJobMutex->unlock();
+
+	for (std::vector<Worker*>::iterator it = workers.begin(); it != workers.end(); ++it)
+	{
+		(*it)->setQuitting();
+	}
+	for (std::vector<Worker*>::iterator it = workers.begin(); it != workers.end(); ++it)
+	{
+		(*it)->shutdown();
+		delete *it;
+	}
+	delete sDoneCondition;
+	sDoneCondition = NULL;
+	delete sJobMutex;
+	sJobMutex = NULL;
+}
+
+//static
+S32 LLThreadPool::getWorkerCount()
+{
+	return (S32)sWorkers.size();
+}
+
+//static
+void LLThreadPool::parallelFor(S32 count, S32 grain, const range_func_t& func)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+	grain = llmax(grain, 1);
+	const S32 workers = (S32)sWorkers.size();
+	if (!workers || count <= grain)
+	{
+		func(0, count);
+		return;
+	}
+
+	Job job;
+	job.mFunc = &func;
+	job.mCount = count;
+	job.mChunkSize = llmax(grain, (count + (workers + 1) * CHUNKS_PER_THREAD - 1) / ((workers + 1) * CHUNKS_PER_THREAD));
+	job.mChunks = (count + job.mChunkSize - 1) / job.mChunkSize;
+	job.mNextChunk = 0;
+	job.mChunksLeft = job.mChunks;
+	job.mUsers = 0;
+
+	sJobMutex->lock();
+	if (sJob || sWorkers.empty())
+	{
+		// The pool is busy or shutting down.
+		sJobMutex->unlock();
+		func(0, count);
+		return;
+	}
+	sJob = &job;
+	sGeneration++;
+	sJobMutex->unlock();
+
+	for (std::vector<Worker*>::iterator it = sWorkers.begin(); it != sWorkers.end(); ++it)
+	{
+		(*it)->wake();
+	}
+
+	run_job(job);
+
+	sDoneCondition->lock();
+	while (job.mChunksLeft)
+	{
+		sDoneCondition->wait();
+	}
+	sDoneCondition->unlock();
+
+	sJobMutex->lock();
+	sJob = NULL;
+	sJobMutex->unlock();
+
+	// Workers that picked up the job after the last chunk was handed out
+	// are about to drop it; they must be done with it before it goes out
+	// of scope.
+	while (job.mUsers)
+	{
+		LLThread::yield();
+	}
+}
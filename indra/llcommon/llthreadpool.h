@@ -0,0 +1,74 @@
+/**
+ * @file llthreadpool.h
+ * @brief A small set of worker threads for data parallel loops.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTHREADPOOL_H
+#define LL_LLTHREADPOOL_H
+
+#include <boost/function.hpp>
+
+/**
+ * @class LLThreadPool
+ * @brief Runs the iterations of a loop on several cores at once.
+ *
+ * parallelFor() cuts the index range [0, count) into chunks, hands them
+ * out to the worker threads and to the calling thread, and returns when
+ * every chunk is done. The function is called with a half open range
+ * [begin, end) and must not depend on the order in which chunks run.
+ *
+ * Only one loop is distributed at a time. A loop that is started while
+ * another one is running (from another thread, or from inside a chunk)
+ * simply runs on the calling thread, as does every loop before
+ * initClass() or after cleanupClass(). Callers therefore never need to
+ * know whether the pool exists.
+ */
+class LL_COMMON_API LLThreadPool
+{
+public:
+	typedef boost::function<void (S32 begin, S32 end)> range_func_t;
+
+	/**
+	 * @brief Start the worker threads.
+	 *
+	 * @param workers Number of threads to start; a negative value starts
+	 * one less than there are cores, 0 disables the pool.
+	 */
+	static void initClass(S32 workers = -1);
+
+	// Call from the thread that called initClass(), with no loop running.
+	static void cleanupClass();
+
+	static S32 getWorkerCount();
+
+	/**
+	 * @brief Call func for every chunk of [0, count).
+	 *
+	 * @param grain The smallest chunk worth handing to another thread.
+	 * Ranges of at most this size always run on the calling thread.
+	 */
+	static void parallelFor(S32 count, S32 grain, const range_func_t& func);
+};
+
+#endif // LL_LLTHREADPOOL_H
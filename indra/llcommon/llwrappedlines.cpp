@@ -0,0 +1,142 @@
+/**
+ * @file llwrappedlines.cpp
+ * @brief Line starts of a word wrapped text, kept up to date as it is edited.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llwrappedlines.h"
+
+#include <algorithm>
+
+LLWrappedLines::LLWrappedLines()
+:	mChangeStart(0),
+	mChangeEnd(0),
+	mChangeDelta(0),
+	mWrappedCount(0),
+	mChanged(false),
+	mValid(false)
+{
+}
+
+void LLWrappedLines::noteChange(S32 pos, S32 removed, S32 inserted)
+{
+	if (!mValid)
+	{
+		return;
+	}
+	if (!mChanged)
+	{
+		mChangeStart = pos;
+		mChangeEnd = pos + inserted;
+		mChangeDelta = inserted - removed;
+		mChanged = true;
+		return;
+	}
+	// The text after the earlier changes and after this one is as it was.
+	mChangeEnd = llmax(mChangeEnd, pos + removed) + inserted - removed;
+	mChangeStart = llmin(mChangeStart, pos);
+	mChangeDelta += inserted - removed;
+}
+
+void LLWrappedLines::invalidate()
+{
+	mValid = false;
+	mChanged = false;
+}
+
+void LLWrappedLines::update(const LLWString& text, const wrap_t& wrap, S32 keep_from)
+{
+	mWrappedCount = 0;
+	if (!needsUpdate())
+	{
+		return;
+	}
+
+	const S32 text_len = (S32)text.length();
+	std::vector<S32> old_lines;
+	S32 start = 0;
+	// Old lines are only kept for paragraphs whose newline did not change
+	S32 sync_from = text_len + 1;
+	if (mValid && !mLines.empty())
+	{
+		// The paragraph that holds the first change
+		start = llclamp(mChangeStart, 0, text_len);
+		while (start > 0 && text[start - 1] != '\n')
+		{
+			--start;
+		}
+		std::vector<S32>::iterator first = std::lower_bound(mLines.begin(), mLines.end(), start);
+		old_lines.assign(first, mLines.end());
+		mLines.erase(first, mLines.end());
+		sync_from = llmax(mChangeEnd + 1, keep_from);
+	}
+	else
+	{
+		mLines.clear();
+	}
+
+	while (true)
+	{
+		if (start >= sync_from)
+		{
+			const S32 old_start = start - mChangeDelta;
+			std::vector<S32>::iterator it = std::lower_bound(old_lines.begin(), old_lines.end(), old_start);
+			if (it != old_lines.end() && *it == old_start)
+			{
+				// This paragraph and the ones after it did not change
+				for (; it != old_lines.end(); ++it)
+				{
+					mLines.push_back(*it + mChangeDelta);
+				}
+				break;
+			}
+		}
+
+		mLines.push_back(start);
+		S32 end = start;
+		while (end < text_len && text[end] != '\n')
+		{
+			++end;
+		}
+		wrap(start, end, mLines);
+		++mWrappedCount;
+		if (end >= text_len)
+		{
+			break;
+		}
+		start = end + 1;
+	}
+
+	mChanged = false;
+	mChangeDelta = 0;
+	mValid = true;
+}
+
+S32 LLWrappedLines::getLine(S32 pos) const
+{
+	std::vector<S32>::const_iterator it = std::upper_bound(mLines.begin(), mLines.end(), pos);
+	return it == mLines.begin() ? 0 : (S32)(it - mLines.begin()) - 1;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file llwrappedlines.h
+ * @brief Line starts of a word wrapped text, kept up to date as it is edited.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLWRAPPEDLINES_H
+#define LL_LLWRAPPEDLINES_H
+
+#include <vector>
+#include <boost/function.hpp>
+
+#include "llstring.h"
+
+//
+// Where the lines of a word wrapped text start. Every newline starts a
+// paragraph, which wraps into one or more lines; a text that ends with a
+// newline ends with an empty line.
+//
+// Editors report each edit with noteChange(), and update() wraps only the
+// paragraphs that changed: it starts at the paragraph that holds the first
+// change, and stops at the first paragraph after the last change that also
+// started a paragraph before the edits. The lines after it are the old
+// ones, moved by the change in length.
+//
+class LL_COMMON_API LLWrappedLines
+{
+public:
+	// Appends to lines where the lines of the paragraph [start, end) wrap,
+	// not counting start itself. end is the newline or the end of the text.
+	typedef boost::function<void (S32 start, S32 end, std::vector<S32>& lines)> wrap_t;
+
+	LLWrappedLines();
+
+	// Characters from pos on were removed, and others inserted in their place.
+	void noteChange(S32 pos, S32 removed, S32 inserted);
+	// The next update() wraps the whole text, as when the width or the font changed.
+	void invalidate();
+
+	bool isValid() const					{ return mValid; }
+	// Whether update() has work to do
+	bool needsUpdate() const				{ return !mValid || mChanged; }
+	// The text that changed since the last update(), from start to end of
+	// the current text, and the change in its length. Only when isValid().
+	bool isChanged() const					{ return mChanged; }
+	S32 getChangeStart() const				{ return mChangeStart; }
+	S32 getChangeEnd() const				{ return mChangeEnd; }
+	S32 getChangeDelta() const				{ return mChangeDelta; }
+
+	// Wraps the paragraphs of text that changed. Old lines are only kept
+	// from keep_from on, for wrap functions that depend on more than the
+	// characters of a paragraph, like the colors of a highlighter that did
+	// not redo the whole text.
+	void update(const LLWString& text, const wrap_t& wrap, S32 keep_from = 0);
+
+	// As of the last update()
+	S32 getLineCount() const				{ return (S32)mLines.size(); }
+	S32 getLineStart(S32 line) const		{ return mLines[line]; }
+	// The line that holds pos
+	S32 getLine(S32 pos) const;
+	// Paragraphs wrapped by the last update()
+	S32 getWrappedCount() const				{ return mWrappedCount; }
+
+private:
+	std::vector<S32> mLines;
+	S32 mChangeStart;
+	S32 mChangeEnd;
+	S32 mChangeDelta;
+	S32 mWrappedCount;
+	bool mChanged;
+	bool mValid;
+};
+
+#endif // LL_LLWRAPPEDLINES_H
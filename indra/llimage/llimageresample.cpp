@@ -0,0 +1,622 @@
+/**
+ * @file llimageresample.cpp
+ * @brief Scaling and mipmap generation for raw image buffers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimageresample.h"
+
+#include <emmintrin.h>
+
+#include "llmath.h"
+#include "llthreadpool.h"
+
+// Smallest number of rows handed to another thread.
+static const S32 ROW_GRAIN = 8;
+
+// Size of the level 0 band of rows that generateMipChain() takes through
+// all of its banded levels at once; about the size of an L2 cache.
+static const S32 MIP_BAND_BYTES = 256 * 1024;
+
+//----------------------------------------------------------------------------
+// Box filter
+//----------------------------------------------------------------------------
+
+// The source pixels covered by one output pixel: index0 is covered for
+// fract0, index0 + 1 up to index1 - 1 completely and index1 for fract1.
+struct BoxSpan
+{
+	S32 mIndex0;
+	S32 mIndex1;
+	F32 mFract0;
+	F32 mFract1;
+};
+
+static inline void get_box_span(S32 x, F32 ratio, BoxSpan& span)
+{
+	// Avoid floating point accumulation error... don't just add ratio each time.  JC
+	const F32 sample0 = x * ratio;
+	const F32 sample1 = (x+1) * ratio;
+	span.mIndex0 = llfloor(sample0);					// left integer (floor)
+	span.mIndex1 = llfloor(sample1);					// right integer (floor)
+	span.mFract0 = 1.f - (sample0 - F32(span.mIndex0));	// spill over on left
+	span.mFract1 = sample1 - F32(span.mIndex1);			// spill-over on right
+}
+
+// Four non-negative floats to integers, rounded like ll_round().
+static inline __m128i round_ps(__m128 v)
+{
+#ifdef LL_CPP11
+	// round(): halfway cases away from zero.
+	__m128i i = _mm_cvttps_epi32(v);
+	__m128 frac = _mm_sub_ps(v, _mm_cvtepi32_ps(i));
+	__m128i up = _mm_castps_si128(_mm_cmpge_ps(frac, _mm_set1_ps(0.5f)));
+	return _mm_sub_epi32(i, up);					// up is -1 where true.
+#else
+	// floor(v + 0.5f)
+	return _mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(0.5f)));
+#endif
+}
+
+// Sixteen bytes to four vectors of floats.
+static inline void load_bytes(const U8* p, __m128* v)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i b = _mm_loadu_si128((const __m128i*)p);
+	__m128i lo = _mm_unpacklo_epi8(b, zero);
+	__m128i hi = _mm_unpackhi_epi8(b, zero);
+	v[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+	v[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+	v[2] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+	v[3] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+}
+
+// Four vectors of floats to sixteen bytes.
+static inline void store_bytes(const __m128* v, U8* p)
+{
+	__m128i lo = _mm_packs_epi32(round_ps(v[0]), round_ps(v[1]));
+	__m128i hi = _mm_packs_epi32(round_ps(v[2]), round_ps(v[3]));
+	_mm_storeu_si128((__m128i*)p, _mm_packus_epi16(lo, hi));
+}
+
+// One RGBA pixel to a vector of floats.
+static inline __m128 load_pixel(const U8* p)
+{
+	const __m128i zero = _mm_setzero_si128();
+	S32 bits;
+	memcpy(&bits, p, sizeof(bits));
+	__m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero);
+	return _mm_cvtepi32_ps(_mm_unpacklo_epi16(b, zero));
+}
+
+static inline void store_pixel(__m128 v, U8* p)
+{
+	__m128i i = _mm_packs_epi32(round_ps(v), _mm_setzero_si128());
+	S32 bits = _mm_cvtsi128_si32(_mm_packus_epi16(i, i));
+	memcpy(p, &bits, sizeof(bits));
+}
+
+// Scalar box filter of one line of pixels, the former LLImageRaw::copyLineScaled().
+// Steps are in pixels.
+static void scale_line(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step, S32 components)
+{
+	llassert( components >= 1 && components <= 4 );
+
+	const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
+	const F32 norm_factor = 1.f / ratio;
+
+	S32 goff = components >= 2 ? 1 : 0;
+	S32 boff = components >= 3 ? 2 : 0;
+	for( S32 x = 0; x < out_pixel_len; x++ )
+	{
+		BoxSpan span;
+		get_box_span(x, ratio, span);
+		const S32 index0 = span.mIndex0;
+		const S32 index1 = span.mIndex1;
+		const F32 fract0 = span.mFract0;
+		const F32 fract1 = span.mFract1;
+
+		if( index0 == index1 )
+		{
+			// Interval is embedded in one input pixel
+			memcpy(out + x * out_pixel_step * components, in + index0 * in_pixel_step * components, components);
+			continue;
+		}
+
+		// Left straddle
+		S32 t1 = index0 * in_pixel_step * components;
+		F32 r = in[t1 + 0] * fract0;
+		F32 g = in[t1 + goff] * fract0;
+		F32 b = in[t1 + boff] * fract0;
+		F32 a = 0;
+		if( components == 4)
+		{
+			a = in[t1 + 3] * fract0;
+		}
+
+		// Central interval
+		for( S32 u = index0 + 1; u < index1; u++ )
+		{
+			S32 t2 = u * in_pixel_step * components;
+			r += in[t2 + 0];
+			g += in[t2 + goff];
+			b += in[t2 + boff];
+			if (components == 4)
+			{
+				a += in[t2 + 3];
+			}
+		}
+
+		// right straddle
+		// Watch out for reading off of end of input array.
+		if( fract1 && index1 < in_pixel_len )
+		{
+			S32 t3 = index1 * in_pixel_step * components;
+			r += in[t3 + 0] * fract1;
+			g += in[t3 + goff] * fract1;
+			b += in[t3 + boff] * fract1;
+			if (components == 4)
+			{
+				a += in[t3 + 3] * fract1;
+			}
+		}
+
+		r *= norm_factor;
+		g *= norm_factor;
+		b *= norm_factor;
+		a *= norm_factor;  // skip conditional
+
+		S32 t4 = x * out_pixel_step * components;
+		out[t4 + 0] = U8(ll_round(r));
+		if (components >= 2)
+			out[t4 + 1] = U8(ll_round(g));
+		if (components >= 3)
+			out[t4 + 2] = U8(ll_round(b));
+		if( components == 4)
+			out[t4 + 3] = U8(ll_round(a));
+	}
+}
+
+// Vertical pass. Every output row is a weighted sum of whole input rows,
+// so the rows are filtered as flat byte arrays, sixteen bytes at a time.
+struct ScaleVertical
+{
+	const U8* mIn;
+	U8* mOut;
+	S32 mRowBytes;
+	S32 mInHeight;
+	S32 mOutHeight;
+
+	void operator()(S32 begin, S32 end) const
+	{
+		const F32 ratio = F32(mInHeight) / mOutHeight;
+		const F32 norm_factor = 1.f / ratio;
+		const __m128 norm = _mm_set1_ps(norm_factor);
+		for (S32 y = begin; y < end; ++y)
+		{
+			BoxSpan span;
+			get_box_span(y, ratio, span);
+			U8* outp = mOut + y * mRowBytes;
+			const U8* in0 = mIn + span.mIndex0 * mRowBytes;
+			if (span.mIndex0 == span.mIndex1)
+			{
+				memcpy(outp, in0, mRowBytes);
+				continue;
+			}
+			const bool right = span.mFract1 && span.mIndex1 < mInHeight;
+			const U8* in1 = mIn + span.mIndex1 * mRowBytes;
+			const __m128 fract0 = _mm_set1_ps(span.mFract0);
+			const __m128 fract1 = _mm_set1_ps(span.mFract1);
+
+			S32 i = 0;
+			for ( ; i + 16 <= mRowBytes; i += 16)
+			{
+				__m128 acc[4], v[4];
+				load_bytes(in0 + i, acc);
+				for (S32 k = 0; k < 4; ++k)
+				{
+					acc[k] = _mm_mul_ps(acc[k], fract0);
+				}
+				for (S32 u = span.mIndex0 + 1; u < span.mIndex1; ++u)
+				{
+					load_bytes(mIn + u * mRowBytes + i, v);
+					for (S32 k = 0; k < 4; ++k)
+					{
+						acc[k] = _mm_add_ps(acc[k], v[k]);
+					}
+				}
+				if (right)
+				{
+					load_bytes(in1 + i, v);
+					for (S32 k = 0; k < 4; ++k)
+					{
+						acc[k] = _mm_add_ps(acc[k], _mm_mul_ps(v[k], fract1));
+					}
+				}
+				for (S32 k = 0; k < 4; ++k)
+				{
+					acc[k] = _mm_mul_ps(acc[k], norm);
+				}
+				store_bytes(acc, outp + i);
+			}
+			for ( ; i < mRowBytes; ++i)
+			{
+				F32 acc = in0[i] * span.mFract0;
+				for (S32 u = span.mIndex0 + 1; u < span.mIndex1; ++u)
+				{
+					acc += mIn[u * mRowBytes + i];
+				}
+				if (right)
+				{
+					acc += in1[i] * span.mFract1;
+				}
+				acc *= norm_factor;
+				outp[i] = U8(ll_round(acc));
+			}
+		}
+	}
+};
+
+// Horizontal pass; RGBA pixels are filtered as one vector each.
+struct ScaleHorizontal
+{
+	const U8* mIn;
+	U8* mOut;
+	S32 mInWidth;
+	S32 mOutWidth;
+	S32 mComponents;
+	const BoxSpan* mSpans;			// One per output pixel, RGBA only.
+
+	void operator()(S32 begin, S32 end) const
+	{
+		const S32 in_row = mInWidth * mComponents;
+		const S32 out_row = mOutWidth * mComponents;
+		if (mComponents != 4)
+		{
+			for (S32 y = begin; y < end; ++y)
+			{
+				scale_line(mIn + y * in_row, mOut + y * out_row, mInWidth, mOutWidth, 1, 1, mComponents);
+			}
+			return;
+		}
+
+		const __m128 norm = _mm_set1_ps(1.f / (F32(mInWidth) / mOutWidth));
+		for (S32 y = begin; y < end; ++y)
+		{
+			const U8* in = mIn + y * in_row;
+			U8* out = mOut + y * out_row;
+			for (S32 x = 0; x < mOutWidth; ++x)
+			{
+				const BoxSpan& span = mSpans[x];
+				if (span.mIndex0 == span.mIndex1)
+				{
+					memcpy(out + x * 4, in + span.mIndex0 * 4, 4);
+					continue;
+				}
+				__m128 acc = _mm_mul_ps(load_pixel(in + span.mIndex0 * 4), _mm_set1_ps(span.mFract0));
+				for (S32 u = span.mIndex0 + 1; u < span.mIndex1; ++u)
+				{
+					acc = _mm_add_ps(acc, load_pixel(in + u * 4));
+				}
+				if (span.mFract1 && span.mIndex1 < mInWidth)
+				{
+					acc = _mm_add_ps(acc, _mm_mul_ps(load_pixel(in + span.mIndex1 * 4), _mm_set1_ps(span.mFract1)));
+				}
+				store_pixel(_mm_mul_ps(acc, norm), out + x * 4);
+			}
+		}
+	}
+};
+
+//static
+void LLImageResample::scaleVertical(const U8* in, S32 width, S32 in_height,
+									U8* out, S32 out_height, S32 components)
+{
+	llassert(width > 0 && in_height > 0 && out_height > 0);
+	ScaleVertical pass = { in, out, width * components, in_height, out_height };
+	if (width * llmax(in_height, out_height) >= PARALLEL_PIXELS)
+	{
+		LLThreadPool::parallelFor(out_height, ROW_GRAIN, pass);
+	}
+	else
+	{
+		pass(0, out_height);
+	}
+}
+
+//static
+void LLImageResample::scaleHorizontal(const U8* in, S32 in_width, S32 height,
+									  U8* out, S32 out_width, S32 components)
+{
+	llassert(in_width > 0 && height > 0 && out_width > 0);
+	std::vector<BoxSpan> spans;
+	if (components == 4)
+	{
+		const F32 ratio = F32(in_width) / out_width;
+		spans.resize(out_width);
+		for (S32 x = 0; x < out_width; ++x)
+		{
+			get_box_span(x, ratio, spans[x]);
+		}
+	}
+	ScaleHorizontal pass = { in, out, in_width, out_width, components, spans.empty() ? NULL : &spans[0] };
+	if (llmax(in_width, out_width) * height >= PARALLEL_PIXELS)
+	{
+		LLThreadPool::parallelFor(height, ROW_GRAIN, pass);
+	}
+	else
+	{
+		pass(0, height);
+	}
+}
+
+//static
+void LLImageResample::scale(const U8* in, S32 in_width, S32 in_height,
+							U8* out, S32 out_width, S32 out_height, S32 components)
+{
+	if (in_width == out_width && in_height == out_height)
+	{
+		memcpy(out, in, in_width * in_height * components);
+		return;
+	}
+	if (in_width == out_width)
+	{
+		scaleVertical(in, in_width, in_height, out, out_height, components);
+		return;
+	}
+	if (in_height == out_height)
+	{
+		scaleHorizontal(in, in_width, in_height, out, out_width, components);
+		return;
+	}
+	std::vector<U8> temp(in_width * out_height * components);
+	scaleVertical(in, in_width, in_height, &temp[0], out_height, components);
+	scaleHorizontal(&temp[0], in_width, out_height, out, out_width, components);
+}
+
+//----------------------------------------------------------------------------
+// Mipmaps
+//----------------------------------------------------------------------------
+
+// Average the 2x2 blocks of rows [begin, end) of out. width is that of out.
+static void mip_rows(const U8* in, U8* out, S32 width, S32 components, S32 begin, S32 end)
+{
+	const S32 out_row = width * components;
+	const S32 in_row = out_row * 2;
+	const __m128i zero = _mm_setzero_si128();
+	for (S32 y = begin; y < end; ++y)
+	{
+		const U8* in0 = in + 2 * y * in_row;
+		const U8* in1 = in0 + in_row;
+		U8* outp = out + y * out_row;
+		S32 x = 0;				// Output byte.
+		if (components == 4)
+		{
+			// Four output pixels from two times eight input pixels.
+			for ( ; x + 16 <= out_row; x += 16)
+			{
+				const U8* p0 = in0 + 2 * x;
+				const U8* p1 = in1 + 2 * x;
+				__m128i a0 = _mm_loadu_si128((const __m128i*)p0);
+				__m128i a1 = _mm_loadu_si128((const __m128i*)(p0 + 16));
+				__m128i b0 = _mm_loadu_si128((const __m128i*)p1);
+				__m128i b1 = _mm_loadu_si128((const __m128i*)(p1 + 16));
+				// Vertical sums, two pixels per register.
+				__m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+				__m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+				__m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+				__m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+				// Add the right pixel of each pair to the left one.
+				s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+				s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+				s2 = _mm_add_epi16(s2, _mm_srli_si128(s2, 8));
+				s3 = _mm_add_epi16(s3, _mm_srli_si128(s3, 8));
+				__m128i r0 = _mm_srli_epi16(_mm_unpacklo_epi64(s0, s1), 2);
+				__m128i r1 = _mm_srli_epi16(_mm_unpacklo_epi64(s2, s3), 2);
+				_mm_storeu_si128((__m128i*)(outp + x), _mm_packus_epi16(r0, r1));
+			}
+		}
+		else if (components == 1)
+		{
+			// Sixteen output pixels from two times thirty two input pixels.
+			const __m128i ones = _mm_set1_epi16(1);
+			for ( ; x + 16 <= out_row; x += 16)
+			{
+				const U8* p0 = in0 + 2 * x;
+				const U8* p1 = in1 + 2 * x;
+				__m128i a0 = _mm_loadu_si128((const __m128i*)p0);
+				__m128i a1 = _mm_loadu_si128((const __m128i*)(p0 + 16));
+				__m128i b0 = _mm_loadu_si128((const __m128i*)p1);
+				__m128i b1 = _mm_loadu_si128((const __m128i*)(p1 + 16));
+				__m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+				__m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+				__m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+				__m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+				// Horizontal pair sums.
+				__m128i r0 = _mm_packs_epi32(_mm_madd_epi16(s0, ones), _mm_madd_epi16(s1, ones));
+				__m128i r1 = _mm_packs_epi32(_mm_madd_epi16(s2, ones), _mm_madd_epi16(s3, ones));
+				r0 = _mm_srli_epi16(r0, 2);
+				r1 = _mm_srli_epi16(r1, 2);
+				_mm_storeu_si128((__m128i*)(outp + x), _mm_packus_epi16(r0, r1));
+			}
+		}
+		// Whatever is left, and all of 2 and 3 component images.
+		for ( ; x < out_row; ++x)
+		{
+			const S32 i = 2 * x - x % components;
+			outp[x] = (U8)(((U32)in0[i] + in0[i + components] + in1[i] + in1[i + components]) >> 2);
+		}
+	}
+}
+
+struct MipLevel
+{
+	const U8* mIn;
+	U8* mOut;
+	S32 mWidth;
+	S32 mComponents;
+
+	void operator()(S32 begin, S32 end) const
+	{
+		mip_rows(mIn, mOut, mWidth, mComponents, begin, end);
+	}
+};
+
+// Takes each band of level 0 rows through the first mLevels levels.
+struct MipBands
+{
+	const U8* mIn;
+	U8* const* mMips;
+	S32 mWidth;
+	S32 mHeight;
+	S32 mComponents;
+	S32 mLevels;
+	S32 mBandRows;				// Level 0 rows per band, a multiple of 1 << mLevels.
+
+	void operator()(S32 begin, S32 end) const
+	{
+		for (S32 band = begin; band < end; ++band)
+		{
+			for (S32 level = 1; level <= mLevels; ++level)
+			{
+				const S32 height = mHeight >> level;
+				const S32 first = (band * mBandRows) >> level;
+				const S32 last = llmin(((band + 1) * mBandRows) >> level, height);
+				const U8* in = level == 1 ? mIn : mMips[level - 2];
+				mip_rows(in, mMips[level - 1], mWidth >> level, mComponents, first, last);
+			}
+		}
+	}
+};
+
+//static
+void LLImageResample::generateMip(const U8* in, U8* out, S32 width, S32 height, S32 components)
+{
+	llassert(width > 0 && height > 0);
+	llassert(components >= 1 && components <= 4);
+	MipLevel pass = { in, out, width, components };
+	if (width * height * 4 >= PARALLEL_PIXELS)
+	{
+		LLThreadPool::parallelFor(height, ROW_GRAIN, pass);
+	}
+	else
+	{
+		pass(0, height);
+	}
+}
+
+//static
+void LLImageResample::generateMipChain(const U8* in, S32 width, S32 height, S32 components,
+									   U8* const* mips, S32 levels)
+{
+	llassert(components >= 1 && components <= 4);
+	if (levels <= 0)
+	{
+		return;
+	}
+
+	// Band as many levels as fit in a band of MIP_BAND_BYTES.
+	S32 banded = 1;
+	const S32 row_bytes = width * components;
+	while (banded < levels && (row_bytes << (banded + 1)) <= MIP_BAND_BYTES && (height >> (banded + 1)) > 0)
+	{
+		++banded;
+	}
+	const S32 band_rows = 1 << banded;
+	const S32 bands = (height + band_rows - 1) / band_rows;
+	MipBands pass = { in, mips, width, height, components, banded, band_rows };
+	if (width * height >= PARALLEL_PIXELS)
+	{
+		LLThreadPool::parallelFor(bands, 1, pass);
+	}
+	else
+	{
+		pass(0, bands);
+	}
+
+	// The remaining levels are at most 1/16th of the size of level 0.
+	for (S32 level = banded + 1; level <= levels; ++level)
+	{
+		generateMip(mips[level - 2], mips[level - 1], width >> level, height >> level, components);
+	}
+}
+
+//----------------------------------------------------------------------------
+// Compositing
+//----------------------------------------------------------------------------
+
+// Calculates (U8)(255*(a/255.f)*(b/255.f) + 0.5f).  Thanks, Jim Blinn!
+static inline U8 fast_fractional_mult(U8 a, U8 b)
+{
+	U32 i = a * b + 128;
+	return U8((i + (i>>8)) >> 8);
+}
+
+struct Composite4onto3
+{
+	const U8* mSrc;
+	U8* mDst;
+
+	void operator()(S32 begin, S32 end) const
+	{
+		const U8* src_data = mSrc + begin * 4;
+		U8* dst_data = mDst + begin * 3;
+		for (S32 pixels = end - begin; pixels--; src_data += 4, dst_data += 3)
+		{
+			U8 alpha = src_data[3];
+			if (!alpha)
+			{
+				continue;
+			}
+			if (255 == alpha)
+			{
+				dst_data[0] = src_data[0];
+				dst_data[1] = src_data[1];
+				dst_data[2] = src_data[2];
+			}
+			else
+			{
+				U8 transparency = 255 - alpha;
+				dst_data[0] = fast_fractional_mult( dst_data[0], transparency ) + fast_fractional_mult( src_data[0], alpha );
+				dst_data[1] = fast_fractional_mult( dst_data[1], transparency ) + fast_fractional_mult( src_data[1], alpha );
+				dst_data[2] = fast_fractional_mult( dst_data[2], transparency ) + fast_fractional_mult( src_data[2], alpha );
+			}
+		}
+	}
+};
+
+//static
+void LLImageResample::composite4onto3(const U8* src, U8* dst, S32 pixels)
+{
+	Composite4onto3 pass = { src, dst };
+	if (pixels >= PARALLEL_PIXELS)
+	{
+		LLThreadPool::parallelFor(pixels, 64 * 1024, pass);
+	}
+	else
+	{
+		pass(0, pixels);
+	}
+}
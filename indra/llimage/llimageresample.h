@@ -0,0 +1,92 @@
+/**
+ * @file llimageresample.h
+ * @brief Scaling and mipmap generation for raw image buffers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGERESAMPLE_H
+#define LL_LLIMAGERESAMPLE_H
+
+/**
+ * @class LLImageResample
+ * @brief SSE2 kernels behind LLImageRaw::scale() and LLImageBase::generateMip().
+ *
+ * Buffers are tightly packed rows of 1 to 4 byte components. The results
+ * are bit for bit the same as those of the original per pixel loops; the
+ * box filter averages every source pixel that an output pixel covers,
+ * weighting partially covered pixels by their coverage.
+ *
+ * Large images are split into bands of rows that are processed on
+ * LLThreadPool, so everything here may be called from any thread.
+ */
+class LLImageResample
+{
+public:
+	enum
+	{
+		// Images with at least this many pixels are split across threads.
+		PARALLEL_PIXELS = 1024 * 1024
+	};
+
+	/**
+	 * @brief Box filter an image to a new size, vertically first.
+	 *
+	 * in and out must not overlap.
+	 */
+	static void scale(const U8* in, S32 in_width, S32 in_height,
+					  U8* out, S32 out_width, S32 out_height, S32 components);
+
+	// Change the height only, out is width x out_height.
+	static void scaleVertical(const U8* in, S32 width, S32 in_height,
+							  U8* out, S32 out_height, S32 components);
+
+	// Change the width only, out is out_width x height.
+	static void scaleHorizontal(const U8* in, S32 in_width, S32 height,
+								U8* out, S32 out_width, S32 components);
+
+	/**
+	 * @brief Average 2x2 blocks of in into out.
+	 *
+	 * width and height are those of out; in is twice as wide and high.
+	 */
+	static void generateMip(const U8* in, U8* out, S32 width, S32 height, S32 components);
+
+	/**
+	 * @brief Generate levels 1 to levels of a mip chain in one pass.
+	 *
+	 * in is level 0 of width x height pixels, mips[i] receives level i + 1.
+	 * The top levels are produced together, one band of rows at a time,
+	 * so that every source row is still in the cache when the next level
+	 * reads it. The output is the same as that of successive
+	 * generateMip() calls.
+	 */
+	static void generateMipChain(const U8* in, S32 width, S32 height, S32 components,
+								 U8* const* mips, S32 levels);
+
+	/**
+	 * @brief Alpha blend RGBA src onto RGB dst; both hold the same number of pixels.
+	 */
+	static void composite4onto3(const U8* src, U8* dst, S32 pixels);
+};
+
+#endif // LL_LLIMAGERESAMPLE_H
@@ -0,0 +1,228 @@
+/**
+ * @file llimageresample_test.cpp
+ * @date 2026-10
+ * @brief LLImageResample unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "../llcommon/linden_common.h"
+#include <vector>
+// Class to test
+#include "../llimageresample.h"
+#include "../llmath/llmath.h"
+#include "../llcommon/llformat.h"
+#include "../llcommon/llthreadpool.h"
+// Tut header
+#include "../test/lltestrandom.h"
+#include "../test/lltut.h"
+
+// -------------------------------------------------------------------------------------------
+// Reference implementations: the per pixel loops that LLImageResample replaced.
+// The new code must produce exactly the same bytes.
+// -------------------------------------------------------------------------------------------
+
+static void ref_line_scaled(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step, S32 components)
+{
+	const F32 ratio = F32(in_pixel_len) / out_pixel_len;
+	const F32 norm_factor = 1.f / ratio;
+	S32 goff = components >= 2 ? 1 : 0;
+	S32 boff = components >= 3 ? 2 : 0;
+	for (S32 x = 0; x < out_pixel_len; x++)
+	{
+		const F32 sample0 = x * ratio;
+		const F32 sample1 = (x+1) * ratio;
+		const S32 index0 = llfloor(sample0);
+		const S32 index1 = llfloor(sample1);
+		const F32 fract0 = 1.f - (sample0 - F32(index0));
+		const F32 fract1 = sample1 - F32(index1);
+		if (index0 == index1)
+		{
+			for (S32 i = 0; i < components; ++i)
+			{
+				out[x * out_pixel_step * components + i] = in[index0 * in_pixel_step * components + i];
+			}
+			continue;
+		}
+		S32 t1 = index0 * in_pixel_step * components;
+		F32 r = in[t1 + 0] * fract0;
+		F32 g = in[t1 + goff] * fract0;
+		F32 b = in[t1 + boff] * fract0;
+		F32 a = components == 4 ? in[t1 + 3] * fract0 : 0.f;
+		for (S32 u = index0 + 1; u < index1; u++)
+		{
+			S32 t2 = u * in_pixel_step * components;
+			r += in[t2 + 0];
+			g += in[t2 + goff];
+			b += in[t2 + boff];
+			if (components == 4) a += in[t2 + 3];
+		}
+		if (fract1 && index1 < in_pixel_len)
+		{
+			S32 t3 = index1 * in_pixel_step * components;
+			r += in[t3 + 0] * fract1;
+			g += in[t3 + goff] * fract1;
+			b += in[t3 + boff] * fract1;
+			if (components == 4) a += in[t3 + 3] * fract1;
+		}
+		S32 t4 = x * out_pixel_step * components;
+		out[t4 + 0] = U8(ll_round(r * norm_factor));
+		if (components >= 2) out[t4 + 1] = U8(ll_round(g * norm_factor));
+		if (components >= 3) out[t4 + 2] = U8(ll_round(b * norm_factor));
+		if (components == 4) out[t4 + 3] = U8(ll_round(a * norm_factor));
+	}
+}
+
+// Column by column, then row by row, like LLImageRaw::copyScaled() used to.
+static void ref_scale(const U8* in, S32 in_width, S32 in_height, U8* out, S32 out_width, S32 out_height, S32 components)
+{
+	std::vector<U8> temp(in_width * out_height * components);
+	for (S32 col = 0; col < in_width; col++)
+	{
+		ref_line_scaled(in + components * col, &temp[0] + components * col, in_height, out_height, in_width, in_width, components);
+	}
+	for (S32 row = 0; row < out_height; row++)
+	{
+		ref_line_scaled(&temp[0] + components * in_width * row, out + components * out_width * row, in_width, out_width, 1, 1, components);
+	}
+}
+
+static void ref_generate_mip(const U8* indata, U8* mipdata, S32 width, S32 height, S32 nchannels)
+{
+	S32 in_width = width * 2;
+	for (S32 h = 0; h < height; h++)
+	{
+		for (S32 w = 0; w < width; w++)
+		{
+			for (S32 c = 0; c < nchannels; ++c)
+			{
+				const U8* p = indata + c;
+				*mipdata++ = (U8)(((U32)p[0] + p[nchannels] + p[nchannels*in_width] + p[nchannels*in_width + nchannels]) >> 2);
+			}
+			indata += nchannels * 2;
+		}
+		indata += nchannels * in_width;
+	}
+}
+
+static void fill_random(std::vector<U8>& data)
+{
+	tut::TestRandom random;
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = (U8)random.nextU32();
+	}
+}
+
+namespace tut
+{
+	struct imageresample_test
+	{
+		imageresample_test()
+		{
+			LLThreadPool::initClass(3);
+		}
+		~imageresample_test()
+		{
+			LLThreadPool::cleanupClass();
+		}
+
+		void ensure_scale(S32 in_width, S32 in_height, S32 out_width, S32 out_height, S32 components)
+		{
+			std::vector<U8> in(in_width * in_height * components);
+			fill_random(in);
+			std::vector<U8> expected(out_width * out_height * components);
+			std::vector<U8> actual(expected.size());
+			ref_scale(&in[0], in_width, in_height, &expected[0], out_width, out_height, components);
+			LLImageResample::scale(&in[0], in_width, in_height, &actual[0], out_width, out_height, components);
+			ensure(llformat("scale %dx%d -> %dx%d, %d components", in_width, in_height, out_width, out_height, components),
+				   expected == actual);
+		}
+	};
+
+	typedef test_group<imageresample_test> imageresample_t;
+	typedef imageresample_t::object imageresample_object_t;
+	tut::imageresample_t tut_imageresample("imageresample");
+
+	template<> template<>
+	void imageresample_object_t::test<1>()
+	{
+		// Scaling matches the per pixel box filter, down and up, for odd sizes and large
+		// images that are split across threads.
+		const S32 sizes[][4] = {
+			{ 64, 64, 32, 32 }, { 100, 37, 33, 80 }, { 17, 3, 5, 9 }, { 7, 7, 7, 3 },
+			{ 512, 512, 300, 200 }, { 333, 777, 1024, 512 }, { 2048, 1024, 1000, 700 } };
+		for (S32 i = 0; i < (S32)LL_ARRAY_SIZE(sizes); ++i)
+		{
+			for (S32 components = 1; components <= 4; ++components)
+			{
+				ensure_scale(sizes[i][0], sizes[i][1], sizes[i][2], sizes[i][3], components);
+			}
+		}
+	}
+
+	template<> template<>
+	void imageresample_object_t::test<2>()
+	{
+		// A mip chain matches successive single level reductions.
+		const S32 sizes[][2] = { { 4, 4 }, { 64, 32 }, { 256, 1024 }, { 2048, 2048 } };
+		for (S32 i = 0; i < (S32)LL_ARRAY_SIZE(sizes); ++i)
+		{
+			for (S32 components = 1; components <= 4; ++components)
+			{
+				const S32 width = sizes[i][0];
+				const S32 height = sizes[i][1];
+				S32 levels = 0;
+				while ((width >> (levels + 1)) && (height >> (levels + 1)))
+				{
+					++levels;
+				}
+				std::vector<U8> in(width * height * components);
+				fill_random(in);
+				std::vector<std::vector<U8> > expected(levels), actual(levels);
+				std::vector<U8*> mips(levels);
+				const U8* prev = &in[0];
+				for (S32 level = 1; level <= levels; ++level)
+				{
+					const S32 bytes = (width >> level) * (height >> level) * components;
+					expected[level - 1].resize(bytes);
+					actual[level - 1].resize(bytes);
+					mips[level - 1] = &actual[level - 1][0];
+					ref_generate_mip(prev, &expected[level - 1][0], width >> level, height >> level, components);
+					prev = &expected[level - 1][0];
+				}
+				LLImageResample::generateMipChain(&in[0], width, height, components, &mips[0], levels);
+				for (S32 level = 0; level < levels; ++level)
+				{
+					ensure(llformat("mip level %d of %dx%d, %d components", level + 1, width, height, components),
+						   expected[level] == actual[level]);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,239 @@
+/**
+ * @file llhizbuffer.cpp
+ * @brief Hierarchical depth buffer for batched occlusion tests.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llhizbuffer.h"
+
+#include "llmath.h"
+#include "llthreadpool.h"
+
+// Reduce one level into the next: out[x, y] is the maximum of the 2 x 2
+// texels at (2x, 2y), clamped to the edges of in for odd sizes.
+static void reduce_level(const F32* in, S32 in_width, S32 in_height, F32* out, S32 out_width, S32 out_height)
+{
+	// Output texels whose two source columns both exist, four at a time
+	const S32 pairs = in_width / 2;
+	const S32 simd_end = pairs & ~3;
+
+	for (S32 y = 0; y < out_height; ++y)
+	{
+		const F32* row0 = in + (2 * y) * in_width;
+		const F32* row1 = in + llmin(2 * y + 1, in_height - 1) * in_width;
+		F32* dst = out + y * out_width;
+
+		S32 x = 0;
+		for (; x < simd_end; x += 4)
+		{
+			__m128 lo = _mm_max_ps(_mm_loadu_ps(row0 + 2 * x), _mm_loadu_ps(row1 + 2 * x));
+			__m128 hi = _mm_max_ps(_mm_loadu_ps(row0 + 2 * x + 4), _mm_loadu_ps(row1 + 2 * x + 4));
+			__m128 even = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 odd = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+			_mm_storeu_ps(dst + x, _mm_max_ps(even, odd));
+		}
+		for (; x < out_width; ++x)
+		{
+			const S32 x0 = 2 * x;
+			const S32 x1 = llmin(x0 + 1, in_width - 1);
+			dst[x] = llmax(llmax(row0[x0], row0[x1]), llmax(row1[x0], row1[x1]));
+		}
+	}
+}
+
+LLHiZBuffer::LLHiZBuffer()
+{
+	mViewProj.setIdentity();
+}
+
+void LLHiZBuffer::clear()
+{
+	mLevels.clear();
+	mDepth.clear();
+}
+
+void LLHiZBuffer::setDepth(const F32* depth, S32 width, S32 height, const LLMatrix4a& view_proj)
+{
+	clear();
+	if (width <= 0 || height <= 0)
+	{
+		return;
+	}
+	mViewProj = view_proj;
+
+	Level level;
+	level.mWidth = width;
+	level.mHeight = height;
+	level.mOffset = 0;
+	S32 total = 0;
+	while (true)
+	{
+		mLevels.push_back(level);
+		total += level.mWidth * level.mHeight;
+		if (level.mWidth == 1 && level.mHeight == 1)
+		{
+			break;
+		}
+		level.mOffset = total;
+		level.mWidth = (level.mWidth + 1) / 2;
+		level.mHeight = (level.mHeight + 1) / 2;
+	}
+
+	mDepth.resize(total);
+	memcpy(&mDepth[0], depth, width * height * sizeof(F32));
+	for (S32 i = 1; i < (S32)mLevels.size(); ++i)
+	{
+		const Level& in = mLevels[i - 1];
+		const Level& out = mLevels[i];
+		reduce_level(&mDepth[in.mOffset], in.mWidth, in.mHeight, &mDepth[out.mOffset], out.mWidth, out.mHeight);
+	}
+}
+
+bool LLHiZBuffer::isOccluded(const LLVector4a& center, const LLVector4a& size) const
+{
+	if (mLevels.empty())
+	{
+		return false;
+	}
+
+	// Clip space corners are the projected center plus or minus the
+	// projected half extents along each axis.
+	LLVector4a clip_center;
+	mViewProj.affineTransform(center, clip_center);
+	LLVector4a axis[3][2];
+	LLVector4a s;
+	s.splat<0>(size);
+	axis[0][1].setMul(mViewProj.getRow<0>(), s);
+	s.splat<1>(size);
+	axis[1][1].setMul(mViewProj.getRow<1>(), s);
+	s.splat<2>(size);
+	axis[2][1].setMul(mViewProj.getRow<2>(), s);
+	LLVector4a zero;
+	zero.clear();
+	for (S32 i = 0; i < 3; ++i)
+	{
+		axis[i][0].setSub(zero, axis[i][1]);
+	}
+
+	LLVector4a ndc_min, ndc_max;
+	ndc_min.splat(F32_MAX);
+	ndc_max.splat(-F32_MAX);
+	for (S32 i = 0; i < 8; ++i)
+	{
+		LLVector4a corner;
+		corner.setAdd(clip_center, axis[0][i & 1]);
+		corner.add(axis[1][(i >> 1) & 1]);
+		corner.add(axis[2][i >> 2]);
+
+		const F32 w = corner[3];
+		if (!(w > 0.f))
+		{	//behind the eye, the projection is meaningless
+			return false;
+		}
+		LLVector4a inv_w;
+		inv_w.splat(1.f / w);
+		corner.mul(inv_w);
+		ndc_min.setMin(ndc_min, corner);
+		ndc_max.setMax(ndc_max, corner);
+	}
+
+	const F32 near_depth = ndc_min[2] * 0.5f + 0.5f;
+	if (!(near_depth > 0.f))
+	{	//in front of the near plane, nothing can hide it
+		return false;
+	}
+
+	const Level& base = mLevels[0];
+	const F32 x0 = (ndc_min[0] * 0.5f + 0.5f) * base.mWidth;
+	const F32 x1 = (ndc_max[0] * 0.5f + 0.5f) * base.mWidth;
+	const F32 y0 = (ndc_min[1] * 0.5f + 0.5f) * base.mHeight;
+	const F32 y1 = (ndc_max[1] * 0.5f + 0.5f) * base.mHeight;
+	if (!(x0 >= 0.f && y0 >= 0.f && x1 < (F32)base.mWidth && y1 < (F32)base.mHeight))
+	{	//partly off screen, where the depth is unknown
+		return false;
+	}
+
+	S32 ix0 = (S32)x0;
+	S32 ix1 = (S32)x1;
+	S32 iy0 = (S32)y0;
+	S32 iy1 = (S32)y1;
+
+	// The finest level at which the rectangle touches at most 2 x 2 texels
+	S32 level = 0;
+	const S32 top = (S32)mLevels.size() - 1;
+	while (level < top && ((ix1 >> level) - (ix0 >> level) > 1 || (iy1 >> level) - (iy0 >> level) > 1))
+	{
+		++level;
+	}
+	ix0 >>= level;
+	ix1 >>= level;
+	iy0 >>= level;
+	iy1 >>= level;
+
+	const Level& l = mLevels[level];
+	const F32* depth = &mDepth[l.mOffset];
+	F32 far_depth = 0.f;
+	for (S32 y = iy0; y <= iy1; ++y)
+	{
+		for (S32 x = ix0; x <= ix1; ++x)
+		{
+			far_depth = llmax(far_depth, depth[y * l.mWidth + x]);
+		}
+	}
+
+	return near_depth > far_depth;
+}
+
+struct TestHiZBoxes
+{
+	const LLHiZBuffer* mBuffer;
+	const LLVector4a* mBounds;
+	U8* mOccluded;
+
+	void operator()(S32 begin, S32 end) const
+	{
+		for (S32 i = begin; i < end; ++i)
+		{
+			mOccluded[i] = mBuffer->isOccluded(mBounds[i * 2], mBounds[i * 2 + 1]) ? 1 : 0;
+		}
+	}
+};
+
+void LLHiZBuffer::testBoxes(const LLVector4a* bounds, S32 count, U8* occluded) const
+{
+	TestHiZBoxes test;
+	test.mBuffer = this;
+	test.mBounds = bounds;
+	test.mOccluded = occluded;
+
+	if (count >= PARALLEL_BOXES)
+	{
+		LLThreadPool::parallelFor(count, PARALLEL_BOXES / 4, test);
+	}
+	else
+	{
+		test(0, count);
+	}
+}
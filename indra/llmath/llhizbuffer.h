@@ -0,0 +1,108 @@
+/**
+ * @file llhizbuffer.h
+ * @brief Hierarchical depth buffer for batched occlusion tests.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLHIZBUFFER_H
+#define LL_LLHIZBUFFER_H
+
+#include <vector>
+
+#include "llmath.h"
+#include "llmatrix4a.h"
+
+/**
+ * @class LLHiZBuffer
+ * @brief A max depth pyramid and the bounding box test against it.
+ *
+ * Level 0 is a depth buffer in window coordinates, rows bottom to top as
+ * glReadPixels() returns them, each texel holding the farthest depth of
+ * the screen area it covers. Every further level halves the size, rounding
+ * up, and keeps the maximum of the texels below it.
+ *
+ * A box is occluded when its nearest point is farther than the farthest
+ * depth of every texel its screen rectangle touches. The test reads at
+ * most 2 x 2 texels, from the level at which the rectangle fits, and errs
+ * on the side of visibility: boxes that reach behind the eye, leave the
+ * screen or meet an empty buffer are visible.
+ *
+ * Tests only read the buffer, so testBoxes() spreads large batches over
+ * LLThreadPool.
+ */
+LL_ALIGN_PREFIX(16)
+class LLHiZBuffer
+{
+public:
+	enum
+	{
+		// Batches of at least this many boxes are split across threads.
+		PARALLEL_BOXES = 1024
+	};
+
+	LLHiZBuffer();
+
+	/**
+	 * @brief Build the pyramid from a level 0 depth buffer.
+	 *
+	 * view_proj is the projection times the modelview matrix that the depth
+	 * was rendered with; boxes are projected with it.
+	 */
+	void setDepth(const F32* depth, S32 width, S32 height, const LLMatrix4a& view_proj);
+	void clear();
+
+	bool isEmpty() const					{ return mLevels.empty(); }
+	S32 getLevelCount() const				{ return (S32)mLevels.size(); }
+	S32 getWidth(S32 level) const			{ return mLevels[level].mWidth; }
+	S32 getHeight(S32 level) const			{ return mLevels[level].mHeight; }
+	F32 getDepth(S32 level, S32 x, S32 y) const
+	{
+		const Level& l = mLevels[level];
+		return mDepth[l.mOffset + y * l.mWidth + x];
+	}
+
+	// center and size as in LLSpatialGroup::mBounds, size being half the extent.
+	bool isOccluded(const LLVector4a& center, const LLVector4a& size) const;
+
+	/**
+	 * @brief Test count boxes at once.
+	 *
+	 * bounds holds a center and a size per box; occluded[i] is set to 1 if
+	 * box i is occluded, 0 otherwise.
+	 */
+	void testBoxes(const LLVector4a* bounds, S32 count, U8* occluded) const;
+
+private:
+	struct Level
+	{
+		S32 mWidth;
+		S32 mHeight;
+		S32 mOffset;	// Into mDepth
+	};
+
+	LLMatrix4a mViewProj;
+	std::vector<Level> mLevels;
+	std::vector<F32> mDepth;
+} LL_ALIGN_POSTFIX(16);
+
+#endif // LL_LLHIZBUFFER_H
@@ -0,0 +1,273 @@
+/**
+ * @file llpointgrid.h
+ * @brief Points on a uniform grid, for range and nearest neighbor queries.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPOINTGRID_H
+#define LL_LLPOINTGRID_H
+
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "llmath.h"
+#include "v3dmath.h"
+
+/**
+ * @class LLPointGrid
+ * @brief Keyed points in global coordinates, bucketed by x and y.
+ *
+ * Each point sits in the square cell of the horizontal grid that contains
+ * it, so moving a point only touches its old and new cell, and a query
+ * only looks at the cells that it overlaps instead of at every point.
+ * Cells that hold no points take no memory. Distances are in three
+ * dimensions.
+ */
+template <class Key, class Hash = boost::hash<Key> >
+class LLPointGrid
+{
+public:
+	explicit LLPointGrid(F64 cell_size)
+	:	mCellSize(cell_size),
+		mCellSizeInv(1.0 / cell_size)
+	{
+	}
+
+	// Adds the point, or moves it if it is already there. True if it was added.
+	bool set(const Key& key, const LLVector3d& pos)
+	{
+		const U64 cell = cellOf(pos);
+		typename point_map_t::iterator it = mPoints.find(key);
+		if (it != mPoints.end())
+		{
+			Point& point = it->second;
+			point.mPos = pos;
+			if (point.mCell != cell)
+			{
+				removeFromCell(point);
+				addToCell(key, point, cell);
+			}
+			return false;
+		}
+
+		Point& point = mPoints[key];
+		point.mPos = pos;
+		addToCell(key, point, cell);
+		return true;
+	}
+
+	// True if the point was there.
+	bool remove(const Key& key)
+	{
+		typename point_map_t::iterator it = mPoints.find(key);
+		if (it == mPoints.end())
+		{
+			return false;
+		}
+		removeFromCell(it->second);
+		mPoints.erase(it);
+		return true;
+	}
+
+	const LLVector3d* find(const Key& key) const
+	{
+		typename point_map_t::const_iterator it = mPoints.find(key);
+		return it != mPoints.end() ? &it->second.mPos : NULL;
+	}
+
+	U32 size() const		{ return (U32)mPoints.size(); }
+	bool empty() const		{ return mPoints.empty(); }
+
+	void clear()
+	{
+		mPoints.clear();
+		mCells.clear();
+	}
+
+	// Appends the keys of the points that are at most radius from center.
+	void findInRange(const LLVector3d& center, F64 radius, std::vector<Key>& keys) const
+	{
+		const F64 radius_squared = radius * radius;
+		const S32 x_begin = cellCoord(center.mdV[VX] - radius);
+		const S32 x_end = cellCoord(center.mdV[VX] + radius);
+		const S32 y_begin = cellCoord(center.mdV[VY] - radius);
+		const S32 y_end = cellCoord(center.mdV[VY] + radius);
+
+		if ((F64)(x_end - x_begin + 1) * (F64)(y_end - y_begin + 1) > (F64)mCells.size())
+		{
+			// The range covers more cells than there are occupied ones.
+			for (typename cell_map_t::const_iterator it = mCells.begin(); it != mCells.end(); ++it)
+			{
+				appendInRange(it->second, center, radius_squared, keys);
+			}
+			return;
+		}
+
+		for (S32 y = y_begin; y <= y_end; ++y)
+		{
+			for (S32 x = x_begin; x <= x_end; ++x)
+			{
+				typename cell_map_t::const_iterator it = mCells.find(cellKey(x, y));
+				if (it != mCells.end())
+				{
+					appendInRange(it->second, center, radius_squared, keys);
+				}
+			}
+		}
+	}
+
+	// The key of the point nearest to center, if one is at most max_radius away.
+	bool findNearest(const LLVector3d& center, F64 max_radius, Key& key) const
+	{
+		F64 best = max_radius * max_radius;
+		bool found = false;
+		const S32 cx = cellCoord(center.mdV[VX]);
+		const S32 cy = cellCoord(center.mdV[VY]);
+		U32 visited = 0;
+
+		// Rings of cells around the center's, nearest first.
+		for (S32 ring = 0; ; ++ring)
+		{
+			// How far the nearest point outside the rings so far can be.
+			const F64 reach = llmin(llmin(center.mdV[VX] - (cx - ring) * mCellSize, (cx + ring + 1) * mCellSize - center.mdV[VX]),
+									llmin(center.mdV[VY] - (cy - ring) * mCellSize, (cy + ring + 1) * mCellSize - center.mdV[VY]));
+			const U32 ring_cells = ring ? 8 * ring : 1;
+			if (visited + ring_cells > mCells.size())
+			{
+				// Cheaper to look at every occupied cell than to search further.
+				for (typename cell_map_t::const_iterator it = mCells.begin(); it != mCells.end(); ++it)
+				{
+					found |= nearestInCell(it->second, center, best, key);
+				}
+				return found;
+			}
+
+			for (S32 y = cy - ring; y <= cy + ring; ++y)
+			{
+				// Only the first and last rows are whole; the others only have their ends in the ring.
+				const S32 step = (y == cy - ring || y == cy + ring) ? 1 : llmax(2 * ring, 1);
+				for (S32 x = cx - ring; x <= cx + ring; x += step)
+				{
+					typename cell_map_t::const_iterator it = mCells.find(cellKey(x, y));
+					if (it != mCells.end())
+					{
+						found |= nearestInCell(it->second, center, best, key);
+					}
+				}
+			}
+			visited += ring_cells;
+
+			if (reach * reach >= best)
+			{
+				return found;
+			}
+		}
+	}
+
+private:
+	struct Point
+	{
+		LLVector3d mPos;
+		U64 mCell;
+		U32 mSlot;		// Index in the cell's keys
+	};
+
+	typedef boost::unordered_map<Key, Point, Hash> point_map_t;
+	typedef boost::unordered_map<U64, std::vector<Key> > cell_map_t;
+
+	S32 cellCoord(F64 value) const
+	{
+		return (S32)floor(value * mCellSizeInv);
+	}
+
+	static U64 cellKey(S32 x, S32 y)
+	{
+		return ((U64)(U32)x << 32) | (U64)(U32)y;
+	}
+
+	U64 cellOf(const LLVector3d& pos) const
+	{
+		return cellKey(cellCoord(pos.mdV[VX]), cellCoord(pos.mdV[VY]));
+	}
+
+	void addToCell(const Key& key, Point& point, U64 cell)
+	{
+		std::vector<Key>& keys = mCells[cell];
+		point.mCell = cell;
+		point.mSlot = (U32)keys.size();
+		keys.push_back(key);
+	}
+
+	void removeFromCell(const Point& point)
+	{
+		typename cell_map_t::iterator it = mCells.find(point.mCell);
+		std::vector<Key>& keys = it->second;
+		if (point.mSlot + 1 != keys.size())
+		{
+			// The last key takes the place of the removed one.
+			keys[point.mSlot] = keys.back();
+			mPoints.find(keys[point.mSlot])->second.mSlot = point.mSlot;
+		}
+		keys.pop_back();
+		if (keys.empty())
+		{
+			mCells.erase(it);
+		}
+	}
+
+	void appendInRange(const std::vector<Key>& cell, const LLVector3d& center, F64 radius_squared, std::vector<Key>& keys) const
+	{
+		for (typename std::vector<Key>::const_iterator it = cell.begin(); it != cell.end(); ++it)
+		{
+			if (dist_vec_squared(mPoints.find(*it)->second.mPos, center) <= radius_squared)
+			{
+				keys.push_back(*it);
+			}
+		}
+	}
+
+	bool nearestInCell(const std::vector<Key>& cell, const LLVector3d& center, F64& best, Key& key) const
+	{
+		bool found = false;
+		for (typename std::vector<Key>::const_iterator it = cell.begin(); it != cell.end(); ++it)
+		{
+			const F64 dist = dist_vec_squared(mPoints.find(*it)->second.mPos, center);
+			if (dist <= best)
+			{
+				best = dist;
+				key = *it;
+				found = true;
+			}
+		}
+		return found;
+	}
+
+	F64 mCellSize;
+	F64 mCellSizeInv;
+	point_map_t mPoints;
+	cell_map_t mCells;
+};
+
+#endif // LL_LLPOINTGRID_H
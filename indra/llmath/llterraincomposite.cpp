@@ -0,0 +1,249 @@
+/**
+ * @file llterraincomposite.cpp
+ * @brief Per texel kernels behind terrain texture compositing.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+#include "llterraincomposite.h"
+
+#include <vector>
+
+#include "llmath.h"
+#include "llperlin.h"
+#include "llsimdmath.h"
+#include "v2math.h"
+#include "v3math.h"
+
+namespace
+{
+
+// Composition value at column x of the current rows, as LLViewerLayer::getValueScaled() does it.
+inline F32 composition_at(const F32* row1, const F32* row2, S32 x1, S32 x2, F32 x_frac, F32 y_frac)
+{
+	F32 row1_left  = row1[x1];
+	F32 row1_right = row1[x2];
+	F32 row2_left  = row2[x1];
+	F32 row2_right = row2[x2];
+
+	F32 row1_interp = row1_left - x_frac * (row1_left - row1_right);
+	F32 row2_interp = row2_left - x_frac * (row2_left - row2_right);
+
+	return row1_interp - y_frac * (row1_interp - row2_interp);
+}
+
+// Grid point at or below pos and the one after it, clamped to the grid, and how far pos is past the first.
+inline void grid_span(F32 pos, F32 scale_inv, S32 width, S32& p1, S32& p2, F32& frac)
+{
+	frac = pos*scale_inv;
+	p1 = llfloor(frac);
+	p2 = p1 + 1;
+	frac -= p1;
+
+	p1 = llmin(width-1, p1);
+	p1 = llmax(0, p1);
+	p2 = llmin(width-1, p2);
+	p2 = llmax(0, p2);
+}
+
+} // namespace
+
+//static
+void LLTerrainComposite::generateNoise(F32 origin_x, F32 origin_y, F32 scale, S32 width,
+									   S32 row_begin, S32 row_end, F32* noise)
+{
+	// For perlin noise generation...
+	const F32 slope_squared = 1.5f*1.5f;
+	const F32 xyScale = 4.9215f; //0.93284f;
+	const F32 noise_magnitude = 2.f;		//  Degree to which noise modulates composition layer (versus
+											//  simple height)
+	const F32 xyScaleInv = (1.f / xyScale);
+	const LLVector2 origin(origin_x, origin_y);
+
+	for (S32 j = row_begin; j < row_end; j++)
+	{
+		for (S32 i = 0; i < width; i++)
+		{
+			LLVector3 location(i*scale, j*scale, 0.f);
+
+			// Adjust to non - integer lattice
+			LLVector2 vec = origin + LLVector2(location);
+			vec *= xyScaleInv;
+
+			F32 twiddle = LLPerlinNoise::noise(vec*0.2222222222f)*6.5f;	//  Low freq component for large divisions
+			twiddle += LLPerlinNoise::turbulence(vec, 2.f)*slope_squared;	//  High frequency component
+			twiddle *= noise_magnitude;
+
+			noise[j*width + i] = twiddle;
+		}
+	}
+}
+
+//static
+void LLTerrainComposite::blend(const BlendParams& params, S32 x_begin, S32 y_begin, S32 x_end, S32 y_end)
+{
+	if (x_end <= x_begin || y_end <= y_begin)
+	{
+		return;
+	}
+
+	const U32 st_comps = 3;
+	const U32 st_width = params.mDetailWidth;
+	const U32 st_height = params.mDetailHeight;
+	const F32 st_x_stride = params.mDetailStrideX;
+	const F32 st_y_stride = params.mDetailStrideY;
+	const S32 comp_width = params.mCompositionWidth;
+
+	// Everything that only depends on the column, the same for every row.
+	const S32 columns = x_end - x_begin;
+	std::vector<S32> col_x1(columns), col_x2(columns), col_st(columns);
+	std::vector<F32> col_x_frac(columns);
+	F32 sti = (x_begin * st_x_stride) - st_width*((U32)(x_begin * st_x_stride)/st_width);
+	for (S32 c = 0; c < columns; c++)
+	{
+		grid_span((x_begin + c)*params.mTexelSizeX, params.mCompositionScaleInv, comp_width,
+				  col_x1[c], col_x2[c], col_x_frac[c]);
+		col_st[c] = lltrunc(sti);
+
+		sti += st_x_stride;
+		if (sti >= st_width)
+		{
+			sti -= st_width;
+		}
+	}
+
+	const U8* const* st_data = params.mDetail;
+	const S32* st_data_size = params.mDetailSize;
+
+	F32 stj = (y_begin * st_y_stride) - st_height*(llfloor((y_begin * st_y_stride)/st_height));
+	for (S32 j = y_begin; j < y_end; j++)
+	{
+		S32 y1, y2;
+		F32 y_frac;
+		grid_span(j*params.mTexelSizeY, params.mCompositionScaleInv, comp_width, y1, y2, y_frac);
+		const F32* row1 = params.mComposition + y1*comp_width;
+		const F32* row2 = params.mComposition + y2*comp_width;
+		const S32 st_row = lltrunc(stj)*st_width;
+		U8* dst = params.mDst + j*params.mDstStride + x_begin*st_comps;
+
+		S32 c = 0;
+		const LLQuad y_frac4 = _mm_set1_ps(y_frac);
+		for (; c + 4 <= columns; c += 4, dst += 4*st_comps)
+		{
+			// Composition of four texels
+			LLQuad r1l = _mm_setr_ps(row1[col_x1[c]], row1[col_x1[c+1]], row1[col_x1[c+2]], row1[col_x1[c+3]]);
+			LLQuad r1r = _mm_setr_ps(row1[col_x2[c]], row1[col_x2[c+1]], row1[col_x2[c+2]], row1[col_x2[c+3]]);
+			LLQuad r2l = _mm_setr_ps(row2[col_x1[c]], row2[col_x1[c+1]], row2[col_x1[c+2]], row2[col_x1[c+3]]);
+			LLQuad r2r = _mm_setr_ps(row2[col_x2[c]], row2[col_x2[c+1]], row2[col_x2[c+2]], row2[col_x2[c+3]]);
+			LLQuad x_frac = _mm_loadu_ps(&col_x_frac[c]);
+			LLQuad r1 = _mm_sub_ps(r1l, _mm_mul_ps(x_frac, _mm_sub_ps(r1l, r1r)));
+			LLQuad r2 = _mm_sub_ps(r2l, _mm_mul_ps(x_frac, _mm_sub_ps(r2l, r2r)));
+			LLQuad composition = _mm_sub_ps(r1, _mm_mul_ps(y_frac4, _mm_sub_ps(r1, r2)));
+
+			// floor(): truncate, then step down where that rounded up
+			__m128i floor4 = _mm_cvttps_epi32(composition);
+			floor4 = _mm_add_epi32(floor4, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(floor4), composition)));
+			LL_ALIGN_16(S32 tex0[4]);
+			_mm_store_si128((__m128i*)tex0, floor4);
+			for (S32 q = 0; q < 4; q++)
+			{
+				tex0[q] = llclamp(tex0[q], 0, 3);
+			}
+			composition = _mm_sub_ps(composition, _mm_cvtepi32_ps(_mm_load_si128((const __m128i*)tex0)));
+			LL_ALIGN_16(F32 frac[4]);
+			_mm_store_ps(frac, composition);
+
+			// Gather the twelve components; a texel whose detail offset is out of
+			// range blends its current value with itself, which leaves it as it is.
+			LL_ALIGN_16(F32 a[12]);
+			LL_ALIGN_16(F32 b[12]);
+			LL_ALIGN_16(F32 f[12]);
+			for (S32 q = 0; q < 4; q++)
+			{
+				const S32 t0 = tex0[q];
+				const S32 t1 = llclamp(t0 + 1, 0, 3);
+				S32 st_offset = (col_st[c+q] + st_row) * st_comps;
+				for (U32 k = 0; k < st_comps; k++, st_offset++)
+				{
+					const S32 n = q*st_comps + k;
+					if (st_offset >= st_data_size[t0] || st_offset >= st_data_size[t1])
+					{
+						a[n] = b[n] = dst[n];
+						f[n] = 0.f;
+					}
+					else
+					{
+						a[n] = st_data[t0][st_offset];
+						b[n] = st_data[t1][st_offset];
+						f[n] = frac[q];
+					}
+				}
+			}
+
+			// (U8) keeps the low byte, also of results that the composition put out of range.
+			const __m128i low_byte = _mm_set1_epi32(0xFF);
+			__m128i out[3];
+			for (S32 v = 0; v < 3; v++)
+			{
+				LLQuad av = _mm_load_ps(a + v*4);
+				LLQuad bv = _mm_load_ps(b + v*4);
+				out[v] = _mm_cvttps_epi32(_mm_add_ps(av, _mm_mul_ps(_mm_load_ps(f + v*4), _mm_sub_ps(bv, av))));
+				out[v] = _mm_and_si128(out[v], low_byte);
+			}
+			LL_ALIGN_16(U8 bytes[16]);
+			_mm_store_si128((__m128i*)bytes, _mm_packus_epi16(_mm_packs_epi32(out[0], out[1]), _mm_packs_epi32(out[2], out[2])));
+			memcpy(dst, bytes, 4*st_comps);
+		}
+
+		for (; c < columns; c++)
+		{
+			F32 composition = composition_at(row1, row2, col_x1[c], col_x2[c], col_x_frac[c], y_frac);
+
+			S32 tex0 = llfloor( composition );
+			tex0 = llclamp(tex0, 0, 3);
+			composition -= tex0;
+			S32 tex1 = tex0 + 1;
+			tex1 = llclamp(tex1, 0, 3);
+
+			S32 st_offset = (col_st[c] + st_row) * st_comps;
+			for (U32 k = 0; k < st_comps; k++)
+			{
+				if (st_offset < st_data_size[tex0] && st_offset < st_data_size[tex1])
+				{
+					F32 a = *(st_data[tex0] + st_offset);
+					F32 b = *(st_data[tex1] + st_offset);
+					*dst = (U8)lltrunc( a + composition * (b - a) );
+				}
+				dst++;
+				st_offset++;
+			}
+		}
+
+		stj += st_y_stride;
+		if (stj >= st_height)
+		{
+			stj -= st_height;
+		}
+	}
+}
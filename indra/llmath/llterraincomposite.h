@@ -0,0 +1,79 @@
+/**
+ * @file llterraincomposite.h
+ * @brief Per texel kernels behind terrain texture compositing.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLTERRAINCOMPOSITE_H
+#define LL_LLTERRAINCOMPOSITE_H
+
+/**
+ * @class LLTerrainComposite
+ * @brief The loops of LLVLComposition, on plain arrays.
+ *
+ * generateNoise() computes the Perlin noise that jitters the height at
+ * which one detail texture gives way to the next. It only depends on where
+ * the region is, so a region computes it once. blend() mixes the detail
+ * textures into the surface texture, four texels at a time.
+ *
+ * Both give the same bits as the per texel code they replaced, and only
+ * write their own rows or texels, so that callers can split the work
+ * between threads.
+ */
+class LLTerrainComposite
+{
+public:
+	/**
+	 * @brief Noise of the grid points in rows [row_begin, row_end).
+	 *
+	 * The grid is width points wide and scale meters apart, with its
+	 * south west corner at (origin_x, origin_y) in global meters.
+	 * Writes noise[j * width + i].
+	 */
+	static void generateNoise(F32 origin_x, F32 origin_y, F32 scale, S32 width,
+							  S32 row_begin, S32 row_end, F32* noise);
+
+	// Everything blend() reads, set up once per surface texture.
+	struct BlendParams
+	{
+		const F32* mComposition;		// width x width values in [0, 3]: 0 is detail 0, 3 is detail 3
+		S32 mCompositionWidth;
+		F32 mCompositionScaleInv;		// Composition grid points per meter
+		const U8* mDetail[4];			// RGB detail textures
+		S32 mDetailSize[4];				// In bytes
+		U32 mDetailWidth;
+		U32 mDetailHeight;
+		F32 mDetailStrideX;				// Detail texels per surface texel
+		F32 mDetailStrideY;
+		F32 mTexelSizeX;				// Meters per surface texel
+		F32 mTexelSizeY;
+		U8* mDst;						// RGB surface texture
+		U32 mDstStride;					// In bytes
+	};
+
+	// Fill the surface texels [x_begin, x_end) x [y_begin, y_end).
+	static void blend(const BlendParams& params, S32 x_begin, S32 y_begin, S32 x_end, S32 y_end);
+};
+
+#endif // LL_LLTERRAINCOMPOSITE_H
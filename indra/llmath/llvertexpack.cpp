@@ -0,0 +1,335 @@
+/**
+ * @file llvertexpack.cpp
+ * @brief SSE2 kernels that pack volume face streams into vertex buffers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvertexpack.h"
+
+#include "llmath.h"
+#include "llmatrix4a.h"
+#include "v2math.h"
+
+// Texture coordinates go through the kernels in blocks of this many.
+static const S32 TC_BLOCK = 4;
+
+//
+// Texture coordinate kernels. A block of four coordinates is held as one
+// vector of s and one of t; each stage performs, lane by lane, the same
+// single precision operations in the same order as the scalar code that
+// used to run per vertex (planarProjection(), xform() and
+// LLMatrix4a::affineTransform() of <s, t, 0>), so the results match
+// exactly.
+//
+
+template <bool PLANAR, S32 TRANSFORM>
+class TexCoordBlock
+{
+public:
+	TexCoordBlock(const LLVertexPack::TexCoordParams& params)
+	{
+		if (PLANAR)
+		{
+			mPosScale[0] = _mm_set1_ps(params.mScale[0]);
+			mPosScale[1] = _mm_set1_ps(params.mScale[1]);
+			mPosScale[2] = _mm_set1_ps(params.mScale[2]);
+		}
+		if (TRANSFORM == LLVertexPack::TC_XFORM)
+		{
+			mCos = _mm_set1_ps(params.mCos);
+			mSin = _mm_set1_ps(params.mSin);
+			mNegSin = _mm_set1_ps(-params.mSin);
+			mScaleS = _mm_set1_ps(params.mScaleS);
+			mScaleT = _mm_set1_ps(params.mScaleT);
+			mOffsetS = _mm_set1_ps(params.mOffsetS + 0.5f);
+			mOffsetT = _mm_set1_ps(params.mOffsetT + 0.5f);
+		}
+		else if (TRANSFORM == LLVertexPack::TC_MATRIX)
+		{
+			const LLMatrix4a& mat = *params.mMatrix;
+			mRowS[0] = _mm_set1_ps(mat.getRow<0>()[0]);
+			mRowS[1] = _mm_set1_ps(mat.getRow<1>()[0]);
+			mRowT[0] = _mm_set1_ps(mat.getRow<0>()[1]);
+			mRowT[1] = _mm_set1_ps(mat.getRow<1>()[1]);
+			// The z and translation terms do not depend on the coordinate
+			LLVector4a zt;
+			zt.setMul(mat.getRow<2>(), LLVector4a::getZero());
+			zt.add(mat.getRow<3>());
+			mConstS = _mm_set1_ps(zt[0]);
+			mConstT = _mm_set1_ps(zt[1]);
+		}
+	}
+
+	// TC_BLOCK coordinates from the given source pointers into out.
+	void operator()(const LLVector2* tc, const LLVector4a* pos, const LLVector4a* norm, LLVector2* out) const
+	{
+		LLQuad s, t;
+		if (PLANAR)
+		{
+			planar(pos, norm, s, t);
+		}
+		else
+		{
+			const LLQuad lo = _mm_loadu_ps(tc[0].mV);
+			const LLQuad hi = _mm_loadu_ps(tc[2].mV);
+			s = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+			t = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+
+		if (TRANSFORM == LLVertexPack::TC_XFORM)
+		{
+			// Texture transforms are done about the center of the face
+			const LLQuad half = _mm_set1_ps(0.5f);
+			const LLQuad s0 = _mm_sub_ps(s, half);
+			const LLQuad t0 = _mm_sub_ps(t, half);
+			// Rotate, scale, offset
+			s = _mm_add_ps(_mm_mul_ps(s0, mCos), _mm_mul_ps(t0, mSin));
+			t = _mm_add_ps(_mm_mul_ps(s0, mNegSin), _mm_mul_ps(t0, mCos));
+			s = _mm_add_ps(_mm_mul_ps(s, mScaleS), mOffsetS);
+			t = _mm_add_ps(_mm_mul_ps(t, mScaleT), mOffsetT);
+		}
+		else if (TRANSFORM == LLVertexPack::TC_MATRIX)
+		{
+			const LLQuad rs = _mm_add_ps(_mm_mul_ps(s, mRowS[0]), _mm_mul_ps(t, mRowS[1]));
+			const LLQuad rt = _mm_add_ps(_mm_mul_ps(s, mRowT[0]), _mm_mul_ps(t, mRowT[1]));
+			s = _mm_add_ps(rs, mConstS);
+			t = _mm_add_ps(rt, mConstT);
+		}
+
+		_mm_storeu_ps(out[0].mV, _mm_unpacklo_ps(s, t));
+		_mm_storeu_ps(out[2].mV, _mm_unpackhi_ps(s, t));
+	}
+
+private:
+	// planarProjection() for four vertices. The binormal is a signed axis,
+	// so the dot and cross products reduce to the terms that are not zero.
+	void planar(const LLVector4a* pos, const LLVector4a* norm, LLQuad& s, LLQuad& t) const
+	{
+		LLQuad nx = norm[0], ny = norm[1], nz = norm[2], nw = norm[3];
+		_MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+		LLQuad vx = pos[0], vy = pos[1], vz = pos[2], vw = pos[3];
+		_MM_TRANSPOSE4_PS(vx, vy, vz, vw);
+		vx = _mm_mul_ps(vx, mPosScale[0]);
+		vy = _mm_mul_ps(vy, mPosScale[1]);
+		vz = _mm_mul_ps(vz, mPosScale[2]);
+
+		const LLQuad zero = _mm_setzero_ps();
+		const LLQuad one = _mm_set1_ps(1.f);
+		const LLQuad minus_one = _mm_set1_ps(-1.f);
+		const LLQuad half = _mm_set1_ps(0.5f);
+
+		// |normal.x| >= 0.5: binormal = <0, +-1, 0>, tangent = <+-nz, 0, -+nx>
+		const LLQuad x_major = _mm_or_ps(_mm_cmpge_ps(nx, half), _mm_cmple_ps(nx, _mm_set1_ps(-0.5f)));
+		const LLQuad sign_x = select(_mm_cmplt_ps(nx, zero), minus_one, one);
+		const LLQuad b_dot_x = _mm_mul_ps(sign_x, vy);
+		const LLQuad t_dot_x = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sign_x, nz), vx),
+										  _mm_mul_ps(negate(_mm_mul_ps(sign_x, nx)), vz));
+
+		// Otherwise binormal = <-+1, 0, 0>, tangent = <0, -(+-nz), +-ny>
+		const LLQuad sign_y = select(_mm_cmpgt_ps(ny, zero), minus_one, one);
+		const LLQuad b_dot_y = _mm_mul_ps(sign_y, vx);
+		const LLQuad t_dot_y = _mm_add_ps(_mm_mul_ps(negate(_mm_mul_ps(sign_y, nz)), vy),
+										  _mm_mul_ps(_mm_mul_ps(sign_y, ny), vz));
+
+		const LLQuad b_dot = select(x_major, b_dot_x, b_dot_y);
+		const LLQuad t_dot = select(x_major, t_dot_x, t_dot_y);
+
+		const LLQuad two = _mm_set1_ps(2.f);
+		s = _mm_add_ps(one, _mm_sub_ps(_mm_mul_ps(b_dot, two), half));
+		t = negate(_mm_sub_ps(_mm_mul_ps(t_dot, two), half));
+	}
+
+	static LLQuad select(const LLQuad& mask, const LLQuad& a, const LLQuad& b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	static LLQuad negate(const LLQuad& v)
+	{
+		return _mm_xor_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x80000000)));
+	}
+
+	LLQuad mPosScale[3];
+	LLQuad mCos, mSin, mNegSin, mScaleS, mScaleT, mOffsetS, mOffsetT;
+	LLQuad mRowS[2], mRowT[2], mConstS, mConstT;
+};
+
+template <bool PLANAR, S32 TRANSFORM>
+static void pack_texcoords(const LLVertexPack::TexCoordParams& params, S32 count, LLVector2* dst)
+{
+	const TexCoordBlock<PLANAR, TRANSFORM> block(params);
+
+	const LLVector2* tc = params.mTexCoords;
+	const LLVector4a* pos = params.mPositions;
+	const LLVector4a* norm = params.mNormals;
+
+	const S32 full = count & ~(TC_BLOCK - 1);
+	for (S32 i = 0; i < full; i += TC_BLOCK)
+	{
+		block(tc + i, PLANAR ? pos + i : NULL, PLANAR ? norm + i : NULL, dst + i);
+	}
+
+	// The last few go through a padded copy, so nothing past count is read or written
+	const S32 tail = count - full;
+	if (tail)
+	{
+		LL_ALIGN_16(LLVector4a tail_pos[TC_BLOCK]);
+		LL_ALIGN_16(LLVector4a tail_norm[TC_BLOCK]);
+		LLVector2 tail_tc[TC_BLOCK];
+		LLVector2 tail_out[TC_BLOCK];
+		for (S32 i = 0; i < TC_BLOCK; ++i)
+		{
+			const S32 src = full + llmin(i, tail - 1);
+			if (PLANAR)
+			{
+				tail_pos[i] = pos[src];
+				tail_norm[i] = norm[src];
+			}
+			else
+			{
+				tail_tc[i] = tc[src];
+			}
+		}
+		block(tail_tc, tail_pos, tail_norm, tail_out);
+		for (S32 i = 0; i < tail; ++i)
+		{
+			dst[full + i] = tail_out[i];
+		}
+	}
+}
+
+static void copy_texcoords(const LLVertexPack::TexCoordParams& params, S32 count, LLVector2* dst)
+{
+	memcpy(dst, params.mTexCoords, count * sizeof(LLVector2));
+}
+
+//static
+LLVertexPack::texcoord_kernel_t LLVertexPack::getTexCoordKernel(bool planar, ETexCoordTransform transform)
+{
+	switch (transform)
+	{
+		case TC_XFORM:
+			return planar ? pack_texcoords<true, TC_XFORM> : pack_texcoords<false, TC_XFORM>;
+		case TC_MATRIX:
+			return planar ? pack_texcoords<true, TC_MATRIX> : pack_texcoords<false, TC_MATRIX>;
+		case TC_NONE:
+		default:
+			return planar ? pack_texcoords<true, TC_NONE> : copy_texcoords;
+	}
+}
+
+//static
+void LLVertexPack::transformPositions(const LLMatrix4a& mat, const LLVector4a* src, S32 count,
+									  S32 texture_index, LLVector4a* dst, S32 dst_count)
+{
+	llassert(count > 0);
+
+	// The texture index rides in w as raw bits
+	const LLQuad w_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	const LLQuad w_index = _mm_castsi128_ps(_mm_set_epi32(texture_index, 0, 0, 0));
+
+	LLVector4a res0, res1, res2, res3;
+	S32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		mat.affineTransform(src[i], res0);
+		mat.affineTransform(src[i + 1], res1);
+		mat.affineTransform(src[i + 2], res2);
+		mat.affineTransform(src[i + 3], res3);
+		dst[i] = _mm_or_ps(_mm_andnot_ps(w_mask, res0), w_index);
+		dst[i + 1] = _mm_or_ps(_mm_andnot_ps(w_mask, res1), w_index);
+		dst[i + 2] = _mm_or_ps(_mm_andnot_ps(w_mask, res2), w_index);
+		dst[i + 3] = _mm_or_ps(_mm_andnot_ps(w_mask, res3), w_index);
+	}
+	// res3 is the last position if the loop above consumed everything
+	res0 = res3;
+	for (; i < count; ++i)
+	{
+		mat.affineTransform(src[i], res0);
+		dst[i] = _mm_or_ps(_mm_andnot_ps(w_mask, res0), w_index);
+	}
+
+	for (; i < dst_count; ++i)
+	{
+		dst[i] = res0;
+	}
+}
+
+//static
+void LLVertexPack::rotateNormals(const LLMatrix4a& mat, const LLVector4a* src, S32 count, LLVector4a* dst)
+{
+	S32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		mat.rotate(src[i], dst[i]);
+		mat.rotate(src[i + 1], dst[i + 1]);
+		mat.rotate(src[i + 2], dst[i + 2]);
+		mat.rotate(src[i + 3], dst[i + 3]);
+	}
+	for (; i < count; ++i)
+	{
+		mat.rotate(src[i], dst[i]);
+	}
+}
+
+//static
+void LLVertexPack::rotateTangents(const LLMatrix4a& mat, const LLVector4a* src, S32 count, LLVector4a* dst)
+{
+	for (S32 i = 0; i < count; ++i)
+	{
+		LLVector4a tangent;
+		mat.rotate(src[i], tangent);
+		tangent.normalize3fast();
+		tangent.copyComponent<3>(src[i]);
+		dst[i] = tangent;
+	}
+}
+
+//static
+void LLVertexPack::offsetIndices(const U16* src, S32 count, U16 offset, U16* dst)
+{
+	const __m128i offset8 = _mm_set1_epi16(offset);
+
+	const S32 full = count & ~7;
+	for (S32 i = 0; i < full; i += 8)
+	{
+		const __m128i idx = _mm_loadu_si128((const __m128i*) (src + i));
+		_mm_storeu_si128((__m128i*) (dst + i), _mm_add_epi16(idx, offset8));
+	}
+	for (S32 i = full; i < count; ++i)
+	{
+		dst[i] = src[i] + offset;
+	}
+}
+
+//static
+void LLVertexPack::fill(U32 value, S32 count, U32* dst)
+{
+	const LLQuad value4 = _mm_castsi128_ps(_mm_set1_epi32(value));
+	for (S32 i = 0; i < count; i += 4)
+	{
+		_mm_store_ps((F32*) (dst + i), value4);
+	}
+}
@@ -0,0 +1,100 @@
+/**
+ * @file llvertexpack.h
+ * @brief SSE2 kernels that pack volume face streams into vertex buffers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVERTEXPACK_H
+#define LL_LLVERTEXPACK_H
+
+class LLMatrix4a;
+class LLVector2;
+class LLVector4a;
+
+/**
+ * @class LLVertexPack
+ * @brief One loop per vertex stream, for LLFace::packGeometryVolume().
+ *
+ * Every kernel reads each source vertex once and writes each destination
+ * vertex once. Texture coordinates are processed four at a time as
+ * separate s and t vectors; positions, normals and tangents one vertex
+ * per vector, several vertices per iteration. The results are bit for bit
+ * those of the per vertex code in LLFace that they replaced.
+ *
+ * Destinations are the mapped ranges of a vertex buffer and follow its
+ * layout: 16 byte aligned positions, normals, tangents and colors, packed
+ * texture coordinates at any 8 byte boundary.
+ */
+class LLVertexPack
+{
+public:
+	enum ETexCoordTransform
+	{
+		TC_NONE,		// Copy
+		TC_XFORM,		// Rotate, scale and offset about the face center
+		TC_MATRIX		// Texture animation matrix
+	};
+
+	// Everything a texture coordinate kernel reads, set up once per face and channel.
+	struct TexCoordParams
+	{
+		const LLVector2* mTexCoords;
+		const LLVector4a* mPositions;	// Planar only
+		const LLVector4a* mNormals;		// Planar only
+		F32 mScale[3];					// Planar only: object scale applied to positions
+		const LLMatrix4a* mMatrix;		// TC_MATRIX only
+		F32 mCos;						// TC_XFORM only
+		F32 mSin;
+		F32 mOffsetS;
+		F32 mOffsetT;
+		F32 mScaleS;
+		F32 mScaleT;
+	};
+
+	typedef void (*texcoord_kernel_t)(const TexCoordParams& params, S32 count, LLVector2* dst);
+
+	// The kernel for one combination of planar projection and transform.
+	static texcoord_kernel_t getTexCoordKernel(bool planar, ETexCoordTransform transform);
+
+	/**
+	 * @brief Affine transform count positions, storing texture_index in w.
+	 *
+	 * Entries count to dst_count - 1 are padded with the last transformed
+	 * position; count must be at least 1.
+	 */
+	static void transformPositions(const LLMatrix4a& mat, const LLVector4a* src, S32 count,
+								   S32 texture_index, LLVector4a* dst, S32 dst_count);
+
+	static void rotateNormals(const LLMatrix4a& mat, const LLVector4a* src, S32 count, LLVector4a* dst);
+
+	// Rotate and normalize, keeping the handedness in w.
+	static void rotateTangents(const LLMatrix4a& mat, const LLVector4a* src, S32 count, LLVector4a* dst);
+
+	// dst[i] = src[i] + offset
+	static void offsetIndices(const U16* src, S32 count, U16 offset, U16* dst);
+
+	// Fill count 32 bit values, rounded up to a multiple of four.
+	static void fill(U32 value, S32 count, U32* dst);
+};
+
+#endif // LL_LLVERTEXPACK_H
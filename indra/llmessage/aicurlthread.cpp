@@ -39,6 +39,7 @@
 #include "llhttpstatuscodes.h"
 #include "llbuffer.h"
 #include "llcontrol.h"
+#include "llfasttimer.h"
 #include <sys/types.h>
 #if !LL_WINDOWS
 #include <sys/select.h>
@@ -1381,6 +1382,9 @@ static bool is_bad(curl_socket_t fd, bool for_writing)
   return ret == -1;
 }
 
+static LLFastTimer::DeclareTimer FTM_CURL_COMMANDS("Curl Commands");
+static LLFastTimer::DeclareTimer FTM_CURL_SOCKET_ACTIONS("Curl Socket Actions");
+
 // The main loop of the curl thread.
 void AICurlThread::run(void)
 {
@@ -1399,6 +1403,7 @@ void AICurlThread::run(void)
 		if (mWakeUpFlag)
 		{
 		  mWakeUpFlagMutex.unlock();
+		  LLFastTimer t(FTM_CURL_COMMANDS);
 		  process_commands(multi_handle_w);
 		  continue;
 		}
@@ -1572,6 +1577,7 @@ void AICurlThread::run(void)
 		}
 		continue;
 	  }
+	  LLFastTimer t(FTM_CURL_SOCKET_ACTIONS);
 	  // Update the clocks.
 	  AICurlTimer::sTime_1ms = get_clock_count() * AICurlTimer::sClockWidth_1ms;
 	  Dout(dc::curl, "AICurlTimer::sTime_1ms = " << AICurlTimer::sTime_1ms);
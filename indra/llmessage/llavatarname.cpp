@@ -32,6 +32,7 @@
 #include "llcontrol.h" // For LLCachedControl
 #include "lldate.h"
 #include "llframetimer.h"
+#include "llnamestore.h"
 #include "llsd.h"
 
 // Store these in pre-built std::strings to avoid memory allocations in
@@ -126,6 +127,35 @@ void LLAvatarName::fromLLSD(const LLSD& sd)
 	}
 }
 
+void LLAvatarName::toRecord(LLNameRecord& record) const
+{
+	record.addString(mUsername);
+	record.addString(mDisplayName);
+	record.addString(mLegacyFirstName);
+	record.addString(mLegacyLastName);
+	record.addU32(mIsDisplayNameDefault ? 1 : 0);
+	record.addF64(mExpires);
+	record.addF64(mNextUpdate);
+}
+
+bool LLAvatarName::fromRecord(LLNameRecord& record)
+{
+	U32 is_display_name_default;
+	if (!record.getString(mUsername)
+		|| !record.getString(mDisplayName)
+		|| !record.getString(mLegacyFirstName)
+		|| !record.getString(mLegacyLastName)
+		|| !record.getU32(is_display_name_default)
+		|| !record.getF64(mExpires)
+		|| !record.getF64(mNextUpdate))
+	{
+		return false;
+	}
+	mIsDisplayNameDefault = is_display_name_default != 0;
+	mIsTemporaryName = false;
+	return true;
+}
+
 // Transform a string (typically provided by the legacy service) into a decent
 // avatar name instance.
 void LLAvatarName::fromString(const std::string& full_name)
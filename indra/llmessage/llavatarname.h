@@ -32,6 +32,7 @@
 
 const S32& main_name_system();
 
+class LLNameRecord;
 class LLSD;
 
 class LLAvatarName
@@ -45,6 +46,10 @@ public:
 	LLSD asLLSD() const;
 	void fromLLSD(const LLSD& sd);
 
+	// Conversion to and from an LLNameStore record (name store file)
+	void toRecord(LLNameRecord& record) const;
+	bool fromRecord(LLNameRecord& record);
+
 	// Used only in legacy mode when the display name capability is not provided server side
 	// or to otherwise create a temporary valid item.
 	void fromString(const std::string& full_name);
@@ -87,6 +92,10 @@ public:
 	// Returns "james.linden" or the legacy name for very old names
 	std::string getAccountName() const { return mUsername; }
 
+	// "James" and "Linden", or "bobsmith123" and "Resident"
+	const std::string& getLegacyFirstName() const { return mLegacyFirstName; }
+	const std::string& getLegacyLastName() const { return mLegacyLastName; }
+
 	// Returns name in the format desired according to name_system
 	std::string getNSName(const S32& name_system = main_name_system()) const
 	{
@@ -32,6 +32,7 @@
 #include "llcontrol.h"		// For LLCachedControl
 #include "llframetimer.h"
 #include "llhttpclient.h"
+#include "llnamestore.h"
 #include "llsd.h"
 #include "llsdserialize.h"
 
@@ -39,6 +40,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 namespace LLAvatarNameCache
 {
@@ -83,6 +85,13 @@ namespace LLAvatarNameCache
 	typedef std::map<LLUUID, LLAvatarName> cache_t;
 	cache_t sCache;
 
+	// Where the cache is kept between sessions, if anywhere.
+	LLNameStore* sStore = NULL;
+
+	// Agents the People API had no name for, asked for over the legacy
+	// protocol instead.
+	std::set<LLUUID> sLegacyFallback;
+
 	// Send bulk lookup requests a few times a second at most.
 	// Only need per-frame timing resolution.
 	LLFrameTimer sRequestTimer;
@@ -104,6 +113,16 @@ namespace LLAvatarNameCache
 	void processName(const LLUUID& agent_id,
 					 const LLAvatarName& av_name);
 
+	void storeName(const LLUUID& agent_id, const LLAvatarName& av_name);
+	void loadName(const LLUUID& agent_id, LLNameRecord& record,
+				  F64 max_unrefreshed, std::vector<LLUUID>& expired);
+
+	// Agent name provider of gCacheName: while we use the People API,
+	// the legacy cache gets its agent names from us.
+	bool provideAgentName(const LLUUID& agent_id);
+	// Hands the legacy name in av_name to gCacheName.
+	void insertLegacyName(const LLUUID& agent_id, const LLAvatarName& av_name);
+
 	void requestNamesViaCapability();
 
 	// Legacy name system callbacks
@@ -271,6 +290,7 @@ void LLAvatarNameCache::handleAgentError(const LLUUID& agent_id)
         // there is no existing cache entry, so make a temporary name from legacy
         LL_WARNS("AvNameCache") << "LLAvatarNameCache get legacy for agent "
                                 << agent_id << LL_ENDL;
+        sLegacyFallback.insert(agent_id);
         gCacheName->get(agent_id, false,  // legacy compatibility
                         boost::bind(&LLAvatarNameCache::legacyNameFetch, _1, _2, _3));
     }
@@ -288,6 +308,9 @@ void LLAvatarNameCache::handleAgentError(const LLUUID& agent_id)
 
 		 // Reset expiry time so we don't constantly rerequest.
 		av_name.setExpires(TEMP_CACHE_ENTRY_LIFETIME);
+
+		// gCacheName may be waiting for us.
+		insertLegacyName(agent_id, av_name);
     }
 }
 
@@ -295,6 +318,8 @@ void LLAvatarNameCache::processName(const LLUUID& agent_id, const LLAvatarName&
 {
 	// Add to the cache
 	sCache[agent_id] = av_name;
+	storeName(agent_id, av_name);
+	insertLegacyName(agent_id, av_name);
 
 	// Suppress request from the queue
 	sPendingQueue.erase(agent_id);
@@ -313,6 +338,58 @@ void LLAvatarNameCache::processName(const LLUUID& agent_id, const LLAvatarName&
 	}
 }
 
+void LLAvatarNameCache::storeName(const LLUUID& agent_id, const LLAvatarName& av_name)
+{
+	// Do not write temporary entries to the stored cache
+	if (sStore && av_name.isValidName())
+	{
+		LLNameRecord record;
+		av_name.toRecord(record);
+		sStore->put(LLNameStore::AVATAR_NAME, agent_id, record);
+	}
+}
+
+void LLAvatarNameCache::loadName(const LLUUID& agent_id, LLNameRecord& record,
+								 F64 max_unrefreshed, std::vector<LLUUID>& expired)
+{
+	LLAvatarName av_name;
+	if (!av_name.fromRecord(record) || !av_name.isValidName(max_unrefreshed))
+	{
+		expired.push_back(agent_id);
+		return;
+	}
+	// What we learned this session is newer.
+	sCache.insert(std::make_pair(agent_id, av_name));
+}
+
+bool LLAvatarNameCache::provideAgentName(const LLUUID& agent_id)
+{
+	if (!usePeopleAPI() || sLegacyFallback.count(agent_id))
+	{
+		return false;
+	}
+
+	cache_t::const_iterator it = sCache.find(agent_id);
+	if (it != sCache.end() && it->second.isValidName(LLFrameTimer::getTotalSeconds()))
+	{
+		insertLegacyName(agent_id, it->second);
+	}
+	else if (!isRequestPending(agent_id))
+	{
+		sAskQueue.insert(agent_id);
+	}
+	return true;
+}
+
+void LLAvatarNameCache::insertLegacyName(const LLUUID& agent_id, const LLAvatarName& av_name)
+{
+	// Temporary names came from gCacheName, or are made up
+	if (gCacheName && av_name.isValidName())
+	{
+		gCacheName->insertAgentName(agent_id, av_name.getLegacyFirstName(), av_name.getLegacyLastName());
+	}
+}
+
 void LLAvatarNameCache::requestNamesViaCapability()
 {
 	F64 now = LLFrameTimer::getTotalSeconds();
@@ -397,6 +474,8 @@ void LLAvatarNameCache::legacyNameFetch(const LLUUID& agent_id,
 							 << ( is_group ? " [group]" : "" )
 							 << LL_ENDL;
 
+	sLegacyFallback.erase(agent_id);
+
 	// Construct an av_name record from this name.
 	LLAvatarName av_name;
 	av_name.fromString(full_name);
@@ -432,11 +511,45 @@ void LLAvatarNameCache::initClass(bool running, bool usePeopleAPI)
 {
 	sRunning = running;
 	sUsePeopleAPI = usePeopleAPI;
+	if (gCacheName)
+	{
+		gCacheName->setAgentNameProvider(&LLAvatarNameCache::provideAgentName);
+	}
 }
 
 void LLAvatarNameCache::cleanupClass()
 {
+	if (gCacheName)
+	{
+		gCacheName->setAgentNameProvider(LLCacheName::agent_name_provider_t());
+	}
 	sCache.clear();
+	sLegacyFallback.clear();
+	sStore = NULL;
+}
+
+void LLAvatarNameCache::setStore(LLNameStore* store)
+{
+	sStore = store;
+	if (!store)
+	{
+		return;
+	}
+
+	for (cache_t::const_iterator it = sCache.begin(); it != sCache.end(); ++it)
+	{
+		storeName(it->first, it->second);
+	}
+
+	std::vector<LLUUID> expired;
+	F64 max_unrefreshed = LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
+	store->forEach(LLNameStore::AVATAR_NAME,
+		boost::bind(&LLAvatarNameCache::loadName, _1, _2, max_unrefreshed, boost::ref(expired)));
+	for (std::vector<LLUUID>::const_iterator it = expired.begin(); it != expired.end(); ++it)
+	{
+		store->erase(LLNameStore::AVATAR_NAME, *it);
+	}
+	LL_INFOS("AvNameCache") << "loaded " << sCache.size() << ", " << expired.size() << " expired" << LL_ENDL;
 }
 
 void LLAvatarNameCache::importFile(std::istream& istr)
@@ -572,6 +685,10 @@ void LLAvatarNameCache::eraseUnrefreshed()
                                          << " user '" << av_name.getAccountName() << "' "
                                          << "expired " << now - av_name.mExpires << " secs ago"
                                          << LL_ENDL;
+                if (sStore)
+                {
+                    sStore->erase(LLNameStore::AVATAR_NAME, it->first);
+                }
                 sCache.erase(it++);
             }
 			else
@@ -744,12 +861,17 @@ void LLAvatarNameCache::setUseUsernames(bool use)
 void LLAvatarNameCache::erase(const LLUUID& agent_id)
 {
 	sCache.erase(agent_id);
+	if (sStore)
+	{
+		sStore->erase(LLNameStore::AVATAR_NAME, agent_id);
+	}
 }
 
 void LLAvatarNameCache::insert(const LLUUID& agent_id, const LLAvatarName& av_name)
 {
 	// *TODO: update timestamp if zero?
 	sCache[agent_id] = av_name;
+	storeName(agent_id, av_name);
 }
 
 F64 LLAvatarNameCache::nameExpirationFromHeaders(AIHTTPReceivedHeaders const& headers)
@@ -33,6 +33,7 @@
 #include <boost/signals2.hpp>
 
 class AIHTTPReceivedHeaders;
+class LLNameStore;
 class LLUUID;
 
 namespace LLAvatarNameCache
@@ -49,6 +50,10 @@ namespace LLAvatarNameCache
 	void importFile(std::istream& istr);
 	void exportFile(std::ostream& ostr);
 
+	// Loads the names in store, and writes every name we learn or expire
+	// to it from then on. Names already in the cache are written first.
+	void setStore(LLNameStore* store);
+
 	// On the viewer, usually a simulator capabilitity.
 	// If empty, name cache will fall back to using legacy name lookup system.
 	void setNameLookupURL(const std::string& name_lookup_url);
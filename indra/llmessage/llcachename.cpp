@@ -33,6 +33,7 @@
 #include "lldbstrings.h"
 #include "llframetimer.h"
 #include "llhost.h"
+#include "llnamestore.h"
 #include "llrand.h"
 #include "llsdserialize.h"
 #include "lluuid.h"
@@ -55,6 +56,9 @@ const U32 PENDING_TIMEOUT_SECS = 5 * 60;
 // File version number
 const S32 CN_FILE_VERSION = 2;
 
+// Names loaded from disk are dropped once they are this old.
+const U32 STORED_NAME_LIFETIME_SECS = 7 * 24 * 60 * 60;
+
 // Globals
 LLCacheName* gCacheName = NULL;
 std::map<std::string, std::string> LLCacheName::sCacheName;
@@ -216,10 +220,22 @@ public:
 
 	LLFrameTimer		mProcessTimer;
 
+	LLNameStore*		mStore;
+		// where names are kept between sessions, if anywhere
+
+	agent_name_provider_t mAgentNameProvider;
+
+	bool				mHaveNewEntries;
+		// entries arrived since processPendingReplies() last ran
+
 	Impl(LLMessageSystem* msg);
 	~Impl();
 
 	BOOL getName(const LLUUID& id, std::string& first, std::string& last);
+	void setAgentName(const LLUUID& id, std::string first, std::string last);
+
+	void storeEntry(const LLUUID& id, const LLCacheNameEntry& entry);
+	void loadEntry(const LLUUID& id, LLNameRecord& record, bool is_group, U32 expire_time, std::vector<LLUUID>& expired);
 
 	boost::signals2::connection addPending(const LLUUID& id, const LLCacheNameCallback& callback);
 	void addPending(const LLUUID& id, const LLHost& host);
@@ -263,7 +279,7 @@ LLCacheName::~LLCacheName()
 }
 
 LLCacheName::Impl::Impl(LLMessageSystem* msg)
-	: mMsg(msg), mUpstreamHost(LLHost::invalid)
+	: mMsg(msg), mUpstreamHost(LLHost::invalid), mStore(NULL), mHaveNewEntries(false)
 {
 	mMsg->setHandlerFuncFast(
 		_PREHASH_UUIDNameRequest, handleUUIDNameRequest, (void**)this);
@@ -318,8 +334,7 @@ bool LLCacheName::importFile(std::istream& istr)
 
 	// We'll expire entries more than a week old
 	U32 now = (U32)time(NULL);
-	const U32 SECS_PER_DAY = 60 * 60 * 24;
-	U32 delete_before_time = now - (7 * SECS_PER_DAY);
+	U32 delete_before_time = now - STORED_NAME_LIFETIME_SECS;
 
 	// iterate over the agents
 	S32 count = 0;
@@ -405,6 +420,123 @@ void LLCacheName::exportFile(std::ostream& ostr)
 	LLSDSerialize::toPrettyXML(data, ostr);
 }
 
+void LLCacheName::setStore(LLNameStore* store)
+{
+	impl.mStore = store;
+	if (!store)
+	{
+		return;
+	}
+
+	for (Cache::const_iterator it = impl.mCache.begin(); it != impl.mCache.end(); ++it)
+	{
+		impl.storeEntry(it->first, *it->second);
+	}
+
+	std::vector<LLUUID> expired_agents, expired_groups;
+	U32 expire_time = (U32)time(NULL) - STORED_NAME_LIFETIME_SECS;
+	store->forEach(LLNameStore::AGENT_NAME,
+		boost::bind(&Impl::loadEntry, &impl, _1, _2, false, expire_time, boost::ref(expired_agents)));
+	store->forEach(LLNameStore::GROUP_NAME,
+		boost::bind(&Impl::loadEntry, &impl, _1, _2, true, expire_time, boost::ref(expired_groups)));
+	for (std::vector<LLUUID>::const_iterator it = expired_agents.begin(); it != expired_agents.end(); ++it)
+	{
+		store->erase(LLNameStore::AGENT_NAME, *it);
+	}
+	for (std::vector<LLUUID>::const_iterator it = expired_groups.begin(); it != expired_groups.end(); ++it)
+	{
+		store->erase(LLNameStore::GROUP_NAME, *it);
+	}
+	impl.mHaveNewEntries = true;
+	LL_INFOS() << "LLCacheName has " << impl.mCache.size() << " names, "
+			   << expired_agents.size() + expired_groups.size() << " expired" << LL_ENDL;
+}
+
+void LLCacheName::Impl::storeEntry(const LLUUID& id, const LLCacheNameEntry& entry)
+{
+	// Only store entries for which we have valid data, like exportFile().
+	if (!mStore
+		|| (std::string::npos != entry.mFirstName.find('?'))
+		|| (std::string::npos != entry.mGroupName.find('?')))
+	{
+		return;
+	}
+
+	LLNameRecord record;
+	record.addU32(entry.mCreateTime);
+	if (!entry.mIsGroup && !entry.mFirstName.empty() && !entry.mLastName.empty())
+	{
+		record.addString(entry.mFirstName);
+		record.addString(entry.mLastName);
+		mStore->put(LLNameStore::AGENT_NAME, id, record);
+	}
+	else if (entry.mIsGroup && !entry.mGroupName.empty())
+	{
+		record.addString(entry.mGroupName);
+		mStore->put(LLNameStore::GROUP_NAME, id, record);
+	}
+}
+
+void LLCacheName::Impl::loadEntry(const LLUUID& id, LLNameRecord& record, bool is_group, U32 expire_time, std::vector<LLUUID>& expired)
+{
+	LLCacheNameEntry loaded;
+	loaded.mIsGroup = is_group;
+	bool valid = record.getU32(loaded.mCreateTime)
+		&& (is_group ? record.getString(loaded.mGroupName)
+					 : record.getString(loaded.mFirstName) && record.getString(loaded.mLastName));
+	if (!valid || loaded.mCreateTime < expire_time)
+	{
+		expired.push_back(id);
+		return;
+	}
+
+	// What we learned this session is newer.
+	LLCacheNameEntry*& entry = mCache[id];
+	if (entry)
+	{
+		return;
+	}
+	entry = new LLCacheNameEntry(loaded);
+	if (is_group)
+	{
+		mReverseCache[entry->mGroupName] = id;
+	}
+	else
+	{
+		mReverseCache[buildFullName(entry->mFirstName, entry->mLastName)] = id;
+	}
+}
+
+void LLCacheName::setAgentNameProvider(const agent_name_provider_t& provider)
+{
+	impl.mAgentNameProvider = provider;
+}
+
+void LLCacheName::insertAgentName(const LLUUID& id, const std::string& first, const std::string& last)
+{
+	if (id.isNull() || first.empty())
+	{
+		return;
+	}
+
+	// The People API keeps refreshing the names we have; only tell the
+	// observers about names that changed.
+	LLCacheNameEntry* entry = get_ptr_in_map(impl.mCache, id);
+	if (entry && !entry->mIsGroup && entry->mFirstName == first && entry->mLastName == last)
+	{
+		// A day off on the age of a stored name doesn't matter; a record
+		// for every refresh would.
+		const U32 now = (U32)time(NULL);
+		const U32 SECS_PER_DAY = 60 * 60 * 24;
+		if (now - entry->mCreateTime > SECS_PER_DAY)
+		{
+			entry->mCreateTime = now;
+			impl.storeEntry(id, *entry);
+		}
+		return;
+	}
+	impl.setAgentName(id, first, last);
+}
 
 BOOL LLCacheName::Impl::getName(const LLUUID& id, std::string& first, std::string& last)
 {
@@ -715,6 +847,10 @@ void LLCacheName::deleteEntriesOlderThan(S32 secs)
 		LLCacheNameEntry* entry = curiter->second;
 		if (entry->mCreateTime < expire_time)
 		{
+			if (impl.mStore)
+			{
+				impl.mStore->erase(entry->mIsGroup ? LLNameStore::GROUP_NAME : LLNameStore::AGENT_NAME, curiter->first);
+			}
 			delete entry;
 			impl.mCache.erase(curiter);
 		}
@@ -793,6 +929,23 @@ std::string LLCacheName::getDefaultLastName()
 
 void LLCacheName::Impl::processPendingAsks()
 {
+	if (mAgentNameProvider)
+	{
+		for (AskQueue::iterator it = mAskNameQueue.begin(); it != mAskNameQueue.end(); )
+		{
+			if (mAgentNameProvider(*it))
+			{
+				// The provider tracks the request from here.
+				mPendingQueue.erase(*it);
+				mAskNameQueue.erase(it++);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
 	sendRequest(_PREHASH_UUIDNameRequest, mAskNameQueue);
 	sendRequest(_PREHASH_UUIDGroupNameRequest, mAskGroupQueue);
 	mAskNameQueue.clear();
@@ -801,6 +954,14 @@ void LLCacheName::Impl::processPendingAsks()
 
 void LLCacheName::Impl::processPendingReplies()
 {
+	// Replies wait for entries that are not in the cache; without new
+	// entries, none of them can be answered.
+	if (!mHaveNewEntries)
+	{
+		return;
+	}
+	mHaveNewEntries = false;
+
 	// First call all the callbacks, because they might send messages.
 	for(ReplyQueue::iterator it = mReplyQueue.begin(); it != mReplyQueue.end(); ++it)
 	{
@@ -963,6 +1124,15 @@ void LLCacheName::Impl::processUUIDReply(LLMessageSystem* msg, bool isGroup)
 	{
 		LLUUID id;
 		msg->getUUIDFast(_PREHASH_UUIDNameBlock, _PREHASH_ID, id, i);
+		if (!isGroup)
+		{
+			std::string first, last;
+			msg->getStringFast(_PREHASH_UUIDNameBlock, _PREHASH_FirstName, first, i);
+			msg->getStringFast(_PREHASH_UUIDNameBlock, _PREHASH_LastName, last, i);
+			setAgentName(id, first, last);
+			continue;
+		}
+
 		LLCacheNameEntry* entry = get_ptr_in_map(mCache, id);
 		if (!entry)
 		{
@@ -974,47 +1144,50 @@ void LLCacheName::Impl::processUUIDReply(LLMessageSystem* msg, bool isGroup)
 
 		entry->mIsGroup = isGroup;
 		entry->mCreateTime = (U32)time(NULL);
-		if (!isGroup)
-		{
-			msg->getStringFast(_PREHASH_UUIDNameBlock, _PREHASH_FirstName, entry->mFirstName, i);
-			msg->getStringFast(_PREHASH_UUIDNameBlock, _PREHASH_LastName,  entry->mLastName, i);
-		}
-		else
-		{	// is group
-			msg->getStringFast(_PREHASH_UUIDNameBlock, _PREHASH_GroupName, entry->mGroupName, i);
-			LLStringFn::replace_ascii_controlchars(entry->mGroupName, LL_UNKNOWN_CHAR);
-		}
+		msg->getStringFast(_PREHASH_UUIDNameBlock, _PREHASH_GroupName, entry->mGroupName, i);
+		LLStringFn::replace_ascii_controlchars(entry->mGroupName, LL_UNKNOWN_CHAR);
 
-		if (!isGroup)
-		{
-			// NOTE: Very occasionally the server sends down a full name
-			// in the first name field with an empty last name, for example,
-			// first = "Ladanie1 Resident", last = "".
-			// I cannot reproduce this, nor can I find a bug in the server code.
-			// Ensure "Resident" does not appear via cleanFullName, because
-			// buildFullName only checks last name. JC
-			std::string full_name;
-			if (entry->mLastName.empty())
-			{
-				full_name = cleanFullName(entry->mFirstName);
+		mSignal(id, entry->mGroupName, true);
+		mReverseCache[entry->mGroupName] = id;
+		storeEntry(id, *entry);
+		mHaveNewEntries = true;
+	}
+}
 
-				//fix what we are putting in the cache
-				entry->mFirstName = full_name;
-				entry->mLastName = "Resident";
-			}
-			else
-			{
-				full_name = LLCacheName::buildFullName(entry->mFirstName, entry->mLastName);
-			}
-			mSignal(id, full_name, false);
-			mReverseCache[full_name] = id;
-		}
-		else
-		{
-			mSignal(id, entry->mGroupName, true);
-			mReverseCache[entry->mGroupName] = id;
-		}
+void LLCacheName::Impl::setAgentName(const LLUUID& id, std::string first, std::string last)
+{
+	// NOTE: Very occasionally the server sends down a full name
+	// in the first name field with an empty last name, for example,
+	// first = "Ladanie1 Resident", last = "".
+	// I cannot reproduce this, nor can I find a bug in the server code.
+	// Ensure "Resident" does not appear via cleanFullName, because
+	// buildFullName only checks last name. JC
+	if (last.empty())
+	{
+		//fix what we are putting in the cache
+		first = cleanFullName(first);
+		last = "Resident";
 	}
+
+	LLCacheNameEntry* entry = get_ptr_in_map(mCache, id);
+	if (!entry)
+	{
+		entry = new LLCacheNameEntry;
+		mCache[id] = entry;
+	}
+
+	mPendingQueue.erase(id);
+
+	entry->mIsGroup = false;
+	entry->mCreateTime = (U32)time(NULL);
+	entry->mFirstName = first;
+	entry->mLastName = last;
+	storeEntry(id, *entry);
+	mHaveNewEntries = true;
+
+	std::string full_name = LLCacheName::buildFullName(first, last);
+	mSignal(id, full_name, false);
+	mReverseCache[full_name] = id;
 }
 
 
@@ -28,10 +28,12 @@
 #define LL_LLCACHENAME_H
 
 #include <boost/bind.hpp>
+#include <boost/function.hpp>
 #include <boost/signals2.hpp>
 
 class LLMessageSystem;
 class LLHost;
+class LLNameStore;
 class LLUUID;
 
 
@@ -68,6 +70,22 @@ public:
 	bool importFile(std::istream& istr);
 	void exportFile(std::ostream& ostr);
 
+	// Loads the names in store, and writes every name we learn or expire
+	// to it from then on. Names already in the cache are written first.
+	// NULL detaches the store.
+	void setStore(LLNameStore* store);
+
+	// Agent names we need are offered to the provider first. Those it
+	// takes (returns true for) are not requested from the upstream host;
+	// the provider hands them back through insertAgentName(). This keeps
+	// the viewer from fetching a name both here and through the People API.
+	typedef boost::function<bool (const LLUUID& id)> agent_name_provider_t;
+	void setAgentNameProvider(const agent_name_provider_t& provider);
+
+	// Adds an agent name that was learned some other way, as if the
+	// upstream host had sent it.
+	void insertAgentName(const LLUUID& id, const std::string& first, const std::string& last);
+
 	// If available, copies name ("bobsmith123" or "James Linden") into string
 	// If not available, copies the string "waiting".
 	// Returns TRUE iff available.
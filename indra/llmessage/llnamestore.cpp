@@ -0,0 +1,361 @@
+/**
+ * @file llnamestore.cpp
+ * @brief Append-only on-disk store shared by the name caches.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llnamestore.h"
+
+#include "llfile.h"
+
+namespace
+{
+
+const char STORE_MAGIC[4] = { 'L', 'L', 'N', 'S' };
+const U32 STORE_VERSION = 1;
+const U32 STORE_HEADER_SIZE = sizeof(STORE_MAGIC) + sizeof(U32);
+
+// U32 payload size, U8 type, UUID
+const U32 RECORD_HEADER_SIZE = sizeof(U32) + 1 + UUID_BYTES;
+// Names are much shorter; a larger size means the file is damaged.
+const U32 MAX_PAYLOAD_SIZE = 64 * 1024;
+
+// open() rewrites the file once it holds more replaced records than live
+// ones, and at least this many.
+const U32 MIN_DEAD_RECORDS_TO_COMPACT = 1024;
+
+const F32 FLUSH_INTERVAL = 5.f;
+
+// Sizes are in host byte order: the store is a cache, that never leaves
+// the machine that wrote it.
+void append_record(std::string& out, U8 type, const LLUUID& id, const std::string& data)
+{
+	const U32 size = (U32)data.size();
+	out.append((const char*)&size, sizeof(size));
+	out += (char)type;
+	out.append((const char*)id.mData, UUID_BYTES);
+	out += data;
+}
+
+bool write_file(const std::string& filename, const char* mode, const std::string& data)
+{
+	LLFILE* file = LLFile::fopen(filename, mode);
+	if (!file)
+	{
+		return false;
+	}
+	bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+	return LLFile::close(file) == 0 && written;
+}
+
+} // namespace
+
+/// ---------------------------------------------------------------------------
+/// class LLNameRecord
+/// ---------------------------------------------------------------------------
+
+void LLNameRecord::addU32(U32 value)
+{
+	mData.append((const char*)&value, sizeof(value));
+}
+
+void LLNameRecord::addF64(F64 value)
+{
+	mData.append((const char*)&value, sizeof(value));
+}
+
+void LLNameRecord::addString(const std::string& value)
+{
+	addU32((U32)value.size());
+	mData += value;
+}
+
+bool LLNameRecord::read(void* value, U32 size)
+{
+	if (mData.size() - mReadPos < size)
+	{
+		mReadPos = (U32)mData.size();
+		return false;
+	}
+	memcpy(value, mData.data() + mReadPos, size);
+	mReadPos += size;
+	return true;
+}
+
+bool LLNameRecord::getU32(U32& value)
+{
+	U32 read_value;
+	if (!read(&read_value, sizeof(read_value)))
+	{
+		return false;
+	}
+	value = read_value;
+	return true;
+}
+
+bool LLNameRecord::getF64(F64& value)
+{
+	F64 read_value;
+	if (!read(&read_value, sizeof(read_value)))
+	{
+		return false;
+	}
+	value = read_value;
+	return true;
+}
+
+bool LLNameRecord::getString(std::string& value)
+{
+	U32 size;
+	if (!getU32(size))
+	{
+		return false;
+	}
+	if (mData.size() - mReadPos < size)
+	{
+		mReadPos = (U32)mData.size();
+		return false;
+	}
+	value.assign(mData, mReadPos, size);
+	mReadPos += size;
+	return true;
+}
+
+/// ---------------------------------------------------------------------------
+/// class LLNameStore
+/// ---------------------------------------------------------------------------
+
+LLNameStore::LLNameStore()
+:	mFileRecords(0)
+{
+}
+
+LLNameStore::~LLNameStore()
+{
+	close();
+}
+
+bool LLNameStore::open(const std::string& filename)
+{
+	close();
+	mFilename = filename;
+
+	bool damaged = false;
+	const bool loaded = load(damaged);
+	const U32 dead = mFileRecords - size();
+	if (!loaded || damaged || (dead > size() && dead >= MIN_DEAD_RECORDS_TO_COMPACT))
+	{
+		if (!compact() && (damaged || !loaded))
+		{
+			// Records appended to this file would be lost at the next load.
+			LL_WARNS() << "Could not repair " << mFilename << "; names will not be saved this session" << LL_ENDL;
+			mFilename.clear();
+		}
+	}
+	mFlushTimer.reset();
+	return loaded;
+}
+
+void LLNameStore::close()
+{
+	flush();
+	mFilename.clear();
+	mRecords.clear();
+	mPending.clear();
+	mFileRecords = 0;
+}
+
+void LLNameStore::put(EType type, const LLUUID& id, const LLNameRecord& record)
+{
+	if (record.isEmpty())
+	{
+		erase(type, id);
+		return;
+	}
+	if (!isOpen())
+	{
+		return;
+	}
+
+	const Key key(type, id);
+	std::pair<record_map_t::iterator, bool> inserted = mRecords.insert(std::make_pair(key, record.getData()));
+	if (!inserted.second)
+	{
+		if (inserted.first->second == record.getData())
+		{
+			return;
+		}
+		inserted.first->second = record.getData();
+	}
+	mPending.insert(key);
+}
+
+void LLNameStore::erase(EType type, const LLUUID& id)
+{
+	const Key key(type, id);
+	if (isOpen() && mRecords.erase(key))
+	{
+		mPending.insert(key);
+	}
+}
+
+bool LLNameStore::has(EType type, const LLUUID& id) const
+{
+	return mRecords.find(Key(type, id)) != mRecords.end();
+}
+
+void LLNameStore::forEach(EType type, const record_func_t& func) const
+{
+	for (record_map_t::const_iterator it = mRecords.begin(); it != mRecords.end(); ++it)
+	{
+		if (it->first.mType == type)
+		{
+			LLNameRecord record(it->second);
+			func(it->first.mID, record);
+		}
+	}
+}
+
+void LLNameStore::flush()
+{
+	if (mPending.empty() || !isOpen())
+	{
+		return;
+	}
+
+	std::string data;
+	for (key_set_t::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+	{
+		// Erased records are written with no payload.
+		record_map_t::const_iterator record = mRecords.find(*it);
+		append_record(data, (U8)it->mType, it->mID, record != mRecords.end() ? record->second : LLStringUtil::null);
+	}
+	if (!write_file(mFilename, "ab", data))
+	{
+		LL_WARNS() << "Could not write " << mPending.size() << " names to " << mFilename << LL_ENDL;
+	}
+	mFileRecords += (U32)mPending.size();
+	mPending.clear();
+	mFlushTimer.reset();
+}
+
+void LLNameStore::idle()
+{
+	if (!mPending.empty() && mFlushTimer.getElapsedTimeF32() > FLUSH_INTERVAL)
+	{
+		flush();
+	}
+}
+
+bool LLNameStore::load(bool& damaged)
+{
+	damaged = false;
+	LLFILE* file = LLFile::fopen(mFilename, "rb");
+	if (!file)
+	{
+		return false;
+	}
+	std::string data;
+	char buffer[16 * 1024];
+	size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		data.append(buffer, count);
+	}
+	LLFile::close(file);
+
+	U32 version = 0;
+	if (data.size() >= STORE_HEADER_SIZE)
+	{
+		memcpy(&version, data.data() + sizeof(STORE_MAGIC), sizeof(version));
+	}
+	if (data.size() < STORE_HEADER_SIZE || memcmp(data.data(), STORE_MAGIC, sizeof(STORE_MAGIC)) || version != STORE_VERSION)
+	{
+		LL_WARNS() << mFilename << " is not a name store of version " << STORE_VERSION << "; starting a new one" << LL_ENDL;
+		return false;
+	}
+
+	size_t pos = STORE_HEADER_SIZE;
+	while (data.size() - pos >= RECORD_HEADER_SIZE)
+	{
+		U32 payload_size;
+		memcpy(&payload_size, data.data() + pos, sizeof(payload_size));
+		if (payload_size > MAX_PAYLOAD_SIZE || data.size() - pos - RECORD_HEADER_SIZE < payload_size)
+		{
+			break;
+		}
+		LLUUID id;
+		memcpy(id.mData, data.data() + pos + sizeof(payload_size) + 1, UUID_BYTES);
+		const Key key((EType)(U8)data[pos + sizeof(payload_size)], id);
+		if (payload_size)
+		{
+			mRecords[key].assign(data, pos + RECORD_HEADER_SIZE, payload_size);
+		}
+		else
+		{
+			mRecords.erase(key);
+		}
+		++mFileRecords;
+		pos += RECORD_HEADER_SIZE + payload_size;
+	}
+	if (pos != data.size())
+	{
+		LL_WARNS() << "Dropped " << data.size() - pos << " damaged bytes at the end of " << mFilename << LL_ENDL;
+		damaged = true;
+	}
+
+	LL_INFOS() << "Loaded " << size() << " names from " << mFileRecords << " records in " << mFilename << LL_ENDL;
+	return true;
+}
+
+bool LLNameStore::compact()
+{
+	std::string data(STORE_MAGIC, sizeof(STORE_MAGIC));
+	data.append((const char*)&STORE_VERSION, sizeof(STORE_VERSION));
+	for (record_map_t::const_iterator it = mRecords.begin(); it != mRecords.end(); ++it)
+	{
+		append_record(data, (U8)it->first.mType, it->first.mID, it->second);
+	}
+	const std::string temp_filename = mFilename + ".tmp";
+	if (!write_file(temp_filename, "wb", data))
+	{
+		LL_WARNS() << "Could not write " << temp_filename << LL_ENDL;
+		LLFile::remove_nowarn(temp_filename);
+		return false;
+	}
+#if LL_WINDOWS
+	// rename() does not replace files on Windows.
+	LLFile::remove_nowarn(mFilename);
+#endif
+	if (LLFile::rename(temp_filename, mFilename))
+	{
+		return false;
+	}
+	// Records that were waiting for a flush are in the new file.
+	mPending.clear();
+	mFileRecords = size();
+	return true;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file llnamestore.h
+ * @brief Append-only on-disk store shared by the name caches.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLNAMESTORE_H
+#define LL_LLNAMESTORE_H
+
+#include <boost/function.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "llframetimer.h"
+#include "llsingleton.h"
+#include "lluuid.h"
+
+// The payload of an LLNameStore record: fields, read back in the order
+// they were added.
+class LLNameRecord
+{
+public:
+	LLNameRecord() : mReadPos(0) {}
+	explicit LLNameRecord(const std::string& data) : mData(data), mReadPos(0) {}
+
+	void addU32(U32 value);
+	void addF64(F64 value);
+	void addString(const std::string& value);
+
+	// False when the record has no more fields; value is then left alone.
+	bool getU32(U32& value);
+	bool getF64(F64& value);
+	bool getString(std::string& value);
+
+	const std::string& getData() const { return mData; }
+	bool isEmpty() const { return mData.empty(); }
+
+private:
+	bool read(void* value, U32 size);
+
+	std::string mData;
+	U32 mReadPos;
+};
+
+//
+// The names that LLCacheName and LLAvatarNameCache know about, kept on disk
+// between sessions. Each cache writes a record when it learns or forgets a
+// name; the records are appended to the file a few at a time, so that the
+// store is current without rewriting the whole cache at logout.
+//
+// The file is a header followed by records:
+//
+//	U32 payload size, U8 type, 16 bytes UUID, payload
+//
+// A record replaces the earlier ones of the same type and UUID, and an empty
+// payload erases them. A record cut short by a crash ends the file. open()
+// rewrites the file when most of it is replaced records.
+//
+// The whole store is kept in memory; only open(), flush() and close() touch
+// the disk. Main thread only.
+//
+class LLNameStore : public LLSingleton<LLNameStore>
+{
+public:
+	enum EType
+	{
+		AGENT_NAME = 1,		// LLCacheName agents
+		GROUP_NAME = 2,		// LLCacheName groups
+		AVATAR_NAME = 3		// LLAvatarNameCache
+	};
+
+	typedef boost::function<void (const LLUUID& id, LLNameRecord& record)> record_func_t;
+
+	LLNameStore();
+	~LLNameStore();
+
+	// Loads the records in filename, and appends to it from then on. A
+	// missing or unreadable file starts an empty store. Returns false if
+	// there was no store to load.
+	bool open(const std::string& filename);
+	// Writes the pending records, and forgets all of them.
+	void close();
+	bool isOpen() const { return !mFilename.empty(); }
+
+	// Do nothing while the store is closed, or when nothing changes.
+	void put(EType type, const LLUUID& id, const LLNameRecord& record);
+	void erase(EType type, const LLUUID& id);
+	bool has(EType type, const LLUUID& id) const;
+	// Calls func with every record of type, in no particular order. func
+	// must not change the store.
+	void forEach(EType type, const record_func_t& func) const;
+	U32 size() const { return (U32)mRecords.size(); }
+
+	// Appends the records that changed since the last flush to the file.
+	void flush();
+	// Flushes every few seconds. Called once per frame.
+	void idle();
+
+private:
+	struct Key
+	{
+		Key(EType type, const LLUUID& id) : mType(type), mID(id) {}
+		bool operator==(const Key& rhs) const { return mType == rhs.mType && mID == rhs.mID; }
+
+		EType mType;
+		LLUUID mID;
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const { return key.mID.hash() ^ (size_t)key.mType; }
+	};
+
+	typedef boost::unordered_map<Key, std::string, KeyHash> record_map_t;
+	typedef boost::unordered_set<Key, KeyHash> key_set_t;
+
+	// Returns false if the file holds no store. Sets damaged when the file
+	// ends in a partial record.
+	bool load(bool& damaged);
+	// Writes the live records to a new file, in place of the old one.
+	bool compact();
+
+	std::string mFilename;
+	record_map_t mRecords;
+	key_set_t mPending;				// Changed since the last flush
+	U32 mFileRecords;				// Records in the file, live or replaced
+	LLFrameTimer mFlushTimer;
+};
+
+#endif // LL_LLNAMESTORE_H
@@ -89,6 +89,9 @@ void get_patch_group_header(LLGroupHeader *gopp);
 void set_group_of_patch_header(LLGroupHeader *gopp);
 void init_patch_decompressor(S32 size);
 void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph);
+// Takes the patch size and stride from its arguments instead of the group header,
+// so it can run on any thread once init_patch_decompressor() was called for the size.
+void decompress_patch(F32 *patch, const S32 *cpatch, const LLPatchHeader *ph, S32 size, S32 stride);
 void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph);
 
 #endif
@@ -29,6 +29,7 @@
 #include "llmath.h"
 //#include "vmath.h"
 #include "v3math.h"
+#include "llsimdmath.h"
 #include "patch_dct.h"
 
 LLGroupHeader	*gGOPP;
@@ -38,24 +39,43 @@ void set_group_of_patch_header(LLGroupHeader *gopp)
 	gGOPP = gopp;
 }
 
-F32 gPatchDequantizeTable[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-void build_patch_dequantize_table(S32 size)
+// The decompression tables of one patch size. Patches of both sizes can be
+// in flight on different threads, so each size keeps its own.
+struct LLPatchDecompressTables
+{
+	BOOL	mBuilt;
+	F32		mDequantize[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+	F32		mICosines[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+	S32		mDeCopy[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+};
+
+static LLPatchDecompressTables gNormalPatchTables;
+static LLPatchDecompressTables gLargePatchTables;
+
+// Anything but a normal patch is decoded as a large one.
+static inline LLPatchDecompressTables &get_patch_tables(S32 size)
+{
+	return size == NORMAL_PATCH_SIZE ? gNormalPatchTables : gLargePatchTables;
+}
+
+static inline S32 get_patch_table_size(S32 size)
+{
+	return size == NORMAL_PATCH_SIZE ? NORMAL_PATCH_SIZE : LARGE_PATCH_SIZE;
+}
+
+static void build_patch_dequantize_table(F32 *table, S32 size)
 {
 	S32 i, j;
 	for (j = 0; j < size; j++)
 	{
 		for (i = 0; i < size; i++)
 		{
-			gPatchDequantizeTable[j*size + i] = (1.f + 2.f*(i+j));
+			table[j*size + i] = (1.f + 2.f*(i+j));
 		}
 	}
 }
 
-S32	gCurrentDeSize = 0;
-
-F32	gPatchICosines[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-void setup_patch_icosines(S32 size)
+static void setup_patch_icosines(F32 *table, S32 size)
 {
 	S32 n, u;
 	F32 oosob = F_PI*0.5f/size;
@@ -64,14 +84,12 @@ void setup_patch_icosines(S32 size)
 	{
 		for (n = 0; n < size; n++)
 		{
-			gPatchICosines[u*size+n] = cosf((2.f*n+1.f)*u*oosob);
+			table[u*size+n] = cosf((2.f*n+1.f)*u*oosob);
 		}
 	}
 }
 
-S32	gDeCopyMatrix[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-void build_decopy_matrix(S32 size)
+static void build_decopy_matrix(S32 *matrix, S32 size)
 {
 	S32 i, j, count;
 	BOOL	b_diag = FALSE;
@@ -84,7 +102,7 @@ void build_decopy_matrix(S32 size)
 	while (  (i < size)
 		   &&(j < size))
 	{
-		gDeCopyMatrix[j*size + i] = count;
+		matrix[j*size + i] = count;
 
 		count++;
 
@@ -137,548 +155,119 @@ void build_decopy_matrix(S32 size)
 
 void init_patch_decompressor(S32 size)
 {
-	if (size != gCurrentDeSize)
+	LLPatchDecompressTables &tables = get_patch_tables(size);
+	if (!tables.mBuilt)
 	{
-		gCurrentDeSize = size;
-		build_patch_dequantize_table(size);
-		setup_patch_icosines(size);
-		build_decopy_matrix(size);
+		size = get_patch_table_size(size);
+		build_patch_dequantize_table(tables.mDequantize, size);
+		setup_patch_icosines(tables.mICosines, size);
+		build_decopy_matrix(tables.mDeCopy, size);
+		tables.mBuilt = TRUE;
 	}
 }
 
-inline void idct_line(F32 *linein, F32 *lineout, S32 line)
+// Columns, then lines, of the 2D IDCT of a size x size block (size is a
+// multiple of 4), four outputs at a time. Every output is summed in the
+// same order as the scalar code did, so the results are bit for bit the same.
+static void idct_patch(F32 *block, const F32 *icosines, S32 size)
 {
-	S32 n;
-	F32 total;
-	F32 *pcp = gPatchICosines;
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-	F32 oosob = 2.f/16.f;
-	S32	line_size = line*NORMAL_PATCH_SIZE;
-	F32 *tlinein, *tpcp;
-
-
-	for (n = 0; n < NORMAL_PATCH_SIZE; n++)
-	{
-		tpcp = pcp + n;
-		tlinein = linein + line_size;
-	
-		total = OO_SQRT2*(*(tlinein++));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein)*(*(tpcp += NORMAL_PATCH_SIZE));
+	F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+	const LLQuad oo_sqrt2 = _mm_set1_ps(OO_SQRT2);
+	const LLQuad oosob = _mm_set1_ps(2.f/size);
+	S32 n, u, i;
 
-		*(lineout + line_size + n) = total*oosob;
-	}
-#else
-	F32 oosob = 2.f/size;
-	S32	size = gGOPP->patch_size;
-	S32	line_size = line*size;
-	S32 u;
+	// temp[n][c] = OO_SQRT2*block[0][c] + sum(block[u][c]*icosines[u][n]), four columns c at a time
 	for (n = 0; n < size; n++)
 	{
-		total = OO_SQRT2*linein[line_size];
-		for (u = 1; u < size; u++)
+		for (i = 0; i < size; i += 4)
 		{
-			total += linein[line_size + u]*pcp[u*size+n];
+			LLQuad total = _mm_mul_ps(oo_sqrt2, _mm_loadu_ps(block + i));
+			for (u = 1; u < size; u++)
+			{
+				total = _mm_add_ps(total, _mm_mul_ps(_mm_loadu_ps(block + u*size + i), _mm_set1_ps(icosines[u*size + n])));
+			}
+			_mm_storeu_ps(temp + n*size + i, total);
 		}
-		lineout[line_size + n] = total*oosob;
 	}
-#endif
-}
-
-inline void idct_line_large_slow(F32 *linein, F32 *lineout, S32 line)
-{
-	S32 n;
-	F32 total;
-	F32 *pcp = gPatchICosines;
 
-	F32 oosob = 2.f/32.f;
-	S32	line_size = line*LARGE_PATCH_SIZE;
-	F32 *tlinein, *tpcp;
-
-
-	for (n = 0; n < LARGE_PATCH_SIZE; n++)
+	// block[l][n] = (OO_SQRT2*temp[l][0] + sum(temp[l][u]*icosines[u][n]))*2/size, four n at a time
+	for (S32 line = 0; line < size; line++)
 	{
-		tpcp = pcp + n;
-		tlinein = linein + line_size;
-	
-		total = OO_SQRT2*(*(tlinein++));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		*(lineout + line_size + n) = total*oosob;
-	}
-}
-
-// Nota Bene: assumes that coefficients beyond 128 are 0!
-
-void idct_line_large(F32 *linein, F32 *lineout, S32 line)
-{
-	S32 n;
-	F32 total;
-	F32 *pcp = gPatchICosines;
-
-	F32 oosob = 2.f/32.f;
-	S32	line_size = line*LARGE_PATCH_SIZE;
-	F32 *tlinein, *tpcp;
-	F32 *baselinein = linein + line_size;
-	F32 *baselineout = lineout + line_size;
-
-
-	for (n = 0; n < LARGE_PATCH_SIZE; n++)
-	{
-		tpcp = pcp++;
-		tlinein = baselinein;
-	
-		total = OO_SQRT2*(*(tlinein++));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein)*(*(tpcp));
-
-		*baselineout++ = total*oosob;
-	}
-}
-
-inline void idct_column(F32 *linein, F32 *lineout, S32 column)
-{
-	S32 n;
-	F32 total;
-	F32 *pcp = gPatchICosines;
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-	F32 *tlinein, *tpcp;
-
-	for (n = 0; n < NORMAL_PATCH_SIZE; n++)
-	{
-		tpcp = pcp + n;
-		tlinein = linein + column;
-
-		total = OO_SQRT2*(*tlinein);
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-		total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-		*(lineout + (n<<4) + column) = total;
-	}
-
-#else
-	S32	size = gGOPP->patch_size;
-	S32 u;
-	S32 u_size;
-
-	for (n = 0; n < size; n++)
-	{
-		total = OO_SQRT2*linein[column];
-		for (u = 1; u < size; u++)
+		const F32 *linein = temp + line*size;
+		for (n = 0; n < size; n += 4)
 		{
-			u_size = u*size;
-			total += linein[u_size + column]*pcp[u_size+n];
+			LLQuad total = _mm_mul_ps(oo_sqrt2, _mm_set1_ps(linein[0]));
+			for (u = 1; u < size; u++)
+			{
+				total = _mm_add_ps(total, _mm_mul_ps(_mm_set1_ps(linein[u]), _mm_loadu_ps(icosines + u*size + n)));
+			}
+			_mm_storeu_ps(block + line*size + n, _mm_mul_ps(total, oosob));
 		}
-		lineout[size*n + column] = total;
 	}
-#endif
 }
 
-inline void idct_column_large_slow(F32 *linein, F32 *lineout, S32 column)
+// Dequantizes and transforms cpatch into block; returns the scale and
+// offset that turn the block into heights.
+static S32 decode_patch_block(F32 *block, const S32 *cpatch, const LLPatchHeader *ph, S32 size, F32 &mult, F32 &addval)
 {
-	S32 n;
-	F32 total;
-	F32 *pcp = gPatchICosines;
-
-	F32 *tlinein, *tpcp;
-
-	for (n = 0; n < LARGE_PATCH_SIZE; n++)
-	{
-		tpcp = pcp + n;
-		tlinein = linein + column;
+	const LLPatchDecompressTables &tables = get_patch_tables(size);
+	llassert(tables.mBuilt);
+	size = get_patch_table_size(size);
 
-		total = OO_SQRT2*(*tlinein);
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-		total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		*(lineout + (n<<5) + column) = total;
-	}
-}
-
-// Nota Bene: assumes that coefficients beyond 128 are 0!
-
-void idct_column_large(F32 *linein, F32 *lineout, S32 column)
-{
-	S32 n, m;
-	F32 total;
-	F32 *pcp = gPatchICosines;
-
-	F32 *tlinein, *tpcp;
-	F32 *baselinein = linein + column;
-	F32 *baselineout = lineout + column;
-
-	for (n = 0; n < LARGE_PATCH_SIZE; n++)
-	{
-		tpcp = pcp++;
-		tlinein = baselinein;
-
-		total = OO_SQRT2*(*tlinein);
-		for (m = 1; m < NORMAL_PATCH_SIZE; m++)
-			total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-		*(baselineout + (n<<5)) = total;
-	}
-}
-
-inline void idct_patch(F32 *block)
-{
-	F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-	idct_column(block, temp, 0);	
-	idct_column(block, temp, 1);	
-	idct_column(block, temp, 2);	
-	idct_column(block, temp, 3);	
-
-	idct_column(block, temp, 4);	
-	idct_column(block, temp, 5);	
-	idct_column(block, temp, 6);	
-	idct_column(block, temp, 7);	
-
-	idct_column(block, temp, 8);	
-	idct_column(block, temp, 9);	
-	idct_column(block, temp, 10);	
-	idct_column(block, temp, 11);	
-
-	idct_column(block, temp, 12);	
-	idct_column(block, temp, 13);	
-	idct_column(block, temp, 14);	
-	idct_column(block, temp, 15);	
-
-	idct_line(temp, block, 0);	
-	idct_line(temp, block, 1);	
-	idct_line(temp, block, 2);	
-	idct_line(temp, block, 3);	
-
-	idct_line(temp, block, 4);	
-	idct_line(temp, block, 5);	
-	idct_line(temp, block, 6);	
-	idct_line(temp, block, 7);	
-
-	idct_line(temp, block, 8);	
-	idct_line(temp, block, 9);	
-	idct_line(temp, block, 10);	
-	idct_line(temp, block, 11);	
-
-	idct_line(temp, block, 12);	
-	idct_line(temp, block, 13);	
-	idct_line(temp, block, 14);	
-	idct_line(temp, block, 15);	
-#else
-	S32 i;
-	S32	size = gGOPP->patch_size;
-	for (i = 0; i < size; i++)
-	{
-		idct_column(block, temp, i);	
-	}
-	for (i = 0; i < size; i++)
-	{
-		idct_line(temp, block, i);	
-	}
-#endif
-}
-
-inline void idct_patch_large(F32 *block)
-{
-	F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-	idct_column_large_slow(block, temp, 0);	
-	idct_column_large_slow(block, temp, 1);	
-	idct_column_large_slow(block, temp, 2);	
-	idct_column_large_slow(block, temp, 3);	
-
-	idct_column_large_slow(block, temp, 4);	
-	idct_column_large_slow(block, temp, 5);	
-	idct_column_large_slow(block, temp, 6);	
-	idct_column_large_slow(block, temp, 7);	
-
-	idct_column_large_slow(block, temp, 8);	
-	idct_column_large_slow(block, temp, 9);	
-	idct_column_large_slow(block, temp, 10);	
-	idct_column_large_slow(block, temp, 11);	
-
-	idct_column_large_slow(block, temp, 12);	
-	idct_column_large_slow(block, temp, 13);	
-	idct_column_large_slow(block, temp, 14);	
-	idct_column_large_slow(block, temp, 15);	
-
-	idct_column_large_slow(block, temp, 16);	
-	idct_column_large_slow(block, temp, 17);	
-	idct_column_large_slow(block, temp, 18);	
-	idct_column_large_slow(block, temp, 19);	
-
-	idct_column_large_slow(block, temp, 20);	
-	idct_column_large_slow(block, temp, 21);	
-	idct_column_large_slow(block, temp, 22);	
-	idct_column_large_slow(block, temp, 23);	
-
-	idct_column_large_slow(block, temp, 24);	
-	idct_column_large_slow(block, temp, 25);	
-	idct_column_large_slow(block, temp, 26);	
-	idct_column_large_slow(block, temp, 27);	
-
-	idct_column_large_slow(block, temp, 28);	
-	idct_column_large_slow(block, temp, 29);	
-	idct_column_large_slow(block, temp, 30);	
-	idct_column_large_slow(block, temp, 31);	
-
-	idct_line_large_slow(temp, block, 0);	
-	idct_line_large_slow(temp, block, 1);	
-	idct_line_large_slow(temp, block, 2);	
-	idct_line_large_slow(temp, block, 3);	
-
-	idct_line_large_slow(temp, block, 4);	
-	idct_line_large_slow(temp, block, 5);	
-	idct_line_large_slow(temp, block, 6);	
-	idct_line_large_slow(temp, block, 7);	
-
-	idct_line_large_slow(temp, block, 8);	
-	idct_line_large_slow(temp, block, 9);	
-	idct_line_large_slow(temp, block, 10);	
-	idct_line_large_slow(temp, block, 11);	
-
-	idct_line_large_slow(temp, block, 12);	
-	idct_line_large_slow(temp, block, 13);	
-	idct_line_large_slow(temp, block, 14);	
-	idct_line_large_slow(temp, block, 15);	
-
-	idct_line_large_slow(temp, block, 16);	
-	idct_line_large_slow(temp, block, 17);	
-	idct_line_large_slow(temp, block, 18);	
-	idct_line_large_slow(temp, block, 19);	
-
-	idct_line_large_slow(temp, block, 20);	
-	idct_line_large_slow(temp, block, 21);	
-	idct_line_large_slow(temp, block, 22);	
-	idct_line_large_slow(temp, block, 23);	
-
-	idct_line_large_slow(temp, block, 24);	
-	idct_line_large_slow(temp, block, 25);	
-	idct_line_large_slow(temp, block, 26);	
-	idct_line_large_slow(temp, block, 27);	
-
-	idct_line_large_slow(temp, block, 28);	
-	idct_line_large_slow(temp, block, 29);	
-	idct_line_large_slow(temp, block, 30);	
-	idct_line_large_slow(temp, block, 31);	
-}
-
-S32	gDitherNoise = 128;
-
-void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph)
-{
-	S32		i, j;
-
-	F32		block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], *tblock = block;
-	F32		*tpatch;
-
-	LLGroupHeader	*gopp = gGOPP;
-	S32		size = gopp->patch_size;
-	F32		range = ph->range;
 	S32		prequant = (ph->quant_wbits >> 4) + 2;
 	S32		quantize = 1<<prequant;
-	F32		hmin = ph->dc_offset;
-	S32		stride = gopp->stride;
-
 	F32		ooq = 1.f/(F32)quantize;
-	F32     *dq = gPatchDequantizeTable;
-	S32		*decopy_matrix = gDeCopyMatrix;
 
-	F32		mult = ooq*range;
-	F32		addval = mult*(F32)(1<<(prequant - 1))+hmin;
+	mult = ooq*ph->range;
+	addval = mult*(F32)(1<<(prequant - 1))+ph->dc_offset;
 
-	for (i = 0; i < size*size; i++)
+	for (S32 i = 0; i < size*size; i++)
 	{
-		*(tblock++) = *(cpatch + *(decopy_matrix++))*(*dq++);
+		block[i] = cpatch[tables.mDeCopy[i]]*tables.mDequantize[i];
 	}
 
-	if (size == 16)
-	{
-		idct_patch(block);
-	}
-	else
-	{
-		idct_patch_large(block);
-	}
+	idct_patch(block, tables.mICosines, size);
+	return size;
+}
 
-	for (j = 0; j < size; j++)
+void decompress_patch(F32 *patch, const S32 *cpatch, const LLPatchHeader *ph, S32 size, S32 stride)
+{
+	F32		block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+	F32		mult, addval;
+	size = decode_patch_block(block, cpatch, ph, size, mult, addval);
+
+	const LLQuad mult4 = _mm_set1_ps(mult);
+	const LLQuad addval4 = _mm_set1_ps(addval);
+	for (S32 j = 0; j < size; j++)
 	{
-		tpatch = patch + j*stride;
-		tblock = block + j*size;
-		for (i = 0; i < size; i++)
+		F32 *tpatch = patch + j*stride;
+		const F32 *tblock = block + j*size;
+		for (S32 i = 0; i < size; i += 4)
 		{
-			*(tpatch++) = *(tblock++)*mult+addval;
+			_mm_storeu_ps(tpatch + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(tblock + i), mult4), addval4));
 		}
 	}
 }
 
+void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph)
+{
+	decompress_patch(patch, cpatch, ph, gGOPP->patch_size, gGOPP->stride);
+}
 
 void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph)
 {
-	S32		i, j;
-
-	F32			block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], *tblock = block;
-	LLVector3	*tvec;
-
-	LLGroupHeader	*gopp = gGOPP;
-	S32		size = gopp->patch_size;
-	F32		range = ph->range;
-	S32		prequant = (ph->quant_wbits >> 4) + 2;
-	S32		quantize = 1<<prequant;
-	F32		hmin = ph->dc_offset;
-	S32		stride = gopp->stride;
-
-	F32		ooq = 1.f/(F32)quantize;
-	F32     *dq = gPatchDequantizeTable;
-	S32		*decopy_matrix = gDeCopyMatrix;
-
-	F32		mult = ooq*range;
-	F32		addval = mult*(F32)(1<<(prequant - 1))+hmin;
-
-//	BOOL	b_diag = FALSE;
-//	BOOL	b_right = TRUE;
-
-	for (i = 0; i < size*size; i++)
-	{
-		*(tblock++) = *(cpatch + *(decopy_matrix++))*(*dq++);
-	}
-
-	if (size == 16)
-		idct_patch(block);
-	else
-		idct_patch_large(block);
+	F32		block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+	F32		mult, addval;
+	S32		size = decode_patch_block(block, cpatch, ph, gGOPP->patch_size, mult, addval);
+	S32		stride = gGOPP->stride;
 
-	for (j = 0; j < size; j++)
+	for (S32 j = 0; j < size; j++)
 	{
-		tvec = v + j*stride;
-		tblock = block + j*size;
-		for (i = 0; i < size; i++)
+		LLVector3 *tvec = v + j*stride;
+		const F32 *tblock = block + j*size;
+		for (S32 i = 0; i < size; i++)
 		{
 			(*tvec++).mV[VZ] = *(tblock++)*mult+addval;
 		}
 	}
 }
-
@@ -0,0 +1,237 @@
+/**
+ * @file llnamestore_test.cpp
+ * @brief Tests for LLNameStore.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "../llnamestore.h"
+
+#include <boost/bind.hpp>
+
+#include "llfile.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct llnamestore_data
+	{
+		llnamestore_data()
+		:	mFilename(std::string(LLFile::tmpdir()) + "llnamestore_test.db"),
+			mID1("8a2cf2f7-a4a5-4b63-8eba-0fa2bee0c3c9"),
+			mID2("3941037e-78ab-45f0-b421-bd6e77c1804d")
+		{
+			LLFile::remove_nowarn(mFilename);
+		}
+
+		~llnamestore_data()
+		{
+			LLFile::remove_nowarn(mFilename);
+		}
+
+		static LLNameRecord makeRecord(const std::string& name, U32 time)
+		{
+			LLNameRecord record;
+			record.addU32(time);
+			record.addString(name);
+			return record;
+		}
+
+		static std::string readName(const LLNameStore& store, LLNameStore::EType type, const LLUUID& id)
+		{
+			std::string name;
+			store.forEach(type, boost::bind(&llnamestore_data::collect, _1, _2, id, boost::ref(name)));
+			return name;
+		}
+
+		static void collect(const LLUUID& id, LLNameRecord& record, const LLUUID& wanted, std::string& name)
+		{
+			U32 time;
+			if (id == wanted && record.getU32(time))
+			{
+				record.getString(name);
+			}
+		}
+
+		S32 fileSize() const
+		{
+			LLFILE* file = LLFile::fopen(mFilename, "rb");
+			if (!file)
+			{
+				return 0;
+			}
+			fseek(file, 0, SEEK_END);
+			S32 size = (S32)ftell(file);
+			LLFile::close(file);
+			return size;
+		}
+
+		std::string mFilename;
+		LLUUID mID1;
+		LLUUID mID2;
+	};
+	typedef test_group<llnamestore_data> llnamestore_test;
+	typedef llnamestore_test::object llnamestore_object;
+	tut::llnamestore_test llnamestore_testcase("LLNameStore");
+
+	template<> template<>
+	void llnamestore_object::test<1>()
+	{
+		// fields read back in order, and reads past the end fail
+		LLNameRecord written;
+		written.addU32(42);
+		written.addF64(1.5);
+		written.addString("James Linden");
+
+		LLNameRecord record(written.getData());
+		U32 value;
+		F64 time;
+		std::string name;
+		ensure("U32", record.getU32(value) && value == 42);
+		ensure("F64", record.getF64(time) && time == 1.5);
+		ensure("string", record.getString(name) && name == "James Linden");
+		ensure("past the end", !record.getU32(value) && value == 42);
+	}
+
+	template<> template<>
+	void llnamestore_object::test<2>()
+	{
+		// records survive a reopen; the last one of a type and UUID wins
+		{
+			LLNameStore store;
+			ensure("no store yet", !store.open(mFilename));
+			store.put(LLNameStore::AGENT_NAME, mID1, makeRecord("Old Name", 1));
+			store.put(LLNameStore::GROUP_NAME, mID1, makeRecord("Group", 1));
+			store.flush();
+			store.put(LLNameStore::AGENT_NAME, mID1, makeRecord("New Name", 2));
+			store.put(LLNameStore::AGENT_NAME, mID2, makeRecord("Other", 2));
+			store.close();
+		}
+
+		LLNameStore store;
+		ensure("store loaded", store.open(mFilename));
+		ensure_equals("records", store.size(), 3U);
+		ensure_equals("replaced", readName(store, LLNameStore::AGENT_NAME, mID1), "New Name");
+		ensure_equals("other type", readName(store, LLNameStore::GROUP_NAME, mID1), "Group");
+		ensure_equals("other id", readName(store, LLNameStore::AGENT_NAME, mID2), "Other");
+	}
+
+	template<> template<>
+	void llnamestore_object::test<3>()
+	{
+		// erased records stay erased
+		{
+			LLNameStore store;
+			store.open(mFilename);
+			store.put(LLNameStore::AGENT_NAME, mID1, makeRecord("Name", 1));
+			store.put(LLNameStore::AGENT_NAME, mID2, makeRecord("Other", 1));
+			store.flush();
+			store.erase(LLNameStore::AGENT_NAME, mID1);
+			store.close();
+		}
+
+		LLNameStore store;
+		store.open(mFilename);
+		ensure("erased", !store.has(LLNameStore::AGENT_NAME, mID1));
+		ensure("kept", store.has(LLNameStore::AGENT_NAME, mID2));
+	}
+
+	template<> template<>
+	void llnamestore_object::test<4>()
+	{
+		// a partial record at the end is dropped, and the file stays usable
+		{
+			LLNameStore store;
+			store.open(mFilename);
+			store.put(LLNameStore::AGENT_NAME, mID1, makeRecord("Name", 1));
+			store.close();
+		}
+		LLFILE* file = LLFile::fopen(mFilename, "ab");
+		ensure("opened", file != NULL);
+		const char partial[] = { 40, 0, 0, 0, 1, 2, 3 };
+		fwrite(partial, 1, sizeof(partial), file);
+		LLFile::close(file);
+
+		{
+			LLNameStore store;
+			ensure("store loaded", store.open(mFilename));
+			ensure_equals("records", store.size(), 1U);
+			store.put(LLNameStore::AGENT_NAME, mID2, makeRecord("Other", 1));
+			store.close();
+		}
+
+		LLNameStore store;
+		store.open(mFilename);
+		ensure_equals("records after repair", store.size(), 2U);
+		ensure_equals("appended", readName(store, LLNameStore::AGENT_NAME, mID2), "Other");
+	}
+
+	template<> template<>
+	void llnamestore_object::test<5>()
+	{
+		// a file that is not a store starts an empty one
+		LLFILE* file = LLFile::fopen(mFilename, "wb");
+		ensure("opened", file != NULL);
+		fputs("<llsd><map /></llsd>", file);
+		LLFile::close(file);
+
+		LLNameStore store;
+		ensure("not loaded", !store.open(mFilename));
+		ensure_equals("empty", store.size(), 0U);
+		store.put(LLNameStore::AGENT_NAME, mID1, makeRecord("Name", 1));
+		store.close();
+		ensure("reopened", store.open(mFilename));
+		ensure_equals("records", store.size(), 1U);
+	}
+
+	template<> template<>
+	void llnamestore_object::test<6>()
+	{
+		// a file of mostly replaced records is rewritten with the live ones
+		{
+			LLNameStore store;
+			store.open(mFilename);
+			for (U32 i = 0; i < 2000; ++i)
+			{
+				store.put(LLNameStore::AGENT_NAME, mID1, makeRecord("Name", i));
+				store.flush();
+			}
+			store.close();
+		}
+		const S32 full_size = fileSize();
+
+		{
+			LLNameStore store;
+			store.open(mFilename);
+			ensure_equals("records", store.size(), 1U);
+		}
+		ensure("compacted", fileSize() * 100 < full_size);
+
+		LLNameStore store;
+		store.open(mFilename);
+		ensure_equals("last record kept", readName(store, LLNameStore::AGENT_NAME, mID1), "Name");
+	}
+}
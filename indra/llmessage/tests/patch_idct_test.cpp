@@ -0,0 +1,193 @@
+/** 
+ * @file patch_idct_test.cpp
+ * @brief Compares the patch IDCT with the scalar code it replaced.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2010, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <cstring>
+
+#include "llmath.h"
+#include "llrand.h"
+#include "v3math.h"
+
+#include "../patch_dct.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// The scalar decoder that patch_idct.cpp had before it used SSE: the
+	// same tables, and every sum in the same order.
+	struct ReferenceDecoder
+	{
+		S32 mSize;
+		F32 mDequantize[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+		F32 mICosines[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+		S32 mDeCopy[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+
+		ReferenceDecoder(S32 size) : mSize(size)
+		{
+			const F32 oosob = F_PI*0.5f/size;
+			for (S32 j = 0; j < size; j++)
+			{
+				for (S32 i = 0; i < size; i++)
+				{
+					mDequantize[j*size + i] = (1.f + 2.f*(i+j));
+					mICosines[j*size + i] = cosf((2.f*i+1.f)*j*oosob);
+				}
+			}
+			// Zig-zag order: odd diagonals run down the columns, even ones up.
+			S32 count = 0;
+			for (S32 diagonal = 0; diagonal < 2*size - 1; diagonal++)
+			{
+				for (S32 k = 0; k <= diagonal; k++)
+				{
+					const S32 i = (diagonal & 1) ? diagonal - k : k;
+					const S32 j = diagonal - i;
+					if (i < size && j < size)
+					{
+						mDeCopy[j*size + i] = count++;
+					}
+				}
+			}
+		}
+
+		void decompress(F32 *patch, const S32 *cpatch, const LLPatchHeader *ph, S32 stride) const
+		{
+			F32 block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+			F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+			const S32 size = mSize;
+			S32 prequant = (ph->quant_wbits >> 4) + 2;
+			S32 quantize = 1<<prequant;
+			F32 ooq = 1.f/(F32)quantize;
+			F32 mult = ooq*ph->range;
+			F32 addval = mult*(F32)(1<<(prequant - 1))+ph->dc_offset;
+
+			for (S32 i = 0; i < size*size; i++)
+			{
+				block[i] = cpatch[mDeCopy[i]]*mDequantize[i];
+			}
+			for (S32 column = 0; column < size; column++)
+			{
+				for (S32 n = 0; n < size; n++)
+				{
+					F32 total = OO_SQRT2*block[column];
+					for (S32 u = 1; u < size; u++)
+					{
+						total += block[u*size + column]*mICosines[u*size + n];
+					}
+					temp[n*size + column] = total;
+				}
+			}
+			const F32 oosob = 2.f/size;
+			for (S32 line = 0; line < size; line++)
+			{
+				for (S32 n = 0; n < size; n++)
+				{
+					F32 total = OO_SQRT2*temp[line*size];
+					for (S32 u = 1; u < size; u++)
+					{
+						total += temp[line*size + u]*mICosines[u*size + n];
+					}
+					block[line*size + n] = total*oosob;
+				}
+			}
+			for (S32 j = 0; j < size; j++)
+			{
+				for (S32 i = 0; i < size; i++)
+				{
+					patch[j*stride + i] = block[j*size + i]*mult+addval;
+				}
+			}
+		}
+	};
+
+	// Like the coefficients of a real patch: the low frequencies are set and
+	// large, the high ones mostly zero.
+	void random_patch(LLRandMT19937& random, S32 size, S32 *cpatch, LLPatchHeader& ph)
+	{
+		for (S32 i = 0; i < size*size; i++)
+		{
+			cpatch[i] = (i < 64 || random() % 16 == 0) ? (S32)(random() % 2001) - 1000 : 0;
+		}
+		ph.dc_offset = (F32)(random() % 100000) * 0.001f - 20.f;
+		ph.range = (U16)(1 + random() % 512);
+		ph.quant_wbits = (U8)(((random() % 8) << 4) | 5);
+		ph.patchids = 0;
+	}
+}
+
+namespace tut
+{
+	struct patch_idct_test
+	{
+	};
+	typedef test_group<patch_idct_test> patch_idct_test_t;
+	typedef patch_idct_test_t::object patch_idct_test_object_t;
+	tut::patch_idct_test_t tut_patch_idct_test("patch_idct");
+
+	template<> template<>
+	void patch_idct_test_object_t::test<1>()
+	{
+		// Both patch sizes decode bit for bit as before, through both entry points.
+		const S32 STRIDE = 260;
+		static F32 expected[STRIDE*LARGE_PATCH_SIZE];
+		static F32 actual[STRIDE*LARGE_PATCH_SIZE];
+		S32 cpatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+		LLPatchHeader ph;
+		// Fixed seed, so failures reproduce.
+		LLRandMT19937 random(4357);
+
+		for (S32 size = NORMAL_PATCH_SIZE; size <= LARGE_PATCH_SIZE; size += NORMAL_PATCH_SIZE)
+		{
+			init_patch_decompressor(size);
+			const ReferenceDecoder reference(size);
+			LLGroupHeader group;
+			group.patch_size = (U8)size;
+			group.stride = STRIDE;
+			group.layer_type = 0;
+			set_group_of_patch_header(&group);
+
+			for (S32 t = 0; t < 500; t++)
+			{
+				random_patch(random, size, cpatch, ph);
+				reference.decompress(expected, cpatch, &ph, STRIDE);
+
+				decompress_patch(actual, cpatch, &ph, size, STRIDE);
+				for (S32 j = 0; j < size; j++)
+				{
+					ensure("decompress_patch", !memcmp(expected + j*STRIDE, actual + j*STRIDE, size*sizeof(F32)));
+				}
+
+				memset(actual, 0, sizeof(actual));
+				decompress_patch(actual, cpatch, &ph);
+				for (S32 j = 0; j < size; j++)
+				{
+					ensure("decompress_patch with the group header", !memcmp(expected + j*STRIDE, actual + j*STRIDE, size*sizeof(F32)));
+				}
+			}
+		}
+	}
+}
@@ -35,6 +35,9 @@
 #include "llgl.h"
 #include "llfontbitmapcache.h"
 
+#include <istream>
+#include <ostream>
+
 LLFontBitmapCache::LLFontBitmapCache():
 	mNumComponents(0),
 	mBitmapWidth(0),
@@ -87,22 +90,9 @@ BOOL LLFontBitmapCache::nextOpenPos(S32 width, S32 &pos_x, S32 &pos_y, S32& bitm
 		{
 			// We're out of space in the current image, or no image
 			// has been allocated yet.  Make a new one.
-			mImageRawVec.push_back(new LLImageRaw);
-			mBitmapNum = mImageRawVec.size()-1;
-			LLImageRaw *image_raw = getImageRaw(mBitmapNum);
-
-			// Make corresponding GL image.
-			mImageGLVec.push_back(new LLImageGL(FALSE));
-			LLImageGL *image_gl = getImageGL(mBitmapNum);
-			
-			S32 image_width = mMaxCharWidth * 20;
-			S32 pow_iw = 2;
-			while (pow_iw < image_width)
-			{
-				pow_iw *= 2;
-			}
-			image_width = pow_iw;
-			image_width = llmin(512, image_width); // Don't make bigger than 512x512, ever.
+			LLPointer<LLImageRaw> image_raw = new LLImageRaw;
+
+			S32 image_width = getBitmapSize();
 			S32 image_height = image_width;
 
 			image_raw->resize(image_width, image_height, mNumComponents);
@@ -124,10 +114,7 @@ BOOL LLFontBitmapCache::nextOpenPos(S32 width, S32 &pos_x, S32 &pos_y, S32& bitm
 			mCurrentOffsetX = 1;
 			mCurrentOffsetY = 1;
 
-			// Attach corresponding GL texture.
-			image_gl->createGLTexture(0, image_raw);
-			gGL.getTexUnit(0)->bind(image_gl);
-			image_gl->setFilteringOption(LLTexUnit::TFO_POINT); // was setMipFilterNearest(TRUE, TRUE);
+			addBitmap(image_raw);
 		}
 		else
 		{
@@ -146,6 +133,93 @@ BOOL LLFontBitmapCache::nextOpenPos(S32 width, S32 &pos_x, S32 &pos_y, S32& bitm
 	return TRUE;
 }
 
+S32 LLFontBitmapCache::getBitmapSize() const
+{
+	S32 image_width = mMaxCharWidth * 20;
+	S32 pow_iw = 2;
+	while (pow_iw < image_width)
+	{
+		pow_iw *= 2;
+	}
+	return llmin(512, pow_iw); // Don't make bigger than 512x512, ever.
+}
+
+void LLFontBitmapCache::addBitmap(LLImageRaw* image_raw)
+{
+	mImageRawVec.push_back(image_raw);
+	mBitmapNum = mImageRawVec.size()-1;
+
+	// Make corresponding GL image.
+	LLImageGL *image_gl = new LLImageGL(FALSE);
+	mImageGLVec.push_back(image_gl);
+
+	// Attach corresponding GL texture.
+	image_gl->createGLTexture(0, image_raw);
+	gGL.getTexUnit(0)->bind(image_gl);
+	image_gl->setFilteringOption(LLTexUnit::TFO_POINT); // was setMipFilterNearest(TRUE, TRUE);
+}
+
+bool LLFontBitmapCache::write(std::ostream& out) const
+{
+	const S32 header[] = { getNumBitmaps(), mBitmapWidth, mBitmapHeight, mNumComponents, mCurrentOffsetX, mCurrentOffsetY };
+	out.write((const char*)header, sizeof(header));
+	for (S32 i = 0; i < getNumBitmaps(); ++i)
+	{
+		// Only the rows that nextOpenPos() may have handed out of the last bitmap
+		S32 rows = i < mBitmapNum ? mBitmapHeight : llmin(mBitmapHeight, mCurrentOffsetY + 2 * mMaxCharHeight + 2);
+		out.write((const char*)mImageRawVec[i]->getData(), rows * mBitmapWidth * mNumComponents);
+	}
+	return out.good();
+}
+
+bool LLFontBitmapCache::read(std::istream& in)
+{
+	S32 header[6];
+	if (!in.read((char*)header, sizeof(header)))
+	{
+		return false;
+	}
+	const S32 count = header[0];
+	const S32 size = getBitmapSize();
+	if (count < 1 || count > 256 || header[1] != size || header[2] != size || header[3] != mNumComponents
+		|| header[4] < 1 || header[4] > size || header[5] < 1 || header[5] > size)
+	{
+		return false;
+	}
+
+	// Read everything before replacing the current bitmaps.
+	std::vector<LLPointer<LLImageRaw> > images;
+	for (S32 i = 0; i < count; ++i)
+	{
+		LLPointer<LLImageRaw> image_raw = new LLImageRaw(size, size, mNumComponents);
+		S32 rows = i < count - 1 ? size : llmin(size, header[5] + 2 * mMaxCharHeight + 2);
+		if (mNumComponents == 2)
+		{
+			image_raw->clear(255, 0);
+		}
+		else
+		{
+			image_raw->clear();
+		}
+		if (!in.read((char*)image_raw->getData(), rows * size * mNumComponents))
+		{
+			return false;
+		}
+		images.push_back(image_raw);
+	}
+
+	reset();
+	mBitmapWidth = size;
+	mBitmapHeight = size;
+	for (S32 i = 0; i < count; ++i)
+	{
+		addBitmap(images[i]);
+	}
+	mCurrentOffsetX = header[4];
+	mCurrentOffsetY = header[5];
+	return true;
+}
+
 void LLFontBitmapCache::destroyGL()
 {
 	for (std::vector<LLPointer<LLImageGL> >::iterator it = mImageGLVec.begin();
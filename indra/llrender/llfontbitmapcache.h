@@ -33,6 +33,7 @@
 #ifndef LL_LLFONTBITMAPCACHE_H
 #define LL_LLFONTBITMAPCACHE_H
 
+#include <iosfwd>
 #include <vector>
 
 // Maintain a collection of bitmaps containing rendered glyphs.
@@ -53,6 +54,12 @@ public:
 	BOOL nextOpenPos(S32 width, S32 &posX, S32 &posY, S32 &bitmapNum);
 	
 	void destroyGL();
+
+	// The bitmaps and the packing position, for LLFontFreetype's glyph atlas
+	// cache. read() keeps the current bitmaps and returns false when the data
+	// was not written by a cache with the same layout.
+	bool write(std::ostream& out) const;
+	bool read(std::istream& in);
 	
  	LLImageRaw *getImageRaw(U32 bitmapNum = 0) const;
  	LLImageGL *getImageGL(U32 bitmapNum = 0) const;
@@ -61,8 +68,12 @@ public:
 	S32 getNumComponents() const { return mNumComponents; }
 	S32 getBitmapWidth() const { return mBitmapWidth; }
 	S32 getBitmapHeight() const { return mBitmapHeight; }
+	S32 getNumBitmaps() const { return mBitmapNum + 1; }
 
 private:
+	S32 getBitmapSize() const;
+	void addBitmap(LLImageRaw* image_raw);
+
 	S32 mNumComponents;
 	S32 mBitmapWidth;
 	S32 mBitmapHeight;
@@ -45,6 +45,10 @@
 //#include "imdebug.h"
 #include "llfontbitmapcache.h"
 #include "llgl.h"
+#include "lldir.h"
+#include "llfile.h"
+#include "llformat.h"
+#include "llmd5.h"
 
 FT_Render_Mode gFontRenderMode = FT_RENDER_MODE_NORMAL;
 
@@ -53,6 +57,52 @@ LLFontManager *gFontManagerp = NULL;
 FT_Library gFTLibrary = NULL;
 
 bool LLFontFreetype::sOpenGLcrashOnRestart = false;
+std::string LLFontFreetype::sCacheDir;
+
+namespace
+{
+	// Bump when the layout of the glyph atlas cache files changes.
+	const U32 ATLAS_CACHE_VERSION = 1;
+	const char ATLAS_CACHE_MAGIC[4] = { 'L', 'L', 'F', 'A' };
+
+	// A LLFontGlyphInfo as it is stored in the glyph atlas cache
+	struct CachedGlyph
+	{
+		U32 mChar;
+		U32 mGlyphIndex;
+		S32 mWidth;
+		S32 mHeight;
+		F32 mXAdvance;
+		F32 mYAdvance;
+		S32 mXBitmapOffset;
+		S32 mYBitmapOffset;
+		S32 mXBearing;
+		S32 mYBearing;
+		S32 mBitmapNum;
+	};
+
+	// Digest of the contents of a font file, computed once per file and session.
+	const std::string& get_file_digest(const std::string& filename)
+	{
+		static std::map<std::string, std::string> digests;
+		std::map<std::string, std::string>::iterator it = digests.find(filename);
+		if (it == digests.end())
+		{
+			std::string digest;
+			LLFILE* file = LLFile::fopen(filename, "rb");
+			if (file)
+			{
+				// Closes the file.
+				LLMD5 md5(file);
+				char hex[MD5HEX_STR_SIZE];
+				md5.hex_digest(hex);
+				digest = hex;
+			}
+			it = digests.insert(std::make_pair(filename, digest)).first;
+		}
+		return it->second;
+	}
+}
 
 //static
 void LLFontManager::initClass()
@@ -112,7 +162,11 @@ LLFontFreetype::LLFontFreetype()
 	mFTFace(NULL),
 	mRenderGlyphCount(0),
 	mAddGlyphCount(0),
-	mPointSize(0)
+	mPointSize(0),
+	mVertDPI(0.f),
+	mHorzDPI(0.f),
+	mGeneration(0),
+	mCachedGlyphCount(0)
 {
 }
 
@@ -203,6 +257,8 @@ BOOL LLFontFreetype::loadFace(const std::string& filename, const F32 point_size,
 
 	mName = filename;
 	mPointSize = point_size;
+	mVertDPI = vert_dpi;
+	mHorzDPI = horz_dpi;
 
 	return TRUE;
 }
@@ -483,6 +539,10 @@ void LLFontFreetype::renderGlyph(const U32 glyph_index) const
 
 void LLFontFreetype::reset(F32 vert_dpi, F32 horz_dpi)
 {
+	if (!mIsFallback)
+	{
+		saveCache();
+	}
 	resetBitmapCache(); 
 	loadFace(mName,mPointSize,vert_dpi,horz_dpi,mFontBitmapCachep->getNumComponents(),mIsFallback);
 	if (!mIsFallback)
@@ -502,6 +562,7 @@ void LLFontFreetype::reset(F32 vert_dpi, F32 horz_dpi)
 				(*it)->reset(vert_dpi, horz_dpi);
 			}
 		}
+		loadCache();
 	}
 }
 
@@ -509,6 +570,8 @@ void LLFontFreetype::resetBitmapCache()
 {
 	for_each(mCharGlyphInfoMap.begin(), mCharGlyphInfoMap.end(), DeletePairedPointer());
 	mCharGlyphInfoMap.clear();
+	++mGeneration;
+	mCachedGlyphCount = 0;
 	
 	mFontBitmapCachep->reset();
 
@@ -521,6 +584,145 @@ void LLFontFreetype::resetBitmapCache()
 	}
 }
 
+std::string LLFontFreetype::getCacheFileName() const
+{
+	// Everything the bitmaps and the glyph infos depend on
+	LLMD5 key;
+	key.update(llformat("%u %d.%d.%d %d %d %.3f %.3f ", ATLAS_CACHE_VERSION, FREETYPE_MAJOR, FREETYPE_MINOR, FREETYPE_PATCH,
+						(S32)gFontRenderMode, mFontBitmapCachep->getNumComponents(), mVertDPI, mHorzDPI));
+	key.update(llformat("%.3f ", mPointSize) + get_file_digest(mName));
+	for (font_vector_t::const_iterator it = mFallbackFonts.begin(); it != mFallbackFonts.end(); ++it)
+	{
+		key.update(llformat(" %.3f ", (*it)->mPointSize) + get_file_digest((*it)->mName));
+	}
+	key.finalize();
+
+	char hex[MD5HEX_STR_SIZE];
+	key.hex_digest(hex);
+	return sCacheDir + gDirUtilp->getDirDelimiter() + hex + ".atlas";
+}
+
+void LLFontFreetype::loadCache()
+{
+	mCacheFile.clear();
+	if (sCacheDir.empty() || mIsFallback || !mFTFace)
+	{
+		return;
+	}
+	mCacheFile = getCacheFileName();
+
+	llifstream file(mCacheFile.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	char magic[sizeof(ATLAS_CACHE_MAGIC)];
+	U32 version = 0;
+	U32 count = 0;
+	file.read(magic, sizeof(magic));
+	file.read((char*)&version, sizeof(version));
+	file.read((char*)&count, sizeof(count));
+	if (!file || memcmp(magic, ATLAS_CACHE_MAGIC, sizeof(magic)) || version != ATLAS_CACHE_VERSION || !count || count > 0x10000)
+	{
+		LL_WARNS() << "Ignoring invalid glyph atlas cache " << mCacheFile << LL_ENDL;
+		return;
+	}
+	std::vector<CachedGlyph> glyphs(count);
+	if (!file.read((char*)&glyphs[0], count * sizeof(CachedGlyph)) || !mFontBitmapCachep->read(file))
+	{
+		LL_WARNS() << "Ignoring invalid glyph atlas cache " << mCacheFile << LL_ENDL;
+		return;
+	}
+
+	// The bitmaps are replaced now; so are the glyphs that point into them.
+	for_each(mCharGlyphInfoMap.begin(), mCharGlyphInfoMap.end(), DeletePairedPointer());
+	mCharGlyphInfoMap.clear();
+	++mGeneration;
+
+	const S32 num_bitmaps = mFontBitmapCachep->getNumBitmaps();
+	for (U32 i = 0; i < count; ++i)
+	{
+		const CachedGlyph& cached = glyphs[i];
+		if (cached.mBitmapNum < 0 || cached.mBitmapNum >= num_bitmaps)
+		{
+			LL_WARNS() << "Ignoring invalid glyph atlas cache " << mCacheFile << LL_ENDL;
+			resetBitmapCache();
+			return;
+		}
+		LLFontGlyphInfo* gi = new LLFontGlyphInfo(cached.mGlyphIndex);
+		gi->mWidth = cached.mWidth;
+		gi->mHeight = cached.mHeight;
+		gi->mXAdvance = cached.mXAdvance;
+		gi->mYAdvance = cached.mYAdvance;
+		gi->mXBitmapOffset = cached.mXBitmapOffset;
+		gi->mYBitmapOffset = cached.mYBitmapOffset;
+		gi->mXBearing = cached.mXBearing;
+		gi->mYBearing = cached.mYBearing;
+		gi->mBitmapNum = cached.mBitmapNum;
+		insertGlyphInfo(cached.mChar, gi);
+	}
+	mCachedGlyphCount = mCharGlyphInfoMap.size();
+
+	LL_INFOS() << "Loaded " << mCachedGlyphCount << " glyphs of " << mName << " from the glyph atlas cache" << LL_ENDL;
+}
+
+void LLFontFreetype::saveCache() const
+{
+	// Nothing to add to the cache unless glyphs were rendered since it was read.
+	if (mCacheFile.empty() || mCharGlyphInfoMap.size() == mCachedGlyphCount)
+	{
+		return;
+	}
+
+	std::vector<CachedGlyph> glyphs;
+	glyphs.reserve(mCharGlyphInfoMap.size());
+	for (char_glyph_info_map_t::const_iterator it = mCharGlyphInfoMap.begin(); it != mCharGlyphInfoMap.end(); ++it)
+	{
+		const LLFontGlyphInfo* gi = it->second;
+		CachedGlyph cached;
+		cached.mChar = it->first;
+		cached.mGlyphIndex = gi->mGlyphIndex;
+		cached.mWidth = gi->mWidth;
+		cached.mHeight = gi->mHeight;
+		cached.mXAdvance = gi->mXAdvance;
+		cached.mYAdvance = gi->mYAdvance;
+		cached.mXBitmapOffset = gi->mXBitmapOffset;
+		cached.mYBitmapOffset = gi->mYBitmapOffset;
+		cached.mXBearing = gi->mXBearing;
+		cached.mYBearing = gi->mYBearing;
+		cached.mBitmapNum = gi->mBitmapNum;
+		glyphs.push_back(cached);
+	}
+
+	// Write a temporary file and move it in place, so that a crash never leaves half a cache.
+	const std::string tmp_file = mCacheFile + ".tmp";
+	bool success;
+	{
+		llofstream file(tmp_file.c_str(), std::ios::out | std::ios::binary);
+		if (!file.is_open())
+		{
+			LL_WARNS() << "Could not open " << tmp_file << " to write the glyph atlas cache" << LL_ENDL;
+			return;
+		}
+		const U32 version = ATLAS_CACHE_VERSION;
+		const U32 count = glyphs.size();
+		file.write(ATLAS_CACHE_MAGIC, sizeof(ATLAS_CACHE_MAGIC));
+		file.write((const char*)&version, sizeof(version));
+		file.write((const char*)&count, sizeof(count));
+		file.write((const char*)&glyphs[0], count * sizeof(CachedGlyph));
+		success = mFontBitmapCachep->write(file);
+	}
+	LLFile::remove_nowarn(mCacheFile);
+	if (!success || LLFile::rename(tmp_file, mCacheFile))
+	{
+		LL_WARNS() << "Could not write the glyph atlas cache " << mCacheFile << LL_ENDL;
+		LLFile::remove(tmp_file);
+		return;
+	}
+	mCachedGlyphCount = glyphs.size();
+}
+
 void LLFontFreetype::destroyGL()
 {
 	mFontBitmapCachep->destroyGL();
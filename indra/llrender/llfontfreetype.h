@@ -141,9 +141,24 @@ public:
 
 	const LLPointer<LLFontBitmapCache> getFontBitmapCache() const;
 
+	// Changes whenever the glyph infos are deleted, which makes pointers
+	// returned by getGlyphInfo() dangle.
+	U32 getGeneration() const { return mGeneration; }
+
+	// The glyph atlas cache: the bitmaps and the glyph infos of a head font,
+	// kept in sCacheDir between sessions so that the glyphs already rendered
+	// by the last session aren't rasterized again. The file name is a digest
+	// of the font files, the point sizes and the DPI, so that a change of any
+	// of them starts a new cache. Call loadCache() once the fallback fonts
+	// are set.
+	void loadCache();
+	void saveCache() const;
+
 	static bool sOpenGLcrashOnRestart;
+	static std::string sCacheDir;	// Empty disables the glyph atlas cache
 
 private:
+	std::string getCacheFileName() const;
 	void resetBitmapCache();
 	void setSubImageLuminanceAlpha(const U32 x, const U32 y, const U32 bitmap_num, const U32 width, const U32 height, const U8 *data, S32 stride = 0) const;
 	BOOL hasGlyph(llwchar wch) const;		// Has a glyph for this character
@@ -155,6 +170,8 @@ private:
 	std::string mName;
 
 	F32 mPointSize;
+	F32 mVertDPI;
+	F32 mHorzDPI;
 	F32 mAscender;			
 	F32 mDescender;
 	F32 mLineHeight;
@@ -173,6 +190,10 @@ private:
 
 	mutable S32 mRenderGlyphCount;
 	mutable S32 mAddGlyphCount;
+
+	U32 mGeneration;
+	mutable std::string mCacheFile;
+	mutable U32 mCachedGlyphCount;	// Glyphs in mCacheFile
 };
 
 #endif // LL_FONTFREETYPE_H
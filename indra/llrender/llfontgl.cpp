@@ -69,6 +69,48 @@ const F32 PIXEL_CORRECTION_DISTANCE = 0.01f;
 const F32 PAD_UVY = 0.5f; // half of vertical padding between glyphs in the glyph texture
 const F32 DROP_SHADOW_SOFT_STRENGTH = 0.3f;
 
+// Strings longer than this are rendered without a glyph run: they are
+// usually clipped by max_pixels, and hashing all of them would cost more
+// than the lookups it saves.
+const S32 MAX_GLYPH_RUN_LENGTH = 256;
+// Glyph runs kept per font, counting the ones used before the cache last
+// filled up, which are dropped next time unless they are used again.
+const U32 MAX_GLYPH_RUNS = 1024;
+
+// Quads per gGL.begin()/end(). LLRender holds 4096 vertices and flushes past 2048.
+const S32 GLYPH_BATCH_SIZE = 256;
+// A glyph with a soft drop shadow takes 6 quads.
+const S32 MAX_QUADS_PER_GLYPH = 6;
+
+namespace
+{
+	// A glyph laid out by LLFontGL::render(), waiting for its bitmap to be bound
+	struct QueuedGlyph
+	{
+		LLRectf mScreenRect;
+		LLRectf mUVRect;
+		S32 mBitmapNum;		// -1 once drawn
+	};
+	std::vector<QueuedGlyph> sQueuedGlyphs;
+
+	LL_ALIGN_16(LLVector4a sGlyphVertices[GLYPH_BATCH_SIZE * 4]);
+	LLVector2 sGlyphUVs[GLYPH_BATCH_SIZE * 4];
+	LLColor4U sGlyphColors[GLYPH_BATCH_SIZE * 4];
+
+	void draw_glyph_quads(S32& quad_count)
+	{
+		if (quad_count > 0)
+		{
+			gGL.begin(LLRender::QUADS);
+			{
+				gGL.vertexBatchPreTransformed(sGlyphVertices, sGlyphUVs, sGlyphColors, quad_count * 4);
+			}
+			gGL.end();
+			quad_count = 0;
+		}
+	}
+}
+
 F32 llfont_round_x(F32 x)
 {
 	//return llfloor((x-LLFontGL::sCurOrigin.mX)/LLFontGL::sScaleX+0.5f)*LLFontGL::sScaleX+LLFontGL::sCurOrigin.mX;
@@ -84,6 +126,7 @@ F32 llfont_round_y(F32 y)
 }
 
 LLFontGL::LLFontGL()
+:	mGlyphRunGeneration(0)
 {
 	clearEmbeddedChars();
 }
@@ -264,17 +307,17 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 		}
 	}
 
+	GlyphRun* run = getGlyphRun(wstr, begin_offset, length);
+	const llwchar* run_chars = wstr.c_str() + begin_offset;
 	const LLFontGlyphInfo* next_glyph = NULL;
 
-	const S32 GLYPH_BATCH_SIZE = 30;
-	static LL_ALIGN_16(LLVector4a vertices[GLYPH_BATCH_SIZE * 4]);
-	static LLVector2 uvs[GLYPH_BATCH_SIZE * 4];
-	static LLColor4U colors[GLYPH_BATCH_SIZE * 4];
+	// The glyphs are queued while the string is laid out, and drawn with one
+	// texture bind per bitmap at the end. render() may recurse for the labels
+	// of embedded characters, so only the glyphs from first_glyph on are ours.
+	const U32 first_glyph = sQueuedGlyphs.size();
 
 	LLColor4U text_color(color);
 
-	S32 bitmap_num = -1;
-	S32 glyph_count = 0;
 	for (i = begin_offset; i < begin_offset + length; i++)
 	{
 		llwchar wch = wstr[i];
@@ -303,6 +346,9 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 				break;
 			}
 
+			// Draw the glyphs before this character, which may overlap them.
+			drawGlyphs(first_glyph, text_color, style, shadow, drop_shadow_strength);
+
 			gGL.getTexUnit(0)->bind(ext_image);
 
 			// snap origin to whole screen pixel
@@ -312,22 +358,10 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 			LLRectf uv_rect(0.f, 1.f, 1.f, 0.f);
 			LLRectf screen_rect(ext_x, ext_y + ext_height, ext_x + ext_width, ext_y);
 
-			if (glyph_count > 0)
-			{
-				gGL.begin(LLRender::QUADS);
-				{
-					gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
-				}
-				gGL.end();
-				glyph_count = 0;
-			}
-			renderQuad(vertices, uvs, colors, screen_rect, uv_rect, LLColor4U::white, 0);
+			renderQuad(sGlyphVertices, sGlyphUVs, sGlyphColors, screen_rect, uv_rect, LLColor4U::white, 0);
 			//No batching here. It will never happen.
-			gGL.begin(LLRender::QUADS);
-			{
-				gGL.vertexBatchPreTransformed(vertices, uvs, colors, 4);
-			}
-			gGL.end();
+			S32 quad_count = 1;
+			draw_glyph_quads(quad_count);
 
 			if (!label.empty())
 			{
@@ -339,6 +373,8 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 									 halign, BASELINE, UNDERLINE, NO_SHADOW, S32_MAX, S32_MAX, NULL,
 									 TRUE );
 				gGL.popMatrix();
+				// The label font may be this one, and have dropped the run.
+				run = NULL;
 			}
 
 			chars_drawn++;
@@ -351,9 +387,15 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 		}
 		else
 		{
+			// Embedded characters drawn as glyphs aren't in the run.
+			const LLFontGlyphInfo* run_glyph = run ? getRunGlyph(*run, run_chars, i - begin_offset) : NULL;
 			const LLFontGlyphInfo* fgi = next_glyph;
 			next_glyph = NULL;
-			if(!fgi)
+			if (run_glyph)
+			{
+				fgi = run_glyph;
+			}
+			else if(!fgi)
 			{
 				fgi = mFontFreetype->getGlyphInfo(wch);
 			}
@@ -362,26 +404,6 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 				LL_ERRS() << "Missing Glyph Info" << LL_ENDL;
 				break;
 			}
-			// Per-glyph bitmap texture.
-			S32 next_bitmap_num = fgi->mBitmapNum;
-			if (next_bitmap_num != bitmap_num)
-			{
-				// Actually draw the queued glyphs before switching their texture;
-				// otherwise the queued glyphs will be taken from wrong textures.
-				if (glyph_count > 0)
-				{
-					gGL.begin(LLRender::QUADS);
-					{
-						gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
-					}
-					gGL.end();
-					glyph_count = 0;
-				}
-
-				bitmap_num = next_bitmap_num;
-				LLImageGL *font_image = font_bitmap_cache->getImageGL(bitmap_num);
-				gGL.getTexUnit(0)->bind(font_image);
-			}
 
 			if ((start_x + scaled_max_pixels) < (cur_x + fgi->mXBearing + fgi->mWidth))
 			{
@@ -391,39 +413,37 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 
 			// Draw the text at the appropriate location
 			//Specify vertices and texture coordinates
-			LLRectf uv_rect((fgi->mXBitmapOffset) * inv_width,
+			QueuedGlyph glyph;
+			glyph.mUVRect = LLRectf((fgi->mXBitmapOffset) * inv_width,
 					(fgi->mYBitmapOffset + fgi->mHeight + PAD_UVY) * inv_height,
 					(fgi->mXBitmapOffset + fgi->mWidth) * inv_width,
 				(fgi->mYBitmapOffset - PAD_UVY) * inv_height);
 			// snap glyph origin to whole screen pixel
-			LLRectf screen_rect((F32)ll_round(cur_render_x + (F32)fgi->mXBearing),
+			glyph.mScreenRect = LLRectf((F32)ll_round(cur_render_x + (F32)fgi->mXBearing),
 				    (F32)ll_round(cur_render_y + (F32)fgi->mYBearing),
 				    (F32)ll_round(cur_render_x + (F32)fgi->mXBearing) + (F32)fgi->mWidth,
 				    (F32)ll_round(cur_render_y + (F32)fgi->mYBearing) - (F32)fgi->mHeight);
-			
-			if (glyph_count >= GLYPH_BATCH_SIZE)
-			{
-				gGL.begin(LLRender::QUADS);
-				{
-					gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
-				}
-				gGL.end();
-
-				glyph_count = 0;
-			}
-
-			drawGlyph(glyph_count, vertices, uvs, colors, screen_rect, uv_rect, text_color, style, shadow, drop_shadow_strength);
+			// Per-glyph bitmap texture.
+			glyph.mBitmapNum = fgi->mBitmapNum;
+			sQueuedGlyphs.push_back(glyph);
 
 			chars_drawn++;
 			cur_x += fgi->mXAdvance;
 			cur_y += fgi->mYAdvance;
 
-			llwchar next_char = wstr[i+1];
-			if (next_char && (next_char < LAST_CHARACTER))
+			if (run_glyph)
 			{
-				// Kern this puppy.
-				next_glyph = mFontFreetype->getGlyphInfo(next_char);
-				cur_x += mFontFreetype->getXKerning(fgi, next_glyph);
+				cur_x += getRunKerning(*run, run_chars, i - begin_offset);
+			}
+			else
+			{
+				llwchar next_char = wstr[i+1];
+				if (next_char && (next_char < LAST_CHARACTER))
+				{
+					// Kern this puppy.
+					next_glyph = mFontFreetype->getGlyphInfo(next_char);
+					cur_x += mFontFreetype->getXKerning(fgi, next_glyph);
+				}
 			}
 
 			// Round after kerning.
@@ -438,15 +458,7 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 		}
 	}
 
-	if(glyph_count)
-	{
-		gGL.begin(LLRender::QUADS);
-		{
-			gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
-		}
-		gGL.end();
-	}
-
+	drawGlyphs(first_glyph, text_color, style, shadow, drop_shadow_strength);
 
 	if (right_x)
 	{
@@ -915,6 +927,8 @@ void LLFontGL::clearEmbeddedChars()
 {
 	for_each(mEmbeddedChars.begin(), mEmbeddedChars.end(), DeletePairedPointer());
 	mEmbeddedChars.clear();
+	// The glyph runs leave embedded characters out.
+	clearGlyphRuns();
 }
 
 void LLFontGL::addEmbeddedChar( llwchar wc, LLTexture* image, const std::string& label ) const
@@ -927,6 +941,7 @@ void LLFontGL::addEmbeddedChar( llwchar wc, LLTexture* image, const LLWString& w
 {
 	embedded_data_t* ext_data = new embedded_data_t(image->getGLTexture(), wlabel);
 	mEmbeddedChars[wc] = ext_data;
+	clearGlyphRuns();
 }
 
 void LLFontGL::removeEmbeddedChar( llwchar wc ) const
@@ -936,6 +951,7 @@ void LLFontGL::removeEmbeddedChar( llwchar wc ) const
 	{
 		delete iter->second;
 		mEmbeddedChars.erase(wc);
+		clearGlyphRuns();
 	}
 }
 
@@ -1302,6 +1318,124 @@ void LLFontGL::renderQuad(LLVector4a* vertex_out, LLVector2* uv_out, LLColor4U*
 	colors_out[index] = color;
 }
 
+LLFontGL::GlyphRun* LLFontGL::getGlyphRun(const LLWString& wstr, S32 begin_offset, S32 length) const
+{
+	if (length > MAX_GLYPH_RUN_LENGTH)
+	{
+		return NULL;
+	}
+
+	if (mGlyphRunGeneration != mFontFreetype->getGeneration())
+	{
+		clearGlyphRuns();
+		mGlyphRunGeneration = mFontFreetype->getGeneration();
+	}
+
+	// The characters and the one after them, if any
+	LLWString key(wstr, begin_offset, length + 1);
+	glyph_run_map_t::iterator it = mGlyphRuns.find(key);
+	if (it != mGlyphRuns.end())
+	{
+		return &it->second;
+	}
+
+	if (mGlyphRuns.size() >= MAX_GLYPH_RUNS / 2)
+	{
+		// Drop the runs that were not used since the last time
+		mOldGlyphRuns.swap(mGlyphRuns);
+		mGlyphRuns.clear();
+	}
+
+	GlyphRun& run = mGlyphRuns[key];
+	it = mOldGlyphRuns.find(key);
+	if (it != mOldGlyphRuns.end())
+	{
+		run.mGlyphs.swap(it->second.mGlyphs);
+		run.mGlyphCount = it->second.mGlyphCount;
+		run.mKerningCount = it->second.mKerningCount;
+		mOldGlyphRuns.erase(it);
+	}
+	else
+	{
+		run.mGlyphs.resize(key.length());
+	}
+	return &run;
+}
+
+const LLFontGlyphInfo* LLFontGL::getRunGlyph(GlyphRun& run, const llwchar* chars, U32 i) const
+{
+	while (run.mGlyphCount <= i)
+	{
+		const llwchar wch = chars[run.mGlyphCount];
+		run.mGlyphs[run.mGlyphCount++].mGlyph = getEmbeddedCharData(wch) ? NULL : mFontFreetype->getGlyphInfo(wch);
+	}
+	return run.mGlyphs[i].mGlyph;
+}
+
+F32 LLFontGL::getRunKerning(GlyphRun& run, const llwchar* chars, U32 i) const
+{
+	while (run.mKerningCount <= i)
+	{
+		const U32 k = run.mKerningCount++;
+		RunGlyph& glyph = run.mGlyphs[k];
+		glyph.mKerning = 0.f;
+		// Same as render() without a run: only Latin-1 characters are kerned.
+		if (getRunGlyph(run, chars, k) && k + 1 < run.mGlyphs.size() &&
+			chars[k + 1] && chars[k + 1] < LLFontFreetype::LAST_CHAR_FULL)
+		{
+			glyph.mKerning = mFontFreetype->getXKerning(glyph.mGlyph, getRunGlyph(run, chars, k + 1));
+		}
+	}
+	return run.mGlyphs[i].mKerning;
+}
+
+void LLFontGL::clearGlyphRuns() const
+{
+	mGlyphRuns.clear();
+	mOldGlyphRuns.clear();
+}
+
+void LLFontGL::drawGlyphs(U32 first_glyph, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_strength) const
+{
+	const LLFontBitmapCache* font_bitmap_cache = mFontFreetype->getFontBitmapCache();
+	const U32 count = sQueuedGlyphs.size();
+	S32 quad_count = 0;
+
+	// One pass per bitmap, in the order they are first used
+	U32 start = first_glyph;
+	while (start < count)
+	{
+		const S32 bitmap_num = sQueuedGlyphs[start].mBitmapNum;
+		gGL.getTexUnit(0)->bind(font_bitmap_cache->getImageGL(bitmap_num));
+
+		U32 next_start = count;
+		for (U32 i = start; i < count; ++i)
+		{
+			QueuedGlyph& glyph = sQueuedGlyphs[i];
+			if (glyph.mBitmapNum != bitmap_num)
+			{
+				if (glyph.mBitmapNum >= 0 && next_start == count)
+				{
+					next_start = i;
+				}
+				continue;
+			}
+
+			if (quad_count + MAX_QUADS_PER_GLYPH > GLYPH_BATCH_SIZE)
+			{
+				draw_glyph_quads(quad_count);
+			}
+			drawGlyph(quad_count, sGlyphVertices, sGlyphUVs, sGlyphColors, glyph.mScreenRect, glyph.mUVRect, color, style, shadow, drop_shadow_strength);
+			glyph.mBitmapNum = -1;
+		}
+		// Before the next bind, which would draw them with its texture
+		draw_glyph_quads(quad_count);
+		start = next_start;
+	}
+
+	sQueuedGlyphs.resize(first_glyph);
+}
+
 void LLFontGL::drawGlyph(S32& glyph_count, LLVector4a* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_strength) const
 {
 	F32 slant_offset;
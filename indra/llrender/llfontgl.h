@@ -28,6 +28,8 @@
 #ifndef LL_LLFONTGL_H
 #define LL_LLFONTGL_H
 
+#include <boost/unordered_map.hpp>
+
 #include "llcoord.h"
 #include "llfontregistry.h"
 #include "lltexture.h"
@@ -41,6 +43,7 @@ class LLColor4;
 // Key used to request a font.
 class LLFontDescriptor;
 class LLFontFreetype;
+struct LLFontGlyphInfo;
 
 // Structure used to store previously requested fonts.
 class LLFontRegistry;
@@ -229,7 +232,40 @@ protected:
 	LLFontDescriptor mFontDescriptor;
 	LLPointer<LLFontFreetype> mFontFreetype;
 
+	// The glyphs of recently rendered strings, so that render() doesn't look
+	// up every character and kerning pair again each frame. A run covers the
+	// rendered characters and the one after them, which the last one is kerned
+	// against. Its glyphs are looked up as render() gets to them, so that the
+	// characters past the max_pixels clip are not rasterized.
+	struct RunGlyph
+	{
+		const LLFontGlyphInfo* mGlyph;	// NULL for embedded characters
+		F32 mKerning;					// Against the next glyph
+	};
+	struct GlyphRun
+	{
+		GlyphRun() : mGlyphCount(0), mKerningCount(0) { }
+
+		std::vector<RunGlyph> mGlyphs;
+		U32 mGlyphCount;				// Leading glyphs looked up
+		U32 mKerningCount;				// Leading kernings looked up
+	};
+	typedef boost::unordered_map<LLWString, GlyphRun> glyph_run_map_t;
+	// The runs used since the cache last filled up, and the ones used before
+	// that, which are dropped when it fills up again unless used meanwhile.
+	mutable glyph_run_map_t mGlyphRuns;
+	mutable glyph_run_map_t mOldGlyphRuns;
+	mutable U32 mGlyphRunGeneration;	// LLFontFreetype::getGeneration() of the runs
+	// NULL when the string is too long to be worth caching.
+	GlyphRun* getGlyphRun(const LLWString& wstr, S32 begin_offset, S32 length) const;
+	// Glyph i of the run and its kerning; chars are the characters of the run.
+	const LLFontGlyphInfo* getRunGlyph(GlyphRun& run, const llwchar* chars, U32 i) const;
+	F32 getRunKerning(GlyphRun& run, const llwchar* chars, U32 i) const;
+	void clearGlyphRuns() const;
+
 	void renderQuad(LLVector4a* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, F32 slant_amt) const;
+	// Draws the glyphs that render() queued from first_glyph on, and removes them from the queue.
+	void drawGlyphs(U32 first_glyph, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_strength) const;
 	void drawGlyph(S32& glyph_count, LLVector4a* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_fade) const;
 
 	// Registry holds all instantiated fonts.
@@ -480,6 +480,12 @@ LLFontGL *LLFontRegistry::createFont(const LLFontDescriptor& desc)
 		result->mFontFreetype->setFallbackFonts(fontlist);
 	}
 
+	if (result)
+	{
+		// The cache is keyed on the fallback fonts too.
+		result->mFontFreetype->loadCache();
+	}
+
 	norm_desc.setStyle(match_desc->getStyle());
 
 	if (result)
@@ -513,6 +519,10 @@ void LLFontRegistry::clear()
 		 ++it)
 	{
 		LLFontGL *fontp = it->second;
+		if (fontp)
+		{
+			fontp->mFontFreetype->saveCache();
+		}
 		delete fontp;
 	}
 	mFontMap.clear();
@@ -195,6 +195,21 @@ PFNGLWAITSYNCPROC				glWaitSync = NULL;
 PFNGLGETINTEGER64VPROC			glGetInteger64v = NULL;
 PFNGLGETSYNCIVPROC				glGetSynciv = NULL;
 
+// GL_ARB_get_program_binary
+PFNGLGETPROGRAMBINARYPROC		glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARYPROC			glProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERIPROC		glProgramParameteri = NULL;
+
+// GL_ARB_uniform_buffer_object
+PFNGLGETUNIFORMBLOCKINDEXPROC	glGetUniformBlockIndex = NULL;
+PFNGLUNIFORMBLOCKBINDINGPROC	glUniformBlockBinding = NULL;
+PFNGLBINDBUFFERBASEPROC			glBindBufferBase = NULL;
+
+#ifdef GL_KHR_parallel_shader_compile
+// GL_KHR_parallel_shader_compile
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC	glMaxShaderCompilerThreadsKHR = NULL;
+#endif
+
 // GL_APPLE_flush_buffer_range
 PFNGLBUFFERPARAMETERIAPPLEPROC	glBufferParameteriAPPLE = NULL;
 PFNGLFLUSHMAPPEDBUFFERRANGEAPPLEPROC glFlushMappedBufferRangeAPPLE = NULL;
@@ -271,6 +286,9 @@ PFNGLGETDEBUGMESSAGELOGARBPROC glGetDebugMessageLogARB = NULL;
 // GL_EXT_blend_func_separate
 PFNGLBLENDFUNCSEPARATEEXTPROC glBlendFuncSeparateEXT = NULL;
 
+// GL_EXT_multi_draw_arrays
+PFNGLMULTIDRAWELEMENTSEXTPROC glMultiDrawElementsEXT = NULL;
+
 // GL_ARB_draw_buffers
 PFNGLDRAWBUFFERSARBPROC glDrawBuffersARB = NULL;
 
@@ -420,11 +438,16 @@ LLGLManager::LLGLManager() :
 	mMaxSamples(0),
 	mHasFramebufferMultisample(FALSE),
 	mHasBlendFuncSeparate(FALSE),
+	mHasMultiDrawArrays(FALSE),
 	mHasSync(FALSE),
+	mHasGetProgramBinary(FALSE),
+	mHasParallelShaderCompile(FALSE),
+	mHasUniformBufferObject(FALSE),
 	mHasVertexBufferObject(FALSE),
 	mHasVertexArrayObject(FALSE),
 	mHasMapBufferRange(FALSE),
 	mHasFlushBufferRange(FALSE),
+	mHasPixelBufferObject(FALSE),
 	mHasPBuffer(FALSE),
 	mHasShaderObjects(FALSE),
 	mHasVertexShader(FALSE),
@@ -939,6 +962,7 @@ void LLGLManager::initExtensions()
 	mHasSync = ExtensionExists("GL_ARB_sync", gGLHExts.mSysExts);
 	mHasMapBufferRange = ExtensionExists("GL_ARB_map_buffer_range", gGLHExts.mSysExts);
 	mHasFlushBufferRange = ExtensionExists("GL_APPLE_flush_buffer_range", gGLHExts.mSysExts);
+	mHasPixelBufferObject = ExtensionExists("GL_ARB_pixel_buffer_object", gGLHExts.mSysExts);
 	mHasDepthClamp = ExtensionExists("GL_ARB_depth_clamp", gGLHExts.mSysExts) || ExtensionExists("GL_NV_depth_clamp", gGLHExts.mSysExts);
 	// mask out FBO support when packed_depth_stencil isn't there 'cause we need it for LLRenderTarget -Brad
 #ifdef GL_ARB_framebuffer_object
@@ -955,11 +979,15 @@ void LLGLManager::initExtensions()
 
 	mHasDrawBuffers = ExtensionExists("GL_ARB_draw_buffers", gGLHExts.mSysExts);
 	mHasBlendFuncSeparate = ExtensionExists("GL_EXT_blend_func_separate", gGLHExts.mSysExts);
+	mHasMultiDrawArrays = mGLVersion >= 1.4f || ExtensionExists("GL_EXT_multi_draw_arrays", gGLHExts.mSysExts);
 	mHasTextureRectangle = ExtensionExists("GL_ARB_texture_rectangle", gGLHExts.mSysExts);
 	mHasDebugOutput = ExtensionExists("GL_ARB_debug_output", gGLHExts.mSysExts);
 	mHasTransformFeedback = mGLVersion >= 4.f || ExtensionExists("GL_EXT_transform_feedback", gGLHExts.mSysExts);
 #if !LL_DARWIN
 	mHasPointParameters = !mIsATI && ExtensionExists("GL_ARB_point_parameters", gGLHExts.mSysExts);
+	mHasGetProgramBinary = mGLVersion >= 4.1f || ExtensionExists("GL_ARB_get_program_binary", gGLHExts.mSysExts);
+	mHasParallelShaderCompile = ExtensionExists("GL_KHR_parallel_shader_compile", gGLHExts.mSysExts) || ExtensionExists("GL_ARB_parallel_shader_compile", gGLHExts.mSysExts);
+	mHasUniformBufferObject = mGLVersion >= 3.1f || ExtensionExists("GL_ARB_uniform_buffer_object", gGLHExts.mSysExts);
 #endif
 	mHasShaderObjects = ExtensionExists("GL_ARB_shader_objects", gGLHExts.mSysExts) && (LLRender::sGLCoreProfile || ExtensionExists("GL_ARB_shading_language_100", gGLHExts.mSysExts));
 	mHasVertexShader = ExtensionExists("GL_ARB_vertex_program", gGLHExts.mSysExts) && ExtensionExists("GL_ARB_vertex_shader", gGLHExts.mSysExts)
@@ -1109,6 +1137,10 @@ void LLGLManager::initExtensions()
 	{
 		LL_INFOS("RenderInit") << "Couldn't initialize GL_ARB_draw_buffers" << LL_ENDL;
 	}
+	if (!mHasMultiDrawArrays)
+	{
+		LL_INFOS("RenderInit") << "Couldn't initialize GL_EXT_multi_draw_arrays" << LL_ENDL;
+	}
 
 	// Disable certain things due to known bugs
 	if (mIsIntel && mHasMipMapGeneration)
@@ -1168,6 +1200,41 @@ void LLGLManager::initExtensions()
 		glGetInteger64v = (PFNGLGETINTEGER64VPROC) GLH_EXT_GET_PROC_ADDRESS("glGetInteger64v");
 		glGetSynciv = (PFNGLGETSYNCIVPROC) GLH_EXT_GET_PROC_ADDRESS("glGetSynciv");
 	}
+	if (mHasGetProgramBinary)
+	{
+		glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC) GLH_EXT_GET_PROC_ADDRESS("glGetProgramBinary");
+		glProgramBinary = (PFNGLPROGRAMBINARYPROC) GLH_EXT_GET_PROC_ADDRESS("glProgramBinary");
+		glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC) GLH_EXT_GET_PROC_ADDRESS("glProgramParameteri");
+		// Drivers may expose the extension without supporting a single format
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		mHasGetProgramBinary = glGetProgramBinary && glProgramBinary && glProgramParameteri && formats > 0;
+	}
+	if (mHasUniformBufferObject)
+	{
+		glGetUniformBlockIndex = (PFNGLGETUNIFORMBLOCKINDEXPROC) GLH_EXT_GET_PROC_ADDRESS("glGetUniformBlockIndex");
+		glUniformBlockBinding = (PFNGLUNIFORMBLOCKBINDINGPROC) GLH_EXT_GET_PROC_ADDRESS("glUniformBlockBinding");
+		glBindBufferBase = (PFNGLBINDBUFFERBASEPROC) GLH_EXT_GET_PROC_ADDRESS("glBindBufferBase");
+		mHasUniformBufferObject = glGetUniformBlockIndex && glUniformBlockBinding && glBindBufferBase;
+	}
+#ifdef GL_KHR_parallel_shader_compile
+	if (mHasParallelShaderCompile)
+	{
+		// The ARB entry point is the same function under another name
+		glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC) GLH_EXT_GET_PROC_ADDRESS("glMaxShaderCompilerThreadsKHR");
+		if (!glMaxShaderCompilerThreadsKHR)
+		{
+			glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC) GLH_EXT_GET_PROC_ADDRESS("glMaxShaderCompilerThreadsARB");
+		}
+		if (glMaxShaderCompilerThreadsKHR)
+		{
+			// Let the driver pick how many threads compile and link in the background
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		}
+	}
+#else
+	mHasParallelShaderCompile = FALSE;
+#endif
 	if (mHasMapBufferRange)
 	{
 		glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC) GLH_EXT_GET_PROC_ADDRESS("glMapBufferRange");
@@ -1205,6 +1272,16 @@ void LLGLManager::initExtensions()
 	{
 		glBlendFuncSeparateEXT = (PFNGLBLENDFUNCSEPARATEEXTPROC) GLH_EXT_GET_PROC_ADDRESS("glBlendFuncSeparateEXT");
 	}
+	if (mHasMultiDrawArrays)
+	{
+		// Core since GL 1.4, where drivers need not export the EXT name
+		glMultiDrawElementsEXT = (PFNGLMULTIDRAWELEMENTSEXTPROC) GLH_EXT_GET_PROC_ADDRESS("glMultiDrawElements");
+		if (!glMultiDrawElementsEXT)
+		{
+			glMultiDrawElementsEXT = (PFNGLMULTIDRAWELEMENTSEXTPROC) GLH_EXT_GET_PROC_ADDRESS("glMultiDrawElementsEXT");
+		}
+		mHasMultiDrawArrays = glMultiDrawElementsEXT != NULL;
+	}
 	if (mHasTransformFeedback)
 	{
 		glBeginTransformFeedback = (PFNGLBEGINTRANSFORMFEEDBACKPROC) GLH_EXT_GET_PROC_ADDRESS("glBeginTransformFeedback");
@@ -86,13 +86,18 @@ public:
 	S32 mMaxSamples;
 	BOOL mHasFramebufferMultisample;
 	BOOL mHasBlendFuncSeparate;
+	BOOL mHasMultiDrawArrays;
 	
 	// ARB Extensions
 	BOOL mHasVertexBufferObject;
 	BOOL mHasVertexArrayObject;
 	BOOL mHasSync;
+	BOOL mHasGetProgramBinary;
+	BOOL mHasParallelShaderCompile;
+	BOOL mHasUniformBufferObject;
 	BOOL mHasMapBufferRange;
 	BOOL mHasFlushBufferRange;
+	BOOL mHasPixelBufferObject;
 	BOOL mHasPBuffer;
 	BOOL mHasShaderObjects;
 	BOOL mHasVertexShader;
@@ -84,6 +84,21 @@ extern PFNGLWAITSYNCPROC				glWaitSync;
 extern PFNGLGETINTEGER64VPROC			glGetInteger64v;
 extern PFNGLGETSYNCIVPROC				glGetSynciv;
 
+// GL_ARB_get_program_binary
+extern PFNGLGETPROGRAMBINARYPROC		glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC			glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC		glProgramParameteri;
+
+// GL_ARB_uniform_buffer_object
+extern PFNGLGETUNIFORMBLOCKINDEXPROC	glGetUniformBlockIndex;
+extern PFNGLUNIFORMBLOCKBINDINGPROC		glUniformBlockBinding;
+extern PFNGLBINDBUFFERBASEPROC			glBindBufferBase;
+
+#ifdef GL_KHR_parallel_shader_compile
+// GL_KHR_parallel_shader_compile
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC	glMaxShaderCompilerThreadsKHR;
+#endif
+
 // GL_APPLE_flush_buffer_range
 extern PFNGLBUFFERPARAMETERIAPPLEPROC	glBufferParameteriAPPLE;
 extern PFNGLFLUSHMAPPEDBUFFERRANGEAPPLEPROC glFlushMappedBufferRangeAPPLE;
@@ -239,6 +254,9 @@ extern PFNGLCOLORTABLEEXTPROC glColorTableEXT;
 //GL_EXT_blend_func_separate
 extern PFNGLBLENDFUNCSEPARATEEXTPROC glBlendFuncSeparateEXT;
 
+//GL_EXT_multi_draw_arrays
+extern PFNGLMULTIDRAWELEMENTSEXTPROC glMultiDrawElementsEXT;
+
 //GL_EXT_framebuffer_object
 extern PFNGLISRENDERBUFFEREXTPROC glIsRenderbufferEXT;
 extern PFNGLBINDRENDERBUFFEREXTPROC glBindRenderbufferEXT;
@@ -346,6 +364,21 @@ extern PFNGLWAITSYNCPROC				glWaitSync;
 extern PFNGLGETINTEGER64VPROC			glGetInteger64v;
 extern PFNGLGETSYNCIVPROC				glGetSynciv;
 
+// GL_ARB_get_program_binary
+extern PFNGLGETPROGRAMBINARYPROC		glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC			glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC		glProgramParameteri;
+
+// GL_ARB_uniform_buffer_object
+extern PFNGLGETUNIFORMBLOCKINDEXPROC	glGetUniformBlockIndex;
+extern PFNGLUNIFORMBLOCKBINDINGPROC		glUniformBlockBinding;
+extern PFNGLBINDBUFFERBASEPROC			glBindBufferBase;
+
+#ifdef GL_KHR_parallel_shader_compile
+// GL_KHR_parallel_shader_compile
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC	glMaxShaderCompilerThreadsKHR;
+#endif
+
 // GL_APPLE_flush_buffer_range
 extern PFNGLBUFFERPARAMETERIAPPLEPROC	glBufferParameteriAPPLE;
 extern PFNGLFLUSHMAPPEDBUFFERRANGEAPPLEPROC glFlushMappedBufferRangeAPPLE;
@@ -499,6 +532,9 @@ extern PFNGLGETCOMPRESSEDTEXIMAGEARBPROC glGetCompressedTexImageARB;
 //GL_EXT_blend_func_separate
 extern PFNGLBLENDFUNCSEPARATEEXTPROC glBlendFuncSeparateEXT;
 
+//GL_EXT_multi_draw_arrays
+extern PFNGLMULTIDRAWELEMENTSEXTPROC glMultiDrawElementsEXT;
+
 //GL_ARB_framebuffer_object
 extern PFNGLISRENDERBUFFERPROC glIsRenderbuffer;
 extern PFNGLBINDRENDERBUFFERPROC glBindRenderbuffer;
@@ -585,6 +621,21 @@ extern PFNGLWAITSYNCPROC				glWaitSync;
 extern PFNGLGETINTEGER64VPROC			glGetInteger64v;
 extern PFNGLGETSYNCIVPROC				glGetSynciv;
 
+// GL_ARB_get_program_binary
+extern PFNGLGETPROGRAMBINARYPROC		glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC			glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC		glProgramParameteri;
+
+// GL_ARB_uniform_buffer_object
+extern PFNGLGETUNIFORMBLOCKINDEXPROC	glGetUniformBlockIndex;
+extern PFNGLUNIFORMBLOCKBINDINGPROC		glUniformBlockBinding;
+extern PFNGLBINDBUFFERBASEPROC			glBindBufferBase;
+
+#ifdef GL_KHR_parallel_shader_compile
+// GL_KHR_parallel_shader_compile
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC	glMaxShaderCompilerThreadsKHR;
+#endif
+
 // GL_APPLE_flush_buffer_range
 extern PFNGLBUFFERPARAMETERIAPPLEPROC	glBufferParameteriAPPLE;
 extern PFNGLFLUSHMAPPEDBUFFERRANGEAPPLEPROC glFlushMappedBufferRangeAPPLE;
@@ -737,6 +788,9 @@ extern PFNGLGETATTRIBLOCATIONARBPROC glGetAttribLocationARB;
 //GL_EXT_blend_func_separate
 extern PFNGLBLENDFUNCSEPARATEEXTPROC glBlendFuncSeparateEXT;
 
+//GL_EXT_multi_draw_arrays
+extern PFNGLMULTIDRAWELEMENTSEXTPROC glMultiDrawElementsEXT;
+
 //GL_ARB_framebuffer_object
 extern PFNGLISRENDERBUFFERPROC glIsRenderbuffer;
 extern PFNGLBINDRENDERBUFFERPROC glBindRenderbuffer;
@@ -798,6 +852,9 @@ extern PFNGLGETDEBUGMESSAGELOGARBPROC glGetDebugMessageLogARB;
 //GL_EXT_blend_func_separate
 extern void glBlendFuncSeparateEXT(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) ;
 
+//GL_EXT_multi_draw_arrays
+extern void glMultiDrawElementsEXT(GLenum mode, const GLsizei* count, GLenum type, const GLvoid** indices, GLsizei primcount);
+
 // GL_EXT_framebuffer_object
 extern GLboolean glIsRenderbufferEXT(GLuint renderbuffer) AVAILABLE_MAC_OS_X_VERSION_10_4_AND_LATER;
 extern void glBindRenderbufferEXT(GLenum target, GLuint renderbuffer) AVAILABLE_MAC_OS_X_VERSION_10_4_AND_LATER;
@@ -32,6 +32,7 @@
 #include "llfile.h"
 #include "llrender.h"
 #include "llcontrol.h"
+#include "lluniformbuffer.h"
 #include "llvertexbuffer.h"
 
 #if LL_DARWIN
@@ -48,6 +49,12 @@ GLhandleARB LLGLSLShader::sCurBoundShader = 0;
 LLGLSLShader* LLGLSLShader::sCurBoundShaderPtr = NULL;
 S32 LLGLSLShader::sIndexedTextureChannels = 0;
 bool LLGLSLShader::sNoFixedFunction = false;
+U32 LLGLSLShader::sBindCount = 0;
+U32 LLGLSLShader::sUniformUpdateCount = 0;
+U32 LLGLSLShader::sRedundantUniformCount = 0;
+
+// Locations past this are not shadowed; drivers hand out small ones in practice
+static const S32 MAX_SHADOWED_UNIFORM_LOCATION = 4096;
 
 //UI shader -- declared here so llui_libtest will link properly
 //Singu note: Not using llui_libtest... and LLViewerShaderMgr is a part of newview. So, 
@@ -92,7 +99,12 @@ LLGLSLShader::LLGLSLShader(S32 shader_class)
 	  mActiveTextureChannels(0),
 	  mShaderLevel(0),
 	  mShaderGroup(SG_DEFAULT),
-	  mUniformsDirty(FALSE)
+	  mUniformsDirty(FALSE),
+	  mPending(false),
+	  mSubmitted(FALSE),
+	  mCached(FALSE),
+	  mHasPendingAttributes(false),
+	  mHasPendingUniforms(false)
 {
 	LLShaderMgr::getGlobalShaderList().push_back(this);
 }
@@ -107,6 +119,8 @@ void LLGLSLShader::unload()
 	mAttribute.clear();
 	mTexture.clear();
 	mUniform.clear();
+	mShadow.clear();
+	mShadowData.clear();
 	mShaderFiles.clear();
 	mDefines.clear();
 
@@ -137,6 +151,35 @@ BOOL LLGLSLShader::createShader(std::vector<LLStaticHashedString> * attributes,
 								std::vector<LLStaticHashedString> * uniforms,
 								U32 varying_count,
 								const char** varyings)
+{
+	// Kept for finishShader(), which may run after the caller's vectors are gone
+	mHasPendingAttributes = attributes != NULL;
+	mPendingAttributes = attributes ? *attributes : std::vector<LLStaticHashedString>();
+	mHasPendingUniforms = uniforms != NULL;
+	mPendingUniforms = uniforms ? *uniforms : std::vector<LLStaticHashedString>();
+
+	LLShaderMgr* shader_mgr = LLShaderMgr::instance();
+	// Varyings are not kept, so transform feedback programs are never batched
+	llassert(!varying_count || !shader_mgr->isBatching());
+	return buildShader(varying_count, varyings, !shader_mgr->isBatching() || varying_count > 0);
+}
+
+BOOL LLGLSLShader::buildShader(U32 varying_count, const char** varyings, bool wait)
+{
+	if (!submitShader(varying_count, varyings))
+	{
+		return FALSE;
+	}
+	if (!wait)
+	{
+		mPending = true;
+		LLShaderMgr::instance()->addPendingShader(this);
+		return TRUE;
+	}
+	return finishShader();
+}
+
+BOOL LLGLSLShader::submitShader(U32 varying_count, const char** varyings)
 {
 	//reloading, reset matrix hash values
 	for (U32 i = 0; i < LLRender::NUM_MATRIX_MODES; ++i)
@@ -146,7 +189,8 @@ BOOL LLGLSLShader::createShader(std::vector<LLStaticHashedString> * attributes,
 	mLightHash = 0xFFFFFFFF;
 
 	llassert_always(!mShaderFiles.empty());
-	BOOL success = TRUE;
+	mSubmitted = TRUE;
+	mSubmittedFeatures = mFeatures;
 
 	if(mProgramObject)	//purge the old program
 		glDeleteObjectARB(mProgramObject);
@@ -157,30 +201,55 @@ BOOL LLGLSLShader::createShader(std::vector<LLStaticHashedString> * attributes,
     // work-around missing mix(vec3,vec3,bvec3)
     mDefines["OLD_SELECT"] = "1";
 #endif
-	
-	//compile new source
-	vector< pair<string,GLenum> >::iterator fileIter = mShaderFiles.begin();
-	for ( ; fileIter != mShaderFiles.end(); fileIter++ )
+
+	LLShaderMgr* shader_mgr = LLShaderMgr::instance();
+	++shader_mgr->mProgramCount;
+	mCacheKey.clear();
+	mCached = FALSE;
+	if (shader_mgr->useProgramCache())
 	{
-		GLhandleARB shaderhandle = LLShaderMgr::instance()->loadShaderFile((*fileIter).first, mShaderLevel, (*fileIter).second, &mDefines, mFeatures.mIndexedTextureChannels);
-		LL_DEBUGS("ShaderLoading") << "SHADER FILE: " << (*fileIter).first << " mShaderLevel=" << mShaderLevel << LL_ENDL;
-		if (shaderhandle > 0)
+		// The key needs the shared objects, so attach those first. attachShaderFeatures
+		// may change the number of texture channels, which the own files are built with.
+		const S32 texture_index_channels = mFeatures.mIndexedTextureChannels;
+		if (shader_mgr->attachShaderFeatures(this))
 		{
-			attachObject(shaderhandle);
+			mCacheKey = shader_mgr->getProgramCacheKey(this, texture_index_channels, varying_count, varyings);
 		}
-		else
-		{
-			success = FALSE;
+		mCached = !mCacheKey.empty() && shader_mgr->loadCachedProgram(mCacheKey, mProgramObject, mShaderLevel);
+		if (!mCached)
+		{ //build it from scratch the usual way
+			mFeatures.mIndexedTextureChannels = texture_index_channels;
+			glDeleteObjectARB(mProgramObject);
+			mProgramObject = glCreateProgramObjectARB();
 		}
 	}
 
-	// Attach existing objects
-	if (!LLShaderMgr::instance()->attachShaderFeatures(this))
+	if (!mCached)
 	{
-		if(mProgramObject)
-			glDeleteObjectARB(mProgramObject);
-		mProgramObject = 0;
-		return FALSE;
+		//compile new source
+		vector< pair<string,GLenum> >::iterator fileIter = mShaderFiles.begin();
+		for ( ; fileIter != mShaderFiles.end(); fileIter++ )
+		{
+			GLhandleARB shaderhandle = LLShaderMgr::instance()->loadShaderFile((*fileIter).first, mShaderLevel, (*fileIter).second, &mDefines, mFeatures.mIndexedTextureChannels);
+			LL_DEBUGS("ShaderLoading") << "SHADER FILE: " << (*fileIter).first << " mShaderLevel=" << mShaderLevel << LL_ENDL;
+			if (shaderhandle > 0)
+			{
+				attachObject(shaderhandle);
+			}
+			else
+			{
+				mSubmitted = FALSE;
+			}
+		}
+
+		// Attach existing objects
+		if (!LLShaderMgr::instance()->attachShaderFeatures(this))
+		{
+			if(mProgramObject)
+				glDeleteObjectARB(mProgramObject);
+			mProgramObject = 0;
+			return FALSE;
+		}
 	}
 
 	static const LLCachedControl<bool> no_texture_indexing("ShyotlUseLegacyTextureBatching",false);
@@ -189,17 +258,53 @@ BOOL LLGLSLShader::createShader(std::vector<LLStaticHashedString> * attributes,
 		mFeatures.mIndexedTextureChannels = llmin(mFeatures.mIndexedTextureChannels, 1);
 	}
 
+	if (mSubmitted && !mCached)
+	{
 #ifdef GL_INTERLEAVED_ATTRIBS
-	if (varying_count > 0 && varyings)
+		if (varying_count > 0 && varyings)
+		{
+			glTransformFeedbackVaryings(mProgramObject, varying_count, varyings, GL_INTERLEAVED_ATTRIBS);
+		}
+#endif
+
+		if (!mCacheKey.empty())
+		{
+			shader_mgr->prepareCachedProgram(mProgramObject);
+		}
+
+		// Start the link; finishShader() asks how it went
+		bindReservedAttributes();
+		glLinkProgramARB(mProgramObject);
+	}
+	return TRUE;
+}
+
+BOOL LLGLSLShader::finishShader()
+{
+	LLShaderMgr* shader_mgr = LLShaderMgr::instance();
+	const bool was_pending = mPending;
+	mPending = false;
+	// Anything rebuilt from here on waits for its own results
+	const bool finishing = shader_mgr->mFinishing;
+	shader_mgr->mFinishing = true;
+
+	BOOL success = mSubmitted;
+	if (success && !mCached)
 	{
-		glTransformFeedbackVaryings(mProgramObject, varying_count, varyings, GL_INTERLEAVED_ATTRIBS);
+		success = shader_mgr->checkProgramLinked(mProgramObject);
 	}
-#endif
+
+	const std::vector<LLStaticHashedString>* attributes = mHasPendingAttributes ? &mPendingAttributes : NULL;
+	const std::vector<LLStaticHashedString>* uniforms = mHasPendingUniforms ? &mPendingUniforms : NULL;
 
 	// Map attributes and uniforms
 	if (success)
 	{
-		success = mapAttributes(attributes);
+		success = mapAttributes(attributes, FALSE);
+	}
+	if (success && !mCacheKey.empty() && !mCached)
+	{
+		shader_mgr->saveCachedProgram(mCacheKey, mProgramObject, mShaderLevel);
 	}
 	if (success)
 	{
@@ -211,14 +316,25 @@ BOOL LLGLSLShader::createShader(std::vector<LLStaticHashedString> * attributes,
 			glDeleteObjectARB(mProgramObject);
 		mProgramObject = 0;
 
-		LL_WARNS("ShaderLoading") << "Failed to link shader: " << mName << LL_ENDL;
-
-		// Try again using a lower shader level;
-		if (mShaderLevel > 0)
+		if (was_pending)
+		{ //a shader object may have failed to compile, and nothing has tried the lower classes yet.
+			// Build from the features it was submitted with; callers may have changed them since.
+			LLShaderFeatures features = mFeatures;
+			mFeatures = mSubmittedFeatures;
+			success = buildShader(0, NULL, true);
+			mFeatures = features;
+		}
+		else
 		{
-			LL_WARNS("ShaderLoading") << "Failed to link using shader level " << mShaderLevel << " trying again using shader level " << (mShaderLevel - 1) << LL_ENDL;
-			mShaderLevel--;
-			return createShader(attributes,uniforms);
+			LL_WARNS("ShaderLoading") << "Failed to link shader: " << mName << LL_ENDL;
+
+			// Try again using a lower shader level;
+			if (mShaderLevel > 0)
+			{
+				LL_WARNS("ShaderLoading") << "Failed to link using shader level " << mShaderLevel << " trying again using shader level " << (mShaderLevel - 1) << LL_ENDL;
+				mShaderLevel--;
+				success = buildShader(0, NULL, true);
+			}
 		}
 	}
 	else if (mFeatures.mIndexedTextureChannels > 0)
@@ -245,6 +361,7 @@ BOOL LLGLSLShader::createShader(std::vector<LLStaticHashedString> * attributes,
 		unbind();
 	}
 
+	shader_mgr->mFinishing = finishing;
 	return success;
 }
 
@@ -302,7 +419,7 @@ void LLGLSLShader::attachObjects(GLhandleARB* objects, S32 count)
 	}
 }
 
-BOOL LLGLSLShader::mapAttributes(const std::vector<LLStaticHashedString> * attributes)
+void LLGLSLShader::bindReservedAttributes()
 {
 	//before linking, make sure reserved attributes always have consistent locations
 	for (U32 i = 0; i < LLShaderMgr::instance()->mReservedAttribs.size(); i++)
@@ -310,9 +427,18 @@ BOOL LLGLSLShader::mapAttributes(const std::vector<LLStaticHashedString> * attri
 		const char* name = LLShaderMgr::instance()->mReservedAttribs[i].c_str();
 		glBindAttribLocationARB(mProgramObject, i, (const GLcharARB *) name);
 	}
-	
-	//link the program
-	BOOL res = link();
+}
+
+BOOL LLGLSLShader::mapAttributes(const std::vector<LLStaticHashedString> * attributes, BOOL link_program)
+{
+	BOOL res = TRUE;
+	if (link_program)
+	{
+		bindReservedAttributes();
+
+		//link the program
+		res = link();
+	}
 
 	mAttribute.clear();
 	U32 numAttributes = (attributes == NULL) ? 0 : attributes->size();
@@ -411,11 +537,29 @@ void LLGLSLShader::mapUniform(GLint index, const vector<LLStaticHashedString> *
 		}
 		mTotalUniformSize += size;
 	}
+	const S32 shadow_words = size;
+#else
+	// No type table here, leave room for a mat4 per element
+	const S32 shadow_words = size * 16;
 #endif
 
 	S32 location = glGetUniformLocationARB(mProgramObject, name);
 	if (location != -1)
 	{
+		if (location < MAX_SHADOWED_UNIFORM_LOCATION && shadow_words > 0)
+		{
+			if (location >= (S32)mShadow.size())
+			{
+				UniformShadow untracked = { 0, 0, 0 };
+				mShadow.resize(location + 1, untracked);
+			}
+			UniformShadow& shadow = mShadow[location];
+			shadow.mOffset = (U32)mShadowData.size();
+			shadow.mWords = shadow_words;
+			shadow.mValidWords = 0;
+			mShadowData.resize(mShadowData.size() + shadow_words);
+		}
+
 		//chop off "[0]" so we can always access the first element
 		//of an array by the array name
 		char* is_array = strstr(name, "[0]");
@@ -474,7 +618,11 @@ GLint LLGLSLShader::mapUniformTextureChannel(GLint location, GLenum type)
 	if (type >= GL_SAMPLER_1D_ARB && type <= GL_SAMPLER_2D_RECT_SHADOW_ARB /*||
 		type == GL_SAMPLER_2D_MULTISAMPLE*/)
 	{	//this here is a texture
-		glUniform1iARB(location, mActiveTextureChannels);
+		GLint channel = mActiveTextureChannels;
+		if (updateShadow(location, &channel, 1))
+		{
+			glUniform1iARB(location, channel);
+		}
 		LL_DEBUGS("ShaderLoading") << "Assigned to texture channel " << mActiveTextureChannels << LL_ENDL;
 		return mActiveTextureChannels++;
 	}
@@ -490,9 +638,8 @@ BOOL LLGLSLShader::mapUniforms(const vector<LLStaticHashedString> * uniforms)
 	mUniform.clear();
 	mUniformMap.clear();
 	mTexture.clear();
-	mValueVec4.clear();
-	mValueMat3.clear();
-	mValueMat4.clear();
+	mShadow.clear();
+	mShadowData.clear();
 	//initialize arrays
 	U32 numUniforms = (uniforms == NULL) ? 0 : uniforms->size();
 	mUniform.resize(numUniforms + LLShaderMgr::instance()->mReservedUniforms.size(), -1);
@@ -509,6 +656,13 @@ BOOL LLGLSLShader::mapUniforms(const vector<LLStaticHashedString> * uniforms)
 		mapUniform(i, uniforms);
 	}
 
+	// Shared blocks are read from their buffers' binding points
+	std::vector<LLUniformBuffer*>& buffers = LLShaderMgr::instance()->mUniformBuffers;
+	for (std::vector<LLUniformBuffer*>::iterator it = buffers.begin(); it != buffers.end(); ++it)
+	{
+		(*it)->bindProgram(mProgramObject);
+	}
+
 	unbind();
 
 	LL_DEBUGS("ShaderLoading") << "Total Uniform Size: " << mTotalUniformSize << LL_ENDL;
@@ -522,6 +676,10 @@ BOOL LLGLSLShader::link(BOOL suppress_errors)
 
 void LLGLSLShader::bind()
 {
+	if (mPending)
+	{ //set up straight after createShader() in a batch
+		finishShader();
+	}
 	gGL.flush();
 	if (gGLManager.mHasShaderObjects)
 	{
@@ -529,6 +687,7 @@ void LLGLSLShader::bind()
 		glUseProgramObjectARB(mProgramObject);
 		sCurBoundShader = mProgramObject;
 		sCurBoundShaderPtr = this;
+		sBindCount++;
 		if (mUniformsDirty)
 		{
 			LLShaderMgr::instance()->updateShaderUniforms(this);
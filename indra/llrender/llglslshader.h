@@ -80,17 +80,27 @@ public:
 	static LLGLSLShader* sCurBoundShaderPtr;
 	static S32 sIndexedTextureChannels;
 	static bool sNoFixedFunction;
+	static U32 sBindCount;		// Tracks number of shader binds for current frame
+	static U32 sUniformUpdateCount;		// Uniform values sent to GL for current frame
+	static U32 sRedundantUniformCount;	// Uniform values that GL already had for current frame
 
 	void unload();
+	// Inside LLShaderMgr::beginShaderBatch()/endShaderBatch() this only starts the
+	// work and returns TRUE unless a file is missing; the batch reports failures.
 	BOOL createShader(std::vector<LLStaticHashedString> * attributes,
 						std::vector<LLStaticHashedString> * uniforms,
 						U32 varying_count = 0,
 						const char** varyings = NULL);
+	// Waits for a batched createShader() and sets the program up
+	BOOL finishShader();
+	bool isPending() const { return mPending; }
 	BOOL attachObject(std::string object);
 	void attachObject(GLhandleARB object);
 	void attachObjects(GLhandleARB* objects = NULL, S32 count = 0);
-	BOOL mapAttributes(const std::vector<LLStaticHashedString> * attributes);
+	// link_program is FALSE for programs that came out of the program binary cache already linked
+	BOOL mapAttributes(const std::vector<LLStaticHashedString> * attributes, BOOL link_program = TRUE);
 	BOOL mapUniforms(const std::vector<LLStaticHashedString> *);
+	void bindReservedAttributes();
 	void mapUniform(GLint index, const std::vector<LLStaticHashedString> *);
 	S32 getUniformFromIndex(const U32 index)
 	{
@@ -101,133 +111,148 @@ public:
 		}
 		return mUniform[index];
 	}
-	template <typename T, int N>
-	S32 updateUniform(std::vector<std::pair<GLint, T> >& cache, S32 uniform, const F32* val)
+	// Records the words that are about to be sent to location. Returns false,
+	// and the call can be skipped, if GL already has them or there is nothing
+	// to set them on.
+	bool updateShadow(GLint location, const void* val, U32 words)
 	{
-		if (mProgramObject > 0)
+		if (mProgramObject == 0 || location < 0)
 		{
-			if (uniform >= 0)
+			return false;
+		}
+		if ((U32)location >= mShadow.size() || words > mShadow[location].mWords)
+		{ //not tracked, or more than the uniform holds
+			if ((U32)location < mShadow.size())
 			{
-				typename std::vector<std::pair<GLint, T> >::iterator iter = std::find_if(cache.begin(), cache.end(), boost::bind(&std::pair<GLint, T>::first, _1) == uniform);
-				if (iter == cache.end())
-				{
-					T tmp;
-					memcpy(&tmp, val, sizeof(F32)*N);
-					cache.push_back(std::make_pair(uniform, tmp));
-					return true;
-				}
-				else if (memcmp(&iter->second, val, sizeof(F32)*N))
-				{
-					memcpy(&iter->second, val, sizeof(F32)*N);
-					return true;
-				}
+				mShadow[location].mValidWords = 0;
 			}
+			++sUniformUpdateCount;
+			return true;
+		}
+		UniformShadow& shadow = mShadow[location];
+		U32* data = &mShadowData[shadow.mOffset];
+		if (words <= shadow.mValidWords && !memcmp(data, val, words * sizeof(U32)))
+		{
+			++sRedundantUniformCount;
+			return false;
 		}
-		return false;
+		memcpy(data, val, words * sizeof(U32));
+		shadow.mValidWords = llmax(shadow.mValidWords, words);
+		++sUniformUpdateCount;
+		return true;
 	}
+
 	void uniform1i(U32 index, GLint x)
 	{
-		F32 val = x;
-		if (updateUniform<LLVector4, 1>(mValueVec4, getUniformFromIndex(index), &val))
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, &x, 1))
 		{
-			glUniform1iARB(mUniform[index], x);
+			glUniform1iARB(location, x);
 		}
 	}
 	void uniform1f(U32 index, GLfloat x)
 	{
-		if (updateUniform<LLVector4, 1>(mValueVec4, getUniformFromIndex(index), &x))
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, &x, 1))
 		{
-			glUniform1fARB(mUniform[index], x);
+			glUniform1fARB(location, x);
 		}
 	}
 	void uniform2f(U32 index, GLfloat x, GLfloat y)
 	{
-		F32 val[] = { x, y };
-		if (updateUniform<LLVector4, 2>(mValueVec4, getUniformFromIndex(index), val))
+		GLint location = getUniformFromIndex(index);
+		F32 val[] = {x, y};
+		if (updateShadow(location, val, 2))
 		{
-			glUniform2fARB(mUniform[index], x, y);
+			glUniform2fARB(location, x, y);
 		}
 	}
 	void uniform3f(U32 index, GLfloat x, GLfloat y, GLfloat z)
 	{
-		F32 val[] = { x, y, z };
-		if (updateUniform<LLVector4, 3>(mValueVec4, getUniformFromIndex(index), val))
+		GLint location = getUniformFromIndex(index);
+		F32 val[] = {x, y, z};
+		if (updateShadow(location, val, 3))
 		{
-			glUniform3fARB(mUniform[index], x, y, z);
+			glUniform3fARB(location, x, y, z);
 		}
 	}
 	void uniform4f(U32 index, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
 	{
-		F32 val[] = { x, y, z, w };
-		if (updateUniform<LLVector4, 4>(mValueVec4, getUniformFromIndex(index), val))
+		GLint location = getUniformFromIndex(index);
+		F32 val[] = {x, y, z, w};
+		if (updateShadow(location, val, 4))
 		{
-			glUniform4fARB(mUniform[index], x, y, z, w);
+			glUniform4fARB(location, x, y, z, w);
 		}
 	}
 	void uniform1iv(U32 index, U32 count, const GLint* v)
 	{
-		F32 val[] = { static_cast<const F32>(v[0]) };
-		if (updateUniform<LLVector4, 1>(mValueVec4, getUniformFromIndex(index), val) || count > 1)
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, v, count))
 		{
-			glUniform1ivARB(mUniform[index], count, v);
+			glUniform1ivARB(location, count, v);
 		}
 	}
 	void uniform1fv(U32 index, U32 count, const GLfloat* v)
 	{
-		if (updateUniform<LLVector4, 1>(mValueVec4, getUniformFromIndex(index), v) || count > 1)
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, v, count))
 		{
-			glUniform1fvARB(mUniform[index], count, v);
+			glUniform1fvARB(location, count, v);
 		}
 	}
 	void uniform2fv(U32 index, U32 count, const GLfloat* v)
 	{
-		if (updateUniform<LLVector4, 2>(mValueVec4, getUniformFromIndex(index), v) || count > 1)
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, v, 2 * count))
 		{
-			glUniform2fvARB(mUniform[index], count, v);
+			glUniform2fvARB(location, count, v);
 		}
 	}
 	void uniform3fv(U32 index, U32 count, const GLfloat* v)
 	{
-		if (updateUniform<LLVector4, 3>(mValueVec4, getUniformFromIndex(index), v) || count > 1)
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, v, 3 * count))
 		{
-			glUniform3fvARB(mUniform[index], count, v);
+			glUniform3fvARB(location, count, v);
 		}
 	}
 	void uniform4fv(U32 index, U32 count, const GLfloat* v)
 	{
-		if (updateUniform<LLVector4, 4>(mValueVec4, getUniformFromIndex(index), v) || count > 1)
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, v, 4 * count))
 		{
-			glUniform4fvARB(mUniform[index], count, v);
+			glUniform4fvARB(location, count, v);
 		}
 	}
 	void uniformMatrix3fv(U32 index, U32 count, GLboolean transpose, const GLfloat *v)
 	{
-		if (updateUniform<LLMatrix3, 9>(mValueMat3, getUniformFromIndex(index), v) || count > 1)
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, v, 9 * count))
 		{
-			glUniformMatrix3fvARB(mUniform[index], count, transpose, v);
+			glUniformMatrix3fvARB(location, count, transpose, v);
 		}
 	}
 	void uniformMatrix3x4fv(U32 index, U32 count, GLboolean transpose, const GLfloat *v)
 	{
-		if (updateUniform<LLMatrix4, 12>(mValueMat4, getUniformFromIndex(index), v) || count > 1)
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, v, 12 * count))
 		{
-			glUniformMatrix3x4fv(mUniform[index], count, transpose, v);
+			glUniformMatrix3x4fv(location, count, transpose, v);
 		}
 	}
 	void uniformMatrix4fv(U32 index, U32 count, GLboolean transpose, const GLfloat *v)
 	{
-		if (updateUniform<LLMatrix4, 16>(mValueMat4, getUniformFromIndex(index), v) || count > 1)
+		GLint location = getUniformFromIndex(index);
+		if (updateShadow(location, v, 16 * count))
 		{
-			glUniformMatrix4fvARB(mUniform[index], count, transpose, v);
+			glUniformMatrix4fvARB(location, count, transpose, v);
 		}
 	}
 	void uniform1i(const LLStaticHashedString& uniform, GLint i)
 	{
 		GLint location = getUniformLocation(uniform);
-		if (location < 0)
-			return;
-		F32 val = i;
-		if (updateUniform<LLVector4, 1>(mValueVec4, getUniformLocation(uniform), &val))
+		if (updateShadow(location, &i, 1))
 		{
 			glUniform1iARB(location, i);
 		}
@@ -235,9 +260,7 @@ public:
 	void uniform1f(const LLStaticHashedString& uniform, GLfloat v)
 	{
 		GLint location = getUniformLocation(uniform);
-		if (location < 0)
-			return;
-		if (updateUniform<LLVector4, 1>(mValueVec4, location, &v))
+		if (updateShadow(location, &v, 1))
 		{
 			glUniform1fARB(location, v);
 		}
@@ -245,10 +268,8 @@ public:
 	void uniform2f(const LLStaticHashedString& uniform, GLfloat x, GLfloat y)
 	{
 		GLint location = getUniformLocation(uniform);
-		if (location < 0)
-			return;
-		F32 val[] = { x, y };
-		if (updateUniform<LLVector4, 2>(mValueVec4, location, val))
+		F32 val[] = {x, y};
+		if (updateShadow(location, val, 2))
 		{
 			glUniform2fARB(location, x, y);
 		}
@@ -256,10 +277,8 @@ public:
 	void uniform3f(const LLStaticHashedString& uniform, GLfloat x, GLfloat y, GLfloat z)
 	{
 		GLint location = getUniformLocation(uniform);
-		if (location < 0)
-			return;
-		F32 val[] = { x, y, z };
-		if (updateUniform<LLVector4, 3>(mValueVec4, location, val))
+		F32 val[] = {x, y, z};
+		if (updateShadow(location, val, 3))
 		{
 			glUniform3fARB(location, x, y, z);
 		}
@@ -267,9 +286,7 @@ public:
 	void uniform1fv(const LLStaticHashedString& uniform, U32 count, const GLfloat* v)
 	{
 		GLint location = getUniformLocation(uniform);
-		if (location < 0)
-			return;
-		if (updateUniform<LLVector4, 1>(mValueVec4, location, v))
+		if (updateShadow(location, v, count))
 		{
 			glUniform1fvARB(location, count, v);
 		}
@@ -277,9 +294,7 @@ public:
 	void uniform2fv(const LLStaticHashedString& uniform, U32 count, const GLfloat* v)
 	{
 		GLint location = getUniformLocation(uniform);
-		if (location < 0)
-			return;
-		if (updateUniform<LLVector4, 2>(mValueVec4, location, v))
+		if (updateShadow(location, v, 2 * count))
 		{
 			glUniform2fvARB(location, count, v);
 		}
@@ -287,9 +302,7 @@ public:
 	void uniform3fv(const LLStaticHashedString& uniform, U32 count, const GLfloat* v)
 	{
 		GLint location = getUniformLocation(uniform);
-		if (location < 0)
-			return;
-		if (updateUniform<LLVector4, 3>(mValueVec4, location, v))
+		if (updateShadow(location, v, 3 * count))
 		{
 			glUniform3fvARB(location, count, v);
 		}
@@ -297,9 +310,7 @@ public:
 	void uniform4fv(const LLStaticHashedString& uniform, U32 count, const GLfloat* v)
 	{
 		GLint location = getUniformLocation(uniform);
-		if (location < 0)
-			return;
-		if (updateUniform<LLVector4, 4>(mValueVec4, location, v))
+		if (updateShadow(location, v, 4 * count))
 		{
 			glUniform4fvARB(location, count, v);
 		}
@@ -307,9 +318,7 @@ public:
 	void uniformMatrix4fv(const LLStaticHashedString& uniform, U32 count, GLboolean transpose, const GLfloat *v)
 	{
 		GLint location = getUniformLocation(uniform);
-		if (location < 0)
-			return;
-		if (updateUniform<LLMatrix4, 16>(mValueMat4, location, v))
+		if (updateShadow(location, v, 16 * count))
 		{
 			glUniformMatrix4fvARB(location, count, transpose, v);
 		}
@@ -379,10 +388,15 @@ public:
 	U32 mAttributeMask;  //mask of which reserved attributes are set (lines up with LLVertexBuffer::getTypeMask())
 	std::vector<GLint> mUniform;   //lookup table of uniform enum to uniform location
 	LLStaticStringTable<GLint> mUniformMap; //lookup map of uniform name to uniform location
-	//There are less naive ways to do this than just having several vectors for the differing types, but this method is of least complexity and has some inherent type-safety.
-	std::vector<std::pair<GLint, LLVector4> > mValueVec4; //lookup map of uniform location to last known value
-	std::vector<std::pair<GLint, LLMatrix3> > mValueMat3; //lookup map of uniform location to last known value
-	std::vector<std::pair<GLint, LLMatrix4> > mValueMat4; //lookup map of uniform location to last known value
+	//last values sent to each uniform location, whatever their type, so that unchanged values are not sent again
+	struct UniformShadow
+	{
+		U32 mOffset;		//into mShadowData
+		U32 mWords;			//room for the whole uniform, 0 if not tracked
+		U32 mValidWords;	//how much of it GL is known to have
+	};
+	std::vector<UniformShadow> mShadow; //lookup table of uniform location to shadow
+	std::vector<U32> mShadowData;
 
 	std::vector<GLint> mTexture;   //lookup table of texture uniform enum to texture channel
 	S32 mTotalUniformSize;
@@ -395,6 +409,21 @@ public:
 	std::vector< std::pair< std::string, GLenum > > mShaderFiles;
 	std::string mName;
 	std::map<std::string, std::string> mDefines;
+
+private:
+	BOOL buildShader(U32 varying_count, const char** varyings, bool wait);
+	BOOL submitShader(U32 varying_count, const char** varyings);
+
+	// Carried from submitShader() to finishShader()
+	bool mPending;					// Waiting for LLShaderMgr::endShaderBatch()
+	BOOL mSubmitted;				// Every own file found and compiling
+	BOOL mCached;					// Came out of the program binary cache
+	LLShaderFeatures mSubmittedFeatures;
+	std::string mCacheKey;
+	bool mHasPendingAttributes;
+	std::vector<LLStaticHashedString> mPendingAttributes;
+	bool mHasPendingUniforms;
+	std::vector<LLStaticHashedString> mPendingUniforms;
 };
 
 //UI shader (declared here so llui_libtest will link properly)
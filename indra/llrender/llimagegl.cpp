@@ -33,6 +33,8 @@
 
 #include "llerror.h"
 #include "llimage.h"
+#include "llimageglthread.h"
+#include "llimageresample.h"
 
 #include "llmath.h"
 #include "llgl.h"
@@ -465,6 +467,7 @@ LLImageGL::LLImageGL(const LLImageRaw* imageraw, BOOL usemipmaps)
 
 LLImageGL::~LLImageGL()
 {
+	gGL.forgetImage(this);
 	LLImageGL::cleanup();
 	sImageList.erase(this);
 	delete [] mPickMask;
@@ -499,6 +502,7 @@ void LLImageGL::init(BOOL usemipmaps)
 
 	mGLTextureCreated = FALSE ;
 	mTexName = 0;
+	mUpload = NULL;
 	mWidth = 0;
 	mHeight	= 0;
 	mCurrentDiscardLevel = -1;	
@@ -835,38 +839,30 @@ void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
 				S32 height = getHeight(mCurrentDiscardLevel);
 				S32 nummips = mMaxDiscardLevel - mCurrentDiscardLevel + 1;
 				S32 w = width, h = height;
-				const U8* prev_mip_data = 0;
-				const U8* cur_mip_data = 0;
-#ifdef SHOW_ASSERT
-				S32 cur_mip_size = 0;
-#endif
-				
+
 				mMipLevels = nummips;
 
-				for (int m=0; m<nummips; m++)
+				// Build the whole chain in one pass, into a single buffer.
+				std::vector<U8*> mip_data(nummips);
+				S32 mip_bytes = 0;
+				for (int m=1; m<nummips; m++)
 				{
-					if (m==0)
-					{
-						cur_mip_data = data_in;
-#ifdef SHOW_ASSERT
-						cur_mip_size = width * height * mComponents; 
-#endif
-					}
-					else
+					mip_bytes += (width >> m) * (height >> m) * mComponents;
+				}
+				U8* mip_buffer = mip_bytes ? new U8[mip_bytes] : NULL;
+				if (mip_buffer)
+				{
+					mip_data[1] = mip_buffer;
+					for (int m=2; m<nummips; m++)
 					{
-						S32 bytes = w * h * mComponents;
-#ifdef SHOW_ASSERT
-						llassert(prev_mip_data);
-						llassert(cur_mip_size == bytes*4);
-#endif
-						U8* new_data = new U8[bytes];
-						llassert_always(new_data);
-						LLImageBase::generateMip(prev_mip_data, new_data, w, h, mComponents);
-						cur_mip_data = new_data;
-#ifdef SHOW_ASSERT
-						cur_mip_size = bytes; 
-#endif
+						mip_data[m] = mip_data[m-1] + (width >> (m-1)) * (height >> (m-1)) * mComponents;
 					}
+					LLImageResample::generateMipChain(data_in, width, height, mComponents, &mip_data[1], nummips - 1);
+				}
+
+				for (int m=0; m<nummips; m++)
+				{
+					const U8* cur_mip_data = m == 0 ? data_in : mip_data[m];
 					llassert(w > 0 && h > 0 && cur_mip_data);
 					{
 // 						LLFastTimer t1(FTM_TEMP4);
@@ -893,19 +889,10 @@ void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
 							stop_glerror();
 						}
 					}
-					if (prev_mip_data && prev_mip_data != data_in)
-					{
-						delete[] prev_mip_data;
-					}
-					prev_mip_data = cur_mip_data;
 					w >>= 1;
 					h >>= 1;
 				}
-				if (prev_mip_data && prev_mip_data != data_in)
-				{
-					delete[] prev_mip_data;
-					prev_mip_data = NULL;
-				}
+				delete[] mip_buffer;
 			}
 		}
 		else
@@ -1087,6 +1074,46 @@ void LLImageGL::deleteTextures(S32 numTextures, U32 *textures)
 	}
 }
 
+// The generic compressed format for an uncompressed internal format
+static LLGLint get_compressed_format(LLGLint intformat)
+{
+	switch (intformat)
+	{
+		case GL_RED: 
+		case GL_R8:
+			intformat = GL_COMPRESSED_RED; 
+			break;
+		case GL_RG: 
+		case GL_RG8:
+			intformat = GL_COMPRESSED_RG; 
+			break;
+		case GL_RGB: 
+		case GL_RGB8:
+			intformat = GL_COMPRESSED_RGB; 
+			break;
+		case GL_RGBA:
+		case GL_RGBA8:
+			intformat = GL_COMPRESSED_RGBA; 
+			break;
+		case GL_LUMINANCE:
+		case GL_LUMINANCE8:
+			intformat = GL_COMPRESSED_LUMINANCE;
+			break;
+		case GL_LUMINANCE_ALPHA:
+		case GL_LUMINANCE8_ALPHA8:
+			intformat = GL_COMPRESSED_LUMINANCE_ALPHA;
+			break;
+		case GL_ALPHA:
+		case GL_ALPHA8:
+			intformat = GL_COMPRESSED_ALPHA;
+			break;
+		default:
+			LL_WARNS() << "Could not compress format: " << std::hex << intformat << std::dec << LL_ENDL;
+			break;
+	}
+	return intformat;
+}
+
 // static
 static LLFastTimer::DeclareTimer FTM_SET_MANUAL_IMAGE("setManualImage");
 void LLImageGL::setManualImage(U32 target, S32 miplevel, S32 intformat, S32 width, S32 height, U32 pixformat, U32 pixtype, const void *pixels, bool allow_compression)
@@ -1184,40 +1211,7 @@ void LLImageGL::setManualImage(U32 target, S32 miplevel, S32 intformat, S32 widt
 	}
 	if (LLImageGL::sCompressTextures && allow_compression)
 	{
-		switch (intformat)
-		{
-			case GL_RED: 
-			case GL_R8:
-				intformat = GL_COMPRESSED_RED; 
-				break;
-			case GL_RG: 
-			case GL_RG8:
-				intformat = GL_COMPRESSED_RG; 
-				break;
-			case GL_RGB: 
-			case GL_RGB8:
-				intformat = GL_COMPRESSED_RGB; 
-				break;
-			case GL_RGBA:
-			case GL_RGBA8:
-				intformat = GL_COMPRESSED_RGBA; 
-				break;
-			case GL_LUMINANCE:
-			case GL_LUMINANCE8:
-				intformat = GL_COMPRESSED_LUMINANCE;
-				break;
-			case GL_LUMINANCE_ALPHA:
-			case GL_LUMINANCE8_ALPHA8:
-				intformat = GL_COMPRESSED_LUMINANCE_ALPHA;
-				break;
-			case GL_ALPHA:
-			case GL_ALPHA8:
-				intformat = GL_COMPRESSED_ALPHA;
-				break;
-			default:
-				LL_WARNS() << "Could not compress format: " << std::hex << intformat << std::dec << LL_ENDL;
-				break;
-		}
+		intformat = get_compressed_format(intformat);
 	}
 
 	stop_glerror();
@@ -1259,7 +1253,7 @@ BOOL LLImageGL::createGLTexture()
 }
 
 static LLFastTimer::DeclareTimer FTM_CREATE_GL_TEXTURE2("createGLTexture(raw)");
-BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename/*=0*/, BOOL to_create, S32 category)
+BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename/*=0*/, BOOL to_create, S32 category, bool allow_async)
 {
 	LLFastTimer t(FTM_CREATE_GL_TEXTURE2);
 	if (gGLManager.mIsDisabled)
@@ -1331,6 +1325,10 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
 	}
 
 	setCategory(category);
+	if (allow_async && !usename && postUpload(discard_level, imageraw))
+	{
+		return TRUE;
+	}
  	const U8* rawdata = imageraw->getData();
 	return createGLTexture(discard_level, rawdata, FALSE, usename);
 }
@@ -1341,6 +1339,7 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_
 	LLFastTimer t(FTM_CREATE_GL_TEXTURE3);
 	llassert(data_in);
 	stop_glerror();
+	cancelUpload();
 
 	if (discard_level < 0)
 	{
@@ -1432,6 +1431,109 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_
 	return TRUE;
 }
 
+// Hand the texture to the upload thread, if there is one and it can do this format.
+bool LLImageGL::postUpload(S32 discard_level, const LLImageRaw* imageraw)
+{
+	LLImageGLThread* thread = LLImageGLThread::getInstance();
+	if (!thread || mTarget != GL_TEXTURE_2D || mFormatSwapBytes || mFormatType != GL_UNSIGNED_BYTE ||
+		!((mComponents == 3 && mFormatPrimary == GL_RGB) || (mComponents == 4 && mFormatPrimary == GL_RGBA)))
+	{
+		return false;
+	}
+
+	cancelUpload();
+	discard_level = llclamp(discard_level, 0, (S32)mMaxDiscardLevel);
+
+	LLImageGLUpload* upload = new LLImageGLUpload;
+	upload->mImage = this;
+	upload->mRaw = const_cast<LLImageRaw*>(imageraw);
+	upload->mData = imageraw->getData();
+	upload->mWidth = getWidth(discard_level);
+	upload->mHeight = getHeight(discard_level);
+	upload->mComponents = mComponents;
+	upload->mDiscardLevel = discard_level;
+	upload->mMaxLevel = mMaxDiscardLevel - discard_level;
+	upload->mLevels = mUseMipMaps ? upload->mMaxLevel + 1 : 1;
+	upload->mFormatInternal = mFormatInternal;
+	if (sCompressTextures && mAllowCompression)
+	{
+		upload->mFormatInternal = get_compressed_format(mFormatInternal);
+	}
+	upload->mFormatPrimary = mFormatPrimary;
+
+	mUpload = upload;
+	thread->post(upload);
+	return true;
+}
+
+// Called by LLImageGLThread::updateClass() once the GPU has the new texture.
+void LLImageGL::finishUpload(LLImageGLUpload* upload)
+{
+	llassert(mUpload == upload);
+	mUpload = NULL;
+	if (!upload->mTexName)
+	{
+		// The upload thread failed, do it here.
+		createGLTexture(upload->mDiscardLevel, upload->mData);
+		return;
+	}
+
+	if (mUseMipMaps)
+	{
+		//set has mip maps to true before binding image so tex parameters get set properly
+		gGL.getTexUnit(0)->unbind(mBindTarget);
+		mHasMipMaps = true;
+		setFilteringOption(LLTexUnit::TFO_ANISOTROPIC);
+		mMipLevels = upload->mLevels;
+	}
+	else
+	{
+		mHasMipMaps = false;
+		mMipLevels = 0;
+	}
+	// Address mode and filtering get applied on the next bind.
+	mTexOptionsDirty = true;
+
+	analyzeAlpha(upload->mData, upload->mWidth, upload->mHeight);
+	updatePickMask(upload->mWidth, upload->mHeight, upload->mData);
+
+	if (mTexName != 0)
+	{
+		sGlobalTextureMemoryInBytes -= mTextureMemory;
+
+		if(gAuditTexture)
+		{
+			decTextureCounter(mTextureMemory, mComponents, mCategory) ;
+		}
+
+		LLImageGL::deleteTextures(1, &mTexName);
+	}
+	mTexName = upload->mTexName;
+	upload->mTexName = 0;
+	mCurrentDiscardLevel = upload->mDiscardLevel;
+
+	mTextureMemory = getMipBytes(mCurrentDiscardLevel);
+	sGlobalTextureMemoryInBytes += mTextureMemory;
+
+	if(gAuditTexture)
+	{
+		incTextureCounter(mTextureMemory, mComponents, mCategory) ;
+	}
+	mGLTextureCreated = true;
+	// mark this as bound at this point, so we don't throw it out immediately
+	mLastBindTime = sLastFrameTime;
+}
+
+void LLImageGL::cancelUpload()
+{
+	if (mUpload)
+	{
+		// The upload thread still hands it back; its texture gets deleted then.
+		mUpload->mCancelled = true;
+		mUpload = NULL;
+	}
+}
+
 BOOL LLImageGL::readBackRaw(S32 discard_level, LLImageRaw* imageraw, bool compressed_ok)
 {
 	// VWR-13505 : Merov : Allow gl texture read back so save texture works again (temporary)
@@ -1558,6 +1660,7 @@ void LLImageGL::deleteDeadTextures()
 		
 void LLImageGL::destroyGLTexture()
 {
+	cancelUpload();
 	if (mTexName != 0)
 	{
 		if(mTextureMemory)
@@ -37,6 +37,8 @@
 
 #include "llrender.h"
 
+struct LLImageGLUpload;
+
 #define BYTES_TO_MEGA_BYTES(x) ((x) >> 20)
 #define MEGA_BYTES_TO_BYTES(x) ((x) << 20)
 
@@ -44,6 +46,7 @@
 class LLImageGL : public LLRefCount
 {
 	friend class LLTexUnit;
+	friend class LLImageGLThread;
 public:
 	// These 2 functions replace glGenTextures() and glDeleteTextures()
 	static void generateTextures(S32 numTextures, U32 *textures);
@@ -90,6 +93,10 @@ protected:
 	void analyzeAlpha(const void* data_in, U32 w, U32 h);
 	void calcAlphaChannelOffsetAndStride();
 
+	bool postUpload(S32 discard_level, const LLImageRaw* imageraw);
+	void finishUpload(LLImageGLUpload* upload);
+	void cancelUpload();
+
 public:
 	virtual void dump();	// debugging info to llinfos
 	
@@ -100,8 +107,10 @@ public:
 	static void setManualImage(U32 target, S32 miplevel, S32 intformat, S32 width, S32 height, U32 pixformat, U32 pixtype, const void *pixels, bool allow_compression = true);
 
 	BOOL createGLTexture() ;
+	// With allow_async, the texture may be handed to the GL upload thread instead,
+	// see isUploadPending(). imageraw must stay unchanged until it is done.
 	BOOL createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename = 0, BOOL to_create = TRUE,
-		S32 category = sMaxCategories-1);
+		S32 category = sMaxCategories-1, bool allow_async = false);
 	BOOL createGLTexture(S32 discard_level, const U8* data, BOOL data_hasmips = FALSE, S32 usename = 0);
 	void setImage(const LLImageRaw* imageraw);
 	void setImage(const U8* data_in, BOOL data_hasmips = FALSE);
@@ -133,6 +142,9 @@ public:
 	LLGLenum getFormatType() const { return mFormatType; }
 
 	BOOL getHasGLTexture() const { return mTexName != 0; }
+	// True while the upload thread works on a new texture for this image; the
+	// old one, if any, stays in use until then.
+	bool isUploadPending() const { return mUpload != NULL; }
 	LLGLuint getTexName() const { return mTexName; }
 
 	BOOL getIsAlphaMask(const F32 max_rmse) const { return mNeedsAlphaAndPickMask && (max_rmse < 0.f ? (bool)mIsMask : (mMaskRMSE <= max_rmse)); }
@@ -193,6 +205,7 @@ private:
 	
 	bool     mGLTextureCreated ;
 	LLGLuint mTexName;
+	LLImageGLUpload* mUpload;	// Owned by LLImageGLThread
 	U16      mWidth;
 	U16      mHeight;	
 	S8       mCurrentDiscardLevel;
@@ -0,0 +1,322 @@
+/**
+ * @file llimageglthread.cpp
+ * @brief Uploads textures on a thread with its own shared GL context
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimageglthread.h"
+
+#include "llimagegl.h"
+#include "llimageresample.h"
+#include "llwindow.h"
+
+LLImageGLThread* LLImageGLThread::sInstance = NULL;
+
+LLImageGLUpload::LLImageGLUpload()
+:	mCancelled(false),
+	mData(NULL),
+	mWidth(0),
+	mHeight(0),
+	mComponents(0),
+	mDiscardLevel(0),
+	mLevels(1),
+	mMaxLevel(0),
+	mFormatInternal(0),
+	mFormatPrimary(0),
+	mTexName(0)
+{
+}
+
+//static
+void LLImageGLThread::createInstance(LLWindow* window)
+{
+	if (sInstance || !window || gGLManager.mIsDisabled)
+	{
+		return;
+	}
+	if (!gGLManager.mHasSync)
+	{
+		LL_INFOS("RenderInit") << "No GL_ARB_sync, textures are uploaded on the main thread" << LL_ENDL;
+		return;
+	}
+
+	void* context = window->createSharedContext();
+	if (!context)
+	{
+		LL_INFOS("RenderInit") << "No shared GL context, textures are uploaded on the main thread" << LL_ENDL;
+		return;
+	}
+
+	sInstance = new LLImageGLThread(window, context);
+	sInstance->start();
+	LL_INFOS("RenderInit") << "Texture upload thread started"
+						   << (gGLManager.mHasPixelBufferObject ? " with pixel buffer objects" : "") << LL_ENDL;
+}
+
+//static
+void LLImageGLThread::deleteInstance()
+{
+	if (!sInstance)
+	{
+		return;
+	}
+	LLImageGLThread* thread = sInstance;
+	sInstance = NULL;
+
+	thread->setQuitting();
+	thread->shutdown();
+	delete thread;
+}
+
+LLImageGLThread::LLImageGLThread(LLWindow* window, void* context)
+:	LLThread("GL upload"),
+	mWindow(window),
+	mContext(context),
+	mWorkCount(0),
+	mPendingCount(0),
+	mPixelBuffer(0)
+{
+}
+
+LLImageGLThread::~LLImageGLThread()
+{
+	// The thread is gone and ran glFinish() before it let go of its context,
+	// so every texture it made is complete. Finish the rest here, through the
+	// main context, which shares the texture names: finishUpload() swaps in
+	// what the thread did and creates the others synchronously, so no image
+	// is left without its texture.
+	std::vector<LLImageGLUpload*> uploads(mDone.begin(), mDone.end());
+	uploads.insert(uploads.end(), mInFlight.begin(), mInFlight.end());
+	uploads.insert(uploads.end(), mQueue.begin(), mQueue.end());
+	for (std::vector<LLImageGLUpload*>::iterator it = uploads.begin(); it != uploads.end(); ++it)
+	{
+		LLImageGLUpload* upload = *it;
+		if (!upload->mCancelled)
+		{
+			upload->mImage->finishUpload(upload);
+		}
+		if (upload->mTexName)
+		{
+			LLImageGL::deleteTextures(1, &upload->mTexName);
+		}
+		delete upload;
+	}
+	mWindow->destroySharedContext(mContext);
+}
+
+//static
+void LLImageGLThread::updateClass()
+{
+	if (!sInstance)
+	{
+		return;
+	}
+
+	std::vector<LLImageGLUpload*> done;
+	sInstance->mQueueMutex.lock();
+	done.swap(sInstance->mDone);
+	sInstance->mQueueMutex.unlock();
+
+	for (std::vector<LLImageGLUpload*>::iterator it = done.begin(); it != done.end(); ++it)
+	{
+		LLImageGLUpload* upload = *it;
+		if (upload->mCancelled)
+		{
+			if (upload->mTexName)
+			{
+				LLImageGL::deleteTextures(1, &upload->mTexName);
+			}
+		}
+		else
+		{
+			upload->mImage->finishUpload(upload);
+		}
+		delete upload;
+	}
+	sInstance->mPendingCount -= (S32)done.size();
+}
+
+void LLImageGLThread::post(LLImageGLUpload* upload)
+{
+	mQueueMutex.lock();
+	mQueue.push_back(upload);
+	mQueueMutex.unlock();
+	mWorkCount++;
+	mPendingCount++;
+	wake();
+}
+
+//virtual
+bool LLImageGLThread::runCondition()
+{
+	return mWorkCount != 0;
+}
+
+//virtual
+void LLImageGLThread::run()
+{
+	mWindow->makeContextCurrent(mContext);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (gGLManager.mHasPixelBufferObject)
+	{
+		glGenBuffersARB(1, &mPixelBuffer);
+	}
+
+	while (true)
+	{
+		checkPause();
+		if (isQuitting())
+		{
+			break;
+		}
+
+		LLImageGLUpload* upload = NULL;
+		mQueueMutex.lock();
+		if (!mQueue.empty())
+		{
+			upload = mQueue.front();
+			mQueue.pop_front();
+		}
+		mQueueMutex.unlock();
+
+		if (upload)
+		{
+			this->upload(upload);
+			mInFlight.push_back(upload);
+		}
+		else if (!mInFlight.empty())
+		{
+			// Nothing else to do: block until the oldest upload reached the GPU.
+			mInFlight.front()->mFence.wait();
+		}
+
+		// Fences pass in order, so stop at the first one that has not.
+		while (!mInFlight.empty() && mInFlight.front()->mFence.isCompleted())
+		{
+			mQueueMutex.lock();
+			mDone.push_back(mInFlight.front());
+			mQueueMutex.unlock();
+			mInFlight.pop_front();
+			--mWorkCount;
+		}
+	}
+
+	if (mPixelBuffer)
+	{
+		glDeleteBuffersARB(1, &mPixelBuffer);
+		mPixelBuffer = 0;
+	}
+	// Make sure the main context sees every finished texture before it deletes them.
+	glFinish();
+	mWindow->makeContextCurrent(NULL);
+}
+
+void LLImageGLThread::upload(LLImageGLUpload* upload)
+{
+	const S32 components = upload->mComponents;
+
+	// Level 0 comes straight from the raw image, the others from the scratch buffer.
+	std::vector<const U8*> level_data(upload->mLevels);
+	std::vector<S32> level_bytes(upload->mLevels);
+	S32 total_bytes = 0;
+	for (S32 m = 0; m < upload->mLevels; ++m)
+	{
+		level_bytes[m] = (upload->mWidth >> m) * (upload->mHeight >> m) * components;
+		total_bytes += level_bytes[m];
+	}
+	level_data[0] = upload->mData;
+	if (upload->mLevels > 1)
+	{
+		mMipScratch.resize(total_bytes - level_bytes[0]);
+		std::vector<U8*> mips(upload->mLevels);
+		mips[1] = &mMipScratch[0];
+		for (S32 m = 2; m < upload->mLevels; ++m)
+		{
+			mips[m] = mips[m - 1] + level_bytes[m - 1];
+		}
+		LLImageResample::generateMipChain(upload->mData, upload->mWidth, upload->mHeight, components,
+										  &mips[1], upload->mLevels - 1);
+		for (S32 m = 1; m < upload->mLevels; ++m)
+		{
+			level_data[m] = mips[m];
+		}
+	}
+
+	// Stage every level in one orphaned pixel buffer, so that the copy to the
+	// GPU happens asynchronously and the driver never has to hold client memory.
+	if (mPixelBuffer)
+	{
+		glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, mPixelBuffer);
+		glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, total_bytes, NULL, GL_STREAM_DRAW_ARB);
+		U8* dst = (U8*)glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+		if (dst)
+		{
+			S32 offset = 0;
+			for (S32 m = 0; m < upload->mLevels; ++m)
+			{
+				memcpy(dst + offset, level_data[m], level_bytes[m]);
+				// From here on, an offset into the bound buffer
+				level_data[m] = (const U8*)(size_t)offset;
+				offset += level_bytes[m];
+			}
+			glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+		}
+		else
+		{
+			glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+		}
+	}
+
+	glGenTextures(1, &upload->mTexName);
+	glBindTexture(GL_TEXTURE_2D, upload->mTexName);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, upload->mMaxLevel);
+	for (S32 m = 0; m < upload->mLevels; ++m)
+	{
+		glTexImage2D(GL_TEXTURE_2D, m, upload->mFormatInternal, upload->mWidth >> m, upload->mHeight >> m, 0,
+					 upload->mFormatPrimary, GL_UNSIGNED_BYTE, level_data[m]);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	if (mPixelBuffer)
+	{
+		glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+	}
+
+	GLenum error = glGetError();
+	if (error != GL_NO_ERROR)
+	{
+		LL_WARNS() << "GL error " << error << " uploading a " << upload->mWidth << "x" << upload->mHeight
+				   << " texture, retrying on the main thread" << LL_ENDL;
+		while (glGetError() != GL_NO_ERROR)
+		{
+		}
+		glDeleteTextures(1, &upload->mTexName);
+		upload->mTexName = 0;
+	}
+
+	upload->mFence.placeFence();
+	// Get the fence to the GPU; nothing else will flush this context.
+	glFlush();
+}
@@ -0,0 +1,122 @@
+/**
+ * @file llimageglthread.h
+ * @brief Uploads textures on a thread with its own shared GL context
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGEGLTHREAD_H
+#define LL_LLIMAGEGLTHREAD_H
+
+#include <deque>
+#include <vector>
+
+#include "llgl.h"
+#include "llimage.h"
+#include "llpointer.h"
+#include "llthread.h"
+
+class LLImageGL;
+class LLWindow;
+
+// One texture on its way to the GPU.
+struct LLImageGLUpload
+{
+	// Main thread only
+	LLPointer<LLImageGL> mImage;
+	LLPointer<LLImageRaw> mRaw;		// Keeps mData alive
+	bool mCancelled;
+
+	// Set by the main thread before posting, read by the upload thread
+	const U8* mData;
+	S32 mWidth;
+	S32 mHeight;
+	S32 mComponents;
+	S32 mDiscardLevel;
+	S32 mLevels;					// 1 + the number of mip levels to generate
+	S32 mMaxLevel;					// GL_TEXTURE_MAX_LEVEL
+	LLGLint mFormatInternal;
+	LLGLenum mFormatPrimary;
+
+	// Set by the upload thread
+	LLGLuint mTexName;				// 0 if the upload failed
+	LLGLSyncFence mFence;
+
+	LLImageGLUpload();
+};
+
+//
+// Turns decoded images into GL textures away from the main thread. The thread
+// owns a GL context that shares objects with the main one; it builds the mip
+// chain, streams the levels through a pixel buffer object and places a fence
+// behind them. Once the GPU has passed the fence, updateClass() hands the new
+// texture name to its LLImageGL, which then drops its old one.
+//
+// Without a shared context, sync objects or a window that can make one, no
+// thread is started and LLImageGL uploads on the main thread as before.
+//
+class LLImageGLThread : public LLThread
+{
+public:
+	// Call from the main thread with the main context current.
+	static void createInstance(LLWindow* window);
+	// Stops the thread and finishes every unfinished upload on the main thread.
+	static void deleteInstance();
+	static LLImageGLThread* getInstance() { return sInstance; }
+
+	// Main thread, once per frame: swap in the textures that are done.
+	static void updateClass();
+
+	// Takes ownership of upload.
+	void post(LLImageGLUpload* upload);
+
+	// Uploads that were posted and not swapped in yet.
+	S32 getPending() const { return mPendingCount; }
+
+private:
+	LLImageGLThread(LLWindow* window, void* context);
+	/*virtual*/ ~LLImageGLThread();
+
+	/*virtual*/ bool runCondition();
+	/*virtual*/ void run();
+
+	void upload(LLImageGLUpload* upload);
+
+private:
+	static LLImageGLThread* sInstance;
+
+	LLWindow* mWindow;
+	void* mContext;
+
+	LLMutex mQueueMutex;						// Protects mQueue and mDone
+	std::deque<LLImageGLUpload*> mQueue;		// Waiting for the thread
+	std::vector<LLImageGLUpload*> mDone;		// Waiting for the main thread
+	LLAtomicS32 mWorkCount;						// Queued or in flight
+	S32 mPendingCount;							// Main thread only
+
+	// Upload thread only
+	std::deque<LLImageGLUpload*> mInFlight;		// Waiting for their fence
+	LLGLuint mPixelBuffer;
+	std::vector<U8> mMipScratch;
+};
+
+#endif // LL_LLIMAGEGLTHREAD_H
@@ -32,6 +32,7 @@
 #include "llcubemap.h"
 #include "llglslshader.h"
 #include "llimagegl.h"
+#include "llrenderdrawlist.h"
 #include "llrendertarget.h"
 #include "lltexture.h"
 #include "llshadermgr.h"
@@ -107,7 +108,7 @@ mCurrColorOp(TBO_MULT), mCurrAlphaOp(TBO_MULT),
 mCurrColorSrc1(TBS_TEX_COLOR), mCurrColorSrc2(TBS_PREV_COLOR),
 mCurrAlphaSrc1(TBS_TEX_ALPHA), mCurrAlphaSrc2(TBS_PREV_ALPHA),
 mCurrColorScale(1), mCurrAlphaScale(1), mCurrTexture(0),
-mHasMipMaps(false)
+mHasMipMaps(false), mCurrTexturep(NULL), mCurrImageGLp(NULL)
 {
 	llassert_always(index < (S32)LL_NUM_TEXTURE_LAYERS);
 	mIndex = index;
@@ -243,7 +244,11 @@ bool LLTexUnit::bind(LLTexture* texture, bool for_rendering, bool forceBind)
 		texture->forceImmediateUpdate() ;
 
 		gl_tex->forceUpdateBindStats() ;
-		return texture->bindDefaultImage(mIndex);
+		bool res = texture->bindDefaultImage(mIndex);
+		// Drawing it again binds the texture itself once it exists.
+		mCurrTexturep = texture;
+		mCurrImageGLp = NULL;
+		return res;
 	}
 
 	//in audit, replace the selected texture by the default one.
@@ -275,6 +280,8 @@ bool LLTexUnit::bind(LLTexture* texture, bool for_rendering, bool forceBind)
 			setTextureFilteringOption(gl_tex->mFilterOption);
 		}
 	}
+	mCurrTexturep = texture;
+	mCurrImageGLp = gl_tex;
 	return true;
 }
 
@@ -293,7 +300,10 @@ bool LLTexUnit::bind(LLImageGL* texture, bool for_rendering, bool forceBind)
 	{
 		if(LLImageGL::sDefaultGLTexture && LLImageGL::sDefaultGLTexture->getTexName())
 		{
-			return bind(LLImageGL::sDefaultGLTexture) ;
+			bool res = bind(LLImageGL::sDefaultGLTexture) ;
+			mCurrTexturep = NULL;
+			mCurrImageGLp = texture;
+			return res;
 		}
 		stop_glerror();
 		return false ;
@@ -321,6 +331,8 @@ bool LLTexUnit::bind(LLImageGL* texture, bool for_rendering, bool forceBind)
 			stop_glerror();
 		}
 	}
+	mCurrTexturep = NULL;
+	mCurrImageGLp = texture;
 
 	stop_glerror();
 
@@ -351,6 +363,8 @@ bool LLTexUnit::bind(LLCubeMap* cubeMap)
 			activate();
 			enable(LLTexUnit::TT_CUBE_MAP);
 			mCurrTexture = cubeMap->mImages[0]->getTexName();
+			mCurrTexturep = NULL;
+			mCurrImageGLp = NULL;
 			glBindTexture(GL_TEXTURE_CUBE_MAP_ARB, mCurrTexture);
 			mHasMipMaps = cubeMap->mImages[0]->mHasMipMaps;
 			cubeMap->mImages[0]->updateBindStats(cubeMap->mImages[0]->mTextureMemory);
@@ -414,6 +428,8 @@ bool LLTexUnit::bindManual(eTextureType type, U32 texture, bool hasMips)
 		glBindTexture(sGLTextureType[type], texture);
 		mHasMipMaps = hasMips;
 	}
+	mCurrTexturep = NULL;
+	mCurrImageGLp = NULL;
 	return true;
 }
 
@@ -432,6 +448,8 @@ void LLTexUnit::unbind(eTextureType type)
 	if (mCurrTexType == type)
 	{
 		mCurrTexture = 0;
+		mCurrTexturep = NULL;
+		mCurrImageGLp = NULL;
 		if (LLGLSLShader::sNoFixedFunction && type == LLTexUnit::TT_TEXTURE)
 		{
 			glBindTexture(sGLTextureType[type], sWhiteTexture);
@@ -522,6 +540,17 @@ void LLTexUnit::setTextureFilteringOption(LLTexUnit::eTextureFilterOptions optio
 	}
 }
 
+// A replayed list doesn't set the texture environment again, so it can't
+// hold batches drawn with another one.
+//static
+void LLTexUnit::abortDrawList()
+{
+	if (gGL.getDrawList())
+	{
+		gGL.getDrawList()->abort();
+	}
+}
+
 void LLTexUnit::setTextureBlendType(eTextureBlendType type)
 {
 	if (LLGLSLShader::sNoFixedFunction)
@@ -538,6 +567,7 @@ void LLTexUnit::setTextureBlendType(eTextureBlendType type)
 	}
 
 	gGL.flush();
+	abortDrawList();
 
 	activate();
 	mCurrBlendType = type;
@@ -661,6 +691,7 @@ void LLTexUnit::setTextureCombiner(eTextureBlendOp op, eTextureBlendSrc src1, eT
 	{
 		mCurrBlendType = TB_COMBINE;
 		gGL.flush();
+		abortDrawList();
 		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE_ARB);
 	}
 
@@ -672,6 +703,7 @@ void LLTexUnit::setTextureCombiner(eTextureBlendOp op, eTextureBlendSrc src1, eT
 	}
 
 	gGL.flush();
+	abortDrawList();
 
 	// Get the gl source enums according to the eTextureBlendSrc sources passed in
 	GLint source1 = getTextureSource(src1);
@@ -1031,7 +1063,9 @@ LLRender::LLRender()
 	mQuadCycle(0),
     mMode(LLRender::TRIANGLES),
     mCurrTextureUnitIndex(0),
-    mMaxAnisotropy(0.f) 
+    mMaxAnisotropy(0.f),
+    mDrawList(NULL),
+    mDrawingBatch(false)
 {	
 	mTexUnits.reserve(LL_NUM_TEXTURE_LAYERS);
 	for (U32 i = 0; i < LL_NUM_TEXTURE_LAYERS; i++)
@@ -1143,6 +1177,7 @@ void LLRender::refreshState(void)
 void LLRender::resetVertexBuffers()
 {
 	mBuffer = NULL;
+	LLRenderDrawList::destroyGL();
 }
 
 void LLRender::restoreVertexBuffers()
@@ -1199,6 +1234,12 @@ void LLRender::syncMatrices()
 {
 	stop_glerror();
 
+	if (mDrawList && !mDrawingBatch)
+	{
+		// Drawn from some other vertex buffer, which the list can't hold
+		mDrawList->abort();
+	}
+
 	U32 name[] = 
 	{
 		LLShaderMgr::MODELVIEW_MATRIX,
@@ -1981,6 +2022,29 @@ void LLRender::blendFunc(eBlendFactor color_sfactor, eBlendFactor color_dfactor,
 	}
 }
 
+void LLRender::forgetTexture(const LLTexture* texture)
+{
+	for (U32 i = 0; i < mTexUnits.size(); i++)
+	{
+		if (mTexUnits[i]->mCurrTexturep == texture)
+		{
+			mTexUnits[i]->mCurrTexturep = NULL;
+		}
+	}
+}
+
+void LLRender::forgetImage(const LLImageGL* image)
+{
+	for (U32 i = 0; i < mTexUnits.size(); i++)
+	{
+		if (mTexUnits[i]->mCurrImageGLp == image)
+		{
+			mTexUnits[i]->mCurrImageGLp = NULL;
+			mTexUnits[i]->mCurrTexturep = NULL;
+		}
+	}
+}
+
 LLTexUnit* LLRender::getTexUnit(U32 index)
 {
 	if (index < mTexUnits.size())
@@ -2170,6 +2234,13 @@ void LLRender::flush()
 			mBuffer->getColorStrider(mColorsp, 0, count);
 		}
 		
+		if (mDrawList)
+		{
+			mDrawList->addBatch(mMode == LLRender::QUADS && sGLCoreProfile ? LLRender::TRIANGLES : mMode,
+								mVerticesp.get(), mTexcoordsp.get(), mColorsp.get(), count);
+		}
+
+		mDrawingBatch = true;
 		mBuffer->flush();
 		mBuffer->setBuffer(immediate_mask);
 
@@ -2182,6 +2253,7 @@ void LLRender::flush()
 		{
 			mBuffer->drawArrays(mMode, 0, count);
 		}
+		mDrawingBatch = false;
 		
 		mVerticesp[0] = mVerticesp[count];
 		mTexcoordsp[0] = mTexcoordsp[count];
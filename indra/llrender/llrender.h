@@ -48,6 +48,7 @@
 class LLVertexBuffer;
 class LLCubeMap;
 class LLImageGL;
+class LLRenderDrawList;
 class LLRenderTarget;
 class LLTexture ;
 class LLMatrix4a;
@@ -57,6 +58,7 @@ class LLMatrix4a;
 class LLTexUnit
 {
 	friend class LLRender;
+	friend class LLRenderDrawList;
 public:
 	static U32 sWhiteTexture;
 
@@ -213,10 +215,14 @@ protected:
 	S32					mCurrColorScale;
 	S32					mCurrAlphaScale;
 	bool				mHasMipMaps;
+	// What mCurrTexture was last bound from, for LLRenderDrawList; NULL when bound by name.
+	LLTexture*			mCurrTexturep;
+	LLImageGL*			mCurrImageGLp;
 	
 	void debugTextureUnit(void);
 	void setColorScale(S32 scale);
 	void setAlphaScale(S32 scale);
+	static void abortDrawList();
 	GLint getTextureSource(eTextureBlendSrc src);
 	GLint getTextureSourceType(eTextureBlendSrc src, bool isAlpha = false);
 	void setTextureCombiner(eTextureBlendOp op, eTextureBlendSrc src1, eTextureBlendSrc src2, bool isAlpha = false);
@@ -437,6 +443,13 @@ public:
 	void setAmbientLightColor(const LLColor4& color);
 
 	LLTexUnit* getTexUnit(U32 index);
+	// For the destructors, so that no texture unit points at a deleted texture
+	void forgetTexture(const LLTexture* texture);
+	void forgetImage(const LLImageGL* image);
+
+	// The list recording what gets drawn, if any; see LLRenderDrawList.
+	void setDrawList(LLRenderDrawList* list) { mDrawList = list; }
+	LLRenderDrawList* getDrawList() const { return mDrawList; }
 
 	U32	getCurrentTexUnitIndex(void) const { return mCurrTextureUnitIndex; }
 
@@ -460,6 +473,7 @@ public:
 	
 private:
 	friend class LLLightState;
+	friend class LLRenderDrawList;
 
 	U32 mMatrixMode;
 	U32 mMatIdx[NUM_MATRIX_MODES];
@@ -495,6 +509,9 @@ private:
 
 	LLAlignedArray<LLVector4a, 64> mUIOffset;
 	LLAlignedArray<LLVector4a, 64> mUIScale;
+
+	LLRenderDrawList*	mDrawList;
+	bool				mDrawingBatch;	// Drawing batched vertices, which mDrawList gets from flush()
 } LL_ALIGN_POSTFIX(16);
 
 
@@ -0,0 +1,337 @@
+/**
+ * @file llrenderdrawlist.cpp
+ * @brief Recording of what LLRender draws, for drawing it again
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llrenderdrawlist.h"
+
+#include "llglslshader.h"
+#include "llimagegl.h"
+#include "lltexture.h"
+#include "llvertexbuffer.h"
+
+U32 LLRenderDrawList::sGLGeneration = 0;
+
+static const U32 DRAW_LIST_MASK = LLVertexBuffer::MAP_VERTEX | LLVertexBuffer::MAP_COLOR | LLVertexBuffer::MAP_TEXCOORD0;
+
+LLRenderDrawList::Command::Command()
+:	mScissor(false),
+	mMode(LLRender::TRIANGLES),
+	mFirst(0),
+	mCount(0),
+	mScissorEnabled(false)
+{
+	for (U32 i = 0; i < 4; ++i)
+	{
+		mBlend[i] = LLRender::BF_UNDEF;
+		mScissorRect[i] = 0;
+	}
+}
+
+LLRenderDrawList::LLRenderDrawList()
+:	mBufferGeneration(0),
+	mOuter(NULL),
+	mShader(NULL),
+	mRecording(false),
+	mRecorded(false),
+	mAborted(false),
+	mHasScissor(false)
+{
+	memset(mModelview, 0, sizeof(mModelview));
+	memset(mProjection, 0, sizeof(mProjection));
+}
+
+LLRenderDrawList::~LLRenderDrawList()
+{
+	if (mRecording)
+	{
+		end();
+	}
+}
+
+void LLRenderDrawList::clear()
+{
+	llassert(!mRecording);
+	mCommands.clear();
+	mVertices.resize(0);
+	mUVs.clear();
+	mColors.clear();
+	mBuffer = NULL;
+	mRecorded = false;
+	mHasScissor = false;
+}
+
+void LLRenderDrawList::begin()
+{
+	llassert(!mRecording);
+	gGL.flush();
+	clear();
+
+	mOuter = gGL.getDrawList();
+	gGL.setDrawList(this);
+	mShader = LLGLSLShader::sCurBoundShaderPtr;
+	memcpy(mModelview, gGL.getModelviewMatrix().getF32ptr(), sizeof(mModelview));
+	memcpy(mProjection, gGL.getProjectionMatrix().getF32ptr(), sizeof(mProjection));
+	mUIOffset = gGL.getUITranslation();
+	mUIScale = gGL.getUIScale();
+	mRecording = true;
+	mAborted = false;
+}
+
+bool LLRenderDrawList::end()
+{
+	llassert(mRecording && gGL.getDrawList() == this);
+	gGL.flush();
+	gGL.setDrawList(mOuter);
+	mOuter = NULL;
+	mRecording = false;
+
+	if (mAborted)
+	{
+		clear();
+		return false;
+	}
+	mRecorded = true;
+	return true;
+}
+
+void LLRenderDrawList::abort()
+{
+	if (mOuter)
+	{
+		mOuter->abort();
+	}
+	mAborted = true;
+}
+
+bool LLRenderDrawList::canReplay() const
+{
+	return mRecorded &&
+		   LLGLSLShader::sCurBoundShaderPtr == mShader &&
+		   gGL.getUITranslation() == mUIOffset &&
+		   gGL.getUIScale() == mUIScale &&
+		   !memcmp(gGL.getModelviewMatrix().getF32ptr(), mModelview, sizeof(mModelview)) &&
+		   !memcmp(gGL.getProjectionMatrix().getF32ptr(), mProjection, sizeof(mProjection));
+}
+
+void LLRenderDrawList::addBatch(U32 mode, const LLVector4a* vertices, const LLVector2* uvs, const LLColor4U* colors, U32 count)
+{
+	if (mOuter)
+	{
+		mOuter->addBatch(mode, vertices, uvs, colors, count);
+	}
+	if (mAborted || !count)
+	{
+		return;
+	}
+	if (LLGLSLShader::sCurBoundShaderPtr != mShader)
+	{
+		mAborted = true;
+		return;
+	}
+
+	Command command;
+	command.mMode = mode;
+	command.mFirst = mVertices.size();
+	command.mCount = count;
+
+	// Textures bound by GL name can't be bound again later.
+	LLTexUnit* unit = gGL.getTexUnit(0);
+	if (unit->mCurrTexturep)
+	{
+		command.mTexture = unit->mCurrTexturep;
+	}
+	else if (unit->mCurrImageGLp)
+	{
+		command.mImage = unit->mCurrImageGLp;
+	}
+	else if (unit->getCurrTexture())
+	{
+		mAborted = true;
+		return;
+	}
+
+	command.mBlend[0] = gGL.mCurrBlendColorSFactor;
+	command.mBlend[1] = gGL.mCurrBlendColorDFactor;
+	command.mBlend[2] = gGL.mCurrBlendAlphaSFactor;
+	command.mBlend[3] = gGL.mCurrBlendAlphaDFactor;
+
+	// Batches of separate primitives drawn in the same state make one draw call.
+	bool merged = false;
+	if (!mCommands.empty() && (mode == LLRender::TRIANGLES || mode == LLRender::QUADS || mode == LLRender::LINES || mode == LLRender::POINTS))
+	{
+		Command& last = mCommands.back();
+		if (!last.mScissor && last.mMode == mode && last.mTexture == command.mTexture && last.mImage == command.mImage &&
+			!memcmp(last.mBlend, command.mBlend, sizeof(command.mBlend)))
+		{
+			last.mCount += count;
+			merged = true;
+		}
+	}
+	if (!merged)
+	{
+		mCommands.push_back(command);
+	}
+
+	LLVector4a* dst = mVertices.append(count);
+	for (U32 i = 0; i < count; ++i)
+	{
+		dst[i] = vertices[i];
+	}
+	mUVs.insert(mUVs.end(), uvs, uvs + count);
+	mColors.insert(mColors.end(), colors, colors + count);
+}
+
+void LLRenderDrawList::addScissor(bool enabled, S32 x, S32 y, S32 width, S32 height)
+{
+	if (mOuter)
+	{
+		mOuter->addScissor(enabled, x, y, width, height);
+	}
+	if (mAborted)
+	{
+		return;
+	}
+
+	Command command;
+	command.mScissor = true;
+	command.mScissorEnabled = enabled;
+	command.mScissorRect[0] = x;
+	command.mScissorRect[1] = y;
+	command.mScissorRect[2] = width;
+	command.mScissorRect[3] = height;
+	mCommands.push_back(command);
+	mHasScissor = true;
+}
+
+void LLRenderDrawList::updateBuffer()
+{
+	if (mBuffer.notNull() && mBufferGeneration == sGLGeneration)
+	{
+		return;
+	}
+
+	const U32 count = mVertices.size();
+	mBuffer = new LLVertexBuffer(DRAW_LIST_MASK, GL_STATIC_DRAW_ARB);
+	mBuffer->allocateBuffer(count, 0, true);
+
+	LLStrider<LLVector4a> vertices;
+	LLStrider<LLVector2> uvs;
+	LLStrider<LLColor4U> colors;
+	if (!mBuffer->getVertexStrider(vertices) || !mBuffer->getTexCoord0Strider(uvs) || !mBuffer->getColorStrider(colors))
+	{
+		LL_WARNS() << "Failed to map a vertex buffer of " << count << " vertices for a draw list" << LL_ENDL;
+		mBuffer = NULL;
+		return;
+	}
+	for (U32 i = 0; i < count; ++i)
+	{
+		*(vertices++) = mVertices[i];
+		*(uvs++) = mUVs[i];
+		*(colors++) = mColors[i];
+	}
+	mBuffer->flush();
+	mBufferGeneration = sGLGeneration;
+}
+
+void LLRenderDrawList::replay()
+{
+	llassert(mRecorded && !mRecording);
+	gGL.flush();
+
+	LLRenderDrawList* outer = gGL.getDrawList();
+	if (!mVertices.empty())
+	{
+		updateBuffer();
+		if (mBuffer.isNull())
+		{
+			if (outer)
+			{
+				outer->abort();
+			}
+			return;
+		}
+	}
+
+	LLTexUnit* unit = gGL.getTexUnit(0);
+	LLGLState scissor_state(GL_SCISSOR_TEST);
+	for (std::vector<Command>::const_iterator it = mCommands.begin(); it != mCommands.end(); ++it)
+	{
+		const Command& command = *it;
+		if (command.mScissor)
+		{
+			scissor_state.setEnabled(command.mScissorEnabled);
+			if (command.mScissorEnabled)
+			{
+				glScissor(command.mScissorRect[0], command.mScissorRect[1], command.mScissorRect[2], command.mScissorRect[3]);
+			}
+			if (outer)
+			{
+				outer->addScissor(command.mScissorEnabled, command.mScissorRect[0], command.mScissorRect[1],
+								  command.mScissorRect[2], command.mScissorRect[3]);
+			}
+			continue;
+		}
+
+		if (command.mTexture.notNull())
+		{
+			unit->bind(command.mTexture.get());
+		}
+		else if (command.mImage.notNull())
+		{
+			unit->bind(command.mImage.get());
+		}
+		else
+		{
+			unit->unbind(LLTexUnit::TT_TEXTURE);
+		}
+		if (command.mBlend[0] == LLRender::BF_UNDEF || command.mBlend[1] == LLRender::BF_UNDEF ||
+			command.mBlend[2] == LLRender::BF_UNDEF || command.mBlend[3] == LLRender::BF_UNDEF)
+		{
+			// Recorded before anything set the blend function
+		}
+		else if (command.mBlend[0] == command.mBlend[2] && command.mBlend[1] == command.mBlend[3])
+		{
+			gGL.blendFunc(command.mBlend[0], command.mBlend[1]);
+		}
+		else
+		{
+			gGL.blendFunc(command.mBlend[0], command.mBlend[1], command.mBlend[2], command.mBlend[3]);
+		}
+
+		if (outer)
+		{
+			// The outer list records the batch with the state just set.
+			outer->addBatch(command.mMode, &mVertices[command.mFirst], &mUVs[command.mFirst], &mColors[command.mFirst], command.mCount);
+		}
+
+		gGL.mDrawingBatch = true;
+		mBuffer->setBuffer(DRAW_LIST_MASK);
+		mBuffer->drawArrays(command.mMode, command.mFirst, command.mCount);
+		gGL.mDrawingBatch = false;
+	}
+}
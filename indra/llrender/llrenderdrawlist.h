@@ -0,0 +1,136 @@
+/**
+ * @file llrenderdrawlist.h
+ * @brief Recording of what LLRender draws, for drawing it again
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLRENDERDRAWLIST_H
+#define LL_LLRENDERDRAWLIST_H
+
+#include <vector>
+
+#include "llalignedarray.h"
+#include "llpointer.h"
+#include "llrender.h"
+#include "v2math.h"
+#include "v3math.h"
+#include "v4coloru.h"
+
+class LLGLSLShader;
+class LLImageGL;
+class LLTexture;
+class LLVertexBuffer;
+
+//
+// The batches gGL flushed between begin() and end(), with the texture and
+// blend function each was drawn with, kept so that replay() can draw them
+// again from one static vertex buffer instead of building them vertex by
+// vertex. This is meant for the UI, where most of a frame looks like the
+// last one.
+//
+// A recording only holds what went through gGL's batches, under the
+// transforms, UI offset and shader that were current at begin(). Anything
+// else drawn in between, or a change of the fixed-function texture
+// combiners, aborts it, and end() reports that the list can't be replayed.
+//
+// Lists nest: batches recorded by a list also go to the list that was
+// recording when it began, and replaying a list while another records
+// adds its batches to that one.
+//
+class LLRenderDrawList
+{
+public:
+	LLRenderDrawList();
+	~LLRenderDrawList();
+
+	// Forgets the previous recording. Flushes gGL.
+	void begin();
+	// Flushes gGL. False, and nothing recorded, when the recording was aborted.
+	bool end();
+	void clear();
+
+	bool isRecording() const { return mRecording; }
+	bool isRecorded() const { return mRecorded; }
+	// Whether the transforms, UI offset and shader are those of the recording.
+	bool canReplay() const;
+	void replay();
+
+	U32 getVertexCount() const { return mVertices.size(); }
+	bool hasScissor() const { return mHasScissor; }
+
+	// For LLRender, and for the code that sets the scissor rectangle.
+	void addBatch(U32 mode, const LLVector4a* vertices, const LLVector2* uvs, const LLColor4U* colors, U32 count);
+	void addScissor(bool enabled, S32 x, S32 y, S32 width, S32 height);
+	// Something was drawn that the list can't hold.
+	void abort();
+
+	// Called when the GL context goes away; the lists rebuild their vertex buffers.
+	static void destroyGL() { ++sGLGeneration; }
+
+private:
+	LLRenderDrawList(const LLRenderDrawList&);
+	LLRenderDrawList& operator=(const LLRenderDrawList&);
+
+	struct Command
+	{
+		Command();
+
+		bool mScissor;					// A scissor change rather than a batch
+		// Batch
+		U32 mMode;
+		U32 mFirst;
+		U32 mCount;
+		LLPointer<LLTexture> mTexture;	// Bound by texture, or else
+		LLPointer<LLImageGL> mImage;	// by image, or else none
+		LLRender::eBlendFactor mBlend[4];
+		// Scissor
+		bool mScissorEnabled;
+		S32 mScissorRect[4];
+	};
+
+	void updateBuffer();
+
+	std::vector<Command> mCommands;
+	LLAlignedArray<LLVector4a, 64> mVertices;
+	std::vector<LLVector2> mUVs;
+	std::vector<LLColor4U> mColors;
+	LLPointer<LLVertexBuffer> mBuffer;
+	U32 mBufferGeneration;
+
+	// State of the recording
+	LLRenderDrawList* mOuter;
+	LLGLSLShader* mShader;
+	F32 mModelview[16];
+	F32 mProjection[16];
+	LLVector3 mUIOffset;
+	LLVector3 mUIScale;
+	bool mRecording;
+	bool mRecorded;
+	bool mAborted;
+	bool mHasScissor;
+
+	static U32 sGLGeneration;
+};
+
+#endif // LL_LLRENDERDRAWLIST_H
@@ -33,6 +33,8 @@
 #include "llrender.h"
 #include "llcontrol.h"	//for LLCachedControl
 #include "lldir.h"		//for gDirUtilp
+#include "llmd5.h"
+#include "lluniformbuffer.h"
 
 #if LL_DARWIN
 #include "OpenGL/OpenGL.h"
@@ -53,6 +55,12 @@ using std::string;
 LLShaderMgr * LLShaderMgr::sInstance = NULL;
 
 LLShaderMgr::LLShaderMgr()
+:	mProgramCacheHits(0),
+	mProgramCacheMisses(0),
+	mProgramCacheChecked(false),
+	mBatching(false),
+	mFinishing(false),
+	mProgramCount(0)
 {
 	{
 		const std::string dumpdir = gDirUtilp->getExpandedFilename(LL_PATH_LOGS,"shader_dump")+gDirUtilp->getDirDelimiter();
@@ -528,44 +536,30 @@ void LLShaderMgr::dumpObjectLog(GLhandleARB ret, BOOL warns)
 	}
 }
 
-GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shader_level, GLenum type, std::map<std::string, std::string>* defines, S32 texture_index_channels)
+static std::string hash_shader_source(const std::vector<std::string>& text, S32 gpu_class)
 {
-	std::pair<std::multimap<std::string, CachedObjectInfo >::iterator, std::multimap<std::string, CachedObjectInfo>::iterator> range;
-	range = mShaderObjects.equal_range(filename);
-	for (std::multimap<std::string, CachedObjectInfo>::iterator it = range.first; it != range.second;++it)
+	LLMD5 md5;
+	md5.update(llformat("class %d\n", gpu_class));
+	for (std::vector<std::string>::const_iterator it = text.begin(); it != text.end(); ++it)
 	{
-		if((*it).second.mLevel == shader_level && (*it).second.mType == type && (*it).second.mDefinitions == (defines ? *defines : std::map<std::string, std::string>()))
-		{
-			//LL_INFOS("ShaderLoading") << "Loading cached shader for " << filename << LL_ENDL;
-			return (*it).second.mHandle;
-		}
-	}
-
-	GLenum error = GL_NO_ERROR;
-	if (gDebugGL)
-	{
-		error = glGetError();
-		if (error != GL_NO_ERROR)
-		{
-			LL_WARNS("ShaderLoading") << "GL ERROR entering loadShaderFile(): " << error << LL_ENDL;
-		}
-	}
-
-	LL_DEBUGS("ShaderLoading") << "Loading shader file: " << filename << " class " << shader_level << LL_ENDL;
-
-	if (filename.empty()) 
-	{
-		return 0;
+		md5.update(*it);
 	}
+	md5.finalize();
+	char digest[33];
+	md5.hex_digest(digest);
+	return digest;
+}
 
+S32 LLShaderMgr::readShaderSource(const std::string& filename, S32 shader_level, GLenum type, std::map<std::string, std::string>* defines,
+								  S32 texture_index_channels, std::vector<std::string>& text)
+{
 	//read in from file
 	LLFILE* file = NULL;
 
-	S32 try_gpu_class = shader_level;
 	S32 gpu_class;
 
 	//find the most relevant file
-	for (gpu_class = try_gpu_class; gpu_class > 0; gpu_class--)
+	for (gpu_class = shader_level; gpu_class > 0; gpu_class--)
 	{	//search from the current gpu class down to class 1 to find the most relevant shader
 		std::stringstream fname;
 		fname << getShaderDirPrefix();
@@ -582,15 +576,11 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 	
 	if (file == NULL)
 	{
-		LL_WARNS("ShaderLoading") << "GLSL Shader file not found: " << filename << LL_ENDL;
 		return 0;
 	}
 
-	//we can't have any lines longer than 1024 characters 
-	//or any shaders longer than 4096 lines... deal - DaveP
+	//longer lines are read in pieces
 	GLcharARB buff[1024];
-	GLcharARB* text[4096];
-	GLuint count = 0;
 
 	S32 major_version = gGLManager.mGLSLVersionMajor;
 	S32 minor_version = gGLManager.mGLSLVersionMinor;
@@ -606,28 +596,28 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 
 		if (minor_version <= 19)
 		{
-			text[count++] = strdup("#version 110\n");
-			text[count++] = strdup("#define ATTRIBUTE attribute\n");
-			text[count++] = strdup("#define VARYING varying\n");
-			text[count++] = strdup("#define VARYING_FLAT varying\n");
+			text.push_back("#version 110\n");
+			text.push_back("#define ATTRIBUTE attribute\n");
+			text.push_back("#define VARYING varying\n");
+			text.push_back("#define VARYING_FLAT varying\n");
 			// Need to enable extensions here instead of in the shader files,
 			// before any non-preprocessor directives (per spec)
-			text[count++] = strdup("#extension GL_ARB_texture_rectangle : enable\n");
-			text[count++] = strdup("#extension GL_ARB_shader_texture_lod : enable\n");
+			text.push_back("#extension GL_ARB_texture_rectangle : enable\n");
+			text.push_back("#extension GL_ARB_shader_texture_lod : enable\n");
 		}
 		else if (minor_version <= 29)
 		{
 			//set version to 1.20
-			text[count++] = strdup("#version 120\n");
-			text[count++] = strdup("#define FXAA_GLSL_120 1\n");
-			text[count++] = strdup("#define FXAA_FAST_PIXEL_OFFSET 0\n");
-			text[count++] = strdup("#define ATTRIBUTE attribute\n");
-			text[count++] = strdup("#define VARYING varying\n");
-			text[count++] = strdup("#define VARYING_FLAT varying\n");
+			text.push_back("#version 120\n");
+			text.push_back("#define FXAA_GLSL_120 1\n");
+			text.push_back("#define FXAA_FAST_PIXEL_OFFSET 0\n");
+			text.push_back("#define ATTRIBUTE attribute\n");
+			text.push_back("#define VARYING varying\n");
+			text.push_back("#define VARYING_FLAT varying\n");
 			// Need to enable extensions here instead of in the shader files,
 			// before any non-preprocessor directives (per spec)
-			text[count++] = strdup("#extension GL_ARB_texture_rectangle : enable\n");
-			text[count++] = strdup("#extension GL_ARB_shader_texture_lod : enable\n");
+			text.push_back("#extension GL_ARB_texture_rectangle : enable\n");
+			text.push_back("#extension GL_ARB_shader_texture_lod : enable\n");
 		}
 	}
 	else
@@ -635,54 +625,66 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 		if (major_version < 4)
 		{
 			//set version to 1.30
-			text[count++] = strdup("#version 130\n");
+			text.push_back("#version 130\n");
 			// Need to enable extensions here instead of in the shader files,
 			// before any non-preprocessor directives (per spec)
-			text[count++] = strdup("#extension GL_ARB_texture_rectangle : enable\n");
-			text[count++] = strdup("#extension GL_ARB_shader_texture_lod : enable\n");
+			text.push_back("#extension GL_ARB_texture_rectangle : enable\n");
+			text.push_back("#extension GL_ARB_shader_texture_lod : enable\n");
+			if (!mUniformBuffers.empty())
+			{ //uniform blocks are core from GLSL 1.40 on
+				text.push_back("#extension GL_ARB_uniform_buffer_object : enable\n");
+			}
 			
 
 			//some implementations of GLSL 1.30 require integer precision be explicitly declared
-			text[count++] = strdup("precision mediump int;\n");
-			text[count++] = strdup("precision highp float;\n");
+			text.push_back("precision mediump int;\n");
+			text.push_back("precision highp float;\n");
 		}
 		else
 		{ //set version to 400
-			text[count++] = strdup("#version 400\n");
+			text.push_back("#version 400\n");
 			// Need to enable extensions here instead of in the shader files,
 			// before any non-preprocessor directives (per spec)
-			text[count++] = strdup("#extension GL_ARB_texture_rectangle : enable\n");
-			text[count++] = strdup("#extension GL_ARB_shader_texture_lod : enable\n");
+			text.push_back("#extension GL_ARB_texture_rectangle : enable\n");
+			text.push_back("#extension GL_ARB_shader_texture_lod : enable\n");
 		}
 		
 
-		text[count++] = strdup("#define DEFINE_GL_FRAGCOLOR 1\n");
-		text[count++] = strdup("#define FXAA_GLSL_130 1\n");
+		text.push_back("#define DEFINE_GL_FRAGCOLOR 1\n");
+		text.push_back("#define FXAA_GLSL_130 1\n");
 
-		text[count++] = strdup("#define ATTRIBUTE in\n");
+		text.push_back("#define ATTRIBUTE in\n");
 
 		if (type == GL_VERTEX_SHADER_ARB)
 		{ //"varying" state is "out" in a vertex program, "in" in a fragment program 
 			// ("varying" is deprecated after version 1.20)
-			text[count++] = strdup("#define VARYING out\n");
-			text[count++] = strdup("#define VARYING_FLAT flat out\n");
+			text.push_back("#define VARYING out\n");
+			text.push_back("#define VARYING_FLAT flat out\n");
 		}
 		else
 		{
-			text[count++] = strdup("#define VARYING in\n");
-			text[count++] = strdup("#define VARYING_FLAT flat in\n");
+			text.push_back("#define VARYING in\n");
+			text.push_back("#define VARYING_FLAT flat in\n");
 		}
 
 		//backwards compatibility with legacy texture lookup syntax
-		text[count++] = strdup("#define texture2D texture\n");
-		text[count++] = strdup("#define textureCube texture\n");
-		text[count++] = strdup("#define texture2DLod textureLod\n");
-		text[count++] = strdup("#define	shadow2D(a,b) vec2(texture(a,b))\n");
+		text.push_back("#define texture2D texture\n");
+		text.push_back("#define textureCube texture\n");
+		text.push_back("#define texture2DLod textureLod\n");
+		text.push_back("#define	shadow2D(a,b) vec2(texture(a,b))\n");
 
 		if (major_version > 1 || minor_version >= 40)
 		{ //GLSL 1.40 replaces texture2DRect et al with texture
-			text[count++] = strdup("#define texture2DRect texture\n");
-			text[count++] = strdup("#define shadow2DRect(a,b) vec2(texture(a,b))\n");
+			text.push_back("#define texture2DRect texture\n");
+			text.push_back("#define shadow2DRect(a,b) vec2(texture(a,b))\n");
+		}
+	}
+
+	if (major_version > 1 || minor_version >= 30)
+	{
+		for (std::vector<LLUniformBuffer*>::iterator it = mUniformBuffers.begin(); it != mUniformBuffers.end(); ++it)
+		{
+			text.push_back("#define " + (*it)->getDefine() + " " + (*it)->getDeclaration() + "\n");
 		}
 	}
 
@@ -691,7 +693,7 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 		for (std::map<std::string,std::string>::iterator iter = defines->begin(); iter != defines->end(); ++iter)
 	{
 		std::string define = "#define " + iter->first + " " + iter->second + "\n";
-		text[count++] = (GLcharARB *) strdup(define.c_str());
+		text.push_back(define);
 	}
 	}
 
@@ -730,28 +732,28 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 		}
 		*/
 
-		text[count++] = strdup("#define HAS_DIFFUSE_LOOKUP 1\n");
+		text.push_back("#define HAS_DIFFUSE_LOOKUP 1\n");
 
 		//uniform declartion
 		for (S32 i = 0; i < texture_index_channels; ++i)
 		{
 			std::string decl = llformat("uniform sampler2D tex%d;\n", i);
-			text[count++] = strdup(decl.c_str());
+			text.push_back(decl);
 		}
 
 		if (texture_index_channels > 1)
 		{
-			text[count++] = strdup("VARYING_FLAT ivec4 vary_texture_index;\n");
+			text.push_back("VARYING_FLAT ivec4 vary_texture_index;\n");
 		}
 
-		text[count++] = strdup("vec4 diffuseLookup(vec2 texcoord)\n");
-		text[count++] = strdup("{\n");
+		text.push_back("vec4 diffuseLookup(vec2 texcoord)\n");
+		text.push_back("{\n");
 		
 		
 		if (texture_index_channels == 1)
 		{ //don't use flow control, that's silly
-			text[count++] = strdup("return texture2D(tex0, texcoord);\n");
-			text[count++] = strdup("}\n");
+			text.push_back("return texture2D(tex0, texcoord);\n");
+			text.push_back("}\n");
 		}
 		else if (major_version > 1 || minor_version >= 30)
 		{  //switches are supported in GLSL 1.30 and later
@@ -760,27 +762,27 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 				for (S32 i = 0; i < texture_index_channels; ++i)
 				{
 					std::string if_string = llformat("\t%sif (vary_texture_index.r == %d) { return texture2D(tex%d, texcoord); }\n", i > 0 ? "else " : "", i, i); 
-					text[count++] = strdup(if_string.c_str());
+					text.push_back(if_string);
 				}
-				text[count++] = strdup("\treturn vec4(1,0,1,1);\n");
-				text[count++] = strdup("}\n");
+				text.push_back("\treturn vec4(1,0,1,1);\n");
+				text.push_back("}\n");
 			}
 			else
 			{
-				text[count++] = strdup("\tvec4 ret = vec4(1,0,1,1);\n");
-				text[count++] = strdup("\tswitch (vary_texture_index.r)\n");
-				text[count++] = strdup("\t{\n");
+				text.push_back("\tvec4 ret = vec4(1,0,1,1);\n");
+				text.push_back("\tswitch (vary_texture_index.r)\n");
+				text.push_back("\t{\n");
 		
 				//switch body
 				for (S32 i = 0; i < texture_index_channels; ++i)
 				{
 					std::string case_str = llformat("\t\tcase %d: ret = texture2D(tex%d, texcoord); break;\n", i, i);
-					text[count++] = strdup(case_str.c_str());
+					text.push_back(case_str);
 				}
 
-				text[count++] = strdup("\t}\n");
-				text[count++] = strdup("\treturn ret;\n");
-				text[count++] = strdup("}\n");
+				text.push_back("\t}\n");
+				text.push_back("\treturn ret;\n");
+				text.push_back("}\n");
 			}
 		}
 		else
@@ -791,16 +793,67 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 	}
 	else
 	{
-		text[count++] = strdup("#define HAS_DIFFUSE_LOOKUP 0\n");
+		text.push_back("#define HAS_DIFFUSE_LOOKUP 0\n");
 	}
 
 	//copy file into memory
-	while( fgets((char *)buff, 1024, file) != NULL && count < LL_ARRAY_SIZE(text) ) 
+	while( fgets((char *)buff, 1024, file) != NULL ) 
 	{
-		text[count++] = (GLcharARB *)strdup((char *)buff); 
+		text.push_back((char *)buff);
 	}
 	fclose(file);
 
+	return gpu_class;
+}
+
+GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shader_level, GLenum type, std::map<std::string, std::string>* defines, S32 texture_index_channels)
+{
+	std::pair<std::multimap<std::string, CachedObjectInfo >::iterator, std::multimap<std::string, CachedObjectInfo>::iterator> range;
+	range = mShaderObjects.equal_range(filename);
+	for (std::multimap<std::string, CachedObjectInfo>::iterator it = range.first; it != range.second;++it)
+	{
+		if((*it).second.mLevel == shader_level && (*it).second.mType == type && (*it).second.mDefinitions == (defines ? *defines : std::map<std::string, std::string>()))
+		{
+			//LL_INFOS("ShaderLoading") << "Loading cached shader for " << filename << LL_ENDL;
+			return (*it).second.mHandle;
+		}
+	}
+
+	GLenum error = GL_NO_ERROR;
+	if (gDebugGL)
+	{
+		error = glGetError();
+		if (error != GL_NO_ERROR)
+		{
+			LL_WARNS("ShaderLoading") << "GL ERROR entering loadShaderFile(): " << error << LL_ENDL;
+		}
+	}
+
+	LL_DEBUGS("ShaderLoading") << "Loading shader file: " << filename << " class " << shader_level << LL_ENDL;
+
+	if (filename.empty()) 
+	{
+		return 0;
+	}
+
+	S32 try_gpu_class = shader_level;
+	std::vector<std::string> source;
+	S32 gpu_class = readShaderSource(filename, try_gpu_class, type, defines, texture_index_channels, source);
+	if (!gpu_class)
+	{
+		LL_WARNS("ShaderLoading") << "GLSL Shader file not found: " << filename << LL_ENDL;
+		return 0;
+	}
+	const std::string source_hash = hash_shader_source(source, gpu_class);
+	mSourceHashes[getSourceHashKey(filename, try_gpu_class, type, defines, texture_index_channels)] = source_hash;
+
+	std::vector<const GLcharARB*> text(source.size());
+	for (size_t i = 0; i < source.size(); ++i)
+	{
+		text[i] = source[i].c_str();
+	}
+	const GLuint count = (GLuint)text.size();
+
 	//create shader object
 	GLhandleARB ret = glCreateShaderObjectARB(type);
 	if (gDebugGL)
@@ -817,7 +870,7 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 	//load source
 	if(ret)
 	{
-		glShaderSourceARB(ret, count, (const GLcharARB**) text, NULL);
+		glShaderSourceARB(ret, count, (const GLcharARB**) &text[0], NULL);
 
 		if (gDebugGL)
 		{
@@ -850,7 +903,9 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 
 	std::string error_str;
 
-	if (error == GL_NO_ERROR)
+	// In a batch the status is left for endShaderBatch(); asking for it now would wait for the compile
+	const bool defer_status = isBatching() && !gDebugGL;
+	if (error == GL_NO_ERROR && !defer_status)
 	{
 		//check for errors
 		GLint success = GL_TRUE;
@@ -931,18 +986,26 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 	}
 	stop_glerror();
 
-	//free memory
-	for (GLuint i = 0; i < count; i++)
-	{
-		free(text[i]);
-	}
-
 	//successfully loaded, save results
 	if (ret)
 	{
 		// Add shader file to map
-		mShaderObjects.insert(make_pair(filename,CachedObjectInfo(ret,try_gpu_class,type,defines)));
+		mShaderObjects.insert(make_pair(filename,CachedObjectInfo(ret,try_gpu_class,type,defines,source_hash)));
 		shader_level = try_gpu_class;
+		if (defer_status)
+		{
+			PendingObject pending;
+			pending.mFilename = filename;
+			pending.mLevel = try_gpu_class;
+			pending.mType = type;
+			if (defines)
+			{
+				pending.mDefines = *defines;
+			}
+			pending.mTextureIndexChannels = texture_index_channels;
+			pending.mHandle = ret;
+			mPendingObjects.push_back(pending);
+		}
 	}
 	else
 	{
@@ -956,10 +1019,362 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 	return ret;
 }
 
+//static
+std::string LLShaderMgr::getSourceHashKey(const std::string& filename, S32 shader_level, GLenum type,
+										  std::map<std::string, std::string>* defines, S32 texture_index_channels)
+{
+	std::string key = llformat("%s|%d|%u|%d", filename.c_str(), shader_level, type, texture_index_channels);
+	if (defines)
+	{
+		for (std::map<std::string, std::string>::iterator iter = defines->begin(); iter != defines->end(); ++iter)
+		{
+			key += "|" + iter->first + "=" + iter->second;
+		}
+	}
+	return key;
+}
+
+std::string LLShaderMgr::getShaderSourceHash(const std::string& filename, S32 shader_level, GLenum type, std::map<std::string, std::string>* defines, S32 texture_index_channels)
+{
+	const std::string key = getSourceHashKey(filename, shader_level, type, defines, texture_index_channels);
+	std::map<std::string, std::string>::iterator it = mSourceHashes.find(key);
+	if (it != mSourceHashes.end())
+	{
+		return it->second;
+	}
+
+	std::vector<std::string> text;
+	S32 gpu_class = readShaderSource(filename, shader_level, type, defines, texture_index_channels, text);
+	if (!gpu_class)
+	{
+		return std::string();
+	}
+	const std::string hash = hash_shader_source(text, gpu_class);
+	mSourceHashes[key] = hash;
+	return hash;
+}
+
+//============================================================================
+// Program binary cache
+//
+// One <key>.bin per program in the cache directory, next to a driver.txt that
+// names the driver the binaries came from. A binary is only ever loaded for
+// the exact sources, defines and link inputs it was built from, and the driver
+// is free to reject it anyway, in which case the program is built as usual.
+
+// Darwin's legacy profile has no program binaries
+#if defined(GL_ARB_get_program_binary) && !LL_DARWIN
+#define LL_PROGRAM_BINARY 1
+#else
+#define LL_PROGRAM_BINARY 0
+#endif
+
+static const U32 PROGRAM_CACHE_MAGIC = 0x4253484C;	// "LHSB"
+static const U32 PROGRAM_CACHE_VERSION = 1;
+
+struct LLProgramCacheHeader
+{
+	U32 mMagic;
+	U32 mVersion;
+	U32 mFormat;		// Driver specific binary format
+	S32 mShaderLevel;	// What the shader's level ended up at when it was built
+	U32 mLength;		// Bytes of binary after the header
+};
+
+static std::string get_driver_stamp()
+{
+	return gGLManager.mGLVendor + "\n" + gGLManager.mGLRenderer + "\n" + gGLManager.mGLVersionString + "\n"
+		   + gGLManager.mDriverVersionVendorString + "\n";
+}
+
+std::string LLShaderMgr::getProgramCacheDir()
+{
+	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "shader_cache") + gDirUtilp->getDirDelimiter();
+}
+
+bool LLShaderMgr::useProgramCache()
+{
+	static const LLCachedControl<bool> use_cache("RenderShaderCache", true);
+	if (!LL_PROGRAM_BINARY || !use_cache || !gGLManager.mHasGetProgramBinary)
+	{
+		return false;
+	}
+
+	if (!mProgramCacheChecked)
+	{
+		mProgramCacheChecked = true;
+
+		// A new driver would reject every old binary one at a time; throw them out up front.
+		const std::string dir = getProgramCacheDir();
+		const std::string stamp_file = dir + "driver.txt";
+		const std::string stamp = get_driver_stamp();
+		std::string old_stamp;
+		LLFILE* file = LLFile::fopen(stamp_file, "rb");
+		if (file)
+		{
+			char buff[1024];
+			size_t length = fread(buff, 1, sizeof(buff), file);
+			old_stamp.assign(buff, length);
+			fclose(file);
+		}
+		if (old_stamp != stamp)
+		{
+			LLFile::mkdir(dir);
+			S32 count = gDirUtilp->deleteFilesInDir(dir, "*.bin");
+			if (count)
+			{
+				LL_INFOS("ShaderLoading") << "Driver changed, removed " << count << " cached shader programs" << LL_ENDL;
+			}
+			file = LLFile::fopen(stamp_file, "wb");
+			if (file)
+			{
+				fwrite(stamp.data(), 1, stamp.size(), file);
+				fclose(file);
+			}
+		}
+	}
+	return true;
+}
+
+std::string LLShaderMgr::getProgramCacheKey(LLGLSLShader* shader, S32 texture_index_channels, U32 varying_count, const char** varyings)
+{
+	LLMD5 md5;
+	md5.update(get_driver_stamp());
+	md5.update(llformat("GLSL %d.%d\n", gGLManager.mGLSLVersionMajor, gGLManager.mGLSLVersionMinor));
+
+	// The shader's own files, as loadShaderFile() would build them
+	for (std::vector<std::pair<std::string, GLenum> >::iterator it = shader->mShaderFiles.begin(); it != shader->mShaderFiles.end(); ++it)
+	{
+		std::string hash = getShaderSourceHash(it->first, shader->mShaderLevel, it->second, &shader->mDefines, texture_index_channels);
+		if (hash.empty())
+		{
+			return std::string();
+		}
+		md5.update(it->first + " " + hash + "\n");
+	}
+
+	// The shared objects attachShaderFeatures() put in, in attachment order
+	GLhandleARB objects[64];
+	GLsizei count = 0;
+	glGetAttachedObjectsARB(shader->mProgramObject, LL_ARRAY_SIZE(objects), &count, objects);
+	for (GLsizei i = 0; i < count; ++i)
+	{
+		std::multimap<std::string, CachedObjectInfo>::iterator it = mShaderObjects.begin();
+		for (; it != mShaderObjects.end(); ++it)
+		{
+			if (it->second.mHandle == objects[i])
+			{
+				break;
+			}
+		}
+		if (it == mShaderObjects.end() || it->second.mSourceHash.empty())
+		{
+			return std::string();
+		}
+		md5.update(it->first + " " + it->second.mSourceHash + "\n");
+	}
+
+	// Everything else that goes into the link
+	for (std::vector<std::string>::iterator it = mReservedAttribs.begin(); it != mReservedAttribs.end(); ++it)
+	{
+		md5.update("attribute " + *it + "\n");
+	}
+	for (U32 i = 0; varyings && i < varying_count; ++i)
+	{
+		md5.update(std::string("varying ") + varyings[i] + "\n");
+	}
+
+	md5.finalize();
+	char digest[33];
+	md5.hex_digest(digest);
+	return digest;
+}
+
+BOOL LLShaderMgr::loadCachedProgram(const std::string& key, GLhandleARB program, S32& shader_level)
+{
+#if LL_PROGRAM_BINARY
+	const std::string filename = getProgramCacheDir() + key + ".bin";
+	LLFILE* file = LLFile::fopen(filename, "rb");
+	if (!file)
+	{
+		++mProgramCacheMisses;
+		return FALSE;
+	}
+
+	LLProgramCacheHeader header;
+	std::vector<U8> binary;
+	bool valid = fread(&header, sizeof(header), 1, file) == 1
+				 && header.mMagic == PROGRAM_CACHE_MAGIC
+				 && header.mVersion == PROGRAM_CACHE_VERSION
+				 && header.mLength > 0;
+	if (valid)
+	{
+		binary.resize(header.mLength);
+		valid = fread(&binary[0], 1, header.mLength, file) == header.mLength;
+	}
+	fclose(file);
+
+	GLint success = GL_FALSE;
+	if (valid)
+	{
+		glProgramBinary(program, header.mFormat, &binary[0], header.mLength);
+		glGetObjectParameterivARB(program, GL_OBJECT_LINK_STATUS_ARB, &success);
+	}
+	if (success != GL_TRUE)
+	{
+		// Truncated, or from a driver build the stamp did not tell apart
+		LL_INFOS("ShaderLoading") << "Discarding unusable cached shader program " << key << LL_ENDL;
+		LLFile::remove(filename);
+		++mProgramCacheMisses;
+		return FALSE;
+	}
+
+	shader_level = header.mShaderLevel;
+	++mProgramCacheHits;
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+void LLShaderMgr::prepareCachedProgram(GLhandleARB program)
+{
+#if LL_PROGRAM_BINARY
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+}
+
+void LLShaderMgr::saveCachedProgram(const std::string& key, GLhandleARB program, S32 shader_level)
+{
+#if LL_PROGRAM_BINARY
+	GLint length = 0;
+	glGetObjectParameterivARB(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	LLProgramCacheHeader header;
+	header.mMagic = PROGRAM_CACHE_MAGIC;
+	header.mVersion = PROGRAM_CACHE_VERSION;
+	header.mShaderLevel = shader_level;
+	std::vector<U8> binary(length);
+	GLsizei written = 0;
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &written, &format, &binary[0]);
+	if (written <= 0)
+	{
+		return;
+	}
+	header.mFormat = format;
+	header.mLength = written;
+
+	// Write under a temporary name so that a crash never leaves half a binary behind
+	const std::string filename = getProgramCacheDir() + key + ".bin";
+	const std::string temp_name = filename + ".tmp";
+	LLFILE* file = LLFile::fopen(temp_name, "wb");
+	if (!file)
+	{
+		return;
+	}
+	bool written_ok = fwrite(&header, sizeof(header), 1, file) == 1
+					  && fwrite(&binary[0], 1, written, file) == (size_t)written;
+	fclose(file);
+	if (!written_ok || LLFile::rename(temp_name, filename) != 0)
+	{
+		LLFile::remove(temp_name);
+	}
+#endif
+}
+
+void LLShaderMgr::resetProgramCacheStats()
+{
+	mProgramCacheHits = 0;
+	mProgramCacheMisses = 0;
+}
+
+void LLShaderMgr::logProgramCacheStats()
+{
+	if (mProgramCacheHits || mProgramCacheMisses)
+	{
+		LL_INFOS("ShaderLoading") << "Shader program cache: " << mProgramCacheHits << " loaded, "
+								  << mProgramCacheMisses << " built" << LL_ENDL;
+	}
+}
+
+void LLShaderMgr::beginShaderBatch()
+{
+	llassert(!mBatching);
+	mBatching = true;
+}
+
+BOOL LLShaderMgr::endShaderBatch()
+{
+	llassert(mBatching);
+	mBatching = false;
+	BOOL success = TRUE;
+
+	// Shader objects first. One that failed is compiled again the usual way, which
+	// also tries the lower classes; programs that used it relink below.
+	std::vector<PendingObject> objects;
+	objects.swap(mPendingObjects);
+	for (std::vector<PendingObject>::iterator it = objects.begin(); it != objects.end(); ++it)
+	{
+		GLint compiled = GL_TRUE;
+		glGetObjectParameterivARB(it->mHandle, GL_OBJECT_COMPILE_STATUS_ARB, &compiled);
+		if (compiled == GL_TRUE)
+		{
+			dumpObjectLog(it->mHandle, FALSE);
+			continue;
+		}
+
+		for (std::multimap<std::string, CachedObjectInfo>::iterator obj = mShaderObjects.begin(); obj != mShaderObjects.end(); ++obj)
+		{
+			if (obj->second.mHandle == it->mHandle)
+			{
+				mShaderObjects.erase(obj);
+				break;
+			}
+		}
+		glDeleteObjectARB(it->mHandle);
+
+		S32 level = it->mLevel;
+		if (!loadShaderFile(it->mFilename, level, it->mType, &it->mDefines, it->mTextureIndexChannels))
+		{
+			success = FALSE;
+		}
+	}
+
+	std::vector<LLGLSLShader*> shaders;
+	shaders.swap(mPendingShaders);
+	for (std::vector<LLGLSLShader*>::iterator it = shaders.begin(); it != shaders.end(); ++it)
+	{
+		LLGLSLShader* shader = *it;
+		if (shader->isPending())
+		{
+			if (!shader->finishShader())
+			{
+				success = FALSE;
+			}
+		}
+		else if (!shader->mProgramObject)
+		{ //finished early, see LLGLSLShader::bind()
+			success = FALSE;
+		}
+	}
+
+	return success;
+}
+
 BOOL LLShaderMgr::linkProgramObject(GLhandleARB obj, BOOL suppress_errors) 
 {
-	//check for errors
 	glLinkProgramARB(obj);
+	return checkProgramLinked(obj, suppress_errors);
+}
+
+BOOL LLShaderMgr::checkProgramLinked(GLhandleARB obj, BOOL suppress_errors)
+{
+	//check for errors
 	GLint success = GL_TRUE;
 	glGetObjectParameterivARB(obj, GL_OBJECT_LINK_STATUS_ARB, &success);
 	if (!suppress_errors && success == GL_FALSE) 
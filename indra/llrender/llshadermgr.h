@@ -30,6 +30,8 @@
 #include "llgl.h"
 #include "llglslshader.h"
 
+class LLUniformBuffer;
+
 class LLShaderMgr
 {
 public:
@@ -230,8 +232,38 @@ DISPLAY_GAMMA,
 	BOOL attachShaderFeatures(LLGLSLShader * shader);
 	void dumpObjectLog(GLhandleARB ret, BOOL warns = TRUE);
 	BOOL	linkProgramObject(GLhandleARB obj, BOOL suppress_errors = FALSE);
+	// The status half of linkProgramObject(), for programs that were linked earlier
+	BOOL	checkProgramLinked(GLhandleARB obj, BOOL suppress_errors = FALSE);
 	BOOL	validateProgramObject(GLhandleARB obj);
 	GLhandleARB loadShaderFile(const std::string& filename, S32 & shader_level, GLenum type, std::map<std::string, std::string>* defines = NULL, S32 texture_index_channels = -1);
+	// Hash of the source loadShaderFile() would compile, empty if the file is missing.
+	std::string getShaderSourceHash(const std::string& filename, S32 shader_level, GLenum type, std::map<std::string, std::string>* defines = NULL, S32 texture_index_channels = -1);
+
+	// On disk cache of linked program binaries (GL_ARB_get_program_binary).
+	// The key covers the driver, the preprocessed source of every shader object
+	// in the program and everything else that goes into the link.
+	bool useProgramCache();
+	// texture_index_channels is what the shader's own files get compiled with.
+	std::string getProgramCacheKey(LLGLSLShader* shader, S32 texture_index_channels, U32 varying_count, const char** varyings);
+	BOOL loadCachedProgram(const std::string& key, GLhandleARB program, S32& shader_level);
+	// Before linking a program that is going to be saved
+	void prepareCachedProgram(GLhandleARB program);
+	void saveCachedProgram(const std::string& key, GLhandleARB program, S32 shader_level);
+	void resetProgramCacheStats();
+	void logProgramCacheStats();
+
+	// Between these two, loadShaderFile() and LLGLSLShader::createShader() only
+	// start compiling and linking, without waiting for the driver, and report
+	// success. endShaderBatch() then collects every result, rebuilding anything
+	// that failed the usual way, and returns FALSE if something still failed.
+	// Drivers that compile in the background (KHR_parallel_shader_compile, or
+	// threaded drivers in general) get to work on the whole batch at once.
+	void beginShaderBatch();
+	BOOL endShaderBatch();
+	// True while results may be left for endShaderBatch() to collect
+	bool isBatching() const { return mBatching && !mFinishing; }
+	void addPendingShader(LLGLSLShader* shader) { mPendingShaders.push_back(shader); }
+	U32 getProgramCount() const { return mProgramCount; }
 
 	// Implemented in the application to actually point to the shader directory.
 	virtual std::string getShaderDirPrefix(void) = 0; // Pure Virtual
@@ -239,15 +271,24 @@ DISPLAY_GAMMA,
 	// Implemented in the application to actually update out of date uniforms for a particular shader
 	virtual void updateShaderUniforms(LLGLSLShader * shader) = 0; // Pure Virtual
 
+private:
+	// Everything that gets compiled for filename, one string per line
+	S32 readShaderSource(const std::string& filename, S32 shader_level, GLenum type, std::map<std::string, std::string>* defines,
+						 S32 texture_index_channels, std::vector<std::string>& text);
+	static std::string getSourceHashKey(const std::string& filename, S32 shader_level, GLenum type,
+										std::map<std::string, std::string>* defines, S32 texture_index_channels);
+	std::string getProgramCacheDir();
+
 public:
 	struct CachedObjectInfo
 	{
-		CachedObjectInfo(GLhandleARB handle, U32 level, GLenum type, std::map<std::string,std::string> *definitions) : 
-			mHandle(handle), mLevel(level), mType(type), mDefinitions(definitions ? *definitions : std::map<std::string,std::string>()){}
+		CachedObjectInfo(GLhandleARB handle, U32 level, GLenum type, std::map<std::string,std::string> *definitions, const std::string& source_hash) : 
+			mHandle(handle), mLevel(level), mType(type), mDefinitions(definitions ? *definitions : std::map<std::string,std::string>()), mSourceHash(source_hash){}
 		GLhandleARB mHandle;	//Actual handle of the opengl shader object.
 		U32 mLevel;				//Level /might/ not be needed, but it's stored to ensure there's no change in behavior.
 		GLenum mType;			//GL_VERTEX_SHADER_ARB or GL_FRAGMENT_SHADER_ARB. Tracked because some utility shaders can be loaded as both types (carefully).
 		std::map<std::string,std::string> mDefinitions;
+		std::string mSourceHash;	//MD5 of the source that was compiled, for the program binary cache.
 	};
 	// Map of shader names to compiled
 	std::multimap<std::string, CachedObjectInfo > mShaderObjects;	//Singu Note: Packing more info here. Doing such provides capability to skip unneeded duplicate loading..
@@ -260,6 +301,32 @@ public:
 	//preprocessor definitions (name/value)
 	std::map<std::string, std::string> mDefinitions;
 
+	// Source hashes by getSourceHashKey(). Cleared with mShaderObjects, so that edited files get picked up.
+	std::map<std::string, std::string> mSourceHashes;
+
+	U32 mProgramCacheHits;
+	U32 mProgramCacheMisses;
+	bool mProgramCacheChecked;	// Driver stamp of the cache directory checked
+
+	// Shader batches
+	struct PendingObject
+	{
+		std::string mFilename;
+		S32 mLevel;
+		GLenum mType;
+		std::map<std::string, std::string> mDefines;
+		S32 mTextureIndexChannels;
+		GLhandleARB mHandle;
+	};
+	std::vector<PendingObject> mPendingObjects;
+	std::vector<LLGLSLShader*> mPendingShaders;
+	bool mBatching;
+	bool mFinishing;		// Set by LLGLSLShader while it waits for its own results
+	U32 mProgramCount;		// Programs submitted, for the load time report
+
+	// Uniform blocks that shader files may declare, see LLUniformBuffer. Not owned.
+	std::vector<LLUniformBuffer*> mUniformBuffers;
+
 protected:
 
 	// our parameter manager singleton instance
@@ -32,7 +32,10 @@
 #include "linden_common.h"
 #include "lltexture.h"
 
+#include "llrender.h"
+
 //virtual 
 LLTexture::~LLTexture()
 {
+	gGL.forgetTexture(this);
 }
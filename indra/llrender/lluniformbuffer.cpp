@@ -0,0 +1,168 @@
+/**
+ * @file lluniformbuffer.cpp
+ * @brief Uniform block shared by every program that declares it
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lluniformbuffer.h"
+
+#include "llformat.h"
+
+// Darwin's legacy profile has no uniform buffers, and GLhandleARB is not a GLuint there
+#if defined(GL_ARB_uniform_buffer_object) && !LL_DARWIN
+#define LL_UNIFORM_BUFFER 1
+#else
+#define LL_UNIFORM_BUFFER 0
+#endif
+
+U32 LLUniformBuffer::sUploadCount = 0;
+
+LLUniformBuffer::LLUniformBuffer(const std::string& block_name, const std::string& define, U32 binding)
+:	mBlockName(block_name),
+	mDefine(define),
+	mBinding(binding),
+	mBuffer(0),
+	mDirty(true)
+{
+}
+
+LLUniformBuffer::~LLUniformBuffer()
+{
+	// The GL context is usually gone by now; destroyGL() is the place to free the buffer.
+	llassert(!mBuffer);
+}
+
+void LLUniformBuffer::addVec4(const std::string& name)
+{
+	addMember(name, 4, 4);
+}
+
+void LLUniformBuffer::addFloat(const std::string& name)
+{
+	addMember(name, 1, 1);
+}
+
+void LLUniformBuffer::addMember(const std::string& name, U32 components, U32 alignment)
+{
+	llassert(!mBuffer);
+	// std140: scalars align to themselves, vec4s to 16 bytes
+	U32 offset = (U32)mData.size();
+	offset = (offset + alignment - 1) / alignment * alignment;
+	mMembers.push_back(Member(name, offset, components));
+	mData.resize(offset + components, 0.f);
+
+	std::string members;
+	for (std::vector<Member>::const_iterator it = mMembers.begin(); it != mMembers.end(); ++it)
+	{
+		members += llformat(" %s %s;", it->mComponents == 4 ? "vec4" : "float", it->mName.String().c_str());
+	}
+	mDeclaration = "layout(std140) uniform " + mBlockName + " {" + members + " };";
+}
+
+S32 LLUniformBuffer::findMember(const LLStaticHashedString& name) const
+{
+	for (U32 i = 0; i < mMembers.size(); ++i)
+	{
+		if (mMembers[i].mName.Hash() == name.Hash() && mMembers[i].mName == name)
+		{
+			return (S32)i;
+		}
+	}
+	return -1;
+}
+
+bool LLUniformBuffer::set(const LLStaticHashedString& name, const F32* value)
+{
+	S32 index = findMember(name);
+	if (index < 0)
+	{
+		return false;
+	}
+
+	const Member& member = mMembers[index];
+	F32* data = &mData[member.mOffset];
+	if (memcmp(data, value, member.mComponents * sizeof(F32)))
+	{
+		memcpy(data, value, member.mComponents * sizeof(F32));
+		mDirty = true;
+	}
+	return true;
+}
+
+void LLUniformBuffer::update()
+{
+#if LL_UNIFORM_BUFFER
+	if (!gGLManager.mHasUniformBufferObject || mData.empty() || (!mDirty && mBuffer))
+	{
+		return;
+	}
+
+	// Block sizes are whole vec4s
+	const U32 size = ((U32)mData.size() * sizeof(F32) + 15) & ~15;
+	if (!mBuffer)
+	{
+		mData.resize(size / sizeof(F32), 0.f);
+		glGenBuffersARB(1, &mBuffer);
+		glBindBufferARB(GL_UNIFORM_BUFFER, mBuffer);
+		glBufferDataARB(GL_UNIFORM_BUFFER, size, &mData[0], GL_DYNAMIC_DRAW_ARB);
+	}
+	else
+	{
+		glBindBufferARB(GL_UNIFORM_BUFFER, mBuffer);
+		glBufferSubDataARB(GL_UNIFORM_BUFFER, 0, size, &mData[0]);
+	}
+	glBindBufferARB(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, mBinding, mBuffer);
+	mDirty = false;
+	++sUploadCount;
+#endif
+}
+
+void LLUniformBuffer::bindProgram(GLhandleARB program) const
+{
+#if LL_UNIFORM_BUFFER
+	if (!gGLManager.mHasUniformBufferObject || !program)
+	{
+		return;
+	}
+	GLuint index = glGetUniformBlockIndex(program, mBlockName.c_str());
+	if (index != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(program, index, mBinding);
+	}
+#endif
+}
+
+void LLUniformBuffer::destroyGL()
+{
+#if LL_UNIFORM_BUFFER
+	if (mBuffer)
+	{
+		glDeleteBuffersARB(1, &mBuffer);
+		mBuffer = 0;
+	}
+#endif
+	mDirty = true;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file lluniformbuffer.h
+ * @brief Uniform block shared by every program that declares it
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLUNIFORMBUFFER_H
+#define LL_LLUNIFORMBUFFER_H
+
+#include <vector>
+
+#include "llgl.h"
+#include "llstaticstringtable.h"
+
+//
+// A std140 uniform block (GL_ARB_uniform_buffer_object) for values that are
+// the same in every program, such as the windlight sky. The values are kept
+// on the CPU and sent to the GPU in one upload when they changed, instead of
+// to every program that uses them on its next bind.
+//
+// Shader files opt in per declaration:
+//
+//	#ifdef <define>
+//	<define>
+//	#else
+//	uniform vec4 ...;
+//	#endif
+//
+// LLShaderMgr defines <define> as the block declaration for every buffer in
+// LLShaderMgr::mUniformBuffers, and binds the block of every program it maps.
+//
+class LLUniformBuffer
+{
+public:
+	LLUniformBuffer(const std::string& block_name, const std::string& define, U32 binding);
+	~LLUniformBuffer();
+
+	// Members in declaration order; the std140 offsets follow from it.
+	void addVec4(const std::string& name);
+	void addFloat(const std::string& name);
+
+	bool has(const LLStaticHashedString& name) const { return findMember(name) >= 0; }
+	// Copies the member's components; false if there is no such member.
+	bool set(const LLStaticHashedString& name, const F32* value);
+
+	// Sends the values to the GPU if they changed. Main thread, once per frame.
+	void update();
+	// Points program's block, if it declares one, at this buffer.
+	void bindProgram(GLhandleARB program) const;
+	void destroyGL();
+
+	const std::string& getDefine() const { return mDefine; }
+	// The GLSL declaration, on one line so that it fits in a #define
+	const std::string& getDeclaration() const { return mDeclaration; }
+
+	// Buffer uploads, for the render debug info
+	static U32 sUploadCount;
+
+private:
+	struct Member
+	{
+		LLStaticHashedString mName;
+		U32 mOffset;		// In floats
+		U32 mComponents;
+
+		Member(const std::string& name, U32 offset, U32 components)
+		:	mName(name), mOffset(offset), mComponents(components) {}
+	};
+
+	void addMember(const std::string& name, U32 components, U32 alignment);
+	S32 findMember(const LLStaticHashedString& name) const;
+
+	std::string mBlockName;
+	std::string mDefine;
+	std::string mDeclaration;
+	U32 mBinding;
+	std::vector<Member> mMembers;
+	std::vector<F32> mData;		// std140 image of the block
+	GLuint mBuffer;
+	bool mDirty;
+};
+
+#endif // LL_LLUNIFORMBUFFER_H
@@ -741,6 +741,78 @@ void LLVertexBuffer::drawRange(U32 mode, U32 start, U32 end, U32 count, U32 indi
 	placeFence();
 }
 
+void LLVertexBuffer::drawMultiRange(U32 mode, const DrawRange* ranges, U32 range_count) const
+{
+	if (!range_count)
+	{
+		return;
+	}
+
+	for (U32 i = 0; i < range_count; ++i)
+	{
+		validateRange(ranges[i].mStart, ranges[i].mEnd, ranges[i].mCount, ranges[i].mOffset);
+	}
+	mMappable = false;
+	gGL.syncMatrices();
+
+	llassert(mNumVerts >= 0);
+	llassert(!LLGLSLShader::sNoFixedFunction || LLGLSLShader::sCurBoundShaderPtr != NULL);
+
+	if (mGLArray)
+	{
+		if (mGLArray != sGLRenderArray)
+		{
+			LL_ERRS() << "Wrong vertex array bound." << LL_ENDL;
+		}
+	}
+	else
+	{
+		if (mGLIndices != sGLRenderIndices)
+		{
+			LL_ERRS() << "Wrong index buffer bound." << LL_ENDL;
+		}
+
+		if (mGLBuffer != sGLRenderBuffer)
+		{
+			LL_ERRS() << "Wrong vertex buffer bound." << LL_ENDL;
+		}
+	}
+
+	if (mode >= LLRender::NUM_MODES)
+	{
+		LL_ERRS() << "Invalid draw mode: " << mode << LL_ENDL;
+		return;
+	}
+
+	U16* idx = (U16*) getIndicesPointer();
+
+	stop_glerror();
+	if (gGLManager.mHasMultiDrawArrays && range_count > 1)
+	{
+		// Only ever touched from the render thread
+		static std::vector<GLsizei> counts;
+		static std::vector<const GLvoid*> offsets;
+		counts.resize(range_count);
+		offsets.resize(range_count);
+		for (U32 i = 0; i < range_count; ++i)
+		{
+			counts[i] = ranges[i].mCount;
+			offsets[i] = idx + ranges[i].mOffset;
+		}
+		glMultiDrawElementsEXT(sGLMode[mode], &counts[0], GL_UNSIGNED_SHORT, &offsets[0], range_count);
+	}
+	else
+	{
+		for (U32 i = 0; i < range_count; ++i)
+		{
+			glDrawRangeElements(sGLMode[mode], ranges[i].mStart, ranges[i].mEnd, ranges[i].mCount, GL_UNSIGNED_SHORT,
+				idx + ranges[i].mOffset);
+		}
+	}
+	stop_glerror();
+	placeFence();
+}
+
 void LLVertexBuffer::draw(U32 mode, U32 count, U32 indices_offset) const
 {
 	llassert(!LLGLSLShader::sNoFixedFunction || LLGLSLShader::sCurBoundShaderPtr != NULL);
@@ -282,6 +282,18 @@ public:
 	void drawArrays(U32 mode, U32 offset, U32 count) const;
 	void drawRange(U32 mode, U32 start, U32 end, U32 count, U32 indices_offset) const;
 
+	// One drawRange() call's worth of indices
+	struct DrawRange
+	{
+		U32 mStart;
+		U32 mEnd;
+		U32 mCount;
+		U32 mOffset;
+	};
+	// Draws several index ranges with a single glMultiDrawElements, or one
+	// glDrawRangeElements each without GL_EXT_multi_draw_arrays.
+	void drawMultiRange(U32 mode, const DrawRange* ranges, U32 range_count) const;
+
 	//for debugging, validate data in given range is valid
 	void validateRange(U32 start, U32 end, U32 count, U32 offset) const;
 
@@ -370,6 +370,7 @@ BOOL LLComboBox::setSimple(const LLStringExplicit& name)
 // virtual
 void LLComboBox::setValue(const LLSD& value)
 {
+	invalidateDraw();
 	BOOL found = mList->selectByValue(value);
 	if (found)
 	{
@@ -371,17 +371,89 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
 
 	seg_list->push_back( new LLTextSegment( LLColor3(defaultColor), 0, text_len ) ); 
 
+	findSegmentsFrom(*seg_list, wtext, defaultColor, 0, NULL, 0, 0);
+}
+
+S32 LLKeywords::updateSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLWString& wtext, const LLColor4 &defaultColor, S32 start, S32 end, S32 delta)
+{
+	S32 text_len = wtext.size();
+	if( !text_len || seg_list->empty() || seg_list->front()->getStart() != 0 || seg_list->back()->getEnd() != text_len - delta )
+	{
+		findSegments(seg_list, wtext, defaultColor);
+		return text_len;
+	}
+
+	// The text before start did not change, nor did its segments.
+	S32 restart = llclamp(start, 0, text_len);
+	while( restart > 0 )
+	{
+		while( restart > 0 && wtext[restart - 1] != '\n' )
+		{
+			restart--;
+		}
+		LLTextSegment pos_segment(restart);
+		std::vector<LLTextSegmentPtr>::iterator iter = std::upper_bound(seg_list->begin(), seg_list->end(), &pos_segment, LLTextSegment::compare());
+		LLTextSegment* segment = *(--iter);
+		if( !segment->getToken() || segment->getStart() >= restart )
+		{
+			break;
+		}
+		// A comment or a string goes on from an earlier line
+		restart = segment->getStart();
+	}
+
+	std::vector<LLTextSegmentPtr> old_list;
+	old_list.swap(*seg_list);
+	for (std::vector<LLTextSegmentPtr>::iterator iter = old_list.begin();
+		 iter != old_list.end() && (*iter)->getStart() < restart; ++iter)
+	{
+		seg_list->push_back(*iter);
+	}
+	// The plain text before restart now runs to the end, as in findSegments(). It is a new
+	// segment, since the old one may be needed by appendOldSegments().
+	if( seg_list->empty() )
+	{
+		// The edit is on the first line: tokenize from the start, but still stop where
+		// the old segments are back in step.
+		seg_list->push_back( new LLTextSegment( LLColor3(defaultColor), 0, text_len ) );
+	}
+	else
+	{
+		LLTextSegmentPtr last = seg_list->back();
+		if( last->getToken() )
+		{
+			findSegments(seg_list, wtext, defaultColor);
+			return text_len;
+		}
+		seg_list->back() = new LLTextSegment( last->getStyle(), last->getStart(), text_len );
+	}
+
+	LLFastTimer ft(FTM_SYNTAX_COLORING);
+	return findSegmentsFrom(*seg_list, wtext, defaultColor, restart, &old_list, end + 1, delta);
+}
+
+S32 LLKeywords::findSegmentsFrom(std::vector<LLTextSegmentPtr>& seg_list, const LLWString& wtext, const LLColor4 &defaultColor, S32 start,
+								 std::vector<LLTextSegmentPtr>* old_list, S32 sync_from, S32 delta)
+{
+	S32 text_len = wtext.size();
+
 	const llwchar* base = wtext.c_str();
-	const llwchar* cur = base;
+	const llwchar* cur = base + start;
 	//const llwchar* line = NULL;
 
 	while( *cur )
 	{
-		if( *cur == '\n' || cur == base )
+		if( *cur == '\n' || cur == base + start )
 		{
 			if( *cur == '\n' )
 			{
 				cur++;
+				if( old_list && (cur - base) >= sync_from && *cur &&
+					appendOldSegments(seg_list, *old_list, cur - base, delta) )
+				{
+					// The rest of the text is as before, and so are its segments.
+					return cur - base;
+				}
 				if( !*cur || *cur == '\n' )
 				{
 					continue;
@@ -422,7 +494,7 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
 						
 						LLTextSegmentPtr text_segment = new LLTextSegment( cur_token->getColor(), seg_start, seg_end );
 						text_segment->setToken( cur_token );
-						insertSegment( *seg_list, text_segment, text_len, defaultColor);
+						insertSegment( seg_list, text_segment, text_len, defaultColor);
 						line_done = TRUE; // to break out of second loop.
 						break;
 					}
@@ -532,7 +604,7 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
 
 					LLTextSegmentPtr text_segment = new LLTextSegment( cur_delimiter->getColor(), seg_start, seg_end );
 					text_segment->setToken( cur_delimiter );
-					insertSegment( *seg_list, text_segment, text_len, defaultColor);
+					insertSegment( seg_list, text_segment, text_len, defaultColor);
 
 					// Note: we don't increment cur, since the end of one delimited seg may be immediately
 					// followed by the start of another one.
@@ -565,7 +637,7 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
 
 						LLTextSegmentPtr text_segment = new LLTextSegment( cur_token->getColor(), seg_start, seg_end );
 						text_segment->setToken( cur_token );
-						insertSegment( *seg_list, text_segment, text_len, defaultColor);
+						insertSegment( seg_list, text_segment, text_len, defaultColor);
 					}
 					cur += seg_len; 
 					continue;
@@ -578,6 +650,46 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
 			}
 		}
 	}
+	return text_len;
+}
+
+// Ends seg_list, which is at the start of a line of plain text at pos, with the old segments
+// from there, if the old text was at the start of a line of plain text there as well.
+bool LLKeywords::appendOldSegments(std::vector<LLTextSegmentPtr>& seg_list, std::vector<LLTextSegmentPtr>& old_list, S32 pos, S32 delta)
+{
+	LLTextSegment old_pos(pos - delta);
+	std::vector<LLTextSegmentPtr>::iterator iter = std::upper_bound(old_list.begin(), old_list.end(), &old_pos, LLTextSegment::compare());
+	if( iter == old_list.begin() )
+	{
+		return false;
+	}
+	LLTextSegment* old_segment = *(--iter);
+	LLTextSegment* last = seg_list.back();
+	if( last->getToken() || old_segment->getEnd() <= old_pos.getStart() ||
+		(old_segment->getToken() && old_segment->getStart() < old_pos.getStart()) )
+	{
+		// The old text was in a comment or a string there
+		return false;
+	}
+
+	if( old_segment->getToken() )
+	{
+		last->setEnd( pos );
+	}
+	else
+	{
+		// Plain text on both sides is one segment, as findSegments() makes it
+		last->setEnd( old_segment->getEnd() + delta );
+		++iter;
+	}
+	for ( ; iter != old_list.end(); ++iter)
+	{
+		LLTextSegment* segment = *iter;
+		segment->setStart( segment->getStart() + delta );
+		segment->setEnd( segment->getEnd() + delta );
+		seg_list.push_back( segment );
+	}
+	return true;
 }
 
 void LLKeywords::insertSegment(std::vector<LLTextSegmentPtr>& seg_list, LLTextSegmentPtr new_segment, S32 text_len, const LLColor4 &defaultColor )
@@ -108,6 +108,12 @@ public:
 	BOOL		isLoaded() const	{ return mLoaded; }
 
 	void		findSegments(std::vector<LLTextSegmentPtr> *seg_list, const LLWString& text, const LLColor4 &defaultColor );
+	// Brings seg_list, the segments of the text before an edit, up to date with text. The edit
+	// changed the text from start to end of the new text, and its length by delta. Tokenizing
+	// restarts at the beginning of the line that holds start, or before it when a comment or a
+	// string spans that line, and stops at the first line past end where it is back in step with
+	// the old segments; they are kept from there. Returns where, or the length of text.
+	S32			updateSegments(std::vector<LLTextSegmentPtr> *seg_list, const LLWString& text, const LLColor4 &defaultColor, S32 start, S32 end, S32 delta);
 
 	// Add the token as described
 	void addToken(LLKeywordToken::TOKEN_TYPE type,
@@ -153,6 +159,9 @@ public:
 private:
 	LLColor3	readColor(const std::string& s);
 	void		insertSegment(std::vector<LLTextSegmentPtr>& seg_list, LLTextSegmentPtr new_segment, S32 text_len, const LLColor4 &defaultColor);
+	S32			findSegmentsFrom(std::vector<LLTextSegmentPtr>& seg_list, const LLWString& wtext, const LLColor4 &defaultColor, S32 start,
+								 std::vector<LLTextSegmentPtr>* old_list, S32 sync_from, S32 delta);
+	bool		appendOldSegments(std::vector<LLTextSegmentPtr>& seg_list, std::vector<LLTextSegmentPtr>& old_list, S32 pos, S32 delta);
 
 	BOOL		mLoaded;
 	word_token_map_t mWordTokenMap;
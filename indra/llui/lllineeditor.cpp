@@ -358,6 +358,7 @@ void LLLineEditor::setText(const LLStringExplicit &new_text)
 	}
 
 	mPrevText = mText;
+	invalidateDraw();
 }
 
 
@@ -27,6 +27,7 @@
 #include "lllocalcliprect.h"
 
 #include "llfontgl.h"
+#include "llrenderdrawlist.h"
 #include "llui.h"
 
 /*static*/ std::stack<LLRect> LLScreenClipRect::sClipRectStack;
@@ -50,6 +51,12 @@ LLScreenClipRect::~LLScreenClipRect()
 	{
 		popClipRect();
 		updateScissorRegion();
+		if (sClipRectStack.empty() && gGL.getDrawList())
+		{
+			// mScissorState disables the test as it goes.
+			gGL.flush();
+			gGL.getDrawList()->addScissor(false, 0, 0, 0, 0);
+		}
 	}
 }
 
@@ -94,6 +101,10 @@ void LLScreenClipRect::updateScissorRegion()
 	h = llmax(0, llceil(rect.getHeight() * LLUI::getScaleFactor().mV[VY])) + 1;
 	glScissor( x,y,w,h );
 	stop_glerror();
+	if (gGL.getDrawList())
+	{
+		gGL.getDrawList()->addScissor(true, x, y, w, h);
+	}
 }
 
 //---------------------------------------------------------------------------
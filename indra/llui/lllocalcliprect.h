@@ -41,10 +41,14 @@ public:
 	LLScreenClipRect(const LLRect& rect, BOOL enabled = TRUE);
 	virtual ~LLScreenClipRect();
 
+	// Sets the scissor rectangle to the innermost clip rect again.
+	static void updateScissorRegion();
+	// The innermost clip rect, in screen coordinates; null when there is none.
+	static LLRect getClipRect() { return sClipRectStack.empty() ? LLRect::null : sClipRectStack.top(); }
+
 private:
 	static void pushClipRect(const LLRect& rect);
 	static void popClipRect();
-	static void updateScissorRegion();
 
 private:
 	LLGLState		mScissorState;
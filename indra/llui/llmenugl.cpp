@@ -208,6 +208,7 @@ LLXMLNodePtr LLMenuItemGL::getXML(bool save_children) const
 void LLMenuItemGL::setValue(const LLSD& value)
 {
 	setLabel(value.asString());
+	invalidateDraw();
 }
 
 //virtual
@@ -1076,6 +1077,7 @@ void LLMenuItemCheckGL::setValue(const LLSD& value)
 	{
 		mDrawBoolLabel.clear();
 	}
+	invalidateDraw();
 }
 
 void LLMenuItemCheckGL::setCheckedControl(std::string checked_control, LLView *context)
@@ -164,6 +164,7 @@ void LLMultiSlider::setSliderValue(const std::string& name, F32 value, BOOL from
 	S32 x = left_edge + S32( t * (right_edge - left_edge) );
 	mThumbRects[name].mLeft = x - (mThumbWidth/2);
 	mThumbRects[name].mRight = x + (mThumbWidth/2);
+	invalidateDraw();
 }
 
 void LLMultiSlider::setValue(const LLSD& value)
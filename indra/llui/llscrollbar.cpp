@@ -165,6 +165,8 @@ bool LLScrollbar::setDocPos(S32 pos, BOOL update_thumb)
 	{
 		mDocPos = pos;
 		mDocChanged = TRUE;
+		// Scrolls what this bar is in as well.
+		invalidateDraw();
 
 		if( mChangeCallback )
 		{
@@ -67,7 +67,7 @@ public:
 
 	void setScrolledView(LLView* view) { mScrolledView = view; }
 
-	virtual void setValue(const LLSD& value) { mInnerRect.setValue(value); }
+	virtual void setValue(const LLSD& value) { mInnerRect.setValue(value); invalidateDraw(); }
 
 	void			setBorderVisible( BOOL b );
 	void			setPassBackToChildren(bool b) { mPassBackToChildren = b; }
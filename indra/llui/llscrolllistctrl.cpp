@@ -134,6 +134,7 @@ LLScrollListCtrl::LLScrollListCtrl(const std::string& name, const LLRect& rect,
 	mHighlightedItem(-1),
 	mBorder(NULL),
 	mSortCallback(NULL),
+	mModel(NULL),
 	mPopupMenu(NULL),
 	mCommentTextView(NULL),
 	mNumDynamicWidthColumns(0),
@@ -228,6 +229,7 @@ LLScrollListCtrl::~LLScrollListCtrl()
 {
 	delete mSortCallback;
 
+	clearRowItems();
 	std::for_each(mItemList.begin(), mItemList.end(), DeletePointer());
 	std::for_each(mColumns.begin(), mColumns.end(), DeletePairedPointer());
 }
@@ -244,11 +246,21 @@ BOOL LLScrollListCtrl::setMaxItemCount(S32 max_count)
 
 S32 LLScrollListCtrl::isEmpty() const
 {
+	if (mModel)
+	{
+		updateSort();
+		return mRowIndex.empty();
+	}
 	return mItemList.empty();
 }
 
 S32 LLScrollListCtrl::getItemCount() const
 {
+	if (mModel)
+	{
+		updateSort();
+		return mRowIndex.size();
+	}
 	return mItemList.size();
 }
 
@@ -276,6 +288,13 @@ LLScrollListItem* LLScrollListCtrl::getFirstSelected() const
 		return NULL;
 	}
 
+	if (mModel)
+	{
+		std::vector<U32> rows = getSelectedRows();
+		// conceptually const, like updateSort()
+		return rows.empty() ? NULL : const_cast<LLScrollListCtrl*>(this)->getRowItem(rows.front());
+	}
+
 	item_list::const_iterator iter;
 	for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
 	{
@@ -297,6 +316,16 @@ std::vector<LLScrollListItem*> LLScrollListCtrl::getAllSelected() const
 		return ret;
 	}
 
+	if (mModel)
+	{
+		std::vector<U32> rows = getSelectedRows();
+		for (std::vector<U32>::iterator it = rows.begin(); it != rows.end(); ++it)
+		{
+			ret.push_back(const_cast<LLScrollListCtrl*>(this)->getRowItem(*it));
+		}
+		return ret;
+	}
+
 	item_list::const_iterator iter;
 	for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
 	{
@@ -313,6 +342,16 @@ uuid_vec_t LLScrollListCtrl::getSelectedIDs()
 {
 	LLUUID selected_id;
 	uuid_vec_t ids;
+	if (mModel)
+	{
+		// without building the selected rows
+		std::vector<U32> rows = getCanSelect() ? getSelectedRows() : std::vector<U32>();
+		for (std::vector<U32>::iterator it = rows.begin(); it != rows.end(); ++it)
+		{
+			ids.push_back(mModel->getRowValue(*it).asUUID());
+		}
+		return ids;
+	}
 	std::vector<LLScrollListItem*> selected = this->getAllSelected();
 	for(std::vector<LLScrollListItem*>::iterator itr = selected.begin(); itr != selected.end(); ++itr)
 	{
@@ -328,6 +367,11 @@ S32 LLScrollListCtrl::getNumSelected() const
 		return 0;
 	}
 
+	if (mModel)
+	{
+		return getSelectedRows().size();
+	}
+
 	S32 numSelected = 0;
 
 	for(item_list::const_iterator iter = mItemList.begin(); iter != mItemList.end(); ++iter)
@@ -354,6 +398,20 @@ S32 LLScrollListCtrl::getFirstSelectedIndex() const
 	// make sure sort is up to date before returning an index
 	updateSort();
 
+	if (mModel)
+	{
+		S32 first_index = -1;
+		for (std::set<U32>::const_iterator it = mSelectedRows.begin(); it != mSelectedRows.end(); ++it)
+		{
+			S32 index = mRowIndex.getIndex(*it);
+			if (index >= 0 && (first_index < 0 || index < first_index))
+			{
+				first_index = index;
+			}
+		}
+		return first_index;
+	}
+
 	item_list::const_iterator iter;
 	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 	{
@@ -459,6 +517,8 @@ void LLScrollListCtrl::updateLayout()
 	mScrollbar->setVisible(scrollbar_visible);
 
 	dirtyColumns();
+	// Rows came or went
+	invalidateDraw();
 }
 
 // Attempt to size the control to show all items.
@@ -711,16 +771,24 @@ void LLScrollListCtrl::updateColumns()
 		item_list::iterator iter;
 		for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 		{
-			LLScrollListItem *itemp = *iter;
-			S32 num_cols = itemp->getNumColumns();
-			S32 i = 0;
-			for (LLScrollListCell* cell = itemp->getColumn(i); i < num_cols; cell = itemp->getColumn(++i))
-			{
-				if (i >= (S32)mColumnsIndexed.size()) break;
-
-				cell->setWidth(mColumnsIndexed[i]->getWidth());
-			}
+			setCellWidths(*iter);
 		}
+		for (row_item_map_t::iterator it = mRowItems.begin(); it != mRowItems.end(); ++it)
+		{
+			setCellWidths(it->second);
+		}
+	}
+}
+
+void LLScrollListCtrl::setCellWidths(LLScrollListItem* itemp)
+{
+	S32 num_cols = itemp->getNumColumns();
+	S32 i = 0;
+	for (LLScrollListCell* cell = itemp->getColumn(i); i < num_cols; cell = itemp->getColumn(++i))
+	{
+		if (i >= (S32)mColumnsIndexed.size()) break;
+
+		cell->setWidth(mColumnsIndexed[i]->getWidth());
 	}
 }
 
@@ -742,6 +810,34 @@ BOOL LLScrollListCtrl::selectFirstItem()
 {
 	BOOL success = FALSE;
 
+	if (mModel)
+	{
+		if (!isEmpty() && mModel->isRowEnabled(mRowIndex.getRow(0)))
+		{
+			U32 first_row = mRowIndex.getRow(0);
+			std::set<U32> selected = mSelectedRows;
+			for (std::set<U32>::iterator it = selected.begin(); it != selected.end(); ++it)
+			{
+				if (*it != first_row)
+				{
+					setRowSelected(*it, false);
+				}
+			}
+			selectItem(getRowItem(first_row), FALSE);
+			success = TRUE;
+			mOriginalSelection = 0;
+		}
+		else
+		{
+			deselectAllItems(TRUE);
+		}
+		if (mCommitOnSelectionChange)
+		{
+			commitIfChanged();
+		}
+		return success;
+	}
+
 	// our $%&@#$()^%#$()*^ iterators don't let us check against the first item inside out iteration
 	BOOL first_item = TRUE;
 
@@ -781,7 +877,7 @@ BOOL LLScrollListCtrl::selectNthItem( S32 target_index )
 // virtual
 BOOL LLScrollListCtrl::selectItemRange( S32 first_index, S32 last_index )
 {
-	if (mItemList.empty())
+	if (isEmpty())
 	{
 		return FALSE;
 	}
@@ -789,7 +885,7 @@ BOOL LLScrollListCtrl::selectItemRange( S32 first_index, S32 last_index )
 	// make sure sort is up to date
 	updateSort();
 
-	S32 listlen = (S32)mItemList.size();
+	S32 listlen = getItemCount();
 	first_index = llclamp(first_index, 0, listlen-1);
 	
 	if (last_index < 0)
@@ -798,6 +894,20 @@ BOOL LLScrollListCtrl::selectItemRange( S32 first_index, S32 last_index )
 		last_index = llclamp(last_index, first_index, listlen-1);
 
 	BOOL success = FALSE;
+	if (mModel)
+	{
+		deselectAllItems(TRUE);
+		for (S32 index = first_index; index <= last_index; ++index)
+		{
+			U32 row = mRowIndex.getRow(index);
+			if (mModel->isRowEnabled(row))
+			{
+				setRowSelected(row, true);
+				success = TRUE;
+			}
+		}
+	}
+
 	S32 index = 0;
 	for (item_list::iterator iter = mItemList.begin(); iter != mItemList.end(); )
 	{
@@ -980,6 +1090,12 @@ S32 LLScrollListCtrl::getItemIndex( LLScrollListItem* target_item ) const
 {
 	updateSort();
 
+	if (mModel)
+	{
+		S32 row = getItemRow(target_item);
+		return row < 0 ? -1 : mRowIndex.getIndex(row);
+	}
+
 	S32 index = 0;
 	item_list::const_iterator iter;
 	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
@@ -998,6 +1114,18 @@ S32 LLScrollListCtrl::getItemIndex( const LLUUID& target_id ) const
 {
 	updateSort();
 
+	if (mModel)
+	{
+		for (U32 index = 0; index < mRowIndex.size(); ++index)
+		{
+			if (mModel->getRowValue(mRowIndex.getRow(index)).asUUID() == target_id)
+			{
+				return index;
+			}
+		}
+		return -1;
+	}
+
 	S32 index = 0;
 	item_list::const_iterator iter;
 	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
@@ -1021,6 +1149,23 @@ void LLScrollListCtrl::selectPrevItem( BOOL extend_selection)
 		// select last item
 		selectNthItem(getItemCount() - 1);
 	}
+	else if (mModel)
+	{
+		S32 index = getFirstSelectedIndex() - 1;
+		// don't allow navigation to disabled elements
+		while (index >= 0 && !mModel->isRowEnabled(mRowIndex.getRow(index)))
+		{
+			--index;
+		}
+		if (index >= 0)
+		{
+			selectItem(getItemAt(index), !extend_selection);
+		}
+		else
+		{
+			reportInvalidInput();
+		}
+	}
 	else
 	{
 		updateSort();
@@ -1065,6 +1210,24 @@ void LLScrollListCtrl::selectNextItem( BOOL extend_selection)
 	{
 		selectFirstItem();
 	}
+	else if (mModel)
+	{
+		std::vector<U32> rows = getSelectedRows();
+		S32 index = mRowIndex.getIndex(rows.back()) + 1;
+		// don't allow navigation to disabled items
+		while (index < (S32)mRowIndex.size() && !mModel->isRowEnabled(mRowIndex.getRow(index)))
+		{
+			++index;
+		}
+		if (index < (S32)mRowIndex.size())
+		{
+			selectItem(getItemAt(index), !extend_selection);
+		}
+		else
+		{
+			reportInvalidInput();
+		}
+	}
 	else
 	{
 		updateSort();
@@ -1111,6 +1274,19 @@ void LLScrollListCtrl::deselectAllItems(BOOL no_commit_on_change)
 		deselectItem(item);
 	}
 
+	if (mModel)
+	{
+		for (row_item_map_t::iterator it = mRowItems.begin(); it != mRowItems.end(); ++it)
+		{
+			deselectItem(it->second);
+		}
+		// rows that aren't built as items
+		while (!mSelectedRows.empty())
+		{
+			setRowSelected(*mSelectedRows.begin(), false);
+		}
+	}
+
 	if (mCommitOnSelectionChange && !no_commit_on_change)
 	{
 		commitIfChanged();
@@ -1315,6 +1491,28 @@ BOOL LLScrollListCtrl::setSelectedByValue(const LLSD& value, BOOL selected)
 
 	if (selected && !mAllowMultipleSelection) deselectAllItems(TRUE);
 
+	if (mModel)
+	{
+		updateSort();
+		for (U32 index = 0; index < mRowIndex.size(); ++index)
+		{
+			U32 row = mRowIndex.getRow(index);
+			if (mModel->isRowEnabled(row) && mModel->getRowValue(row).asString() == value.asString())
+			{
+				if (selected)
+				{
+					selectItem(getRowItem(row));
+				}
+				else
+				{
+					setRowSelected(row, false);
+				}
+				found = TRUE;
+				break;
+			}
+		}
+	}
+
 	item_list::iterator iter;
 	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 	{
@@ -1344,6 +1542,18 @@ BOOL LLScrollListCtrl::setSelectedByValue(const LLSD& value, BOOL selected)
 
 BOOL LLScrollListCtrl::isSelected(const LLSD& value) const 
 {
+	if (mModel)
+	{
+		for (std::set<U32>::const_iterator it = mSelectedRows.begin(); it != mSelectedRows.end(); ++it)
+		{
+			if (mModel->getRowValue(*it).asString() == value.asString())
+			{
+				return TRUE;
+			}
+		}
+		return FALSE;
+	}
+
 	item_list::const_iterator iter;
 	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 	{
@@ -1406,16 +1616,22 @@ void LLScrollListCtrl::drawItems()
 		highlight_color.mV[VALPHA] = clamp_rescale(mSearchTimer.getElapsedTimeF32(), type_ahead_timeout * 0.7f, type_ahead_timeout, 0.4f, 0.f);
 
 		S32 first_line = mScrollLines;
-		S32 last_line = llmin((S32)mItemList.size() - 1, mScrollLines + getLinesPerPage());
+		S32 item_count = getItemCount();
 
-		if ((item_list::size_type)first_line >= mItemList.size())
+		if (first_line >= item_count)
 		{
 			return;
 		}
-		item_list::iterator iter;
+		if (mModel && !mLineHeight)
+		{
+			// the line height comes from the items; build one before counting the lines on a page
+			getItemAt(first_line);
+		}
+		S32 last_line = llmin(item_count - 1, mScrollLines + getLinesPerPage());
+
 		for (S32 line = first_line; line <= last_line; line++)
 		{
-			LLScrollListItem* item = mItemList[line];
+			LLScrollListItem* item = getItemAt(line);
 			
 			item_rect.setOriginAndSize( 
 				x, 
@@ -1461,6 +1677,11 @@ void LLScrollListCtrl::drawItems()
 				cur_y -= mLineHeight;
 			}
 		}
+
+		if (mModel)
+		{
+			pruneRowItems(first_line, last_line);
+		}
 	}
 }
 
@@ -1472,6 +1693,12 @@ void LLScrollListCtrl::draw()
 	// if user specifies sort, make sure it is maintained
 	updateSort();
 
+	if (mModel && mScrollbar->getDocSize() != getItemCount())
+	{
+		// the model added, removed or filtered rows
+		updateLayout();
+	}
+
 	if (mNeedsScroll)
 	{
 		scrollToShowSelected();
@@ -1488,7 +1715,7 @@ void LLScrollListCtrl::draw()
 
 	updateColumns();
 
-	getChildView("comment_text")->setVisible(mItemList.empty());
+	getChildView("comment_text")->setVisible(isEmpty());
 
 	drawItems();
 
@@ -1593,10 +1820,36 @@ BOOL LLScrollListCtrl::selectItemAt(S32 x, S32 y, MASK mask)
 		{
 			if (mask & MASK_SHIFT)
 			{
-				if (mLastSelected == NULL)
+				if (mLastSelected == NULL || (mModel && getItemIndex(mLastSelected) < 0))
 				{
 					selectItem(hit_item);
 				}
+				else if (mModel)
+				{
+					// Select everthing between mLastSelected and hit_item, which stays the anchor
+					S32 from = getItemIndex(mLastSelected);
+					S32 to = getItemIndex(hit_item);
+					if (from > to)
+					{
+						std::swap(from, to);
+					}
+					for (S32 index = from; index <= to; ++index)
+					{
+						if (mMaxSelectable > 0 && mSelectedRows.size() >= mMaxSelectable)
+						{
+							if (mOnMaximumSelectCallback)
+							{
+								mOnMaximumSelectCallback();
+							}
+							break;
+						}
+						U32 row = mRowIndex.getRow(index);
+						if (mModel->isRowEnabled(row))
+						{
+							setRowSelected(row, true);
+						}
+					}
+				}
 				else
 				{
 					// Select everthing between mLastSelected and hit_item
@@ -1608,7 +1861,7 @@ BOOL LLScrollListCtrl::selectItemAt(S32 x, S32 y, MASK mask)
 					LLScrollListItem* lastSelected = mLastSelected;
 					for (itor = mItemList.begin(); itor != mItemList.end(); ++itor)
 					{
-						if(mMaxSelectable > 0 && getAllSelected().size() >= mMaxSelectable)
+						if(mMaxSelectable > 0 && (U32)getNumSelected() >= mMaxSelectable)
 						{
 							if(mOnMaximumSelectCallback)
 							{
@@ -1642,7 +1895,7 @@ BOOL LLScrollListCtrl::selectItemAt(S32 x, S32 y, MASK mask)
 				}
 				else
 				{
-					if(!(mMaxSelectable > 0 && getAllSelected().size() >= mMaxSelectable))
+					if(!(mMaxSelectable > 0 && (U32)getNumSelected() >= mMaxSelectable))
 					{
 						selectItem(hit_item, FALSE);
 					}
@@ -1828,39 +2081,25 @@ BOOL LLScrollListCtrl::handleClick(S32 x, S32 y, MASK mask)
 LLScrollListItem* LLScrollListCtrl::hitItem( S32 x, S32 y )
 {
 	// Excludes disabled items.
-	LLScrollListItem* hit_item = NULL;
-
 	updateSort();
 
-	LLRect item_rect;
-	item_rect.setLeftTopAndSize( 
-		mItemListRect.mLeft,
-		mItemListRect.mTop,
-		mItemListRect.getWidth(),
-		mLineHeight );
-
-	// allow for partial line at bottom
-	S32 num_page_lines = getLinesPerPage();
-
-	S32 line = 0;
-	item_list::iterator iter;
-	for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
+	if (mLineHeight <= 0
+		|| x < mItemListRect.mLeft || x >= mItemListRect.mRight
+		|| y >= mItemListRect.mTop)
 	{
-		LLScrollListItem* item  = *iter;
-		if( mScrollLines <= line && line < mScrollLines + num_page_lines )
-		{
-			if( item->getEnabled() && item_rect.pointInRect( x, y ) )
-			{
-				hit_item = item;
-				break;
-			}
+		return NULL;
+	}
 
-			item_rect.translate(0, -mLineHeight);
-		}
-		line++;
+	// lines are drawn from the top of the list down, starting at mScrollLines
+	S32 page_line = (mItemListRect.mTop - 1 - y) / mLineHeight;
+	S32 line = mScrollLines + page_line;
+	if (page_line >= getLinesPerPage() || line >= getItemCount())
+	{
+		return NULL;
 	}
 
-	return hit_item;
+	LLScrollListItem* hit_item = getItemAt(line);
+	return hit_item && hit_item->getEnabled() ? hit_item : NULL;
 }
 
 S32 LLScrollListCtrl::getColumnIndexFromOffset(S32 x)
@@ -2225,6 +2464,16 @@ void LLScrollListCtrl::selectItem(LLScrollListItem* itemp, BOOL select_single_it
 		itemp->setSelected(TRUE);
 		mLastSelected = itemp;
 		mSelectionChanged = true;
+		invalidateDraw();
+
+		if (mModel)
+		{
+			S32 row = getItemRow(itemp);
+			if (row >= 0)
+			{
+				mSelectedRows.insert(row);
+			}
+		}
 	}
 }
 
@@ -2246,6 +2495,16 @@ void LLScrollListCtrl::deselectItem(LLScrollListItem* itemp)
 			cellp->highlightText(0, 0);	
 		}
 		mSelectionChanged = true;
+		invalidateDraw();
+
+		if (mModel)
+		{
+			S32 row = getItemRow(itemp);
+			if (row >= 0)
+			{
+				mSelectedRows.erase(row);
+			}
+		}
 	}
 }
 
@@ -2337,6 +2596,18 @@ void  LLScrollListCtrl::sortByColumnIndex(U32 column, BOOL ascending)
 
 void LLScrollListCtrl::updateSort() const
 {
+	if (mModel)
+	{
+		// only rows that were added or changed since the last update get placed
+		if (!isSorted())
+		{
+			mRowIndex.resort();
+			mSorted = true;
+		}
+		mRowIndex.update();
+		return;
+	}
+
 	if (hasSortOrder() && !isSorted())
 	{
 		// do stable sort to preserve any previous sorts
@@ -2411,7 +2682,7 @@ void LLScrollListCtrl::scrollToShowSelected()
 		return;
 	}
 
-	LLScrollListItem* item = mItemList[index];
+	LLScrollListItem* item = getItemAt(index);
 	if (!item)
 	{
 		// I don't THINK this should ever happen.
@@ -2763,6 +3034,19 @@ BOOL	LLScrollListCtrl::canCut() const
 // virtual
 void	LLScrollListCtrl::selectAll()
 {
+	if (mModel)
+	{
+		updateSort();
+		for (U32 index = 0; index < mRowIndex.size(); ++index)
+		{
+			U32 row = mRowIndex.getRow(index);
+			if (mModel->isRowEnabled(row))
+			{
+				setRowSelected(row, true);
+			}
+		}
+	}
+
 	// Deselects all other items
 	item_list::iterator iter;
 	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
@@ -2783,7 +3067,7 @@ void	LLScrollListCtrl::selectAll()
 // virtual
 BOOL	LLScrollListCtrl::canSelectAll() const
 {
-	return getCanSelect() && mAllowMultipleSelection && !(mMaxSelectable > 0 && mItemList.size() > mMaxSelectable);
+	return getCanSelect() && mAllowMultipleSelection && !(mMaxSelectable > 0 && (U32)getItemCount() > mMaxSelectable);
 }
 
 // virtual
@@ -3039,6 +3323,14 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
 {
 	LLFastTimer _(FTM_ADD_SCROLLLIST_ELEMENT);
 	if (!item_p.validateBlock() || !new_item) return NULL;
+	initRow(new_item, item_p);
+	addItem(new_item, pos);
+	return new_item;
+}
+
+// Makes the cells of new_item, and any columns it needs
+void LLScrollListCtrl::initRow(LLScrollListItem* new_item, const LLScrollListItem::Params& item_p)
+{
 	new_item->setNumColumns(mColumns.size());
 
 	// Add any columns we don't already have
@@ -3139,9 +3431,291 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
 			new_item->setColumn(column_idx, new LLScrollListSpacer(cell_p));
 		}
 	}
+}
 
-	addItem(new_item, pos);
-	return new_item;
+void LLScrollListCtrl::setCell(LLScrollListItem* item, const LLScrollListCell::Params& cell)
+{
+	const std::string& column = cell.column;
+	LLScrollListColumn* columnp = getColumn(column);
+	if (!item || !columnp)
+	{
+		return;
+	}
+
+	LLScrollListCell::Params cell_p = cell;
+	if (!cell_p.width.isProvided())
+	{
+		cell_p.width = columnp->getWidth();
+	}
+	cell_p.font_halign = columnp->mFontAlignment;
+
+	if (LLScrollListCell* new_cell = LLScrollListCell::create(cell_p))
+	{
+		item->setColumn(columnp->mIndex, new_cell);
+		setNeedsSortColumn(columnp->mIndex);
+	}
+}
+
+namespace
+{
+	// Moves the rows at or after first by offset.
+	void renumber_rows(std::set<U32>& rows, U32 first, S32 offset)
+	{
+		std::set<U32> renumbered;
+		for (std::set<U32>::const_iterator it = rows.begin(); it != rows.end(); ++it)
+		{
+			renumbered.insert(*it >= first ? *it + offset : *it);
+		}
+		rows.swap(renumbered);
+	}
+
+	template<typename T>
+	void renumber_rows(std::map<U32, T>& rows, U32 first, S32 offset)
+	{
+		std::map<U32, T> renumbered;
+		for (typename std::map<U32, T>::const_iterator it = rows.begin(); it != rows.end(); ++it)
+		{
+			renumbered[it->first >= first ? it->first + offset : it->first] = it->second;
+		}
+		rows.swap(renumbered);
+	}
+}
+
+void LLScrollListCtrl::setModel(LLScrollListModel* model)
+{
+	mModelConnection.disconnect();
+	clearRowItems();
+	mSelectedRows.clear();
+	mHighlightedItem = -1;
+
+	mModel = model;
+	if (mModel)
+	{
+		mModelConnection = mModel->setChangedCallback(boost::bind(&LLScrollListCtrl::onModelChanged, this, _1, _2, _3));
+		mRowIndex.setCompare(boost::bind(&LLScrollListCtrl::compareRows, this, _1, _2));
+		mRowIndex.reset(mModel->getRowCount());
+	}
+	else
+	{
+		mRowIndex.reset(0);
+	}
+
+	setScrollPos(0);
+	updateLayout();
+}
+
+void LLScrollListCtrl::setRowFilter(const LLSortedIndex::filter_t& filter)
+{
+	mRowIndex.setFilter(filter);
+}
+
+void LLScrollListCtrl::refilter()
+{
+	mRowIndex.refilter();
+}
+
+std::vector<U32> LLScrollListCtrl::getSelectedRows() const
+{
+	updateSort();
+
+	std::vector<std::pair<S32, U32> > selected;
+	for (std::set<U32>::const_iterator it = mSelectedRows.begin(); it != mSelectedRows.end(); ++it)
+	{
+		S32 index = mRowIndex.getIndex(*it);
+		if (index >= 0)
+		{
+			selected.push_back(std::make_pair(index, *it));
+		}
+	}
+	std::sort(selected.begin(), selected.end());
+
+	std::vector<U32> rows;
+	rows.reserve(selected.size());
+	for (std::vector<std::pair<S32, U32> >::const_iterator it = selected.begin(); it != selected.end(); ++it)
+	{
+		rows.push_back(it->second);
+	}
+	return rows;
+}
+
+void LLScrollListCtrl::onModelChanged(LLScrollListModel::EChange change, U32 first, U32 count)
+{
+	switch (change)
+	{
+	case LLScrollListModel::ROWS_INSERTED:
+		renumber_rows(mRowItems, first, count);
+		renumber_rows(mSelectedRows, first, count);
+		mRowIndex.insertRows(first, count);
+		break;
+
+	case LLScrollListModel::ROWS_REMOVED:
+		for (U32 row = first; row < first + count; ++row)
+		{
+			row_item_map_t::iterator it = mRowItems.find(row);
+			if (it != mRowItems.end())
+			{
+				if (it->second == mLastSelected)
+				{
+					mLastSelected = NULL;
+				}
+				delete it->second;
+				mRowItems.erase(it);
+			}
+			if (mSelectedRows.erase(row))
+			{
+				mSelectionChanged = true;
+			}
+		}
+		renumber_rows(mRowItems, first + count, -(S32)count);
+		renumber_rows(mSelectedRows, first + count, -(S32)count);
+		mRowIndex.removeRows(first, count);
+		break;
+
+	case LLScrollListModel::ROWS_CHANGED:
+		for (U32 row = first; row < first + count; ++row)
+		{
+			// rebuild the rows that are shown
+			row_item_map_t::iterator it = mRowItems.find(row);
+			if (it != mRowItems.end())
+			{
+				bool last_selected = it->second == mLastSelected;
+				delete it->second;
+				mRowItems.erase(it);
+				LLScrollListItem* itemp = getRowItem(row);
+				if (last_selected)
+				{
+					mLastSelected = itemp;
+				}
+			}
+			mRowIndex.rowChanged(row);
+		}
+		break;
+
+	case LLScrollListModel::MODEL_RESET:
+		clearRowItems();
+		if (!mSelectedRows.empty())
+		{
+			mSelectedRows.clear();
+			mSelectionChanged = true;
+		}
+		mRowIndex.reset(mModel->getRowCount());
+		break;
+	}
+	invalidateDraw();
+}
+
+// Like SortScrollListItem, for model rows
+S32 LLScrollListCtrl::compareRows(U32 lhs, U32 rhs) const
+{
+	for (std::vector<sort_column_t>::const_reverse_iterator it = mSortColumns.rbegin(); it != mSortColumns.rend(); ++it)
+	{
+		S32 order = mModel->compareRows(lhs, rhs, it->first);
+		if (order)
+		{
+			return it->second ? order : -order;
+		}
+	}
+	return 0;
+}
+
+LLScrollListItem* LLScrollListCtrl::getItemAt(S32 index)
+{
+	return mModel ? getRowItem(mRowIndex.getRow(index)) : mItemList[index];
+}
+
+LLScrollListItem* LLScrollListCtrl::getRowItem(U32 row)
+{
+	row_item_map_t::iterator it = mRowItems.find(row);
+	if (it != mRowItems.end())
+	{
+		return it->second;
+	}
+
+	LLScrollListItem::Params item_p;
+	mModel->getRow(row, item_p);
+	LLScrollListItem* itemp = new LLScrollListItem(item_p);
+	initRow(itemp, item_p);
+	itemp->setSelected(mSelectedRows.count(row) > 0);
+	mRowItems[row] = itemp;
+
+	S32 line_height = mLineHeight;
+	updateLineHeightInsert(itemp);
+	if (mLineHeight != line_height)
+	{
+		updateLayout();
+	}
+	return itemp;
+}
+
+S32 LLScrollListCtrl::getItemRow(const LLScrollListItem* itemp) const
+{
+	for (row_item_map_t::const_iterator it = mRowItems.begin(); it != mRowItems.end(); ++it)
+	{
+		if (it->second == itemp)
+		{
+			return it->first;
+		}
+	}
+	return -1;
+}
+
+void LLScrollListCtrl::setRowSelected(U32 row, bool selected)
+{
+	if (selected == (mSelectedRows.count(row) > 0))
+	{
+		return;
+	}
+
+	if (selected)
+	{
+		mSelectedRows.insert(row);
+	}
+	else
+	{
+		mSelectedRows.erase(row);
+	}
+
+	row_item_map_t::iterator it = mRowItems.find(row);
+	if (it != mRowItems.end())
+	{
+		it->second->setSelected(selected);
+		if (!selected && it->second == mLastSelected)
+		{
+			mLastSelected = NULL;
+		}
+	}
+	mSelectionChanged = true;
+}
+
+void LLScrollListCtrl::clearRowItems()
+{
+	for (row_item_map_t::iterator it = mRowItems.begin(); it != mRowItems.end(); ++it)
+	{
+		if (it->second == mLastSelected)
+		{
+			mLastSelected = NULL;
+		}
+		delete it->second;
+	}
+	mRowItems.clear();
+}
+
+// Deletes the items of the rows that scrolled out of view. The selection anchor stays.
+void LLScrollListCtrl::pruneRowItems(S32 first_index, S32 last_index)
+{
+	for (row_item_map_t::iterator it = mRowItems.begin(); it != mRowItems.end(); )
+	{
+		S32 index = mRowIndex.getIndex(it->first);
+		if ((index < first_index || index > last_index) && it->second != mLastSelected)
+		{
+			delete it->second;
+			mRowItems.erase(it++);
+		}
+		else
+		{
+			++it;
+		}
+	}
 }
 
 LLScrollListItem* LLScrollListCtrl::addSimpleElement(const std::string& value, EAddPosition pos, const LLSD& id)
@@ -31,6 +31,8 @@
 
 #include <vector>
 #include <deque>
+#include <map>
+#include <set>
 
 #include "lluictrl.h"
 #include "llctrlselectioninterface.h"
@@ -40,10 +42,12 @@
 #include "llstring.h"	// LLWString
 #include "lleditmenuhandler.h"
 #include "llframetimer.h"
+#include "llsortedindex.h"
 
 #include "llscrollbar.h"
 #include "llscrolllistitem.h"
 #include "llscrolllistcolumn.h"
+#include "llscrolllistmodel.h"
 
 class LLMenuGL;
 
@@ -111,6 +115,21 @@ public:
 	virtual LLScrollListItem* addElement(const LLSD& element, EAddPosition pos = ADD_BOTTOM, void* userdata = NULL);
 	virtual LLScrollListItem* addRow(LLScrollListItem *new_item, const LLScrollListItem::Params& value, EAddPosition pos = ADD_BOTTOM);
 	virtual LLScrollListItem* addRow(const LLScrollListItem::Params& value, EAddPosition pos = ADD_BOTTOM);
+	// Replaces the cell of an existing row in cell.column, the way addRow() makes it.
+	void setCell(LLScrollListItem* item, const LLScrollListCell::Params& cell);
+
+	// Virtualized mode: the rows come from model, which the list does not own,
+	// and only the rows that are shown are built as items. Functions that walk
+	// every item, like getAllData() or selectMultiple(), only see items added
+	// with addRow(). Setting NULL goes back to those.
+	void setModel(LLScrollListModel* model);
+	LLScrollListModel* getModel() const { return mModel; }
+	// Hides the model rows for which filter returns false. Call refilter()
+	// when its answer changes; hidden rows keep their selection.
+	void setRowFilter(const LLSortedIndex::filter_t& filter);
+	void refilter();
+	// Selected model rows that are shown, in list order
+	std::vector<U32> getSelectedRows() const;
 	// Simple add element. Takes a single array of:
 	// [ "value" => value, "font" => font, "font-style" => style ]
 	virtual void clearRows(); // clears all elements
@@ -397,6 +416,19 @@ private:
 	void			selectPrevItem(BOOL extend_selection);
 	void			selectNextItem(BOOL extend_selection);
 	void			drawItems();
+	void			initRow(LLScrollListItem* new_item, const LLScrollListItem::Params& item_p);
+	void			setCellWidths(LLScrollListItem* itemp);
+
+	// Virtualized mode
+	void			onModelChanged(LLScrollListModel::EChange change, U32 first, U32 count);
+	S32				compareRows(U32 lhs, U32 rhs) const;
+	// Item at index in list order, in either mode; builds it if needed
+	LLScrollListItem* getItemAt(S32 index);
+	LLScrollListItem* getRowItem(U32 row);
+	S32				getItemRow(const LLScrollListItem* itemp) const;
+	void			setRowSelected(U32 row, bool selected);
+	void			clearRowItems();
+	void			pruneRowItems(S32 first_index, S32 last_index);
 
 	void            updateLineHeightInsert(LLScrollListItem* item);
 	void			reportInvalidInput();
@@ -481,6 +513,14 @@ private:
 	std::vector<sort_column_t>	mSortColumns;
 
 	sort_signal_t*	mSortCallback;
+
+	LLScrollListModel* mModel;
+	boost::signals2::scoped_connection mModelConnection;
+	mutable LLSortedIndex mRowIndex;		// Model rows in list order
+
+	typedef std::map<U32, LLScrollListItem*> row_item_map_t;
+	row_item_map_t	mRowItems;				// Model rows built as items
+	std::set<U32>	mSelectedRows;
 }; // end class LLScrollListCtrl
 
 #endif  // LL_SCROLLLISTCTRL_H
@@ -0,0 +1,85 @@
+/**
+ * @file llscrolllistmodel.h
+ * @brief Rows of a virtualized LLScrollListCtrl
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLSCROLLLISTMODEL_H
+#define LL_LLSCROLLLISTMODEL_H
+
+#include <boost/signals2.hpp>
+
+#include "llscrolllistitem.h"
+
+//
+// The rows of a scroll list that are too many to keep as LLScrollListItems:
+// see LLScrollListCtrl::setModel(). Rows are numbered 0 to getRowCount() - 1;
+// the list only builds items for the rows it shows, and sorts and filters
+// row numbers. After changing its rows, a model tells its lists with one of
+// the protected functions.
+//
+class LLScrollListModel
+{
+public:
+	enum EChange
+	{
+		ROWS_INSERTED,		// count rows before row first, or at the end
+		ROWS_REMOVED,		// count rows starting at first
+		ROWS_CHANGED,		// the values of count rows starting at first
+		MODEL_RESET			// everything, including the row count
+	};
+	typedef boost::signals2::signal<void (EChange change, U32 first, U32 count)> changed_signal_t;
+
+	virtual ~LLScrollListModel() {}
+
+	virtual U32 getRowCount() const = 0;
+	// Fills in the row the way LLScrollListCtrl::addRow() takes it.
+	virtual void getRow(U32 row, LLScrollListItem::Params& row_p) const = 0;
+	// Negative if lhs comes first when sorting by column, like LLStringUtil::compareDict().
+	virtual S32 compareRows(U32 lhs, U32 rhs, S32 column) const = 0;
+
+	// The value getRow() gives the row, for selecting by value. Override to
+	// spare building the row.
+	virtual LLSD getRowValue(U32 row) const
+	{
+		LLScrollListItem::Params row_p;
+		getRow(row, row_p);
+		return row_p.value;
+	}
+	// Disabled rows can't be selected.
+	virtual bool isRowEnabled(U32 row) const { return true; }
+
+	boost::signals2::connection setChangedCallback(const changed_signal_t::slot_type& cb) { return mChangedSignal.connect(cb); }
+
+protected:
+	void rowsInserted(U32 first, U32 count)		{ mChangedSignal(ROWS_INSERTED, first, count); }
+	void rowsRemoved(U32 first, U32 count)		{ mChangedSignal(ROWS_REMOVED, first, count); }
+	void rowsChanged(U32 first, U32 count = 1)	{ mChangedSignal(ROWS_CHANGED, first, count); }
+	void modelReset()							{ mChangedSignal(MODEL_RESET, 0, getRowCount()); }
+
+private:
+	changed_signal_t mChangedSignal;
+};
+
+#endif // LL_LLSCROLLLISTMODEL_H
@@ -126,6 +126,7 @@ void LLStatGraph::draw()
 void LLStatGraph::setValue(const LLSD& value)
 {
 	mValue = (F32)value.asReal();
+	invalidateDraw();
 }
 
 void LLStatGraph::setMin(const F32 min)
@@ -499,88 +499,17 @@ void LLTextEditor::setShadowColor( const LLColor4& color )
 	mScrollbar->setShadowColor(color); 
 }
 
-void LLTextEditor::updateLineStartList(S32 startpos)
+static LLFastTimer::DeclareTimer FTM_TEXT_LAYOUT("Text Layout");
+
+void LLTextEditor::updateLineStartList()
 {
-	updateSegments();
-	
+	S32 keep_from = updateSegments();
+
+	LLFastTimer ft(FTM_TEXT_LAYOUT);
 	bindEmbeddedChars(mGLFont);
 
-	S32 seg_num = mSegments.size();
-	S32 seg_idx = 0;
-	S32 seg_offset = 0;
+	mLines.update(mWText, boost::bind(&LLTextEditor::wrapParagraph, this, _1, _2, _3), keep_from);
 
-	if (!mLineStartList.empty())
-	{
-		getSegmentAndOffset(startpos, &seg_idx, &seg_offset);
-		line_info t(seg_idx, seg_offset);
-		line_list_t::iterator iter = std::upper_bound(mLineStartList.begin(), mLineStartList.end(), t, line_info_compare());
-		if (iter != mLineStartList.begin()) --iter;
-		seg_idx = iter->mSegment;
-		seg_offset = iter->mOffset;
-		mLineStartList.erase(iter, mLineStartList.end());
-	}
-	
-	while( seg_idx < seg_num )
-	{
-		mLineStartList.push_back(line_info(seg_idx,seg_offset));
-		BOOL line_ended = FALSE;
-		S32 start_x = mShowLineNumbers ? UI_TEXTEDITOR_LINE_NUMBER_MARGIN : 0;
-		S32 line_width = start_x;
-		while(!line_ended && seg_idx < seg_num)
-		{
-			LLTextSegment* segment = mSegments[seg_idx];
-			S32 start_idx = segment->getStart() + seg_offset;
-			S32 end_idx = start_idx;
-			while (end_idx < segment->getEnd() && mWText[end_idx] != '\n')
-			{
-				end_idx++;
-			}
-			if (start_idx == end_idx)
-			{
-				if (end_idx >= segment->getEnd())
-				{
-					// empty segment
-					seg_idx++;
-					seg_offset = 0;
-				}
-				else
-				{
-					// empty line
-					line_ended = TRUE;
-					seg_offset++;
-				}
-			}
-			else
-			{ 
-				const llwchar* str = mWText.c_str() + start_idx;
-				S32 drawn = mGLFont->maxDrawableChars(str, (F32)abs(mTextRect.getWidth()) - line_width,
-													  end_idx - start_idx, mWordWrap ? LLFontGL::WORD_BOUNDARY_IF_POSSIBLE : LLFontGL::ANYWHERE, mAllowEmbeddedItems );
-				if( 0 == drawn && line_width == start_x)
-				{
-					// If at the beginning of a line, draw at least one character, even if it doesn't all fit.
-					drawn = 1;
-				}
-				seg_offset += drawn;
-				line_width += mGLFont->getWidth(str, 0, drawn, mAllowEmbeddedItems);
-				end_idx = segment->getStart() + seg_offset;
-				if (end_idx < segment->getEnd())
-				{
-					line_ended = TRUE;
-					if (mWText[end_idx] == '\n')
-					{
-						seg_offset++; // skip newline
-					}
-				}
-				else
-				{
-					// finished with segment
-					seg_idx++;
-					seg_offset = 0;
-				}
-			}
-		}
-	}
-	
 	unbindEmbeddedChars(mGLFont);
 
 	mScrollbar->setDocSize( getLineCount() );
@@ -600,6 +529,46 @@ void LLTextEditor::updateLineStartList(S32 startpos)
 	}
 }
 
+// Wraps the paragraph [start, end) into lines, segment by segment; see LLWrappedLines.
+void LLTextEditor::wrapParagraph(S32 start, S32 end, std::vector<S32>& lines) const
+{
+	const S32 start_x = mShowLineNumbers ? UI_TEXTEDITOR_LINE_NUMBER_MARGIN : 0;
+	const F32 max_width = (F32)abs(mTextRect.getWidth());
+	const LLFontGL::EWordWrapStyle wrap_style = mWordWrap ? LLFontGL::WORD_BOUNDARY_IF_POSSIBLE : LLFontGL::ANYWHERE;
+	S32 line_width = start_x;
+
+	S32 seg_idx, seg_offset;
+	getSegmentAndOffset(start, &seg_idx, &seg_offset);
+	S32 seg_num = mSegments.size();
+	S32 pos = start;
+	while (pos < end && seg_idx >= 0 && seg_idx < seg_num)
+	{
+		S32 seg_end = llmin(mSegments[seg_idx]->getEnd(), end);
+		if (pos >= seg_end)
+		{
+			seg_idx++;
+			continue;
+		}
+
+		// Only the characters to measure: the font takes strings, and copies a pointer to the end of the text.
+		const LLWString run(mWText, pos, seg_end - pos);
+		S32 drawn = mGLFont->maxDrawableChars(run, max_width - line_width, run.length(), wrap_style, mAllowEmbeddedItems);
+		if (0 == drawn && line_width == start_x)
+		{
+			// If at the beginning of a line, draw at least one character, even if it doesn't all fit.
+			drawn = 1;
+		}
+		line_width += mGLFont->getWidth(run, 0, drawn, mAllowEmbeddedItems);
+		pos += drawn;
+		if (pos < seg_end)
+		{
+			// The line is full
+			lines.push_back(pos);
+			line_width = start_x;
+		}
+	}
+}
+
 ////////////////////////////////////////////////////////////
 // LLTextEditor
 // Public methods
@@ -620,6 +589,7 @@ BOOL LLTextEditor::truncate()
 			temp_utf8_text = utf8str_truncate( temp_utf8_text, mMaxTextByteLength );
 			mWText = utf8str_to_wstring( temp_utf8_text );
 			mTextIsUpToDate = FALSE;
+			mLines.invalidate();
 			did_truncate = TRUE;
 		}
 	}
@@ -634,6 +604,7 @@ void LLTextEditor::setText(const LLStringExplicit &utf8str)
 	// mUTF8Text = utf8str;
 	mWText = utf8str_to_wstring(mUTF8Text);
 	mTextIsUpToDate = TRUE;
+	mLines.invalidate();
 
 	truncate();
 	blockUndo();
@@ -651,6 +622,7 @@ void LLTextEditor::setWText(const LLWString &wtext)
 	mWText = wtext;
 	mUTF8Text.clear();
 	mTextIsUpToDate = FALSE;
+	mLines.invalidate();
 
 	truncate();
 	blockUndo();
@@ -696,6 +668,7 @@ void LLTextEditor::setWordWrap(BOOL b)
 	setCursorPos(0);
 	deselect();
 	
+	mLines.invalidate();
 	needsReflow();
 }
 
@@ -884,40 +857,22 @@ S32 LLTextEditor::getLineStart( S32 line ) const
     }
 
 	line = llclamp(line, 0, num_lines-1);
-	S32 segidx = mLineStartList[line].mSegment;
-	S32 segoffset = mLineStartList[line].mOffset;
-	LLTextSegment* seg = mSegments[segidx];
-	S32 res = seg->getStart() + segoffset;
-	if (res > seg->getEnd()) 
-	{
-		//LL_ERRS() << "wtf" << LL_ENDL;
-		// This happens when creating a new notecard using the AO on certain opensims.
-		// Play it safe instead of bringing down the viewer - MC
-		LL_WARNS() << "BAD JOOJOO! Text length (" << res << ") greater than text end (" << seg->getEnd() << "). Setting line start to " << seg->getEnd() << LL_ENDL;
-		res = seg->getEnd();
-	}
-	return res;
+	// The text may have changed since it was laid out
+	return llmin(mLines.getLineStart(line), getLength());
 }
 
 // Given an offset into text (pos), find the corresponding line (from the start of the doc) and an offset into the line.
 void LLTextEditor::getLineAndOffset( S32 startpos, S32* linep, S32* offsetp ) const
 {
-	if (mLineStartList.empty())
+	if (getLineCount() == 0)
 	{
 		*linep = 0;
 		*offsetp = startpos;
 	}
 	else
 	{
-		S32 seg_idx, seg_offset;
-		getSegmentAndOffset( startpos, &seg_idx, &seg_offset );
-
-		line_info tline(seg_idx, seg_offset);
-		line_list_t::const_iterator iter = std::upper_bound(mLineStartList.begin(), mLineStartList.end(), tline, line_info_compare());
-		if (iter != mLineStartList.begin()) --iter;
-		*linep = iter - mLineStartList.begin();
-		S32 line_start = mSegments[iter->mSegment]->getStart() + iter->mOffset;
-		*offsetp = startpos - line_start;
+		*linep = mLines.getLine(startpos);
+		*offsetp = startpos - mLines.getLineStart(*linep);
 	}
 }
 
@@ -3985,7 +3940,12 @@ void LLTextEditor::reshape(S32 width, S32 height, BOOL called_from_parent)
 
 	// do this first after reshape, because other things depend on
 	// up-to-date mTextRect
+	S32 old_width = mTextRect.getWidth();
 	updateTextRect();
+	if (mTextRect.getWidth() != old_width)
+	{
+		mLines.invalidate();
+	}
 	
 	needsReflow();
 
@@ -4255,7 +4215,6 @@ void LLTextEditor::removeTextFromEnd(S32 num_chars)
 
 	pruneSegments();
 	
-	// pruneSegments will invalidate mLineStartList.
 	updateLineStartList();
 	needsScroll();
 }
@@ -4277,12 +4236,14 @@ S32 LLTextEditor::insertStringNoUndo(const S32 pos, const LLWString &wstr)
 		make_ui_sound("UISndBadKeystroke");
 		insert_len = mWText.length() - old_len;
 	}
+	mLines.noteChange(pos, 0, insert_len);
 
 	return insert_len;
 }
 
 S32 LLTextEditor::removeStringNoUndo(S32 pos, S32 length)
 {
+	mLines.noteChange(pos, llmin(length, (S32)mWText.length() - pos), 0);
 	mWText.erase(pos, length);
 	mTextIsUpToDate = FALSE;
 	return -length;	// This will be wrong if someone calls removeStringNoUndo with an excessive length
@@ -4296,6 +4257,7 @@ S32 LLTextEditor::overwriteCharNoUndo(S32 pos, llwchar wc)
 	}
 	mWText[pos] = wc;
 	mTextIsUpToDate = FALSE;
+	mLines.noteChange(pos, 1, 1);
 	return 1;
 }
 
@@ -4393,20 +4355,32 @@ void LLTextEditor::loadKeywords(const std::string& filename,
 		{
 			insert_it = mSegments.insert(insert_it, *list_it);
 		}
+		mLines.invalidate();
 	}
 }
 
 static LLFastTimer::DeclareTimer FTM_SYNTAX_HIGHLIGHTING("Syntax Highlighting");
 static LLFastTimer::DeclareTimer FTM_UPDATE_TEXT_SEGMENTS("Update Text Segments");
 
-void LLTextEditor::updateSegments()
+// Returns where the segments start being the old ones, moved by the edits since the last layout.
+S32 LLTextEditor::updateSegments()
 {
+	S32 keep_from = 0;
 	{
 		LLFastTimer ft(FTM_SYNTAX_HIGHLIGHTING);
 		if (mKeywords.isLoaded())
 		{
 			// HACK:  No non-ascii keywords for now
-			mKeywords.findSegments(&mSegments, mWText, mDefaultColor);
+			if (!mLines.isValid())
+			{
+				mKeywords.findSegments(&mSegments, mWText, mDefaultColor);
+			}
+			else if (mLines.isChanged())
+			{
+				// Only tokenize the lines around the edits
+				keep_from = mKeywords.updateSegments(&mSegments, mWText, mDefaultColor,
+													 mLines.getChangeStart(), mLines.getChangeEnd(), mLines.getChangeDelta());
+			}
 		}
 		else if (mAllowEmbeddedItems)
 		{
@@ -4427,10 +4401,10 @@ void LLTextEditor::updateSegments()
 		default_segment->setIsDefault(TRUE);
 		mSegments.push_back(default_segment);
 	}
+	return keep_from;
 }
 
 // Only effective if text was removed from the end of the editor
-// *NOTE: Using this will invalidate references to mSegments from mLineStartList.
 void LLTextEditor::pruneSegments()
 {
 	S32 len = mWText.length();
@@ -45,6 +45,7 @@
 #include "lldarray.h"
 
 #include "llpreeditor.h"
+#include "llwrappedlines.h"
 #include "llmenugl.h"
 
 class LLFontGL;
@@ -305,7 +306,7 @@ protected:
 	void			getSegmentAndOffset( S32 startpos, S32* segidxp, S32* offsetp ) const;
 	void			drawPreeditMarker();
 public:
-	void			updateLineStartList(S32 startpos = 0);
+	void			updateLineStartList();
 protected:
 	void			updateScrollFromCursor();
 	void			updateTextRect();
@@ -350,7 +351,7 @@ protected:
 	S32				nextWordPos(S32 cursorPos) const;
 	BOOL			getWordBoundriesAt(const S32 at, S32* word_begin, S32* word_length) const;
 
-	S32 			getLineCount() const { return mLineStartList.size(); }
+	S32 			getLineCount() const { return mLines.getLineCount(); }
 	S32 			getLineStart( S32 line ) const;
 	void			getLineAndOffset(S32 pos, S32* linep, S32* offsetp) const;
 	S32				getPos(S32 line, S32 offset);
@@ -483,7 +484,8 @@ private:
 	void	                pasteHelper(bool is_primary);
 	void			onKeyStroke();
 
-	void			updateSegments();
+	S32				updateSegments();
+	void			wrapParagraph(S32 start, S32 end, std::vector<S32>& lines) const;
 	void			pruneSegments();
 
 	void			drawBackground();
@@ -498,6 +500,7 @@ private:
 		mReflowNeeded = TRUE; 
 		// cursor might have moved, need to scroll
 		mScrollNeeded = TRUE;
+		invalidateDraw();
 	}
 	void			needsScroll() { mScrollNeeded = TRUE; }
 
@@ -539,33 +542,14 @@ private:
 
 	S32				mDesiredXPixel;			// X pixel position where the user wants the cursor to be
 	LLRect			mTextRect;				// The rect in which text is drawn.  Excludes borders.
-	// List of offsets and segment index of the start of each line.  Always has at least one node (0).
-	struct line_info
-	{
-		line_info(S32 segment, S32 offset) : mSegment(segment), mOffset(offset) {}
-		S32 mSegment;
-		S32 mOffset;
-	};
-	struct line_info_compare
-	{
-		bool operator()(const line_info& a, const line_info& b) const
-		{
-			if (a.mSegment < b.mSegment)
-				return true;
-			else if (a.mSegment > b.mSegment)
-				return false;
-			else
-				return a.mOffset < b.mOffset;
-		}
-	};
-	typedef std::vector<line_info> line_list_t;
 
 	//to keep track of what we have to remove before showing menu
 	std::vector<SpellMenuBind* > suggestionMenuItems;
 	S32 mLastContextMenuX;
 	S32 mLastContextMenuY;
 
-	line_list_t mLineStartList;
+	// Where each line starts; once laid out, there is always at least one (0).
+	LLWrappedLines	mLines;
 	BOOL			mReflowNeeded;
 	BOOL			mScrollNeeded;
 
@@ -619,6 +603,7 @@ public:
 
 	S32					getStart() const					{ return mStart; }
 	S32					getEnd() const						{ return mEnd; }
+	void				setStart( S32 start )				{ mStart = start; }
 	void				setEnd( S32 end )					{ mEnd = end; }
 	const LLColor4&		getColor() const					{ return mStyle->getColor(); }
 	void 				setColor(const LLColor4 &color)		{ mStyle->setColor(color); }
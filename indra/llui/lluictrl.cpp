@@ -407,6 +407,7 @@ BOOL LLUICtrl::isCtrl() const
 void LLUICtrl::setValue(const LLSD& value)
 {
     mViewModel->setValue(value);
+	invalidateDraw();
 }
 
 //virtual
@@ -41,6 +41,7 @@
 #include <boost/foreach.hpp>
 
 #include "llrender.h"
+#include "llrenderdrawlist.h"
 #include "llevent.h"
 #include "llfontgl.h"
 #include "llfocusmgr.h"
@@ -58,6 +59,8 @@
 #include "lltexteditor.h"
 #include "lltextbox.h"
 #include "llfasttimer.h"
+#include "llframetimer.h"
+#include "lllocalcliprect.h"
 
 using namespace LLOldEvents;
 
@@ -72,6 +75,9 @@ std::string LLView::sMouseHandlerMessage;
 BOOL	LLView::sEditingUI = FALSE;
 BOOL	LLView::sForceReshape = FALSE;
 LLView*	LLView::sEditingUIView = NULL;
+bool	LLView::sRetainDraw = false;
+U32		LLView::sRetainedDraws = 0;
+U32		LLView::sRetainedReplays = 0;
 S32		LLView::sLastLeftXML = S32_MIN;
 S32		LLView::sLastBottomXML = S32_MIN;
 std::vector<LLViewDrawContext*> LLViewDrawContext::sDrawContextStack;
@@ -96,6 +102,7 @@ LLView::Params::Params()
 	follows("follows"),
 	hover_cursor("hover_cursor", "UI_CURSOR_ARROW"),
 	use_bounding_rect("use_bounding_rect", false),
+	retain_draw("retain_draw", false),
 	tab_group("tab_group", 0),
 	default_tab_group("default_tab_group"),
 	//tool_tip("tool_tip"),
@@ -142,6 +149,8 @@ void LLView::init(const LLView::Params& p)
 	mUseBoundingRect = p.use_bounding_rect;
 	mDefaultTabGroup = p.default_tab_group;
 	mLastTabGroup = 0;
+	mRetainedDraw = NULL;
+	setRetainDraw(p.retain_draw);
 	//mToolTipMsg((LLStringExplicit)p.tool_tip()),
 	//mDefaultWidgets(NULL)
 	
@@ -202,6 +211,8 @@ LLView::~LLView()
 				  DeletePairedPointer());
 	std::for_each(mDummyWidgets.begin(), mDummyWidgets.end(),
 				  DeletePairedPointer());
+
+	delete mRetainedDraw;
 }
 
 // virtual
@@ -244,6 +255,7 @@ void LLView::setRect(const LLRect& rect)
 {
 	mRect = rect;
 	updateBoundingRect();
+	invalidateDraw();
 }
 
 void LLView::setUseBoundingRect( BOOL use_bounding_rect ) 
@@ -278,6 +290,7 @@ void LLView::sendChildToFront(LLView* child)
 		{
 			mChildList.remove( child );
 			mChildList.push_front(child);
+			invalidateDraw();
 		}
 	}
 }
@@ -293,6 +306,7 @@ void LLView::sendChildToBack(LLView* child)
 		{
 			mChildList.remove( child );
 			mChildList.push_back(child);
+			invalidateDraw();
 		}
 	}
 }
@@ -347,6 +361,7 @@ bool LLView::addChild(LLView* child, S32 tab_group)
 
 	child->mParentView = this;
 	updateBoundingRect();
+	invalidateDraw();
 	mLastTabGroup = tab_group;
 	return true;
 }
@@ -395,6 +410,7 @@ void LLView::removeChild(LLView* child)
 		LL_WARNS() << child->getName() << "is not a child of " << getName() << LL_ENDL;
 	}
 	updateBoundingRect();
+	invalidateDraw();
 }
 
 LLView::ctrl_list_t LLView::getCtrlList() const
@@ -492,7 +508,11 @@ BOOL LLView::getTentative() const
 //virtual
 void LLView::setEnabled(BOOL enabled)
 {
-	mEnabled = enabled;
+	if (mEnabled != enabled)
+	{
+		mEnabled = enabled;
+		invalidateDraw();
+	}
 }
 
 //virtual
@@ -638,6 +658,7 @@ void LLView::setVisible(BOOL visible)
 			handleVisibilityChange( visible );
 		}
 		updateBoundingRect();
+		invalidateDraw();
 	}
 }
 
@@ -659,6 +680,10 @@ void LLView::translate(S32 x, S32 y)
 {
 	mRect.translate(x, y);
 	updateBoundingRect();
+	if (x || y)
+	{
+		invalidateDraw();
+	}
 }
 
 // virtual
@@ -1199,7 +1224,7 @@ void LLView::drawChildren()
 						// flag the fact we are in draw here, in case overridden draw() method attempts to remove this widget
 						viewp->mInDraw = true;
 						if(gDebugGL)check_blend_funcs();
-						viewp->draw();
+						viewp->drawRetained();
 						if(gDebugGL)check_blend_funcs();
 						viewp->mInDraw = false;
 
@@ -1308,7 +1333,7 @@ void LLView::drawChild(LLView* childp, S32 x_offset, S32 y_offset, BOOL force_dr
 			{
 				LLUI::translate((F32)childp->getRect().mLeft + x_offset, (F32)childp->getRect().mBottom + y_offset, 0.f);
 				if(gDebugGL)check_blend_funcs();
-				childp->draw();
+				childp->drawRetained();
 				if(gDebugGL)check_blend_funcs();
 			}
 			LLUI::popMatrix();
@@ -1319,6 +1344,121 @@ void LLView::drawChild(LLView* childp, S32 x_offset, S32 y_offset, BOOL force_dr
 }
 
 
+// Frames a view has to go unchanged before it gets recorded
+static const U32 RETAINED_DRAW_QUIET_FRAMES = 2;
+// Views can change without telling; recordings get this old at most.
+static const F32 RETAINED_DRAW_MAX_AGE = 0.25f;
+
+struct LLView::RetainedDraw
+{
+	RetainedDraw() : mQuietFrames(0), mUnrecordable(false) {}
+
+	LLRenderDrawList mList;
+	LLRect mClipRect;		// Clip rect the recording was made in
+	LLFrameTimer mAge;
+	U32 mQuietFrames;
+	bool mUnrecordable;		// The last recording was aborted
+};
+
+void LLView::setRetainDraw(bool retain)
+{
+	if (retain && !mRetainedDraw)
+	{
+		mRetainedDraw = new RetainedDraw;
+	}
+	else if (!retain && mRetainedDraw)
+	{
+		llassert(!mRetainedDraw->mList.isRecording());
+		delete mRetainedDraw;
+		mRetainedDraw = NULL;
+		invalidateDraw();
+	}
+}
+
+void LLView::invalidateDraw()
+{
+	for (LLView* viewp = this; viewp; viewp = viewp->mParentView)
+	{
+		RetainedDraw* retained = viewp->mRetainedDraw;
+		if (retained)
+		{
+			if (retained->mList.isRecording())
+			{
+				// Changed while drawing: what was recorded may already be stale.
+				retained->mList.abort();
+			}
+			else
+			{
+				retained->mList.clear();
+			}
+			retained->mQuietFrames = 0;
+			retained->mUnrecordable = false;
+		}
+	}
+}
+
+void LLView::drawRetained()
+{
+	if (!mRetainedDraw)
+	{
+		draw();
+		return;
+	}
+
+	++sRetainedDraws;
+	RetainedDraw& retained = *mRetainedDraw;
+	LLRenderDrawList& list = retained.mList;
+	bool live = !sRetainDraw || retained.mUnrecordable;
+	if (!live)
+	{
+		// What the user interacts with changes from frame to frame.
+		S32 mouse_x, mouse_y;
+		LLUI::getMousePositionScreen(&mouse_x, &mouse_y);
+		if (gFocusMgr.childHasKeyboardFocus(this) || gFocusMgr.childHasMouseCapture(this) ||
+			calcScreenRect().pointInRect(mouse_x, mouse_y))
+		{
+			retained.mQuietFrames = 0;
+			live = true;
+		}
+		else if (retained.mQuietFrames < RETAINED_DRAW_QUIET_FRAMES)
+		{
+			++retained.mQuietFrames;
+			live = true;
+		}
+	}
+	if (live)
+	{
+		list.clear();
+		draw();
+		return;
+	}
+
+	const LLRect clip_rect = LLScreenClipRect::getClipRect();
+	if (list.isRecorded() && retained.mAge.getElapsedTimeF32() < RETAINED_DRAW_MAX_AGE &&
+		retained.mClipRect == clip_rect && list.canReplay())
+	{
+		++sRetainedReplays;
+		list.replay();
+		if (list.hasScissor())
+		{
+			LLScreenClipRect::updateScissorRegion();
+		}
+		return;
+	}
+
+	list.begin();
+	draw();
+	if (list.end())
+	{
+		retained.mClipRect = clip_rect;
+		retained.mAge.reset();
+	}
+	else
+	{
+		retained.mUnrecordable = true;
+	}
+}
+
 void LLView::reshape(S32 width, S32 height, BOOL called_from_parent)
 {
 	// compute how much things changed and apply reshape logic to children
@@ -1330,6 +1470,7 @@ void LLView::reshape(S32 width, S32 height, BOOL called_from_parent)
 		// adjust our rectangle
 		mRect.mRight = getRect().mLeft + width;
 		mRect.mTop = getRect().mBottom + height;
+		invalidateDraw();
 
 		// move child views according to reshape flags
 		BOOST_FOREACH(LLView* viewp, mChildList)
@@ -2770,6 +2911,13 @@ void LLView::initFromXML(LLXMLNodePtr node, LLView* parent)
 	node->getAttributeBOOL("use_bounding_rect", mUseBoundingRect);
 	node->getAttributeBOOL("mouse_opaque", mMouseOpaque);
 
+	if (node->hasAttribute("retain_draw"))
+	{
+		BOOL retain_draw;
+		node->getAttributeBOOL("retain_draw", retain_draw);
+		setRetainDraw(retain_draw);
+	}
+
 	node->getAttributeS32("default_tab_group", mDefaultTabGroup);
 	
 	reshape(view_rect.getWidth(), view_rect.getHeight());
@@ -184,7 +184,8 @@ public:
 									mouse_opaque,
 									use_bounding_rect,
 									from_xui,
-									focus_root;
+									focus_root,
+									retain_draw;
 
 		Optional<S32>				tab_group,
 									default_tab_group;
@@ -320,6 +321,17 @@ public:
 	void		setUseBoundingRect( BOOL use_bounding_rect );
 	BOOL		getUseBoundingRect() const;
 
+	// Lets the drawing of this view and its children be recorded once and
+	// replayed while nothing changes (see LLRenderDrawList). Only for views
+	// whose draw() does nothing but draw, which rules out every floater:
+	// LLFloater updates its default button, LLButton fades its glow and
+	// LLTabContainer scrolls its tabs from draw().
+	void		setRetainDraw(bool retain);
+	bool		getRetainDraw() const			{ return mRetainedDraw != NULL; }
+	// This view looks different now; drops the recordings of it and of the
+	// views it is in.
+	void		invalidateDraw();
+
 	ECursorType	getHoverCursor() { return mHoverCursor; }
 
 	const std::string& getToolTip() const			{ return mToolTipMsg.getString(); }
@@ -753,6 +765,11 @@ private:
 
 	bool		mInDraw;
 private:
+	// Draws the view, or replays its recording.
+	void		drawRetained();
+
+	struct RetainedDraw;
+	RetainedDraw* mRetainedDraw;
 
 	static LLWindow* sWindow;	// All root views must know about their window.
 
@@ -808,6 +825,9 @@ public:
 	static S32 sLastLeftXML;
 	static S32 sLastBottomXML;
 	static BOOL sForceReshape;
+	static bool sRetainDraw;	// Whether views that allow it replay their drawing
+	static U32	sRetainedDraws;		// Draws of views that allow it, and how many of
+	static U32	sRetainedReplays;	// those were replayed
 };
 
 class LLCompareByTabOrder
@@ -0,0 +1,169 @@
+/**
+ * @file llkeywords_test.cpp
+ * @date 2026-10
+ * @brief LLKeywords incremental highlighting tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+// Class to test
+#include "../llkeywords.h"
+#include "../lltexteditor.h"
+#include "llwrappedlines.h"
+// Tut header
+#include "../test/lltestrandom.h"
+#include "../test/lltut.h"
+
+// -------------------------------------------------------------------------------------------
+// Stubbing: Declarations required to link and run the class being tested
+// Notes:
+// * Add here stubbed implementation of the few classes and methods used in the class to be tested
+// * Add as little as possible (let the link errors guide you)
+// * Do not make any assumption as to how those classes or methods work (i.e. don't copy/paste code)
+// * A simulator for a class can be implemented here. Please comment and document thoroughly.
+
+// The tests only look at where segments start and end and at their tokens, not at their styles.
+LLTextSegment::LLTextSegment(S32 start) : mStart(start), mEnd(0), mToken(NULL), mIsDefault(FALSE) { }
+LLTextSegment::LLTextSegment(const LLStyleSP& style, S32 start, S32 end) : mStart(start), mEnd(end), mToken(NULL), mIsDefault(FALSE) { }
+LLTextSegment::LLTextSegment(const LLColor4& color, S32 start, S32 end) : mStart(start), mEnd(end), mToken(NULL), mIsDefault(FALSE) { }
+LLTextSegment::LLTextSegment(const LLColor3& color, S32 start, S32 end) : mStart(start), mEnd(end), mToken(NULL), mIsDefault(FALSE) { }
+LLColor3::LLColor3(const LLColor4& color) { }
+
+// End Stubbing
+// -------------------------------------------------------------------------------------------
+
+namespace tut
+{
+	static void no_wrap(S32 start, S32 end, std::vector<S32>& lines)
+	{
+	}
+
+	static bool same_segments(const std::vector<LLTextSegmentPtr>& segments, const std::vector<LLTextSegmentPtr>& expected)
+	{
+		if (segments.size() != expected.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < segments.size(); ++i)
+		{
+			if (segments[i]->getStart() != expected[i]->getStart() || segments[i]->getEnd() != expected[i]->getEnd() ||
+				segments[i]->getToken() != expected[i]->getToken())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	struct keywords_test
+	{
+		keywords_test()
+		{
+			// The kinds of tokens of the LSL keywords file
+			const LLColor3 color(1.f, 0.f, 0.f);
+			mKeywords.addToken(LLKeywordToken::WORD, "default", color);
+			mKeywords.addToken(LLKeywordToken::WORD, "if", color);
+			mKeywords.addToken(LLKeywordToken::WORD, "float", color);
+			mKeywords.addToken(LLKeywordToken::LINE, "@", color);
+			mKeywords.addToken(LLKeywordToken::TWO_SIDED_DELIMITER, "/*", color, LLStringUtil::null, "*/");
+			mKeywords.addToken(LLKeywordToken::ONE_SIDED_DELIMITER, "//", color);
+			mKeywords.addToken(LLKeywordToken::DOUBLE_QUOTATION_MARKS, "\"", color, LLStringUtil::null, "\"");
+		}
+
+		LLKeywords mKeywords;
+		LLColor4 mColor;
+	};
+
+	typedef test_group<keywords_test> keywords_t;
+	typedef keywords_t::object keywords_object_t;
+	tut::keywords_t tut_keywords("keywords");
+
+	template<> template<>
+	void keywords_object_t::test<1>()
+	{
+		// An edit on the first line keeps the segments of the lines after it.
+		LLWString text = utf8str_to_wstring("float x;\n");
+		for (S32 i = 0; i < 100; ++i)
+		{
+			text += utf8str_to_wstring("if (x) x = 1.0; // \"one\"\n");
+		}
+		std::vector<LLTextSegmentPtr> segments, expected;
+		mKeywords.findSegments(&segments, text, mColor);
+
+		text.insert(1, 1, 'x');
+		const S32 keep_from = mKeywords.updateSegments(&segments, text, mColor, 1, 2, 1);
+		ensure_equals("kept from the second line", keep_from, 10);
+		mKeywords.findSegments(&expected, text, mColor);
+		ensure("same segments", same_segments(segments, expected));
+	}
+
+	template<> template<>
+	void keywords_object_t::test<2>()
+	{
+		// Random edits, against tokenizing the text from scratch. The edits are tracked by
+		// LLWrappedLines, as LLTextEditor does.
+		static const char* pieces[] = { "/*", "*/", "//", "\"", "\\", "\n", "\n", "@", " ", "x",
+										"if", "float", "default", "if (x) \"a\" // b\n", "/* c */" };
+		TestRandom random;
+		LLWString text;
+		for (S32 i = 0; i < 400; ++i)
+		{
+			text += utf8str_to_wstring(pieces[random.next(LL_ARRAY_SIZE(pieces))]);
+		}
+		std::vector<LLTextSegmentPtr> segments, expected;
+		mKeywords.findSegments(&segments, text, mColor);
+		LLWrappedLines lines;
+		lines.update(text, &no_wrap);
+
+		for (S32 round = 0; round < 2000; ++round)
+		{
+			const S32 edits = 1 + random.next(3);
+			for (S32 e = 0; e < edits; ++e)
+			{
+				const S32 pos = random.next(text.length() + 1);
+				const S32 removed = llmin((S32)text.length() - pos, (S32)random.next(6));
+				LLWString inserted;
+				for (S32 count = random.next(3); count > 0; --count)
+				{
+					inserted += utf8str_to_wstring(pieces[random.next(LL_ARRAY_SIZE(pieces))]);
+				}
+				text.replace(pos, removed, inserted);
+				lines.noteChange(pos, removed, inserted.length());
+			}
+
+			if (lines.isChanged())
+			{
+				mKeywords.updateSegments(&segments, text, mColor, lines.getChangeStart(), lines.getChangeEnd(), lines.getChangeDelta());
+			}
+			lines.update(text, &no_wrap);
+			mKeywords.findSegments(&expected, text, mColor);
+			ensure(llformat("same segments, round %d", round), same_segments(segments, expected));
+		}
+	}
+}
@@ -160,6 +160,15 @@ public:
 
 // return the platform-specific window reference we use to initialize llmozlib (HWND on Windows, WindowRef on the Mac, Gtk window on Linux)
 	virtual void *getMediaWindow();
+
+	// Create a GL context that shares textures and buffers with the main one, for use
+	// by another thread. Call from the main thread; returns NULL where not supported.
+	virtual void *createSharedContext() { return NULL; }
+	// Make a context from createSharedContext() current on the calling thread, or
+	// release the current one with NULL.
+	virtual void makeContextCurrent(void *context) {}
+	// Call after the context was released by the thread that used it.
+	virtual void destroySharedContext(void *context) {}
 	
 	// control platform's Language Text Input mechanisms.
 	virtual void allowLanguageTextInput(LLPreeditor *preeditor, BOOL b) {}
@@ -2604,6 +2604,122 @@ void *LLWindowSDL::getPlatformWindow()
 	return NULL;
 }
 
+#if LL_X11
+// A context for another thread. It gets its own connection to the X server,
+// since Xlib is not initialized for use from several threads, and its own
+// 1x1 pbuffer to be current on: the window belongs to the main connection.
+struct LLSharedContextX11
+{
+	Display* mDisplay;
+	GLXContext mContext;
+	GLXPbuffer mPbuffer;
+};
+#endif // LL_X11
+
+void *LLWindowSDL::createSharedContext()
+{
+#if LL_X11
+	GLXContext main_context = glXGetCurrentContext();
+	if (!mSDL_Display || !main_context)
+	{
+		return NULL;
+	}
+
+	int config_id = 0;
+	maybe_lock_display();
+	glXQueryContext(mSDL_Display, main_context, GLX_FBCONFIG_ID, &config_id);
+	maybe_unlock_display();
+
+	Display* display = XOpenDisplay(DisplayString(mSDL_Display));
+	if (!display)
+	{
+		LL_WARNS("Window") << "Could not open a second X display connection" << LL_ENDL;
+		return NULL;
+	}
+
+	// Direct contexts of one process can share objects across connections.
+	// Prefer the window's own config; fall back to any RGBA config that can
+	// render to a pbuffer.
+	const int id_attribs[] = { GLX_FBCONFIG_ID, config_id, GLX_DRAWABLE_TYPE, GLX_PBUFFER_BIT, None };
+	const int pbuffer_attribs[] = { GLX_DRAWABLE_TYPE, GLX_PBUFFER_BIT, GLX_RENDER_TYPE, GLX_RGBA_BIT, None };
+	int count = 0;
+	GLXFBConfig* configs = glXChooseFBConfig(display, DefaultScreen(display), id_attribs, &count);
+	if (!configs || count <= 0)
+	{
+		if (configs)
+		{
+			XFree(configs);
+		}
+		configs = glXChooseFBConfig(display, DefaultScreen(display), pbuffer_attribs, &count);
+	}
+	GLXContext context = NULL;
+	GLXPbuffer pbuffer = None;
+	if (configs && count > 0)
+	{
+		const int size_attribs[] = { GLX_PBUFFER_WIDTH, 1, GLX_PBUFFER_HEIGHT, 1, None };
+		pbuffer = glXCreatePbuffer(display, configs[0], size_attribs);
+		if (pbuffer != None)
+		{
+			context = glXCreateNewContext(display, configs[0], GLX_RGBA_TYPE, main_context, True);
+		}
+	}
+	if (configs)
+	{
+		XFree(configs);
+	}
+	if (!context)
+	{
+		LL_WARNS("Window") << "Could not create a shared GL context" << LL_ENDL;
+		if (pbuffer != None)
+		{
+			glXDestroyPbuffer(display, pbuffer);
+		}
+		XCloseDisplay(display);
+		return NULL;
+	}
+
+	LLSharedContextX11* shared = new LLSharedContextX11;
+	shared->mDisplay = display;
+	shared->mContext = context;
+	shared->mPbuffer = pbuffer;
+	return shared;
+#else
+	return NULL;
+#endif // LL_X11
+}
+
+void LLWindowSDL::makeContextCurrent(void *context)
+{
+#if LL_X11
+	// The context that is current on this thread, to release it again.
+	static ll_thread_local LLSharedContextX11* current = NULL;
+	LLSharedContextX11* shared = context ? (LLSharedContextX11*)context : current;
+	if (shared)
+	{
+		if (!glXMakeContextCurrent(shared->mDisplay, context ? shared->mPbuffer : None,
+								   context ? shared->mPbuffer : None, context ? shared->mContext : NULL))
+		{
+			LL_WARNS("Window") << "glXMakeContextCurrent failed" << LL_ENDL;
+		}
+	}
+	current = (LLSharedContextX11*)context;
+#endif // LL_X11
+}
+
+void LLWindowSDL::destroySharedContext(void *context)
+{
+#if LL_X11
+	LLSharedContextX11* shared = (LLSharedContextX11*)context;
+	if (shared)
+	{
+		glXDestroyContext(shared->mDisplay, shared->mContext);
+		glXDestroyPbuffer(shared->mDisplay, shared->mPbuffer);
+		XCloseDisplay(shared->mDisplay);
+		delete shared;
+	}
+#endif // LL_X11
+}
+
 void LLWindowSDL::bringToFront()
 {
 	// This is currently used when we are 'launched' to a specific
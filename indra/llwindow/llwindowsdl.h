@@ -123,6 +123,10 @@ public:
 	/*virtual*/ void *getPlatformWindow();
 	/*virtual*/ void bringToFront();
 
+	/*virtual*/ void *createSharedContext();
+	/*virtual*/ void makeContextCurrent(void *context);
+	/*virtual*/ void destroySharedContext(void *context);
+
 	/*virtual*/ void spawnWebBrowser(const std::string& escaped_url, bool async);
 	
 	/*virtual*/ void setTitle(const std::string &title);
@@ -3352,6 +3352,58 @@ void *LLWindowWin32::getPlatformWindow()
 	return (void*)mWindowHandle;
 }
 
+void *LLWindowWin32::createSharedContext()
+{
+	if (!mhDC || !mhRC)
+	{
+		return NULL;
+	}
+
+	HGLRC rc = NULL;
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	glGetError(); // GL_MAJOR_VERSION is unknown before 3.0
+	if (wglCreateContextAttribsARB && major >= 3)
+	{ //ask for the same version and profile as the main context
+		S32 attribs[] = 
+		{
+			WGL_CONTEXT_MAJOR_VERSION_ARB, major,
+			WGL_CONTEXT_MINOR_VERSION_ARB, minor,
+			WGL_CONTEXT_PROFILE_MASK_ARB,  LLRender::sGLCoreProfile ? WGL_CONTEXT_CORE_PROFILE_BIT_ARB : WGL_CONTEXT_COMPATIBILITY_PROFILE_BIT_ARB,
+			0
+		};
+		rc = wglCreateContextAttribsARB(mhDC, mhRC, attribs);
+	}
+	else if ((rc = SafeCreateContext(mhDC)) && !wglShareLists(mhRC, rc))
+	{
+		wglDeleteContext(rc);
+		rc = NULL;
+	}
+
+	if (!rc)
+	{
+		LL_WARNS("Window") << "Could not create a shared GL context" << LL_ENDL;
+	}
+	return (void*)rc;
+}
+
+void LLWindowWin32::makeContextCurrent(void *context)
+{
+	if (!wglMakeCurrent(context ? mhDC : NULL, (HGLRC)context))
+	{
+		LL_WARNS("Window") << "wglMakeCurrent failed, error " << GetLastError() << LL_ENDL;
+	}
+}
+
+void LLWindowWin32::destroySharedContext(void *context)
+{
+	if (context)
+	{
+		wglDeleteContext((HGLRC)context);
+	}
+}
+
 void LLWindowWin32::bringToFront()
 {
 	BringWindowToTop(mWindowHandle);
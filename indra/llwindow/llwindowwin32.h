@@ -107,6 +107,10 @@ public:
 	/*virtual*/ void bringToFront();
 	/*virtual*/ void focusClient();
 
+	/*virtual*/ void *createSharedContext();
+	/*virtual*/ void makeContextCurrent(void *context);
+	/*virtual*/ void destroySharedContext(void *context);
+
 	/*virtual*/ void allowLanguageTextInput(LLPreeditor *preeditor, BOOL b);
 	/*virtual*/ void setLanguageTextInput( const LLCoordGL & pos );
 	/*virtual*/ void updateLanguageTextInputArea();
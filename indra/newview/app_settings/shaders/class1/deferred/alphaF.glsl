@@ -38,6 +38,10 @@ out vec4 frag_color;
 //uniform float display_gamma;
 uniform vec4 gamma;
 uniform vec4 lightnorm;
+uniform float distance_multiplier;
+#ifdef WINDLIGHT_SKY_BLOCK
+WINDLIGHT_SKY_BLOCK
+#else
 uniform vec4 sunlight_color;
 uniform vec4 ambient;
 uniform vec4 blue_horizon;
@@ -46,9 +50,9 @@ uniform float haze_horizon;
 uniform float haze_density;
 uniform float cloud_shadow;
 uniform float density_multiplier;
-uniform float distance_multiplier;
 uniform float max_y;
 uniform vec4 glow;
+#endif
 uniform float scene_light_strength;
 uniform mat3 env_mat;
 
@@ -0,0 +1,57 @@
+/** 
+ * @file hiZDownsampleF.glsl
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+//#extension GL_ARB_texture_rectangle : enable
+
+#ifdef DEFINE_GL_FRAGCOLOR
+out vec4 frag_color;
+#else
+#define frag_color gl_FragColor
+#endif
+
+uniform sampler2DRect depthMap;
+
+// Size of depthMap
+uniform vec2 screen_res;
+// depthMap texels per output texel
+uniform vec2 delta;
+
+// Farthest depth of every texel of depthMap that this texel covers, even partially
+void main() 
+{
+	vec2 start = floor((gl_FragCoord.xy - 0.5) * delta);
+	vec2 end = min(ceil((gl_FragCoord.xy + 0.5) * delta), screen_res);
+
+	float depth = 0.0;
+	for (float y = start.y; y < end.y; y += 1.0)
+	{
+		for (float x = start.x; x < end.x; x += 1.0)
+		{
+			depth = max(depth, texture2DRect(depthMap, vec2(x, y) + 0.5).r);
+		}
+	}
+
+	gl_FragDepth = depth;
+}
@@ -43,6 +43,10 @@ uniform vec3 camPosLocal;
 //uniform vec4 camPosWorld;
 
 uniform vec4 lightnorm;
+uniform float distance_multiplier;
+#ifdef WINDLIGHT_SKY_BLOCK
+WINDLIGHT_SKY_BLOCK
+#else
 uniform vec4 sunlight_color;
 uniform vec4 ambient;
 uniform vec4 blue_horizon;
@@ -51,9 +55,9 @@ uniform float haze_horizon;
 uniform float haze_density;
 uniform float cloud_shadow;
 uniform float density_multiplier;
-uniform float distance_multiplier;
 uniform float max_y;
 uniform vec4 glow;
+#endif
 
 void calcAtmospherics(vec3 inPositionEye) {
 
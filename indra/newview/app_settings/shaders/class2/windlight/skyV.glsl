@@ -38,6 +38,9 @@ VARYING vec4 vary_HazeColor;
 uniform vec3 camPosLocal;
 
 uniform vec4 lightnorm;
+#ifdef WINDLIGHT_SKY_BLOCK
+WINDLIGHT_SKY_BLOCK
+#else
 uniform vec4 sunlight_color;
 uniform vec4 ambient;
 uniform vec4 blue_horizon;
@@ -50,6 +53,7 @@ uniform float density_multiplier;
 uniform float max_y;
 
 uniform vec4 glow;
+#endif
 
 uniform vec4 cloud_color;
 
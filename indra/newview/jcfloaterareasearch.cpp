@@ -61,6 +61,11 @@ JCFloaterAreaSearch::JCFloaterAreaSearch(const LLSD& data) :
 
 JCFloaterAreaSearch::~JCFloaterAreaSearch()
 {
+	// The list outlives mResults.
+	if (mResultList)
+	{
+		mResultList->setModel(NULL);
+	}
 }
 
 void JCFloaterAreaSearch::close(bool app)
@@ -79,6 +84,8 @@ BOOL JCFloaterAreaSearch::postBuild()
 {
 	mResultList = getChild<LLScrollListCtrl>("result_list");
 	mResultList->setDoubleClickCallback(boost::bind(&JCFloaterAreaSearch::onDoubleClick,this));
+	mResultList->setModel(&mResults);
+	mResultList->setRowFilter(boost::bind(&JCFloaterAreaSearch::filterRow, this, _1));
 	mResultList->sortByColumn("Name", TRUE);
 
 	mCounterText = getChild<LLTextBox>("counter");
@@ -111,7 +118,7 @@ void JCFloaterAreaSearch::checkRegion(bool force_clear)
 		mLastRegion = region;
 		mPendingObjects.clear();
 		mCachedObjects.clear();
-		mResultList->deleteAllItems();
+		mResults.clear();
 		mCounterText->setText(std::string("Listed/Pending/Total"));
 	}
 }
@@ -163,6 +170,7 @@ void JCFloaterAreaSearch::onCommitLine(LLUICtrl* caller, const LLSD& value, OBJE
 	LLStringUtil::toLower(text);
 	caller->setValue(text);
  	mFilterStrings[type] = text;
+	mResultList->refilter();
 	//LL_INFOS() << "loaded " << name << " with "<< text << LL_ENDL;
 	checkRegion();
 	results();
@@ -199,9 +207,7 @@ void JCFloaterAreaSearch::results()
 
 	if (mPendingObjects.size() > 0 && mLastUpdateTimer.getElapsedTimeF32() < min_refresh_interval) return;
 	//LL_INFOS() << "results()" << LL_ENDL;
-	uuid_vec_t selected = mResultList->getSelectedIDs();
-	S32 scrollpos = mResultList->getScrollPos();
-	mResultList->deleteAllItems();
+	std::set<LLUUID> listed;
 	S32 i;
 	S32 total = gObjectList.getNumObjects();
 
@@ -221,55 +227,131 @@ void JCFloaterAreaSearch::results()
 					if(it != mCachedObjects.end())
 					{
 						//LL_INFOS() << "all entries are \"\" or we have data" << LL_ENDL;
-						std::string object_name = it->second.name;
-						std::string object_desc = it->second.desc;
-						std::string object_owner;
-						std::string object_group;
-						gCacheName->getFullName(it->second.owner_id, object_owner);
-						gCacheName->getGroupName(it->second.group_id, object_group);
-						//LL_INFOS() << "both names are loaded or aren't needed" << LL_ENDL;
-						std::string onU = object_owner;
-						std::string cnU = object_group;
-						LLStringUtil::toLower(object_name);
-						LLStringUtil::toLower(object_desc);
-						LLStringUtil::toLower(object_owner);
-						LLStringUtil::toLower(object_group);
-						if ((mFilterStrings[LIST_OBJECT_NAME].empty() || object_name.find(mFilterStrings[LIST_OBJECT_NAME]) != std::string::npos) &&
-							(mFilterStrings[LIST_OBJECT_DESC].empty() || object_desc.find(mFilterStrings[LIST_OBJECT_DESC]) != std::string::npos) &&
-							(mFilterStrings[LIST_OBJECT_OWNER].empty() || object_owner.find(mFilterStrings[LIST_OBJECT_OWNER]) != std::string::npos) &&
-							(mFilterStrings[LIST_OBJECT_GROUP].empty() || object_group.find(mFilterStrings[LIST_OBJECT_GROUP]) != std::string::npos))
+						ResultModel::Result result;
+						result.mID = object_id;
+						result.mColumns[LIST_OBJECT_NAME] = it->second.name;
+						result.mColumns[LIST_OBJECT_DESC] = it->second.desc;
+						gCacheName->getFullName(it->second.owner_id, result.mColumns[LIST_OBJECT_OWNER]);
+						gCacheName->getGroupName(it->second.group_id, result.mColumns[LIST_OBJECT_GROUP]);
+						for (S32 column = 0; column < LIST_OBJECT_COUNT; ++column)
 						{
-							//LL_INFOS() << "pass" << LL_ENDL;
-							LLSD element;
-							element["id"] = object_id;
-							element["columns"][LIST_OBJECT_NAME]["column"] = "Name";
-							element["columns"][LIST_OBJECT_NAME]["type"] = "text";
-							element["columns"][LIST_OBJECT_NAME]["value"] = it->second.name;
-							element["columns"][LIST_OBJECT_DESC]["column"] = "Description";
-							element["columns"][LIST_OBJECT_DESC]["type"] = "text";
-							element["columns"][LIST_OBJECT_DESC]["value"] = it->second.desc;
-							element["columns"][LIST_OBJECT_OWNER]["column"] = "Owner";
-							element["columns"][LIST_OBJECT_OWNER]["type"] = "text";
-							element["columns"][LIST_OBJECT_OWNER]["value"] = onU;
-							element["columns"][LIST_OBJECT_GROUP]["column"] = "Group";
-							element["columns"][LIST_OBJECT_GROUP]["type"] = "text";
-							element["columns"][LIST_OBJECT_GROUP]["value"] = cnU;			//ai->second;
-							mResultList->addElement(element, ADD_BOTTOM);
+							result.mLowerColumns[column] = result.mColumns[column];
+							LLStringUtil::toLower(result.mLowerColumns[column]);
 						}
-						
+						// The list only places the rows that changed, and filters them itself.
+						mResults.setResult(result);
+						listed.insert(object_id);
 					}
 				}
 			}
 		}
 	}
+	mResults.retain(listed);
 
-	mResultList->updateSort();
-	mResultList->selectMultiple(selected);
-	mResultList->setScrollPos(scrollpos);
 	mCounterText->setText(llformat("%d listed/%d pending/%d total", mResultList->getItemCount(), mPendingObjects.size(), mPendingObjects.size()+mCachedObjects.size()));
 	mLastUpdateTimer.reset();
 }
 
+bool JCFloaterAreaSearch::filterRow(U32 row) const
+{
+	const ResultModel::Result& result = mResults.getResult(row);
+	for (S32 column = 0; column < LIST_OBJECT_COUNT; ++column)
+	{
+		if (!mFilterStrings[column].empty() && result.mLowerColumns[column].find(mFilterStrings[column]) == std::string::npos)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void JCFloaterAreaSearch::ResultModel::getRow(U32 row, LLScrollListItem::Params& row_p) const
+{
+	static const std::string column_names[LIST_OBJECT_COUNT] = { "Name", "Description", "Owner", "Group" };
+	const Result& result = mRows[row];
+	row_p.value(result.mID);
+	for (S32 column = 0; column < LIST_OBJECT_COUNT; ++column)
+	{
+		row_p.columns.add().column(column_names[column]).type("text").value(result.mColumns[column]);
+	}
+}
+
+S32 JCFloaterAreaSearch::ResultModel::compareRows(U32 lhs, U32 rhs, S32 column) const
+{
+	if (column < 0 || column >= LIST_OBJECT_COUNT)
+	{
+		return 0;
+	}
+	return LLStringUtil::compareDict(mRows[lhs].mColumns[column], mRows[rhs].mColumns[column]);
+}
+
+void JCFloaterAreaSearch::ResultModel::setResult(const Result& result)
+{
+	std::map<LLUUID, U32>::iterator it = mRowOfID.find(result.mID);
+	if (it == mRowOfID.end())
+	{
+		U32 row = mRows.size();
+		mRows.push_back(result);
+		mRowOfID[result.mID] = row;
+		rowsInserted(row, 1);
+		return;
+	}
+
+	Result& old_result = mRows[it->second];
+	for (S32 column = 0; column < LIST_OBJECT_COUNT; ++column)
+	{
+		if (old_result.mColumns[column] != result.mColumns[column])
+		{
+			old_result = result;
+			rowsChanged(it->second);
+			return;
+		}
+	}
+}
+
+void JCFloaterAreaSearch::ResultModel::retain(const std::set<LLUUID>& ids)
+{
+	bool removed = false;
+	// From the back, so that the rows before keep their numbers, and a run
+	// of gone rows at a time, so that the list renumbers once per run
+	U32 end = mRows.size();
+	while (end > 0)
+	{
+		if (ids.count(mRows[end - 1].mID))
+		{
+			--end;
+			continue;
+		}
+		U32 first = end - 1;
+		while (first > 0 && !ids.count(mRows[first - 1].mID))
+		{
+			--first;
+		}
+		for (U32 row = first; row < end; ++row)
+		{
+			mRowOfID.erase(mRows[row].mID);
+		}
+		mRows.erase(mRows.begin() + first, mRows.begin() + end);
+		rowsRemoved(first, end - first);
+		removed = true;
+		end = first;
+	}
+	if (removed)
+	{
+		for (U32 row = 0; row < mRows.size(); ++row)
+		{
+			mRowOfID[mRows[row].mID] = row;
+		}
+	}
+}
+
+void JCFloaterAreaSearch::ResultModel::clear()
+{
+	mRows.clear();
+	mRowOfID.clear();
+	modelReset();
+}
+
 // static
 void JCFloaterAreaSearch::processObjectPropertiesFamily(LLMessageSystem* msg, void** user_data)
 {
@@ -38,6 +38,7 @@
 #include "lluuid.h"
 #include "llstring.h"
 #include "llframetimer.h"
+#include "llscrolllistmodel.h"
 
 class LLTextBox;
 class LLScrollListCtrl;
@@ -94,6 +95,37 @@ private:
 	std::set<LLUUID> mPendingObjects;
 	std::map<LLUUID, ObjectData> mCachedObjects;
 
+	// The objects listed, as the rows of mResultList
+	class ResultModel : public LLScrollListModel
+	{
+	public:
+		struct Result
+		{
+			LLUUID mID;
+			std::string mColumns[LIST_OBJECT_COUNT];
+			std::string mLowerColumns[LIST_OBJECT_COUNT];	// For the filters
+		};
+
+		/*virtual*/ U32 getRowCount() const { return mRows.size(); }
+		/*virtual*/ void getRow(U32 row, LLScrollListItem::Params& row_p) const;
+		/*virtual*/ S32 compareRows(U32 lhs, U32 rhs, S32 column) const;
+		/*virtual*/ LLSD getRowValue(U32 row) const { return mRows[row].mID; }
+
+		const Result& getResult(U32 row) const { return mRows[row]; }
+		// Adds the object, or updates its row.
+		void setResult(const Result& result);
+		// Removes the objects that are not in ids.
+		void retain(const std::set<LLUUID>& ids);
+		void clear();
+
+	private:
+		std::vector<Result> mRows;
+		std::map<LLUUID, U32> mRowOfID;
+	};
+	bool filterRow(U32 row) const;
+
+	ResultModel mResults;
+
 	std::string mFilterStrings[LIST_OBJECT_COUNT];
 };
 
@@ -95,6 +95,7 @@
 #include "lldiriterator.h"
 #include "llimagej2c.h"
 #include "llmemory.h"
+#include "llnamestore.h"
 #include "llprimitive.h"
 #include "llurlaction.h"
 #include "llurlentry.h"
@@ -117,6 +118,7 @@
 #include "llviewerkeyboard.h"
 #include "lllfsthread.h"
 #include "llworkerthread.h"
+#include "llthreadpool.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
 #include "llimageworker.h"
@@ -166,6 +168,7 @@
 #include "llvotree.h"
 #include "llfolderview.h"
 #include "lltoolbar.h"
+#include "llframebudget.h"
 #include "llframestats.h"
 #include "llagentpilot.h"
 #include "llvovolume.h"
@@ -679,6 +682,7 @@ bool LLAppViewer::init()
 	LLPrivateMemoryPoolManager::initClass((BOOL)gSavedSettings.getBOOL("MemoryPrivatePoolEnabled"), (U32)gSavedSettings.getU32("MemoryPrivatePoolSize")) ;
 
 	AIEngine::setMaxCount(gSavedSettings.getU32("StateMachineMaxTime"));
+	gFrameBudget.setLimits(LLFrameBudget::STATE_MACHINES, 0.001f, gSavedSettings.getU32("StateMachineMaxTime") / 1000.f);
 
 	{
 		AIHTTPTimeoutPolicy policy_tmp(
@@ -748,6 +752,7 @@ bool LLAppViewer::init()
 	LL_INFOS("InitInfo") << "UI initialized." << LL_ENDL ;
 
 	LLUICtrlFactory::getInstance()->setupPaths(); // update paths with correct language set
+	LLView::sRetainDraw = gSavedSettings.getBOOL("UIRetainedDraw");
 
 	// Setup LLTrans after LLUI::initClass has been called.
 	LLTrans::parseStrings("strings.xml", default_trans_args);
@@ -880,6 +885,13 @@ bool LLAppViewer::init()
 	}
 	LL_INFOS("InitInfo") << "Cache initialization is done." << LL_ENDL ;
 
+	// Keep the glyphs the fonts render for the next session.
+	if (gSavedSettings.getBOOL("FontAtlasCache"))
+	{
+		LLFontFreetype::sCacheDir = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "fonts");
+		LLFile::mkdir(LLFontFreetype::sCacheDir);
+	}
+
 	// Initialize the repeater service.
 	LLMainLoopRepeater::instance().start();
 
@@ -1360,11 +1372,12 @@ bool LLAppViewer::mainLoop()
 					ms_sleep(500);
 				}
 
-				const F64 max_idle_time = run_multiple_threads ? 0.0 : llmin(.005*10.0*gFrameIntervalSeconds, 0.005); // 50ms/second, no more than 5ms/frame
+				const F64 max_idle_time = run_multiple_threads ? 0.0 : gFrameBudget.getSlice(LLFrameBudget::WORKERS);
 				idleTimer.reset();
+				S32 work_pending = 0;
 				while(1)
 				{
-					S32 work_pending = 0;
+					work_pending = 0;
 					S32 io_pending = 0;
 					{
 						LLFastTimer ftm(FTM_TEXTURE_CACHE);
@@ -1399,6 +1412,7 @@ bool LLAppViewer::mainLoop()
 						break;
 					}
 				}
+				gFrameBudget.report(LLFrameBudget::WORKERS, idleTimer.getElapsedTimeF32(), work_pending && !run_multiple_threads);
 				if ((LLStartUp::getStartupState() >= STATE_CLEANUP) &&
 					(frameTimer.getElapsedTimeF64() > FRAME_STALL_THRESHOLD))
 				{
@@ -1813,6 +1827,7 @@ bool LLAppViewer::cleanup()
 	LLUIImageList::getInstance()->cleanUp();
 	
 	// This should eventually be done in LLAppViewer
+	LLThreadPool::cleanupClass();
 	LLImage::cleanupClass();
 	LLVFSThread::cleanupClass();
 	LLLFSThread::cleanupClass();
@@ -1927,6 +1942,7 @@ bool LLAppViewer::initThreads()
 	AICurlInterface::startCurlThread(&gSavedSettings);
 
 	LLImage::initClass();
+	LLThreadPool::initClass(enable_threads ? gSavedSettings.getS32("ThreadPoolWorkers") : 0);
 	
 	LLVFSThread::initClass(enable_threads && false);
 	LLLFSThread::initClass(enable_threads && false);
@@ -3519,6 +3535,7 @@ void LLAppViewer::purgeCache()
 	LL_INFOS("AppCache") << "Purging Cache and Texture Cache..." << LL_ENDL;
 	LLAppViewer::getTextureCache()->purgeCache(LL_PATH_CACHE);
 	LLVOCache::getInstance()->removeCache(LL_PATH_CACHE);
+	gDirUtilp->deleteFilesInDir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "fonts"), "*.atlas");
 	std::string mask = "*.*";
 	gDirUtilp->deleteFilesInDir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, ""), mask);
 }
@@ -3645,47 +3662,50 @@ void LLAppViewer::saveFinalSnapshot()
 
 void LLAppViewer::loadNameCache()
 {
-	// Phoenix: Wolfspirit: Loads the Display Name Cache. And set if we are using Display Names.
-	std::string filename =
-		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
-	LL_INFOS("AvNameCache") << filename << LL_ENDL;
-	llifstream name_cache_stream(filename);
-	if(name_cache_stream.is_open())
-	{
-		LLAvatarNameCache::importFile(name_cache_stream);
-	}
+	// Both name caches live in names.db, which they update as names come in.
+	LLNameStore* store = LLNameStore::getInstance();
+	if (!store->open(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "names.db")))
+	{
+		// No store yet: start it from the files of older viewers.
+		// Phoenix: Wolfspirit: Loads the Display Name Cache. And set if we are using Display Names.
+		std::string filename =
+			gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
+		LL_INFOS("AvNameCache") << filename << LL_ENDL;
+		llifstream name_cache_stream(filename);
+		if(name_cache_stream.is_open())
+		{
+			LLAvatarNameCache::importFile(name_cache_stream);
+		}
 
-	if (!gCacheName) return;
+		if (gCacheName)
+		{
+			std::string name_cache;
+			name_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache");
+			llifstream cache_file(name_cache);
+			if(cache_file.is_open())
+			{
+				gCacheName->importFile(cache_file);
+			}
+		}
+	}
 
-	std::string name_cache;
-	name_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache");
-	llifstream cache_file(name_cache);
-	if(cache_file.is_open())
+	LLAvatarNameCache::setStore(store);
+	if (gCacheName)
 	{
-		if(gCacheName->importFile(cache_file)) return;
+		gCacheName->setStore(store);
 	}
+	store->flush();
 }
 
 void LLAppViewer::saveNameCache()
 {
-	// Phoenix: Wolfspirit: Saves the Display Name Cache.
-	std::string filename =
-		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
-	llofstream name_cache_stream(filename);
-	if(name_cache_stream.is_open())
+	// The store is current but for the last few seconds of names.
+	LLAvatarNameCache::setStore(NULL);
+	if (gCacheName)
 	{
-		LLAvatarNameCache::exportFile(name_cache_stream);
-	}
-
-	if (!gCacheName) return;
-
-	std::string name_cache;
-	name_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache");
-	llofstream cache_file(name_cache);
-	if(cache_file.is_open())
-	{
-		gCacheName->exportFile(cache_file);
+		gCacheName->setStore(NULL);
 	}
+	LLNameStore::getInstance()->close();
 }
 
 /*!	@brief		This class is an LLFrameTimer that can be created with
@@ -3748,6 +3768,8 @@ void LLAppViewer::idle()
 		LAZY_FT("LLMortician::updateClass");
 		LLMortician::updateClass();
 	}
+	static const LLCachedControl<F32> frame_budget_target_fps(gSavedSettings, "FrameBudgetTargetFPS");
+	gFrameBudget.beginFrame(frame_budget_target_fps);
 	F32 dt_raw;
 	{
 		LAZY_FT("UpdateGlobalTimers");
@@ -3784,7 +3806,10 @@ void LLAppViewer::idle()
 
 	{
 		LLFastTimer t(FTM_STATEMACHINE);
-		gMainThreadEngine.mainloop();
+		LLTimer state_machine_timer;
+		AIEngine::setMaxCount(gFrameBudget.getSlice(LLFrameBudget::STATE_MACHINES) * 1000.f);
+		bool deferred = gMainThreadEngine.mainloop();
+		gFrameBudget.report(LLFrameBudget::STATE_MACHINES, state_machine_timer.getElapsedTimeF32(), deferred);
 	}
 
 	// Must wait until both have avatar object and mute list, so poll
@@ -4304,6 +4329,8 @@ void LLAppViewer::sendLogoutRequest()
 
 void LLAppViewer::idleNameCache()
 {
+	LLNameStore::getInstance()->idle();
+
 	// Neither old nor new name cache can function before agent has a region
 	LLViewerRegion* region = gAgent.getRegion();
 	if (!region) return;
@@ -4362,11 +4389,6 @@ void LLAppViewer::idleNameCache()
 
 #define TIME_THROTTLE_MESSAGES
 
-#ifdef TIME_THROTTLE_MESSAGES
-#define CHECK_MESSAGES_DEFAULT_MAX_TIME .020f // 50 ms = 50 fps (just for messages!)
-static F32 CheckMessagesMaxTime = CHECK_MESSAGES_DEFAULT_MAX_TIME;
-#endif
-
 static LLFastTimer::DeclareTimer FTM_IDLE_NETWORK("Idle Network");
 static LLFastTimer::DeclareTimer FTM_MESSAGE_ACKS("Message Acks");
 static LLFastTimer::DeclareTimer FTM_RETRANSMIT("Retransmit");
@@ -4391,6 +4413,11 @@ void LLAppViewer::idleNetwork()
 		//  Read all available packets from network 
 		const S64 frame_count = gFrameCount;  // U32->S64
 		F32 total_time = 0.0f;
+#ifdef TIME_THROTTLE_MESSAGES
+		// Grows while messages are left over, see LLFrameBudget.
+		const F32 max_time = gFrameBudget.getSlice(LLFrameBudget::NETWORK);
+		bool deferred = false;
+#endif
 
 		while (gMessageSystem->checkAllMessages(frame_count, gServicePump))
 		{
@@ -4416,8 +4443,11 @@ void LLAppViewer::idleNetwork()
 			// of network processing time (which needs to be fixed, but this is
 			// a good limit anyway).
 			total_time = check_message_timer.getElapsedTimeF32();
-			if (total_time >= CheckMessagesMaxTime)
+			if (total_time >= max_time)
+			{
+				deferred = true;
 				break;
+			}
 #endif
 		}
 
@@ -4425,16 +4455,7 @@ void LLAppViewer::idleNetwork()
 		gMessageSystem->processAcks();
 
 #ifdef TIME_THROTTLE_MESSAGES
-		if (total_time >= CheckMessagesMaxTime)
-		{
-			// Increase CheckMessagesMaxTime so that we will eventually catch up
-			CheckMessagesMaxTime *= 1.035f; // 3.5% ~= x2 in 20 frames, ~8x in 60 frames
-		}
-		else
-		{
-			// Reset CheckMessagesMaxTime to default value
-			CheckMessagesMaxTime = CHECK_MESSAGES_DEFAULT_MAX_TIME;
-		}
+		gFrameBudget.report(LLFrameBudget::NETWORK, check_message_timer.getElapsedTimeF32(), deferred);
 #endif
 		
 
@@ -0,0 +1,217 @@
+/** 
+ * @file llavatarpositiontracker.cpp
+ * @brief Where the avatars around us are, indexed for range queries
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ * 
+ * Copyright (c) 2026, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llavatarpositiontracker.h"
+
+#include "llagent.h"
+#include "llcallbacklist.h"
+#include "llviewerobjectlist.h"
+#include "llviewerregion.h"
+#include "llvoavatar.h"
+#include "llworld.h"
+
+LLVector3d unpackLocalToGlobalPosition(U32 compact_local, const LLVector3d& origin);
+
+// A quarter region, so that a chat range query looks at a few cells
+static const F64 GRID_CELL_SIZE = 64.0;
+// Terse updates that move an avatar less than this are not worth telling anyone
+static const F64 MIN_MOVE_DISTANCE = 0.1;
+
+LLAvatarPositionTracker::LLAvatarPositionTracker()
+:	mGrid(GRID_CELL_SIZE)
+{
+	gIdleCallbacks.addFunction(&LLAvatarPositionTracker::onIdle, NULL);
+	LLWorld::instance().setRegionRemovedCallback(boost::bind(&LLAvatarPositionTracker::onRegionRemoved, this, _1));
+}
+
+LLAvatarPositionTracker::~LLAvatarPositionTracker()
+{
+	gIdleCallbacks.deleteFunction(&LLAvatarPositionTracker::onIdle, NULL);
+}
+
+void LLAvatarPositionTracker::updateRegion(const LLViewerRegion* region)
+{
+	const U64 handle = region->getHandle();
+	const LLVector3d& origin = region->getOriginGlobal();
+	const LLDynamicArray<U32>& positions = region->mMapAvatars;
+	const LLDynamicArray<LLUUID>& ids = region->mMapAvatarIDs;
+	uuid_vec_t& reported = mRegionAvatars[handle];
+
+	// Sorted, to find the ones that left in one pass.
+	uuid_vec_t current;
+	current.reserve(ids.count());
+	for (S32 i = 0, count = llmin(ids.count(), positions.count()); i < count; ++i)
+	{
+		const LLUUID& id = ids[i];
+		if (id.isNull())
+		{
+			continue;
+		}
+		current.push_back(id);
+
+		LLVOAvatar* avatarp = gObjectList.findAvatar(id);
+		setAvatar(id, handle,
+				  avatarp ? gAgent.getPosGlobalFromAgent(avatarp->getCharacterPosition()) : unpackLocalToGlobalPosition(positions[i], origin),
+				  avatarp != NULL);
+	}
+	std::sort(current.begin(), current.end());
+
+	for (uuid_vec_t::const_iterator it = reported.begin(); it != reported.end(); ++it)
+	{
+		if (!std::binary_search(current.begin(), current.end(), *it))
+		{
+			// Only if no other region has reported it since, as it does when the avatar crosses over.
+			avatar_map_t::const_iterator avatar = mAvatars.find(*it);
+			if (avatar != mAvatars.end() && avatar->second.mRegionHandle == handle)
+			{
+				removeAvatar(*it);
+			}
+		}
+	}
+	reported.swap(current);
+}
+
+void LLAvatarPositionTracker::updateAvatar(LLVOAvatar* avatarp)
+{
+	avatar_map_t::const_iterator it = mAvatars.find(avatarp->getID());
+	if (it != mAvatars.end())
+	{
+		// Only the coarse updates add avatars; they know which ones are really around.
+		setAvatar(it->first, it->second.mRegionHandle, gAgent.getPosGlobalFromAgent(avatarp->getCharacterPosition()), true);
+	}
+}
+
+bool LLAvatarPositionTracker::isDrawn(const LLUUID& id) const
+{
+	avatar_map_t::const_iterator it = mAvatars.find(id);
+	return it != mAvatars.end() && it->second.mDrawn;
+}
+
+void LLAvatarPositionTracker::getAvatarIDs(uuid_vec_t& ids) const
+{
+	ids.reserve(ids.size() + mAvatars.size());
+	for (avatar_map_t::const_iterator it = mAvatars.begin(); it != mAvatars.end(); ++it)
+	{
+		ids.push_back(it->first);
+	}
+}
+
+void LLAvatarPositionTracker::setAvatar(const LLUUID& id, U64 region_handle, const LLVector3d& position, bool drawn)
+{
+	avatar_map_t::iterator it = mAvatars.find(id);
+	if (it == mAvatars.end())
+	{
+		Avatar& avatar = mAvatars[id];
+		avatar.mRegionHandle = region_handle;
+		avatar.mDrawn = drawn;
+		mGrid.set(id, position);
+		if (mRemoved.erase(id))
+		{
+			// Left and came back within the frame
+			mMoved.insert(id);
+		}
+		else
+		{
+			mAdded.insert(id);
+		}
+		return;
+	}
+
+	Avatar& avatar = it->second;
+	avatar.mRegionHandle = region_handle;
+	const LLVector3d* old_position = mGrid.find(id);
+	if (avatar.mDrawn != drawn || dist_vec_squared(*old_position, position) >= MIN_MOVE_DISTANCE * MIN_MOVE_DISTANCE)
+	{
+		avatar.mDrawn = drawn;
+		mGrid.set(id, position);
+		if (!mAdded.count(id))
+		{
+			mMoved.insert(id);
+		}
+	}
+}
+
+void LLAvatarPositionTracker::removeAvatar(const LLUUID& id)
+{
+	mAvatars.erase(id);
+	mGrid.remove(id);
+	mMoved.erase(id);
+	if (!mAdded.erase(id))
+	{
+		mRemoved.insert(id);
+	}
+}
+
+void LLAvatarPositionTracker::onRegionRemoved(LLViewerRegion* region)
+{
+	const U64 handle = region->getHandle();
+	boost::unordered_map<U64, uuid_vec_t>::iterator reported = mRegionAvatars.find(handle);
+	if (reported == mRegionAvatars.end())
+	{
+		return;
+	}
+	for (uuid_vec_t::const_iterator it = reported->second.begin(); it != reported->second.end(); ++it)
+	{
+		avatar_map_t::const_iterator avatar = mAvatars.find(*it);
+		if (avatar != mAvatars.end() && avatar->second.mRegionHandle == handle)
+		{
+			removeAvatar(*it);
+		}
+	}
+	mRegionAvatars.erase(reported);
+}
+
+void LLAvatarPositionTracker::notifyChanges()
+{
+	if (mAdded.empty() && mMoved.empty() && mRemoved.empty())
+	{
+		return;
+	}
+
+	Changes changes;
+	changes.mAdded.assign(mAdded.begin(), mAdded.end());
+	changes.mMoved.assign(mMoved.begin(), mMoved.end());
+	changes.mRemoved.assign(mRemoved.begin(), mRemoved.end());
+	mAdded.clear();
+	mMoved.clear();
+	mRemoved.clear();
+	mChangedSignal(changes);
+}
+
+//static
+void LLAvatarPositionTracker::onIdle(void*)
+{
+	getInstance()->notifyChanges();
+}
@@ -0,0 +1,111 @@
+/** 
+ * @file llavatarpositiontracker.h
+ * @brief Where the avatars around us are, indexed for range queries
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ * 
+ * Copyright (c) 2026, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLAVATARPOSITIONTRACKER_H
+#define LL_LLAVATARPOSITIONTRACKER_H
+
+#include <boost/signals2.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "llpointgrid.h"
+#include "llsingleton.h"
+#include "lluuid.h"
+
+class LLViewerRegion;
+class LLVOAvatar;
+
+//
+// The position of every avatar that a region reports in its coarse location
+// updates, kept up to date between those by the terse updates of the
+// avatars we have objects for. The positions are the ones the radar shows:
+// the avatar's own when we have it, the coarse one otherwise.
+//
+// Changes collect during the frame and go to the listeners once per frame,
+// from idle, as lists of the avatars that arrived, moved or left.
+//
+class LLAvatarPositionTracker : public LLSingleton<LLAvatarPositionTracker>
+{
+	friend class LLSingleton<LLAvatarPositionTracker>;
+protected:
+	LLAvatarPositionTracker();
+	~LLAvatarPositionTracker();
+
+public:
+	struct Changes
+	{
+		uuid_vec_t mAdded;
+		uuid_vec_t mMoved;		// Also when we got or lost the avatar's object
+		uuid_vec_t mRemoved;
+	};
+	typedef boost::signals2::signal<void (const Changes&)> changed_signal_t;
+
+	// After region's mMapAvatars and mMapAvatarIDs were filled from a coarse location update
+	void updateRegion(const LLViewerRegion* region);
+	void updateAvatar(LLVOAvatar* avatarp);
+
+	const LLVector3d* getPosition(const LLUUID& id) const { return mGrid.find(id); }
+	// Whether we have the avatar's object, and so a precise position
+	bool isDrawn(const LLUUID& id) const;
+	void getAvatarIDs(uuid_vec_t& ids) const;
+	// Appends the avatars that are at most radius meters from center.
+	void findInRange(const LLVector3d& center, F64 radius, uuid_vec_t& ids) const { mGrid.findInRange(center, radius, ids); }
+	bool findNearest(const LLVector3d& center, F64 max_radius, LLUUID& id) const { return mGrid.findNearest(center, max_radius, id); }
+
+	boost::signals2::connection setChangedCallback(const changed_signal_t::slot_type& cb) { return mChangedSignal.connect(cb); }
+
+private:
+	struct Avatar
+	{
+		U64 mRegionHandle;		// Of the last region that reported the avatar
+		bool mDrawn;
+	};
+	typedef boost::unordered_map<LLUUID, Avatar> avatar_map_t;
+
+	void setAvatar(const LLUUID& id, U64 region_handle, const LLVector3d& position, bool drawn);
+	void removeAvatar(const LLUUID& id);
+	void onRegionRemoved(LLViewerRegion* region);
+	void notifyChanges();
+	static void onIdle(void*);
+
+	LLPointGrid<LLUUID> mGrid;
+	avatar_map_t mAvatars;
+	// What each region reported last
+	boost::unordered_map<U64, uuid_vec_t> mRegionAvatars;
+
+	uuid_set_t mAdded;
+	uuid_set_t mMoved;
+	uuid_set_t mRemoved;
+	changed_signal_t mChangedSignal;
+};
+
+#endif // LL_LLAVATARPOSITIONTRACKER_H
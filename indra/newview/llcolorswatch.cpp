@@ -123,6 +123,7 @@ void LLColorSwatchCtrl::setOriginal(const LLColor4& color)
 void LLColorSwatchCtrl::set(const LLColor4& color, BOOL update_picker, BOOL from_event)
 {
 	mColor = color; 
+	invalidateDraw();
 	LLFloaterColorPicker* pickerp = (LLFloaterColorPicker*)mPickerHandle.get();
 	if (pickerp && update_picker)
 	{
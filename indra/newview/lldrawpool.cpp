@@ -405,15 +405,58 @@ void LLRenderPass::renderTexture(U32 type, U32 mask)
 	pushBatches(type, mask, TRUE);
 }
 
+// Whether pushBatch() would set up the same state for both batches, so that
+// they can go into one draw call.
+static bool batches_share_state(const LLDrawInfo& lhs, const LLDrawInfo& rhs, BOOL texture, BOOL batch_textures)
+{
+	if (lhs.mVertexBuffer != rhs.mVertexBuffer ||
+		lhs.mDrawMode != rhs.mDrawMode ||
+		lhs.mModelMatrix != rhs.mModelMatrix)
+	{
+		return false;
+	}
+	if (!texture)
+	{
+		return true;
+	}
+	if (batch_textures && (lhs.mTextureList.size() > 1 || rhs.mTextureList.size() > 1))
+	{
+		return lhs.mTextureList == rhs.mTextureList;
+	}
+	return lhs.mTexture == rhs.mTexture && lhs.mTextureMatrix == rhs.mTextureMatrix;
+}
+
 void LLRenderPass::pushBatches(U32 type, U32 mask, BOOL texture, BOOL batch_textures)
 {
-	for (LLCullResult::drawinfo_iterator i = gPipeline.beginRenderMap(type); i != gPipeline.endRenderMap(type); ++i)	
+	static const LLCachedControl<bool> render_merge_batches("RenderMergeBatches", true);
+	const bool merge = render_merge_batches && canMergeBatches();
+
+	LLCullResult::drawinfo_iterator end = gPipeline.endRenderMap(type);
+	LLCullResult::drawinfo_iterator i = gPipeline.beginRenderMap(type);
+	while (i != end)
 	{
+		LLCullResult::drawinfo_iterator next = i + 1;
 		LLDrawInfo* pparams = *i;
 		if (pparams) 
 		{
-			pushBatch(*pparams, mask, texture, batch_textures);
+			if (merge && pparams->mVertexBuffer.notNull())
+			{ //the render map is sorted by texture and vertex buffer, so batches that can share a draw call are neighbours
+				while (next != end && *next && batches_share_state(*pparams, **next, texture, batch_textures))
+				{
+					++next;
+				}
+			}
+
+			if (next - i > 1)
+			{
+				pushMergedBatch(&*i, next - i, mask, texture, batch_textures);
+			}
+			else
+			{
+				pushBatch(*pparams, mask, texture, batch_textures);
+			}
 		}
+		i = next;
 	}
 }
 
@@ -453,44 +496,55 @@ void LLRenderPass::applyModelMatrix(LLDrawInfo& params)
 	}
 }
 
-void LLRenderPass::pushBatch(LLDrawInfo& params, U32 mask, BOOL texture, BOOL batch_textures)
+// Binds the textures of a batch; returns true if it loaded a texture matrix
+// that has to be reset after drawing.
+static bool bind_batch_textures(LLDrawInfo& params, BOOL batch_textures)
 {
-	applyModelMatrix(params);
-
 	bool tex_setup = false;
 
-	if (texture)
+	if (batch_textures && params.mTextureList.size() > 1)
 	{
-		if (batch_textures && params.mTextureList.size() > 1)
+		for (U32 i = 0; i < params.mTextureList.size(); ++i)
 		{
-			for (U32 i = 0; i < params.mTextureList.size(); ++i)
+			if (params.mTextureList[i].notNull())
 			{
-				if (params.mTextureList[i].notNull())
-				{
-					gGL.getTexUnit(i)->bind(params.mTextureList[i], TRUE);
-				}
+				gGL.getTexUnit(i)->bind(params.mTextureList[i], TRUE);
 			}
 		}
-		else
-		{ //not batching textures or batch has only 1 texture -- might need a texture matrix
-			if (params.mTexture.notNull())
-			{
-				params.mTexture->addTextureStats(params.mVSize);
-				gGL.getTexUnit(0)->bind(params.mTexture, TRUE) ;
-				if (params.mTextureMatrix)
-				{
-					tex_setup = true;
-					gGL.getTexUnit(0)->activate();
-					gGL.matrixMode(LLRender::MM_TEXTURE);
-					gGL.loadMatrix(*params.mTextureMatrix);
-					gPipeline.mTextureMatrixOps++;
-				}
-			}
-			else
+	}
+	else
+	{ //not batching textures or batch has only 1 texture -- might need a texture matrix
+		if (params.mTexture.notNull())
+		{
+			params.mTexture->addTextureStats(params.mVSize);
+			gGL.getTexUnit(0)->bind(params.mTexture, TRUE) ;
+			if (params.mTextureMatrix)
 			{
-				gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+				tex_setup = true;
+				gGL.getTexUnit(0)->activate();
+				gGL.matrixMode(LLRender::MM_TEXTURE);
+				gGL.loadMatrix(*params.mTextureMatrix);
+				gPipeline.mTextureMatrixOps++;
 			}
 		}
+		else
+		{
+			gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+		}
+	}
+
+	return tex_setup;
+}
+
+void LLRenderPass::pushBatch(LLDrawInfo& params, U32 mask, BOOL texture, BOOL batch_textures)
+{
+	applyModelMatrix(params);
+
+	bool tex_setup = false;
+
+	if (texture)
+	{
+		tex_setup = bind_batch_textures(params, batch_textures);
 	}
 	
 	if (params.mVertexBuffer.notNull())
@@ -511,6 +565,55 @@ void LLRenderPass::pushBatch(LLDrawInfo& params, U32 mask, BOOL texture, BOOL ba
 	}
 }
 
+void LLRenderPass::pushMergedBatch(LLDrawInfo* const* batches, U32 count, U32 mask, BOOL texture, BOOL batch_textures)
+{
+	LLDrawInfo& params = *batches[0];
+	applyModelMatrix(params);
+
+	bool tex_setup = false;
+
+	if (texture)
+	{
+		tex_setup = bind_batch_textures(params, batch_textures);
+		if (params.mTexture.notNull() && !(batch_textures && params.mTextureList.size() > 1))
+		{
+			for (U32 i = 1; i < count; ++i)
+			{
+				params.mTexture->addTextureStats(batches[i]->mVSize);
+			}
+		}
+	}
+
+	static std::vector<LLVertexBuffer::DrawRange> ranges;
+	ranges.resize(count);
+	U32 triangles = 0;
+	for (U32 i = 0; i < count; ++i)
+	{
+		LLDrawInfo* batch = batches[i];
+		if (batch->mGroup)
+		{
+			batch->mGroup->rebuildMesh();
+		}
+		LLVertexBuffer::DrawRange& range = ranges[i];
+		range.mStart = batch->mStart;
+		range.mEnd = batch->mEnd;
+		range.mCount = batch->mCount;
+		range.mOffset = batch->mOffset;
+		triangles += params.mDrawMode == LLRender::TRIANGLE_STRIP ? batch->mCount - 2 : batch->mCount / 3;
+	}
+
+	params.mVertexBuffer->setBuffer(mask);
+	params.mVertexBuffer->drawMultiRange(params.mDrawMode, &ranges[0], count);
+	//counts as one batch of that many triangles
+	gPipeline.addTrianglesDrawn(params.mDrawMode == LLRender::TRIANGLE_STRIP ? triangles + 2 : triangles * 3, params.mDrawMode);
+
+	if (tex_setup)
+	{
+		gGL.loadIdentity();
+		gGL.matrixMode(LLRender::MM_MODELVIEW);
+	}
+}
+
 void LLRenderPass::renderGroups(U32 type, U32 mask, BOOL texture)
 {
 	gPipeline.renderGroups(this, type, mask, texture);
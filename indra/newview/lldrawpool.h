@@ -165,9 +165,13 @@ public:
 	void resetDrawOrders() { }
 
 	static void applyModelMatrix(LLDrawInfo& params);
+	// pushBatches() draws runs of batches that share every bit of state with
+	// one call. Pools whose pushBatch() sets per batch state must return FALSE.
+	virtual BOOL canMergeBatches() const { return TRUE; }
 	virtual void pushBatches(U32 type, U32 mask, BOOL texture = TRUE, BOOL batch_textures = FALSE);
 	virtual void pushMaskBatches(U32 type, U32 mask, BOOL texture = TRUE, BOOL batch_textures = FALSE);
 	virtual void pushBatch(LLDrawInfo& params, U32 mask, BOOL texture, BOOL batch_textures = FALSE);
+	void pushMergedBatch(LLDrawInfo* const* batches, U32 count, U32 mask, BOOL texture, BOOL batch_textures);
 	virtual void renderGroup(LLSpatialGroup* group, U32 type, U32 mask, BOOL texture = TRUE);
 	virtual void renderGroups(U32 type, U32 mask, BOOL texture = TRUE);
 	virtual void renderTexture(U32 type, U32 mask);
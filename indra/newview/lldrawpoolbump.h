@@ -62,6 +62,7 @@ public:
 	virtual S32	 getNumPasses();
 	/*virtual*/ void prerender();
 	/*virtual*/ void pushBatch(LLDrawInfo& params, U32 mask, BOOL texture, BOOL batch_textures = FALSE);
+	/*virtual*/ BOOL canMergeBatches() const { return FALSE; }
 
 	void renderBump(U32 type, U32 mask);
 	void renderGroup(LLSpatialGroup* group, U32 type, U32 mask, BOOL texture);
@@ -70,6 +70,7 @@ public:
 	void bindNormalMap(LLViewerTexture* tex);
 	
 	/*virtual*/ void pushBatch(LLDrawInfo& params, U32 mask, BOOL texture, BOOL batch_textures = FALSE);
+	/*virtual*/ BOOL canMergeBatches() const { return FALSE; }
 };
 
 #endif //LL_LLDRAWPOOLMATERIALS_H
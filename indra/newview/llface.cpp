@@ -59,6 +59,7 @@
 #include "llviewershadermgr.h"
 #include "llviewertexture.h"
 #include "llvoavatar.h"
+#include "llthreadpool.h"
 
 #define LL_MAX_INDICES_COUNT 1000000
 
@@ -756,50 +757,6 @@ static void xform(LLVector2 &tex_coord, F32 cosAng, F32 sinAng, F32 offS, F32 of
 	tex_coord.mV[1] = t;
 }
 
-// Transform the texture coordinates for this face.
-static void xform4a(LLVector4a &tex_coord, const LLVector4a& trans, const LLVector4Logical& mask, const LLVector4a& rot0, const LLVector4a& rot1, const LLVector4a& offset, const LLVector4a& scale) 
-{
-	//tex coord is two coords, <s0, t0, s1, t1>
-	LLVector4a st;
-
-	// Texture transforms are done about the center of the face.
-	st.setAdd(tex_coord, trans);
-	
-	// Handle rotation
-	LLVector4a rot_st;
-		
-	// <s0 * cosAng, s0*-sinAng, s1*cosAng, s1*-sinAng>
-	LLVector4a s0;
-	s0.splat(st, 0);
-	LLVector4a s1;
-	s1.splat(st, 2);
-	LLVector4a ss;
-	ss.setSelectWithMask(mask, s1, s0);
-
-	LLVector4a a; 
-	a.setMul(rot0, ss);
-	
-	// <t0*sinAng, t0*cosAng, t1*sinAng, t1*cosAng>
-	LLVector4a t0;
-	t0.splat(st, 1);
-	LLVector4a t1;
-	t1.splat(st, 3);
-	LLVector4a tt;
-	tt.setSelectWithMask(mask, t1, t0);
-
-	LLVector4a b;
-	b.setMul(rot1, tt);
-		
-	st.setAdd(a,b);
-
-	// Then scale
-	st.mul(scale);
-
-	// Then offset
-	tex_coord.setAdd(st, offset);
-}
-
-
 bool less_than_max_mag(const LLVector4a& vec)
 {
 #if 1
@@ -1186,12 +1143,6 @@ void push_for_transform(LLVertexBuffer* buff, U32 source_count, U32 dest_count)
 	}
 }
 static LLFastTimer::DeclareTimer FTM_FACE_GET_GEOM("Face Geom");
-static LLFastTimer::DeclareTimer FTM_FACE_GEOM_POSITION("Position");
-static LLFastTimer::DeclareTimer FTM_FACE_GEOM_NORMAL("Normal");
-static LLFastTimer::DeclareTimer FTM_FACE_GEOM_TEXTURE("Texture");
-static LLFastTimer::DeclareTimer FTM_FACE_GEOM_COLOR("Color");
-static LLFastTimer::DeclareTimer FTM_FACE_GEOM_EMISSIVE("Emissive");
-static LLFastTimer::DeclareTimer FTM_FACE_GEOM_WEIGHTS("Weights");
 static LLFastTimer::DeclareTimer FTM_FACE_GEOM_TANGENT("Binormal");
 
 static LLFastTimer::DeclareTimer FTM_FACE_GEOM_FEEDBACK("Face Feedback");
@@ -1202,16 +1153,17 @@ static LLFastTimer::DeclareTimer FTM_FACE_GEOM_FEEDBACK_COLOR("Feedback  Color")
 static LLFastTimer::DeclareTimer FTM_FACE_GEOM_FEEDBACK_EMISSIVE("Feedback  Emissive");
 static LLFastTimer::DeclareTimer FTM_FACE_GEOM_FEEDBACK_BINORMAL("Feedback Binormal");
 
-static LLFastTimer::DeclareTimer FTM_FACE_GEOM_INDEX("Index");
-static LLFastTimer::DeclareTimer FTM_FACE_GEOM_INDEX_TAIL("Tail");
-static LLFastTimer::DeclareTimer FTM_FACE_POSITION_STORE("Pos");
-static LLFastTimer::DeclareTimer FTM_FACE_TEXTURE_INDEX_STORE("TexIdx");
-static LLFastTimer::DeclareTimer FTM_FACE_POSITION_PAD("Pad");
-static LLFastTimer::DeclareTimer FTM_FACE_TEX_DEFAULT("Default");
-static LLFastTimer::DeclareTimer FTM_FACE_TEX_QUICK("Quick");
-static LLFastTimer::DeclareTimer FTM_FACE_TEX_QUICK_NO_XFORM("No Xform");
-static LLFastTimer::DeclareTimer FTM_FACE_TEX_QUICK_XFORM("Xform");
-static LLFastTimer::DeclareTimer FTM_FACE_TEX_QUICK_PLANAR("Quick Planar");
+static LLFastTimer::DeclareTimer FTM_FACE_GEOM_PACK("Face Pack");
+
+static void set_xform_params(LLVertexPack::TexCoordParams& params, F32 cos_ang, F32 sin_ang, F32 os, F32 ot, F32 ms, F32 mt)
+{
+	params.mCos = cos_ang;
+	params.mSin = sin_ang;
+	params.mOffsetS = os;
+	params.mOffsetT = ot;
+	params.mScaleS = ms;
+	params.mScaleT = mt;
+}
 
 BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 							   const S32 &f,
@@ -1220,6 +1172,22 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 								bool force_rebuild)
 {
 	LLFastTimer t(FTM_FACE_GET_GEOM);
+	GeometryJob job;
+	if (!prepareGeometryVolume(job, volume, f, mat_vert_in, mat_norm_in, index_offset, force_rebuild))
+	{
+		return FALSE;
+	}
+	packGeometryVolume(job);
+	return TRUE;
+}
+
+BOOL LLFace::prepareGeometryVolume(GeometryJob& job,
+								const LLVolume& volume,
+								const S32 &f,
+								const LLMatrix4a& mat_vert_in, const LLMatrix4a& mat_norm_in,
+								const U16 &index_offset,
+								bool force_rebuild)
+{
 	llassert(verify());
 	const LLVolumeFace &vf = volume.getVolumeFace(f);
 	S32 num_vertices = (S32)vf.mNumVertices;
@@ -1261,15 +1229,6 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		}
 	}
 
-	LLStrider<LLVector3> vert;
-	LLStrider<LLVector2> tex_coords0;
-	LLStrider<LLVector2> tex_coords1;
-	LLStrider<LLVector3> norm;
-	LLStrider<LLColor4U> colors;
-	LLStrider<LLVector3> tangent;
-	LLStrider<U16> indicesp;
-	LLStrider<LLVector4a> wght;
-
 	BOOL full_rebuild = force_rebuild || mDrawablep->isState(LLDrawable::REBUILD_VOLUME);
 	
 	BOOL global_volume = mDrawablep->getVOVolume()->isVolumeGlobal();
@@ -1297,8 +1256,6 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 	BOOL is_static = mDrawablep->isStatic();
 	BOOL is_global = is_static;
 
-	LLVector3 center_sum(0.f, 0.f, 0.f);
-	
 	if (is_global)
 	{
 		setState(GLOBAL);
@@ -1328,42 +1285,42 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		}
 	}
 
+	job.mFace = this;
+	job.mVolumeFace = &vf;
+	job.mMatVert = mat_vert_in;
+	job.mMatNormal = mat_norm_in;
+	job.mBumpQuat = LLQuaternion();
+	job.mBumpSLightRay.clear();
+	job.mBumpTLightRay.clear();
+	job.mNumVertices = num_vertices;
+	job.mNumIndices = num_indices;
+	job.mGeomCount = mGeomCount;
+	job.mIndexOffset = index_offset;
+	job.mTextureIndex = mTextureIndex < 255 ? mTextureIndex : 0;
+	job.mColor = color.mAll;
+	job.mGlow = 0;
+	job.mTexCoordKernel = NULL;
+	job.mPackIndices = full_rebuild;
+	job.mPackPosition = false;
+	job.mPackNormal = false;
+	job.mPackTangent = false;
+	job.mPackWeights = false;
+	job.mPackColor = false;
+	job.mPackEmissive = false;
+	job.mPackTexCoord = false;
+	job.mBumpOffsets = false;
+	job.mActive = false;
+	for (U32 ch = 0; ch < 3; ++ch)
+	{
+		job.mTexCoords[ch] = (LLVector2*) NULL;
+	}
+
 	// INDICES
 	if (full_rebuild)
 	{
-		LLFastTimer t(FTM_FACE_GEOM_INDEX);
-		mVertexBuffer->getIndexStrider(indicesp, mIndicesIndex, mIndicesCount, map_range);
-
-		volatile __m128i* dst = (__m128i*) indicesp.get();
-		__m128i* src = (__m128i*) vf.mIndices;
-		__m128i offset = _mm_set1_epi16(index_offset);
-
-		S32 end = num_indices/8;
-		
-		for (S32 i = 0; i < end; i++)
-		{
-			__m128i res = _mm_add_epi16(src[i], offset);
-			_mm_storeu_si128((__m128i*) dst++, res);
-		}
-
-		{
-			LLFastTimer t(FTM_FACE_GEOM_INDEX_TAIL);
-			U16* idx = (U16*) dst;
-
-			for (S32 i = end*8; i < num_indices; ++i)
-			{
-				*idx++ = vf.mIndices[i]+index_offset;
-			}
-		}
-
-		if (map_range)
-		{
-			mVertexBuffer->flush();
-		}
+		mVertexBuffer->getIndexStrider(job.mIndices, mIndicesIndex, mIndicesCount, map_range);
 	}
 	
-	const LLMatrix4a& mat_normal = mat_norm_in;
-	
 	F32 r = 0, os = 0, ot = 0, ms = 0, mt = 0, cos_ang = 0, sin_ang = 0;
 	bool do_xform = false;
 	if (rebuild_tcoord)
@@ -1552,17 +1509,10 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 
 		if (rebuild_tcoord)
 		{
-			LLFastTimer t(FTM_FACE_GEOM_TEXTURE);
-									
-			//bump setup
-			LLVector4a binormal_dir( -sin_ang, cos_ang, 0.f );
-			LLVector4a bump_s_primary_light_ray(0.f, 0.f, 0.f);
-			LLVector4a bump_t_primary_light_ray(0.f, 0.f, 0.f);
-
-			LLQuaternion bump_quat;
 			if (mDrawablep->isActive())
 			{
-				bump_quat = LLQuaternion(LLMatrix4(mDrawablep->getRenderMatrix().getF32ptr()));
+				job.mActive = true;
+				job.mBumpQuat = LLQuaternion(LLMatrix4(mDrawablep->getRenderMatrix().getF32ptr()));
 			}
 		
 			if (bump_code)
@@ -1609,8 +1559,8 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 				LLVector3   moon_ray = gSky.getMoonDirection();
 				LLVector3& primary_light_ray = (sun_ray.mV[VZ] > 0) ? sun_ray : moon_ray;
 
-				bump_s_primary_light_ray.load3((offset_multiple * s_scale * primary_light_ray).mV);
-				bump_t_primary_light_ray.load3((offset_multiple * t_scale * primary_light_ray).mV);
+				job.mBumpSLightRay.load3((offset_multiple * s_scale * primary_light_ray).mV);
+				job.mBumpTLightRay.load3((offset_multiple * t_scale * primary_light_ray).mV);
 			}
 
 			U8 texgen = getTextureEntry()->getTexGen();
@@ -1654,9 +1604,6 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 				}
 			}
 
-			LLVector4a scalea;
-			scalea.load3(scale.mV);
-
 			LLMaterial* mat = tep->getMaterialParams().get();
 
 			bool do_bump = bump_code && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1);
@@ -1666,500 +1613,127 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 				do_bump  = mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1)
 					     || mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD2);
 			}
-			
-			bool do_tex_mat = tex_mode && mTextureMatrix;
-
-			if (!do_bump)
-			{ //not in atlas or not bump mapped, might be able to do a cheap update
-				mVertexBuffer->getTexCoord0Strider(tex_coords0, mGeomIndex, mGeomCount);
-
-				if (texgen != LLTextureEntry::TEX_GEN_PLANAR)
-				{
-					LLFastTimer t(FTM_FACE_TEX_QUICK);
-					if (!do_tex_mat)
-					{
-						if (!do_xform)
-						{
-							LLFastTimer t(FTM_FACE_TEX_QUICK_NO_XFORM);
-							S32 tc_size = (num_vertices*2*sizeof(F32)+0xF) & ~0xF;
-							LLVector4a::memcpyNonAliased16((F32*) tex_coords0.get(), (F32*) vf.mTexCoords, tc_size);
-						}
-						else
-						{
-							LLFastTimer t(FTM_FACE_TEX_QUICK_XFORM);
-							F32* dst = (F32*) tex_coords0.get();
-							LLVector4a* src = (LLVector4a*) vf.mTexCoords;
-
-							LLVector4a trans;
-							trans.splat(-0.5f);
-
-							LLVector4a rot0;
-							rot0.set(cos_ang, -sin_ang, cos_ang, -sin_ang);
 
-							LLVector4a rot1;
-							rot1.set(sin_ang, cos_ang, sin_ang, cos_ang);
+			// Pick the kernel up front; the channels only differ in parameters
+			const bool planar = texgen == LLTextureEntry::TEX_GEN_PLANAR;
+			const LLMatrix4a* tex_mat = tex_mode ? mTextureMatrix : NULL;
 
-							LLVector4a scale;
-							scale.set(ms, mt, ms, mt);
+			LLVertexPack::TexCoordParams params;
+			params.mTexCoords = vf.mTexCoords;
+			params.mPositions = vf.mPositions;
+			params.mNormals = vf.mNormals;
+			params.mScale[0] = scale.mV[VX];
+			params.mScale[1] = scale.mV[VY];
+			params.mScale[2] = scale.mV[VZ];
+			params.mMatrix = tex_mat;
+			set_xform_params(params, cos_ang, sin_ang, os, ot, ms, mt);
 
-							LLVector4a offset;
-							offset.set(os+0.5f, ot+0.5f, os+0.5f, ot+0.5f);
+			job.mPackTexCoord = true;
 
-							LLVector4Logical mask;
-							mask.clear();
-							mask.setElement<2>();
-							mask.setElement<3>();
-
-							U32 count = num_vertices/2 + num_vertices%2;
-
-							for (U32 i = 0; i < count; i++)
-							{	
-								LLVector4a res = *src++;
-								xform4a(res, trans, mask, rot0, rot1, offset, scale);
-								res.store4a(dst);
-								dst += 4;
-							}
-						}
-					}
-					else
-					{ //do tex mat, no texgen, no atlas, no bump
-						for (S32 i = 0; i < num_vertices; i++)
-						{
-							//LLVector4a& norm = vf.mNormals[i];
-							//LLVector4a& center = *(vf.mCenter);
-							LLVector4a tc(vf.mTexCoords[i].mV[VX],vf.mTexCoords[i].mV[VY],0.f);
-							mTextureMatrix->affineTransform(tc,tc);
-							(tex_coords0++)->set(tc.getF32ptr());
-						}
-					}
-				}
-				else
-				{ //no bump, no atlas, tex gen planar
-					LLFastTimer t(FTM_FACE_TEX_QUICK_PLANAR);
-					if (do_tex_mat)
-					{
-						for (S32 i = 0; i < num_vertices; i++)
-						{	
-							LLVector2 tc(vf.mTexCoords[i]);
-							LLVector4a& norm = vf.mNormals[i];
-							LLVector4a& center = *(vf.mCenter);
-							LLVector4a vec = vf.mPositions[i];	
-							vec.mul(scalea);
-							planarProjection(tc, norm, center, vec);
-						
-							LLVector4a tmp(tc.mV[VX],tc.mV[VY],0.f);
-							mTextureMatrix->affineTransform(tmp,tmp);
-							(tex_coords0++)->set(tmp.getF32ptr());
-						}
-					}
-					else
-					{
-						for (S32 i = 0; i < num_vertices; i++)
-						{	
-							LLVector2 tc(vf.mTexCoords[i]);
-							LLVector4a& norm = vf.mNormals[i];
-							LLVector4a& center = *(vf.mCenter);
-							LLVector4a vec = vf.mPositions[i];	
-							vec.mul(scalea);
-							planarProjection(tc, norm, center, vec);
-						
-							xform(tc, cos_ang, sin_ang, os, ot, ms, mt);
-
-							*tex_coords0++ = tc;	
-						}
-					}
+			if (!do_bump)
+			{ //not in atlas or not bump mapped, might be able to do a cheap update
+				LLVertexPack::ETexCoordTransform transform = LLVertexPack::TC_NONE;
+				if (tex_mat)
+				{
+					transform = LLVertexPack::TC_MATRIX;
 				}
-
-				if (map_range)
+				else if (planar || do_xform)
 				{
-					mVertexBuffer->flush();
+					transform = LLVertexPack::TC_XFORM;
 				}
+				job.mTexCoordKernel = LLVertexPack::getTexCoordKernel(planar, transform);
+				job.mTexCoordParams[0] = params;
+				mVertexBuffer->getTexCoord0Strider(job.mTexCoords[0], mGeomIndex, mGeomCount);
 			}
 			else
 			{ //either bump mapped or in atlas, just do the whole expensive loop
-				LLFastTimer t(FTM_FACE_TEX_DEFAULT);
-
-				std::vector<LLVector2> bump_tc;
+				job.mTexCoordKernel = LLVertexPack::getTexCoordKernel(planar, tex_mat ? LLVertexPack::TC_MATRIX : LLVertexPack::TC_XFORM);
 
-				if (mat && !mat->getNormalID().isNull())
-				{ //writing out normal and specular texture coordinates, not bump offsets
-					do_bump = false;
-				}
+				// Without a material, texture coordinate 1 gets emboss offsets
+				job.mBumpOffsets = !mat;
 
-				LLStrider<LLVector2> dst;
+				job.mTexCoordParams[0] = params;
+				mVertexBuffer->getTexCoord0Strider(job.mTexCoords[0], mGeomIndex, mGeomCount, map_range);
 
-				for (U32 ch = 0; ch < 3; ++ch)
+				if (mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1))
 				{
-					switch (ch)
+					mVertexBuffer->getTexCoord1Strider(job.mTexCoords[1], mGeomIndex, mGeomCount, map_range);
+					if (mat && !tex_anim)
 					{
-						case 0: 
-							mVertexBuffer->getTexCoord0Strider(dst, mGeomIndex, mGeomCount, map_range); 
-							break;
-						case 1:
-							if (mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1))
-							{
-								mVertexBuffer->getTexCoord1Strider(dst, mGeomIndex, mGeomCount, map_range);
-								if (mat && !tex_anim)
-								{
-									r  = mat->getNormalRotation();
-									mat->getNormalOffset(os, ot);
-									mat->getNormalRepeat(ms, mt);
-
-									cos_ang = cos(r);
-									sin_ang = sin(r);
-
-								}
-							}
-							else
-							{
-								continue;
-							}
-							break;
-						case 2:
-							if (mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD2))
-							{
-								mVertexBuffer->getTexCoord2Strider(dst, mGeomIndex, mGeomCount, map_range);
-								if (mat && !tex_anim)
-								{
-									r  = mat->getSpecularRotation();
-									mat->getSpecularOffset(os, ot);
-									mat->getSpecularRepeat(ms, mt);
-
-									cos_ang = cos(r);
-									sin_ang = sin(r);
-								}
-							}
-							else
-							{
-								continue;
-							}
-							break;
-					}
-					
+						r  = mat->getNormalRotation();
+						mat->getNormalOffset(os, ot);
+						mat->getNormalRepeat(ms, mt);
 
-					for (S32 i = 0; i < num_vertices; i++)
-					{	
-						LLVector2 tc(vf.mTexCoords[i]);
-			
-						LLVector4a& norm = vf.mNormals[i];
-				
-						LLVector4a& center = *(vf.mCenter);
-		   
-						if (texgen != LLTextureEntry::TEX_GEN_DEFAULT)
-						{
-							LLVector4a vec = vf.mPositions[i];
-				
-							vec.mul(scalea);
-
-							if (texgen == LLTextureEntry::TEX_GEN_PLANAR)
-							{
-								planarProjection(tc, norm, center, vec);
-							}
-						}
-
-						if (tex_mode && mTextureMatrix)
-						{
-							LLVector4a tmp(tc.mV[VX],tc.mV[VY],0.f);
-							mTextureMatrix->affineTransform(tmp,tmp);
-							tc.set(tmp.getF32ptr());
-						}
-						else
-						{
-							xform(tc, cos_ang, sin_ang, os, ot, ms, mt);
-						}
-
-						*dst++ = tc;
-						if (do_bump)
-						{
-							bump_tc.push_back(tc);
-						}
+						cos_ang = cos(r);
+						sin_ang = sin(r);
+						set_xform_params(params, cos_ang, sin_ang, os, ot, ms, mt);
 					}
+					job.mTexCoordParams[1] = params;
 				}
 
-				if (map_range)
+				if (mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD2))
 				{
-					mVertexBuffer->flush();
-				}
-
-				if (!mat && do_bump)
-				{
-					mVertexBuffer->getTexCoord1Strider(tex_coords1, mGeomIndex, mGeomCount, map_range);
-		
-					for (S32 i = 0; i < num_vertices; i++)
+					mVertexBuffer->getTexCoord2Strider(job.mTexCoords[2], mGeomIndex, mGeomCount, map_range);
+					if (mat && !tex_anim)
 					{
-						LLVector4a tangent = vf.mTangents[i];
-
-						LLVector4a binorm;
-						binorm.setCross3(vf.mNormals[i], tangent);
-						binorm.mul(tangent.getF32ptr()[3]);
-						
-						LLMatrix4a tangent_to_object;
-						tangent_to_object.setRows(tangent, binorm, vf.mNormals[i]);
-						LLVector4a t;
-						tangent_to_object.rotate(binormal_dir, t);
-						LLVector4a binormal;
-						mat_normal.rotate(t, binormal);
-						
-						//VECTORIZE THIS
-						if (mDrawablep->isActive())
-						{
-							LLVector3 t;
-							t.set(binormal.getF32ptr());
-							t *= bump_quat;
-							binormal.load3(t.mV);
-						}
+						r  = mat->getSpecularRotation();
+						mat->getSpecularOffset(os, ot);
+						mat->getSpecularRepeat(ms, mt);
 
-						binormal.normalize3fast();
-
-						LLVector2 tc = bump_tc[i];
-						tc += LLVector2( bump_s_primary_light_ray.dot3(tangent).getF32(), bump_t_primary_light_ray.dot3(binormal).getF32() );
-					
-						*tex_coords1++ = tc;
-					}
-
-					if (map_range)
-					{
-						mVertexBuffer->flush();
+						cos_ang = cos(r);
+						sin_ang = sin(r);
+						set_xform_params(params, cos_ang, sin_ang, os, ot, ms, mt);
 					}
+					job.mTexCoordParams[2] = params;
 				}
 			}
 		}
 
 		if (rebuild_pos)
 		{
-			LLVector4a* src = vf.mPositions;
-			
-			//_mm_prefetch((char*)src, _MM_HINT_T0);
-
-			LLVector4a* end = src+num_vertices;
-			//LLVector4a* end_64 = end-4;
-
-			//LLFastTimer t(FTM_FACE_GEOM_POSITION);
 			llassert(num_vertices > 0);
-		
-			mVertexBuffer->getVertexStrider(vert, mGeomIndex, mGeomCount, map_range);
-			
-			const LLMatrix4a& mat_vert = mat_vert_in;
-
-			F32* dst = (F32*) vert.get();
-			F32* end_f32 = dst+mGeomCount*4;
-
-			//_mm_prefetch((char*)dst, _MM_HINT_NTA);
-			//_mm_prefetch((char*)src, _MM_HINT_NTA);
-				
-			//_mm_prefetch((char*)dst, _MM_HINT_NTA);
-
-
-			LLVector4a res0; //,res1,res2,res3;
-
-			LLVector4a texIdx;
-
-			S32 index = mTextureIndex < 255 ? mTextureIndex : 0;
-
-			F32 val = 0.f;
-			S32* vp = (S32*) &val;
-			*vp = index;
-			
-			llassert(index <= LLGLSLShader::sIndexedTextureChannels-1);
-
-			LLVector4Logical mask;
-			mask.clear();
-			mask.setElement<3>();
-		
-			texIdx.set(0,0,0,val);
-
-			LLVector4a tmp;
-
-			{
-				//LLFastTimer t2(FTM_FACE_POSITION_STORE);
-
-				/*if (num_vertices > 4)
-				{ //more than 64 bytes
-					while (src < end_64)
-					{	
-						_mm_prefetch((char*)src + 64, _MM_HINT_T0);
-						_mm_prefetch((char*)dst + 64, _MM_HINT_T0);
-
-						mat_vert.affineTransform(*src, res0);
-						tmp.setSelectWithMask(mask, texIdx, res0);
-						tmp.store4a((F32*) dst);
-
-						mat_vert.affineTransform(*(src+1), res1);
-						tmp.setSelectWithMask(mask, texIdx, res1);
-						tmp.store4a((F32*) dst+4);
-
-						mat_vert.affineTransform(*(src+2), res2);
-						tmp.setSelectWithMask(mask, texIdx, res2);
-						tmp.store4a((F32*) dst+8);
-
-						mat_vert.affineTransform(*(src+3), res3);
-						tmp.setSelectWithMask(mask, texIdx, res3);
-						tmp.store4a((F32*) dst+12);
-
-						dst += 16;
-						src += 4;
-					}
-				}*/
-
-				while (src < end)
-				{	
-					mat_vert.affineTransform(*src++, res0);
-					tmp.setSelectWithMask(mask, texIdx, res0);
-					tmp.store4a((F32*) dst);
-					dst += 4;
-				}
-			}
-
-			{
-				//LLFastTimer t(FTM_FACE_POSITION_PAD);
-				while (dst < end_f32)
-				{
-					res0.store4a((F32*) dst);
-					dst += 4;
-				}
-			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
+			job.mPackPosition = true;
+			mVertexBuffer->getVertexStrider(job.mPositions, mGeomIndex, mGeomCount, map_range);
+			llassert(job.mTextureIndex <= LLGLSLShader::sIndexedTextureChannels-1);
 		}
-
 		
 		if (rebuild_normal)
 		{
-			//LLFastTimer t(FTM_FACE_GEOM_NORMAL);
-			mVertexBuffer->getNormalStrider(norm, mGeomIndex, mGeomCount, map_range);
-			F32* normals = (F32*) norm.get();
-			LLVector4a* src = vf.mNormals;
-			LLVector4a* end = src+num_vertices;
-			
-			while (src < end)
-			{	
-				LLVector4a normal;
-				mat_normal.rotate(*src++, normal);
-				normal.store4a(normals);
-				normals += 4;
-			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
+			job.mPackNormal = true;
+			mVertexBuffer->getNormalStrider(job.mNormals, mGeomIndex, mGeomCount, map_range);
 		}
 		
 		if (rebuild_tangent)
 		{
 			LLFastTimer t(FTM_FACE_GEOM_TANGENT);
-			mVertexBuffer->getTangentStrider(tangent, mGeomIndex, mGeomCount, map_range);
-			F32* tangents = (F32*) tangent.get();
-			
+			job.mPackTangent = true;
+			mVertexBuffer->getTangentStrider(job.mTangents, mGeomIndex, mGeomCount, map_range);
 			mVObjp->getVolume()->genTangents(f);
-			
-			LLVector4a* src = vf.mTangents;
-			LLVector4a* end = vf.mTangents+num_vertices;
-
-			while (src < end)
-			{
-				LLVector4a tangent_out;
-				mat_normal.rotate(*src, tangent_out);
-				tangent_out.normalize3fast();
-				tangent_out.copyComponent<3>(*src);
-				tangent_out.store4a(tangents);
-				
-				src++;
-				tangents += 4;
-			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
 		}
 	
 		if (rebuild_weights && vf.mWeights)
 		{
-			LLFastTimer t(FTM_FACE_GEOM_WEIGHTS);
-			mVertexBuffer->getWeight4Strider(wght, mGeomIndex, mGeomCount, map_range);
-			for(S32 i=0;i<num_vertices;++i)
-			{
-				*(wght++) = vf.mWeights[i];
-			}
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
+			job.mPackWeights = true;
+			mVertexBuffer->getWeight4Strider(job.mWeights, mGeomIndex, mGeomCount, map_range);
 		}
 
 		if (rebuild_color && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_COLOR) )
 		{
-			LLFastTimer t(FTM_FACE_GEOM_COLOR);
-			mVertexBuffer->getColorStrider(colors, mGeomIndex, mGeomCount, map_range);
-
-			LLVector4a src;
-
-			U32 vec[4];
-			vec[0] = vec[1] = vec[2] = vec[3] = color.mAll;
-		
-			src.loadua((F32*) vec);
-
-			F32* dst = (F32*) colors.get();
-			S32 num_vecs = num_vertices/4;
-			if (num_vertices%4 > 0)
-			{
-				++num_vecs;
-			}
-
-			for (S32 i = 0; i < num_vecs; i++)
-			{	
-				src.store4a(dst);
-				dst += 4;
-			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
+			job.mPackColor = true;
+			mVertexBuffer->getColorStrider(job.mColors, mGeomIndex, mGeomCount, map_range);
 		}
 
 		if (rebuild_emissive)
 		{
-			LLFastTimer t(FTM_FACE_GEOM_EMISSIVE);
-			LLStrider<LLColor4U> emissive;
-			mVertexBuffer->getEmissiveStrider(emissive, mGeomIndex, mGeomCount, map_range);
+			job.mPackEmissive = true;
+			mVertexBuffer->getEmissiveStrider(job.mEmissive, mGeomIndex, mGeomCount, map_range);
 
 			U8 glow = (U8) llclamp((S32) (getTextureEntry()->getGlow()*255), 0, 255);
 
-			LLVector4a src;
-
-		
-			U32 glow32 = glow |
-						 (glow << 8) |
-						 (glow << 16) |
-						 (glow << 24);
-
-			U32 vec[4];
-			std::fill_n(vec,4,glow32); // for clang
-		
-			src.loadua((F32*) vec);
-
-			F32* dst = (F32*) emissive.get();
-			S32 num_vecs = num_vertices/4;
-			if (num_vertices%4 > 0)
-			{
-				++num_vecs;
-			}
-
-			for (S32 i = 0; i < num_vecs; i++)
-			{	
-				src.store4a(dst);
-				dst += 4;
-			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
+			job.mGlow = glow |
+						(glow << 8) |
+						(glow << 16) |
+						(glow << 24);
 		}
 	}
 
@@ -2178,10 +1752,168 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		mTexExtents[1][1] *= et ;
 	}
 
-
 	return TRUE;
 }
 
+//static
+void LLFace::packGeometryVolume(const GeometryJob& job)
+{
+	const LLVolumeFace& vf = *job.mVolumeFace;
+	const S32 num_vertices = job.mNumVertices;
+
+	if (job.mPackIndices)
+	{
+		LLStrider<U16> indicesp = job.mIndices;
+		LLVertexPack::offsetIndices(vf.mIndices, job.mNumIndices, job.mIndexOffset, indicesp.get());
+	}
+
+	if (job.mPackTexCoord)
+	{
+		std::vector<LLVector2> bump_tc;
+
+		for (U32 ch = 0; ch < 3; ++ch)
+		{
+			LLStrider<LLVector2> dst = job.mTexCoords[ch];
+			if (!dst.get() || (ch == 1 && job.mBumpOffsets))
+			{ //unmapped, or overwritten with emboss offsets below
+				continue;
+			}
+
+			if (ch == 0 && job.mBumpOffsets)
+			{ //keep a copy to offset from, mapped memory may be slow to read
+				bump_tc.resize(num_vertices);
+				job.mTexCoordKernel(job.mTexCoordParams[ch], num_vertices, &bump_tc[0]);
+				memcpy(dst.get(), &bump_tc[0], num_vertices * sizeof(LLVector2));
+			}
+			else
+			{
+				job.mTexCoordKernel(job.mTexCoordParams[ch], num_vertices, dst.get());
+			}
+		}
+
+		if (job.mBumpOffsets)
+		{
+			const LLMatrix4a& mat_normal = job.mMatNormal;
+			const LLVertexPack::TexCoordParams& params = job.mTexCoordParams[0];
+			LLVector4a binormal_dir( -params.mSin, params.mCos, 0.f );
+
+			LLStrider<LLVector2> tex_coords1 = job.mTexCoords[1];
+
+			for (S32 i = 0; i < num_vertices; i++)
+			{
+				LLVector4a tangent = vf.mTangents[i];
+
+				LLVector4a binorm;
+				binorm.setCross3(vf.mNormals[i], tangent);
+				binorm.mul(tangent.getF32ptr()[3]);
+				
+				LLMatrix4a tangent_to_object;
+				tangent_to_object.setRows(tangent, binorm, vf.mNormals[i]);
+				LLVector4a t;
+				tangent_to_object.rotate(binormal_dir, t);
+				LLVector4a binormal;
+				mat_normal.rotate(t, binormal);
+				
+				//VECTORIZE THIS
+				if (job.mActive)
+				{
+					LLVector3 t;
+					t.set(binormal.getF32ptr());
+					t *= job.mBumpQuat;
+					binormal.load3(t.mV);
+				}
+
+				binormal.normalize3fast();
+
+				LLVector2 tc = bump_tc[i];
+				tc += LLVector2( job.mBumpSLightRay.dot3(tangent).getF32(), job.mBumpTLightRay.dot3(binormal).getF32() );
+			
+				*tex_coords1++ = tc;
+			}
+		}
+	}
+
+	if (job.mPackPosition)
+	{
+		LLStrider<LLVector3> vert = job.mPositions;
+		LLVertexPack::transformPositions(job.mMatVert, vf.mPositions, num_vertices, job.mTextureIndex,
+										 (LLVector4a*) vert.get(), job.mGeomCount);
+	}
+
+	if (job.mPackNormal)
+	{
+		LLStrider<LLVector3> norm = job.mNormals;
+		LLVertexPack::rotateNormals(job.mMatNormal, vf.mNormals, num_vertices, (LLVector4a*) norm.get());
+	}
+	
+	if (job.mPackTangent)
+	{
+		LLStrider<LLVector3> tangent = job.mTangents;
+		LLVertexPack::rotateTangents(job.mMatNormal, vf.mTangents, num_vertices, (LLVector4a*) tangent.get());
+	}
+
+	if (job.mPackWeights)
+	{
+		LLStrider<LLVector4a> wght = job.mWeights;
+		memcpy(wght.get(), vf.mWeights, num_vertices * sizeof(LLVector4a));
+	}
+
+	if (job.mPackColor)
+	{
+		LLStrider<LLColor4U> colors = job.mColors;
+		LLVertexPack::fill(job.mColor, num_vertices, (U32*) colors.get());
+	}
+
+	if (job.mPackEmissive)
+	{
+		LLStrider<LLColor4U> emissive = job.mEmissive;
+		LLVertexPack::fill(job.mGlow, num_vertices, (U32*) emissive.get());
+	}
+}
+
+// Packs a contiguous run of jobs; one chunk of packGeometryVolumes().
+struct PackGeometryJobs
+{
+	const LLFace::geometry_job_list_t* mJobs;
+
+	void operator()(S32 begin, S32 end) const
+	{
+		for (S32 i = begin; i < end; ++i)
+		{
+			LLFace::packGeometryVolume((*mJobs)[i]);
+		}
+	}
+};
+
+//static
+void LLFace::packGeometryVolumes(const geometry_job_list_t& jobs)
+{
+	// Below this many vertices, handing the batch out costs more than it saves.
+	const S32 PARALLEL_VERTICES = 16384;
+	const S32 JOB_GRAIN = 4;
+
+	if (jobs.empty())
+	{
+		return;
+	}
+
+	LLFastTimer t(FTM_FACE_GEOM_PACK);
+	PackGeometryJobs pack = { &jobs };
+	S32 vertices = 0;
+	for (U32 i = 0; i < jobs.size() && vertices < PARALLEL_VERTICES; ++i)
+	{
+		vertices += jobs[i].mNumVertices;
+	}
+	if (vertices >= PARALLEL_VERTICES)
+	{
+		LLThreadPool::parallelFor(jobs.size(), JOB_GRAIN, pack);
+	}
+	else
+	{
+		pack(0, jobs.size());
+	}
+}
+
 //check if the face has a media
 BOOL LLFace::hasMedia() const 
 {
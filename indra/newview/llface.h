@@ -27,6 +27,7 @@
 #ifndef LL_LLFACE_H
 #define LL_LLFACE_H
 
+#include "llalignedarray.h"
 #include "llstrider.h"
 
 #include "llrender.h"
@@ -39,12 +40,14 @@
 #include "xform.h"
 #include "lldarrayptr.h"
 #include "llvertexbuffer.h"
+#include "llvertexpack.h"
 #include "llviewertexture.h"
 #include "llstat.h"
 #include "lldrawable.h"
 
 class LLFacePool;
 class LLVolume;
+class LLVolumeFace;
 class LLViewerTexture;
 class LLTextureEntry;
 class LLVertexProgram;
@@ -177,6 +180,72 @@ public:
 						const U16 &index_offset,
 						bool force_rebuild = false);
 
+	// getGeometryVolume() in two halves. prepareGeometryVolume() runs on the
+	// main thread: it reads the drawable, object, texture and sky state, does
+	// any transform feedback and maps the face's range of its vertex buffer.
+	// packGeometryVolume() then only reads the volume face and writes the
+	// mapped memory, so the jobs of different faces may be packed on any
+	// thread at the same time, provided their volumes do not change meanwhile.
+	// The buffers are flushed by the caller once every job is packed.
+	LL_ALIGN_PREFIX(16)
+	struct GeometryJob
+	{
+		LL_ALIGN_16(LLMatrix4a mMatVert);
+		LL_ALIGN_16(LLMatrix4a mMatNormal);
+		LL_ALIGN_16(LLVector4a mBumpSLightRay);
+		LL_ALIGN_16(LLVector4a mBumpTLightRay);
+
+		LLFace* mFace;
+		const LLVolumeFace* mVolumeFace;
+		LLQuaternion mBumpQuat;
+
+		S32 mNumVertices;
+		S32 mNumIndices;
+		S32 mGeomCount;
+		U16 mIndexOffset;
+		S32 mTextureIndex;
+		U32 mColor;
+		U32 mGlow;
+
+		// Texture coordinates: one kernel for every channel, picked from the
+		// texgen and animation state; the channels differ only in parameters.
+		LLVertexPack::texcoord_kernel_t mTexCoordKernel;
+		LLVertexPack::TexCoordParams mTexCoordParams[3];
+
+		bool mPackIndices;
+		bool mPackPosition;
+		bool mPackNormal;
+		bool mPackTangent;
+		bool mPackWeights;
+		bool mPackColor;
+		bool mPackEmissive;
+		bool mPackTexCoord;
+		bool mBumpOffsets;			// Emboss offsets in texture coordinate 1
+		bool mActive;
+
+		LLStrider<U16> mIndices;
+		LLStrider<LLVector3> mPositions;
+		LLStrider<LLVector3> mNormals;
+		LLStrider<LLVector3> mTangents;
+		LLStrider<LLVector4a> mWeights;
+		LLStrider<LLColor4U> mColors;
+		LLStrider<LLColor4U> mEmissive;
+		LLStrider<LLVector2> mTexCoords[3];	// Unmapped channels are NULL
+	} LL_ALIGN_POSTFIX(16);
+
+	typedef LLAlignedArray<GeometryJob, 64> geometry_job_list_t;
+
+	// Returns FALSE if the face does not fit its vertex buffer.
+	BOOL prepareGeometryVolume(GeometryJob& job,
+						const LLVolume& volume,
+						const S32 &f,
+						const LLMatrix4a& mat_vert, const LLMatrix4a& mat_normal,
+						const U16 &index_offset,
+						bool force_rebuild = false);
+	static void packGeometryVolume(const GeometryJob& job);
+	// Packs every job, fanning large batches out to LLThreadPool.
+	static void packGeometryVolumes(const geometry_job_list_t& jobs);
+
 	// For avatar
 	U16			 getGeometryAvatar(
 									LLStrider<LLVector3> &vertices,
@@ -46,6 +46,7 @@
 /*static*/ F32 LLVolumeImplFlexible::sUpdateFactor = 1.0f;
 std::vector<LLVolumeImplFlexible*> LLVolumeImplFlexible::sInstanceList;
 std::vector<U32> LLVolumeImplFlexible::sUpdateDelay;
+std::vector<LLVolumeImplFlexible*> LLVolumeImplFlexible::sSimulateQueue;
 
 static LLFastTimer::DeclareTimer FTM_FLEXIBLE_REBUILD("Rebuild");
 static LLFastTimer::DeclareTimer FTM_DO_FLEXIBLE_UPDATE("Flexible Update");
@@ -67,6 +68,8 @@ LLVolumeImplFlexible::LLVolumeImplFlexible(LLViewerObject* vo, LLFlexibleObjectD
 	mFrameNum = 0;
 	mCollisionSphereRadius = 0.f;
 	mRenderRes = 1;
+	mSimulateQueued = FALSE;
+	mSimulated = FALSE;
 
 	if(mVO->mDrawable.notNull())
 	{
@@ -86,6 +89,10 @@ LLVolumeImplFlexible::~LLVolumeImplFlexible()
 		(*iter)->mInstanceIndex = mInstanceIndex;
 	std::vector<U32>::iterator update_it(sUpdateDelay.begin() + mInstanceIndex);
 	vector_replace_with_last(sUpdateDelay, update_it);
+	if (mSimulateQueued)
+	{
+		sSimulateQueue.erase(std::find(sSimulateQueue.begin(), sSimulateQueue.end(), this));
+	}
 }
 
 //static
@@ -105,6 +112,43 @@ void LLVolumeImplFlexible::updateClass()
 	}
 }
 
+//static
+void LLVolumeImplFlexible::simulateQueued()
+{
+	static LLFlexibleSolver solver;
+	static std::vector<LLVolumeImplFlexible*> stepped;
+
+	for (std::vector<LLVolumeImplFlexible*>::iterator iter = sSimulateQueue.begin(); iter != sSimulateQueue.end(); ++iter)
+	{
+		LLVolumeImplFlexible* flex = *iter;
+		flex->mSimulateQueued = FALSE;
+		if (flex->prepareSimulation())
+		{
+			solver.addChain(&flex->mChain);
+			stepped.push_back(flex);
+		}
+	}
+	sSimulateQueue.clear();
+
+	solver.solve();
+
+	for (std::vector<LLVolumeImplFlexible*>::iterator iter = stepped.begin(); iter != stepped.end(); ++iter)
+	{
+		(*iter)->mLastSegmentRotation = (*iter)->mChain.mEndRotation;
+		(*iter)->mSimulated = TRUE;
+	}
+	stepped.clear();
+}
+
+void LLVolumeImplFlexible::queueSimulation()
+{
+	if (!mSimulateQueued)
+	{
+		mSimulateQueued = TRUE;
+		sSimulateQueue.push_back(this);
+	}
+}
+
 LLVector3 LLVolumeImplFlexible::getFramePosition() const
 {
 	return mVO->getRenderPosition();
@@ -348,6 +392,7 @@ void LLVolumeImplFlexible::doIdleUpdate()
 			{
 				updateRenderRes();
 				gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION, FALSE);
+				queueSimulation();
 			}
 			else
 			{
@@ -380,6 +425,7 @@ void LLVolumeImplFlexible::doIdleUpdate()
 							updateRenderRes();
 
 							gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION, FALSE);
+							queueSimulation();
 						}
 					}
 				}
@@ -405,38 +451,15 @@ inline S32 log2(S32 x)
 	return ret;
 }
 
-void LLVolumeImplFlexible::doFlexibleUpdate()
+bool LLVolumeImplFlexible::prepareSimulation()
 {
-	LLFastTimer ftm(FTM_DO_FLEXIBLE_UPDATE);
-	LLVolume* volume = mVO->getVolume();
-	LLPath *path = &volume->getPath();
-	if ((mSimulateRes == 0 || !mInitialized) && mVO->mDrawable->isVisible()) 
-	{
-		BOOL force_update = mSimulateRes == 0 ? TRUE : FALSE;
-
-		doIdleUpdate();
-
-		if (!force_update || !gPipeline.hasRenderDebugFeatureMask(LLPipeline::RENDER_DEBUG_FEATURE_FLEXIBLE))
-		{
-			return;	// we did not get updated or initialized, proceeding without can be dangerous
-		}
-	}
-
-	if(!mInitialized || !mAttributes)
+	LLDrawable* drawablep = mVO->mDrawable;
+	if (!drawablep || mVO->isDead() || !mInitialized || !mAttributes ||
+		mRenderRes < 0 || isHeldByImpostor())
 	{
-		//the object is not visible
-		return ;
+		return false;
 	}
 
-	// stinson 11/12/2012: Need to check with davep on the following.
-	// Skipping the flexible update if render res is negative.  If we were to continue with a negative value,
-	// the subsequent S32 num_render_sections = 1<<mRenderRes; code will specify a really large number of
-	// render sections which will then create a length exception in the std::vector::resize() method.
-	if (mRenderRes < 0)
-	{
-		return;
-	}
-	
 	S32 num_sections = 1 << mSimulateRes;
 
     F32 secondsThisFrame = mTimer.getElapsedTimeAndResetF32();
@@ -447,14 +470,10 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 
 	LLVector3 BasePosition = getFramePosition();
 	LLQuaternion BaseRotation = getFrameRotation();
-	LLQuaternion parentSegmentRotation = BaseRotation;
-	LLVector3 anchorDirectionRotated = LLVector3::z_axis * parentSegmentRotation;
-	LLVector3 anchorScale = mVO->mDrawable->getScale();
+	LLVector3 anchorDirectionRotated = LLVector3::z_axis * BaseRotation;
+	LLVector3 anchorScale = drawablep->getScale();
 	
 	F32 section_length = anchorScale.mV[VZ] / (F32)num_sections;
-	F32 inv_section_length = 1.f / section_length;
-
-	S32 i;
 
 	// ANCHOR position is offset from BASE position (centroid) by half the length
 	LLVector3 AnchorPosition = BasePosition - (anchorScale.mV[VZ]/2 * anchorDirectionRotated);
@@ -463,10 +482,6 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 	mSection[0].mDirection = anchorDirectionRotated;
 	mSection[0].mRotation = BaseRotation;
 
-	LLQuaternion deltaRotation;
-
-	LLVector3 lastPosition;
-
 	// Coefficients which are constant across sections
 	F32 t_factor = mAttributes->getTension() * 0.1f;
 	t_factor = t_factor*(1 - pow(0.85f, secondsThisFrame*30));
@@ -478,170 +493,90 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 	F32 friction_coeff = (mAttributes->getAirFriction()*2+1);
 	friction_coeff = pow(10.f, friction_coeff*secondsThisFrame);
 	friction_coeff = (friction_coeff > 1) ? friction_coeff : 1;
-	F32 momentum = 1.0f / friction_coeff;
-
-	F32 wind_factor = (mAttributes->getWindSensitivity()*0.1f) * section_length * secondsThisFrame;
-	F32 max_angle = atan(section_length*2.f);
 
 	F32 force_factor = section_length * secondsThisFrame;
 
-	// Update simulated sections
-	for (i=1; i<=num_sections; ++i)
-	{
-		LLVector3 parentSectionVector;
-		LLVector3 parentSectionPosition;
-		LLVector3 parentDirection;
-
-		//---------------------------------------------------
-		// save value of position as lastPosition
-		//---------------------------------------------------
-		lastPosition = mSection[i].mPosition;
-
-		//------------------------------------------------------------------------------------------
-		// gravity
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition.mV[2] -= mAttributes->getGravity() * force_factor;
-
-		//------------------------------------------------------------------------------------------
-		// wind force
-		//------------------------------------------------------------------------------------------
-		if (mAttributes->getWindSensitivity() > 0.001f)
+	mChain.mSections = mSection;
+	mChain.mNumSections = num_sections;
+	mChain.mSectionLength = section_length;
+	mChain.mTension = t_factor;
+	mChain.mMomentum = 1.0f / friction_coeff;
+	mChain.mMaxAngle = atan(section_length*2.f);
+	mChain.mGravity = mAttributes->getGravity() * force_factor;
+	mChain.mUserForce = mAttributes->getUserForce() * force_factor;
+	mChain.mWindFactor = 0.f;
+
+	// Wind only pushes sideways, so sampling it before the step is the same
+	// as sampling it after gravity moved the section.
+	LLViewerRegion* regionp = gAgent.getRegion();
+	if (mAttributes->getWindSensitivity() > 0.001f && regionp)
+	{
+		mChain.mWindFactor = (mAttributes->getWindSensitivity()*0.1f) * section_length * secondsThisFrame;
+		for (S32 i = 1; i <= num_sections; ++i)
 		{
-			mSection[i].mPosition += gAgent.getRegion()->mWind.getVelocity( mSection[i].mPosition ) * wind_factor;
+			mChain.mWind[i] = regionp->mWind.getVelocity(mSection[i].mPosition);
 		}
-
-		//------------------------------------------------------------------------------------------
-		// user-defined force
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition += mAttributes->getUserForce() * force_factor;
-
-		//---------------------------------------------------
-		// tension (rigidity, stiffness)
-		//---------------------------------------------------
-		parentSectionPosition = mSection[i-1].mPosition;
-		parentDirection = mSection[i-1].mDirection;
-
-		if ( i == 1 )
-		{
-			parentSectionVector = mSection[0].mDirection;
-		}
-		else
+	}
+	else
+	{
+		for (S32 i = 1; i <= num_sections; ++i)
 		{
-			parentSectionVector = mSection[i-2].mDirection;
+			mChain.mWind[i].clear();
 		}
+	}
+	mChain.mWind[0].clear();
 
-		LLVector3 currentVector = mSection[i].mPosition - parentSectionPosition;
-
-		LLVector3 difference = (parentSectionVector*section_length) - currentVector;
-		LLVector3 tensionForce = difference * t_factor;
-
-		mSection[i].mPosition += tensionForce;
-
-		//------------------------------------------------------------------------------------------
-		// sphere collision, currently not used
-		//------------------------------------------------------------------------------------------
-		/*if ( mAttributes->mUsingCollisionSphere )
-		{
-			LLVector3 vectorToCenterOfCollisionSphere = mCollisionSpherePosition - mSection[i].mPosition;
-			if ( vectorToCenterOfCollisionSphere.magVecSquared() < mCollisionSphereRadius * mCollisionSphereRadius )
-			{
-				F32 distanceToCenterOfCollisionSphere = vectorToCenterOfCollisionSphere.magVec();
-				F32 penetration = mCollisionSphereRadius - distanceToCenterOfCollisionSphere;
-
-				LLVector3 normalToCenterOfCollisionSphere;
-				
-				if ( distanceToCenterOfCollisionSphere > 0.0f )
-				{
-					normalToCenterOfCollisionSphere = vectorToCenterOfCollisionSphere / distanceToCenterOfCollisionSphere;
-				}
-				else // rare
-				{
-					normalToCenterOfCollisionSphere = LLVector3::x_axis; // arbitrary
-				}
-
-				// push the position out to the surface of the collision sphere
-				mSection[i].mPosition -= normalToCenterOfCollisionSphere * penetration;
-			}
-		}*/
-
-		//------------------------------------------------------------------------------------------
-		// inertia
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition += mSection[i].mVelocity * momentum;
-
-		//------------------------------------------------------------------------------------------
-		// clamp length & rotation
-		//------------------------------------------------------------------------------------------
-		mSection[i].mDirection = mSection[i].mPosition - parentSectionPosition;
-		mSection[i].mDirection.normVec();
-		deltaRotation.shortestArc( parentDirection, mSection[i].mDirection );
-
-		F32 angle;
-		LLVector3 axis;
-		deltaRotation.getAngleAxis(&angle, axis);
-		if (angle > F_PI) angle -= 2.f*F_PI;
-		if (angle < -F_PI) angle += 2.f*F_PI;
-		if (angle > max_angle)
-		{
-			//angle = 0.5f*(angle+max_angle);
-			deltaRotation.setQuat(max_angle, axis);
-		} else if (angle < -max_angle)
-		{
-			//angle = 0.5f*(angle-max_angle);
-			deltaRotation.setQuat(-max_angle, axis);
-		}
-		LLQuaternion segment_rotation = parentSegmentRotation * deltaRotation;
-		parentSegmentRotation = segment_rotation;
+	return true;
+}
 
-		mSection[i].mDirection = (parentDirection * deltaRotation);
-		mSection[i].mPosition = parentSectionPosition + mSection[i].mDirection * section_length;
-		mSection[i].mRotation = segment_rotation;
+void LLVolumeImplFlexible::doFlexibleUpdate()
+{
+	LLFastTimer ftm(FTM_DO_FLEXIBLE_UPDATE);
+	LLVolume* volume = mVO->getVolume();
+	LLPath *path = &volume->getPath();
+	if ((mSimulateRes == 0 || !mInitialized) && mVO->mDrawable->isVisible()) 
+	{
+		BOOL force_update = mSimulateRes == 0 ? TRUE : FALSE;
 
-		if (i > 1)
-		{
-			// Propogate half the rotation up to the parent
-			LLQuaternion halfDeltaRotation(angle/2, axis);
-			mSection[i-1].mRotation = mSection[i-1].mRotation * halfDeltaRotation;
-		}
+		doIdleUpdate();
 
-		//------------------------------------------------------------------------------------------
-		// calculate velocity
-		//------------------------------------------------------------------------------------------
-		mSection[i].mVelocity = mSection[i].mPosition - lastPosition;
-		if (mSection[i].mVelocity.magVecSquared() > 1.f)
+		if (!force_update || !gPipeline.hasRenderDebugFeatureMask(LLPipeline::RENDER_DEBUG_FEATURE_FLEXIBLE))
 		{
-			mSection[i].mVelocity.normVec();
+			return;	// we did not get updated or initialized, proceeding without can be dangerous
 		}
 	}
 
-	// Calculate derivatives (not necessary until normals are automagically generated)
-	mSection[0].mdPosition = (mSection[1].mPosition - mSection[0].mPosition) * inv_section_length;
-	// i = 1..NumSections-1
-	for (i=1; i<num_sections; ++i)
+	if(!mInitialized || !mAttributes)
 	{
-		// Quadratic numerical derivative of position
-
-		// f(-L1) = aL1^2 - bL1 + c = f1
-		// f(0)   =               c = f2
-		// f(L2)  = aL2^2 + bL2 + c = f3
-		// f = ax^2 + bx + c
-		// d/dx f = 2ax + b
-		// d/dx f(0) = b
-
-		// c = f2
-		// a = [(f1-c)/L1 + (f3-c)/L2] / (L1+L2)
-		// b = (f3-c-aL2^2)/L2
-
-		LLVector3 a = (mSection[i-1].mPosition-mSection[i].mPosition +
-					mSection[i+1].mPosition-mSection[i].mPosition) * 0.5f * inv_section_length * inv_section_length;
-		LLVector3 b = (mSection[i+1].mPosition-mSection[i].mPosition - a*(section_length*section_length));
-		b *= inv_section_length;
-
-		mSection[i].mdPosition = b;
+		//the object is not visible
+		return ;
 	}
 
-	// i = NumSections
-	mSection[i].mdPosition = (mSection[i].mPosition - mSection[i-1].mPosition) * inv_section_length;
+	// stinson 11/12/2012: Need to check with davep on the following.
+	// Skipping the flexible update if render res is negative.  If we were to continue with a negative value,
+	// the subsequent S32 num_render_sections = 1<<mRenderRes; code will specify a really large number of
+	// render sections which will then create a length exception in the std::vector::resize() method.
+	if (mRenderRes < 0)
+	{
+		return;
+	}
+	
+	if (mSimulated)
+	{	// Already stepped with the other prims, see simulateQueued()
+		mSimulated = FALSE;
+	}
+	else if (prepareSimulation())
+	{
+		// Main thread only, like the rest of the geometry update
+		static LLFlexibleSolver solver;
+		solver.addChain(&mChain);
+		solver.solve(false);
+		mLastSegmentRotation = mChain.mEndRotation;
+	}
+	else
+	{
+		return;
+	}
 
 	// Create points
 	S32 num_render_sections = 1<<mRenderRes;
@@ -653,7 +588,7 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 
 	LLPath::PathPt *new_point;
 
-	LLFlexibleObjectSection newSection[ (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1 ];
+	LLFlexibleObjectSection newSection[ FLEXIBLE_SOLVER_SECTIONS ];
 	remapSections(mSection, mSimulateRes, newSection, mRenderRes);
 
 	//generate transform from global to prim space
@@ -675,7 +610,7 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 								LLVector4(z_axis, 0.f),
 								LLVector4(delta_pos, 1.f));
 			
-	for (i=0; i<=num_render_sections; ++i)
+	for (S32 i=0; i<=num_render_sections; ++i)
 	{
 		new_point = &path->mPath[i];
 		LLVector3 pos = newSection[i].mPosition * rel_xform;
@@ -693,8 +628,6 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 		new_point->mScale.set(newSection[i].mScale.mV[0], newSection[i].mScale.mV[1], 0,1);
 		new_point->mTexT = ((F32)i)/(num_render_sections);
 	}
-
-	mLastSegmentRotation = parentSegmentRotation;
 }
 
 void LLVolumeImplFlexible::preRebuild()
@@ -720,10 +653,8 @@ void LLVolumeImplFlexible::onSetScale(const LLVector3& scale, BOOL damped)
 	setAttributesOfAllSections((LLVector3*) &scale);
 }
 
-BOOL LLVolumeImplFlexible::doUpdateGeometry(LLDrawable *drawable)
+bool LLVolumeImplFlexible::isHeldByImpostor() const
 {
-	LLVOVolume *volume = (LLVOVolume*)mVO;
-
 	if (mVO->isAttachment())
 	{	//don't update flexible attachments for impostored avatars unless the 
 		//impostor is being updated this frame (w00!)
@@ -738,10 +669,21 @@ BOOL LLVolumeImplFlexible::doUpdateGeometry(LLDrawable *drawable)
 			LLVOAvatar* avatar = (LLVOAvatar*) parent;
 			if (avatar->isImpostor() && !avatar->needsImpostorUpdate())
 			{
-				return TRUE;
+				return true;
 			}
 		}
 	}
+	return false;
+}
+
+BOOL LLVolumeImplFlexible::doUpdateGeometry(LLDrawable *drawable)
+{
+	LLVOVolume *volume = (LLVOVolume*)mVO;
+
+	if (isHeldByImpostor())
+	{
+		return TRUE;
+	}
 
 	if (volume->mDrawable.isNull())
 	{
@@ -37,6 +37,7 @@
 #ifndef LL_LLFLEXIBLEOBJECT_H
 #define LL_LLFLEXIBLEOBJECT_H
 
+#include "llflexiblesolver.h"
 #include "llprimitive.h"
 #include "llvovolume.h"
 #include "llwind.h"
@@ -73,11 +74,15 @@ class LLVolumeImplFlexible : public LLVolumeInterface
 private:
 	static std::vector<LLVolumeImplFlexible*> sInstanceList;
 	static std::vector<U32> sUpdateDelay;
+	// Prims whose idle update asked for a step this frame
+	static std::vector<LLVolumeImplFlexible*> sSimulateQueue;
 	S32 mInstanceIndex;
 
 	public:
 		static void resetTimers() { sUpdateDelay.assign(sUpdateDelay.size(),0); }
 		static void updateClass();
+		// Steps the queued prims together; call before their geometry is rebuilt.
+		static void simulateQueued();
 
 		LLVolumeImplFlexible(LLViewerObject* volume, LLFlexibleObjectData* attributes);
 		~LLVolumeImplFlexible();
@@ -130,7 +135,10 @@ private:
 		BOOL						mInitialized;
 		BOOL						mUpdated;
 		LLFlexibleObjectData*		mAttributes;
-		LLFlexibleObjectSection		mSection	[ (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1 ];
+		LLFlexibleObjectSection		mSection	[ FLEXIBLE_SOLVER_SECTIONS ];
+		LLFlexibleSolver::Chain		mChain;
+		BOOL						mSimulateQueued;
+		BOOL						mSimulated;		// Stepped since the last doFlexibleUpdate()
 		S32							mInitializedRes;
 		S32							mSimulateRes;
 		S32							mRenderRes;
@@ -143,6 +151,10 @@ private:
 		// private methods
 		//--------------------------------------
 		void setAttributesOfAllSections	(LLVector3* inScale = NULL);
+		void queueSimulation();
+		// Sets up mChain for this frame's step; false if the prim can't step.
+		bool prepareSimulation();
+		bool isHeldByImpostor() const;
 
 		void remapSections(LLFlexibleObjectSection *source, S32 source_sections,
 										 LLFlexibleObjectSection *dest, S32 dest_sections);
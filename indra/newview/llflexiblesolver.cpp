@@ -0,0 +1,522 @@
+/** 
+ * @file llflexiblesolver.cpp
+ * @brief Steps the section chains of all flexible prims together
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ * 
+ * Copyright (c) 2026, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llflexiblesolver.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+#include "llfasttimer.h"
+#include "llflexibleobject.h"
+#include "llthreadpool.h"
+
+static LLFastTimer::DeclareTimer FTM_FLEXIBLE_SOLVE("Flexible Solve");
+
+namespace
+{
+
+// Chains per packet, one per SIMD lane
+const S32 LANES = 4;
+
+// A 3D vector for each chain of a packet
+struct Vec3x4
+{
+	LLVector4a x, y, z;
+};
+
+// A quaternion for each chain of a packet
+struct Quatx4
+{
+	LLVector4a x, y, z, w;
+};
+
+inline LLVector4a splat(F32 f)
+{
+	LLVector4a r;
+	r.splat(f);
+	return r;
+}
+
+inline LLVector4a add(const LLVector4a& a, const LLVector4a& b)
+{
+	LLVector4a r;
+	r.setAdd(a, b);
+	return r;
+}
+
+inline LLVector4a sub(const LLVector4a& a, const LLVector4a& b)
+{
+	LLVector4a r;
+	r.setSub(a, b);
+	return r;
+}
+
+inline LLVector4a mul(const LLVector4a& a, const LLVector4a& b)
+{
+	LLVector4a r;
+	r.setMul(a, b);
+	return r;
+}
+
+inline LLVector4a sqrt4(const LLVector4a& a)
+{
+	LLVector4a r;
+	r = _mm_sqrt_ps(a);
+	return r;
+}
+
+inline LLVector4a select(const LLVector4Logical& mask, const LLVector4a& if_true, const LLVector4a& if_false)
+{
+	LLVector4a r;
+	r.setSelectWithMask(mask, if_true, if_false);
+	return r;
+}
+
+inline Vec3x4 add(const Vec3x4& a, const Vec3x4& b)
+{
+	Vec3x4 r = { add(a.x, b.x), add(a.y, b.y), add(a.z, b.z) };
+	return r;
+}
+
+inline Vec3x4 sub(const Vec3x4& a, const Vec3x4& b)
+{
+	Vec3x4 r = { sub(a.x, b.x), sub(a.y, b.y), sub(a.z, b.z) };
+	return r;
+}
+
+inline Vec3x4 scale(const Vec3x4& a, const LLVector4a& s)
+{
+	Vec3x4 r = { mul(a.x, s), mul(a.y, s), mul(a.z, s) };
+	return r;
+}
+
+// a += b * s
+inline void madd(Vec3x4& a, const Vec3x4& b, const LLVector4a& s)
+{
+	a.x.add(mul(b.x, s));
+	a.y.add(mul(b.y, s));
+	a.z.add(mul(b.z, s));
+}
+
+inline Vec3x4 select(const LLVector4Logical& mask, const Vec3x4& if_true, const Vec3x4& if_false)
+{
+	Vec3x4 r = { select(mask, if_true.x, if_false.x), select(mask, if_true.y, if_false.y), select(mask, if_true.z, if_false.z) };
+	return r;
+}
+
+inline Quatx4 select(const LLVector4Logical& mask, const Quatx4& if_true, const Quatx4& if_false)
+{
+	Quatx4 r = { select(mask, if_true.x, if_false.x), select(mask, if_true.y, if_false.y),
+				 select(mask, if_true.z, if_false.z), select(mask, if_true.w, if_false.w) };
+	return r;
+}
+
+// The vector part of q
+inline Vec3x4 imaginary(const Quatx4& q)
+{
+	Vec3x4 r = { q.x, q.y, q.z };
+	return r;
+}
+
+inline Quatx4 quat(const Vec3x4& v, const LLVector4a& w)
+{
+	Quatx4 r = { v.x, v.y, v.z, w };
+	return r;
+}
+
+inline LLVector4a dot(const Vec3x4& a, const Vec3x4& b)
+{
+	LLVector4a r = mul(a.x, b.x);
+	r.add(mul(a.y, b.y));
+	r.add(mul(a.z, b.z));
+	return r;
+}
+
+inline Vec3x4 cross(const Vec3x4& a, const Vec3x4& b)
+{
+	Vec3x4 r = { sub(mul(a.y, b.z), mul(a.z, b.y)),
+				 sub(mul(a.z, b.x), mul(a.x, b.z)),
+				 sub(mul(a.x, b.y), mul(a.y, b.x)) };
+	return r;
+}
+
+// LLVector3::normVec(): unit length, or zero when too short to have a direction
+inline void normalize(Vec3x4& v)
+{
+	const LLVector4a mag = sqrt4(dot(v, v));
+	LLVector4a oomag;
+	oomag.setDiv(splat(1.f), mag);
+	oomag = select(mag.greaterThan(splat(FP_MAG_THRESHOLD)), oomag, LLVector4a::getZero());
+	v = scale(v, oomag);
+}
+
+// LLQuaternion's a * b
+inline Quatx4 mul(const Quatx4& a, const Quatx4& b)
+{
+	Quatx4 r;
+	r.x = add(add(mul(b.w, a.x), mul(b.x, a.w)), sub(mul(b.y, a.z), mul(b.z, a.y)));
+	r.y = add(add(mul(b.w, a.y), mul(b.y, a.w)), sub(mul(b.z, a.x), mul(b.x, a.z)));
+	r.z = add(add(mul(b.w, a.z), mul(b.z, a.w)), sub(mul(b.x, a.y), mul(b.y, a.x)));
+	r.w = sub(sub(mul(b.w, a.w), mul(b.x, a.x)), add(mul(b.y, a.y), mul(b.z, a.z)));
+	return r;
+}
+
+// LLVector3 * LLQuaternion: a rotated by q
+inline Vec3x4 rotate(const Vec3x4& a, const Quatx4& q)
+{
+	const LLVector4a rw = sub(LLVector4a::getZero(), dot(a, imaginary(q)));
+	const LLVector4a rx = add(mul(q.w, a.x), sub(mul(q.y, a.z), mul(q.z, a.y)));
+	const LLVector4a ry = add(mul(q.w, a.y), sub(mul(q.z, a.x), mul(q.x, a.z)));
+	const LLVector4a rz = add(mul(q.w, a.z), sub(mul(q.x, a.y), mul(q.y, a.x)));
+
+	Vec3x4 r;
+	r.x = add(sub(mul(rx, q.w), mul(rw, q.x)), sub(mul(rz, q.y), mul(ry, q.z)));
+	r.y = add(sub(mul(ry, q.w), mul(rw, q.y)), sub(mul(rx, q.z), mul(rz, q.x)));
+	r.z = add(sub(mul(rz, q.w), mul(rw, q.z)), sub(mul(ry, q.x), mul(rx, q.y)));
+	return r;
+}
+
+inline void setLane(Vec3x4& v, S32 lane, const LLVector3& value)
+{
+	v.x.getF32ptr()[lane] = value.mV[VX];
+	v.y.getF32ptr()[lane] = value.mV[VY];
+	v.z.getF32ptr()[lane] = value.mV[VZ];
+}
+
+inline LLVector3 getLane(const Vec3x4& v, S32 lane)
+{
+	return LLVector3(v.x[lane], v.y[lane], v.z[lane]);
+}
+
+inline void setLane(Quatx4& q, S32 lane, const LLQuaternion& value)
+{
+	q.x.getF32ptr()[lane] = value.mQ[VX];
+	q.y.getF32ptr()[lane] = value.mQ[VY];
+	q.z.getF32ptr()[lane] = value.mQ[VZ];
+	q.w.getF32ptr()[lane] = value.mQ[VW];
+}
+
+inline LLQuaternion getLane(const Quatx4& q, S32 lane)
+{
+	return LLQuaternion(q.x[lane], q.y[lane], q.z[lane], q.w[lane]);
+}
+
+bool shorter_chain(const LLFlexibleSolver::Chain* a, const LLFlexibleSolver::Chain* b)
+{
+	return a->mNumSections < b->mNumSections;
+}
+
+} // namespace
+
+struct LLFlexibleSolver::Packet
+{
+	Vec3x4 mPosition[FLEXIBLE_SOLVER_SECTIONS];
+	Vec3x4 mVelocity[FLEXIBLE_SOLVER_SECTIONS];
+	Vec3x4 mDirection[FLEXIBLE_SOLVER_SECTIONS];
+	Quatx4 mRotation[FLEXIBLE_SOLVER_SECTIONS];
+	Vec3x4 mWind[FLEXIBLE_SOLVER_SECTIONS];
+	Vec3x4 mUserForce;
+	LLVector4a mSectionLength;
+	LLVector4a mTension;
+	LLVector4a mMomentum;
+	LLVector4a mGravity;
+	LLVector4a mWindFactor;
+	LLVector4a mCosHalfMaxAngle;
+	LLVector4a mSinHalfMaxAngle;
+	Quatx4 mEndRotation;
+	Chain* mChains[LANES];
+	S32 mCount;						// Chains in use; the other lanes step a copy of the first
+	S32 mNumSections;
+};
+
+LLFlexibleSolver::LLFlexibleSolver()
+:	mPackets(new LLAlignedArray<Packet, 64>)
+{
+}
+
+LLFlexibleSolver::~LLFlexibleSolver()
+{
+	delete mPackets;
+}
+
+void LLFlexibleSolver::solve(bool threaded)
+{
+	// Packets to hand a worker at a time
+	const S32 PACKET_GRAIN = 16;
+
+	if (mChains.empty())
+	{
+		return;
+	}
+
+	LLFastTimer t(FTM_FLEXIBLE_SOLVE);
+
+	// Group chains of the same length, so that the lanes of a packet step together
+	mSorted = mChains;
+	std::stable_sort(mSorted.begin(), mSorted.end(), shorter_chain);
+
+	S32 num_packets = 0;
+	for (S32 begin = 0; begin < (S32)mSorted.size();)
+	{
+		S32 end = begin + 1;
+		while (end < (S32)mSorted.size() && end - begin < LANES &&
+			   mSorted[end]->mNumSections == mSorted[begin]->mNumSections)
+		{
+			++end;
+		}
+		mPackets->resize(num_packets + 1);
+		gather((*mPackets)[num_packets++], &mSorted[begin], end - begin);
+		begin = end;
+	}
+
+	if (threaded)
+	{
+		LLThreadPool::parallelFor(num_packets, PACKET_GRAIN, boost::bind(&LLFlexibleSolver::stepRange, this, _1, _2));
+	}
+	else
+	{
+		stepRange(0, num_packets);
+	}
+
+	for (S32 i = 0; i < num_packets; ++i)
+	{
+		scatter((*mPackets)[i]);
+	}
+	mChains.clear();
+}
+
+//static
+void LLFlexibleSolver::gather(Packet& packet, Chain* const* chains, S32 count)
+{
+	llassert(count > 0 && count <= LANES);
+	packet.mCount = count;
+	packet.mNumSections = chains[0]->mNumSections;
+	llassert(packet.mNumSections > 0 && packet.mNumSections < FLEXIBLE_SOLVER_SECTIONS);
+
+	for (S32 lane = 0; lane < LANES; ++lane)
+	{
+		Chain* chain = chains[lane < count ? lane : 0];
+		packet.mChains[lane] = lane < count ? chain : NULL;
+
+		for (S32 i = 0; i <= packet.mNumSections; ++i)
+		{
+			const LLFlexibleObjectSection& section = chain->mSections[i];
+			setLane(packet.mPosition[i], lane, section.mPosition);
+			setLane(packet.mVelocity[i], lane, section.mVelocity);
+			setLane(packet.mDirection[i], lane, section.mDirection);
+			setLane(packet.mRotation[i], lane, section.mRotation);
+			setLane(packet.mWind[i], lane, chain->mWind[i]);
+		}
+
+		setLane(packet.mUserForce, lane, chain->mUserForce);
+		packet.mSectionLength.getF32ptr()[lane] = chain->mSectionLength;
+		packet.mTension.getF32ptr()[lane] = chain->mTension;
+		packet.mMomentum.getF32ptr()[lane] = chain->mMomentum;
+		packet.mGravity.getF32ptr()[lane] = chain->mGravity;
+		packet.mWindFactor.getF32ptr()[lane] = chain->mWindFactor;
+		packet.mCosHalfMaxAngle.getF32ptr()[lane] = cosf(chain->mMaxAngle * 0.5f);
+		packet.mSinHalfMaxAngle.getF32ptr()[lane] = sinf(chain->mMaxAngle * 0.5f);
+	}
+}
+
+//static
+void LLFlexibleSolver::scatter(const Packet& packet)
+{
+	const S32 num_sections = packet.mNumSections;
+	for (S32 lane = 0; lane < packet.mCount; ++lane)
+	{
+		Chain* chain = packet.mChains[lane];
+		LLFlexibleObjectSection* sections = chain->mSections;
+
+		// The anchor is the caller's
+		for (S32 i = 1; i <= num_sections; ++i)
+		{
+			sections[i].mPosition = getLane(packet.mPosition[i], lane);
+			sections[i].mVelocity = getLane(packet.mVelocity[i], lane);
+			sections[i].mDirection = getLane(packet.mDirection[i], lane);
+			sections[i].mRotation = getLane(packet.mRotation[i], lane);
+		}
+		chain->mEndRotation = getLane(packet.mEndRotation, lane);
+
+		// Calculate derivatives (not necessary until normals are automagically generated)
+		const F32 section_length = chain->mSectionLength;
+		const F32 inv_section_length = 1.f / section_length;
+		sections[0].mdPosition = (sections[1].mPosition - sections[0].mPosition) * inv_section_length;
+		// i = 1..NumSections-1
+		S32 i;
+		for (i = 1; i < num_sections; ++i)
+		{
+			// Quadratic numerical derivative of position
+
+			// f(-L1) = aL1^2 - bL1 + c = f1
+			// f(0)   =               c = f2
+			// f(L2)  = aL2^2 + bL2 + c = f3
+			// f = ax^2 + bx + c
+			// d/dx f = 2ax + b
+			// d/dx f(0) = b
+
+			// c = f2
+			// a = [(f1-c)/L1 + (f3-c)/L2] / (L1+L2)
+			// b = (f3-c-aL2^2)/L2
+
+			LLVector3 a = (sections[i-1].mPosition-sections[i].mPosition +
+						sections[i+1].mPosition-sections[i].mPosition) * 0.5f * inv_section_length * inv_section_length;
+			LLVector3 b = (sections[i+1].mPosition-sections[i].mPosition - a*(section_length*section_length));
+			b *= inv_section_length;
+
+			sections[i].mdPosition = b;
+		}
+
+		// i = NumSections
+		sections[i].mdPosition = (sections[i].mPosition - sections[i-1].mPosition) * inv_section_length;
+	}
+}
+
+void LLFlexibleSolver::stepRange(S32 begin, S32 end)
+{
+	for (S32 i = begin; i < end; ++i)
+	{
+		step((*mPackets)[i]);
+	}
+}
+
+// The same step as the scalar solver this replaced, one lane per chain:
+// gravity, wind and user force, then tension towards the parent's direction,
+// inertia, and a limit on how far each section may bend from its parent.
+//static
+void LLFlexibleSolver::step(Packet& packet)
+{
+	const LLVector4a zero = LLVector4a::getZero();
+	const LLVector4a one = splat(1.f);
+	const LLVector4a half = splat(0.5f);
+	const LLVector4a threshold = splat(FP_MAG_THRESHOLD);
+	const Quatx4 identity = { zero, zero, zero, one };
+
+	Quatx4 parent_rotation = packet.mRotation[0];
+
+	for (S32 i = 1; i <= packet.mNumSections; ++i)
+	{
+		Vec3x4& position = packet.mPosition[i];
+		const Vec3x4 last_position = position;
+
+		// gravity, wind (a factor of zero when the prim ignores it) and user-defined force
+		position.z.sub(packet.mGravity);
+		madd(position, packet.mWind[i], packet.mWindFactor);
+		position = add(position, packet.mUserForce);
+
+		// tension (rigidity, stiffness)
+		const Vec3x4& parent_position = packet.mPosition[i-1];
+		const Vec3x4& parent_direction = packet.mDirection[i-1];
+		const Vec3x4& parent_section_vector = packet.mDirection[i == 1 ? 0 : i-2];
+		const Vec3x4 current_vector = sub(position, parent_position);
+		madd(position, sub(scale(parent_section_vector, packet.mSectionLength), current_vector), packet.mTension);
+
+		// inertia
+		madd(position, packet.mVelocity[i], packet.mMomentum);
+
+		// clamp length & rotation
+		Vec3x4 direction = sub(position, parent_position);
+		normalize(direction);
+
+		// LLQuaternion::shortestArc(parent_direction, direction)
+		const LLVector4a ab = dot(parent_direction, direction);
+		const Vec3x4 c = cross(parent_direction, direction);
+		const LLVector4a cc = dot(c, c);
+		const LLVector4a s = add(sqrt4(add(mul(ab, ab), cc)), ab);
+		LLVector4a m;
+		m.setDiv(one, sqrt4(add(cc, mul(s, s))));
+		Quatx4 delta = { mul(c.x, m), mul(c.y, m), mul(c.z, m), mul(s, m) };
+
+		const LLVector4Logical bent = cc.greaterThan(zero);
+		if (!bent.areAllSet())
+		{	// (Anti)parallel: no rotation, or half a turn around an axis in the XY plane
+			const Vec3x4 diff = sub(parent_direction, direction);
+			const LLVector4a mxy = sqrt4(add(mul(diff.x, diff.x), mul(diff.y, diff.y)));
+			const LLVector4Logical in_plane = mxy.greaterThan(threshold);
+			LLVector4a ax, ay;
+			ax.setDiv(sub(zero, diff.y), mxy);
+			ay.setDiv(diff.x, mxy);
+			const Quatx4 flip = { select(in_plane, ax, one), select(in_plane, ay, zero), zero, zero };
+			delta = select(bent, delta, select(ab.lessThan(zero), flip, identity));
+		}
+
+		// LLQuaternion::getAngleAxis(); w is never negative here, and delta has unit length,
+		// so the angle is past max_angle exactly when w is below cos(max_angle / 2).
+		const LLVector4a v = sqrt4(dot(imaginary(delta), imaginary(delta)));
+		const LLVector4Logical rotates = v.greaterThan(threshold);
+		LLVector4a oov;
+		oov.setDiv(one, v);
+		const Vec3x4 axis = { select(rotates, mul(delta.x, oov), zero),
+							  select(rotates, mul(delta.y, oov), zero),
+							  select(rotates, mul(delta.z, oov), one) };
+
+		// Propagate half the (unclamped) rotation up to the parent:
+		// cos and sin of a quarter of the angle, from cos of half of it
+		LLVector4a cos_quarter = sqrt4(mul(add(one, delta.w), half));
+		LLVector4a sin_quarter = sub(one, delta.w);
+		sin_quarter.setMax(sin_quarter, zero);
+		sin_quarter = sqrt4(mul(sin_quarter, half));
+		const Quatx4 half_delta = select(rotates, quat(scale(axis, sin_quarter), cos_quarter), identity);
+
+		const LLVector4Logical clamped = _mm_and_ps(delta.w.lessThan(packet.mCosHalfMaxAngle), rotates);
+		delta = select(clamped, quat(scale(axis, packet.mSinHalfMaxAngle), packet.mCosHalfMaxAngle), delta);
+
+		const Quatx4 segment_rotation = mul(parent_rotation, delta);
+		parent_rotation = segment_rotation;
+
+		Vec3x4& new_direction = packet.mDirection[i];
+		new_direction = rotate(parent_direction, delta);
+		position = add(parent_position, scale(new_direction, packet.mSectionLength));
+		packet.mRotation[i] = segment_rotation;
+
+		if (i > 1)
+		{
+			packet.mRotation[i-1] = mul(packet.mRotation[i-1], half_delta);
+		}
+
+		// calculate velocity
+		Vec3x4 velocity = sub(position, last_position);
+		const LLVector4Logical too_fast = dot(velocity, velocity).greaterThan(one);
+		if (too_fast.areAnySet())
+		{
+			Vec3x4 unit = velocity;
+			normalize(unit);
+			velocity = select(too_fast, unit, velocity);
+		}
+		packet.mVelocity[i] = velocity;
+	}
+
+	packet.mEndRotation = parent_rotation;
+}
@@ -0,0 +1,106 @@
+/** 
+ * @file llflexiblesolver.h
+ * @brief Steps the section chains of all flexible prims together
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ * 
+ * Copyright (c) 2026, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLFLEXIBLESOLVER_H
+#define LL_LLFLEXIBLESOLVER_H
+
+#include <vector>
+
+#include "llalignedarray.h"
+#include "llprimitive.h"
+#include "llquaternion.h"
+#include "llvector4a.h"
+#include "v3math.h"
+
+struct LLFlexibleObjectSection;
+
+// Sections per chain, counting the anchor
+const S32 FLEXIBLE_SOLVER_SECTIONS = (1 << FLEXIBLE_OBJECT_MAX_SECTIONS) + 1;
+
+//
+// Integrates gravity, wind, user force and tension for many flexible prims at
+// once. The chains are gathered four at a time, grouped by length, into
+// structure-of-arrays packets: every LLVector4a holds one component for four
+// chains, so a step of four chains costs what a step of one did with
+// LLVector3 math. The sections of one chain still go one after the other,
+// since each one follows its parent.
+//
+// Packets are independent, so solve() hands them to the thread pool. The
+// chains are only read and written during gather and scatter, on the calling
+// thread.
+//
+class LLFlexibleSolver
+{
+public:
+	// One prim's step, filled in by LLVolumeImplFlexible on the main thread
+	struct Chain
+	{
+		LLFlexibleObjectSection* mSections;	// In/out: mNumSections + 1, section 0 is the anchor
+		S32 mNumSections;
+		F32 mSectionLength;
+		F32 mTension;					// Share of the bend undone this step
+		F32 mMomentum;					// Share of the velocity kept
+		F32 mMaxAngle;					// Largest bend between two sections, in radians
+		F32 mGravity;					// This step's drop
+		LLVector3 mUserForce;			// This step's push
+		F32 mWindFactor;				// 0 if the prim ignores wind
+		LLVector3 mWind[FLEXIBLE_SOLVER_SECTIONS];	// Wind at each section before the step
+		LLQuaternion mEndRotation;		// Out: rotation of the last section
+	};
+
+	LLFlexibleSolver();
+	~LLFlexibleSolver();
+
+	// The chain must stay put until solve() returns.
+	void addChain(Chain* chain)		{ mChains.push_back(chain); }
+	S32 getChainCount() const		{ return (S32)mChains.size(); }
+	// Steps every chain added since the last solve(), then forgets them.
+	void solve(bool threaded = true);
+
+private:
+	struct Packet;
+
+	LLFlexibleSolver(const LLFlexibleSolver&);
+	LLFlexibleSolver& operator=(const LLFlexibleSolver&);
+
+	static void gather(Packet& packet, Chain* const* chains, S32 count);
+	static void scatter(const Packet& packet);
+	void stepRange(S32 begin, S32 end);
+	static void step(Packet& packet);
+
+	std::vector<Chain*> mChains;
+	std::vector<Chain*> mSorted;
+	LLAlignedArray<Packet, 64>* mPackets;
+};
+
+#endif // LL_LLFLEXIBLESOLVER_H
@@ -35,6 +35,7 @@
 #include "llagent.h"
 #include "llagentcamera.h"
 #include "llavataractions.h"
+#include "llcallbacklist.h"
 #include "llfloaterchat.h"
 #include "llfloaterregioninfo.h"
 #include "llfloaterreporter.h"
@@ -136,7 +137,8 @@ LLAvatarListEntry::LLAvatarListEntry(const LLUUID& id, const std::string& name,
 		mID(id), mName(name), mPosition(position), mMarked(false), mFocused(false),
 		mStats(),
 		mActivityType(ACTIVITY_NEW), mActivityTimer(),
-		mIsInList(false), mAge(-1), mTime(time(NULL))
+		mIsInList(false), mAge(-1), mTime(time(NULL)),
+		mListItem(NULL)
 {
 	LLAvatarPropertiesProcessor& inst(LLAvatarPropertiesProcessor::instance());
 	inst.addObserver(mID, this);
@@ -229,17 +231,49 @@ const LLAvatarListEntry::ACTIVITY_TYPE LLAvatarListEntry::getActivity()
 	return mActivityType;
 }
 
+// Our own movement that can take someone in or out of chat range
+const F64 RANGE_STATS_MOVE_DISTANCE = 1.0;
+// Seconds between retries of the avatars that could not be shown yet
+const F32 PENDING_RETRY_INTERVAL = 0.5f;
+
 LLFloaterAvatarList::LLFloaterAvatarList() :  LLFloater(std::string("radar")), 
 	mTracking(false),
 	mUpdate("RadarUpdateEnabled"),
 	mDirtyAvatarSorting(false),
-	mAvatarList(NULL)
+	mAvatarList(NULL),
+	mStatsRegionHandle(0),
+	mDirtyList(false),
+	mRebuildList(false)
 {
+	mTrackerConnection = LLAvatarPositionTracker::instance().setChangedCallback(boost::bind(&LLFloaterAvatarList::onAvatarsChanged, this, _1));
 	LLUICtrlFactory::getInstance()->buildFloater(this, "floater_radar.xml");
+	gIdleCallbacks.addFunction(&LLFloaterAvatarList::callbackIdle, this);
 }
 
 LLFloaterAvatarList::~LLFloaterAvatarList()
 {
+	gIdleCallbacks.deleteFunction(&LLFloaterAvatarList::callbackIdle, this);
+}
+
+//static
+void LLFloaterAvatarList::callbackIdle(void* userdata)
+{
+	LLFloaterAvatarList* self = static_cast<LLFloaterAvatarList*>(userdata);
+	self->updateRangeStats();
+
+	// The tracker only reports avatars that move. A still one that was
+	// pending gets its name, or comes into range because we moved, without
+	// a word from it, so try those again now and then.
+	if (!self->mPendingAvatars.empty() && self->mPendingTimer.getElapsedTimeF32() > PENDING_RETRY_INTERVAL)
+	{
+		self->mPendingTimer.reset();
+		const size_t count = self->mAvatars.size();
+		self->updatePendingAvatars();
+		if (self->mAvatars.size() != count)
+		{
+			self->updateTitle();
+		}
+	}
 }
 
 //static
@@ -263,6 +297,11 @@ void LLFloaterAvatarList::showInstance()
 
 void LLFloaterAvatarList::draw()
 {
+	// Rows follow the entries a few times a second; the time column wants a refresh every second anyway.
+	if (mRefreshTimer.getElapsedTimeF32() > (mDirtyList ? 0.25f : 1.f))
+	{
+		refreshAvatarList();
+	}
 	LLFloater::draw();
 }
 
@@ -411,10 +450,11 @@ BOOL LLFloaterAvatarList::postBuild()
 	mAvatarList->setCommitCallback(boost::bind(&LLFloaterAvatarList::onSelectName,this));
 	mAvatarList->setDoubleClickCallback(boost::bind(&LLFloaterAvatarList::onClickFocus,this));
 	mAvatarList->setSortChangedCallback(boost::bind(&LLFloaterAvatarList::onAvatarSortingChanged,this));
-	BOOST_FOREACH(LLViewerRegion* region, LLWorld::instance().getRegionList())
-	{
-		updateAvatarList(region);
-	}
+	uuid_vec_t ids;
+	LLAvatarPositionTracker::instance().getAvatarIDs(ids);
+	mPendingAvatars.insert(ids.begin(), ids.end());
+	updatePendingAvatars();
+	updateTitle();
 
 	assessColumns();
 
@@ -454,6 +494,10 @@ void col_helper(const bool hide, LLCachedControl<S32> &setting, LLScrollListColu
 
 void LLFloaterAvatarList::assessColumns()
 {
+	// Rows only have cells for the columns that were shown when they were made.
+	mRebuildList = true;
+	mDirtyList = true;
+
 	BIND_COLUMN_TO_SETTINGS(LIST_MARK,Mark);
 	BIND_COLUMN_TO_SETTINGS(LIST_POSITION,Position);
 	BIND_COLUMN_TO_SETTINGS(LIST_ALTITUDE,Altitude);
@@ -509,102 +553,166 @@ void updateParticleActivity(LLDrawable *drawablep)
 	}
 }
 
-void LLFloaterAvatarList::updateAvatarList(const LLViewerRegion* region)
+void LLFloaterAvatarList::onAvatarsChanged(const LLAvatarPositionTracker::Changes& changes)
 {
-	// Check whether updates are enabled
-	if (!mUpdate)
+	const size_t count = mAvatars.size();
+	BOOST_FOREACH(const LLUUID& id, changes.mRemoved)
 	{
-		refreshTracker();
-		return;
+		removeAvatar(id);
 	}
 
+	mPendingAvatars.insert(changes.mAdded.begin(), changes.mAdded.end());
+	mPendingAvatars.insert(changes.mMoved.begin(), changes.mMoved.end());
+	updatePendingAvatars();
+
+	if (mAvatars.size() != count)
 	{
-		const std::vector<U32>& map_avs(region->mMapAvatars);
-		const std::vector<LLUUID>& map_avids(region->mMapAvatarIDs);
-		const LLVector3d& mypos(gAgent.getPositionGlobal());
-		const LLVector3d& origin(region->getOriginGlobal());
-		static const LLCachedControl<F32> radar_range_radius("RadarRangeRadius", 0);
-		const F32 max_range(radar_range_radius * radar_range_radius);
+		updateTitle();
+	}
+	refreshTracker();
+}
 
-		static LLCachedControl<bool> announce(gSavedSettings, "RadarChatKeys");
-		std::queue<LLUUID> announce_keys;
+void LLFloaterAvatarList::updatePendingAvatars()
+{
+	// Check whether updates are enabled
+	if (!mUpdate || mPendingAvatars.empty()) return;
 
-		bool no_names(gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMETAGS));
-		bool anon_names(!no_names && gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMES));
-		const std::string& rlv_hidden(RlvStrings::getString(RLV_STRING_HIDDEN));
-		for (size_t i = 0, size = map_avs.size(); i < size; ++i)
+	static LLCachedControl<bool> announce(gSavedSettings, "RadarChatKeys");
+	std::queue<LLUUID> announce_keys;
+
+	for (uuid_set_t::iterator it = mPendingAvatars.begin(); it != mPendingAvatars.end();)
+	{
+		if (updateAvatar(*it, announce_keys))
+			mPendingAvatars.erase(it++);
+		else
+			++it;
+	}
+
+	//let us send the keys in a more timely fashion
+	if (announce && !announce_keys.empty())
+	{
+		// NOTE: This fragment is repeated in sendKey
+		std::ostringstream ids;
+		U32 transact_num = gFrameCount;
+		U32 num_ids = 0;
+		while(!announce_keys.empty())
 		{
-			const LLUUID& avid = map_avids[i];
-			LLVector3d position(unpackLocalToGlobalPosition(map_avs[i], origin));
+			ids << "," << announce_keys.front().asString();
+			++num_ids;
+			if (ids.tellp() > 200)
+			{
+				send_keys_message(transact_num, num_ids, ids.str());
+				ids.seekp(num_ids = 0);
+				ids.str("");
+			}
+			announce_keys.pop();
+		}
+		if (num_ids) send_keys_message(transact_num, num_ids, ids.str());
+	}
+}
 
-			LLVOAvatar* avatarp = gObjectList.findAvatar(avid);
-			if (avatarp) position = gAgent.getPosGlobalFromAgent(avatarp->getCharacterPosition());
+bool LLFloaterAvatarList::updateAvatar(const LLUUID& avid, std::queue<LLUUID>& announce_keys)
+{
+	const LLAvatarPositionTracker& tracker(LLAvatarPositionTracker::instance());
+	const LLVector3d* tracked_position = tracker.getPosition(avid);
+	if (!tracked_position) return true; // Gone already
+	const LLVector3d position(*tracked_position);
 
-			if (max_range && dist_vec_squared(position, mypos) > max_range) continue; // Out of desired range
+	const LLVector3d& mypos(gAgent.getPositionGlobal());
+	static const LLCachedControl<F32> radar_range_radius("RadarRangeRadius", 0);
+	const F32 max_range(radar_range_radius * radar_range_radius);
+	if (max_range && dist_vec_squared(position, mypos) > max_range) return false; // Out of desired range
 
-			std::string name;
-			if (no_names) name = rlv_hidden;
-			else if (!LLAvatarNameCache::getNSName(avid, name, radar_namesystem())) continue; //prevent (Loading...)
-			else if (anon_names) name = RlvStrings::getAnonym(name);
+	bool no_names(gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMETAGS));
+	std::string name;
+	if (no_names) name = RlvStrings::getString(RLV_STRING_HIDDEN);
+	else if (!LLAvatarNameCache::getNSName(avid, name, radar_namesystem())) return false; //prevent (Loading...)
+	else if (gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMES)) name = RlvStrings::getAnonym(name);
 
-			LLAvatarListEntry* entry = getAvatarEntry(avid);
-			if (!entry)
-			{
-				// Avatar not there yet, add it
-				if (announce && gAgent.getRegion()->pointInRegionGlobal(position)) announce_keys.push(avid);
-				mAvatars.push_back(LLAvatarListEntryPtr(entry = new LLAvatarListEntry(avid, name, position)));
-			}
+	LLAvatarListEntry* entry = getAvatarEntry(avid);
+	if (!entry)
+	{
+		// Avatar not there yet, add it
+		static LLCachedControl<bool> announce(gSavedSettings, "RadarChatKeys");
+		if (announce && gAgent.getRegion()->pointInRegionGlobal(position)) announce_keys.push(avid);
+		LLAvatarListEntryPtr ptr(entry = new LLAvatarListEntry(avid, name, position));
+		mAvatars.push_back(ptr);
+		mAvatarMap[avid] = ptr;
+	}
 
-			// Announce position
-			entry->setPosition(position, (position - mypos).magVec(), avatarp);
+	// Announce position
+	entry->setPosition(position, (position - mypos).magVec(), tracker.isDrawn(avid));
+	if (entry->mStats[STAT_TYPE_SHOUTRANGE] || entry->mStats[STAT_TYPE_CHATRANGE])
+		mInRange.insert(avid);
+	else
+		mInRange.erase(avid);
 
-			// Mark as typing if they are typing
-			if (avatarp && avatarp->isTyping()) entry->setActivity(LLAvatarListEntry::ACTIVITY_TYPING);
-		}
+	mDirtyList = true;
+	return true;
+}
 
-		// Set activity for anyone making sounds
-		if (gAudiop)
-			for (LLAudioEngine::source_map::iterator i = gAudiop->mAllSources.begin(); i != gAudiop->mAllSources.end(); ++i)
-				if (LLAvatarListEntry* entry = getAvatarEntry((i->second)->getOwnerID()))
-					entry->setActivity(LLAvatarListEntry::ACTIVITY_SOUND);
+void LLFloaterAvatarList::removeAvatar(const LLUUID& id)
+{
+	mPendingAvatars.erase(id);
+	mInRange.erase(id);
 
-		//let us send the keys in a more timely fashion
-		if (announce && !announce_keys.empty())
-		{
-			// NOTE: This fragment is repeated in sendKey
-			std::ostringstream ids;
-			U32 transact_num = gFrameCount;
-			U32 num_ids = 0;
-			while(!announce_keys.empty())
-			{
-				ids << "," << announce_keys.front().asString();
-				++num_ids;
-				if (ids.tellp() > 200)
-				{
-					send_keys_message(transact_num, num_ids, ids.str());
-					ids.seekp(num_ids = 0);
-					ids.str("");
-				}
-				announce_keys.pop();
-			}
-			if (num_ids) send_keys_message(transact_num, num_ids, ids.str());
-		}
+	boost::unordered_map<LLUUID, LLAvatarListEntryPtr>::iterator found = mAvatarMap.find(id);
+	if (found == mAvatarMap.end()) return;
+
+	LLAvatarListEntry* entry = found->second.get();
+	entry->setPosition(entry->getPosition(), F32_MIN, false); // Dead and gone
+	if (entry->mListItem)
+	{
+		// Indices are only good in sorted order.
+		mAvatarList->updateSort();
+		mAvatarList->deleteSingleItem(mAvatarList->getItemIndex(entry->mListItem));
 	}
+	mAvatars.erase(std::find(mAvatars.begin(), mAvatars.end(), found->second));
+	mAvatarMap.erase(found);
+	mDirtyList = true;
 }
 
-void LLFloaterAvatarList::expireAvatarList(const std::list<LLUUID>& ids)
+void LLFloaterAvatarList::updateRangeStats()
 {
+	const LLVector3d& mypos(gAgent.getPositionGlobal());
+	const U64 region_handle(gAgent.getRegion() ? gAgent.getRegion()->getHandle() : 0);
+	const LLAvatarPositionTracker& tracker(LLAvatarPositionTracker::instance());
+
+	if (region_handle != mStatsRegionHandle)
+	{
+		// Everyone's in a different sim from us now.
+		mStatsRegionHandle = region_handle;
+		mStatsPosition = mypos;
+		BOOST_FOREACH(av_list_t::value_type& entry, mAvatars)
+		{
+			entry->setPosition(entry->getPosition(), (entry->getPosition() - mypos).magVec(), tracker.isDrawn(entry->getID()));
+		}
+		mDirtyList = true;
+		return;
+	}
+
+	if (dist_vec_squared(mypos, mStatsPosition) < RANGE_STATS_MOVE_DISTANCE * RANGE_STATS_MOVE_DISTANCE) return;
+	mStatsPosition = mypos;
+
+	// Only those in range now, and those that were, can have crossed a range.
+	uuid_vec_t ids(mInRange.begin(), mInRange.end());
+	tracker.findInRange(mypos, llmax(LFSimFeatureHandler::getInstance()->shoutRange(), LFSimFeatureHandler::getInstance()->sayRange()), ids);
 	BOOST_FOREACH(const LLUUID& id, ids)
 	{
-		av_list_t::iterator it(std::find_if(mAvatars.begin(), mAvatars.end(), LLAvatarListEntry::uuidMatch(id)));
-		if (it != mAvatars.end())
+		if (LLAvatarListEntry* entry = getAvatarEntry(id))
 		{
-			LLAvatarListEntry* entry = it->get();
-			entry->setPosition(entry->getPosition(), F32_MIN, false); // Dead and gone
-			mAvatars.erase(it);
+			entry->setPosition(entry->getPosition(), (entry->getPosition() - mypos).magVec(), tracker.isDrawn(id));
+			if (entry->mStats[STAT_TYPE_SHOUTRANGE] || entry->mStats[STAT_TYPE_CHATRANGE])
+				mInRange.insert(id);
+			else
+				mInRange.erase(id);
 		}
 	}
+	mDirtyList = true;
+}
 
+void LLFloaterAvatarList::updateTitle()
+{
 	if (mAvatars.empty())
 		setTitle(getString("Title"));
 	else if (mAvatars.size() == 1)
@@ -615,9 +723,6 @@ void LLFloaterAvatarList::expireAvatarList(const std::list<LLUUID>& ids)
 		args["[COUNT]"] = boost::lexical_cast<std::string>(mAvatars.size());
 		setTitle(getString("TitleWithCount", args));
 	}
-
-	refreshAvatarList();
-	refreshTracker();
 }
 
 void LLFloaterAvatarList::updateAvatarSorting()
@@ -651,13 +756,28 @@ void LLFloaterAvatarList::refreshAvatarList()
 	// Don't update list when interface is hidden
 	if (!getVisible()) return;
 
-	// We rebuild the list fully each time it's refreshed
-	// The assumption is that it's faster to refill it and sort than
-	// to rebuild the whole list.
-	uuid_vec_t selected = mAvatarList->getSelectedIDs();
-	S32 scrollpos = mAvatarList->getScrollPos();
+	mRefreshTimer.reset();
+	mDirtyList = false;
 
-	mAvatarList->deleteAllItems();
+	// Rows stay, and only the cells that show something else change, so
+	// selection and scroll position are kept and sorting only happens when
+	// a sorted column changed.
+	if (mRebuildList)
+	{
+		mRebuildList = false;
+		mAvatarList->deleteAllItems();
+		BOOST_FOREACH(av_list_t::value_type& entry, mAvatars)
+		{
+			entry->mListItem = NULL;
+			entry->mCells.clear();
+		}
+	}
+
+	// Set activity for anyone making sounds
+	if (gAudiop)
+		for (LLAudioEngine::source_map::iterator i = gAudiop->mAllSources.begin(); i != gAudiop->mAllSources.end(); ++i)
+			if (LLAvatarListEntry* entry = getAvatarEntry((i->second)->getOwnerID()))
+				entry->setActivity(LLAvatarListEntry::ACTIVITY_SOUND);
 
 	LLVector3d mypos = gAgent.getPositionGlobal();
 	LLVector3d posagent;
@@ -684,10 +804,23 @@ void LLFloaterAvatarList::refreshAvatarList()
 
 		//jcool410 -- this fucks up seeing dueds thru minimap data > 1024m away, so, lets just say > 2048m to the side is bad
 		//aka 8 sims
-		if (delta.magVec() > 2048.0) continue;
+		if (delta.magVec() > 2048.0)
+		{
+			if (entry->mListItem)
+			{
+				mAvatarList->updateSort();
+				mAvatarList->deleteSingleItem(mAvatarList->getItemIndex(entry->mListItem));
+				entry->mListItem = NULL;
+			}
+			continue;
+		}
 
 		entry->setInList();
 		const LLUUID& av_id = entry->getID();
+
+		// Mark as typing if they are typing
+		LLVOAvatar* avatarp = gObjectList.findAvatar(av_id);
+		if (avatarp && avatarp->isTyping()) entry->setActivity(LLAvatarListEntry::ACTIVITY_TYPING);
 		LLScrollListItem::Params element;
 		element.value = av_id;
 
@@ -945,7 +1078,7 @@ void LLFloaterAvatarList::refreshAvatarList()
 
 			static const LLCachedControl<LLColor4> avatar_name_color(gColors, "AvatarNameColor",LLColor4(0.98f, 0.69f, 0.36f, 1.f));
 			color = avatar_name_color;
-			if (LLVOAvatar* avatarp = gObjectList.findAvatar(av_id))
+			if (avatarp)
 			{
 				std::string client = SHClientTagMgr::instance().getClientName(avatarp, false);
 				if (client.empty())
@@ -965,20 +1098,60 @@ void LLFloaterAvatarList::refreshAvatarList()
 			element.columns.add(viewer);
 		}
 
-		// Add to list
-		mAvatarList->addRow(element);
+		// Add to list, or update the row
+		setRowCells(entry.get(), element);
 	}
 
 	// finish
 	mAvatarList->updateSort();
-	mAvatarList->selectMultiple(selected);
-	mAvatarList->setScrollPos(scrollpos);
 	
 	mDirtyAvatarSorting = true;
 
 //	LL_INFOS() << "radar refresh: done" << LL_ENDL;
 }
 
+// What a cell shows, to tell whether it needs replacing
+static std::string cell_signature(const LLScrollListCell::Params& cell)
+{
+	const LLColor4& color = cell.color;
+	const std::string& type = cell.type;
+	const std::string& font_style = cell.font_style;
+	const std::string& tool_tip = cell.tool_tip;
+	return type + '\n' + cell.value().asString() + '\n' + font_style + '\n' + tool_tip
+		+ llformat("\n%g %g %g %g", color.mV[VRED], color.mV[VGREEN], color.mV[VBLUE], color.mV[VALPHA]);
+}
+
+void LLFloaterAvatarList::setRowCells(LLAvatarListEntry* entry, const LLScrollListItem::Params& element)
+{
+	std::vector<std::string> cells;
+	for (LLInitParam::ParamIterator<LLScrollListCell::Params>::const_iterator it = element.columns.begin(); it != element.columns.end(); ++it)
+	{
+		cells.push_back(cell_signature(*it));
+	}
+
+	if (entry->mListItem && entry->mCells.size() == cells.size())
+	{
+		S32 i = 0;
+		for (LLInitParam::ParamIterator<LLScrollListCell::Params>::const_iterator it = element.columns.begin(); it != element.columns.end(); ++it, ++i)
+		{
+			if (cells[i] != entry->mCells[i])
+			{
+				mAvatarList->setCell(entry->mListItem, *it);
+			}
+		}
+	}
+	else
+	{
+		if (entry->mListItem)
+		{
+			mAvatarList->updateSort();
+			mAvatarList->deleteSingleItem(mAvatarList->getItemIndex(entry->mListItem));
+		}
+		entry->mListItem = mAvatarList->addRow(element);
+	}
+	entry->mCells.swap(cells);
+}
+
 void LLFloaterAvatarList::resetAvatarNames()
 {
 	bool hide_tags(gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMETAGS));
@@ -1074,9 +1247,8 @@ void LLFloaterAvatarList::trackAvatar(const LLAvatarListEntry* entry) const
 
 LLAvatarListEntry* LLFloaterAvatarList::getAvatarEntry(const LLUUID& avatar) const
 {
-	if (avatar.isNull()) return NULL;
-	av_list_t::const_iterator iter = std::find_if(mAvatars.begin(),mAvatars.end(),LLAvatarListEntry::uuidMatch(avatar));
-	return (iter != mAvatars.end()) ? iter->get() : NULL;
+	boost::unordered_map<LLUUID, LLAvatarListEntryPtr>::const_iterator iter = mAvatarMap.find(avatar);
+	return (iter != mAvatarMap.end()) ? iter->second.get() : NULL;
 }
 
 BOOL LLFloaterAvatarList::handleKeyHere(KEY key, MASK mask)
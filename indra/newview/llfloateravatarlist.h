@@ -15,19 +15,23 @@
 #define LL_LLFLOATERAVATARLIST_H
 
 #include "llavatarname.h"
+#include "llavatarpositiontracker.h"
 #include "llavatarpropertiesprocessor.h"
 #include "llfloater.h"
 #include "llfloaterreporter.h"
 #include "lluuid.h"
+#include "llframetimer.h"
 #include "lltimer.h"
 #include "llscrolllistctrl.h"
 
 #include <time.h>
 #include <bitset>
 #include <map>
+#include <queue>
 #include <set>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 class LLFloaterAvatarList;
 
@@ -153,6 +157,12 @@ private:
 	ACTIVITY_TYPE mActivityType;
 
 	LLTimer mActivityTimer;
+
+	/**
+	 * @brief The entry's row in the list, and what its cells showed when last refreshed
+	 */
+	LLScrollListItem* mListItem;
+	std::vector<std::string> mCells;
 };
 
 
@@ -200,12 +210,13 @@ public:
 	void assessColumns();
 
 	/**
-	 * @brief Updates the internal avatar list with the currently present avatars.
+	 * @brief Applies what LLAvatarPositionTracker saw arrive, move and leave since the last frame.
 	 */
-	void updateAvatarList(const class LLViewerRegion* region);
+	void onAvatarsChanged(const LLAvatarPositionTracker::Changes& changes);
 
 	/**
 	 * @brief Refresh avatar list (display)
+	 * Only the rows that changed are touched.
 	 */
 	void refreshAvatarList();
 
@@ -322,23 +333,58 @@ public:
 
 	void doCommand(avlist_command_t cmd, bool single = false) const;
 
-	/**
-	 * @brief Cleanup avatar list, removing dead entries from it.
-	 * This lets dead entries remain for some time. This makes it possible
-	 * to keep people passing by in the list long enough that it's possible
-	 * to do something to them.
-	 */
-	void expireAvatarList(const std::list<LLUUID>& ids);
 	void updateAvatarSorting();
 
 private:
+	/**
+	 * @brief Adds or moves the entries of mPendingAvatars; those that can't be shown yet stay pending.
+	 */
+	void updatePendingAvatars();
+
+	/**
+	 * @brief Adds or moves the avatar's entry; false if it can't be shown yet.
+	 * New avatars in our region go to announce_keys.
+	 */
+	bool updateAvatar(const LLUUID& id, std::queue<LLUUID>& announce_keys);
+
+	/**
+	 * @brief Removes the avatar's entry and row, when the tracker lost it.
+	 */
+	void removeAvatar(const LLUUID& id);
+
+	/**
+	 * @brief Range alerts of the avatars that did not move, when we did.
+	 */
+	void updateRangeStats();
+
+	void updateTitle();
+	void setRowCells(LLAvatarListEntry* entry, const LLScrollListItem::Params& element);
+
 	/**
 	 * @brief Pointer to the avatar scroll list
 	 */
 	LLScrollListCtrl*			mAvatarList;
 	av_list_t	mAvatars;
+	boost::unordered_map<LLUUID, LLAvatarListEntryPtr> mAvatarMap;
 	bool		mDirtyAvatarSorting;
 
+	/**
+	 * @brief Avatars the tracker knows, but that have no entry yet: no name, out of range or updates off
+	 */
+	uuid_set_t	mPendingAvatars;
+	LLFrameTimer mPendingTimer;		// Since the last retry of mPendingAvatars from callbackIdle()
+	/**
+	 * @brief Entries that are in chat or shout range
+	 */
+	uuid_set_t	mInRange;
+	LLVector3d	mStatsPosition;		// Our position at the last updateRangeStats()
+	U64			mStatsRegionHandle;
+
+	bool		mDirtyList;			// Entries changed since the last refresh
+	bool		mRebuildList;		// Rows have other columns than the entries think
+	LLFrameTimer mRefreshTimer;
+	boost::signals2::scoped_connection mTrackerConnection;
+
 	/**
 	 * @brief true when Updating
 	 */
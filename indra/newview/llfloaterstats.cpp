@@ -120,6 +120,18 @@ void LLFloaterStats::buildStats()
 		stat_barp->mDisplayMean = FALSE;
 	}
 
+	if(SGMemStat::havePoolStat()) {
+		stat_barp = stat_viewp->addStat("Pool fragmentation", &(LLViewerStats::getInstance()->mPoolFragmentationStat), "DebugStatModePoolFragmentation");
+		stat_barp->setUnitLabel(" %");
+		stat_barp->mMinBar = 0.f;
+		stat_barp->mMaxBar = 100.f;
+		stat_barp->mTickSpacing = 10.f;
+		stat_barp->mLabelSpacing = 25.f;
+		stat_barp->mPerSec = FALSE;
+		stat_barp->mDisplayMean = FALSE;
+		stat_barp->mPrecision = 1;
+	}
+
 	params.name("advanced stat view");
 	params.show_label(true);
 	params.label("Advanced");
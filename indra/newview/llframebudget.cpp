@@ -0,0 +1,169 @@
+/** 
+ * @file llframebudget.cpp
+ * @brief Shares the spare time of a frame between the main loop's deferrable work
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ * 
+ * Copyright (c) 2026, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llframebudget.h"
+
+LLFrameBudget gFrameBudget;
+
+// Weight of the newest frame in the running averages
+static const F32 AVERAGE_WEIGHT = 0.1f;
+// Slice growth per frame for a consumer that had to defer work
+static const F32 ESCALATION = 1.5f;
+
+LLFrameBudget::LLFrameBudget()
+:	mOtherTime(0.f),
+	mTargetFrameTime(0.f),
+	mPool(0.f),
+	mFirstFrame(true)
+{
+	memset(mConsumers, 0, sizeof(mConsumers));
+	// Messages pile up when they wait, so the network gets the most.
+	setLimits(NETWORK, 0.005f, 0.100f);
+	setLimits(STATE_MACHINES, 0.001f, 0.020f);
+	setLimits(GEOMETRY, 0.002f, 0.025f);
+	setLimits(IMAGES, 0.002f, 0.010f);
+	setLimits(WORKERS, 0.f, 0.005f);
+}
+
+//static
+const char* LLFrameBudget::getName(EConsumer consumer)
+{
+	static const char* names[NUM_CONSUMERS] =
+	{
+		"Network",
+		"State Machines",
+		"Geometry",
+		"Images",
+		"Workers"
+	};
+	return names[consumer];
+}
+
+void LLFrameBudget::setLimits(EConsumer consumer, F32 min_slice, F32 max_slice)
+{
+	Consumer& c = mConsumers[consumer];
+	c.mMinSlice = llmax(min_slice, 0.f);
+	c.mMaxSlice = llmax(max_slice, c.mMinSlice);
+	c.mSlice = llclamp(c.mSlice, c.mMinSlice, c.mMaxSlice);
+}
+
+void LLFrameBudget::report(EConsumer consumer, F32 used, bool deferred)
+{
+	Consumer& c = mConsumers[consumer];
+	c.mUsed += used;
+	c.mDeferred |= deferred;
+}
+
+void LLFrameBudget::beginFrame(F32 target_fps)
+{
+	beginFrame(target_fps, mFrameTimer.getElapsedTimeAndResetF32());
+}
+
+void LLFrameBudget::beginFrame(F32 target_fps, F32 frame_time)
+{
+	mTargetFrameTime = target_fps > 0.f ? 1.f / target_fps : 0.f;
+
+	// Whatever the consumers did not use last frame is the cost of the rest of the frame.
+	F32 used = 0.f;
+	for (S32 i = 0; i < NUM_CONSUMERS; ++i)
+	{
+		Consumer& c = mConsumers[i];
+		used += c.mUsed;
+		c.mAvgUsed = lerp(c.mAvgUsed, c.mUsed, AVERAGE_WEIGHT);
+		c.mAvgSlice = lerp(c.mAvgSlice, c.mSlice, AVERAGE_WEIGHT);
+		c.mDeferRate = lerp(c.mDeferRate, c.mDeferred ? 1.f : 0.f, AVERAGE_WEIGHT);
+	}
+	if (mFirstFrame)
+	{
+		mFirstFrame = false;
+	}
+	else
+	{
+		// A single stalled frame (loading, the debugger) should not starve the consumers for long.
+		mOtherTime = lerp(mOtherTime, llclamp(frame_time - used, 0.f, 1.f), AVERAGE_WEIGHT);
+	}
+
+	F32 min_total = 0.f;
+	F32 max_total = 0.f;
+	for (S32 i = 0; i < NUM_CONSUMERS; ++i)
+	{
+		min_total += mConsumers[i].mMinSlice;
+		max_total += mConsumers[i].mMaxSlice;
+	}
+	// Without a target every consumer may take what it wants.
+	mPool = mTargetFrameTime > 0.f ? llclamp(mTargetFrameTime - mOtherTime, min_total, max_total) : max_total;
+
+	// Minimum slices first, then what each one wants, in priority order. A
+	// consumer that had to defer gets half as much again as it was given,
+	// whether or not the pool has room for it; falling further behind costs
+	// more than a slow frame. The others get a bit more than they have been
+	// using, as far as the pool goes.
+	F32 remaining = mPool - min_total;
+	for (S32 i = 0; i < NUM_CONSUMERS; ++i)
+	{
+		Consumer& c = mConsumers[i];
+		if (c.mDeferred)
+		{
+			c.mSlice = llclamp(c.mSlice * ESCALATION, c.mMinSlice, c.mMaxSlice);
+			remaining -= c.mSlice - c.mMinSlice;
+		}
+		else
+		{
+			F32 want = llclamp(c.mAvgUsed * 1.25f, c.mMinSlice, c.mMaxSlice);
+			F32 extra = llclamp(want - c.mMinSlice, 0.f, llmax(remaining, 0.f));
+			c.mSlice = c.mMinSlice + extra;
+			remaining -= extra;
+		}
+	}
+	// The rest goes to the consumers that are behind.
+	for (S32 i = 0; i < NUM_CONSUMERS && remaining > 0.f; ++i)
+	{
+		Consumer& c = mConsumers[i];
+		if (c.mDeferred)
+		{
+			F32 extra = llmin(c.mMaxSlice - c.mSlice, remaining);
+			c.mSlice += extra;
+			remaining -= extra;
+		}
+	}
+	mPool = 0.f;
+	for (S32 i = 0; i < NUM_CONSUMERS; ++i)
+	{
+		mPool += mConsumers[i].mSlice;
+		mConsumers[i].mUsed = 0.f;
+		mConsumers[i].mDeferred = false;
+	}
+}
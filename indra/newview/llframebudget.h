@@ -0,0 +1,112 @@
+/** 
+ * @file llframebudget.h
+ * @brief Shares the spare time of a frame between the main loop's deferrable work
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ * 
+ * Copyright (c) 2026, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+
+#ifndef LL_LLFRAMEBUDGET_H
+#define LL_LLFRAMEBUDGET_H
+
+#include "lltimer.h"
+
+//
+// Hands out the time a frame has left over to the main loop's work that can
+// wait for a later frame: message decoding, state machines, geometry
+// rebuilds, texture updates and the worker thread updates.
+//
+// Each frame, beginFrame() measures how long the rest of the frame took
+// (rendering, UI, everything that is not a consumer) and gives the time
+// that remains until the target frame time to the consumers in priority
+// order. Every consumer is guaranteed its minimum slice, so nothing starves
+// when the target can't be met. Beyond that a consumer gets what it used
+// recently. One that had to defer work gets half as much again each frame
+// until it catches up or reaches its maximum, even when that overruns the
+// target: on a machine that can't make the target at all, a backlog of
+// messages or state machines would otherwise never clear.
+//
+class LLFrameBudget
+{
+public:
+	// In priority order
+	enum EConsumer
+	{
+		NETWORK,			// LLAppViewer::idleNetwork()
+		STATE_MACHINES,		// gMainThreadEngine
+		GEOMETRY,			// LLPipeline::createObjects() and updateGeom()
+		IMAGES,				// LLViewerTextureList::updateImages()
+		WORKERS,			// Texture cache, decode, fetch and file thread updates
+		NUM_CONSUMERS
+	};
+
+	struct Consumer
+	{
+		F32 mMinSlice;		// Seconds
+		F32 mMaxSlice;
+		F32 mSlice;			// Granted this frame
+		F32 mUsed;			// Spent this frame
+		bool mDeferred;		// Left work for the next frame
+		F32 mAvgUsed;		// Running averages, for the slices and the debug text
+		F32 mAvgSlice;
+		F32 mDeferRate;		// Fraction of frames that deferred work
+	};
+
+	LLFrameBudget();
+
+	// Once per frame, before the first consumer runs. No target if target_fps <= 0.
+	void beginFrame(F32 target_fps);
+	// The same, with the duration of the frame that just ended given rather than measured.
+	void beginFrame(F32 target_fps, F32 frame_time);
+
+	// Seconds consumer may spend this frame.
+	F32 getSlice(EConsumer consumer) const	{ return mConsumers[consumer].mSlice; }
+	// What consumer spent, and whether it had to leave work for the next frame.
+	void report(EConsumer consumer, F32 used, bool deferred);
+
+	void setLimits(EConsumer consumer, F32 min_slice, F32 max_slice);
+
+	const Consumer& getConsumer(EConsumer consumer) const	{ return mConsumers[consumer]; }
+	static const char* getName(EConsumer consumer);
+	F32 getTargetFrameTime() const			{ return mTargetFrameTime; }
+	// Time given out this frame
+	F32 getPool() const						{ return mPool; }
+
+private:
+	Consumer mConsumers[NUM_CONSUMERS];
+	LLTimer mFrameTimer;
+	F32 mOtherTime;			// Running average of the frame time outside the consumers
+	F32 mTargetFrameTime;
+	F32 mPool;
+	bool mFirstFrame;
+};
+
+extern LLFrameBudget gFrameBudget;
+
+#endif // LL_LLFRAMEBUDGET_H
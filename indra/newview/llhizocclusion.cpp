@@ -0,0 +1,243 @@
+/** 
+ * @file llhizocclusion.cpp
+ * @brief Occlusion culling against a hierarchical depth buffer
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ * 
+ * Copyright (c) 2026, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llhizocclusion.h"
+
+#include "llappviewer.h"
+#include "llfasttimer.h"
+#include "llglslshader.h"
+#include "llspatialpartition.h"
+#include "llviewercontrol.h"
+#include "llviewershadermgr.h"
+#include "pipeline.h"
+
+static LLFastTimer::DeclareTimer FTM_HIZ_CAPTURE("Hi-Z Capture");
+static LLFastTimer::DeclareTimer FTM_HIZ_RESOLVE("Hi-Z Resolve");
+
+static LLStaticHashedString sDelta("delta");
+
+LLHiZOcclusion::LLHiZOcclusion()
+:	mActive(false),
+	mResolveFrame(U32_MAX),
+	mPixelBuffer(0),
+	mReadPending(false),
+	mCaptureFrame(0)
+{
+	mCaptureViewProj.setIdentity();
+}
+
+bool LLHiZOcclusion::isSupported() const
+{
+	return LLGLSLShader::sNoFixedFunction &&
+		LLRenderTarget::sUseFBO &&
+		gGLManager.mHasPixelBufferObject &&
+		gGLManager.mHasSync &&
+		gHiZDownsampleProgram.mProgramObject != 0;
+}
+
+void LLHiZOcclusion::resolve()
+{
+	if (mResolveFrame == gFrameCount)
+	{
+		return;
+	}
+	mResolveFrame = gFrameCount;
+
+	LLFastTimer t(FTM_HIZ_RESOLVE);
+
+	static LLCachedControl<bool> use_hiz("RenderHiZOcclusion", false);
+	mActive = use_hiz && LLPipeline::sUseOcclusion > 1 && isSupported();
+
+	if (mReadPending)
+	{
+		static LLCachedControl<bool> wait_for_query("RenderSynchronousOcclusion", true);
+		if (wait_for_query)
+		{
+			mFence.wait();
+		}
+		if (mFence.isCompleted())
+		{
+			glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, mPixelBuffer);
+			const F32* depth = (const F32*)glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB);
+			if (depth)
+			{
+				mBuffer.setDepth(depth, mHiZ.getWidth(), mHiZ.getHeight(), mCaptureViewProj);
+				glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+			}
+			else
+			{
+				mBuffer.clear();
+			}
+			glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+			mReadPending = false;
+		}
+	}
+
+	const S32 count = (S32)mGroups.size();
+	if (!count)
+	{
+		return;
+	}
+
+	// The boxes were queued during the last captured frame. If that frame was
+	// not captured, or its depth is still on the way, nothing is occluded.
+	mOccluded.assign(count, 0);
+	if (!mReadPending && mCaptureFrame + 1 == gFrameCount && !mBuffer.isEmpty())
+	{
+		mBuffer.testBoxes(&mBounds[0], count, &mOccluded[0]);
+	}
+
+	for (S32 i = 0; i < count; ++i)
+	{
+		LLSpatialGroup* group = mGroups[i];
+		if (!group->isDead() && group->isOcclusionState(LLSpatialGroup::HIZ_PENDING))
+		{
+			group->clearOcclusionState(LLSpatialGroup::HIZ_PENDING);
+			group->setOcclusionState(mOccluded[i] ? LLSpatialGroup::HIZ_OCCLUDED : LLSpatialGroup::HIZ_VISIBLE);
+		}
+	}
+	mGroups.clear();
+	mBounds.resize(0);
+}
+
+void LLHiZOcclusion::queue(LLSpatialGroup* group, const LLVector4a& center, const LLVector4a& size)
+{
+	if (group->isOcclusionState(LLSpatialGroup::HIZ_PENDING))
+	{	//already queued this frame
+		return;
+	}
+	group->clearOcclusionState(LLSpatialGroup::HIZ_VISIBLE | LLSpatialGroup::HIZ_OCCLUDED);
+	group->setOcclusionState(LLSpatialGroup::HIZ_PENDING);
+
+	mGroups.push_back(group);
+	LLVector4a* bounds = mBounds.append(2);
+	bounds[0] = center;
+	bounds[1] = size;
+}
+
+void LLHiZOcclusion::capture(LLRenderTarget& source, const LLMatrix4a& modelview, const LLMatrix4a& projection)
+{
+	if (!mActive || mReadPending)
+	{
+		return;
+	}
+
+	LLFastTimer t(FTM_HIZ_CAPTURE);
+
+	const U32 width = source.getWidth();
+	const U32 height = source.getHeight();
+	const U32 hiz_width = (width + DOWNSAMPLE - 1) / DOWNSAMPLE;
+	const U32 hiz_height = (height + DOWNSAMPLE - 1) / DOWNSAMPLE;
+
+	if (mDepthCopy.getWidth() != width || mDepthCopy.getHeight() != height)
+	{
+		mDepthCopy.release();
+		mHiZ.release();
+		if (!mDepthCopy.allocate(width, height, 0, TRUE, FALSE, LLTexUnit::TT_RECT_TEXTURE, FALSE) ||
+			!mHiZ.allocate(hiz_width, hiz_height, 0, TRUE, FALSE, LLTexUnit::TT_RECT_TEXTURE, FALSE))
+		{
+			LL_WARNS() << "Could not allocate the Hi-Z occlusion targets, using occlusion queries" << LL_ENDL;
+			release();
+			mActive = false;
+			return;
+		}
+	}
+	if (!mPixelBuffer)
+	{
+		glGenBuffersARB(1, &mPixelBuffer);
+	}
+
+	LLGLSLShader* last_shader = LLGLSLShader::sCurBoundShaderPtr;
+
+	// The source's depth is a render buffer when it has stencil, so sample a copy.
+	mDepthCopy.copyContents(source, 0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	mHiZ.bindTarget();
+	mHiZ.clear(GL_DEPTH_BUFFER_BIT);
+
+	gHiZDownsampleProgram.bind();
+	gHiZDownsampleProgram.uniform2f(sDelta, (F32)width / hiz_width, (F32)height / hiz_height);
+	gHiZDownsampleProgram.uniform2f(LLShaderMgr::DEFERRED_SCREEN_RES, width, height);
+	gGL.getTexUnit(0)->bind(&mDepthCopy, TRUE);
+	{
+		LLGLDepthTest depth(GL_TRUE, GL_TRUE, GL_ALWAYS);
+		gPipeline.drawFullScreenRect(LLVertexBuffer::MAP_VERTEX);
+	}
+	gGL.getTexUnit(0)->unbind(mDepthCopy.getUsage());
+
+	// Into the pixel buffer; resolve() maps it next frame, by which time the
+	// copy is long done.
+	glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, mPixelBuffer);
+	glBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, hiz_width * hiz_height * sizeof(F32), NULL, GL_STREAM_READ_ARB);
+	glReadPixels(0, 0, hiz_width, hiz_height, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+	mFence.placeFence();
+
+	mHiZ.flush();
+
+	if (last_shader)
+	{
+		last_shader->bind();
+	}
+	else
+	{
+		gHiZDownsampleProgram.unbind();
+	}
+
+	mCaptureViewProj.setMul(projection, modelview);
+	mCaptureFrame = gFrameCount;
+	mReadPending = true;
+}
+
+void LLHiZOcclusion::release()
+{
+	mDepthCopy.release();
+	mHiZ.release();
+	if (mPixelBuffer)
+	{
+		glDeleteBuffersARB(1, &mPixelBuffer);
+		mPixelBuffer = 0;
+	}
+	mReadPending = false;
+	mBuffer.clear();
+}
+
+void LLHiZOcclusion::cleanup()
+{
+	release();
+	mGroups.clear();
+	mBounds.resize(0);
+	mActive = false;
+}
@@ -0,0 +1,115 @@
+/** 
+ * @file llhizocclusion.h
+ * @brief Occlusion culling against a hierarchical depth buffer
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ * 
+ * Copyright (c) 2026, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLHIZOCCLUSION_H
+#define LL_LLHIZOCCLUSION_H
+
+#include <vector>
+
+#include "llalignedarray.h"
+#include "llgl.h"
+#include "llhizbuffer.h"
+#include "llpointer.h"
+#include "llrendertarget.h"
+
+class LLSpatialGroup;
+
+//
+// Hierarchical Z occlusion, the alternative to one GL occlusion query per
+// LLSpatialGroup for the world camera (RenderHiZOcclusion).
+//
+// At the end of the world render, capture() reduces the depth buffer to a
+// small max depth image and reads it back through a pixel buffer object.
+// Groups that would have issued a query this frame are queue()d instead.
+// At the start of the next frame's cull, resolve() builds the pyramid from
+// the readback and tests every queued box in one batch, so that
+// LLSpatialGroup::checkOcclusion() finds the results where it would have
+// found query results: one frame after the test was issued, against the
+// depth of the frame that issued it.
+//
+// Other cameras (shadows, reflections) keep using queries.
+//
+LL_ALIGN_PREFIX(16)
+class LLHiZOcclusion
+{
+public:
+	enum
+	{
+		// Screen pixels per Hi-Z texel, in each direction
+		DOWNSAMPLE = 8
+	};
+
+	LLHiZOcclusion();
+
+	// Whether doOcclusion() should queue world camera groups here this frame.
+	bool isActive() const					{ return mActive; }
+
+	// Before the world camera culls; does nothing after the first call in a frame.
+	void resolve();
+
+	// Test the box of group against the depth of this frame; the result is
+	// in its occlusion state by the next frame.
+	void queue(LLSpatialGroup* group, const LLVector4a& center, const LLVector4a& size);
+
+	// After the world geometry is rendered into source.
+	void capture(LLRenderTarget& source, const LLMatrix4a& modelview, const LLMatrix4a& projection);
+
+	// GL objects only; queued groups resolve as visible.
+	void release();
+	// Everything, at shutdown.
+	void cleanup();
+
+private:
+	bool isSupported() const;
+
+	LLHiZBuffer mBuffer;
+
+	// Queued this frame, tested by the next resolve()
+	std::vector<LLPointer<LLSpatialGroup> > mGroups;
+	LLAlignedArray<LLVector4a, 64> mBounds;			// Center and size per group
+	std::vector<U8> mOccluded;
+
+	bool mActive;
+	U32 mResolveFrame;
+
+	// Readback of the last capture
+	LLRenderTarget mDepthCopy;		// Full size, depth only, as the source's depth may not be a texture
+	LLRenderTarget mHiZ;			// Level 0, depth only
+	LLGLuint mPixelBuffer;
+	LLGLSyncFence mFence;
+	bool mReadPending;
+	U32 mCaptureFrame;
+	LLMatrix4a mCaptureViewProj;
+} LL_ALIGN_POSTFIX(16);
+
+#endif // LL_LLHIZOCCLUSION_H
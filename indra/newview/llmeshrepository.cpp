@@ -950,8 +950,11 @@ void LLMeshRepoThread::decActiveHeaderRequests()
 }
 
 //return false if failed to get header
+static LLFastTimer::DeclareTimer FTM_MESH_FETCH_HEADER("Mesh Fetch Header");
+
 bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params, U32& count)
 {
+	LLFastTimer t(FTM_MESH_FETCH_HEADER);
 	{
 		//look for mesh in asset in vfs
 		LLVFile file(gVFS, mesh_params.getSculptID(), LLAssetType::AT_MESH);
@@ -993,8 +996,11 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params, U32& c
 }
 
 //return false if failed to get mesh lod.
+static LLFastTimer::DeclareTimer FTM_MESH_FETCH_LOD("Mesh Fetch LOD");
+
 bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, U32& count)
 { 
+	LLFastTimer t(FTM_MESH_FETCH_LOD);
 	LLUUID mesh_id = mesh_params.getSculptID();
 	MeshHeaderInfo info;
 
@@ -1436,13 +1436,20 @@ void LLSpatialGroup::checkOcclusion()
 		LLSpatialGroup* parent = getParent();
 		if (parent && parent->isOcclusionState(LLSpatialGroup::OCCLUDED))
 		{	//if the parent has been marked as occluded, the child is implicitly occluded
-			clearOcclusionState(QUERY_PENDING | DISCARD_QUERY);
+			clearOcclusionState(QUERY_PENDING | DISCARD_QUERY | HIZ_VISIBLE | HIZ_OCCLUDED);
 		}
 		else if (isOcclusionState(QUERY_PENDING))
 		{	//otherwise, if a query is pending, read it back
 
 			GLuint available = 0;
-			if (mOcclusionQuery[LLViewerCamera::sCurCameraID])
+			if (isOcclusionState(HIZ_PENDING))
+			{	//Hi-Z test not run yet, it will be at the start of the next frame
+			}
+			else if (isOcclusionState(HIZ_VISIBLE | HIZ_OCCLUDED))
+			{
+				available = 1;
+			}
+			else if (mOcclusionQuery[LLViewerCamera::sCurCameraID])
 			{
 				glGetQueryObjectuivARB(mOcclusionQuery[LLViewerCamera::sCurCameraID], GL_QUERY_RESULT_AVAILABLE_ARB, &available);
 
@@ -1472,7 +1479,11 @@ void LLSpatialGroup::checkOcclusion()
 			if (available)
 			{ //result is available, read it back, otherwise wait until next frame
 				GLuint res = 1;
-				if (!isOcclusionState(DISCARD_QUERY) && mOcclusionQuery[LLViewerCamera::sCurCameraID])
+				if (isOcclusionState(HIZ_VISIBLE | HIZ_OCCLUDED))
+				{
+					res = isOcclusionState(HIZ_OCCLUDED) ? 0 : 1;
+				}
+				else if (!isOcclusionState(DISCARD_QUERY) && mOcclusionQuery[LLViewerCamera::sCurCameraID])
 				{
 					glGetQueryObjectuivARB(mOcclusionQuery[LLViewerCamera::sCurCameraID], GL_QUERY_RESULT_ARB, &res);	
 #if LL_TRACK_PENDING_OCCLUSION_QUERIES
@@ -1503,7 +1514,7 @@ void LLSpatialGroup::checkOcclusion()
 					assert_states_valid(this);
 				}
 
-				clearOcclusionState(QUERY_PENDING | DISCARD_QUERY);
+				clearOcclusionState(QUERY_PENDING | DISCARD_QUERY | HIZ_VISIBLE | HIZ_OCCLUDED);
 			}
 		}
 		else if (mSpatialPartition->isOcclusionEnabled() && isOcclusionState(LLSpatialGroup::OCCLUDED))
@@ -1549,6 +1560,14 @@ void LLSpatialGroup::doOcclusion(LLCamera* camera)
 		{
 			if (!isOcclusionState(QUERY_PENDING) || isOcclusionState(DISCARD_QUERY))
 			{
+				if (LLViewerCamera::sCurCameraID == LLViewerCamera::CAMERA_WORLD && gPipeline.mHiZOcclusion.isActive())
+				{ //test against the depth pyramid instead of issuing a query
+					LLVector4a fudge(SG_OCCLUSION_FUDGE);
+					LLVector4a bounds;
+					bounds.setAdd(fudge, mBounds[1]);
+					gPipeline.mHiZOcclusion.queue(this, mBounds[0], bounds);
+				}
+				else
 				{ //no query pending, or previous query to be discarded
 					LLFastTimer t(FTM_RENDER_OCCLUSION);
 
@@ -4548,5 +4567,93 @@ void LLCullResult::assertDrawMapsEmpty()
 	}
 }
 
+// Sort key of a batch within its render map, most significant bits first:
+//   63-60 material shader variant
+//   59-38 texture name
+//   37-16 vertex buffer
+//   15-0  distance along the view direction, front to back
+// The render pass is the map itself. Texture names and buffer addresses are
+// only used to bring equal ones together, so truncating them costs at most
+// an extra bind.
+static U64 draw_info_sort_key(const LLDrawInfo& params, const LLVector4a& origin, const LLVector4a& at, F32 depth_scale)
+{
+	const LLViewerTexture* texture = params.mTexture.get();
+	if (!texture && !params.mTextureList.empty())
+	{
+		texture = params.mTextureList[0].get();
+	}
+	U64 tex_name = texture && texture->hasGLTexture() ? texture->getTexName() : 0;
+	U64 buffer = (U64)((uintptr_t)params.mVertexBuffer.get() >> 4);
+
+	LLVector4a center;
+	center.setAdd(params.mExtents[0], params.mExtents[1]);
+	center.mul(0.5f);
+	center.sub(origin);
+	F32 depth = llclamp(center.dot3(at).getF32() * depth_scale, 0.f, 65535.f);
+
+	return ((U64)(params.mShaderMask & 0xF) << 60) |
+		((tex_name & 0x3FFFFF) << 38) |
+		((buffer & 0x3FFFFF) << 16) |
+		(U64)depth;
+}
+
+void LLCullResult::sortRenderMaps(const LLCamera& camera)
+{
+	LLVector4a origin, at;
+	origin.load3(camera.getOrigin().mV);
+	at.load3(camera.getAtAxis().mV);
+	const F32 depth_scale = 65535.f / llmax(camera.getFar(), 1.f);
+
+	for (U32 type = 0; type < LLRenderPass::NUM_RENDER_TYPES; ++type)
+	{
+		drawinfo_list_t& list = mRenderMap[type];
+		if (type == LLRenderPass::PASS_ALPHA || list.size() < 2)
+		{ //alpha batches are drawn per group, in the order of sortAlphaGroups()
+			continue;
+		}
+
+		const U32 count = list.size();
+		mDrawInfoKeys.resize(count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			LLDrawInfo* params = list[i];
+			//sort NULL down to the end
+			mDrawInfoKeys[i].mKey = params ? draw_info_sort_key(*params, origin, at, depth_scale) : ~0ULL;
+			mDrawInfoKeys[i].mValue = params;
+		}
+
+		ll_radix_sort(mDrawInfoKeys, mDrawInfoScratch);
+
+		for (U32 i = 0; i < count; ++i)
+		{
+			list[i] = mDrawInfoKeys[i].mValue;
+		}
+	}
+}
+
+void LLCullResult::sortAlphaGroups()
+{
+	const U32 count = mAlphaGroups.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	mGroupKeys.resize(count);
+	for (U32 i = 0; i < count; ++i)
+	{
+		//farthest first
+		mGroupKeys[i].mKey = U32_MAX - ll_float_sort_key(mAlphaGroups[i]->mDepth);
+		mGroupKeys[i].mValue = mAlphaGroups[i];
+	}
+
+	ll_radix_sort(mGroupKeys, mGroupScratch);
+
+	for (U32 i = 0; i < count; ++i)
+	{
+		mAlphaGroups[i] = mGroupKeys[i].mValue;
+	}
+}
+
 
 
@@ -39,6 +39,7 @@
 #include "lldrawable.h"
 #include "lloctree.h"
 #include "llpointer.h"
+#include "llradixsort.h"
 #include "llrefcount.h"
 #include "llvertexbuffer.h"
 #include "llgltypes.h"
@@ -292,6 +293,9 @@ public:
 		ACTIVE_OCCLUSION		= 0x00040000,
 		DISCARD_QUERY			= 0x00080000,
 		EARLY_FAIL				= 0x00100000,
+		HIZ_PENDING				= 0x00200000,	//queued for the world camera's Hi-Z test (LLHiZOcclusion)
+		HIZ_VISIBLE				= 0x00400000,	//Hi-Z test result, read by checkOcclusion()
+		HIZ_OCCLUDED			= 0x00800000,
 	} eOcclusionState;
 
 	typedef enum
@@ -609,9 +613,18 @@ public:
 	void pushBridge(LLSpatialBridge* bridge)			  {  mVisibleBridge.push_back(bridge); }
 	void pushDrawInfo(U32 type, LLDrawInfo* draw_info)	  {  mRenderMap[type].push_back(draw_info); }
 
+	// Orders every render map but PASS_ALPHA by shader, texture, vertex buffer
+	// and then front to back from camera, to save state changes.
+	void sortRenderMaps(const LLCamera& camera);
+	// Back to front, for the alpha pool.
+	void sortAlphaGroups();
+
 	void assertDrawMapsEmpty();
 
 private:
+	typedef std::vector<LLRadixSortEntry<LLDrawInfo*> > drawinfo_sort_t;
+	typedef std::vector<LLRadixSortEntry<LLSpatialGroup*> > sg_sort_t;
+
 	sg_list_t			mVisibleGroups;
 	sg_list_t			mAlphaGroups;
 	sg_list_t			mOcclusionGroups;
@@ -619,6 +632,12 @@ private:
 	drawable_list_t		mVisibleList;
 	bridge_list_t		mVisibleBridge;
 	drawinfo_list_t		mRenderMap[LLRenderPass::NUM_RENDER_TYPES];
+
+	// Kept between frames so that sorting does not allocate
+	drawinfo_sort_t		mDrawInfoKeys;
+	drawinfo_sort_t		mDrawInfoScratch;
+	sg_sort_t			mGroupKeys;
+	sg_sort_t			mGroupScratch;
 };
 
 
@@ -28,6 +28,8 @@
 
 #include "llsurface.h"
 
+#include <boost/bind.hpp>
+
 #include "llrender.h"
 
 #include "llviewertexturelist.h"
@@ -53,12 +55,22 @@
 #include "llglheaders.h"
 #include "lldrawpoolterrain.h"
 #include "lldrawable.h"
+#include "llthreadpool.h"
 
 extern LLPipeline gPipeline;
 extern bool gShiftFrame;
 
 LLColor4U MAX_WATER_COLOR(0, 48, 96, 240);
 
+// Patches per thread pool chunk; a patch takes a few microseconds either way.
+static const S32 DECODE_PATCH_GRAIN = 8;
+static const S32 NORMAL_PATCH_GRAIN = 4;
+// A whole 256m region
+static const size_t MAX_PENDING_PATCHES = 256;
+
+static LLFastTimer::DeclareTimer FTM_TERRAIN_DECODE("Terrain Decode");
+static LLFastTimer::DeclareTimer FTM_TERRAIN_NORMALS("Terrain Normals");
+
 
 S32 LLSurface::sTextureSize = 256;
 S32 LLSurface::sTexelsUpdated = 0;
@@ -836,6 +848,23 @@ BOOL LLSurface::idleUpdate(F32 max_update_time)
 		getRegion()->dirtyHeights();
 	}
 
+	// The middle normals of a patch only depend on its own heights, so those
+	// of all dirty patches are done at once, on the thread pool.
+	mNormalPatches.clear();
+	for (std::set<LLSurfacePatch *>::iterator iter = mDirtyPatchList.begin(); iter != mDirtyPatchList.end(); ++iter)
+	{
+		if ((*iter)->hasInvalidMiddleNormals())
+		{
+			mNormalPatches.push_back(*iter);
+		}
+	}
+	if (!mNormalPatches.empty())
+	{
+		LLFastTimer t(FTM_TERRAIN_NORMALS);
+		LLThreadPool::parallelFor((S32)mNormalPatches.size(), NORMAL_PATCH_GRAIN,
+								  boost::bind(&LLSurface::updateMiddleNormalsRange, this, _1, _2));
+	}
+
 	// Always call updateNormals() / updateVerticalStats()
 	//  every frame to avoid artifacts
 	for(std::set<LLSurfacePatch *>::iterator iter = mDirtyPatchList.begin();
@@ -858,6 +887,14 @@ BOOL LLSurface::idleUpdate(F32 max_update_time)
 	return did_update;
 }
 
+void LLSurface::updateMiddleNormalsRange(S32 begin, S32 end)
+{
+	for (S32 i = begin; i < end; ++i)
+	{
+		mNormalPatches[i]->updateMiddleNormals();
+	}
+}
+
 void LLSurface::decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, BOOL b_large_patch) 
 {
 
@@ -866,9 +903,14 @@ void LLSurface::decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, BOOL
 	S32 patch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
 	LLSurfacePatch *patchp;
 
+	// Builds the tables of this patch size, which the workers then share.
 	init_patch_decompressor(gopp->patch_size);
-	gopp->stride = mGridsPerEdge;
-	set_group_of_patch_header(gopp);
+	const S32 patch_size = llmin((S32)gopp->patch_size, (S32)LARGE_PATCH_SIZE);
+
+	if (mPendingIndex.size() != (size_t)mNumberOfPatches)
+	{
+		mPendingIndex.assign(mNumberOfPatches, -1);
+	}
 
 	while (1)
 	{
@@ -911,11 +953,73 @@ void LLSurface::decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, BOOL
 			return;
 		}
 
-		patchp = &mPatchList[j*mPatchesPerEdge + i];
+		decode_patch(bitpack, patch);
 
+		// A patch that is sent twice before it was transformed only keeps its latest data.
+		const S32 patch_index = j*mPatchesPerEdge + i;
+		S32& pending_index = mPendingIndex[patch_index];
+		if (pending_index < 0 || mPendingPatches[pending_index].mSize != patch_size)
+		{
+			if (pending_index >= 0)
+			{
+				mPendingPatches[pending_index].mPatchp = NULL;
+			}
+			pending_index = (S32)mPendingPatches.size();
+			PendingPatch pending;
+			pending.mPatchp = &mPatchList[patch_index];
+			pending.mSize = patch_size;
+			pending.mOffset = (U32)mPendingCoefficients.size();
+			mPendingPatches.push_back(pending);
+			mPendingCoefficients.resize(mPendingCoefficients.size() + patch_size*patch_size);
+		}
+		PendingPatch& pending = mPendingPatches[pending_index];
+		pending.mHeader = ph;
+		memcpy(&mPendingCoefficients[pending.mOffset], patch, patch_size*patch_size*sizeof(S32));
 
-		decode_patch(bitpack, patch);
-		decompress_patch(patchp->getDataZ(), patch, &ph);
+		// Bounds the memory a flood of patches can take.
+		if (mPendingPatches.size() >= MAX_PENDING_PATCHES)
+		{
+			decodePendingPatches();
+		}
+	}
+}
+
+void LLSurface::decodePatchRange(S32 begin, S32 end)
+{
+	for (S32 i = begin; i < end; ++i)
+	{
+		const PendingPatch& pending = mPendingPatches[i];
+		if (pending.mPatchp)
+		{
+			decompress_patch(pending.mPatchp->getDataZ(), &mPendingCoefficients[pending.mOffset],
+							 &pending.mHeader, pending.mSize, mGridsPerEdge);
+		}
+	}
+}
+
+void LLSurface::decodePendingPatches()
+{
+	if (mPendingPatches.empty())
+	{
+		return;
+	}
+
+	{
+		LLFastTimer t(FTM_TERRAIN_DECODE);
+		LLThreadPool::parallelFor((S32)mPendingPatches.size(), DECODE_PATCH_GRAIN,
+								  boost::bind(&LLSurface::decodePatchRange, this, _1, _2));
+	}
+
+	// Every patch has its heights by now, so the edges copy the new data of
+	// neighbors that arrived in the same batch.
+	for (std::vector<PendingPatch>::iterator iter = mPendingPatches.begin(); iter != mPendingPatches.end(); ++iter)
+	{
+		LLSurfacePatch *patchp = iter->mPatchp;
+		if (!patchp)
+		{
+			continue;
+		}
+		mPendingIndex[patchp - mPatchList] = -1;
 
 		// Update edges for neighbors.  Need to guarantee that this gets done before we generate vertical stats.
 		patchp->updateNorthEdge();
@@ -938,6 +1042,9 @@ void LLSurface::decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, BOOL
 		patchp->dirtyZ();
 		patchp->setHasReceivedData();
 	}
+
+	mPendingPatches.clear();
+	mPendingCoefficients.clear();
 }
 
 
@@ -1314,6 +1421,10 @@ void LLSurface::destroyPatchData()
 	delete [] mPatchList;
 	mPatchList = NULL;
 	mVisiblePatchCount = 0;
+
+	mPendingPatches.clear();
+	mPendingCoefficients.clear();
+	mPendingIndex.clear();
 }
 
 
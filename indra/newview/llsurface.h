@@ -41,6 +41,7 @@
 #include "llvowater.h"
 #include "llpatchvertexarray.h"
 #include "llviewertexture.h"
+#include "patch_dct.h"
 
 class LLTimer;
 class LLUUID;
@@ -88,7 +89,12 @@ public:
 // <FS:CR> Aurora Sim
 	void rebuildWater();
 // </FS:CR> Aurora Sim
+	// Unpacks the patches of a LayerData packet; they land in the height
+	// field on the next decodePendingPatches().
 	virtual void decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, BOOL b_large_patch);
+	// Transforms the unpacked patches on the thread pool, then fixes up
+	// their edges and dirties them.
+	void decodePendingPatches();
 	virtual void updatePatchVisibilities(LLAgent &agent);
 
 	inline F32 getZ(const U32 k) const				{ return mSurfaceZ[k]; }
@@ -193,6 +199,9 @@ protected:
 	
 	LLSurfacePatch *getPatch(const S32 x, const S32 y) const;
 
+	void decodePatchRange(S32 begin, S32 end);
+	void updateMiddleNormalsRange(S32 begin, S32 end);
+
 protected:
 	LLVector3d	mOriginGlobal;		// In absolute frame
 	LLSurfacePatch *mPatchList;		// Array of all patches
@@ -204,6 +213,19 @@ protected:
 	LLVector3 *mNorm;
 
 	std::set<LLSurfacePatch *> mDirtyPatchList;
+	std::vector<LLSurfacePatch *> mNormalPatches;	// Scratch list for idleUpdate()
+
+	// A patch that was unpacked but not transformed yet
+	struct PendingPatch
+	{
+		LLSurfacePatch *mPatchp;
+		LLPatchHeader mHeader;
+		S32 mSize;
+		U32 mOffset;			// Of its coefficients in mPendingCoefficients
+	};
+	std::vector<PendingPatch> mPendingPatches;
+	std::vector<S32> mPendingCoefficients;
+	std::vector<S32> mPendingIndex;	// Per patch, its entry in mPendingPatches or -1
 
 
 	// The textures should never be directly initialized - use the setter methods!
@@ -50,6 +50,7 @@ extern LLPipeline gPipeline;
 LLSurfacePatch::LLSurfacePatch()
 :	mHasReceivedData(FALSE),
 	mSTexUpdate(FALSE),
+	mMiddleNormalsUpdated(FALSE),
 	mDirty(FALSE),
 	mDirtyZStats(TRUE),
 	mHeightsGenerated(FALSE),
@@ -643,16 +644,14 @@ void LLSurfacePatch::updateNormals()
 		dirty_patch = TRUE;
 	}
 
-	// update the middle normals
+	// update the middle normals, unless LLSurface::idleUpdate() already did
 	if (mNormalsInvalid[MIDDLE])
 	{
-		for (j=2; j < grids_per_patch_edge - 2; j++)
-		{
-			for (i=2; i < grids_per_patch_edge - 2; i++)
-			{
-				calcNormal(i, j, 2);
-			}
-		}
+		updateMiddleNormals();
+	}
+	if (mMiddleNormalsUpdated)
+	{
+		mMiddleNormalsUpdated = FALSE;
 		dirty_patch = TRUE;
 	}
 
@@ -667,6 +666,31 @@ void LLSurfacePatch::updateNormals()
 	}
 }
 
+BOOL LLSurfacePatch::hasInvalidMiddleNormals() const
+{
+	return mSurfacep->mType != 'w' && mNormalsInvalid[MIDDLE];
+}
+
+// calcNormal() with a stride of 2 at least two grids away from the patch
+// edges reads no neighbor patch and none of the edge heights that
+// updateNormals() fixes up, and every patch writes its own normals.
+void LLSurfacePatch::updateMiddleNormals()
+{
+	U32 grids_per_patch_edge = mSurfacep->getGridsPerPatchEdge();
+
+	U32 i, j;
+	for (j=2; j < grids_per_patch_edge - 2; j++)
+	{
+		for (i=2; i < grids_per_patch_edge - 2; i++)
+		{
+			calcNormal(i, j, 2);
+		}
+	}
+
+	mNormalsInvalid[MIDDLE] = FALSE;
+	mMiddleNormalsUpdated = TRUE;
+}
+
 void LLSurfacePatch::updateEastEdge()
 {
 	U32 grids_per_patch_edge = mSurfacep->getGridsPerPatchEdge();
@@ -776,6 +800,10 @@ BOOL LLSurfacePatch::updateTexture()
 			{
 				if (mVObjp)
 				{
+					// updateGL() uploads it; the composition blends all patches queued by then at once.
+					F32 tex_patch_size = meters_per_grid*grids_per_patch_edge;
+					comp->queueTexture((F32)origin_region[VX], (F32)origin_region[VY],
+									   tex_patch_size, tex_patch_size);
 					mVObjp->dirtyGeom();
 					gPipeline.markGLRebuild(mVObjp);
 					return TRUE;
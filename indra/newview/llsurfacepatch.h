@@ -84,6 +84,10 @@ public:
 	void updateVerticalStats();
 	void updateCompositionStats();
 	void updateNormals();
+	// The normals that only depend on this patch's own heights; safe to call
+	// for different patches on different threads.
+	void updateMiddleNormals();
+	BOOL hasInvalidMiddleNormals() const;
 
 	void updateEastEdge();
 	void updateNorthEdge();
@@ -151,6 +155,7 @@ public:
 protected:
 	LLSurfacePatch *mNeighborPatches[8]; // Adjacent patches
 	BOOL mNormalsInvalid[9];  // Which normals are invalid
+	BOOL mMiddleNormalsUpdated;	// updateMiddleNormals() ran since the last updateNormals()
 
 	BOOL mDirty;
 	BOOL mDirtyZStats;
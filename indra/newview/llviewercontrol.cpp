@@ -46,6 +46,7 @@
 #include "lldrawpoolterrain.h"
 #include "llflexibleobject.h"
 #include "llfeaturemanager.h"
+#include "llframebudget.h"
 #include "llviewershadermgr.h"
 #include "llpanelgeneral.h"
 #include "llpanelinput.h"
@@ -137,6 +138,7 @@ bool handleStateMachineMaxTimeChanged(const LLSD& newvalue)
 {
 	F32 StateMachineMaxTime = newvalue.asFloat();
 	AIEngine::setMaxCount(StateMachineMaxTime);
+	gFrameBudget.setLimits(LLFrameBudget::STATE_MACHINES, 0.001f, StateMachineMaxTime / 1000.f);
 	return true;
 }
 
@@ -654,6 +656,12 @@ static bool handleAllowLargeSounds(const LLSD& newvalue)
 	return true;
 }
 
+static bool handleUIRetainedDrawChanged(const LLSD& newvalue)
+{
+	LLView::sRetainDraw = newvalue.asBoolean();
+	return true;
+}
+
 void handleHighResChanged(const LLSD& val)
 {
 	if (val) // High Res Snapshot active, must uncheck RenderUIInSnapshot
@@ -690,6 +698,7 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("RenderAvatarCloth")->getSignal()->connect(boost::bind(&handleSetShaderChanged, _2));
 	gSavedSettings.getControl("WindLightUseAtmosShaders")->getSignal()->connect(boost::bind(&handleSetShaderChanged, _2));
 	gSavedSettings.getControl("RenderGammaFull")->getSignal()->connect(boost::bind(&handleSetShaderChanged, _2));
+	gSavedSettings.getControl("RenderUniformBuffers")->getSignal()->connect(boost::bind(&handleSetShaderChanged, _2));
 	gSavedSettings.getControl("RenderAvatarMaxVisible")->getSignal()->connect(boost::bind(&handleAvatarMaxVisibleChanged, _2));
 	gSavedSettings.getControl("RenderAvatarInvisible")->getSignal()->connect(boost::bind(&handleSetSelfInvisible, _2));
 	gSavedSettings.getControl("RenderAvatarComplexityLimit")->getSignal()->connect(boost::bind(&handleRenderAvatarComplexityLimitChanged, _2));
@@ -856,6 +865,7 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("AllowLargeSounds")->getSignal()->connect(boost::bind(&handleAllowLargeSounds, _2));
 	gSavedSettings.getControl("LiruUseZQSDKeys")->getSignal()->connect(boost::bind(load_default_bindings, _2));
 	gSavedSettings.getControl("HighResSnapshot")->getSignal()->connect(boost::bind(&handleHighResChanged, _2));
+	gSavedSettings.getControl("UIRetainedDraw")->getSignal()->connect(boost::bind(&handleUIRetainedDrawChanged, _2));
 }
 
 void onCommitControlSetting_gSavedSettings(LLUICtrl* ctrl, void* name)
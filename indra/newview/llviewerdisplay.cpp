@@ -47,6 +47,7 @@
 #include "lldrawpoolalpha.h"
 #include "llfeaturemanager.h"
 #include "llfirstuse.h"
+#include "llframebudget.h"
 #include "llframestats.h"
 #include "llhudmanager.h"
 #include "llimagebmp.h"
@@ -241,6 +242,14 @@ void display_stats()
 		LL_INFOS() << llformat("MEMORY: %d MB", memory) << LL_ENDL;
 		LL_INFOS() << "THREADS: "<< LLThread::getCount() << LL_ENDL;
 		LL_INFOS() << "MALLOC: " << SGMemStat::getPrintableStat() <<LL_ENDL;
+		if (SGMemStat::havePoolStat())
+		{
+			const std::vector<std::string> pool_stats = SGMemStat::getPrintablePoolStats();
+			for (std::vector<std::string>::const_iterator it = pool_stats.begin(); it != pool_stats.end(); ++it)
+			{
+				LL_INFOS() << "POOL: " << *it << LL_ENDL;
+			}
+		}
 		LLMemory::logMemoryInfo(TRUE) ;
 		gRecentMemoryTime.reset();
 	}
@@ -674,10 +683,12 @@ void display(BOOL rebuild, F32 zoom_factor, int subfield, BOOL for_snapshot, boo
 		if(!tiling)
 		{
 			gFrameStats.start(LLFrameStats::UPDATE_GEOM);
-			const F32 max_geom_update_time = 0.005f*10.f*gFrameIntervalSeconds; // 50 ms/second update time
+			LLTimer geom_timer;
+			const F32 max_geom_update_time = gFrameBudget.getSlice(LLFrameBudget::GEOMETRY);
 			gPipeline.createObjects(max_geom_update_time);
 			gPipeline.processPartitionQ();
-			gPipeline.updateGeom(max_geom_update_time);
+			gPipeline.updateGeom(llmax(max_geom_update_time - geom_timer.getElapsedTimeF32(), 0.f));
+			gFrameBudget.report(LLFrameBudget::GEOMETRY, geom_timer.getElapsedTimeF32(), gPipeline.hasDeferredGeom());
 			stop_glerror();
 			gPipeline.updateGL();
 			stop_glerror();
@@ -835,9 +846,11 @@ void display(BOOL rebuild, F32 zoom_factor, int subfield, BOOL for_snapshot, boo
 
 			{
 				LLFastTimer t(FTM_IMAGE_UPDATE_LIST);
-				F32 max_image_decode_time = 0.050f*gFrameIntervalSeconds; // 50 ms/second decode time
-				max_image_decode_time = llclamp(max_image_decode_time, 0.002f, 0.005f ); // min 2ms/frame, max 5ms/frame)
+				LLTimer image_timer;
+				F32 max_image_decode_time = gFrameBudget.getSlice(LLFrameBudget::IMAGES);
 				gTextureList.updateImages(max_image_decode_time);
+				F32 image_time = image_timer.getElapsedTimeF32();
+				gFrameBudget.report(LLFrameBudget::IMAGES, image_time, image_time >= max_image_decode_time);
 			}
 
 			/*{
@@ -1093,6 +1106,10 @@ void display(BOOL rebuild, F32 zoom_factor, int subfield, BOOL for_snapshot, boo
 															  GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 				}
 			}
+
+			//keep this frame's depth for next frame's occlusion tests
+			gPipeline.mHiZOcclusion.capture(LLPipeline::sRenderDeferred ? gPipeline.mDeferredScreen : gPipeline.mScreen,
+											gGLLastModelView, gGLLastProjection);
 		}
 		//gGL.flush();
 
@@ -39,6 +39,7 @@
 #include "llinventorypanel.h"
 #include "llnotifications.h"
 #include "llnotificationsutil.h"
+#include "llfasttimertrace.h"
 #include "llfeaturemanager.h"
 #include "llsecondlifeurls.h"
 // <edit>
@@ -244,6 +245,9 @@ BOOL enable_save_as(void *);
 // Edit menu
 void handle_dump_group_info(void *);
 void handle_dump_capabilities_info(void *);
+void handle_toggle_fast_timer_trace(void*);
+void handle_benchmark_ui_draw(void*);
+BOOL check_fast_timer_trace(void*);
 void handle_dump_focus(void*);
 
 // Advanced->Consoles menu
@@ -808,6 +812,14 @@ void init_client_menu(LLMenuGL* menu)
 										&get_visibility,
 										(void*)gDebugView->mFastTimerView,
 										  '9', MASK_CONTROL|MASK_SHIFT ) );
+		sub->addChild(new LLMenuItemCheckGL("Record Thread Trace",
+										&handle_toggle_fast_timer_trace,
+										NULL,
+										&check_fast_timer_trace,
+										NULL));
+		sub->addChild(new LLMenuItemCallGL("Benchmark UI Draw",
+										&handle_benchmark_ui_draw,
+										NULL));
 		
 		sub->addSeparator();
 		
@@ -3499,6 +3511,31 @@ void handle_dump_capabilities_info(void *)
 	}
 }
 
+// Starts a fast timer trace, or stops it and writes it to the log directory
+// for chrome://tracing or the Perfetto UI.
+void handle_toggle_fast_timer_trace(void*)
+{
+	if (LLFastTimerTrace::isRunning())
+	{
+		LLFastTimerTrace::stop();
+		LLFastTimerTrace::write(gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "fast_timer_trace.json"));
+	}
+	else
+	{
+		LLFastTimerTrace::start();
+	}
+}
+
+BOOL check_fast_timer_trace(void*)
+{
+	return LLFastTimerTrace::isRunning();
+}
+
+void handle_benchmark_ui_draw(void*)
+{
+	gViewerWindow->benchmarkUIDraw(100);
+}
+
 void handle_dump_region_object_cache(void*)
 {
 	LLViewerRegion* regionp = gAgent.getRegion();
@@ -28,6 +28,8 @@
 
 #include "llviewerobject.h"
 
+#include <boost/bind.hpp>
+
 #include "llaudioengine.h"
 #include "imageids.h"
 #include "indra_constants.h"
@@ -47,6 +49,7 @@
 #include "llquantize.h"
 #include "llregionhandle.h"
 #include "llsdserialize.h"
+#include "llthreadpool.h"
 #include "lltree_common.h"
 #include "llxfermanager.h"
 #include "message.h"
@@ -2241,113 +2244,282 @@ void LLViewerObject::interpolateLinearMotion(const F64 & time, const F32 & dt)
 		LLVector3 new_v = accel * dt;
 
 		if (time_since_last_update > sPhaseOutUpdateInterpolationTime &&
-			sPhaseOutUpdateInterpolationTime > 0.0)
-		{	// Haven't seen a viewer update in a while, check to see if the ciruit is still active
-			if (mRegionp)
-			{	// The simulator will NOT send updates if the object continues normally on the path
-				// predicted by the velocity and the acceleration (often gravity) sent to the viewer
-				// So check to see if the circuit is blocked, which means the sim is likely in a long lag
-				LLCircuitData *cdp = gMessageSystem->mCircuitInfo.findCircuit( mRegionp->getHost() );
-				if (cdp)
-				{
-					// Find out how many seconds since last packet arrived on the circuit
-					F64 time_since_last_packet = LLMessageSystem::getMessageTimeSeconds() - cdp->getLastPacketInTime();
+			sPhaseOutUpdateInterpolationTime > 0.0 &&
+			isCircuitStalled())
+		{	// Start to reduce motion interpolation since we haven't seen a server update in a while
+			F64 phase_out = getMotionPhaseOut(time_since_last_update, time - mLastInterpUpdateSecs,
+											  mLastInterpUpdateSecs - mLastMessageUpdateSecs);
+			new_pos = new_pos * ((F32) phase_out);
+			new_v = new_v * ((F32) phase_out);
+		}
 
-					if (!cdp->isAlive() ||		// Circuit is dead or blocked
-						 cdp->isBlocked() ||	// or doesn't seem to be getting any packets
-						 (time_since_last_packet > sPhaseOutUpdateInterpolationTime))
-					{
-						// Start to reduce motion interpolation since we haven't seen a server update in a while
-						F64 time_since_last_interpolation = time - mLastInterpUpdateSecs;
-						F64 phase_out = 1.0;
-						if (time_since_last_update > sMaxUpdateInterpolationTime)
-						{	// Past the time limit, so stop the object
-							phase_out = 0.0;
-							//LL_INFOS() << "Motion phase out to zero" << LL_ENDL;
-
-							// Kill angular motion as well.  Note - not adding this due to paranoia
-							// about stopping rotation for llTargetOmega objects and not having it restart
-							// setAngularVelocity(LLVector3::zero);
-						}
-						else if (mLastInterpUpdateSecs - mLastMessageUpdateSecs > sPhaseOutUpdateInterpolationTime)
-						{	// Last update was already phased out a bit
-							phase_out = (sMaxUpdateInterpolationTime - time_since_last_update) / 
-										(sMaxUpdateInterpolationTime - time_since_last_interpolation);
-							//LL_INFOS() << "Continuing motion phase out of " << (F32) phase_out << LL_ENDL;
-						}
-						else
-						{	// Phase out from full value
-							phase_out = (sMaxUpdateInterpolationTime - time_since_last_update) / 
-										(sMaxUpdateInterpolationTime - sPhaseOutUpdateInterpolationTime);
-							//LL_INFOS() << "Starting motion phase out of " << (F32) phase_out << LL_ENDL;
-						}
-						phase_out = llclamp(phase_out, 0.0, 1.0);
+		applyLinearMotion(new_pos + getPositionRegion(), new_v + vel);
+	}		
 
-						new_pos = new_pos * ((F32) phase_out);
-						new_v = new_v * ((F32) phase_out);
-					}
-				}
-			}
+	// Update the last time we did anything
+	mLastInterpUpdateSecs = time;
+}
+
+bool LLViewerObject::isCircuitStalled() const
+{
+	if (!mRegionp)
+	{
+		return false;
+	}
+
+	// The simulator will NOT send updates if the object continues normally on the path
+	// predicted by the velocity and the acceleration (often gravity) sent to the viewer
+	// So check to see if the circuit is blocked, which means the sim is likely in a long lag
+	LLCircuitData *cdp = gMessageSystem->mCircuitInfo.findCircuit( mRegionp->getHost() );
+	if (!cdp)
+	{
+		return false;
+	}
+
+	// Find out how many seconds since last packet arrived on the circuit
+	F64 time_since_last_packet = LLMessageSystem::getMessageTimeSeconds() - cdp->getLastPacketInTime();
+
+	return !cdp->isAlive() ||		// Circuit is dead or blocked
+		   cdp->isBlocked() ||		// or doesn't seem to be getting any packets
+		   (time_since_last_packet > sPhaseOutUpdateInterpolationTime);
+}
+
+//static
+F64 LLViewerObject::getMotionPhaseOut(F64 time_since_last_update, F64 time_since_last_interpolation, F64 interpolated_since_update)
+{
+	F64 phase_out = 1.0;
+	if (time_since_last_update > sMaxUpdateInterpolationTime)
+	{	// Past the time limit, so stop the object
+		phase_out = 0.0;
+		//LL_INFOS() << "Motion phase out to zero" << LL_ENDL;
+
+		// Kill angular motion as well.  Note - not adding this due to paranoia
+		// about stopping rotation for llTargetOmega objects and not having it restart
+		// setAngularVelocity(LLVector3::zero);
+	}
+	else if (interpolated_since_update > sPhaseOutUpdateInterpolationTime)
+	{	// Last update was already phased out a bit
+		phase_out = (sMaxUpdateInterpolationTime - time_since_last_update) / 
+					(sMaxUpdateInterpolationTime - time_since_last_interpolation);
+		//LL_INFOS() << "Continuing motion phase out of " << (F32) phase_out << LL_ENDL;
+	}
+	else
+	{	// Phase out from full value
+		phase_out = (sMaxUpdateInterpolationTime - time_since_last_update) / 
+					(sMaxUpdateInterpolationTime - sPhaseOutUpdateInterpolationTime);
+		//LL_INFOS() << "Starting motion phase out of " << (F32) phase_out << LL_ENDL;
+	}
+	return llclamp(phase_out, 0.0, 1.0);
+}
+
+void LLViewerObject::applyLinearMotion(LLVector3 new_pos, const LLVector3& new_v_in)
+{
+	LLVector3 new_v = new_v_in;
+
+	// Clamp interpolated position to minimum underground and maximum region height
+	LLVector3d new_pos_global = mRegionp->getPosGlobalFromRegion(new_pos);
+	F32 min_height;
+	if (isAvatar())
+	{	// Make a better guess about AVs not going underground
+		min_height = LLWorld::getInstance()->resolveLandHeightGlobal(new_pos_global);
+		min_height += (0.5f * getScale().mV[VZ]);
+	}
+	else
+	{	// This will put the object underground, but we can't tell if it will stop 
+		// at ground level or not
+		min_height = LLWorld::getInstance()->getMinAllowedZ(this, new_pos_global);
+	}
+
+	new_pos.mV[VZ] = llmax(min_height, new_pos.mV[VZ]);
+	//Removing check to allow high altitude flight games -SG
+	//new_pos.mV[VZ] = llmin(LLWorld::getInstance()->getRegionMaxHeight(), new_pos.mV[VZ]);
+
+	// Check to see if it's going off the region
+	LLVector3 temp(new_pos);
+	if (temp.clamp(0.f, mRegionp->getWidth()))
+	{	// Going off this region, so see if we might end up on another region
+		LLVector3d old_pos_global = mRegionp->getPosGlobalFromRegion(getPositionRegion());
+		new_pos_global = mRegionp->getPosGlobalFromRegion(new_pos);		// Re-fetch in case it got clipped above
+
+		// Clip the positions to known regions
+		LLVector3d clip_pos_global = LLWorld::getInstance()->clipToVisibleRegions(old_pos_global, new_pos_global);
+		if (clip_pos_global != new_pos_global)
+		{	// Was clipped, so this means we hit a edge where there is no region to enter
+			
+			//LL_INFOS() << "Hit empty region edge, clipped predicted position to " << mRegionp->getPosRegionFromGlobal(clip_pos_global)
+			//	<< " from " << new_pos << LL_ENDL;
+			new_pos = mRegionp->getPosRegionFromGlobal(clip_pos_global);
+			
+			// Stop motion and get server update for bouncing on the edge
+			new_v.clear();
+			setAcceleration(LLVector3::zero);
+		}
+		else
+		{	// Let predicted movement cross into another region
+			//LL_INFOS() << "Predicting region crossing to " << new_pos << LL_ENDL;
+		}
+	}
+
+	// Set new position and velocity
+	setPositionRegion(new_pos);
+	setVelocity(new_v);	
+	
+	// for objects that are spinning but not translating, make sure to flag them as having moved
+	setChanged(MOVED | SILHOUETTE);
+}
+
+bool LLIdleMotionBatch::add(LLViewerObject* objectp, F64 time)
+{
+	// Subclasses with an idleUpdate() of their own do more than dead reckoning.
+	if (objectp->getPCode() != LL_PCODE_VOLUME ||
+		objectp->mDead || objectp->mStatic || !LLViewerObject::sVelocityInterpolate || objectp->isSelected())
+	{
+		return false;
+	}
+
+	// calculate dt from last update
+	F32 dt = objectp->mTimeDilation * (F32)(time - objectp->mLastInterpUpdateSecs);
+	const F64 since_update = time - objectp->mLastMessageUpdateSecs;
+	const LLVector3& accel = objectp->getAcceleration();
+	const LLVector3& vel = objectp->getVelocity();
+
+	U8 flags = 0;
+	if (objectp->isAttachment())
+	{
+		flags |= ATTACHMENT;
+	}
+	else if (since_update > 0.0 && dt > 0.f)
+	{
+		flags |= LINEAR;
+		if (LLViewerObject::sMaxUpdateInterpolationTime <= 0.0)
+		{
+			flags |= UNBOUNDED;
+		}
+		// Most objects don't move; only ask about the circuit for those that do.
+		else if ((!accel.isExactlyZero() || !vel.isExactlyZero()) &&
+				 since_update > LLViewerObject::sPhaseOutUpdateInterpolationTime &&
+				 LLViewerObject::sPhaseOutUpdateInterpolationTime > 0.0 &&
+				 objectp->isCircuitStalled())
+		{
+			flags |= PHASE_OUT;
+		}
+	}
+
+	mObjects.push_back(objectp);
+	mFlags.push_back(flags);
+	mDT.push_back(dt);
+	mAngularVelocity.push_back(objectp->getAngularVelocity());
+	mRotation.push_back(LLQuaternion::DEFAULT);
+	mAcceleration.push_back(accel);
+	mVelocity.push_back(vel);
+	mOffset.push_back(LLVector3::zero);
+	mSinceUpdate.push_back(since_update);
+	mSinceInterpolation.push_back(time - objectp->mLastInterpUpdateSecs);
+	mInterpolatedSinceUpdate.push_back(objectp->mLastInterpUpdateSecs - objectp->mLastMessageUpdateSecs);
+	return true;
+}
+
+void LLIdleMotionBatch::predict(S32 begin, S32 end)
+{
+	for (S32 i = begin; i < end; ++i)
+	{
+		U8& flags = mFlags[i];
+		const F32 dt = mDT[i];
+
+		if (LLViewerObject::predictAngularMotion(mAngularVelocity[i], dt, mRotation[i]))
+		{
+			flags |= ROTATE;
 		}
 
-		new_pos = new_pos + getPositionRegion();
-		new_v = new_v + vel;
+		const LLVector3& accel = mAcceleration[i];
+		LLVector3& vel = mVelocity[i];
+		if (!(flags & LINEAR) || (accel.isExactlyZero() && vel.isExactlyZero()))
+		{
+			continue;
+		}
+
+		// Same arithmetic as LLViewerObject::interpolateLinearMotion(), so that both paths agree to the bit.
+		LLVector3 new_pos = (vel + (0.5f * (dt-PHYSICS_TIMESTEP)) * accel) * dt;
+		LLVector3 new_v = accel * dt;
+		if (flags & PHASE_OUT)
+		{
+			F64 phase_out = LLViewerObject::getMotionPhaseOut(mSinceUpdate[i], mSinceInterpolation[i], mInterpolatedSinceUpdate[i]);
+			new_pos = new_pos * ((F32) phase_out);
+			new_v = new_v * ((F32) phase_out);
+		}
+		mOffset[i] = new_pos;
+		vel = new_v + vel;
+		flags |= MOVE;
+	}
+}
+
+void LLIdleMotionBatch::apply(S32 i, F64 time)
+{
+	LLViewerObject* objectp = mObjects[i];
+	const U8 flags = mFlags[i];
+	if (objectp->mDead)
+	{	// Killed by another object's idleUpdate() since add()
+		return;
+	}
+
+	objectp->mRotTime += mDT[i];
+	if (flags & ROTATE)
+	{
+		objectp->applyAngularMotion(mRotation[i]);
+	}
 
+	if (flags & ATTACHMENT)
+	{
+		objectp->mLastInterpUpdateSecs = time;
+		return;
+	}
 
-		// Clamp interpolated position to minimum underground and maximum region height
-		LLVector3d new_pos_global = mRegionp->getPosGlobalFromRegion(new_pos);
-		F32 min_height;
-		if (isAvatar())
-		{	// Make a better guess about AVs not going underground
-			min_height = LLWorld::getInstance()->resolveLandHeightGlobal(new_pos_global);
-			min_height += (0.5f * getScale().mV[VZ]);
+	if (flags & MOVE)
+	{
+		// The region position is read here rather than in add(): a child's depends on its parent,
+		// which may have moved earlier in this frame.
+		if (flags & UNBOUNDED)
+		{
+			objectp->setPositionRegion(mOffset[i] + objectp->getPositionRegion());
+			objectp->setVelocity(mVelocity[i]);
+			objectp->setChanged(LLXform::MOVED | LLXform::SILHOUETTE);
 		}
 		else
-		{	// This will put the object underground, but we can't tell if it will stop 
-			// at ground level or not
-			min_height = LLWorld::getInstance()->getMinAllowedZ(this, new_pos_global);
-		}
-
-		new_pos.mV[VZ] = llmax(min_height, new_pos.mV[VZ]);
-		//Removing check to allow high altitude flight games -SG
-		//new_pos.mV[VZ] = llmin(LLWorld::getInstance()->getRegionMaxHeight(), new_pos.mV[VZ]);
-
-		// Check to see if it's going off the region
-		LLVector3 temp(new_pos);
-		if (temp.clamp(0.f, mRegionp->getWidth()))
-		{	// Going off this region, so see if we might end up on another region
-			LLVector3d old_pos_global = mRegionp->getPosGlobalFromRegion(getPositionRegion());
-			new_pos_global = mRegionp->getPosGlobalFromRegion(new_pos);		// Re-fetch in case it got clipped above
-
-			// Clip the positions to known regions
-			LLVector3d clip_pos_global = LLWorld::getInstance()->clipToVisibleRegions(old_pos_global, new_pos_global);
-			if (clip_pos_global != new_pos_global)
-			{	// Was clipped, so this means we hit a edge where there is no region to enter
-				
-				//LL_INFOS() << "Hit empty region edge, clipped predicted position to " << mRegionp->getPosRegionFromGlobal(clip_pos_global)
-				//	<< " from " << new_pos << LL_ENDL;
-				new_pos = mRegionp->getPosRegionFromGlobal(clip_pos_global);
-				
-				// Stop motion and get server update for bouncing on the edge
-				new_v.clear();
-				setAcceleration(LLVector3::zero);
-			}
-			else
-			{	// Let predicted movement cross into another region
-				//LL_INFOS() << "Predicting region crossing to " << new_pos << LL_ENDL;
-			}
+		{
+			objectp->applyLinearMotion(mOffset[i] + objectp->getPositionRegion(), mVelocity[i]);
 		}
+	}
+	if (flags & LINEAR)
+	{
+		objectp->mLastInterpUpdateSecs = time;
+	}
 
-		// Set new position and velocity
-		setPositionRegion(new_pos);
-		setVelocity(new_v);	
-		
-		// for objects that are spinning but not translating, make sure to flag them as having moved
-		setChanged(MOVED | SILHOUETTE);
-	}		
+	objectp->updateDrawable(FALSE);
+}
 
-	// Update the last time we did anything
-	mLastInterpUpdateSecs = time;
+static LLFastTimer::DeclareTimer FTM_IDLE_MOTION_PREDICT("Idle Motion Predict");
+
+void LLIdleMotionBatch::predict()
+{
+	// Objects to hand a worker at a time; predicting one is a few dozen flops.
+	const S32 MOTION_GRAIN = 256;
+	LLFastTimer t(FTM_IDLE_MOTION_PREDICT);
+	LLThreadPool::parallelFor(size(), MOTION_GRAIN, boost::bind(&LLIdleMotionBatch::predict, this, _1, _2));
+}
+
+void LLIdleMotionBatch::clear()
+{
+	mObjects.clear();
+	mFlags.clear();
+	mDT.clear();
+	mAngularVelocity.clear();
+	mRotation.clear();
+	mAcceleration.clear();
+	mVelocity.clear();
+	mOffset.clear();
+	mSinceUpdate.clear();
+	mSinceInterpolation.clear();
+	mInterpolatedSinceUpdate.clear();
 }
 
 
@@ -5652,10 +5824,19 @@ void LLViewerObject::applyAngularVelocity(F32 dt)
 {
 	//do target omega here
 	mRotTime += dt;
-	LLVector3 ang_vel = getAngularVelocity();
+	LLQuaternion dQ;
+	if (predictAngularMotion(getAngularVelocity(), dt, dQ))
+	{
+		applyAngularMotion(dQ);
+	}
+}
+
+//static
+bool LLViewerObject::predictAngularMotion(const LLVector3& ang_vel_in, F32 dt, LLQuaternion& dQ)
+{
+	LLVector3 ang_vel = ang_vel_in;
 	F32 omega = ang_vel.magVecSquared();
 	F32 angle = 0.0f;
-	LLQuaternion dQ;
 	if (omega > 0.00001f)
 	{
 		omega = sqrt(omega);
@@ -5665,18 +5846,23 @@ void LLViewerObject::applyAngularVelocity(F32 dt)
 		
 		// calculate the delta increment based on the object's angular velocity
 		dQ.setQuat(angle, ang_vel);
+		return true;
+	}
+	return false;
+}
 
-		static const LLCachedControl<bool> use_new_target_omega ("UseNewTargetOmegaCode", true);
-		if (use_new_target_omega)
-		{
-			// accumulate the angular velocity rotations to re-apply in the case of an object update
-			mAngularVelocityRot *= dQ;
-		}
-		
-		// Just apply the delta increment to the current rotation
-		setRotation(getRotation()*dQ);
-		setChanged(MOVED | SILHOUETTE);
+void LLViewerObject::applyAngularMotion(const LLQuaternion& dQ)
+{
+	static const LLCachedControl<bool> use_new_target_omega ("UseNewTargetOmegaCode", true);
+	if (use_new_target_omega)
+	{
+		// accumulate the angular velocity rotations to re-apply in the case of an object update
+		mAngularVelocityRot *= dQ;
 	}
+	
+	// Just apply the delta increment to the current rotation
+	setRotation(getRotation()*dQ);
+	setChanged(MOVED | SILHOUETTE);
 }
 
 void LLViewerObject::resetRot()
@@ -568,6 +568,7 @@ public:
 	
 	friend class LLViewerObjectList;
 	friend class LLViewerMediaList;
+	friend class LLIdleMotionBatch;
 
 public:
 	//counter-translation
@@ -591,6 +592,15 @@ private:
 	
 	// Motion prediction between updates
 	void interpolateLinearMotion(const F64 & time, const F32 & dt);
+	// The rotation dt of spinning at ang_vel adds; false if there is none. Any thread.
+	static bool predictAngularMotion(const LLVector3& ang_vel, F32 dt, LLQuaternion& dQ);
+	void applyAngularMotion(const LLQuaternion& dQ);
+	// How much of the predicted motion to keep while the simulator seems to have stopped sending updates. Any thread.
+	static F64 getMotionPhaseOut(F64 time_since_last_update, F64 time_since_last_interpolation, F64 interpolated_since_update);
+	// Whether our region's circuit looks too lagged to have sent us an update.
+	bool isCircuitStalled() const;
+	// Sets a predicted position and velocity, kept above ground and out of regions we don't know.
+	void applyLinearMotion(LLVector3 new_pos, const LLVector3& new_v);
 
 public:
 	//
@@ -849,6 +859,51 @@ inline void LLViewerObject::setRotation(const F32 x, const F32 y, const F32 z, B
 	updateDrawable(damped);
 }
 
+// Dead reckoning for many objects at once, for LLViewerObjectList::update().
+// add() copies the motion state of each object whose idleUpdate() is
+// LLViewerObject's into arrays; predict() works out new rotations, positions
+// and velocities from the arrays alone on the thread pool. apply() hands the
+// results back to one object on the main thread, where the ground and region
+// clamps and the drawable updates happen, so that the caller can keep the
+// objects in the order of their idle updates.
+class LLIdleMotionBatch
+{
+public:
+	// Main thread. False if objectp needs its own idleUpdate() instead.
+	bool add(LLViewerObject* objectp, F64 time);
+	void predict();
+	// Main thread, after predict(). What idleUpdate() would have done to getObject(i).
+	void apply(S32 i, F64 time);
+	void clear();
+	S32 size() const { return (S32)mObjects.size(); }
+	LLViewerObject* getObject(S32 i) const { return mObjects[i]; }
+
+private:
+	void predict(S32 begin, S32 end);
+
+	enum
+	{
+		ROTATE		= 0x01,		// mRotation holds the rotation to apply
+		ATTACHMENT	= 0x02,		// Only spins
+		LINEAR		= 0x04,		// Has an update to interpolate from
+		MOVE		= 0x08,		// mOffset and mVelocity hold the motion to apply
+		PHASE_OUT	= 0x10,		// The circuit is stalled; slow down
+		UNBOUNDED	= 0x20		// InterpolationTime is off: no phase out, no clamps
+	};
+
+	std::vector<LLViewerObject*> mObjects;
+	std::vector<U8> mFlags;
+	std::vector<F32> mDT;
+	std::vector<LLVector3> mAngularVelocity;
+	std::vector<LLQuaternion> mRotation;		// Out: rotation increment
+	std::vector<LLVector3> mAcceleration;
+	std::vector<LLVector3> mVelocity;			// In/out
+	std::vector<LLVector3> mOffset;				// Out: position increment
+	std::vector<F64> mSinceUpdate;				// time - mLastMessageUpdateSecs
+	std::vector<F64> mSinceInterpolation;		// time - mLastInterpUpdateSecs
+	std::vector<F64> mInterpolatedSinceUpdate;	// mLastInterpUpdateSecs - mLastMessageUpdateSecs
+};
+
 class LLViewerObjectMedia
 {
 public:
@@ -1011,13 +1011,33 @@ void LLViewerObjectList::update(LLAgent &agent, LLWorld &world)
 	}
 	else
 	{
+		// Objects that only dead reckon are predicted together, on the thread pool
+		static LLIdleMotionBatch motion_batch;
+		motion_batch.clear();
+
 		for (std::vector<LLViewerObject*>::iterator idle_iter = idle_list.begin();
 			idle_iter != idle_end; idle_iter++)
 		{
-			objectp = *idle_iter;
-			llassert(objectp->isActive());
-			objectp->idleUpdate(agent, world, frame_time);
+			llassert((*idle_iter)->isActive());
+			motion_batch.add(*idle_iter, frame_time);
+		}
+		motion_batch.predict();
 
+		// Then every object is updated in the same order as before, whether
+		// its motion was predicted or it has an idleUpdate() of its own.
+		S32 batch_index = 0;
+		for (std::vector<LLViewerObject*>::iterator idle_iter = idle_list.begin();
+			idle_iter != idle_end; idle_iter++)
+		{
+			objectp = *idle_iter;
+			if (batch_index < motion_batch.size() && motion_batch.getObject(batch_index) == objectp)
+			{
+				motion_batch.apply(batch_index++, frame_time);
+			}
+			else
+			{
+				objectp->idleUpdate(agent, world, frame_time);
+			}
 		}
 
 		//update flexible objects
@@ -51,13 +51,13 @@
 #include "lfsimfeaturehandler.h"
 #include "llagent.h"
 #include "llagentcamera.h"
+#include "llavatarpositiontracker.h"
 #include "llcallingcard.h"
 #include "llcaphttpsender.h"
 #include "llcapabilitylistener.h"
 #include "llcommandhandler.h"
 #include "lldir.h"
 #include "lleventpoll.h"
-#include "llfloateravatarlist.h"
 #include "llfloatergodtools.h"
 #include "llfloaterperms.h"
 #include "llfloaterreporter.h"
@@ -1238,6 +1238,7 @@ public:
 				agents_it++;
 			}
 		}
+		LLAvatarPositionTracker::instance().updateRegion(region);
 	}
 };
 
@@ -1251,7 +1252,6 @@ LLHTTPRegistration<CoarseLocationUpdate>
 void LLViewerRegion::updateCoarseLocations(LLMessageSystem* msg)
 {
 	//LL_INFOS() << "CoarseLocationUpdate" << LL_ENDL;
-	std::list<LLUUID> map_avids(mMapAvatarIDs.begin(), mMapAvatarIDs.end());
 	mMapAvatars.reset();
 	mMapAvatarIDs.reset(); // only matters in a rare case but it's good to be safe.
 
@@ -1306,16 +1306,10 @@ void LLViewerRegion::updateCoarseLocations(LLMessageSystem* msg)
 			if(has_agent_data)
 			{
 				mMapAvatarIDs.put(agent_id);
-				map_avids.remove(agent_id);
 			}
 		}
 	}
-	if (LLFloaterAvatarList::instanceExists())
-	{
-		LLFloaterAvatarList& inst(LLFloaterAvatarList::instance());
-		inst.updateAvatarList(this);
-		inst.expireAvatarList(map_avids);
-	}
+	LLAvatarPositionTracker::instance().updateRegion(this);
 }
 
 void LLViewerRegion::getInfo(LLSD& info)
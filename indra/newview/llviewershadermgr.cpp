@@ -46,6 +46,7 @@
 #include "llsky.h"
 #include "llvosky.h"
 #include "llrender.h"
+#include "lltimer.h"
 
 #if LL_DARWIN
 #include "OpenGL/OpenGL.h"
@@ -64,6 +65,40 @@ static LLStaticHashedString sTex1("tex1");
 static LLStaticHashedString sGlowMap("glowMap");
 static LLStaticHashedString sScreenMap("screenMap");
 
+// Adds the time spent and the programs built in its scope to a shader class's line
+// of the load report. Classes that load twice add up.
+class LLShaderLoadTimer
+{
+public:
+	LLShaderLoadTimer(LLViewerShaderMgr::load_times_t& times, const char* name)
+	:	mTimes(times),
+		mName(name),
+		mPrograms(LLViewerShaderMgr::instance()->getProgramCount())
+	{
+	}
+
+	~LLShaderLoadTimer()
+	{
+		LLViewerShaderMgr::load_times_t::iterator it = mTimes.begin();
+		while (it != mTimes.end() && it->mName != mName)
+		{
+			++it;
+		}
+		if (it == mTimes.end())
+		{
+			it = mTimes.insert(it, LLViewerShaderMgr::LoadTime(mName));
+		}
+		it->mSeconds += mTimer.getElapsedTimeF64();
+		it->mPrograms += LLViewerShaderMgr::instance()->getProgramCount() - mPrograms;
+	}
+
+private:
+	LLViewerShaderMgr::load_times_t& mTimes;
+	const char* mName;
+	U32 mPrograms;
+	LLTimer mTimer;
+};
+
 // Lots of STL stuff in here, using namespace std to keep things more readable
 using std::vector;
 using std::pair;
@@ -99,6 +134,7 @@ LLGLSLShader	gDebugProgram(LLViewerShaderMgr::SHADER_INTERFACE);
 LLGLSLShader	gClipProgram(LLViewerShaderMgr::SHADER_INTERFACE);
 LLGLSLShader	gDownsampleDepthProgram(LLViewerShaderMgr::SHADER_INTERFACE);
 LLGLSLShader	gDownsampleDepthRectProgram(LLViewerShaderMgr::SHADER_INTERFACE);
+LLGLSLShader	gHiZDownsampleProgram(LLViewerShaderMgr::SHADER_INTERFACE);
 LLGLSLShader	gAlphaMaskProgram(LLViewerShaderMgr::SHADER_INTERFACE);
 
 LLGLSLShader	gUIProgram(LLViewerShaderMgr::SHADER_INTERFACE);
@@ -205,8 +241,21 @@ LLGLSLShaderArray<LLViewerShaderMgr::SHADER_DEFERRED>	gDeferredMaterialProgram[L
 LLGLSLShaderArray<LLViewerShaderMgr::SHADER_DEFERRED>	gDeferredMaterialWaterProgram[LLMaterial::SHADER_COUNT*2];
 
 LLViewerShaderMgr::LLViewerShaderMgr() :
-	mVertexShaderLevel(SHADER_COUNT, 0)
-{}
+	mVertexShaderLevel(SHADER_COUNT, 0),
+	mWindLightSkyBuffer("WindLightSky", "WINDLIGHT_SKY_BLOCK", 0)
+{
+	// The windlight sky values that are the same in every shader, see LLWLParamSet::updateBuffer()
+	mWindLightSkyBuffer.addVec4("sunlight_color");
+	mWindLightSkyBuffer.addVec4("ambient");
+	mWindLightSkyBuffer.addVec4("blue_horizon");
+	mWindLightSkyBuffer.addVec4("blue_density");
+	mWindLightSkyBuffer.addVec4("glow");
+	mWindLightSkyBuffer.addFloat("haze_horizon");
+	mWindLightSkyBuffer.addFloat("haze_density");
+	mWindLightSkyBuffer.addFloat("cloud_shadow");
+	mWindLightSkyBuffer.addFloat("density_multiplier");
+	mWindLightSkyBuffer.addFloat("max_y");
+}
 
 LLViewerShaderMgr::~LLViewerShaderMgr()
 {
@@ -257,6 +306,8 @@ void LLViewerShaderMgr::setShaders()
 	//Since setShaders can be reentrant, be sure to clear out stale shader objects that may be left over from parent call.
 	unloadShaderObjects();
 	unloadShaders();
+	resetProgramCacheStats();
+	mLoadTimes.clear();
 
 	LLGLSLShader::sIndexedTextureChannels = llmax(llmin(gGLManager.mNumTextureImageUnits, (S32) gSavedSettings.getU32("RenderMaxTextureIndex")), 1);
 	static const LLCachedControl<bool> no_texture_indexing("ShyotlUseLegacyTextureBatching",false);
@@ -285,6 +336,14 @@ void LLViewerShaderMgr::setShaders()
 	initAttribsAndUniforms();
 	gPipeline.releaseGLBuffers();
 
+	// Shaders declare the windlight sky values as a uniform block when they can
+	static const LLCachedControl<bool> use_uniform_buffers("RenderUniformBuffers", true);
+	if (use_uniform_buffers && gGLManager.mHasUniformBufferObject &&
+		(gGLManager.mGLSLVersionMajor > 1 || gGLManager.mGLSLVersionMinor >= 30))
+	{
+		mUniformBuffers.push_back(&mWindLightSkyBuffer);
+	}
+
 	bool want_shaders = LLFeatureManager::getInstance()->isFeatureAvailable("VertexShaderEnable") &&
 						gSavedSettings.getBOOL("VertexShaderEnable") && 
 						(gGLManager.mGLSLVersionMajor > 1 || gGLManager.mGLSLVersionMinor >= 10);
@@ -497,6 +556,9 @@ void LLViewerShaderMgr::setShaders()
 		unloadShaderObjects();
 	}
 
+	logLoadTimes();
+	logProgramCacheStats();
+
 	if (gViewerWindow)
 	{
 		gViewerWindow->setCursor(UI_CURSOR_ARROW);
@@ -522,6 +584,9 @@ void LLViewerShaderMgr::unloadShaders()
 	for (S32 i = 0; i < SHADER_COUNT; i++)
 		mVertexShaderLevel[i] = 0;
 
+	mUniformBuffers.clear();
+	mWindLightSkyBuffer.destroyGL();
+
 	//Unset all shader-dependent static variables.
 	LLGLSLShader::sNoFixedFunction = false;
 	LLGLSLShader::sIndexedTextureChannels = 1;
@@ -537,10 +602,38 @@ void LLViewerShaderMgr::unloadShaderObjects()
 		if (it->second.mHandle)
 			glDeleteObjectARB(it->second.mHandle);
 	mShaderObjects.clear();
+	mSourceHashes.clear();
+}
+
+LLUniformBuffer* LLViewerShaderMgr::getWindLightSkyBuffer()
+{
+	return mUniformBuffers.empty() ? NULL : &mWindLightSkyBuffer;
+}
+
+void LLViewerShaderMgr::logLoadTimes()
+{
+	if (mLoadTimes.empty())
+	{
+		return;
+	}
+
+	std::ostringstream report;
+	F64 total = 0.0;
+	U32 programs = 0;
+	for (load_times_t::iterator it = mLoadTimes.begin(); it != mLoadTimes.end(); ++it)
+	{
+		report << llformat("\n %-12s %4u programs %8.1f ms", it->mName, it->mPrograms, it->mSeconds * 1000.0);
+		total += it->mSeconds;
+		programs += it->mPrograms;
+	}
+	report << llformat("\n %-12s %4u programs %8.1f ms", "Total", programs, total * 1000.0);
+	LL_INFOS("ShaderLoading") << "Shader load times:" << report.str() << LL_ENDL;
 }
 
 BOOL LLViewerShaderMgr::loadBasicShaders()
 {
+	LLShaderLoadTimer load_timer(mLoadTimes, "Basic");
+
 	// Load basic dependency shaders first
 	// All of these have to load for any shaders to function
 	
@@ -595,13 +688,17 @@ BOOL LLViewerShaderMgr::loadBasicShaders()
 	}
 	shaders.push_back( make_pair( "objects/nonindexedTextureV.glsl",		1 ) );
 
+	// Compile everything at once and collect the results at the end
+	beginShaderBatch();
+	BOOL success = TRUE;
+
 	// We no longer have to bind the shaders to global glhandles, they are automatically added to a map now.
-	for (U32 i = 0; i < shaders.size(); i++)
+	for (U32 i = 0; success && i < shaders.size(); i++)
 	{
 		// Note usage of GL_VERTEX_SHADER_ARB
 		if (loadShaderFile(shaders[i].first, shaders[i].second, GL_VERTEX_SHADER_ARB) == 0)
 		{
-			return FALSE;
+			success = FALSE;
 		}
 	}
 
@@ -643,20 +740,21 @@ BOOL LLViewerShaderMgr::loadBasicShaders()
 	index_channels.push_back(ch);	shaders.push_back( make_pair( "lighting/lightShinyWaterF.glsl",			mVertexShaderLevel[SHADER_LIGHTING] ) );
 	index_channels.push_back(ch);	shaders.push_back( make_pair( "lighting/lightFullbrightShinyWaterF.glsl", mVertexShaderLevel[SHADER_LIGHTING] ) );
 	
-	for (U32 i = 0; i < shaders.size(); i++)
+	for (U32 i = 0; success && i < shaders.size(); i++)
 	{
 		// Note usage of GL_FRAGMENT_SHADER_ARB
 		if (loadShaderFile(shaders[i].first, shaders[i].second, GL_FRAGMENT_SHADER_ARB, NULL, index_channels[i]) == 0)
 		{
-			return FALSE;
+			success = FALSE;
 		}
 	}
 
-	return TRUE;
+	return endShaderBatch() && success;
 }
 
 BOOL LLViewerShaderMgr::loadShadersEnvironment()
 {
+	LLShaderLoadTimer load_timer(mLoadTimes, "Environment");
 	BOOL success = TRUE;
 
 	if (mVertexShaderLevel[SHADER_ENVIRONMENT] == 0)
@@ -665,6 +763,8 @@ BOOL LLViewerShaderMgr::loadShadersEnvironment()
 		return TRUE;
 	}
 
+	beginShaderBatch();
+
 	if (success)
 	{
 		gTerrainProgram.mName = "Terrain Shader";
@@ -681,6 +781,8 @@ BOOL LLViewerShaderMgr::loadShadersEnvironment()
 		success = gTerrainProgram.createShader(NULL, NULL);
 	}
 
+	success = endShaderBatch() && success;
+
 	if (!success)
 	{
 		mVertexShaderLevel[SHADER_ENVIRONMENT] = 0;
@@ -696,6 +798,7 @@ BOOL LLViewerShaderMgr::loadShadersEnvironment()
 
 BOOL LLViewerShaderMgr::loadShadersWater()
 {
+	LLShaderLoadTimer load_timer(mLoadTimes, "Water");
 	BOOL success = TRUE;
 
 	if (mVertexShaderLevel[SHADER_WATER] == 0)
@@ -704,6 +807,8 @@ BOOL LLViewerShaderMgr::loadShadersWater()
 		return TRUE;
 	}
 
+	beginShaderBatch();
+
 	if (success)
 	{
 		// load water shader
@@ -750,6 +855,8 @@ BOOL LLViewerShaderMgr::loadShadersWater()
 		success = gTerrainWaterProgram.createShader(NULL, NULL);
 	}
 
+	success = endShaderBatch() && success;
+
 	if (!success)
 	{
 		mVertexShaderLevel[SHADER_WATER] = 0;
@@ -765,6 +872,7 @@ BOOL LLViewerShaderMgr::loadShadersWater()
 
 BOOL LLViewerShaderMgr::loadShadersEffects()
 {
+	LLShaderLoadTimer load_timer(mLoadTimes, "Effects");
 	BOOL success = TRUE;
 
 	if (mVertexShaderLevel[SHADER_EFFECT] == 0)
@@ -951,6 +1059,7 @@ BOOL LLViewerShaderMgr::loadShadersEffects()
 
 BOOL LLViewerShaderMgr::loadShadersDeferred()
 {
+	LLShaderLoadTimer load_timer(mLoadTimes, "Deferred");
 	if (mVertexShaderLevel[SHADER_DEFERRED] == 0)
 	{
 		unloadShaderClass(SHADER_DEFERRED);
@@ -959,6 +1068,8 @@ BOOL LLViewerShaderMgr::loadShadersDeferred()
 
 	BOOL success = TRUE;
 
+	beginShaderBatch();
+
 	if (success)
 	{
 		gDeferredDiffuseProgram.mName = "Deferred Diffuse Shader";
@@ -1782,6 +1893,8 @@ BOOL LLViewerShaderMgr::loadShadersDeferred()
 		success = gNormalMapGenProgram.createShader(NULL, NULL);
 	}
 
+	success = endShaderBatch() && success;
+
 	if (!success)
 	{
 		mVertexShaderLevel[SHADER_DEFERRED] = 0;
@@ -1793,6 +1906,7 @@ BOOL LLViewerShaderMgr::loadShadersDeferred()
 
 BOOL LLViewerShaderMgr::loadShadersObject()
 {
+	LLShaderLoadTimer load_timer(mLoadTimes, "Object");
 	BOOL success = TRUE;
 
 	if (mVertexShaderLevel[SHADER_OBJECT] == 0)
@@ -1801,6 +1915,8 @@ BOOL LLViewerShaderMgr::loadShadersObject()
 		return TRUE;
 	}
 	
+	beginShaderBatch();
+
 	if (success)
 	{
 		gObjectSimpleNonIndexedTexGenProgram.mName = "Non indexed tex-gen Shader";
@@ -2095,6 +2211,8 @@ BOOL LLViewerShaderMgr::loadShadersObject()
 		}
 	}
 
+	success = endShaderBatch() && success;
+
 	if (!success)
 	{
 		mVertexShaderLevel[SHADER_OBJECT] = 0;
@@ -2106,6 +2224,7 @@ BOOL LLViewerShaderMgr::loadShadersObject()
 
 BOOL LLViewerShaderMgr::loadShadersAvatar()
 {
+	LLShaderLoadTimer load_timer(mLoadTimes, "Avatar");
 	BOOL success = TRUE;
 
 	if (mVertexShaderLevel[SHADER_AVATAR] == 0)
@@ -2114,6 +2233,8 @@ BOOL LLViewerShaderMgr::loadShadersAvatar()
 		return TRUE;
 	}
 
+	beginShaderBatch();
+
 	if (success)
 	{
 		gAvatarProgram.mName = "Avatar Shader";
@@ -2152,6 +2273,8 @@ BOOL LLViewerShaderMgr::loadShadersAvatar()
 		}
 	}
 
+	success = endShaderBatch() && success;
+
 	if( !success )
 	{
 		mVertexShaderLevel[SHADER_AVATAR] = 0;
@@ -2163,6 +2286,7 @@ BOOL LLViewerShaderMgr::loadShadersAvatar()
 
 BOOL LLViewerShaderMgr::loadShadersInterface()
 {
+	LLShaderLoadTimer load_timer(mLoadTimes, "Interface");
 	BOOL success = TRUE;
 
 	if (mVertexShaderLevel[SHADER_INTERFACE] == 0)
@@ -2171,6 +2295,8 @@ BOOL LLViewerShaderMgr::loadShadersInterface()
 		return TRUE;
 	}
 	
+	beginShaderBatch();
+
 	if (success)
 	{
 		gHighlightProgram.mName = "Highlight Shader";
@@ -2394,6 +2520,21 @@ BOOL LLViewerShaderMgr::loadShadersInterface()
 		success = gAlphaMaskProgram.createShader(NULL, NULL);
 	}
 
+	success = endShaderBatch() && success;
+
+	if (success)
+	{
+		gHiZDownsampleProgram.mName = "Hi-Z Downsample Shader";
+		gHiZDownsampleProgram.mShaderFiles.clear();
+		gHiZDownsampleProgram.mShaderFiles.push_back(make_pair("interface/downsampleDepthV.glsl", GL_VERTEX_SHADER_ARB));
+		gHiZDownsampleProgram.mShaderFiles.push_back(make_pair("interface/hiZDownsampleF.glsl", GL_FRAGMENT_SHADER_ARB));
+		gHiZDownsampleProgram.mShaderLevel = mVertexShaderLevel[SHADER_INTERFACE];
+		if (!gHiZDownsampleProgram.createShader(NULL, NULL))
+		{ //optional, world occlusion falls back to queries without it, so not part of the batch
+			gHiZDownsampleProgram.unload();
+		}
+	}
+
 	if (!success)
 	{
 		mVertexShaderLevel[SHADER_INTERFACE] = 0;
@@ -2409,10 +2550,13 @@ BOOL LLViewerShaderMgr::loadShadersWindLight()
 
 	if (mVertexShaderLevel[SHADER_WINDLIGHT] < 2)
 	{
+	LLShaderLoadTimer load_timer(mLoadTimes, "WindLight");
 		unloadShaderClass(SHADER_WINDLIGHT);
 		return TRUE;
 	}
 
+	beginShaderBatch();
+
 	if (success)
 	{
 		gWLSkyProgram.mName = "Windlight Sky Shader";
@@ -2437,6 +2581,8 @@ BOOL LLViewerShaderMgr::loadShadersWindLight()
 		success = gWLCloudProgram.createShader(NULL, NULL);
 	}
 
+	success = endShaderBatch() && success;
+
 	if (!success)
 	{
 		mVertexShaderLevel[SHADER_WINDLIGHT] = 0;
@@ -2448,6 +2594,7 @@ BOOL LLViewerShaderMgr::loadShadersWindLight()
 
 BOOL LLViewerShaderMgr::loadTransformShaders()
 {
+	LLShaderLoadTimer load_timer(mLoadTimes, "Transform");
 	BOOL success = TRUE;
 	
 	if (mVertexShaderLevel[SHADER_TRANSFORM] < 1)
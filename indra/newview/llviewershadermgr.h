@@ -29,6 +29,7 @@
 
 #include "llshadermgr.h"
 #include "llmaterial.h"
+#include "lluniformbuffer.h"
 
 #define LL_DEFERRED_MULTI_LIGHT_COUNT 16
 
@@ -58,6 +59,8 @@ public:
 	void setShaders();
 	void unloadShaders();
 	void unloadShaderObjects();
+	// The windlight sky uniform block, NULL unless shaders were loaded with it
+	LLUniformBuffer* getWindLightSkyBuffer();
 	S32 getVertexShaderLevel(S32 type);
 	BOOL loadBasicShaders();
 	BOOL loadShadersEffects();
@@ -70,6 +73,16 @@ public:
 	BOOL loadShadersWindLight();
 	BOOL loadTransformShaders();
 
+	// One line of the shader load time report
+	struct LoadTime
+	{
+		LoadTime(const char* name) : mName(name), mSeconds(0.0), mPrograms(0) {}
+		const char* mName;
+		F64 mSeconds;
+		U32 mPrograms;
+	};
+	typedef std::vector<LoadTime> load_times_t;
+
 	std::vector<S32> mVertexShaderLevel;
 
 	enum EShaderClass
@@ -148,7 +161,13 @@ public:
 	/* virtual */ void updateShaderUniforms(LLGLSLShader * shader); // Virtual
 
 private:
-	
+	void logLoadTimes();
+
+	// Per shader class, filled in while setShaders() runs
+	load_times_t mLoadTimes;
+
+	LLUniformBuffer mWindLightSkyBuffer;
+
 	std::vector<std::string> mShinyUniforms;
 
 	//water parameters
@@ -211,6 +230,7 @@ extern LLGLSLShader			gDebugProgram;
 extern LLGLSLShader			gClipProgram;
 extern LLGLSLShader			gDownsampleDepthProgram;
 extern LLGLSLShader			gDownsampleDepthRectProgram;
+extern LLGLSLShader			gHiZDownsampleProgram;
 
 //output tex0[tc0] + tex1[tc1]
 extern LLGLSLShader			gTwoTextureAddProgram;
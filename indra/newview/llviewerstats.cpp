@@ -217,6 +217,7 @@ LLViewerStats::LLViewerStats() :
 	mHTTPTextureKBitStat("httptexturekbitstat"),
 	mUDPTextureKBitStat("udptexturekbitstat"),
 	mMallocStat("mallocstat"),
+	mPoolFragmentationStat("poolfragmentationstat"),
 	mVFSPendingOperations("vfspendingoperations"),
 	mObjectsDrawnStat("objectsdrawnstat"),
 	mObjectsCulledStat("objectsculledstat"),
@@ -699,6 +700,10 @@ void update_statistics()
 		if (mem_stats_timer.getElapsedTimeF32() >= mem_stats_freq)
 		{
 			stats.mMallocStat.addValue(SGMemStat::getMalloc()/1024.f/1024.f);
+			if (SGMemStat::havePoolStat())
+			{
+				stats.mPoolFragmentationStat.addValue(SGMemStat::getPoolFragmentation());
+			}
 			mem_stats_timer.reset();
 		}
 	}
@@ -60,7 +60,8 @@ public:
 			mActualInKBitStat,	// From the packet ring (when faking a bad connection)
 			mActualOutKBitStat,	// From the packet ring (when faking a bad connection)
 			mTrianglesDrawnStat,
-			mMallocStat;
+			mMallocStat,
+			mPoolFragmentationStat;
 
 	// Simulator stats
 	LLStat	mSimTimeDilation,
@@ -1341,9 +1341,18 @@ BOOL LLViewerFetchedTexture::createTexture(S32 usename/*= 0*/)
 		
 		//if(!(res = insertToAtlas()))
 		//{
-			res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, TRUE, mBoostLevel);
+			static LLCachedControl<bool> background_upload(gSavedSettings, "RenderBackgroundTextureUpload");
+			res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, TRUE, mBoostLevel, background_upload);
 			//resetFaceAtlas() ;
 		//}
+		if (mGLTexturep->isUploadPending())
+		{
+			// Keep the raw image, and hold off fetches and callbacks, until
+			// the upload thread is done; see postCreateTexture().
+			mNeedsCreateTexture = TRUE;
+			gTextureList.mUploadTextureList.insert(this);
+			return res;
+		}
 		setActive() ;
 	}
 
@@ -1355,6 +1364,24 @@ BOOL LLViewerFetchedTexture::createTexture(S32 usename/*= 0*/)
 	return res;
 }
 
+// ONLY called from LLViewerTextureList
+BOOL LLViewerFetchedTexture::postCreateTexture()
+{
+	if (mGLTexturep.notNull() && mGLTexturep->isUploadPending())
+	{
+		return FALSE;
+	}
+	mNeedsCreateTexture = FALSE;
+	setActive() ;
+
+	if (!needsToSaveRawImage())
+	{
+		mNeedsAux = FALSE;
+		destroyRawImage();
+	}
+	return TRUE;
+}
+
 // Call with 0,0 to turn this feature off.
 //virtual
 void LLViewerFetchedTexture::setKnownDrawSize(S32 width, S32 height)
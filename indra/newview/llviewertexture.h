@@ -298,6 +298,8 @@ public:
 
 	 // ONLY call from LLViewerTextureList
 	BOOL createTexture(S32 usename = 0);
+	// Returns FALSE while the GL upload thread still works on the texture
+	BOOL postCreateTexture();
 	void destroyTexture() ;	
 	
 	virtual void processTextureStats() ;
@@ -31,8 +31,14 @@
 
 #include "llmath.h"
 #include "llerror.h"
+#include "llfasttimer.h"
+#include "llthreadpool.h"
 
 std::vector<LLViewerTextureAnim*> LLViewerTextureAnim::sInstanceList;
+std::vector<LLViewerTextureAnim::Frame> LLViewerTextureAnim::sFrames;
+
+static LLFastTimer::DeclareTimer FTM_TEXTURE_ANIM_FRAMES("Texture Anim Frames");
+static LLFastTimer::DeclareTimer FTM_TEXTURE_ANIM_APPLY("Texture Anim Apply");
 
 LLViewerTextureAnim::LLViewerTextureAnim(LLVOVolume* vobj) : LLTextureAnim()
 {
@@ -64,9 +70,40 @@ void LLViewerTextureAnim::reset()
 //static 
 void LLViewerTextureAnim::updateClass()
 {
-	for (std::vector<LLViewerTextureAnim*>::iterator iter = sInstanceList.begin(); iter != sInstanceList.end(); ++iter)
+	// Animations to hand a worker at a time
+	const S32 ANIM_GRAIN = 256;
+
+	// Working out a frame only touches the animation itself, so that part runs
+	// on the thread pool; the faces it changes are updated here afterwards.
+	sFrames.resize(sInstanceList.size());
+	{
+		LLFastTimer t(FTM_TEXTURE_ANIM_FRAMES);
+		LLThreadPool::parallelFor((S32)sInstanceList.size(), ANIM_GRAIN, &LLViewerTextureAnim::animateRange);
+	}
+
+	LLFastTimer t(FTM_TEXTURE_ANIM_APPLY);
+	for (U32 i = 0; i < sInstanceList.size(); ++i)
+	{
+		const Frame& frame = sFrames[i];
+		sInstanceList[i]->mVObj->applyTextureAnimFrame(frame.mResult, frame.mOffS, frame.mOffT,
+														frame.mScaleS, frame.mScaleT, frame.mRot);
+	}
+}
+
+//static
+void LLViewerTextureAnim::animateRange(S32 begin, S32 end)
+{
+	for (S32 i = begin; i < end; ++i)
 	{
-		(*iter)->mVObj->animateTextures();
+		Frame& frame = sFrames[i];
+		frame.mOffS = frame.mOffT = frame.mRot = 0.f;
+		frame.mScaleS = frame.mScaleT = 1.f;
+		frame.mResult = 0;
+		LLViewerTextureAnim* anim = sInstanceList[i];
+		if (!anim->mVObj->isDead())
+		{
+			frame.mResult = anim->animateTextures(frame.mOffS, frame.mOffT, frame.mScaleS, frame.mScaleT, frame.mRot);
+		}
 	}
 }
 
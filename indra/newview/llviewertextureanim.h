@@ -38,6 +38,15 @@ private:
 	static std::vector<LLViewerTextureAnim*> sInstanceList;
 	S32 mInstanceIndex;
 
+	// The outputs of animateTextures(), one per instance
+	struct Frame
+	{
+		S32 mResult;
+		F32 mOffS, mOffT, mScaleS, mScaleT, mRot;
+	};
+	static std::vector<Frame> sFrames;
+	static void animateRange(S32 begin, S32 end);
+
 public:
 	static void updateClass();
 
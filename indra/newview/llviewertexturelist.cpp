@@ -40,6 +40,7 @@
 #include "imageids.h"
 #include "llgl.h" // fot gathering stats from GL
 #include "llimagegl.h"
+#include "llimageglthread.h"
 #include "llimagebmp.h"
 #include "llimagej2c.h"
 #include "llimagetga.h"
@@ -296,6 +297,7 @@ void LLViewerTextureList::shutdown()
 	// Flush all of the references
 	mLoadingStreamList.clear();
 	mCreateTextureList.clear();
+	mUploadTextureList.clear();
 	
 	mUUIDMap.clear();
 	
@@ -898,6 +900,20 @@ F32 LLViewerTextureList::updateImagesCreateTextures(F32 max_time)
 	LLFastTimer t(FTM_IMAGE_CREATE);
 	
 	LLTimer create_timer;
+
+	// Swap in the textures that the upload thread finished
+	LLImageGLThread::updateClass();
+	for (image_list_t::iterator iter = mUploadTextureList.begin();
+		 iter != mUploadTextureList.end();)
+	{
+		image_list_t::iterator curiter = iter++;
+		LLViewerFetchedTexture *imagep = *curiter;
+		if (imagep->postCreateTexture())
+		{
+			mUploadTextureList.erase(curiter);
+		}
+	}
+
 	image_list_t::iterator enditer = mCreateTextureList.begin();
 	for (image_list_t::iterator iter = mCreateTextureList.begin();
 		 iter != mCreateTextureList.end();)
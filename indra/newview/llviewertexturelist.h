@@ -174,6 +174,7 @@ public:
 	typedef std::set<LLPointer<LLViewerFetchedTexture> > image_list_t;	
 	image_list_t mLoadingStreamList;
 	image_list_t mCreateTextureList;
+	image_list_t mUploadTextureList;	// Waiting for the GL upload thread
 	image_list_t mCallbackList;
 
 	// Note: just raw pointers because they are never referenced, just compared against
@@ -101,6 +101,7 @@
 #include "llfloatertools.h"
 #include "llfloaterworldmap.h"
 #include "llfocusmgr.h"
+#include "llframebudget.h"
 #include "llframestatview.h"
 #include "llgesturemgr.h"
 #include "llglheaders.h"
@@ -109,6 +110,7 @@
 #include "llhudview.h"
 #include "llimagebmp.h"
 #include "llimagej2c.h"
+#include "llimageglthread.h"
 #include "llimageworker.h"
 #include "llkeyboard.h"
 #include "lllineeditor.h"
@@ -385,6 +387,23 @@ public:
 		}
 #endif
 
+		static const LLCachedControl<bool> debug_show_frame_budget("DebugShowFrameBudget");
+		if (debug_show_frame_budget)
+		{
+			for (S32 i = LLFrameBudget::NUM_CONSUMERS - 1; i >= 0; --i)
+			{
+				LLFrameBudget::EConsumer consumer = (LLFrameBudget::EConsumer)i;
+				const LLFrameBudget::Consumer& stats = gFrameBudget.getConsumer(consumer);
+				addText(xpos, ypos, llformat("    %s: %.2f of %.2f ms, deferred %d%%", LLFrameBudget::getName(consumer),
+											 stats.mAvgUsed * 1000.f, stats.mAvgSlice * 1000.f, ll_round(stats.mDeferRate * 100.f)));
+				ypos += y_inc;
+			}
+			F32 target = gFrameBudget.getTargetFrameTime();
+			addText(xpos, ypos, target > 0.f ? llformat("Frame Budget: %.2f ms (target %.0f fps)", gFrameBudget.getPool() * 1000.f, 1.f / target)
+											 : llformat("Frame Budget: %.2f ms (no target)", gFrameBudget.getPool() * 1000.f));
+			ypos += y_inc;
+		}
+
 		if (gDisplayCameraPos)
 		{
 			std::string camera_view_text;
@@ -578,6 +597,12 @@ public:
 			addText(xpos, ypos, llformat("%d Unique Textures", LLImageGL::sUniqueCount));
 			ypos += y_inc;
 
+			addText(xpos, ypos, llformat("%d Shader Binds", LLGLSLShader::sBindCount));
+			ypos += y_inc;
+
+			addText(xpos, ypos, llformat("%d Uniform Updates (%d Redundant Skipped)", LLGLSLShader::sUniformUpdateCount, LLGLSLShader::sRedundantUniformCount));
+			ypos += y_inc;
+
 			addText(xpos, ypos, llformat("%d Render Calls", gPipeline.mBatchCount));
 			ypos += y_inc;
 
@@ -691,6 +716,7 @@ public:
 
 			LLVertexBuffer::sBindCount = LLImageGL::sBindCount = 
 				LLVertexBuffer::sSetCount = LLImageGL::sUniqueCount =
+				LLGLSLShader::sBindCount = LLGLSLShader::sUniformUpdateCount = LLGLSLShader::sRedundantUniformCount =
 				gPipeline.mNumVisibleNodes = LLPipeline::sVisibleLightCount = 0;
 		}
 		static const LLCachedControl<bool> debug_show_render_matrices("DebugShowRenderMatrices");
@@ -1738,6 +1764,10 @@ LLViewerWindow::LLViewerWindow(
 	LLVertexBuffer::initClass(gSavedSettings.getBOOL("RenderVBOEnable"), gSavedSettings.getBOOL("RenderVBOMappingDisable"));
 	LL_INFOS("RenderInit") << "LLVertexBuffer initialization done." << LL_ENDL ;
 	LLImageGL::initClass(LLViewerTexture::MAX_GL_IMAGE_CATEGORY) ;
+	if (gSavedSettings.getBOOL("RenderBackgroundTextureUpload"))
+	{
+		LLImageGLThread::createInstance(mWindow);
+	}
 
 	if (LLFeatureManager::getInstance()->isSafe()
 		|| (gSavedSettings.getS32("LastFeatureVersion") != LLFeatureManager::getInstance()->getVersion())
@@ -2271,6 +2301,7 @@ void LLViewerWindow::shutdownGL()
 	LL_INFOS() << "Cleaning up wearables" << LL_ENDL;
 	LLWearableList::instance().cleanup() ;
 
+	LLImageGLThread::deleteInstance();
 	gTextureList.shutdown();
 	stop_glerror();
 
@@ -2681,6 +2712,70 @@ void LLViewerWindow::draw()
 #endif
 }
 
+void LLViewerWindow::benchmarkUIDraw(U32 frames)
+{
+	// Only views that opted in with retain_draw are retained: turning it on
+	// for views whose draw() also updates their state would time drawing
+	// that is wrong.
+	const bool retain_draw = LLView::sRetainDraw;
+	const U32 ui_calls = LLRender::sUICalls;
+	const U32 ui_verts = LLRender::sUIVerts;
+	F64 frame_time[2];
+	U32 draw_calls[2];
+	U32 retained_draws = 0;
+	U32 retained_replays = 0;
+	for (U32 pass = 0; pass < 2; ++pass)
+	{
+		LLView::sRetainDraw = pass == 1;
+
+		// Lets the views record before the timed frames.
+		const U32 WARMUP_FRAMES = 4;
+		LLTimer timer;
+		for (U32 frame = 0; frame < WARMUP_FRAMES + frames; ++frame)
+		{
+			if (frame == WARMUP_FRAMES)
+			{
+				glFinish();
+				timer.reset();
+				LLRender::sUICalls = 0;
+				LLView::sRetainedDraws = 0;
+				LLView::sRetainedReplays = 0;
+			}
+
+			LLGLSDefault gls_default;
+			LLGLSUIDefault gls_ui;
+			setup2DRender();
+			gGL.getTexUnit(0)->setTextureBlendType(LLTexUnit::TB_MULT);
+			gGL.color4f(1, 1, 1, 1);
+			draw();
+			gGL.flush();
+			LLVertexBuffer::unbind();
+		}
+		glFinish();
+		frame_time[pass] = timer.getElapsedTimeF64() / llmax(frames, 1U);
+		draw_calls[pass] = LLRender::sUICalls / llmax(frames, 1U);
+		if (pass == 1)
+		{
+			retained_draws = LLView::sRetainedDraws;
+			retained_replays = LLView::sRetainedReplays;
+		}
+	}
+
+	LLView::sRetainDraw = retain_draw;
+	LLRender::sUICalls = ui_calls;
+	LLRender::sUIVerts = ui_verts;
+
+	if (!retained_draws)
+	{
+		LL_WARNS() << "No view open retains its drawing; open one that sets retain_draw to benchmark retained UI drawing" << LL_ENDL;
+		return;
+	}
+	LL_INFOS() << "UI draw over " << frames << " frames: " << frame_time[0] * 1000.0 << " ms and " << draw_calls[0]
+			   << " batches per frame drawn live, " << frame_time[1] * 1000.0 << " ms and " << draw_calls[1]
+			   << " batches per frame retained, with " << retained_replays << " of " << retained_draws
+			   << " retaining view draws replayed" << LL_ENDL;
+}
+
 // Takes a single keydown event, usually when UI is visible
 BOOL LLViewerWindow::handleKey(KEY key, MASK mask)
 {
@@ -5268,6 +5363,9 @@ void LLViewerWindow::stopGL(BOOL save_state)
 		LLAppViewer::getTextureCache()->pause();
 		LLAppViewer::getImageDecodeThread()->pause();
 		LLAppViewer::getTextureFetch()->pause();
+
+		// The upload context shares with the one that is about to go away.
+		LLImageGLThread::deleteInstance();
 				
 		gSky.destroyGL();
 		stop_glerror();		
@@ -5329,6 +5427,10 @@ void LLViewerWindow::restoreGL(const std::string& progress_message)
 		gGL.refreshState();	//Singu Note: Call immediately. Cached states may have prevented initGLDefaults from actually applying changes.
 		LLGLState::restoreGL();
 		gTextureList.restoreGL();
+		if (gSavedSettings.getBOOL("RenderBackgroundTextureUpload"))
+		{
+			LLImageGLThread::createInstance(mWindow);
+		}
 
 		// for future support of non-square pixels, and fonts that are properly stretched
 		//LLFontGL::destroyDefaultFonts();
@@ -302,6 +302,8 @@ public:
 	void			sendShapeToSim();
 
 	void			draw();
+	// Times drawing the UI with and without retained drawing, and logs the result.
+	void			benchmarkUIDraw(U32 frames);
 	void			updateDebugText();
 	void			drawDebugText();
 
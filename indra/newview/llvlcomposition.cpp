@@ -34,6 +34,8 @@
 
 #include "llvlcomposition.h"
 
+#include <boost/bind.hpp>
+
 #include "imageids.h"
 #include "llerror.h"
 #include "v3math.h"
@@ -42,11 +44,16 @@
 #include "llviewertexture.h"
 #include "llviewertexturelist.h"
 #include "llviewerregion.h"
-#include "llperlin.h"
 #include "llregionhandle.h" // for from_region_handle
 #include "llviewercontrol.h"
+#include "llthreadpool.h"
 
+static LLFastTimer::DeclareTimer FTM_TERRAIN_NOISE("Terrain Noise");
+static LLFastTimer::DeclareTimer FTM_TERRAIN_COMPOSITE("Terrain Composite");
 
+// Rows of noise, and patch textures, per thread pool job
+const S32 NOISE_ROW_GRAIN = 16;
+const S32 BLEND_RECT_GRAIN = 16;
 
 F32 bilinear(const F32 v00, const F32 v01, const F32 v10, const F32 v11, const F32 x_frac, const F32 y_frac)
 {
@@ -67,7 +74,8 @@ F32 bilinear(const F32 v00, const F32 v01, const F32 v10, const F32 v11, const F
 
 LLVLComposition::LLVLComposition(LLSurface *surfacep, const U32 width, const F32 scale) :
 	LLViewerLayer(width, scale),
-	mParamsReady(FALSE)
+	mParamsReady(FALSE),
+	mNoiseHandle(0)
 {
 	mSurfacep = surfacep;
 
@@ -112,6 +120,25 @@ void LLVLComposition::setDetailTextureID(S32 corner, const LLUUID& id)
 	mDetailTextures[corner] = LLViewerTextureManager::getFetchedTexture(id);
 	mDetailTextures[corner]->setNoDelete() ;
 	mRawImages[corner] = NULL;
+	invalidateBlendedTextures();
+}
+
+void LLVLComposition::updateNoise()
+{
+	const U64 handle = mSurfacep->getRegion()->getHandle();
+	if (handle == mNoiseHandle && (S32)mNoise.size() == mWidth*mWidth)
+	{
+		return;
+	}
+
+	LLFastTimer t(FTM_TERRAIN_NOISE);
+	LLVector3d origin_global = from_region_handle(handle);
+	mNoise.resize(mWidth*mWidth);
+	LLThreadPool::parallelFor(mWidth, NOISE_ROW_GRAIN,
+							  boost::bind(&LLTerrainComposite::generateNoise,
+										  (F32)origin_global.mdV[VX], (F32)origin_global.mdV[VY], mScale, mWidth,
+										  _1, _2, &mNoise[0]));
+	mNoiseHandle = handle;
 }
 
 BOOL LLVLComposition::generateHeights(const F32 x, const F32 y,
@@ -147,23 +174,16 @@ BOOL LLVLComposition::generateHeights(const F32 x, const F32 y,
 		y_end = mWidth;
 	}
 
-	LLVector3d origin_global = from_region_handle(mSurfacep->getRegion()->getHandle());
+	// The noise only depends on where the region is.
+	updateNoise();
+	invalidateBlendedTextures();
 
-	// For perlin noise generation...
-	const F32 slope_squared = 1.5f*1.5f;
-	const F32 xyScale = 4.9215f; //0.93284f;
-	//const F32 zScale = 4; //0.92165f;	//Unused
 	const F32 z_offset = 0.f;
-	const F32 noise_magnitude = 2.f;		//  Degree to which noise modulates composition layer (versus
-											//  simple height)
 
 	// Heights map into textures as 0-1 = first, 1-2 = second, etc.
 	// So we need to compress heights into this range.
 	const S32 NUM_TEXTURES = 4;
 
-	const F32 xyScaleInv = (1.f / xyScale);
-	//const F32 zScaleInv = (1.f / zScale);	//Unused
-
 // <FS:CR> Aurora Sim
 	//const F32 inv_width = 1.f/mWidth;
 	const F32 inv_width = 1.f/(F32)mWidth;
@@ -194,18 +214,10 @@ BOOL LLVLComposition::generateHeights(const F32 x, const F32 y,
 
 			// Step 0: Measure the exact height at this texel
 
-			// Adjust to non - integer lattice
-			LLVector2 vec = (LLVector2(LLVector3(origin_global)) + LLVector2(location));
-			vec *= xyScaleInv;
-			//vec[VZ] = height*zScaleInv;	//Unused.
-
 			//
 			//  Choose material value by adding to the exact height a random value 
 			//
-			twiddle = LLPerlinNoise::noise(vec*0.2222222222f)*6.5f;			//  Low freq component for large divisions
-
-			twiddle += LLPerlinNoise::turbulence(vec, 2.f)*slope_squared;	//  High frequency component
-			twiddle *= noise_magnitude;
+			twiddle = mNoise[i + j*mWidth];
 
 			F32 scaled_noisy_height = (height + twiddle - start_height) * F32(NUM_TEXTURES) / height_range;
 
@@ -258,15 +270,67 @@ BOOL LLVLComposition::generateComposition()
 	return TRUE;
 }
 
-BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
-									  const F32 width, const F32 height)
+void LLVLComposition::queueTexture(const F32 x, const F32 y, const F32 width, const F32 height)
 {
-	llassert(mSurfacep);
-	llassert(x >= 0.f);
-	llassert(y >= 0.f);
+	for (std::vector<TextureRect>::const_iterator it = mTextureRects.begin(); it != mTextureRects.end(); ++it)
+	{
+		if (it->mX == x && it->mY == y && it->mWidth == width)
+		{
+			return;
+		}
+	}
+	TextureRect rect;
+	rect.mX = x;
+	rect.mY = y;
+	rect.mWidth = width;
+	rect.mBlended = false;
+	mTextureRects.push_back(rect);
+}
 
-	LLTimer gen_timer;
+void LLVLComposition::invalidateBlendedTextures()
+{
+	for (std::vector<TextureRect>::iterator it = mTextureRects.begin(); it != mTextureRects.end(); ++it)
+	{
+		it->mBlended = false;
+	}
+}
 
+void LLVLComposition::getTexelRect(const TextureRect& rect, S32& tex_x_begin, S32& tex_y_begin, S32& tex_x_end, S32& tex_y_end) const
+{
+	///////////////////////////////////////
+	//
+	// Generate and clamp x/y bounding box.
+	//
+	//
+
+	S32 x_begin, y_begin, x_end, y_end;
+	x_begin = (S32)(rect.mX * mScaleInv);
+	y_begin = (S32)(rect.mY * mScaleInv);
+	x_end = ll_round( (rect.mX + rect.mWidth) * mScaleInv );
+	y_end = ll_round( (rect.mY + rect.mWidth) * mScaleInv );
+
+	if (x_end > mWidth)
+	{
+		LL_WARNS() << "x end > width" << LL_ENDL;
+		x_end = mWidth;
+	}
+	if (y_end > mWidth)
+	{
+		LL_WARNS() << "y end > width" << LL_ENDL;
+		y_end = mWidth;
+	}
+
+	LLViewerTexture *texturep = mSurfacep->getSTexture();
+	F32 tex_x_scalef = (F32)texturep->getWidth() / (F32)mWidth;
+	F32 tex_y_scalef = (F32)texturep->getHeight() / (F32)mWidth;
+	tex_x_begin = (S32)((F32)x_begin * tex_x_scalef);
+	tex_y_begin = (S32)((F32)y_begin * tex_y_scalef);
+	tex_x_end = (S32)((F32)x_end * tex_x_scalef);
+	tex_y_end = (S32)((F32)y_end * tex_y_scalef);
+}
+
+BOOL LLVLComposition::blendQueuedTextures()
+{
 	///////////////////////////
 	//
 	// Generate raw data arrays for surface textures
@@ -274,9 +338,6 @@ BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
 	//
 
 	// These have already been validated by generateComposition.
-	U8* st_data[4];
-	S32 st_data_size[4]; // for debugging
-
 	for (S32 i = 0; i < 4; i++)
 	{
 		if (mRawImages[i].isNull())
@@ -315,52 +376,20 @@ BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
 				mRawImages[i] = newraw; // deletes old
 			}
 		}
-		st_data[i] = mRawImages[i]->getData();
-		st_data_size[i] = mRawImages[i]->getDataSize();
-	}
-
-	///////////////////////////////////////
-	//
-	// Generate and clamp x/y bounding box.
-	//
-	//
-
-	S32 x_begin, y_begin, x_end, y_end;
-	x_begin = (S32)(x * mScaleInv);
-	y_begin = (S32)(y * mScaleInv);
-	x_end = ll_round( (x + width) * mScaleInv );
-	y_end = ll_round( (y + width) * mScaleInv );
-
-	if (x_end > mWidth)
-	{
-		LL_WARNS() << "x end > width" << LL_ENDL;
-		x_end = mWidth;
-	}
-	if (y_end > mWidth)
-	{
-		LL_WARNS() << "y end > width" << LL_ENDL;
-		y_end = mWidth;
+		mBlendParams.mDetail[i] = mRawImages[i]->getData();
+		mBlendParams.mDetailSize[i] = mRawImages[i]->getDataSize();
 	}
 
-
 	///////////////////////////////////////////
 	//
 	// Generate target texture information, stride ratios.
 	//
 	//
 
-	LLViewerTexture *texturep;
-	U32 tex_width, tex_height, tex_comps;
-	U32 tex_stride;
-	F32 tex_x_scalef, tex_y_scalef;
-	S32 tex_x_begin, tex_y_begin, tex_x_end, tex_y_end;
-	F32 tex_x_ratiof, tex_y_ratiof;
-
-	texturep = mSurfacep->getSTexture();
-	tex_width = texturep->getWidth();
-	tex_height = texturep->getHeight();
-	tex_comps = texturep->getComponents();
-	tex_stride = tex_width * tex_comps;
+	LLViewerTexture *texturep = mSurfacep->getSTexture();
+	U32 tex_width = texturep->getWidth();
+	U32 tex_height = texturep->getHeight();
+	U32 tex_comps = texturep->getComponents();
 
 	U32 st_comps = 3;
 	U32 st_width = BASE_SIZE;
@@ -372,92 +401,97 @@ BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
 		return FALSE;
 	}
 
-	tex_x_scalef = (F32)tex_width / (F32)mWidth;
-	tex_y_scalef = (F32)tex_height / (F32)mWidth;
-	tex_x_begin = (S32)((F32)x_begin * tex_x_scalef);
-	tex_y_begin = (S32)((F32)y_begin * tex_y_scalef);
-	tex_x_end = (S32)((F32)x_end * tex_x_scalef);
-	tex_y_end = (S32)((F32)y_end * tex_y_scalef);
-
-	tex_x_ratiof = (F32)mWidth*mScale / (F32)tex_width;
-	tex_y_ratiof = (F32)mWidth*mScale / (F32)tex_height;
+	if (mTextureRaw.isNull() || mTextureRaw->getWidth() != tex_width || mTextureRaw->getHeight() != tex_height)
+	{
+		mTextureRaw = new LLImageRaw(tex_width, tex_height, tex_comps);
+	}
 
-	LLPointer<LLImageRaw> raw = new LLImageRaw(tex_width, tex_height, tex_comps);
-	U8 *rawp = raw->getData();
+	mBlendParams.mComposition = mDatap;
+	mBlendParams.mCompositionWidth = mWidth;
+	mBlendParams.mCompositionScaleInv = mScaleInv;
+	mBlendParams.mDetailWidth = st_width;
+	mBlendParams.mDetailHeight = st_height;
+	mBlendParams.mDetailStrideX = ((F32)st_width / (F32)mTexScaleX)*((F32)mWidth / (F32)tex_width);
+	mBlendParams.mDetailStrideY = ((F32)st_height / (F32)mTexScaleY)*((F32)mWidth / (F32)tex_height);
+	mBlendParams.mTexelSizeX = (F32)mWidth*mScale / (F32)tex_width;
+	mBlendParams.mTexelSizeY = (F32)mWidth*mScale / (F32)tex_height;
+	mBlendParams.mDst = mTextureRaw->getData();
+	mBlendParams.mDstStride = tex_width * tex_comps;
+
+	llassert(mBlendParams.mDetailStrideX > 0.f);
+	llassert(mBlendParams.mDetailStrideY > 0.f);
+
+	// Patch textures don't overlap, so each goes to its own job.
+	mBlendRects.clear();
+	for (S32 i = 0; i < (S32)mTextureRects.size(); ++i)
+	{
+		if (!mTextureRects[i].mBlended)
+		{
+			mBlendRects.push_back(i);
+		}
+	}
+	LLThreadPool::parallelFor((S32)mBlendRects.size(), BLEND_RECT_GRAIN,
+							  boost::bind(&LLVLComposition::blendTextureRange, this, _1, _2));
+	for (std::vector<S32>::const_iterator it = mBlendRects.begin(); it != mBlendRects.end(); ++it)
+	{
+		mTextureRects[*it].mBlended = true;
+	}
+	return TRUE;
+}
 
-	F32 st_x_stride, st_y_stride;
-	st_x_stride = ((F32)st_width / (F32)mTexScaleX)*((F32)mWidth / (F32)tex_width);
-	st_y_stride = ((F32)st_height / (F32)mTexScaleY)*((F32)mWidth / (F32)tex_height);
+void LLVLComposition::blendTextureRange(S32 begin, S32 end)
+{
+	for (S32 i = begin; i < end; ++i)
+	{
+		S32 tex_x_begin, tex_y_begin, tex_x_end, tex_y_end;
+		getTexelRect(mTextureRects[mBlendRects[i]], tex_x_begin, tex_y_begin, tex_x_end, tex_y_end);
+		LLTerrainComposite::blend(mBlendParams, tex_x_begin, tex_y_begin, tex_x_end, tex_y_end);
+	}
+}
 
-	llassert(st_x_stride > 0.f);
-	llassert(st_y_stride > 0.f);
-	////////////////////////////////
-	//
-	// Iterate through the target texture, striding through the
-	// subtextures and interpolating appropriately.
-	//
-	//
+BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
+									  const F32 width, const F32 height)
+{
+	llassert(mSurfacep);
+	llassert(x >= 0.f);
+	llassert(y >= 0.f);
 
-	F32 sti, stj;
-	S32 st_offset;
-	sti = (tex_x_begin * st_x_stride) - st_width*(llfloor((tex_x_begin * st_x_stride)/st_width));
-	stj = (tex_y_begin * st_y_stride) - st_height*(llfloor((tex_y_begin * st_y_stride)/st_height));
+	LLTimer gen_timer;
+	LLFastTimer t(FTM_TERRAIN_COMPOSITE);
 
-	st_offset = (llfloor(stj * st_width) + llfloor(sti)) * st_comps;
-	for (S32 j = tex_y_begin; j < tex_y_end; j++)
+	// Callers that did not queue the area get it blended on its own.
+	queueTexture(x, y, width, height);
+	std::vector<TextureRect>::iterator rect = mTextureRects.begin();
+	while (rect->mX != x || rect->mY != y || rect->mWidth != width)
 	{
-		U32 offset = j * tex_stride + tex_x_begin * tex_comps;
-		sti = (tex_x_begin * st_x_stride) - st_width*((U32)(tex_x_begin * st_x_stride)/st_width);
-		for (S32 i = tex_x_begin; i < tex_x_end; i++)
-		{
-			S32 tex0, tex1;
-			F32 composition = getValueScaled(i*tex_x_ratiof, j*tex_y_ratiof);
-
-			tex0 = llfloor( composition );
-			tex0 = llclamp(tex0, 0, 3);
-			composition -= tex0;
-			tex1 = tex0 + 1;
-			tex1 = llclamp(tex1, 0, 3);
-
-			st_offset = (lltrunc(sti) + lltrunc(stj)*st_width) * st_comps;
-			for (U32 k = 0; k < tex_comps; k++)
-			{
-				// Linearly interpolate based on composition.
-				if (st_offset >= st_data_size[tex0] || st_offset >= st_data_size[tex1])
-				{
-					// SJB: This shouldn't be happening, but does... Rounding error?
-					//LL_WARNS() << "offset 0 [" << tex0 << "] =" << st_offset << " >= size=" << st_data_size[tex0] << LL_ENDL;
-					//LL_WARNS() << "offset 1 [" << tex1 << "] =" << st_offset << " >= size=" << st_data_size[tex1] << LL_ENDL;
-				}
-				else
-				{
-					F32 a = *(st_data[tex0] + st_offset);
-					F32 b = *(st_data[tex1] + st_offset);
-					rawp[ offset ] = (U8)lltrunc( a + composition * (b - a) );
-				}
-				offset++;
-				st_offset++;
-			}
+		++rect;
+	}
 
-			sti += st_x_stride;
-			if (sti >= st_width)
-			{
-				sti -= st_width;
-			}
-		}
+	LLViewerTexture *texturep = mSurfacep->getSTexture();
+	if (mTextureRaw.notNull() &&
+		(mTextureRaw->getWidth() != texturep->getWidth() || mTextureRaw->getHeight() != texturep->getHeight()))
+	{
+		// The surface texture was resized; what we blended is for the old size.
+		invalidateBlendedTextures();
+	}
 
-		stj += st_y_stride;
-		if (stj >= st_height)
+	if (!rect->mBlended)
+	{
+		if (!blendQueuedTextures())
 		{
-			stj -= st_height;
+			return FALSE;
 		}
 	}
 
+	S32 tex_x_begin, tex_y_begin, tex_x_end, tex_y_end;
+	getTexelRect(*rect, tex_x_begin, tex_y_begin, tex_x_end, tex_y_end);
+	mTextureRects.erase(rect);
+
 	if (!texturep->hasGLTexture())
 	{
-		texturep->createGLTexture(0, raw);
+		texturep->createGLTexture(0, mTextureRaw);
 	}
-	texturep->setSubImage(raw, tex_x_begin, tex_y_begin, tex_x_end - tex_x_begin, tex_y_end - tex_y_begin);
+	texturep->setSubImage(mTextureRaw, tex_x_begin, tex_y_begin, tex_x_end - tex_x_begin, tex_y_end - tex_y_begin);
 	LLSurface::sTextureUpdateTime += gen_timer.getElapsedTimeF32();
 	LLSurface::sTexelsUpdated += (tex_x_end - tex_x_begin) * (tex_y_end - tex_y_begin);
 
@@ -33,6 +33,9 @@
 #ifndef LL_LLVLCOMPOSITION_H
 #define LL_LLVLCOMPOSITION_H
 
+#include <vector>
+
+#include "llterraincomposite.h"
 #include "llviewerlayer.h"
 #include "llviewertexture.h"
 
@@ -51,6 +54,9 @@ public:
 	BOOL generateComposition();
 	// Generate texture from composition values.
 	BOOL generateTexture(const F32 x, const F32 y, const F32 width, const F32 height);		
+	// Announce a generateTexture() call for this area, so that the first
+	// generateTexture() of a frame blends all announced areas at once.
+	void queueTexture(const F32 x, const F32 y, const F32 width, const F32 height);
 
 	// Use these as indeces ito the get/setters below that use 'corner'
 	enum ECorner
@@ -75,6 +81,24 @@ public:
 	void setParamsReady()		{ mParamsReady = TRUE; }
 	BOOL getParamsReady() const	{ return mParamsReady; }
 protected:
+	// Area of the surface texture that generateTexture() will upload
+	struct TextureRect
+	{
+		F32 mX;
+		F32 mY;
+		F32 mWidth;
+		bool mBlended;		// In mTextureRaw, from the current heights and detail textures
+	};
+
+	// Computes mNoise for the region, if it has not yet.
+	void updateNoise();
+	// Blends mTextureRects that are not mBlended yet into mTextureRaw.
+	BOOL blendQueuedTextures();
+	void blendTextureRange(S32 begin, S32 end);
+	// The texels of the area, clamped to the composition.
+	void getTexelRect(const TextureRect& rect, S32& tex_x_begin, S32& tex_y_begin, S32& tex_x_end, S32& tex_y_end) const;
+	void invalidateBlendedTextures();
+
 	BOOL mParamsReady;
 	LLSurface *mSurfacep;
 	BOOL mTexturesLoaded;
@@ -87,6 +111,16 @@ protected:
 
 	F32 mTexScaleX;
 	F32 mTexScaleY;
+
+	// Height noise of every grid point, which only depends on where the region is
+	std::vector<F32> mNoise;
+	U64 mNoiseHandle;
+
+	// The whole surface texture, blended ahead of the uploads
+	LLPointer<LLImageRaw> mTextureRaw;
+	std::vector<TextureRect> mTextureRects;
+	std::vector<S32> mBlendRects;		// Indices in mTextureRects, for blendTextureRange()
+	LLTerrainComposite::BlendParams mBlendParams;
 };
 
 #endif //LL_LLVLCOMPOSITION_H
@@ -95,6 +95,9 @@ void LLVLManager::unpackData(const S32 num_packets)
 {
 	static LLFrameTimer decode_timer;
 	
+	// Land patches are only unpacked here; each surface then transforms all of its
+	// new patches at once.
+	std::vector<LLSurface*> land;
 	S32 i;
 	for (i = 0; i < mPacketData.count(); i++)
 	{
@@ -107,11 +110,13 @@ void LLVLManager::unpackData(const S32 num_packets)
 		if (LAND_LAYER_CODE == datap->mType)
 		{
 			datap->mRegionp->getLand().decompressDCTPatch(bit_pack, &goph, FALSE);
+			land.push_back(&datap->mRegionp->getLand());
 		}
 // <FS:CR> Aurora Sim
 		else if (AURORA_LAND_LAYER_CODE == datap->mType)
 		{
 			datap->mRegionp->getLand().decompressDCTPatch(bit_pack, &goph, TRUE);
+			land.push_back(&datap->mRegionp->getLand());
 		}
 		//else if (WIND_LAYER_CODE == datap->mType)
 		else if (WIND_LAYER_CODE == datap->mType || AURORA_WIND_LAYER_CODE == datap->mType)
@@ -128,6 +133,12 @@ void LLVLManager::unpackData(const S32 num_packets)
 		}
 	}
 
+	for (std::vector<LLSurface*>::iterator iter = land.begin(); iter != land.end(); ++iter)
+	{
+		// Surfaces that got several packets are done on their first visit.
+		(*iter)->decodePendingPatches();
+	}
+
 	for (i = 0; i < mPacketData.count(); i++)
 	{
 		delete mPacketData[i];
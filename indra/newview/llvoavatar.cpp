@@ -46,6 +46,7 @@
 #include "llagentwearables.h"
 #include "llanimationstates.h"
 #include "llavatarnamecache.h"
+#include "llavatarpositiontracker.h"
 #include "llavatarpropertiesprocessor.h"
 #include "llphysicsmotion.h"
 #include "llviewercontrol.h"
@@ -2377,6 +2378,11 @@ U32 LLVOAvatar::processUpdateMessage(LLMessageSystem *mesgsys,
 		}
 	}
 
+	else if (!isSelf() && LLAvatarPositionTracker::instanceExists())
+	{
+		LLAvatarPositionTracker::instance().updateAvatar(this);
+	}
+
 	//LL_INFOS() << getRotation() << LL_ENDL;
 	//LL_INFOS() << getPosition() << LL_ENDL;
 
@@ -514,13 +514,10 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 }
 
 
-void LLVOVolume::animateTextures()
+void LLVOVolume::applyTextureAnimFrame(S32 result, F32 off_s, F32 off_t, F32 scale_s, F32 scale_t, F32 rot)
 {
 	if (!mDead)
 	{
-		F32 off_s = 0.f, off_t = 0.f, scale_s = 1.f, scale_t = 1.f, rot = 0.f;
-		S32 result = mTextureAnimp->animateTextures(off_s, off_t, scale_s, scale_t, rot);
-	
 		if (result)
 		{
 			if (!mTexAnimMode)
@@ -4361,6 +4358,36 @@ static LLFastTimer::DeclareTimer FTM_REBUILD_VOLUME_VB("Volume VB");
 static LLFastTimer::DeclareTimer FTM_REBUILD_VOLUME_FACE_LIST("Build Face List");
 static LLFastTimer::DeclareTimer FTM_REBUILD_VOLUME_GEN_DRAW_INFO("Gen Draw Info");
 
+// genDrawInfo() and rebuildMesh() only prepare the faces of a group; their
+// vertices are packed together once the whole group is prepared, so that a
+// large group is spread over LLThreadPool. Main thread only.
+static LLFace::geometry_job_list_t sGeometryJobs;
+
+struct LLPendingBufferFlush
+{
+	LLVertexBuffer* mBuffer;
+	U16 mIndexOffset;
+	U32 mIndicesIndex;
+};
+static std::vector<LLPendingBufferFlush> sPendingFlushes;
+
+// Packs the faces genDrawInfo() prepared, then validates and unmaps their buffers.
+static void pack_group_geometry()
+{
+	LLFace::packGeometryVolumes(sGeometryJobs);
+	sGeometryJobs.resize(0);
+
+	for (std::vector<LLPendingBufferFlush>::iterator iter = sPendingFlushes.begin(); iter != sPendingFlushes.end(); ++iter)
+	{
+		if (iter->mIndexOffset > 0)
+		{
+			iter->mBuffer->validateRange(0, iter->mIndexOffset - 1, iter->mIndicesIndex, 0);
+		}
+		iter->mBuffer->flush();
+	}
+	sPendingFlushes.clear();
+}
+
 static LLDrawPoolAvatar* get_avatar_drawpool(LLViewerObject* vobj)
 {
 	LLVOAvatar* avatar = vobj->getAvatar();
@@ -5246,6 +5273,8 @@ void LLVolumeGeometryManager::rebuildGeom(LLSpatialGroup* group)
 	genDrawInfo(group, spec_mask | additional_flags, spec_faces, spec_count, FALSE);
 	genDrawInfo(group, normspec_mask | additional_flags, normspec_faces, normspec_count, FALSE);
 
+	pack_group_geometry();
+
 	if (!LLPipeline::sDelayVBUpdate)
 	{
 		//drawables have been rebuilt, clear rebuild status
@@ -5320,9 +5349,10 @@ void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
 						{
 							llassert(!face->isState(LLFace::RIGGED));
 
-							if (!face->getGeometryVolume(*volume, face->getTEOffset(), 
+							if (!face->prepareGeometryVolume(*sGeometryJobs.append(1), *volume, face->getTEOffset(), 
 								vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), face->getGeomIndex()))
 							{ //something's gone wrong with the vertex buffer accounting, rebuild this group 
+								sGeometryJobs.pop_back();
 								group->dirtyGeom();
 								gPipeline.markRebuild(group, TRUE);
 							}
@@ -5346,6 +5376,9 @@ void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
 			}
 		}
 		
+		LLFace::packGeometryVolumes(sGeometryJobs);
+		sGeometryJobs.resize(0);
+
 		for (LLVertexBuffer** iter = locked_buffer, ** end_iter = locked_buffer+buffer_count; iter != end_iter; ++iter)
 		{
 			(*iter)->flush();
@@ -6299,9 +6332,10 @@ void LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFac
 
 				llassert(!facep->isState(LLFace::RIGGED));
 
-				if (!facep->getGeometryVolume(*volume, te_idx, 
+				if (!facep->prepareGeometryVolume(*sGeometryJobs.append(1), *volume, te_idx, 
 					vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), index_offset,true))
 				{
+					sGeometryJobs.pop_back();
 					LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
 				}
 
@@ -6317,12 +6351,9 @@ void LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFac
 			++face_iter;
 		}
 
-		if(index_offset > 0)
-		{
-			buffer->validateRange(0,  index_offset - 1, indices_index, 0);
-		}
-
-		buffer->flush();
+		// Validated and flushed by pack_group_geometry(), once the faces are packed
+		LLPendingBufferFlush pending = { buffer, index_offset, indices_index };
+		sPendingFlushes.push_back(pending);
 	}
 
 	group->mBufferMap[mask].clear();
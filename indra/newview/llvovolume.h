@@ -131,7 +131,8 @@ public:
 
 				void	deleteFaces();
 
-				void	animateTextures();
+				// Sets the face texture matrices to a frame from LLViewerTextureAnim::animateTextures()
+				void	applyTextureAnimFrame(S32 result, F32 off_s, F32 off_t, F32 scale_s, F32 scale_t, F32 rot);
 	
 	            BOOL    isVisible() const ;
 	/*virtual*/ BOOL	isActive() const;
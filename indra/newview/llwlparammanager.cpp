@@ -487,6 +487,14 @@ void LLWLParamManager::update(LLViewerCamera * cam)
 
 	// update the shaders and the menu
 	propagateParameters();
+
+	// the sky values every windlight shader shares go to the GPU once, here
+	LLUniformBuffer* sky_buffer = LLViewerShaderMgr::instance()->getWindLightSkyBuffer();
+	if (sky_buffer && gPipeline.canUseWindLightShaders())
+	{
+		mCurParams.updateBuffer(*sky_buffer);
+		sky_buffer->update();
+	}
 	
 	// sync menus if they exist
 	if(LLFloaterWindLight::isOpen()) 
@@ -40,6 +40,7 @@
 #include "lluictrlfactory.h"
 #include "llsliderctrl.h"
 
+#include "llviewershadermgr.h"
 #include <llgl.h>
 
 #include <sstream>
@@ -70,6 +71,7 @@ static LLFastTimer::DeclareTimer FTM_WL_PARAM_UPDATE("WL Param Update");
 void LLWLParamSet::update(LLGLSLShader * shader) const 
 {	
 	LLFastTimer t(FTM_WL_PARAM_UPDATE);
+	const LLUniformBuffer* sky_buffer = LLViewerShaderMgr::instance()->getWindLightSkyBuffer();
 	LLSD::map_const_iterator i = mParamValues.beginMap();
 	std::vector<LLStaticHashedString>::const_iterator n = mParamHashedNames.begin();
 	for(;(i != mParamValues.endMap()) && (n != mParamHashedNames.end());++i, n++)
@@ -86,6 +88,11 @@ void LLWLParamSet::update(LLGLSLShader * shader) const
 		{
 			continue;
 		}
+
+		if (sky_buffer && sky_buffer->has(param))
+		{ //shared by every shader, see updateBuffer()
+			continue;
+		}
 		
 		if (param == sCloudDensity)
 		{
@@ -154,6 +161,34 @@ void LLWLParamSet::update(LLGLSLShader * shader) const
 	}
 }
 
+void LLWLParamSet::updateBuffer(LLUniformBuffer& buffer) const
+{
+	LLSD::map_const_iterator i = mParamValues.beginMap();
+	std::vector<LLStaticHashedString>::const_iterator n = mParamHashedNames.begin();
+	for(;(i != mParamValues.endMap()) && (n != mParamHashedNames.end());++i, n++)
+	{
+		if (!buffer.has(*n))
+		{
+			continue;
+		}
+
+		// Float members only take the first component, like the uniform1f() calls in update()
+		LLVector4 val;
+		if (i->second.isArray())
+		{
+			for (S32 k = 0; k < llmin((S32)i->second.size(), 4); ++k)
+			{
+				val.mV[k] = (F32) i->second[k].asReal();
+			}
+		}
+		else
+		{
+			val.mV[0] = (F32) i->second.asReal();
+		}
+		buffer.set(*n, val.mV);
+	}
+}
+
 void LLWLParamSet::set(const std::string& paramName, float x) 
 {	
 	// handle case where no array
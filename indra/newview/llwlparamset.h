@@ -42,6 +42,7 @@
 
 class LLWLParamSet;
 class LLGLSLShader;
+class LLUniformBuffer;
 
 /// A class representing a set of parameter values for the WindLight shaders.
 class LLWLParamSet {
@@ -66,8 +67,12 @@ public:
 	LLWLParamSet();
 
 	/// Update this set of shader uniforms from the parameter values.
+	/// Leaves out the ones that the windlight sky buffer carries.
 	void update(LLGLSLShader * shader) const;
 
+	/// Copy the parameter values that the buffer has members for.
+	void updateBuffer(LLUniformBuffer& buffer) const;
+
 	/// set the total llsd
 	void setAll(const LLSD& val);
 	
@@ -67,6 +67,7 @@
 #include "lldrawpoolwater.h"
 #include "llface.h"
 #include "llfeaturemanager.h"
+#include "llflexibleobject.h"
 #include "llfloatertelehub.h"
 #include "llframestats.h"
 #include "llgldbg.h"
@@ -206,6 +207,7 @@ LLFastTimer::DeclareTimer FTM_RENDER_DEFERRED("Deferred Shading");
 
 static LLFastTimer::DeclareTimer FTM_STATESORT_DRAWABLE("Sort Drawables");
 static LLFastTimer::DeclareTimer FTM_STATESORT_POSTSORT("Post Sort");
+static LLFastTimer::DeclareTimer FTM_STATESORT_RENDER_MAPS("Sort Render Maps");
 
 //static LLStaticHashedString sTint("tint");
 //static LLStaticHashedString sAmbiance("ambiance");
@@ -573,6 +575,7 @@ void LLPipeline::cleanup()
 
 	mAuxScreenRectVB = NULL;
 	mCubeVB = NULL;
+	mHiZOcclusion.cleanup();
 }
 
 //============================================================================
@@ -1021,6 +1024,7 @@ void LLPipeline::releaseScreenBuffers()
 	mDeferredDownsampledDepth.release();
 	mDeferredLight.release();
 	mOcclusionDepth.release();
+	mHiZOcclusion.release();
 	
 	//mHighlight.release();
 		
@@ -2258,6 +2262,11 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 
 	sCull->clear();
 
+	if (LLViewerCamera::sCurCameraID == LLViewerCamera::CAMERA_WORLD)
+	{ //finish last frame's Hi-Z tests before checkOcclusion() looks for them
+		mHiZOcclusion.resolve();
+	}
+
 	BOOL to_texture =	LLPipeline::sUseOcclusion > 1 &&
 						!hasRenderType(LLPipeline::RENDER_TYPE_HUD) && 
 						LLViewerCamera::sCurCameraID == LLViewerCamera::CAMERA_WORLD &&
@@ -2798,6 +2807,9 @@ void LLPipeline::updateGeom(F32 max_dtime)
 	// for now, only LLVOVolume does this to throttle LOD changes
 	LLVOVolume::preUpdateGeom();
 
+	// step the flexible prims queued this frame together, before their geometry is rebuilt below
+	LLVolumeImplFlexible::simulateQueued();
+
 	// Iterate through all drawables on the priority build queue,
 	for (LLDrawable::drawable_list_t::iterator iter = mBuildQ1.begin();
 		 iter != mBuildQ1.end();)
@@ -3742,9 +3754,16 @@ void LLPipeline::postSort(LLCamera& camera)
 	
 	mMeshDirtyGroup.clear();
 
+	static const LLCachedControl<bool> render_sort_batches("RenderSortBatches", true);
+	if (render_sort_batches)
+	{
+		LLFastTimer t(FTM_STATESORT_RENDER_MAPS);
+		sCull->sortRenderMaps(camera);
+	}
+
 	if (!sShadowRender)
 	{
-		std::sort(sCull->beginAlphaGroups(), sCull->endAlphaGroups(), LLSpatialGroup::CompareDepthGreater());
+		sCull->sortAlphaGroups();
 	}
 
 	LL_PUSH_CALLSTACKS();
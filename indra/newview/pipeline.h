@@ -47,6 +47,7 @@
 #include "lldrawable.h"
 #include "llrendertarget.h"
 #include "llfasttimer.h"
+#include "llhizocclusion.h"
 
 #include <stack>
 
@@ -111,6 +112,7 @@ extern LLFastTimer::DeclareTimer FTM_CLIENT_COPY;
 LL_ALIGN_PREFIX(16)
 class LLPipeline
 {
+	friend class LLHiZOcclusion;
 public:
 	LLPipeline();
 	~LLPipeline();
@@ -255,6 +257,8 @@ public:
 	void createObject(LLViewerObject* vobj);
 	void processPartitionQ();
 	void updateGeom(F32 max_dtime);
+	// Objects or drawables that createObjects() or updateGeom() left for a later frame
+	bool hasDeferredGeom() const { return !mCreateQ.empty() || !mBuildQ2.empty(); }
 	void updateGL();
 	void rebuildPriorityGroups();
 	void rebuildGroups();
@@ -613,6 +617,9 @@ public:
 	//utility buffer for rendering cubes, 8 vertices are corners of a cube [-1, 1]
 	LLPointer<LLVertexBuffer> mCubeVB;
 
+	//world camera occlusion against the previous frame's depth, when enabled
+	LLHiZOcclusion			mHiZOcclusion;
+
 private:
 	//sun shadow map
 	LLRenderTarget			mShadow[6];
@@ -18,6 +18,36 @@
 #include "llviewerprecompiledheaders.h"
 #include "sgmemstat.h"
 
+bool SGMemStat::havePoolStat() {
+	return LLPrivateMemoryPoolManager::isEnabled() && LLPrivateMemoryPoolManager::getInstance();
+}
+
+F32 SGMemStat::getPoolFragmentation() {
+	LLPrivateMemoryPoolManager* manager = LLPrivateMemoryPoolManager::getInstance();
+	if (!manager) return 0.f;
+	manager->updateStatistics();
+	if (!manager->mTotalReservedSize) return 0.f;
+	return 100.f * (1.f - (F32)manager->mTotalAllocatedSize / (F32)manager->mTotalReservedSize);
+}
+
+std::vector<std::string> SGMemStat::getPrintablePoolStats() {
+	static const char* const pool_names[LLPrivateMemoryPool::MAX_TYPES] = {
+		"static", "volatile", "static threaded", "volatile threaded"
+	};
+	std::vector<std::string> stats;
+	LLPrivateMemoryPoolManager* manager = LLPrivateMemoryPoolManager::getInstance();
+	if (!manager) return stats;
+	manager->updateStatistics();
+	for (S32 i = 0; i < LLPrivateMemoryPool::MAX_TYPES; ++i) {
+		const LLPrivateMemoryPool::Stats& pool = manager->mPoolStats[i];
+		if (!pool.mReservedSize) continue;
+		stats.push_back(llformat("%s pool: reserved %u KB, allocated %u KB, cached %u KB, %u spans, %u large, fragmentation %.1f%%",
+			pool_names[i], pool.mReservedSize / 1024, pool.mAllocatedSize / 1024, pool.mCachedSize / 1024,
+			pool.mSpanCount, pool.mLargeCount, pool.getFragmentation() * 100.f));
+	}
+	return stats;
+}
+
 #if (!LL_LINUX && !LL_USE_TCMALLOC)
 bool SGMemStat::haveStat() {
 	return false;
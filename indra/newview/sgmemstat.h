@@ -28,6 +28,15 @@ U32 getNumObjects();
 
 std::string getPrintableStat();
 
+// Private memory pools (LLPrivateMemoryPoolManager)
+bool havePoolStat();
+
+// Percentage of the memory reserved by all pools that is not in use.
+F32 getPoolFragmentation();
+
+// One line per pool in use.
+std::vector<std::string> getPrintablePoolStats();
+
 }
 
 #endif
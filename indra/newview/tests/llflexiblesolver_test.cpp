@@ -0,0 +1,405 @@
+/**
+ * @file llflexiblesolver_test.cpp
+ * @brief LLFlexibleSolver tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+#include "../test/lltestrandom.h"
+
+#include "../llflexibleobject.h"
+#include "../llflexiblesolver.h"
+#include "llformat.h"
+
+#include <vector>
+
+namespace tut
+{
+	// Positions and directions are within this many meters of the scalar step's
+	const F32 POSITION_TOLERANCE = 5.e-4f;
+	// The solver gets a quarter of the bend from half of it with square
+	// roots, which lose some precision on tiny bends.
+	const F32 ROTATION_TOLERANCE = 1.e-3f;
+
+	// The step of LLVolumeImplFlexible::doFlexibleUpdate() before
+	// LLFlexibleSolver, on a chain's inputs. Counts the sections whose bend
+	// it clamped.
+	static void ref_step(LLFlexibleSolver::Chain& chain, S32& clamped)
+	{
+		LLFlexibleObjectSection* section = chain.mSections;
+		const F32 section_length = chain.mSectionLength;
+		const F32 max_angle = chain.mMaxAngle;
+		LLQuaternion parentSegmentRotation = section[0].mRotation;
+		LLQuaternion deltaRotation;
+		LLVector3 lastPosition;
+
+		for (S32 i = 1; i <= chain.mNumSections; ++i)
+		{
+			LLVector3 parentSectionVector;
+			LLVector3 parentSectionPosition;
+			LLVector3 parentDirection;
+
+			lastPosition = section[i].mPosition;
+
+			// gravity, wind and user-defined force
+			section[i].mPosition.mV[2] -= chain.mGravity;
+			section[i].mPosition += chain.mWind[i] * chain.mWindFactor;
+			section[i].mPosition += chain.mUserForce;
+
+			// tension (rigidity, stiffness)
+			parentSectionPosition = section[i-1].mPosition;
+			parentDirection = section[i-1].mDirection;
+
+			if ( i == 1 )
+			{
+				parentSectionVector = section[0].mDirection;
+			}
+			else
+			{
+				parentSectionVector = section[i-2].mDirection;
+			}
+
+			LLVector3 currentVector = section[i].mPosition - parentSectionPosition;
+
+			LLVector3 difference = (parentSectionVector*section_length) - currentVector;
+			LLVector3 tensionForce = difference * chain.mTension;
+
+			section[i].mPosition += tensionForce;
+
+			// inertia
+			section[i].mPosition += section[i].mVelocity * chain.mMomentum;
+
+			// clamp length & rotation
+			section[i].mDirection = section[i].mPosition - parentSectionPosition;
+			section[i].mDirection.normVec();
+			deltaRotation.shortestArc( parentDirection, section[i].mDirection );
+
+			F32 angle;
+			LLVector3 axis;
+			deltaRotation.getAngleAxis(&angle, axis);
+			if (angle > F_PI) angle -= 2.f*F_PI;
+			if (angle < -F_PI) angle += 2.f*F_PI;
+			if (angle > max_angle)
+			{
+				deltaRotation.setQuat(max_angle, axis);
+				++clamped;
+			} else if (angle < -max_angle)
+			{
+				deltaRotation.setQuat(-max_angle, axis);
+				++clamped;
+			}
+			LLQuaternion segment_rotation = parentSegmentRotation * deltaRotation;
+			parentSegmentRotation = segment_rotation;
+
+			section[i].mDirection = (parentDirection * deltaRotation);
+			section[i].mPosition = parentSectionPosition + section[i].mDirection * section_length;
+			section[i].mRotation = segment_rotation;
+
+			if (i > 1)
+			{
+				// Propogate half the rotation up to the parent
+				LLQuaternion halfDeltaRotation(angle/2, axis);
+				section[i-1].mRotation = section[i-1].mRotation * halfDeltaRotation;
+			}
+
+			// calculate velocity
+			section[i].mVelocity = section[i].mPosition - lastPosition;
+			if (section[i].mVelocity.magVecSquared() > 1.f)
+			{
+				section[i].mVelocity.normVec();
+			}
+		}
+
+		chain.mEndRotation = parentSegmentRotation;
+	}
+
+	// A chain with room for the most sections
+	struct TestChain
+	{
+		LLFlexibleObjectSection mSections[FLEXIBLE_SOLVER_SECTIONS];
+		LLFlexibleSolver::Chain mChain;
+
+		TestChain()
+		{
+			mChain.mSections = mSections;
+		}
+
+		TestChain(const TestChain& other)
+		{
+			*this = other;
+		}
+
+		TestChain& operator=(const TestChain& other)
+		{
+			for (S32 i = 0; i < FLEXIBLE_SOLVER_SECTIONS; ++i)
+			{
+				mSections[i] = other.mSections[i];
+			}
+			mChain = other.mChain;
+			mChain.mSections = mSections;
+			return *this;
+		}
+	};
+
+	// q and -q are the same rotation
+	static F32 rotation_distance(const LLQuaternion& a, const LLQuaternion& b)
+	{
+		F32 same = 0.f;
+		F32 opposite = 0.f;
+		for (S32 i = 0; i < 4; ++i)
+		{
+			same = llmax(same, fabsf(a.mQ[i] - b.mQ[i]));
+			opposite = llmax(opposite, fabsf(a.mQ[i] + b.mQ[i]));
+		}
+		return llmin(same, opposite);
+	}
+
+	static void ensure_close(const std::string& msg, F32 error, F32 tolerance)
+	{
+		ensure(msg + llformat(" off by %g", error), error <= tolerance);
+	}
+
+	struct flexiblesolver
+	{
+		TestRandom mRandom;
+		LLFlexibleSolver mSolver;
+		S32 mClamped;		// Sections the scalar step clamped
+		S32 mStepped;		// Sections it stepped
+
+		flexiblesolver() : mClamped(0), mStepped(0) {}
+
+		F32 random(F32 low, F32 high)
+		{
+			return low + (F32)mRandom.nextReal(high - low);
+		}
+
+		LLVector3 randomVector(F32 range)
+		{
+			return LLVector3(random(-range, range), random(-range, range), random(-range, range));
+		}
+
+		LLQuaternion randomRotation()
+		{
+			LLQuaternion q(random(-1.f, 1.f), random(-1.f, 1.f), random(-1.f, 1.f), random(-1.f, 1.f));
+			q.normalize();
+			return q;
+		}
+
+		// A prim a few meters up in a region, hanging roughly along a random
+		// direction, with the coefficients doFlexibleUpdate() can come up with.
+		void makeChain(TestChain& test_chain, S32 num_sections)
+		{
+			LLFlexibleSolver::Chain& chain = test_chain.mChain;
+			chain.mNumSections = num_sections;
+			chain.mSectionLength = random(0.5f, 10.f) / (F32)num_sections;
+			chain.mTension = random(0.f, 0.5f);
+			chain.mMomentum = random(0.f, 1.f);
+			chain.mMaxAngle = atanf(chain.mSectionLength * 2.f);
+			chain.mGravity = random(-0.1f, 0.2f) * chain.mSectionLength;
+			chain.mUserForce = randomVector(0.2f) * chain.mSectionLength;
+			chain.mWindFactor = mRandom.next(2) ? random(0.f, 0.1f) * chain.mSectionLength : 0.f;
+			for (S32 i = 0; i < FLEXIBLE_SOLVER_SECTIONS; ++i)
+			{
+				chain.mWind[i] = randomVector(5.f);
+			}
+
+			LLVector3 direction = randomVector(1.f);
+			direction.normVec();
+			LLFlexibleObjectSection* sections = test_chain.mSections;
+			sections[0].mPosition = LLVector3(random(0.f, 256.f), random(0.f, 256.f), random(20.f, 40.f));
+			sections[0].mDirection = direction;
+			sections[0].mRotation = randomRotation();
+			for (S32 i = 1; i <= num_sections; ++i)
+			{
+				sections[i].mPosition = sections[i-1].mPosition + direction * chain.mSectionLength +
+										randomVector(0.5f * chain.mSectionLength);
+				sections[i].mVelocity = randomVector(0.8f);
+				sections[i].mDirection = direction;
+				sections[i].mRotation = randomRotation();
+			}
+		}
+
+		// A still chain with no forces on it: the sections go from the anchor
+		// along step, and the anchor points along direction.
+		void makeStraightChain(TestChain& test_chain, const LLVector3& direction, const LLVector3& step)
+		{
+			const S32 num_sections = 4;
+			LLFlexibleSolver::Chain& chain = test_chain.mChain;
+			chain.mNumSections = num_sections;
+			chain.mSectionLength = 0.25f;
+			chain.mTension = 0.f;
+			chain.mMomentum = 0.f;
+			chain.mMaxAngle = atanf(chain.mSectionLength * 2.f);
+			chain.mGravity = 0.f;
+			chain.mUserForce.clear();
+			chain.mWindFactor = 0.f;
+			for (S32 i = 0; i < FLEXIBLE_SOLVER_SECTIONS; ++i)
+			{
+				chain.mWind[i].clear();
+			}
+
+			LLFlexibleObjectSection* sections = test_chain.mSections;
+			sections[0].mPosition.setVec(128.f, 128.f, 32.f);
+			sections[0].mDirection = direction;
+			sections[0].mRotation = LLQuaternion::DEFAULT;
+			for (S32 i = 1; i <= num_sections; ++i)
+			{
+				sections[i].mPosition = sections[i-1].mPosition + step;
+				sections[i].mVelocity.clear();
+				sections[i].mDirection = direction;
+				sections[i].mRotation = LLQuaternion::DEFAULT;
+			}
+		}
+
+		// Steps the chains steps times with both the scalar step and the
+		// solver, from the solver's last state each time.
+		void ensureSteps(const std::string& what, std::vector<TestChain>& chains, S32 steps)
+		{
+			for (S32 step = 0; step < steps; ++step)
+			{
+				std::vector<TestChain> expected(chains);
+				for (size_t c = 0; c < expected.size(); ++c)
+				{
+					ref_step(expected[c].mChain, mClamped);
+					mStepped += expected[c].mChain.mNumSections;
+					mSolver.addChain(&chains[c].mChain);
+				}
+				mSolver.solve(false);
+				ensure_equals(what + ": chains left", mSolver.getChainCount(), 0);
+
+				for (size_t c = 0; c < chains.size(); ++c)
+				{
+					const LLFlexibleSolver::Chain& e = expected[c].mChain;
+					const LLFlexibleSolver::Chain& a = chains[c].mChain;
+					const std::string where = what + llformat(", step %d, chain %d of %d", step, (S32)c, (S32)chains.size());
+					for (S32 i = 1; i <= e.mNumSections; ++i)
+					{
+						const LLFlexibleObjectSection& es = e.mSections[i];
+						const LLFlexibleObjectSection& as = a.mSections[i];
+						const std::string section = where + llformat(", section %d of %d: ", i, e.mNumSections);
+						ensure_close(section + "position", dist_vec(es.mPosition, as.mPosition), POSITION_TOLERANCE);
+						ensure_close(section + "direction", dist_vec(es.mDirection, as.mDirection), POSITION_TOLERANCE);
+						ensure_close(section + "velocity", dist_vec(es.mVelocity, as.mVelocity), POSITION_TOLERANCE);
+						ensure_close(section + "rotation", rotation_distance(es.mRotation, as.mRotation), ROTATION_TOLERANCE);
+					}
+					ensure_close(where + ": end rotation", rotation_distance(e.mEndRotation, a.mEndRotation), ROTATION_TOLERANCE);
+				}
+			}
+		}
+	};
+
+	typedef test_group<flexiblesolver> flexiblesolver_t;
+	typedef flexiblesolver_t::object flexiblesolver_object_t;
+	tut::flexiblesolver_t tut_flexiblesolver("LLFlexibleSolver");
+
+	template<> template<>
+	void flexiblesolver_object_t::test<1>()
+	{
+		// Every section count, with one to three lanes of a packet in use,
+		// a full packet, and a full packet and part of another.
+		const S32 counts[] = { 1, 2, 3, 4, 5, 9 };
+		for (S32 sections = 1; sections < FLEXIBLE_SOLVER_SECTIONS; sections *= 2)
+		{
+			for (S32 n = 0; n < (S32)LL_ARRAY_SIZE(counts); ++n)
+			{
+				std::vector<TestChain> chains(counts[n]);
+				for (S32 c = 0; c < counts[n]; ++c)
+				{
+					makeChain(chains[c], sections);
+				}
+				ensureSteps(llformat("%d sections", sections), chains, 10);
+			}
+		}
+		// Both sides of mMaxAngle came up
+		ensure("some sections clamped", mClamped > 0);
+		ensure("some sections not clamped", mClamped < mStepped);
+	}
+
+	template<> template<>
+	void flexiblesolver_object_t::test<2>()
+	{
+		// Prims of every length stepped together: the solver groups them by length.
+		std::vector<TestChain> chains(23);
+		for (S32 c = 0; c < (S32)chains.size(); ++c)
+		{
+			makeChain(chains[c], 1 << mRandom.next(FLEXIBLE_OBJECT_MAX_SECTIONS + 1));
+		}
+		ensureSteps("mixed lengths", chains, 10);
+	}
+
+	template<> template<>
+	void flexiblesolver_object_t::test<3>()
+	{
+		// Sections exactly in line with their parent, exactly turned back along
+		// Z and along X, and on top of their parent, next to a bent chain in
+		// the same packet.
+		std::vector<TestChain> chains(5);
+		makeStraightChain(chains[0], LLVector3::z_axis, LLVector3(0.f, 0.f, 0.25f));
+		makeStraightChain(chains[1], LLVector3::z_axis, LLVector3(0.f, 0.f, -0.25f));
+		makeChain(chains[2], 4);
+		makeStraightChain(chains[3], LLVector3::z_axis, LLVector3::zero);
+		makeStraightChain(chains[4], LLVector3::x_axis, LLVector3(-0.25f, 0.f, 0.f));
+		ensureSteps("(anti)parallel", chains, 1);
+
+		// The parallel chain doesn't move, the ones turned back bend by mMaxAngle.
+		for (S32 i = 1; i <= 4; ++i)
+		{
+			ensure_close(llformat("parallel section %d", i),
+							dist_vec(chains[0].mSections[i].mPosition, LLVector3(128.f, 128.f, 32.f + 0.25f * i)), POSITION_TOLERANCE);
+		}
+		const F32 max_angle = chains[1].mChain.mMaxAngle;
+		ensure_close("turned back along Z", fabsf(angle_between(chains[1].mSections[1].mDirection, LLVector3::z_axis) - max_angle), POSITION_TOLERANCE);
+		ensure_close("turned back along X", fabsf(angle_between(chains[4].mSections[1].mDirection, LLVector3::x_axis) - max_angle), POSITION_TOLERANCE);
+
+		ensureSteps("(anti)parallel, later steps", chains, 5);
+	}
+
+	template<> template<>
+	void flexiblesolver_object_t::test<4>()
+	{
+		// Chains zig-zagging sideways bend every section past mMaxAngle at first.
+		const LLVector3 sideways[] = { LLVector3::x_axis, LLVector3::y_axis, LLVector3(0.6f, -0.8f, 0.f) };
+		std::vector<TestChain> chains(5);
+		for (S32 c = 0; c < (S32)chains.size(); ++c)
+		{
+			makeStraightChain(chains[c], LLVector3::z_axis, LLVector3(0.f, 0.f, 0.25f));
+			LLFlexibleObjectSection* sections = chains[c].mSections;
+			for (S32 i = 1; i <= chains[c].mChain.mNumSections; ++i)
+			{
+				sections[i].mPosition += sideways[c % LL_ARRAY_SIZE(sideways)] * (i % 2 ? 0.5f : -0.5f);
+			}
+		}
+		ensureSteps("zig-zag", chains, 1);
+		ensure_equals("every section clamped", mClamped, mStepped);
+
+		ensureSteps("zig-zag, later steps", chains, 5);
+	}
+}
@@ -0,0 +1,134 @@
+/** 
+ * @file llframebudget_test.cpp
+ * @brief LLFrameBudget tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ * 
+ * Copyright (c) 2026, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llframebudget.h"
+
+namespace tut
+{
+	struct framebudget
+	{
+		LLFrameBudget mBudget;
+
+		// Runs frames in which the rest of the frame takes other_time and every
+		// consumer uses used[i] and defers if deferred[i].
+		void runFrames(S32 frames, F32 target_fps, F32 other_time, const F32* used, const bool* deferred)
+		{
+			for (S32 frame = 0; frame < frames; ++frame)
+			{
+				F32 frame_time = other_time;
+				for (S32 i = 0; i < LLFrameBudget::NUM_CONSUMERS; ++i)
+				{
+					frame_time += used[i];
+				}
+				mBudget.beginFrame(target_fps, frame_time);
+				for (S32 i = 0; i < LLFrameBudget::NUM_CONSUMERS; ++i)
+				{
+					mBudget.report((LLFrameBudget::EConsumer)i, used[i], deferred[i]);
+				}
+			}
+		}
+
+		F32 slice(LLFrameBudget::EConsumer consumer) const
+		{
+			return mBudget.getSlice(consumer);
+		}
+	};
+
+	typedef test_group<framebudget> framebudget_t;
+	typedef framebudget_t::object framebudget_object_t;
+	tut::framebudget_t tut_framebudget("LLFrameBudget");
+
+	template<> template<>
+	void framebudget_object_t::test<1>()
+	{
+		// Spare time goes to the consumers by priority, never below a minimum or above a maximum.
+		const F32 used[LLFrameBudget::NUM_CONSUMERS] = { 0.006f, 0.f, 0.008f, 0.008f, 0.f };
+		const bool deferred[LLFrameBudget::NUM_CONSUMERS] = { false, false, false, false, false };
+		// 60 fps with 4 ms for the rest of the frame leaves 12.7 ms. The minimums
+		// take 10 ms; the network wants 2.5 ms more and geometry 8 ms more.
+		runFrames(300, 60.f, 0.004f, used, deferred);
+
+		const F32 pool = 1.f / 60.f - 0.004f;
+		ensure_approximately_equals("pool", mBudget.getPool(), pool, 20);
+		ensure_approximately_equals("network gets what it uses", slice(LLFrameBudget::NETWORK), 0.0075f, 20);
+		ensure_approximately_equals("idle state machines keep their minimum", slice(LLFrameBudget::STATE_MACHINES), 0.001f, 20);
+		ensure_approximately_equals("geometry gets the rest", slice(LLFrameBudget::GEOMETRY), pool - 0.0075f - 0.001f - 0.002f, 20);
+		ensure_approximately_equals("images are out of luck", slice(LLFrameBudget::IMAGES), 0.002f, 20);
+		ensure_equals("workers keep their minimum", slice(LLFrameBudget::WORKERS), 0.f);
+
+		// Without a target every consumer gets what it wants.
+		runFrames(1, 0.f, 0.004f, used, deferred);
+		ensure_approximately_equals("geometry without a target", slice(LLFrameBudget::GEOMETRY), 0.01f, 20);
+		ensure_approximately_equals("images without a target", slice(LLFrameBudget::IMAGES), 0.01f, 20);
+	}
+
+	template<> template<>
+	void framebudget_object_t::test<2>()
+	{
+		// On a machine that misses the target, a consumer that falls behind
+		// still gets a growing slice until it catches up.
+		F32 used[LLFrameBudget::NUM_CONSUMERS] = { 0.f, 0.f, 0.f, 0.f, 0.f };
+		bool deferred[LLFrameBudget::NUM_CONSUMERS] = { false, false, false, false, false };
+		runFrames(300, 60.f, 0.030f, used, deferred);
+		ensure_approximately_equals("no spare time", mBudget.getPool(), 0.010f, 20);
+		ensure_approximately_equals("network at its minimum", slice(LLFrameBudget::NETWORK), 0.005f, 20);
+
+		// The frame in which the messages pile up.
+		deferred[LLFrameBudget::NETWORK] = true;
+		used[LLFrameBudget::NETWORK] = slice(LLFrameBudget::NETWORK);
+		runFrames(1, 60.f, 0.030f, used, deferred);
+		F32 last = slice(LLFrameBudget::NETWORK);
+		S32 frames = 0;
+		while (last < 0.100f && frames < 100)
+		{
+			used[LLFrameBudget::NETWORK] = last;
+			runFrames(1, 60.f, 0.030f, used, deferred);
+			ensure("network slice grows", slice(LLFrameBudget::NETWORK) > last);
+			last = slice(LLFrameBudget::NETWORK);
+			++frames;
+		}
+		ensure("network reaches its maximum", frames < 100);
+		ensure_approximately_equals("network maximum", last, 0.100f, 20);
+		ensure("past the target", mBudget.getPool() > 1.f / 60.f);
+		ensure_approximately_equals("others keep their minimum", slice(LLFrameBudget::GEOMETRY), 0.002f, 20);
+
+		// Caught up: back to what it uses.
+		deferred[LLFrameBudget::NETWORK] = false;
+		used[LLFrameBudget::NETWORK] = 0.f;
+		runFrames(300, 60.f, 0.030f, used, deferred);
+		ensure_approximately_equals("network back at its minimum", slice(LLFrameBudget::NETWORK), 0.005f, 20);
+	}
+}
@@ -0,0 +1,385 @@
+/**
+ * @file llbenchmark_tut.cpp
+ * @date 2026-10
+ * @brief Timing benchmarks, run with --benchmark
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llmath.h"
+#include "llimageresample.h"
+#include "llmatrix4a.h"
+#include "llsd.h"
+#include "llsdarena.h"
+#include "llsdserialize.h"
+#include "llterraincomposite.h"
+#include "llthreadpool.h"
+#include "lltimer.h"
+#include "llvertexpack.h"
+#include "v2math.h"
+#include "llfetchdescendentsreply.h"
+#include "lltestrandom.h"
+#include "lltut.h"
+#include "test.h"
+
+#include <sstream>
+#include <vector>
+
+namespace tut
+{
+	// The timing runs for code that replaced slower code. They log what
+	// they measure and check nothing; the unit tests of that code check
+	// that it gives the same results. They only run with --benchmark.
+	struct benchmark_test
+	{
+	};
+
+	typedef test_group<benchmark_test> benchmark_t;
+	typedef benchmark_t::object benchmark_object_t;
+	tut::benchmark_t tut_benchmark("benchmark");
+
+	template<> template<>
+	void benchmark_object_t::test<1>()
+	{
+		// Parse and release a large FetchInventoryDescendents2 reply as LLSD
+		// and as an arena document.
+		if (!sRunBenchmarks) return;
+
+		LLSD response = make_fetch_descendents_response(100, 50);
+		std::ostringstream bin, xml;
+		LLSDSerialize::toBinary(response, bin);
+		LLSDSerialize::toXML(response, xml);
+		const std::string bin_data = bin.str();
+		const std::string xml_data = xml.str();
+		const S32 ROUNDS = 5;
+
+		LLTimer timer;
+		for (S32 i = 0; i < ROUNDS; ++i)
+		{
+			std::istringstream istr(bin_data);
+			LLSD sd;
+			LLSDSerialize::fromBinary(sd, istr, bin_data.size());
+		}
+		F64 binary_llsd = timer.getElapsedTimeF64() / ROUNDS;
+
+		timer.reset();
+		for (S32 i = 0; i < ROUNDS; ++i)
+		{
+			std::istringstream istr(bin_data);
+			LLPointer<LLSDArena> arena = new LLSDArena;
+			LLSDSerialize::fromBinary(*arena, istr, bin_data.size());
+		}
+		F64 binary_arena = timer.getElapsedTimeF64() / ROUNDS;
+
+		timer.reset();
+		for (S32 i = 0; i < ROUNDS; ++i)
+		{
+			std::istringstream istr(xml_data);
+			LLSD sd;
+			LLSDSerialize::fromXML(sd, istr);
+		}
+		F64 xml_llsd = timer.getElapsedTimeF64() / ROUNDS;
+
+		timer.reset();
+		for (S32 i = 0; i < ROUNDS; ++i)
+		{
+			std::istringstream istr(xml_data);
+			LLPointer<LLSDArena> arena = new LLSDArena;
+			LLSDSerialize::fromXML(*arena, istr);
+		}
+		F64 xml_arena = timer.getElapsedTimeF64() / ROUNDS;
+
+		LL_INFOS() << "FetchInventoryDescendents2 reply, 5000 items ("
+			<< bin_data.size() << " bytes binary, " << xml_data.size() << " bytes xml):"
+			<< " binary LLSD " << binary_llsd * 1000.0 << " ms, arena " << binary_arena * 1000.0 << " ms;"
+			<< " xml LLSD " << xml_llsd * 1000.0 << " ms, arena " << xml_arena * 1000.0 << " ms" << LL_ENDL;
+	}
+
+	template<> template<>
+	void benchmark_object_t::test<2>()
+	{
+		// Box filter and mip chain of 1024 and 2048 square RGBA images, on
+		// the calling thread and fanned out to three workers. The mip chain
+		// is also built one generateMip() level at a time.
+		if (!sRunBenchmarks) return;
+
+		const S32 ROUNDS = 3;
+		for (S32 size = 1024; size <= 2048; size *= 2)
+		{
+			std::vector<U8> in(size * size * 4);
+			TestRandom random;
+			for (size_t i = 0; i < in.size(); ++i)
+			{
+				in[i] = (U8)random.nextU32();
+			}
+			std::vector<U8> out((size / 2) * (size / 3) * 4);
+
+			std::vector<U8> mip_buffer(size * size * 4 / 3);
+			std::vector<U8*> mips;
+			for (S32 level = 1, offset = 0; (size >> level) >= 4; ++level)
+			{
+				mips.push_back(&mip_buffer[offset]);
+				offset += (size >> level) * (size >> level) * 4;
+			}
+			const S32 levels = (S32)mips.size();
+
+			for (S32 workers = 0; workers <= 3; workers += 3)
+			{
+				LLThreadPool::initClass(workers);
+
+				LLTimer timer;
+				for (S32 i = 0; i < ROUNDS; ++i)
+				{
+					LLImageResample::scale(&in[0], size, size, &out[0], size / 2, size / 3, 4);
+				}
+				F64 scale_time = timer.getElapsedTimeF64() / ROUNDS;
+
+				timer.reset();
+				for (S32 i = 0; i < ROUNDS; ++i)
+				{
+					const U8* prev = &in[0];
+					for (S32 level = 1; level <= levels; ++level)
+					{
+						LLImageResample::generateMip(prev, mips[level - 1], size >> level, size >> level, 4);
+						prev = mips[level - 1];
+					}
+				}
+				F64 mip_time = timer.getElapsedTimeF64() / ROUNDS;
+
+				timer.reset();
+				for (S32 i = 0; i < ROUNDS; ++i)
+				{
+					LLImageResample::generateMipChain(&in[0], size, size, 4, &mips[0], levels);
+				}
+				F64 chain_time = timer.getElapsedTimeF64() / ROUNDS;
+
+				LLThreadPool::cleanupClass();
+
+				LL_INFOS() << size << "x" << size << " RGBA with " << workers << " workers:"
+					<< " scale " << scale_time * 1000.0 << " ms; mips level by level " << mip_time * 1000.0
+					<< " ms, as a chain " << chain_time * 1000.0 << " ms" << LL_ENDL;
+			}
+		}
+	}
+
+	template<> template<>
+	void benchmark_object_t::test<3>()
+	{
+		// The LLVertexPack kernels over a typical prim face (a 25 x 25 grid)
+		// and a large mesh face, with a texture transform, as a full rebuild
+		// of the face runs them.
+		if (!sRunBenchmarks) return;
+
+		LLMatrix4a mat;
+		mat.setRows(LLVector4a(0.9f, 0.3f, -0.2f, 0.f),
+					LLVector4a(-0.6f, 0.7f, 0.4f, 0.f),
+					LLVector4a(0.5f, -0.1f, 1.8f, 0.f));
+		mat.getRow<3>().set(1.5f, -2.f, 12.f, 1.f);
+
+		const S32 sizes[] = { 625, 21000 };
+		for (S32 s = 0; s < (S32)LL_ARRAY_SIZE(sizes); ++s)
+		{
+			const S32 count = sizes[s];
+			const S32 rounds = 4000000 / count;
+			// Source and packed streams, each padded to whole vectors of four
+			const S32 stream = (count + 3) & ~3;
+			LLVector4a* src = (LLVector4a*) ll_aligned_malloc_16(stream * 3 * sizeof(LLVector4a));
+			LLVector4a* dst = (LLVector4a*) ll_aligned_malloc_16(stream * 3 * sizeof(LLVector4a));
+			LLVector4a* positions = src;
+			LLVector4a* normals = src + stream;
+			LLVector4a* tangents = src + stream * 2;
+			std::vector<LLVector2> src_tex_coords(count);
+			std::vector<LLVector2> tex_coords(count);
+			std::vector<LLVector2> planar_coords(count);
+			TestRandom random;
+			for (S32 i = 0; i < count; ++i)
+			{
+				F32 r[8];
+				for (S32 j = 0; j < 8; ++j)
+				{
+					r[j] = (F32)random.nextReal(1.0);
+				}
+				positions[i].set(r[0] - 0.5f, r[1] - 0.5f, r[2] - 0.5f, 1.f);
+				normals[i].set(r[3] * 2.f - 1.f, r[4] * 2.f - 1.f, r[5] * 2.f - 1.f);
+				normals[i].normalize3fast();
+				tangents[i].set(r[5] * 2.f - 1.f, r[3] * 2.f - 1.f, r[4] * 2.f - 1.f, i % 2 ? 1.f : -1.f);
+				src_tex_coords[i].set(r[6], r[7]);
+			}
+
+			LLVertexPack::TexCoordParams params;
+			params.mTexCoords = &src_tex_coords[0];
+			params.mPositions = positions;
+			params.mNormals = normals;
+			params.mScale[0] = 2.5f;
+			params.mScale[1] = 0.75f;
+			params.mScale[2] = 1.25f;
+			params.mMatrix = &mat;
+			params.mCos = cosf(0.7f);
+			params.mSin = sinf(0.7f);
+			params.mOffsetS = 0.125f;
+			params.mOffsetT = -0.3f;
+			params.mScaleS = 3.f;
+			params.mScaleT = 0.6f;
+			const LLVertexPack::texcoord_kernel_t xform_kernel = LLVertexPack::getTexCoordKernel(false, LLVertexPack::TC_XFORM);
+			const LLVertexPack::texcoord_kernel_t planar_kernel = LLVertexPack::getTexCoordKernel(true, LLVertexPack::TC_XFORM);
+
+			LLTimer timer;
+			for (S32 r = 0; r < rounds; ++r)
+			{
+				LLVertexPack::transformPositions(mat, positions, count, 3, dst, stream);
+				LLVertexPack::rotateNormals(mat, normals, count, dst + stream);
+				LLVertexPack::rotateTangents(mat, tangents, count, dst + stream * 2);
+				xform_kernel(params, count, &tex_coords[0]);
+				planar_kernel(params, count, &planar_coords[0]);
+			}
+			const F64 time = timer.getElapsedTimeF64() / rounds;
+
+			LL_INFOS() << count << " vertex face: " << time * 1000000.0 << " us, "
+					   << time * 1000000000.0 / count << " ns per vertex" << LL_ENDL;
+
+			ll_aligned_free_16(src);
+			ll_aligned_free_16(dst);
+		}
+	}
+
+	struct TerrainNoiseRows
+	{
+		F32* mNoise;
+		S32 mWidth;
+
+		void operator()(S32 begin, S32 end) const
+		{
+			LLTerrainComposite::generateNoise(256000.f, 256768.f, 1.f, mWidth, begin, end, mNoise);
+		}
+	};
+
+	struct TerrainPatchBlend
+	{
+		const LLTerrainComposite::BlendParams* mParams;
+		S32 mPatchesPerEdge;
+		S32 mPatchTexels;
+
+		void operator()(S32 begin, S32 end) const
+		{
+			for (S32 p = begin; p < end; p++)
+			{
+				S32 x = (p % mPatchesPerEdge) * mPatchTexels;
+				S32 y = (p / mPatchesPerEdge) * mPatchTexels;
+				LLTerrainComposite::blend(*mParams, x, y, x + mPatchTexels, y + mPatchTexels);
+			}
+		}
+	};
+
+	template<> template<>
+	void benchmark_object_t::test<4>()
+	{
+		// LLTerrainComposite: the noise and the surface texture of a 256m
+		// region, the texture patch by patch as the region updates it.
+		if (!sRunBenchmarks) return;
+
+		const S32 width = 256;
+		const S32 detail_size = 128;
+		const S32 patches_per_edge = 16;
+		const S32 patch_texels = 16;
+		const S32 rounds = 20;
+
+		std::vector<F32> noise(width * width);
+		std::vector<F32> composition(width * width);
+		std::vector<U8> detail[4];
+		std::vector<U8> texture(width * width * 3);
+		TestRandom random;
+		for (S32 j = 0; j < width; j++)
+		{
+			for (S32 i = 0; i < width; i++)
+			{
+				composition[j * width + i] = 1.5f + 1.7f * sinf(i * 0.05f) * cosf(j * 0.031f);
+			}
+		}
+
+		// As LLVLComposition::generateTexture() sets them up, with the default texture scale of 16.
+		LLTerrainComposite::BlendParams params;
+		for (S32 d = 0; d < 4; d++)
+		{
+			detail[d].resize(detail_size * detail_size * 3);
+			for (size_t n = 0; n < detail[d].size(); n++)
+			{
+				detail[d][n] = (U8)random.nextU32();
+			}
+			params.mDetail[d] = &detail[d][0];
+			params.mDetailSize[d] = (S32)detail[d].size();
+		}
+		params.mComposition = &composition[0];
+		params.mCompositionWidth = width;
+		params.mCompositionScaleInv = 1.f;
+		params.mDetailWidth = detail_size;
+		params.mDetailHeight = detail_size;
+		params.mDetailStrideX = (F32)detail_size / 16.f;
+		params.mDetailStrideY = params.mDetailStrideX;
+		params.mTexelSizeX = 1.f;
+		params.mTexelSizeY = 1.f;
+		params.mDst = &texture[0];
+		params.mDstStride = width * 3;
+
+		TerrainNoiseRows noise_rows;
+		noise_rows.mNoise = &noise[0];
+		noise_rows.mWidth = width;
+		TerrainPatchBlend patch_blend;
+		patch_blend.mParams = &params;
+		patch_blend.mPatchesPerEdge = patches_per_edge;
+		patch_blend.mPatchTexels = patch_texels;
+		const S32 patches = patches_per_edge * patches_per_edge;
+
+		for (S32 workers = 0; workers <= 3; workers += 3)
+		{
+			LLThreadPool::initClass(workers);
+
+			LLTimer timer;
+			for (S32 r = 0; r < rounds; r++)
+			{
+				LLThreadPool::parallelFor(width, 16, noise_rows);
+			}
+			const F64 noise_time = timer.getElapsedTimeF64() / rounds;
+
+			timer.reset();
+			for (S32 r = 0; r < rounds; r++)
+			{
+				LLThreadPool::parallelFor(patches, 4, patch_blend);
+			}
+			const F64 blend_time = timer.getElapsedTimeF64() / rounds;
+
+			LL_INFOS() << "256m region with " << LLThreadPool::getWorkerCount() << " workers:"
+					   << " noise " << noise_time * 1000.0 << " ms, surface texture "
+					   << blend_time * 1000.0 << " ms" << LL_ENDL;
+
+			LLThreadPool::cleanupClass();
+		}
+	}
+}
@@ -0,0 +1,118 @@
+/**
+ * @file llfasttimertrace_tut.cpp
+ * @date 2026-10
+ * @brief LLFastTimerTrace unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llfasttimertrace.h"
+#include "llthread.h"
+#include "lltimer.h"
+#include "lltut.h"
+
+#include <sstream>
+
+namespace tut
+{
+	static LLFastTimer::DeclareTimer FTM_TRACE_TEST_MAIN("Trace Test Main");
+	static LLFastTimer::DeclareTimer FTM_TRACE_TEST_WORKER("Trace Test Worker");
+
+	class TraceTestThread : public LLThread
+	{
+	public:
+		TraceTestThread() : LLThread("Trace Test Thread") { }
+
+	protected:
+		/*virtual*/ void run()
+		{
+			LLFastTimer t(FTM_TRACE_TEST_WORKER);
+			ms_sleep(1);
+		}
+	};
+
+	struct fasttimertrace_test
+	{
+	};
+
+	typedef test_group<fasttimertrace_test> fasttimertrace_t;
+	typedef fasttimertrace_t::object fasttimertrace_object_t;
+	tut::fasttimertrace_t tut_fasttimertrace("fasttimertrace");
+
+	template<> template<>
+	void fasttimertrace_object_t::test<1>()
+	{
+		// Scopes on the main thread and on another thread each land on their own timeline.
+		LLFastTimerTrace::start();
+		{
+			LLFastTimer t(FTM_TRACE_TEST_MAIN);
+			TraceTestThread* thread = new TraceTestThread;
+			thread->start();
+			while (!thread->isStopped())
+			{
+				ms_sleep(1);
+			}
+			delete thread;
+		}
+		LLFastTimerTrace::stop();
+
+		std::ostringstream os;
+		LLFastTimerTrace::write(os);
+		const std::string trace = os.str();
+		ensure("trace-event document", trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+		ensure("main thread named", trace.find("\"args\":{\"name\":\"main thread\"}") != std::string::npos);
+		ensure("worker thread named", trace.find("\"args\":{\"name\":\"Trace Test Thread\"}") != std::string::npos);
+		ensure("main thread scope", trace.find("\"name\":\"Trace Test Main\",\"ph\":\"X\"") != std::string::npos);
+		ensure("worker thread scope", trace.find("\"name\":\"Trace Test Worker\",\"ph\":\"X\"") != std::string::npos);
+	}
+
+	template<> template<>
+	void fasttimertrace_object_t::test<2>()
+	{
+		// Interned names are copies and get escaped; nothing is recorded outside a capture.
+		LLFastTimerTrace::start();
+		{
+			std::string name("Machine \"quoted\"");
+			LLFastTimerTrace::Scope scope(LLFastTimerTrace::intern(name.c_str()));
+			name = "overwritten";
+		}
+		LLFastTimerTrace::stop();
+		{
+			LLFastTimerTrace::Scope scope("After Stop");
+		}
+
+		std::ostringstream os;
+		LLFastTimerTrace::write(os);
+		const std::string trace = os.str();
+		ensure("escaped name", trace.find("\"name\":\"Machine \\\"quoted\\\"\"") != std::string::npos);
+		ensure("no events after stop", trace.find("After Stop") == std::string::npos);
+	}
+}
@@ -0,0 +1,114 @@
+/**
+ * @file llfetchdescendentsreply.h
+ * @date 2026-10
+ * @brief Synthetic FetchInventoryDescendents2 replies for tests and benchmarks
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFETCHDESCENDENTSREPLY_H
+#define LL_LLFETCHDESCENDENTSREPLY_H
+
+#include "llsd.h"
+#include "llformat.h"
+#include "lluuid.h"
+
+namespace tut
+{
+	// Builds a response shaped like the FetchInventoryDescendents2
+	// capability reply: one entry per requested folder, each with its
+	// items (permissions and sale info included) and sub categories.
+	inline LLSD make_fetch_descendents_response(S32 folders, S32 items_per_folder)
+	{
+		LLSD response = LLSD::emptyMap();
+		LLSD& folder_list = response["folders"];
+		folder_list = LLSD::emptyArray();
+		LLUUID agent_id("0b0bd9b4-4d8e-4f2a-9ab8-8c1dbb0b4e9e");
+		for (S32 f = 0; f < folders; ++f)
+		{
+			LLUUID folder_id;
+			folder_id.generate(llformat("folder%d", f));
+			LLSD folder;
+			folder["folder_id"] = folder_id;
+			folder["owner_id"] = agent_id;
+			folder["agent_id"] = agent_id;
+			folder["version"] = f + 3;
+			folder["descendents"] = items_per_folder + 2;
+			LLSD& items = folder["items"];
+			items = LLSD::emptyArray();
+			for (S32 i = 0; i < items_per_folder; ++i)
+			{
+				LLUUID item_id, asset_id;
+				item_id.generate(llformat("item%d.%d", f, i));
+				asset_id.generate(llformat("asset%d.%d", f, i));
+				LLSD item;
+				item["item_id"] = item_id;
+				item["parent_id"] = folder_id;
+				item["asset_id"] = asset_id;
+				item["name"] = llformat("Object %d in folder %d", i, f);
+				item["desc"] = "(No Description)";
+				item["type"] = 6;
+				item["inv_type"] = 6;
+				item["flags"] = 0;
+				item["created_at"] = 1300000000 + i;
+				LLSD& perms = item["permissions"];
+				perms["creator_id"] = agent_id;
+				perms["owner_id"] = agent_id;
+				perms["last_owner_id"] = agent_id;
+				perms["group_id"] = LLUUID::null;
+				perms["base_mask"] = (S32)0x7fffffff;
+				perms["owner_mask"] = (S32)0x7fffffff;
+				perms["group_mask"] = 0;
+				perms["everyone_mask"] = 0;
+				perms["next_owner_mask"] = 0x82000;
+				perms["is_owner_group"] = false;
+				LLSD& sale = item["sale_info"];
+				sale["sale_price"] = 10;
+				sale["sale_type"] = 0;
+				items.append(item);
+			}
+			LLSD& categories = folder["categories"];
+			categories = LLSD::emptyArray();
+			for (S32 c = 0; c < 2; ++c)
+			{
+				LLUUID category_id;
+				category_id.generate(llformat("category%d.%d", f, c));
+				LLSD category;
+				category["category_id"] = category_id;
+				category["parent_id"] = folder_id;
+				category["name"] = llformat("Sub folder %d", c);
+				category["type_default"] = -1;
+				categories.append(category);
+			}
+			folder_list.append(folder);
+		}
+		return response;
+	}
+}
+
+#endif // LL_LLFETCHDESCENDENTSREPLY_H
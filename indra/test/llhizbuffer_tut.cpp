@@ -0,0 +1,277 @@
+/**
+ * @file llhizbuffer_tut.cpp
+ * @date 2026-10
+ * @brief LLHiZBuffer unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llhizbuffer.h"
+#include "llformat.h"
+#include "lltestrandom.h"
+#include "lltut.h"
+
+#include <vector>
+
+namespace tut
+{
+	// The test scene: a 160 x 90 depth buffer seen through a 60 degree
+	// perspective from the origin, looking down -z. Everything is sky except
+	// for a wall at z = -20 spanning x in [-5, 5] and y in [-3, 3].
+	static const S32 WIDTH = 160;
+	static const S32 HEIGHT = 90;
+	static const F32 NEAR_CLIP = 0.5f;
+	static const F32 FAR_CLIP = 256.f;
+	static const F32 WALL_Z = -20.f;
+	static const F32 WALL_X = 5.f;
+	static const F32 WALL_Y = 3.f;
+
+	static LLMatrix4a make_projection()
+	{
+		const F32 f = 1.f / tanf(30.f * DEG_TO_RAD);
+		const F32 aspect = (F32)WIDTH / HEIGHT;
+		LLMatrix4a proj;
+		proj.setRow<0>(LLVector4a(f / aspect, 0.f, 0.f, 0.f));
+		proj.setRow<1>(LLVector4a(0.f, f, 0.f, 0.f));
+		proj.setRow<2>(LLVector4a(0.f, 0.f, (FAR_CLIP + NEAR_CLIP) / (NEAR_CLIP - FAR_CLIP), -1.f));
+		proj.setRow<3>(LLVector4a(0.f, 0.f, 2.f * FAR_CLIP * NEAR_CLIP / (NEAR_CLIP - FAR_CLIP), 0.f));
+		return proj;
+	}
+
+	// Window coordinates of a point: pixels in x and y, depth in z.
+	static LLVector4a project(const LLMatrix4a& proj, const LLVector4a& point)
+	{
+		LLVector4a clip;
+		proj.affineTransform(point, clip);
+		const F32 w = clip[3];
+		return LLVector4a((clip[0] / w * 0.5f + 0.5f) * WIDTH,
+						  (clip[1] / w * 0.5f + 0.5f) * HEIGHT,
+						  clip[2] / w * 0.5f + 0.5f);
+	}
+
+	static void render_scene(const LLMatrix4a& proj, std::vector<F32>& depth)
+	{
+		LLVector4a lo = project(proj, LLVector4a(-WALL_X, -WALL_Y, WALL_Z));
+		LLVector4a hi = project(proj, LLVector4a(WALL_X, WALL_Y, WALL_Z));
+		depth.assign(WIDTH * HEIGHT, 1.f);
+		for (S32 y = 0; y < HEIGHT; ++y)
+		{
+			for (S32 x = 0; x < WIDTH; ++x)
+			{
+				// Pixel centers inside the wall
+				if (x + 0.5f >= lo[0] && x + 0.5f <= hi[0] && y + 0.5f >= lo[1] && y + 0.5f <= hi[1])
+				{
+					depth[y * WIDTH + x] = lo[2];
+				}
+			}
+		}
+	}
+
+	// What an occlusion query would report: samples the faces of the box
+	// densely and depth tests every sample against its pixel.
+	static bool query_visible(const LLMatrix4a& proj, const std::vector<F32>& depth,
+							  const LLVector4a& center, const LLVector4a& size)
+	{
+		const S32 SAMPLES = 48;
+		for (S32 axis = 0; axis < 3; ++axis)
+		{
+			for (S32 side = -1; side <= 1; side += 2)
+			{
+				for (S32 i = 0; i <= SAMPLES; ++i)
+				{
+					for (S32 j = 0; j <= SAMPLES; ++j)
+					{
+						F32 offset[3];
+						offset[axis] = (F32)side;
+						offset[(axis + 1) % 3] = 2.f * i / SAMPLES - 1.f;
+						offset[(axis + 2) % 3] = 2.f * j / SAMPLES - 1.f;
+						LLVector4a point(center[0] + offset[0] * size[0],
+										 center[1] + offset[1] * size[1],
+										 center[2] + offset[2] * size[2]);
+						LLVector4a window = project(proj, point);
+						const S32 x = llfloor(window[0]);
+						const S32 y = llfloor(window[1]);
+						if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT &&
+							window[2] >= 0.f && window[2] < depth[y * WIDTH + x])
+						{
+							return true;
+						}
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	struct hizbuffer_test
+	{
+	};
+
+	typedef test_group<hizbuffer_test> hizbuffer_t;
+	typedef hizbuffer_t::object hizbuffer_object_t;
+	tut::hizbuffer_t tut_hizbuffer("hizbuffer");
+
+	template<> template<>
+	void hizbuffer_object_t::test<1>()
+	{
+		// Every texel of every level is the maximum of the level 0 texels it covers,
+		// including odd sizes.
+		const S32 sizes[][2] = { { 1, 1 }, { 7, 3 }, { 37, 23 }, { 64, 64 }, { 161, 90 } };
+		for (S32 s = 0; s < (S32)LL_ARRAY_SIZE(sizes); ++s)
+		{
+			const S32 width = sizes[s][0];
+			const S32 height = sizes[s][1];
+			std::vector<F32> depth(width * height);
+			TestRandom random;
+			for (S32 i = 0; i < width * height; ++i)
+			{
+				depth[i] = (F32)random.nextReal(1.0);
+			}
+
+			LLHiZBuffer buffer;
+			buffer.setDepth(&depth[0], width, height, make_projection());
+			const S32 levels = buffer.getLevelCount();
+			ensure_equals("last level is one texel", buffer.getWidth(levels - 1) * buffer.getHeight(levels - 1), 1);
+			for (S32 level = 0; level < levels; ++level)
+			{
+				for (S32 y = 0; y < buffer.getHeight(level); ++y)
+				{
+					for (S32 x = 0; x < buffer.getWidth(level); ++x)
+					{
+						F32 expected = 0.f;
+						for (S32 y0 = y << level; y0 < llmin((y + 1) << level, height); ++y0)
+						{
+							for (S32 x0 = x << level; x0 < llmin((x + 1) << level, width); ++x0)
+							{
+								expected = llmax(expected, depth[y0 * width + x0]);
+							}
+						}
+						ensure_equals(llformat("%dx%d level %d texel %d,%d", width, height, level, x, y).c_str(),
+									  buffer.getDepth(level, x, y), expected);
+					}
+				}
+			}
+		}
+	}
+
+	template<> template<>
+	void hizbuffer_object_t::test<2>()
+	{
+		// The test scene gives the same answers as occlusion queries.
+		const LLMatrix4a proj = make_projection();
+		std::vector<F32> depth;
+		render_scene(proj, depth);
+		LLHiZBuffer buffer;
+		buffer.setDepth(&depth[0], WIDTH, HEIGHT, proj);
+
+		struct
+		{
+			const char* mName;
+			F32 mCenter[3];
+			F32 mSize[3];
+			bool mOccluded;
+		} cases[] = {
+			{ "behind the wall", { 0.f, 0.f, -40.f }, { 2.f, 2.f, 2.f }, true },
+			{ "small, far behind the wall", { 1.f, -1.f, -200.f }, { 0.5f, 0.5f, 0.5f }, true },
+			{ "right behind the wall", { 0.f, 0.f, -23.f }, { 1.5f, 1.f, 1.5f }, true },
+			{ "in front of the wall", { 0.f, 0.f, -10.f }, { 1.f, 1.f, 1.f }, false },
+			{ "through the wall", { 0.f, 0.f, -20.f }, { 1.f, 1.f, 1.f }, false },
+			{ "beside the wall", { 20.f, 0.f, -40.f }, { 2.f, 2.f, 2.f }, false },
+			{ "peeking out over the wall", { 0.f, 6.f, -40.f }, { 2.f, 2.f, 2.f }, false },
+			{ "in the sky", { 0.f, 30.f, -100.f }, { 5.f, 5.f, 5.f }, false },
+		};
+
+		std::vector<LLVector4a> bounds;
+		for (S32 i = 0; i < (S32)LL_ARRAY_SIZE(cases); ++i)
+		{
+			LLVector4a center(cases[i].mCenter[0], cases[i].mCenter[1], cases[i].mCenter[2]);
+			LLVector4a size(cases[i].mSize[0], cases[i].mSize[1], cases[i].mSize[2]);
+			ensure_equals(llformat("%s, occlusion query", cases[i].mName).c_str(),
+						  !query_visible(proj, depth, center, size), cases[i].mOccluded);
+			ensure_equals(llformat("%s, Hi-Z", cases[i].mName).c_str(),
+						  buffer.isOccluded(center, size), cases[i].mOccluded);
+			bounds.push_back(center);
+			bounds.push_back(size);
+		}
+
+		std::vector<U8> occluded(LL_ARRAY_SIZE(cases));
+		buffer.testBoxes(&bounds[0], (S32)occluded.size(), &occluded[0]);
+		for (S32 i = 0; i < (S32)LL_ARRAY_SIZE(cases); ++i)
+		{
+			ensure_equals(llformat("%s, batch", cases[i].mName).c_str(), occluded[i] != 0, cases[i].mOccluded);
+		}
+	}
+
+	template<> template<>
+	void hizbuffer_object_t::test<3>()
+	{
+		// Random boxes: the test never hides anything a query would see, a
+		// batch agrees with single tests, and an empty buffer hides nothing.
+		const LLMatrix4a proj = make_projection();
+		std::vector<F32> depth;
+		render_scene(proj, depth);
+		LLHiZBuffer buffer;
+		buffer.setDepth(&depth[0], WIDTH, HEIGHT, proj);
+
+		const S32 COUNT = 2000;
+		std::vector<LLVector4a> bounds;
+		TestRandom random;
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			F32 r[6];
+			for (S32 j = 0; j < 6; ++j)
+			{
+				r[j] = (F32)random.nextReal(1.0);
+			}
+			bounds.push_back(LLVector4a(r[0] * 40.f - 20.f, r[1] * 30.f - 15.f, -5.f - r[2] * 80.f));
+			bounds.push_back(LLVector4a(0.1f + r[3] * 3.f, 0.1f + r[4] * 3.f, 0.1f + r[5] * 3.f));
+		}
+
+		std::vector<U8> occluded(COUNT);
+		buffer.testBoxes(&bounds[0], COUNT, &occluded[0]);
+		S32 hidden = 0;
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			const bool single = buffer.isOccluded(bounds[i * 2], bounds[i * 2 + 1]);
+			ensure_equals(llformat("box %d, batch", i).c_str(), occluded[i] != 0, single);
+			if (single)
+			{
+				ensure(llformat("box %d is visible to a query", i), !query_visible(proj, depth, bounds[i * 2], bounds[i * 2 + 1]));
+				++hidden;
+			}
+		}
+		ensure("some boxes are occluded", hidden > 0);
+
+		LLHiZBuffer empty;
+		ensure("empty buffer", !empty.isOccluded(bounds[0], bounds[1]));
+	}
+}
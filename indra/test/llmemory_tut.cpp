@@ -0,0 +1,360 @@
+/**
+ * @file llmemory_tut.cpp
+ * @date 2026-10
+ * @brief LLPrivateMemoryPool unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llmemory.h"
+#include "llthread.h"
+#include "lltimer.h"
+#include "lltut.h"
+
+#include <vector>
+
+namespace tut
+{
+	typedef LLPrivateMemoryPool pool_t;
+
+	// The size of each size class, as laid out in llmemory.cpp: 16 byte steps up to 256,
+	// then four steps per power of two up to MAX_CLASS_SIZE.
+	static U32 class_size(S32 class_index)
+	{
+		if (class_index < 16)
+		{
+			return (class_index + 1) * 16;
+		}
+		U32 step = class_index - 16;
+		U32 level = 8 + (step >> 2);
+		return (1 << level) + (((step & 3) + 1) << (level - 2));
+	}
+
+	// Frees, on its own thread, memory that was allocated on another one.
+	class PoolFreeThread : public LLThread
+	{
+	public:
+		PoolFreeThread(pool_t* pool, const std::vector<char*>& objects) :
+			LLThread("Pool Free Thread"), mPool(pool), mObjects(objects) { }
+
+	protected:
+		/*virtual*/ void run()
+		{
+			for (U32 i = 0; i < mObjects.size(); ++i)
+			{
+				FREE_MEM(mPool, mObjects[i]);
+			}
+		}
+
+	private:
+		pool_t* mPool;
+		std::vector<char*> mObjects;
+	};
+
+	// Allocates and frees a number of same sized objects, leaving them all in its magazines.
+	class PoolChurnThread : public LLThread
+	{
+	public:
+		PoolChurnThread(pool_t* pool, U32 size, U32 count) :
+			LLThread("Pool Churn Thread"), mPool(pool), mSize(size), mCount(count) { }
+
+	protected:
+		/*virtual*/ void run()
+		{
+			std::vector<char*> objects;
+			for (U32 i = 0; i < mCount; ++i)
+			{
+				objects.push_back(ALLOCATE_MEM(mPool, mSize));
+			}
+			for (U32 i = 0; i < mCount; ++i)
+			{
+				FREE_MEM(mPool, objects[i]);
+			}
+		}
+
+	private:
+		pool_t* mPool;
+		U32 mSize;
+		U32 mCount;
+	};
+
+	struct privatememorypool_test
+	{
+		privatememorypool_test()
+		{
+			LLPrivateMemoryPoolManager::initClass(TRUE, 0);
+			mManager = LLPrivateMemoryPoolManager::getInstance();
+		}
+
+		~privatememorypool_test()
+		{
+			LLPrivateMemoryPoolManager::destroyClass();
+		}
+
+		pool_t::Stats stats(S32 type)
+		{
+			mManager->updateStatistics();
+			return mManager->mPoolStats[type];
+		}
+
+		void runThread(LLThread* thread)
+		{
+			thread->start();
+			while (!thread->isStopped())
+			{
+				ms_sleep(1);
+			}
+			delete thread;
+		}
+
+		// A thread hands its magazines back when its thread local data goes away, which is
+		// only after it reports being stopped.
+		bool waitForCachedSize(S32 type, U32 cached_size)
+		{
+			for (S32 i = 0; i < 1000; ++i)
+			{
+				if (stats(type).mCachedSize == cached_size)
+				{
+					return true;
+				}
+				ms_sleep(10);
+			}
+			return false;
+		}
+
+		LLPrivateMemoryPoolManager* mManager;
+	};
+
+	typedef test_group<privatememorypool_test> privatememorypool_t;
+	typedef privatememorypool_t::object privatememorypool_object_t;
+	tut::privatememorypool_t tut_privatememorypool("privatememorypool");
+
+	template<> template<>
+	void privatememorypool_object_t::test<1>()
+	{
+		// Every size class boundary lands in its own class, one byte more in the next one.
+		pool_t* pool = mManager->newPool(pool_t::STATIC);
+		ensure("pool", pool != NULL);
+		ensure_equals("last class", class_size(pool_t::NUM_SIZE_CLASSES - 1), (U32)pool_t::MAX_CLASS_SIZE);
+
+		char* p = ALLOCATE_MEM(pool, 1);
+		ensure_equals("one byte", stats(pool_t::STATIC).mAllocatedSize, 16U);
+		FREE_MEM(pool, p);
+
+		for (S32 i = 0; i < pool_t::NUM_SIZE_CLASSES; ++i)
+		{
+			U32 size = class_size(i);
+			char* at = ALLOCATE_MEM(pool, size);
+			ensure("boundary allocated", at != NULL);
+			ensure_equals("boundary aligned", (U32)((uintptr_t)at & 15), 0U);
+			ensure_equals("boundary class", stats(pool_t::STATIC).mAllocatedSize, size);
+			memset(at, 0xAB, size);
+
+			char* past = ALLOCATE_MEM(pool, size + 1);
+			ensure("past boundary allocated", past != NULL);
+			ensure_equals("past boundary aligned", (U32)((uintptr_t)past & 15), 0U);
+			U32 past_size = i + 1 < pool_t::NUM_SIZE_CLASSES ? class_size(i + 1) : size + pool_t::PAGE_SIZE;
+			ensure_equals("past boundary class", stats(pool_t::STATIC).mAllocatedSize, size + past_size);
+			memset(past, 0xCD, size + 1);
+
+			ensure("boundary untouched", (U8)at[0] == 0xAB && (U8)at[size - 1] == 0xAB);
+			FREE_MEM(pool, at);
+			FREE_MEM(pool, past);
+			ensure_equals("freed", stats(pool_t::STATIC).mAllocatedSize, 0U);
+		}
+		ensure_equals("no large spans left", stats(pool_t::STATIC).mLargeCount, 0U);
+	}
+
+	template<> template<>
+	void privatememorypool_object_t::test<2>()
+	{
+		// Allocations above the largest class get whole pages of their own and give them back when freed.
+		pool_t* pool = mManager->newPool(pool_t::STATIC);
+		const U32 reserved = stats(pool_t::STATIC).mReservedSize;
+
+		char* one = ALLOCATE_MEM(pool, pool_t::MAX_CLASS_SIZE + 1);
+		char* two = ALLOCATE_MEM(pool, 3 * pool_t::MAX_CLASS_SIZE + 5);
+		ensure("large allocated", one && two);
+		memset(one, 1, pool_t::MAX_CLASS_SIZE + 1);
+		memset(two, 2, 3 * pool_t::MAX_CLASS_SIZE + 5);
+
+		pool_t::Stats s = stats(pool_t::STATIC);
+		const U32 large_size = 4 * pool_t::MAX_CLASS_SIZE + 2 * pool_t::PAGE_SIZE;
+		ensure_equals("large count", s.mLargeCount, 2U);
+		ensure_equals("large spans", s.mSpanCount, 2U);
+		ensure_equals("large allocated size", s.mAllocatedSize, large_size);
+		ensure_equals("large reserved size", s.mReservedSize, reserved + large_size);
+		ensure_equals("large not cached", s.mCachedSize, 0U);
+
+		FREE_MEM(pool, one);
+		FREE_MEM(NULL, two); // found through its span
+		s = stats(pool_t::STATIC);
+		ensure_equals("large count freed", s.mLargeCount, 0U);
+		ensure_equals("large allocated freed", s.mAllocatedSize, 0U);
+		ensure_equals("large reserved freed", s.mReservedSize, reserved);
+	}
+
+	template<> template<>
+	void privatememorypool_object_t::test<3>()
+	{
+		// Memory freed on another thread goes to that thread's magazines, and back to the pool when it exits.
+		pool_t* pool = mManager->newPool(pool_t::STATIC_THREADED);
+		const U32 sizes[] = { 48, 1000, 20000 };
+		std::vector<char*> objects;
+		U32 allocated = 0;
+		for (U32 i = 0; i < 300; ++i)
+		{
+			U32 size = sizes[i % LL_ARRAY_SIZE(sizes)];
+			char* p = ALLOCATE_MEM(pool, size);
+			memset(p, i, size);
+			objects.push_back(p);
+			allocated += size;
+		}
+
+		pool_t::Stats s = stats(pool_t::STATIC_THREADED);
+		ensure("allocated", s.mAllocatedSize >= allocated);
+		// what is left in this thread's magazines after the refills
+		const U32 cached = s.mCachedSize;
+
+		runThread(new PoolFreeThread(pool, objects));
+		ensure_equals("freed on the other thread", stats(pool_t::STATIC_THREADED).mAllocatedSize, 0U);
+		ensure("other thread flushed on exit", waitForCachedSize(pool_t::STATIC_THREADED, cached));
+
+		// the objects are usable again from here
+		for (U32 i = 0; i < objects.size(); ++i)
+		{
+			objects[i] = ALLOCATE_MEM(pool, sizes[i % LL_ARRAY_SIZE(sizes)]);
+		}
+		for (U32 i = 0; i < objects.size(); ++i)
+		{
+			FREE_MEM(pool, objects[i]);
+		}
+		ensure_equals("freed again", stats(pool_t::STATIC_THREADED).mAllocatedSize, 0U);
+	}
+
+	template<> template<>
+	void privatememorypool_object_t::test<4>()
+	{
+		// A full magazine hands its oldest half back, so a thread never keeps more than 128 KB of one class.
+		pool_t* pool = mManager->newPool(pool_t::STATIC);
+		const U32 size = 4096;
+		const U32 count = 256;
+		std::vector<char*> objects;
+		for (U32 i = 0; i < count; ++i)
+		{
+			objects.push_back(ALLOCATE_MEM(pool, size));
+		}
+		const U32 reserved = stats(pool_t::STATIC).mReservedSize;
+		ensure("reserved", reserved >= size * count);
+
+		for (U32 i = 0; i < count; ++i)
+		{
+			FREE_MEM(pool, objects[i]);
+		}
+		pool_t::Stats s = stats(pool_t::STATIC);
+		ensure_equals("freed", s.mAllocatedSize, 0U);
+		ensure("magazine kept some", s.mCachedSize > 0);
+		ensure("magazine flushed the rest", s.mCachedSize <= 128 * 1024);
+		ensure("empty spans returned", s.mReservedSize < reserved);
+		ensure("cache fits the spans", s.mCachedSize <= s.mReservedSize);
+	}
+
+	template<> template<>
+	void privatememorypool_object_t::test<5>()
+	{
+		// Volatile pools keep one empty span per class for the next allocation, static pools do not.
+		pool_t* volatile_pool = mManager->newPool(pool_t::VOLATILE);
+		pool_t* static_pool = mManager->newPool(pool_t::STATIC);
+		const U32 size = 32 * 1024; // eight to a 256 KB span
+		const U32 span_size = 8 * size;
+
+		runThread(new PoolChurnThread(volatile_pool, size, 24));
+		runThread(new PoolChurnThread(static_pool, size, 24));
+		ensure("volatile thread flushed on exit", waitForCachedSize(pool_t::VOLATILE, 0));
+		ensure("static thread flushed on exit", waitForCachedSize(pool_t::STATIC, 0));
+
+		pool_t::Stats s = stats(pool_t::VOLATILE);
+		ensure_equals("volatile spare span", s.mSpanCount, 1U);
+		ensure_equals("volatile spare reserved", s.mReservedSize, span_size);
+		s = stats(pool_t::STATIC);
+		ensure_equals("static spans returned", s.mSpanCount, 0U);
+		ensure_equals("static reserved returned", s.mReservedSize, 0U);
+
+		char* p = ALLOCATE_MEM(volatile_pool, size);
+		s = stats(pool_t::VOLATILE);
+		ensure_equals("spare span reused", s.mSpanCount, 1U);
+		ensure_equals("nothing new reserved", s.mReservedSize, span_size);
+		ensure_equals("allocated from the spare", s.mAllocatedSize, size);
+		FREE_MEM(volatile_pool, p);
+	}
+
+	template<> template<>
+	void privatememorypool_object_t::test<6>()
+	{
+		// The totals behind SGMemStat::getPoolFragmentation() add up the pools.
+		pool_t* static_pool = mManager->newPool(pool_t::STATIC);
+		pool_t* volatile_pool = mManager->newPool(pool_t::VOLATILE);
+		ensure_equals("empty stats", pool_t::Stats().getFragmentation(), 0.f);
+
+		std::vector<char*> static_objects;
+		std::vector<char*> volatile_objects;
+		for (U32 i = 0; i < 100; ++i)
+		{
+			static_objects.push_back(ALLOCATE_MEM(static_pool, 100));
+			volatile_objects.push_back(ALLOCATE_MEM(volatile_pool, 3000));
+		}
+		char* large = ALLOCATE_MEM(volatile_pool, 2 * pool_t::MAX_CLASS_SIZE);
+
+		mManager->updateStatistics();
+		const pool_t::Stats& s = mManager->mPoolStats[pool_t::STATIC];
+		const pool_t::Stats& v = mManager->mPoolStats[pool_t::VOLATILE];
+		ensure_equals("static allocated", s.mAllocatedSize, 100 * 112U);
+		ensure_equals("volatile allocated", v.mAllocatedSize, 100 * 3072U + 2 * pool_t::MAX_CLASS_SIZE);
+		ensure_equals("total allocated", mManager->mTotalAllocatedSize, s.mAllocatedSize + v.mAllocatedSize);
+		ensure_equals("total reserved", mManager->mTotalReservedSize, s.mReservedSize + v.mReservedSize);
+		ensure("allocated within reserved", mManager->mTotalAllocatedSize <= mManager->mTotalReservedSize);
+		ensure_equals("no threaded pool", mManager->mPoolStats[pool_t::STATIC_THREADED].mReservedSize, 0U);
+		ensure_approximately_equals("static fragmentation", s.getFragmentation(),
+			1.f - (F32)s.mAllocatedSize / (F32)s.mReservedSize, 16);
+		F32 fragmentation = 1.f - (F32)mManager->mTotalAllocatedSize / (F32)mManager->mTotalReservedSize;
+		ensure("fragmentation in range", fragmentation > 0.f && fragmentation < 1.f);
+
+		for (U32 i = 0; i < static_objects.size(); ++i)
+		{
+			FREE_MEM(static_pool, static_objects[i]);
+			FREE_MEM(volatile_pool, volatile_objects[i]);
+		}
+		FREE_MEM(volatile_pool, large);
+		mManager->updateStatistics();
+		ensure_equals("total freed", mManager->mTotalAllocatedSize, 0U);
+		ensure_equals("all reserved is free", mManager->mPoolStats[pool_t::VOLATILE].getFragmentation(), 1.f);
+	}
+}
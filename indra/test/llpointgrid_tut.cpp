@@ -0,0 +1,209 @@
+/**
+ * @file llpointgrid_tut.cpp
+ * @date 2026-10
+ * @brief LLPointGrid unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llpointgrid.h"
+#include "llformat.h"
+#include "lltestrandom.h"
+#include "lltut.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace tut
+{
+	typedef LLPointGrid<U32> grid_t;
+
+	static TestRandom sRandom;
+
+	static F64 next_random(F64 range)
+	{
+		return sRandom.nextReal(range);
+	}
+
+	// Somewhere on a 3x3 block of regions, a few hundred meters up at most.
+	static LLVector3d random_position()
+	{
+		return LLVector3d(256000.0 + next_random(768.0), 256000.0 + next_random(768.0), next_random(400.0));
+	}
+
+	// The grid's points, next to a plain list of them to check it against.
+	struct GridPoints
+	{
+		GridPoints(F64 cell_size) : mGrid(cell_size) { }
+
+		void set(U32 key, const LLVector3d& pos)
+		{
+			if (key >= mPositions.size())
+			{
+				mPositions.resize(key + 1);
+				mPresent.resize(key + 1, false);
+			}
+			mGrid.set(key, pos);
+			mPositions[key] = pos;
+			mPresent[key] = true;
+		}
+
+		void remove(U32 key)
+		{
+			mGrid.remove(key);
+			mPresent[key] = false;
+		}
+
+		std::vector<U32> expectedInRange(const LLVector3d& center, F64 radius) const
+		{
+			std::vector<U32> keys;
+			for (U32 i = 0; i < mPositions.size(); ++i)
+			{
+				if (mPresent[i] && dist_vec_squared(mPositions[i], center) <= radius * radius)
+				{
+					keys.push_back(i);
+				}
+			}
+			return keys;
+		}
+
+		F64 expectedNearest(const LLVector3d& center) const
+		{
+			F64 best = -1.0;
+			for (U32 i = 0; i < mPositions.size(); ++i)
+			{
+				F64 dist = dist_vec(mPositions[i], center);
+				if (mPresent[i] && (best < 0.0 || dist < best))
+				{
+					best = dist;
+				}
+			}
+			return best;
+		}
+
+		grid_t mGrid;
+		std::vector<LLVector3d> mPositions;
+		std::vector<bool> mPresent;
+	};
+
+	static void ensure_queries(GridPoints& points, const std::string& what)
+	{
+		for (S32 q = 0; q < 50; ++q)
+		{
+			const LLVector3d center = random_position();
+			const F64 radius = q < 45 ? next_random(200.0) : 5000.0;
+
+			std::vector<U32> keys;
+			points.mGrid.findInRange(center, radius, keys);
+			std::sort(keys.begin(), keys.end());
+			ensure(llformat("%s: range %d", what.c_str(), q), keys == points.expectedInRange(center, radius));
+
+			U32 key = 0;
+			const F64 expected = points.expectedNearest(center);
+			const bool found = points.mGrid.findNearest(center, 10000.0, key);
+			ensure_equals(what + ": nearest found", found, expected >= 0.0);
+			if (found)
+			{
+				// Any of several points at the same distance will do.
+				ensure_equals(llformat("%s: nearest %d", what.c_str(), q), dist_vec(points.mPositions[key], center), expected);
+			}
+		}
+	}
+
+	struct pointgrid_test
+	{
+	};
+
+	typedef test_group<pointgrid_test> pointgrid_t;
+	typedef pointgrid_t::object pointgrid_object_t;
+	tut::pointgrid_t tut_pointgrid("pointgrid");
+
+	template<> template<>
+	void pointgrid_object_t::test<1>()
+	{
+		// Set, move and remove, one cell and across cells.
+		grid_t grid(64.0);
+		ensure("added", grid.set(1, LLVector3d(10.0, 10.0, 0.0)));
+		ensure("moved", !grid.set(1, LLVector3d(20.0, 10.0, 0.0)));
+		ensure("added second", grid.set(2, LLVector3d(100.0, 10.0, 0.0)));
+		ensure_equals("size", grid.size(), 2U);
+		ensure("moved across cells", !grid.set(1, LLVector3d(130.0, 10.0, 0.0)));
+		ensure_equals("position", *grid.find(1), LLVector3d(130.0, 10.0, 0.0));
+
+		U32 key = 0;
+		ensure("nearest", grid.findNearest(LLVector3d(0.0, 0.0, 0.0), 1000.0, key));
+		ensure_equals("nearest key", key, 2U);
+		ensure("nothing within radius", !grid.findNearest(LLVector3d(0.0, 0.0, 0.0), 50.0, key));
+
+		ensure("removed", grid.remove(2));
+		ensure("removed twice", !grid.remove(2));
+		ensure("gone", grid.find(2) == NULL);
+		ensure("nearest after remove", grid.findNearest(LLVector3d(0.0, 0.0, 0.0), 1000.0, key));
+		ensure_equals("nearest key after remove", key, 1U);
+
+		grid.clear();
+		ensure("empty", grid.empty());
+		ensure("nothing near", !grid.findNearest(LLVector3d(0.0, 0.0, 0.0), 1000.0, key));
+	}
+
+	template<> template<>
+	void pointgrid_object_t::test<2>()
+	{
+		// Queries match a scan of all points, while points come, move and go.
+		const F64 cell_sizes[] = { 16.0, 64.0, 1000.0 };
+		for (S32 c = 0; c < (S32)LL_ARRAY_SIZE(cell_sizes); ++c)
+		{
+			GridPoints points(cell_sizes[c]);
+			ensure_queries(points, "empty");
+			for (U32 i = 0; i < 300; ++i)
+			{
+				points.set(i, random_position());
+			}
+			ensure_queries(points, llformat("cell %g, added", cell_sizes[c]));
+
+			for (U32 i = 0; i < 300; i += 3)
+			{
+				// Short walks, some of them into the next cell, and long jumps.
+				LLVector3d pos = points.mPositions[i];
+				pos += i % 2 ? LLVector3d(next_random(8.0) - 4.0, next_random(8.0) - 4.0, 0.0) : random_position() - pos;
+				points.set(i, pos);
+			}
+			ensure_queries(points, llformat("cell %g, moved", cell_sizes[c]));
+
+			for (U32 i = 0; i < 300; i += 2)
+			{
+				points.remove(i);
+			}
+			ensure_queries(points, llformat("cell %g, removed", cell_sizes[c]));
+		}
+	}
+}
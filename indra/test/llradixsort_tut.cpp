@@ -0,0 +1,127 @@
+/**
+ * @file llradixsort_tut.cpp
+ * @date 2026-10
+ * @brief ll_radix_sort unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llradixsort.h"
+#include "llformat.h"
+#include "lltestrandom.h"
+#include "lltut.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace tut
+{
+	typedef LLRadixSortEntry<U32> entry_t;
+
+	struct CompareKey
+	{
+		bool operator()(const entry_t& lhs, const entry_t& rhs) const
+		{
+			return lhs.mKey < rhs.mKey;
+		}
+	};
+
+	// Random keys with only the bits in mask set; the value is the original position.
+	static void make_entries(std::vector<entry_t>& entries, U32 count, U64 mask)
+	{
+		TestRandom random;
+		entries.resize(count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			entries[i].mKey = random.nextU64() & mask;
+			entries[i].mValue = i;
+		}
+	}
+
+	static bool same_entries(const std::vector<entry_t>& a, const std::vector<entry_t>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			if (a[i].mKey != b[i].mKey || a[i].mValue != b[i].mValue)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	struct radixsort_test
+	{
+	};
+
+	typedef test_group<radixsort_test> radixsort_t;
+	typedef radixsort_t::object radixsort_object_t;
+	tut::radixsort_t tut_radixsort("radixsort");
+
+	template<> template<>
+	void radixsort_object_t::test<1>()
+	{
+		// Same order as a stable comparison sort, for full keys, keys that only use
+		// some of their bytes (skipped passes) and keys with many duplicates.
+		const U32 counts[] = { 0, 1, 2, 7, 256, 5000 };
+		const U64 masks[] = { ~0ULL, 0xFFFFULL, 0xFF00000000FF0000ULL, 0x7ULL, 0ULL };
+		for (S32 c = 0; c < (S32)LL_ARRAY_SIZE(counts); ++c)
+		{
+			for (S32 m = 0; m < (S32)LL_ARRAY_SIZE(masks); ++m)
+			{
+				std::vector<entry_t> expected, actual, scratch;
+				make_entries(expected, counts[c], masks[m]);
+				actual = expected;
+				std::stable_sort(expected.begin(), expected.end(), CompareKey());
+				ll_radix_sort(actual, scratch);
+				ensure(llformat("%d keys, mask %llx", counts[c], (unsigned long long)masks[m]),
+					   same_entries(expected, actual));
+			}
+		}
+	}
+
+	template<> template<>
+	void radixsort_object_t::test<2>()
+	{
+		// Float keys sort like the floats.
+		const F32 values[] = { -1.0e30f, -256.f, -1.5f, -1.f, -1.0e-30f, 0.f, 1.0e-30f, 0.25f, 1.f, 3.f, 1024.5f, 1.0e30f };
+		for (S32 i = 1; i < (S32)LL_ARRAY_SIZE(values); ++i)
+		{
+			ensure(llformat("%g < %g", values[i - 1], values[i]),
+				   ll_float_sort_key(values[i - 1]) < ll_float_sort_key(values[i]));
+		}
+		ensure_equals("-0 next to +0", ll_float_sort_key(0.f) - ll_float_sort_key(-0.f), 1U);
+	}
+}
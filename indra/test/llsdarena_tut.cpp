@@ -0,0 +1,188 @@
+/**
+ * @file llsdarena_tut.cpp
+ * @date 2026-10
+ * @brief LLSDArena unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llsd.h"
+#include "llsdarena.h"
+#include "llsdserialize.h"
+#include "llfetchdescendentsreply.h"
+#include "lltut.h"
+
+#include <sstream>
+
+namespace tut
+{
+	struct sd_arena_data
+	{
+		sd_arena_data()
+		{
+			mSD = make_fetch_descendents_response(4, 8);
+			mSD["nothing"] = LLSD();
+			mSD["date"] = LLDate(1234567.0);
+			mSD["uri"] = LLURI("http://example.com/cap");
+			std::vector<U8> blob;
+			blob.push_back(0);
+			blob.push_back(0xff);
+			mSD["binary"] = blob;
+			mSD["real"] = 3.25;
+			mSD["bool"] = true;
+		}
+
+		void ensure_same(const std::string& msg, const LLSD& expected, const LLSDArenaValue& actual)
+		{
+			std::ostringstream lhs, rhs;
+			LLSDSerialize::toNotation(expected, lhs);
+			LLSDSerialize::toNotation(actual.toLLSD(), rhs);
+			ensure_equals(msg, rhs.str(), lhs.str());
+		}
+
+		LLSD mSD;
+	};
+
+	typedef test_group<sd_arena_data> sd_arena_test;
+	typedef sd_arena_test::object sd_arena_object;
+	tut::sd_arena_test sd_arena("llsd_arena");
+
+	template<> template<>
+	void sd_arena_object::test<1>()
+	{
+		// binary round trip
+		std::ostringstream ostr;
+		LLSDSerialize::toBinary(mSD, ostr);
+		std::string data = ostr.str();
+		std::istringstream istr(data);
+		LLPointer<LLSDArena> arena = new LLSDArena;
+		ensure("binary parse", LLSDSerialize::fromBinary(*arena, istr, data.size()) > 0);
+		ensure_same("binary arena matches LLSD", mSD, arena->root());
+	}
+
+	template<> template<>
+	void sd_arena_object::test<2>()
+	{
+		// xml round trip
+		std::ostringstream ostr;
+		LLSDSerialize::toXML(mSD, ostr);
+		std::istringstream istr(ostr.str());
+		LLPointer<LLSDArena> arena = new LLSDArena;
+		ensure("xml parse", LLSDSerialize::fromXML(*arena, istr) > 0);
+		ensure_same("xml arena matches LLSD", mSD, arena->root());
+	}
+
+	template<> template<>
+	void sd_arena_object::test<3>()
+	{
+		// accessors and interned keys
+		std::ostringstream ostr;
+		LLSDSerialize::toBinary(mSD, ostr);
+		std::string data = ostr.str();
+		std::istringstream istr(data);
+		LLPointer<LLSDArena> arena = new LLSDArena;
+		LLSDSerialize::fromBinary(*arena, istr, data.size());
+
+		const LLSDArenaValue& root = arena->root();
+		ensure("root is map", root.isMap());
+		ensure("has undefined member", root.has("nothing"));
+		ensure("missing member", !root.has("missing"));
+		ensure("missing member is undefined", root["missing"].isUndefined());
+		ensure_equals("folder count", root["folders"].size(), 4);
+		ensure_equals("out of range is undefined", root["folders"][4].type(), LLSD::TypeUndefined);
+		ensure_equals("uuid", root["folders"][1]["folder_id"].asUUID(), mSD["folders"][1]["folder_id"].asUUID());
+		ensure_equals("string", root["folders"][2]["items"][3]["name"].asString(), mSD["folders"][2]["items"][3]["name"].asString());
+		ensure_equals("integer as string", root["folders"][0]["version"].asString(), std::string("3"));
+		ensure_equals("real", root["real"].asReal(), 3.25);
+		ensure("bool", root["bool"].asBoolean());
+		ensure_equals("binary size", (S32)root["binary"].asBinary().size(), 2);
+
+		const char* item_id = arena->findKey("item_id", 7);
+		ensure("key interned", item_id != NULL);
+		ensure("unused key not interned", arena->findKey("no_such_key", 11) == NULL);
+		const LLSDArenaValue& item = root["folders"][0]["items"][0];
+		ensure_equals("interned lookup", item.getInterned(item_id).asUUID(), item["item_id"].asUUID());
+	}
+
+	template<> template<>
+	void sd_arena_object::test<4>()
+	{
+		// malformed input leaves the root undefined
+		std::string data("{\0\0\0\x02k\0\0\0\x01""ai\0\0\0\x01}", 17);
+		std::istringstream istr(data);
+		LLPointer<LLSDArena> arena = new LLSDArena;
+		ensure_equals("truncated map fails", LLSDSerialize::fromBinary(*arena, istr, data.size()), (S32)LLSDParser::PARSE_FAILURE);
+		ensure("root undefined after failure", arena->root().isUndefined());
+	}
+
+	template<> template<>
+	void sd_arena_object::test<5>()
+	{
+		// duplicate keys: the first value wins, as in the LLSD parser
+		std::string data("{\0\0\0\x03"
+						 "k\0\0\0\x01" "ai\0\0\0\x01"
+						 "k\0\0\0\x01" "bi\0\0\0\x03"
+						 "k\0\0\0\x01" "ai\0\0\0\x02"
+						 "}", 39);
+		LLSD sd;
+		std::istringstream sd_istr(data);
+		ensure("LLSD parse", LLSDSerialize::fromBinary(sd, sd_istr, data.size()) > 0);
+		ensure_equals("LLSD keeps the first value", sd["a"].asInteger(), 1);
+
+		std::istringstream istr(data);
+		LLPointer<LLSDArena> arena = new LLSDArena;
+		ensure("arena parse", LLSDSerialize::fromBinary(*arena, istr, data.size()) > 0);
+		ensure_equals("one entry per key", arena->root().size(), 2);
+		ensure_same("arena matches LLSD", sd, arena->root());
+	}
+
+	template<> template<>
+	void sd_arena_object::test<6>()
+	{
+		// duplicate keys in xml: the last value wins, as in the LLSD parser
+		std::string data("<llsd><map>"
+						 "<key>a</key><integer>1</integer>"
+						 "<key>b</key><array><integer>3</integer></array>"
+						 "<key>a</key><integer>2</integer>"
+						 "<key>b</key><map><key>c</key><string>d</string></map>"
+						 "</map></llsd>");
+		LLSD sd;
+		std::istringstream sd_istr(data);
+		ensure("LLSD parse", LLSDSerialize::fromXML(sd, sd_istr) > 0);
+		ensure_equals("LLSD keeps the last value", sd["a"].asInteger(), 2);
+
+		std::istringstream istr(data);
+		LLPointer<LLSDArena> arena = new LLSDArena;
+		ensure("arena parse", LLSDSerialize::fromXML(*arena, istr) > 0);
+		ensure_equals("one entry per key", arena->root().size(), 2);
+		ensure_same("arena matches LLSD", sd, arena->root());
+	}
+}
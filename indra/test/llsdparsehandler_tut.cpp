@@ -0,0 +1,217 @@
+/**
+ * @file llsdparsehandler_tut.cpp
+ * @date 2026-10
+ * @brief LLSDParseHandler and streaming parser unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llsd.h"
+#include "llsdparsehandler.h"
+#include "llsdserialize.h"
+#include "llformat.h"
+#include "lltut.h"
+
+#include <boost/bind.hpp>
+#include <sstream>
+
+namespace tut
+{
+	struct sd_parse_handler_data
+	{
+		sd_parse_handler_data()
+		{
+			LLSD members = LLSD::emptyMap();
+			for (S32 i = 0; i < 20; ++i)
+			{
+				LLUUID id;
+				id.generate(llformat("member%d", i));
+				LLSD member;
+				member["title"] = i % 3;
+				member["powers"] = llformat("%x", i * 17);
+				member["owner"] = (i == 0) ? "Y" : "N";
+				member["last_login"] = "2026/10/01";
+				member["donated_square_meters"] = i * 512;
+				members[id.asString()] = member;
+			}
+			mSD["members"] = members;
+			mSD["group_id"] = LLUUID("4a2f8a5e-6d1f-4b0e-9c76-1e3d3a1b2c4d");
+			mSD["member_count"] = 20;
+			mSD["titles"][0] = "Everyone";
+			mSD["titles"][1] = "Officers";
+			mSD["titles"][2] = "Owners";
+			mSD["nothing"] = LLSD();
+			mSD["date"] = LLDate(1234567.0);
+			mSD["uri"] = LLURI("http://example.com/cap");
+			std::vector<U8> blob;
+			blob.push_back(0);
+			blob.push_back(0xff);
+			mSD["binary"] = blob;
+			mSD["real"] = 3.25;
+			mSD["bool"] = true;
+			mSD["empty_array"] = LLSD::emptyArray();
+			mSD["empty_map"] = LLSD::emptyMap();
+		}
+
+		void ensure_same(const std::string& msg, const LLSD& expected, const LLSD& actual)
+		{
+			std::ostringstream lhs, rhs;
+			LLSDSerialize::toNotation(expected, lhs);
+			LLSDSerialize::toNotation(actual, rhs);
+			ensure_equals(msg, rhs.str(), lhs.str());
+		}
+
+		void onItem(const std::string& key, const LLSD& item)
+		{
+			mItems[key] = item;
+		}
+
+		LLSD mSD;
+		LLSD mItems;
+	};
+
+	typedef test_group<sd_parse_handler_data> sd_parse_handler_test;
+	typedef sd_parse_handler_test::object sd_parse_handler_object;
+	tut::sd_parse_handler_test sd_parse_handler("llsd_parse_handler");
+
+	template<> template<>
+	void sd_parse_handler_object::test<1>()
+	{
+		// every format reproduces the tree parse through the events
+		std::ostringstream xml, notation, binary;
+		LLSDSerialize::toXML(mSD, xml);
+		LLSDSerialize::toNotation(mSD, notation);
+		LLSDSerialize::toBinary(mSD, binary);
+
+		LLSDTreeHandler handler;
+		std::istringstream xml_stream(xml.str());
+		ensure("xml parse", LLSDSerialize::fromXML(handler, xml_stream) > 0);
+		ensure("xml complete", handler.complete());
+		ensure_same("xml events", mSD, handler.result());
+
+		handler.reset();
+		std::istringstream notation_stream(notation.str());
+		ensure("notation parse", LLSDSerialize::fromNotation(handler, notation_stream, notation.str().size()) > 0);
+		ensure("notation complete", handler.complete());
+		ensure_same("notation events", mSD, handler.result());
+
+		handler.reset();
+		std::istringstream binary_stream(binary.str());
+		ensure("binary parse", LLSDSerialize::fromBinary(handler, binary_stream, binary.str().size()) > 0);
+		ensure("binary complete", handler.complete());
+		ensure_same("binary events", mSD, handler.result());
+	}
+
+	template<> template<>
+	void sd_parse_handler_object::test<2>()
+	{
+		// the parse count matches the tree parse
+		std::ostringstream binary;
+		LLSDSerialize::toBinary(mSD, binary);
+		std::string data = binary.str();
+
+		std::istringstream tree_stream(data);
+		LLSD tree;
+		S32 tree_count = LLSDSerialize::fromBinary(tree, tree_stream, data.size());
+
+		std::istringstream event_stream(data);
+		LLSDParseHandler ignore_all;
+		ensure_equals("event parse count", LLSDSerialize::fromBinary(ignore_all, event_stream, data.size()), tree_count);
+	}
+
+	template<> template<>
+	void sd_parse_handler_object::test<3>()
+	{
+		// the item handler splits the collection off the header
+		std::ostringstream binary;
+		LLSDSerialize::toBinary(mSD, binary);
+		std::istringstream istr(binary.str());
+		LLSDItemHandler handler("members", boost::bind(&sd_parse_handler_data::onItem, this, _1, _2));
+		ensure("item parse", LLSDSerialize::fromBinary(handler, istr, binary.str().size()) > 0);
+
+		ensure_equals("item count", handler.itemCount(), 20);
+		ensure_same("items", mSD["members"], mItems);
+
+		LLSD header = mSD;
+		header.erase("members");
+		ensure("collection not in header", !handler.header().has("members"));
+		ensure_same("header", header, handler.header());
+	}
+
+	template<> template<>
+	void sd_parse_handler_object::test<4>()
+	{
+		// an array collection reports empty keys, and a scalar under the
+		// items key stays in the header
+		LLSD sd;
+		sd["folders"][0]["name"] = "a";
+		sd["folders"][1]["name"] = "b";
+		sd["folders"][2] = 7;
+		sd["version"] = 3;
+		std::ostringstream xml;
+		LLSDSerialize::toXML(sd, xml);
+
+		S32 count = 0;
+		std::istringstream istr(xml.str());
+		LLSDItemHandler handler("folders", boost::bind(&sd_parse_handler_data::onItem, this, _1, _2));
+		LLSDSerialize::fromXML(handler, istr);
+		count = handler.itemCount();
+		ensure_equals("array item count", count, 3);
+		ensure_equals("array item key", mItems.size(), 1);
+		ensure_equals("last item", mItems[""].asInteger(), 7);
+		ensure_equals("header", handler.header()["version"].asInteger(), 3);
+
+		LLSD scalar;
+		scalar["folders"] = "none";
+		std::ostringstream notation;
+		LLSDSerialize::toNotation(scalar, notation);
+		std::istringstream scalar_stream(notation.str());
+		LLSDItemHandler scalar_handler("folders", LLSDItemHandler::callback_t());
+		LLSDSerialize::fromNotation(scalar_handler, scalar_stream, notation.str().size());
+		ensure_equals("no items", scalar_handler.itemCount(), 0);
+		ensure_equals("scalar kept", scalar_handler.header()["folders"].asString(), std::string("none"));
+	}
+
+	template<> template<>
+	void sd_parse_handler_object::test<5>()
+	{
+		// malformed input fails for every format
+		LLSDTreeHandler handler;
+		std::istringstream notation("{'a':i1,'b':[i2,i3");
+		ensure_equals("truncated notation", LLSDSerialize::fromNotation(handler, notation, LLSDSerialize::SIZE_UNLIMITED), (S32)LLSDParser::PARSE_FAILURE);
+		ensure("incomplete notation", !handler.complete());
+
+		handler.reset();
+		std::string data("{\0\0\0\x02k\0\0\0\x01""ai\0\0\0\x01}", 17);
+		std::istringstream binary(data);
+		ensure_equals("truncated binary", LLSDSerialize::fromBinary(handler, binary, data.size()), (S32)LLSDParser::PARSE_FAILURE);
+	}
+}
@@ -0,0 +1,210 @@
+/**
+ * @file llsortedindex_tut.cpp
+ * @date 2026-10
+ * @brief LLSortedIndex unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llsortedindex.h"
+#include "llformat.h"
+#include "lltestrandom.h"
+#include "lltut.h"
+
+#include <algorithm>
+#include <vector>
+#include <boost/bind.hpp>
+
+namespace tut
+{
+	// A list model: a row is its sort key.
+	struct Model
+	{
+		Model() : mDescending(false), mModulo(0) {}
+
+		S32 compare(U32 lhs, U32 rhs) const
+		{
+			S32 order = mKeys[lhs] < mKeys[rhs] ? -1 : (mKeys[rhs] < mKeys[lhs] ? 1 : 0);
+			return mDescending ? -order : order;
+		}
+
+		// Hides the keys that are multiples of mModulo.
+		bool filter(U32 row) const
+		{
+			return !mModulo || mKeys[row] % mModulo;
+		}
+
+		// What the index should hold.
+		std::vector<U32> expected() const
+		{
+			std::vector<U32> rows;
+			for (U32 row = 0; row < (U32)mKeys.size(); ++row)
+			{
+				if (filter(row))
+				{
+					rows.push_back(row);
+				}
+			}
+			std::stable_sort(rows.begin(), rows.end(), boost::bind(&Model::compare, this, _1, _2) < 0);
+			return rows;
+		}
+
+		std::vector<U32> mKeys;
+		bool mDescending;
+		U32 mModulo;
+	};
+
+	static bool same_index(const LLSortedIndex& index, const std::vector<U32>& expected)
+	{
+		if (index.size() != expected.size())
+		{
+			return false;
+		}
+		for (U32 i = 0; i < index.size(); ++i)
+		{
+			if (index.getRow(i) != expected[i] || index.getIndex(expected[i]) != (S32)i)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	struct sortedindex_test
+	{
+	};
+
+	typedef test_group<sortedindex_test> sortedindex_t;
+	typedef sortedindex_t::object sortedindex_object_t;
+	tut::sortedindex_t tut_sortedindex("sortedindex");
+
+	template<> template<>
+	void sortedindex_object_t::test<1>()
+	{
+		// Without a compare function or a filter the index is the model.
+		LLSortedIndex index;
+		index.reset(5);
+		ensure("empty until updated", index.empty());
+		ensure("update after reset", index.update());
+		ensure_equals("all rows", index.size(), 5U);
+		for (U32 i = 0; i < 5; ++i)
+		{
+			ensure_equals("model order", index.getRow(i), i);
+		}
+		ensure("nothing to do", !index.update());
+
+		index.insertRows(2, 2);
+		index.removeRows(0, 1);
+		index.update();
+		ensure_equals("rows after insert and remove", index.size(), 6U);
+		for (U32 i = 0; i < 6; ++i)
+		{
+			ensure_equals("renumbered in model order", index.getRow(i), i);
+		}
+		ensure_equals("no such row", index.getIndex(6), -1);
+	}
+
+	template<> template<>
+	void sortedindex_object_t::test<2>()
+	{
+		// Random edits, against sorting the model from scratch.
+		TestRandom random;
+		Model model;
+		LLSortedIndex index;
+		index.setCompare(boost::bind(&Model::compare, &model, _1, _2));
+		index.setFilter(boost::bind(&Model::filter, &model, _1));
+
+		model.mKeys.resize(200);
+		for (U32 row = 0; row < (U32)model.mKeys.size(); ++row)
+		{
+			model.mKeys[row] = random.next(50);	// Many equal keys
+		}
+		index.reset((U32)model.mKeys.size());
+		index.update();
+		ensure("initial order", same_index(index, model.expected()));
+
+		for (S32 round = 0; round < 2000; ++round)
+		{
+			const S32 edits = 1 + random.next(8);
+			for (S32 edit = 0; edit < edits; ++edit)
+			{
+				const U32 rows = (U32)model.mKeys.size();
+				switch (random.next(7))
+				{
+				case 0:
+				{
+					const U32 first = random.next(rows + 1);
+					const U32 count = 1 + random.next(3);
+					for (U32 i = 0; i < count; ++i)
+					{
+						model.mKeys.insert(model.mKeys.begin() + first + i, random.next(50));
+					}
+					index.insertRows(first, count);
+					break;
+				}
+				case 1:
+					if (rows)
+					{
+						const U32 first = random.next(rows);
+						const U32 count = llmin(rows - first, 1 + random.next(3));
+						model.mKeys.erase(model.mKeys.begin() + first, model.mKeys.begin() + first + count);
+						index.removeRows(first, count);
+					}
+					break;
+				case 2:
+					if (random.next(20) == 0)
+					{
+						model.mModulo = random.next(4);
+						index.refilter();
+					}
+					break;
+				case 3:
+					if (random.next(20) == 0)
+					{
+						model.mDescending = !model.mDescending;
+						index.resort();
+					}
+					break;
+				default:
+					if (rows)
+					{
+						const U32 row = random.next(rows);
+						model.mKeys[row] = random.next(50);
+						index.rowChanged(row);
+					}
+					break;
+				}
+			}
+			index.update();
+			ensure(llformat("round %d", round), same_index(index, model.expected()));
+		}
+	}
+}
@@ -0,0 +1,306 @@
+/**
+ * @file llterraincomposite_tut.cpp
+ * @date 2026-10
+ * @brief LLTerrainComposite unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llmath.h"
+#include "llperlin.h"
+#include "llterraincomposite.h"
+#include "v2math.h"
+#include "v3math.h"
+#include "llformat.h"
+#include "lltestrandom.h"
+#include "lltut.h"
+
+#include <vector>
+
+namespace tut
+{
+	// -------------------------------------------------------------------------------------------
+	// Reference implementations: the loops of LLVLComposition::generateHeights(),
+	// LLViewerLayer::getValueScaled() and LLVLComposition::generateTexture() before the
+	// kernels. The kernels must produce exactly the same bits.
+	// -------------------------------------------------------------------------------------------
+
+	static F32 ref_noise(F32 origin_x, F32 origin_y, F32 scale, S32 i, S32 j)
+	{
+		const F32 slope_squared = 1.5f*1.5f;
+		const F32 xyScale = 4.9215f;
+		const F32 noise_magnitude = 2.f;
+		const F32 xyScaleInv = (1.f / xyScale);
+
+		LLVector3 location(i*scale, j*scale, 0.f);
+		LLVector2 vec = (LLVector2(LLVector3(origin_x, origin_y, 0.f)) + LLVector2(location));
+		vec *= xyScaleInv;
+
+		F32 twiddle = LLPerlinNoise::noise(vec*0.2222222222f)*6.5f;
+		twiddle += LLPerlinNoise::turbulence(vec, 2.f)*slope_squared;
+		twiddle *= noise_magnitude;
+		return twiddle;
+	}
+
+	struct RefLayer
+	{
+		S32 mWidth;
+		F32 mScaleInv;
+		const F32* mDatap;
+
+		F32 getValueScaled(const F32 x, const F32 y) const
+		{
+			S32 x1, x2, y1, y2;
+			F32 x_frac, y_frac;
+
+			x_frac = x*mScaleInv;
+			x1 = llfloor(x_frac);
+			x2 = x1 + 1;
+			x_frac -= x1;
+
+			y_frac = y*mScaleInv;
+			y1 = llfloor(y_frac);
+			y2 = y1 + 1;
+			y_frac -= y1;
+
+			x1 = llmin((S32)mWidth-1, x1);
+			x1 = llmax(0, x1);
+			x2 = llmin((S32)mWidth-1, x2);
+			x2 = llmax(0, x2);
+			y1 = llmin((S32)mWidth-1, y1);
+			y1 = llmax(0, y1);
+			y2 = llmin((S32)mWidth-1, y2);
+			y2 = llmax(0, y2);
+
+			S32 row1 = y1 * mWidth;
+			S32 row2 = y2 * mWidth;
+
+			F32 row1_left  = mDatap[ row1 + x1 ];
+			F32 row1_right = mDatap[ row1 + x2 ];
+			F32 row2_left  = mDatap[ row2 + x1 ];
+			F32 row2_right = mDatap[ row2 + x2 ];
+
+			F32 row1_interp = row1_left - x_frac * (row1_left - row1_right);
+			F32 row2_interp = row2_left - x_frac * (row2_left - row2_right);
+
+			return row1_interp - y_frac * (row1_interp - row2_interp);
+		}
+	};
+
+	static void ref_blend(const LLTerrainComposite::BlendParams& params,
+						  S32 tex_x_begin, S32 tex_y_begin, S32 tex_x_end, S32 tex_y_end)
+	{
+		RefLayer layer;
+		layer.mWidth = params.mCompositionWidth;
+		layer.mScaleInv = params.mCompositionScaleInv;
+		layer.mDatap = params.mComposition;
+
+		const U8* const* st_data = params.mDetail;
+		const S32* st_data_size = params.mDetailSize;
+		U32 st_width = params.mDetailWidth;
+		U32 st_height = params.mDetailHeight;
+		U32 st_comps = 3;
+		U32 tex_comps = 3;
+		U32 tex_stride = params.mDstStride;
+		F32 st_x_stride = params.mDetailStrideX;
+		F32 st_y_stride = params.mDetailStrideY;
+		F32 tex_x_ratiof = params.mTexelSizeX;
+		F32 tex_y_ratiof = params.mTexelSizeY;
+		U8* rawp = params.mDst;
+
+		F32 sti, stj;
+		S32 st_offset;
+		stj = (tex_y_begin * st_y_stride) - st_height*(llfloor((tex_y_begin * st_y_stride)/st_height));
+
+		for (S32 j = tex_y_begin; j < tex_y_end; j++)
+		{
+			U32 offset = j * tex_stride + tex_x_begin * tex_comps;
+			sti = (tex_x_begin * st_x_stride) - st_width*((U32)(tex_x_begin * st_x_stride)/st_width);
+			for (S32 i = tex_x_begin; i < tex_x_end; i++)
+			{
+				S32 tex0, tex1;
+				F32 composition = layer.getValueScaled(i*tex_x_ratiof, j*tex_y_ratiof);
+
+				tex0 = llfloor( composition );
+				tex0 = llclamp(tex0, 0, 3);
+				composition -= tex0;
+				tex1 = tex0 + 1;
+				tex1 = llclamp(tex1, 0, 3);
+
+				st_offset = (lltrunc(sti) + lltrunc(stj)*st_width) * st_comps;
+				for (U32 k = 0; k < tex_comps; k++)
+				{
+					if (!(st_offset >= st_data_size[tex0] || st_offset >= st_data_size[tex1]))
+					{
+						F32 a = *(st_data[tex0] + st_offset);
+						F32 b = *(st_data[tex1] + st_offset);
+						rawp[ offset ] = (U8)lltrunc( a + composition * (b - a) );
+					}
+					offset++;
+					st_offset++;
+				}
+
+				sti += st_x_stride;
+				if (sti >= st_width)
+				{
+					sti -= st_width;
+				}
+			}
+
+			stj += st_y_stride;
+			if (stj >= st_height)
+			{
+				stj -= st_height;
+			}
+		}
+	}
+
+	// -------------------------------------------------------------------------------------------
+
+	// A region: composition values, four detail textures and the surface texture.
+	// Regions of the same size have the same contents.
+	struct TerrainRegion
+	{
+		static const U32 DETAIL_SIZE = 128;
+
+		std::vector<F32> mComposition;
+		std::vector<U8> mDetail[4];
+		std::vector<U8> mTexture;
+		LLTerrainComposite::BlendParams mParams;
+
+		TerrainRegion(S32 comp_width, F32 meters, S32 tex_width)
+		:	mComposition(comp_width * comp_width),
+			mTexture(tex_width * tex_width * 3)
+		{
+			TestRandom random;
+
+			// Smooth hills with some values outside [0, 3], as the edges of real regions have.
+			for (S32 j = 0; j < comp_width; j++)
+			{
+				for (S32 i = 0; i < comp_width; i++)
+				{
+					mComposition[j * comp_width + i] = 1.5f + 1.7f * sinf(i * 0.05f) * cosf(j * 0.031f)
+													   + (F32)random.next(1000) * 0.0002f;
+				}
+			}
+			for (S32 d = 0; d < 4; d++)
+			{
+				mDetail[d].resize(DETAIL_SIZE * DETAIL_SIZE * 3);
+				for (size_t n = 0; n < mDetail[d].size(); n++)
+				{
+					mDetail[d][n] = (U8)random.nextU32();
+				}
+				mParams.mDetail[d] = &mDetail[d][0];
+				mParams.mDetailSize[d] = (S32)mDetail[d].size();
+			}
+			for (size_t n = 0; n < mTexture.size(); n++)
+			{
+				mTexture[n] = (U8)n;
+			}
+
+			// As LLVLComposition::generateTexture() sets them up, with the default texture scale of 16.
+			mParams.mComposition = &mComposition[0];
+			mParams.mCompositionWidth = comp_width;
+			mParams.mCompositionScaleInv = comp_width / meters;
+			mParams.mDetailWidth = DETAIL_SIZE;
+			mParams.mDetailHeight = DETAIL_SIZE;
+			mParams.mDetailStrideX = ((F32)DETAIL_SIZE / 16.f)*((F32)comp_width / (F32)tex_width);
+			mParams.mDetailStrideY = mParams.mDetailStrideX;
+			mParams.mTexelSizeX = meters / (F32)tex_width;
+			mParams.mTexelSizeY = mParams.mTexelSizeX;
+			mParams.mDst = &mTexture[0];
+			mParams.mDstStride = tex_width * 3;
+		}
+	};
+
+	struct terraincomposite_test
+	{
+		void ensure_blend(S32 comp_width, F32 meters, S32 tex_width, S32 x_begin, S32 y_begin, S32 x_end, S32 y_end)
+		{
+			TerrainRegion expected(comp_width, meters, tex_width);
+			TerrainRegion actual(comp_width, meters, tex_width);
+			ref_blend(expected.mParams, x_begin, y_begin, x_end, y_end);
+			LLTerrainComposite::blend(actual.mParams, x_begin, y_begin, x_end, y_end);
+			ensure(llformat("%d grid, %d texels, [%d, %d) x [%d, %d)", comp_width, tex_width, x_begin, x_end, y_begin, y_end),
+				   expected.mTexture == actual.mTexture);
+		}
+	};
+
+	typedef test_group<terraincomposite_test> terraincomposite_t;
+	typedef terraincomposite_t::object terraincomposite_object_t;
+	tut::terraincomposite_t tut_terraincomposite("terraincomposite");
+
+	template<> template<>
+	void terraincomposite_object_t::test<1>()
+	{
+		// Noise: the same bits as the per grid point code, also for rows that start mid region.
+		const S32 width = 64;
+		std::vector<F32> noise(width * width);
+		LLTerrainComposite::generateNoise(256000.f, 256768.f, 1.f, width, 0, 40, &noise[0]);
+		LLTerrainComposite::generateNoise(256000.f, 256768.f, 1.f, width, 40, width, &noise[0]);
+		for (S32 j = 0; j < width; j++)
+		{
+			for (S32 i = 0; i < width; i++)
+			{
+				F32 expected = ref_noise(256000.f, 256768.f, 1.f, i, j);
+				ensure(llformat("noise at %d, %d", i, j), !memcmp(&expected, &noise[j * width + i], sizeof(F32)));
+			}
+		}
+	}
+
+	template<> template<>
+	void terraincomposite_object_t::test<2>()
+	{
+		// Patches of a region with the surface texture as large as the grid, larger and smaller.
+		ensure_blend(256, 256.f, 256, 0, 0, 16, 16);
+		ensure_blend(256, 256.f, 256, 112, 240, 128, 256);
+		ensure_blend(256, 256.f, 256, 0, 0, 256, 256);
+		ensure_blend(256, 256.f, 512, 32, 96, 64, 128);
+		ensure_blend(256, 256.f, 128, 120, 8, 128, 16);
+		// A var region
+		ensure_blend(512, 512.f, 256, 248, 0, 256, 8);
+		// Widths that are not a multiple of four, odd starts
+		ensure_blend(256, 256.f, 256, 3, 5, 22, 19);
+		ensure_blend(256, 256.f, 256, 250, 250, 253, 256);
+	}
+
+	template<> template<>
+	void terraincomposite_object_t::test<3>()
+	{
+		// Detail textures smaller than their offsets say leave those texels alone.
+		TerrainRegion expected(256, 256.f, 256);
+		TerrainRegion actual(256, 256.f, 256);
+		expected.mParams.mDetailSize[2] = actual.mParams.mDetailSize[2] = 3000;
+		ref_blend(expected.mParams, 0, 0, 256, 256);
+		LLTerrainComposite::blend(actual.mParams, 0, 0, 256, 256);
+		ensure("short detail texture", expected.mTexture == actual.mTexture);
+	}
+}
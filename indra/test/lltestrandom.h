@@ -0,0 +1,68 @@
+/**
+ * @file lltestrandom.h
+ * @date 2026-10
+ * @brief Reproducible random numbers for unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTESTRANDOM_H
+#define LL_LLTESTRANDOM_H
+
+#include "llrand.h"
+
+namespace tut
+{
+	// Random test data from a fixed seed, so failures reproduce. Tests that
+	// want independent streams pass their own seed.
+	class TestRandom
+	{
+	public:
+		TestRandom(U32 seed = 4357) : mGenerator(seed) { }
+
+		// In [0, range); 0 when range is 0.
+		U32 next(U32 range)	{ return range ? mGenerator() % range : 0; }
+
+		// In [0, range).
+		F64 nextReal(F64 range)	{ return (F64)mGenerator() / 4294967296.0 * range; }
+
+		U32 nextU32()		{ return mGenerator(); }
+
+		U64 nextU64()
+		{
+			// Two statements, so the order of the halves is fixed.
+			const U64 high = mGenerator();
+			return (high << 32) | mGenerator();
+		}
+
+	private:
+		LLRandMT19937 mGenerator;
+	};
+}
+
+#endif // LL_LLTESTRANDOM_H
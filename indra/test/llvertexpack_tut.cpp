@@ -0,0 +1,368 @@
+/**
+ * @file llvertexpack_tut.cpp
+ * @date 2026-10
+ * @brief LLVertexPack unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llmath.h"
+#include "llmatrix4a.h"
+#include "llvertexpack.h"
+#include "v2math.h"
+#include "v4math.h"
+#include "llformat.h"
+#include "lltestrandom.h"
+#include "lltut.h"
+
+#include <vector>
+
+namespace tut
+{
+	// -------------------------------------------------------------------------------------------
+	// Reference implementations: the per vertex code that LLFace::getGeometryVolume() ran
+	// before the kernels. The kernels must produce exactly the same bits.
+	// -------------------------------------------------------------------------------------------
+
+	static void ref_planar_projection(LLVector2 &tc, const LLVector4a& normal, const LLVector4a& vec)
+	{
+		LLVector4a binormal;
+		F32 d = normal[0];
+
+		if (d >= 0.5f || d <= -0.5f)
+		{
+			if (d < 0)
+			{
+				binormal.set(0,-1,0);
+			}
+			else
+			{
+				binormal.set(0, 1, 0);
+			}
+		}
+		else
+		{
+			if (normal[1] > 0)
+			{
+				binormal.set(-1,0,0);
+			}
+			else
+			{
+				binormal.set(1,0,0);
+			}
+		}
+		LLVector4a tangent;
+		tangent.setCross3(binormal,normal);
+
+		tc.mV[1] = -((tangent.dot3(vec).getF32())*2 - 0.5f);
+		tc.mV[0] = 1.0f+((binormal.dot3(vec).getF32())*2 - 0.5f);
+	}
+
+	static void ref_xform(LLVector2 &tex_coord, F32 cosAng, F32 sinAng, F32 offS, F32 offT, F32 magS, F32 magT)
+	{
+		F32 s = tex_coord.mV[0];
+		F32 t = tex_coord.mV[1];
+
+		s -= 0.5; 
+		t -= 0.5;
+
+		F32 temp = s;
+		s  = s     * cosAng + t * sinAng;
+		t  = -temp * sinAng + t * cosAng;
+
+		s *= magS;
+		t *= magT;
+
+		s += offS + 0.5f; 
+		t += offT + 0.5f;
+
+		tex_coord.mV[0] = s;
+		tex_coord.mV[1] = t;
+	}
+
+	static void ref_texcoords(const LLVertexPack::TexCoordParams& params, bool planar,
+							  LLVertexPack::ETexCoordTransform transform, S32 count, LLVector2* dst)
+	{
+		LLVector4a scale;
+		scale.load3(params.mScale);
+		for (S32 i = 0; i < count; ++i)
+		{
+			LLVector2 tc(params.mTexCoords[i]);
+			if (planar)
+			{
+				LLVector4a vec = params.mPositions[i];
+				vec.mul(scale);
+				ref_planar_projection(tc, params.mNormals[i], vec);
+			}
+			if (transform == LLVertexPack::TC_XFORM)
+			{
+				ref_xform(tc, params.mCos, params.mSin, params.mOffsetS, params.mOffsetT, params.mScaleS, params.mScaleT);
+			}
+			else if (transform == LLVertexPack::TC_MATRIX)
+			{
+				LLVector4a tmp(tc.mV[VX], tc.mV[VY], 0.f);
+				params.mMatrix->affineTransform(tmp, tmp);
+				tc.set(tmp.getF32ptr());
+			}
+			dst[i] = tc;
+		}
+	}
+
+	static void ref_positions(const LLMatrix4a& mat, const LLVector4a* src, S32 count, S32 index, LLVector4a* dst, S32 dst_count)
+	{
+		F32 val = 0.f;
+		S32* vp = (S32*) &val;
+		*vp = index;
+		LLVector4a texIdx;
+		texIdx.set(0,0,0,val);
+		LLVector4Logical mask;
+		mask.clear();
+		mask.setElement<3>();
+
+		LLVector4a res0, tmp;
+		S32 i = 0;
+		for (; i < count; ++i)
+		{
+			mat.affineTransform(src[i], res0);
+			tmp.setSelectWithMask(mask, texIdx, res0);
+			dst[i] = tmp;
+		}
+		for (; i < dst_count; ++i)
+		{
+			dst[i] = res0;
+		}
+	}
+
+	static void ref_tangents(const LLMatrix4a& mat, const LLVector4a* src, S32 count, LLVector4a* dst)
+	{
+		for (S32 i = 0; i < count; ++i)
+		{
+			LLVector4a tangent_out;
+			mat.rotate(src[i], tangent_out);
+			tangent_out.normalize3fast();
+			tangent_out.copyComponent<3>(src[i]);
+			dst[i] = tangent_out;
+		}
+	}
+
+	// -------------------------------------------------------------------------------------------
+	// Synthetic faces
+	// -------------------------------------------------------------------------------------------
+
+	static TestRandom sRandom;
+
+	static F32 random_f32(F32 lo, F32 hi)
+	{
+		return lo + (F32)sRandom.nextReal(hi - lo);
+	}
+
+	static LLVector4a* alloc_vectors(S32 count)
+	{
+		return (LLVector4a*) ll_aligned_malloc_16(llmax(count, 4) * sizeof(LLVector4a));
+	}
+
+	struct TestFace
+	{
+		S32 mCount;
+		LLVector4a* mPositions;
+		LLVector4a* mNormals;
+		LLVector4a* mTangents;
+		std::vector<LLVector2> mTexCoords;
+
+		TestFace(S32 count)
+		:	mCount(count),
+			mPositions(alloc_vectors(count)),
+			mNormals(alloc_vectors(count)),
+			mTangents(alloc_vectors(count)),
+			mTexCoords(llmax(count, 1))
+		{
+			for (S32 i = 0; i < count; ++i)
+			{
+				mPositions[i].set(random_f32(-0.5f, 0.5f), random_f32(-0.5f, 0.5f), random_f32(-0.5f, 0.5f), 1.f);
+				// Every fourth normal sits on the planar projection thresholds
+				if (i % 4 == 3)
+				{
+					const F32 edge[] = { 0.5f, -0.5f, 0.f, -0.f };
+					mNormals[i].set(edge[(i / 4) % 4], random_f32(-1.f, 1.f), random_f32(-1.f, 1.f));
+				}
+				else
+				{
+					mNormals[i].set(random_f32(-1.f, 1.f), random_f32(-1.f, 1.f), random_f32(-1.f, 1.f));
+				}
+				mNormals[i].normalize3fast();
+				mTangents[i].set(random_f32(-1.f, 1.f), random_f32(-1.f, 1.f), random_f32(-1.f, 1.f), i % 2 ? 1.f : -1.f);
+				mTexCoords[i].set(random_f32(0.f, 1.f), random_f32(0.f, 1.f));
+			}
+		}
+
+		~TestFace()
+		{
+			ll_aligned_free_16(mPositions);
+			ll_aligned_free_16(mNormals);
+			ll_aligned_free_16(mTangents);
+		}
+
+		LLVertexPack::TexCoordParams params(const LLMatrix4a* matrix) const
+		{
+			LLVertexPack::TexCoordParams params;
+			params.mTexCoords = &mTexCoords[0];
+			params.mPositions = mPositions;
+			params.mNormals = mNormals;
+			params.mScale[0] = 2.5f;
+			params.mScale[1] = 0.75f;
+			params.mScale[2] = 1.25f;
+			params.mMatrix = matrix;
+			const F32 rot = 0.7f;
+			params.mCos = cosf(rot);
+			params.mSin = sinf(rot);
+			params.mOffsetS = 0.125f;
+			params.mOffsetT = -0.3f;
+			params.mScaleS = 3.f;
+			params.mScaleT = 0.6f;
+			return params;
+		}
+	};
+
+	// A rotation with non uniform scale and a translation, like a prim's
+	static LLMatrix4a make_matrix()
+	{
+		LLMatrix4a mat;
+		mat.setRows(LLVector4a(0.9f, 0.3f, -0.2f, 0.f),
+					LLVector4a(-0.6f, 0.7f, 0.4f, 0.f),
+					LLVector4a(0.5f, -0.1f, 1.8f, 0.f));
+		mat.getRow<3>().set(1.5f, -2.f, 12.f, 1.f);
+		return mat;
+	}
+
+	template <class T>
+	static bool same_bits(const T* a, const T* b, S32 count)
+	{
+		return memcmp(a, b, count * sizeof(T)) == 0;
+	}
+
+	struct vertexpack_test
+	{
+	};
+
+	typedef test_group<vertexpack_test> vertexpack_t;
+	typedef vertexpack_t::object vertexpack_object_t;
+	tut::vertexpack_t tut_vertexpack("vertexpack");
+
+	template<> template<>
+	void vertexpack_object_t::test<1>()
+	{
+		// Positions, normals and tangents match the per vertex loops, including
+		// the texture index in w and the padding up to the buffer's vertex count.
+		const LLMatrix4a mat = make_matrix();
+		const S32 counts[] = { 1, 3, 4, 5, 17, 600 };
+		for (S32 c = 0; c < (S32)LL_ARRAY_SIZE(counts); ++c)
+		{
+			const S32 count = counts[c];
+			const S32 dst_count = (count + 3) & ~3;
+			TestFace face(count);
+			LLVector4a* expected = alloc_vectors(dst_count);
+			LLVector4a* actual = alloc_vectors(dst_count);
+
+			ref_positions(mat, face.mPositions, count, 7, expected, dst_count);
+			LLVertexPack::transformPositions(mat, face.mPositions, count, 7, actual, dst_count);
+			ensure(llformat("positions, %d vertices", count), same_bits(expected, actual, dst_count));
+
+			for (S32 i = 0; i < count; ++i)
+			{
+				mat.rotate(face.mNormals[i], expected[i]);
+			}
+			LLVertexPack::rotateNormals(mat, face.mNormals, count, actual);
+			ensure(llformat("normals, %d vertices", count), same_bits(expected, actual, count));
+
+			ref_tangents(mat, face.mTangents, count, expected);
+			LLVertexPack::rotateTangents(mat, face.mTangents, count, actual);
+			ensure(llformat("tangents, %d vertices", count), same_bits(expected, actual, count));
+
+			ll_aligned_free_16(expected);
+			ll_aligned_free_16(actual);
+		}
+	}
+
+	template<> template<>
+	void vertexpack_object_t::test<2>()
+	{
+		// Every texture coordinate kernel matches planarProjection(), xform() and
+		// the texture matrix, for counts that leave a partial block.
+		const LLMatrix4a mat = make_matrix();
+		const LLVertexPack::ETexCoordTransform transforms[] = { LLVertexPack::TC_NONE, LLVertexPack::TC_XFORM, LLVertexPack::TC_MATRIX };
+		const S32 counts[] = { 1, 2, 3, 4, 5, 7, 8, 33, 1000 };
+		for (S32 c = 0; c < (S32)LL_ARRAY_SIZE(counts); ++c)
+		{
+			const S32 count = counts[c];
+			TestFace face(count);
+			const LLVertexPack::TexCoordParams params = face.params(&mat);
+			for (S32 planar = 0; planar < 2; ++planar)
+			{
+				for (S32 t = 0; t < (S32)LL_ARRAY_SIZE(transforms); ++t)
+				{
+					// One spare entry to catch writes past the end
+					std::vector<LLVector2> expected(count + 1, LLVector2(-7.f, -7.f));
+					std::vector<LLVector2> actual(count + 1, LLVector2(-7.f, -7.f));
+					ref_texcoords(params, planar, transforms[t], count, &expected[0]);
+					LLVertexPack::getTexCoordKernel(planar, transforms[t])(params, count, &actual[0]);
+					ensure(llformat("texture coordinates, %d vertices, planar %d, transform %d", count, planar, t),
+						   same_bits(&expected[0], &actual[0], count + 1));
+				}
+			}
+		}
+	}
+
+	template<> template<>
+	void vertexpack_object_t::test<3>()
+	{
+		// Index offsets and color fills
+		const S32 count = 101;
+		std::vector<U16> indices(count), expected(count + 1, 0xBEEF), actual(count + 1, 0xBEEF);
+		for (S32 i = 0; i < count; ++i)
+		{
+			indices[i] = (U16)(i * 37 % 1000);
+			expected[i] = indices[i] + 500;
+		}
+		LLVertexPack::offsetIndices(&indices[0], count, 500, &actual[0]);
+		ensure("indices", expected == actual);
+
+		LL_ALIGN_16(U32 colors[12]);
+		for (S32 i = 0; i < 12; ++i)
+		{
+			colors[i] = 0;
+		}
+		LLVertexPack::fill(0x80FF40C0, 5, colors);
+		for (S32 i = 0; i < 12; ++i)
+		{
+			ensure_equals(llformat("color %d", i).c_str(), colors[i], i < 8 ? 0x80FF40C0 : 0);
+		}
+	}
+}
@@ -0,0 +1,192 @@
+/**
+ * @file llwrappedlines_tut.cpp
+ * @date 2026-10
+ * @brief LLWrappedLines unit tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewergpl$
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llwrappedlines.h"
+#include "llformat.h"
+#include "lltestrandom.h"
+#include "lltut.h"
+
+#include <vector>
+#include <boost/bind.hpp>
+
+namespace tut
+{
+	// Wraps after mWidth characters, or after the last space before that.
+	struct Wrapper
+	{
+		Wrapper(const LLWString& text, S32 width) : mText(text), mWidth(width) {}
+
+		void wrap(S32 start, S32 end, std::vector<S32>& lines)
+		{
+			S32 line = start;
+			while (end - line > mWidth)
+			{
+				S32 next = line + mWidth;
+				while (next > line && mText[next - 1] != ' ')
+				{
+					--next;
+				}
+				if (next == line)
+				{
+					next = line + mWidth;
+				}
+				lines.push_back(next);
+				line = next;
+			}
+		}
+
+		LLWrappedLines::wrap_t function()
+		{
+			return boost::bind(&Wrapper::wrap, this, _1, _2, _3);
+		}
+
+		const LLWString& mText;
+		S32 mWidth;
+	};
+
+	static bool same_lines(const LLWrappedLines& lines, const LLWrappedLines& expected)
+	{
+		if (lines.getLineCount() != expected.getLineCount())
+		{
+			return false;
+		}
+		for (S32 i = 0; i < lines.getLineCount(); ++i)
+		{
+			if (lines.getLineStart(i) != expected.getLineStart(i))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static LLWString random_text(TestRandom& random, S32 length)
+	{
+		static const char chars[] = "abcdefgh   \n";
+		LLWString text;
+		for (S32 i = 0; i < length; ++i)
+		{
+			text += (llwchar)chars[random.next(sizeof(chars) - 1)];
+		}
+		return text;
+	}
+
+	struct wrappedlines_test
+	{
+	};
+
+	typedef test_group<wrappedlines_test> wrappedlines_t;
+	typedef wrappedlines_t::object wrappedlines_object_t;
+	tut::wrappedlines_t tut_wrappedlines("wrappedlines");
+
+	template<> template<>
+	void wrappedlines_object_t::test<1>()
+	{
+		LLWString text;
+		Wrapper wrapper(text, 4);
+		LLWrappedLines lines;
+		ensure("starts invalid", lines.needsUpdate());
+		lines.update(text, wrapper.function());
+		ensure_equals("an empty text has a line", lines.getLineCount(), 1);
+		ensure_equals("at 0", lines.getLineStart(0), 0);
+
+		text = utf8str_to_wstring("ab cd ef\n\nabcdefghij\n");
+		lines.invalidate();
+		lines.update(text, wrapper.function());
+		// "ab " "cd " "ef" | "" | "abcd" "efgh" "ij" | ""
+		const S32 starts[] = { 0, 3, 6, 9, 10, 14, 18, 21 };
+		ensure_equals("line count", lines.getLineCount(), (S32)LL_ARRAY_SIZE(starts));
+		for (S32 i = 0; i < lines.getLineCount(); ++i)
+		{
+			ensure_equals(llformat("line %d", i), lines.getLineStart(i), starts[i]);
+		}
+		ensure_equals("line of 0", lines.getLine(0), 0);
+		ensure_equals("line of 4", lines.getLine(4), 1);
+		ensure_equals("line of the newline", lines.getLine(8), 2);
+		ensure_equals("line of the end", lines.getLine(21), 7);
+		ensure("up to date", !lines.needsUpdate());
+
+		// Typing in the last paragraph leaves the others alone.
+		text.insert(12, utf8str_to_wstring("xyz"));
+		lines.noteChange(12, 0, 3);
+		lines.update(text, wrapper.function());
+		ensure_equals("one paragraph wrapped", lines.getWrappedCount(), 1);
+		ensure_equals("line count after typing", lines.getLineCount(), 9);
+		ensure_equals("new line", lines.getLineStart(7), 22);
+		ensure_equals("last line moved", lines.getLineStart(8), 24);
+
+		// Joining two paragraphs
+		text.erase(8, 1);
+		lines.noteChange(8, 1, 0);
+		lines.update(text, wrapper.function());
+		ensure_equals("first line kept", lines.getLineStart(0), 0);
+		ensure_equals("one paragraph wrapped after joining", lines.getWrappedCount(), 1);
+		ensure_equals("empty paragraph joined", lines.getLineStart(3), 9);
+		ensure_equals("lines after it moved", lines.getLineStart(4), 13);
+	}
+
+	template<> template<>
+	void wrappedlines_object_t::test<2>()
+	{
+		// Random edits, against wrapping the text from scratch.
+		TestRandom random;
+		LLWString text = random_text(random, 2000);
+		Wrapper wrapper(text, 12);
+		LLWrappedLines lines;
+		lines.update(text, wrapper.function());
+
+		for (S32 round = 0; round < 2000; ++round)
+		{
+			const S32 edits = 1 + random.next(4);
+			for (S32 edit = 0; edit < edits; ++edit)
+			{
+				const S32 pos = random.next(text.length() + 1);
+				const S32 removed = llmin((S32)text.length() - pos, (S32)random.next(5));
+				const S32 inserted = random.next(5);
+				text.replace(pos, removed, random_text(random, inserted));
+				lines.noteChange(pos, removed, inserted);
+			}
+			// Sometimes as for a highlighter that only redid part of the text
+			const S32 keep_from = random.next(4) ? 0 : random.next(text.length() + 1);
+			lines.update(text, wrapper.function(), keep_from);
+
+			LLWrappedLines expected;
+			expected.update(text, wrapper.function());
+			ensure(llformat("round %d", round), same_lines(lines, expected));
+		}
+	}
+}
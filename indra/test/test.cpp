@@ -59,6 +59,7 @@ extern void ll_init_apr();
 namespace tut
 {
 	std::string sSourceDir;
+	bool sRunBenchmarks = false;
 
     test_runner_singleton runner;
 }
@@ -191,6 +192,7 @@ static const apr_getopt_option_t TEST_CL_OPTIONS[] =
 	{"touch", 't', 1, "Touch the given file if all tests succeed"},
 	{"wait", 'w', 0, "Wait for input before exit."},
 	{"debug", 'd', 0, "Emit full debug logs."},
+	{"benchmark", 'b', 0, "Also run the timing benchmarks."},
 	{0, 0, 0, 0}
 };
 
@@ -317,6 +319,9 @@ int main(int argc, char **argv)
 			// ERROR by default, so this allows full debug levels.
 			LLError::setDefaultLevel(LLError::LEVEL_DEBUG);
 			break;
+		case 'b':
+			tut::sRunBenchmarks = true;
+			break;
 		default:
 			stream_usage(std::cerr, argv[0]);
 			return 1;
@@ -45,6 +45,11 @@ namespace tut
 	// Use sparingly, as hitting the file system slows down test execution
 	// and hence every compile. JC
 	extern std::string sSourceDir;
+
+	// Set by --benchmark. Timing runs slow down every compile and their
+	// numbers mean nothing on a loaded build machine, so the benchmarks in
+	// llbenchmark_tut.cpp return early unless this is set.
+	extern bool sRunBenchmarks;
 }
 
 #endif